@@ -0,0 +1,15 @@
+// Polls the view counter without counting a view
+function refresh() {
+  fetch('/count')
+    .then(function (r) { return r.text(); })
+    .then(function (text) {
+      document.getElementById('views').textContent = text.replace('View Count: ', '');
+      document.getElementById('updated').textContent = new Date().toLocaleTimeString();
+    })
+    .catch(function () {
+      document.getElementById('updated').textContent = 'offline';
+    });
+}
+
+refresh();
+setInterval(refresh, 2000);
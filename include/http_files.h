@@ -0,0 +1,33 @@
+#ifndef __HTTP_FILES_H__
+#define __HTTP_FILES_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Longest precomputed response head (bytes), checked by the generator.
+ */
+#define HTTP_FILE_HEAD_MAX 256
+
+/**
+ * @brief A static file in flash, generated from data/ by tools/http_files.py.
+ *
+ * The response heads are complete (status line, headers, blank line), so a
+ * response is two tcp_write() calls by reference: the head and the content.
+ */
+struct http_file {
+  const char *path;                /**< @brief Request path, e.g. "/status/" */
+  const char *etag;                /**< @brief Quoted ETag, e.g. "\"1a2b3c4d\"" */
+  const char *head;                /**< @brief 200 OK response head */
+  const char *head_close;          /**< @brief 200 OK response head with `Connection: close` */
+  const uint8_t *data;             /**< @brief Content, gzip-compressed if @ref gzip */
+  uint16_t head_len;               /**< @brief Length of @ref head */
+  uint16_t head_close_len;         /**< @brief Length of @ref head_close */
+  uint32_t len;                    /**< @brief Length of @ref data */
+  bool gzip;                       /**< @brief Content is sent with `Content-Encoding: gzip` */
+};
+
+extern const struct http_file http_files[];  /**< @brief Generated file table */
+extern const size_t http_files_count;        /**< @brief Number of entries in http_files */
+
+#endif // __HTTP_FILES_H__
@@ -0,0 +1,134 @@
+#ifndef __HTTP_PARSER_H__
+#define __HTTP_PARSER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lwip/pbuf.h"
+
+/**
+ * @brief Longest request path kept for routing (bytes, without the query).
+ *
+ * Longer paths fail the request with 414 URI Too Long.
+ */
+#ifndef HTTP_PATH_MAX
+#define HTTP_PATH_MAX 64
+#endif
+
+/**
+ * @brief Maximum size of the request line and headers (bytes).
+ *
+ * Larger requests fail with 431 Request Header Fields Too Large.
+ */
+#ifndef HTTP_MAX_REQUEST
+#define HTTP_MAX_REQUEST 1024
+#endif
+
+/**
+ * @brief Longest `If-None-Match` value kept (bytes); longer values match no ETag.
+ */
+#ifndef HTTP_ETAG_MAX
+#define HTTP_ETAG_MAX 24
+#endif
+
+/**
+ * @brief Request methods recognized by the parser.
+ */
+enum http_method {
+  HTTP_METHOD_UNKNOWN = 0,
+  HTTP_METHOD_GET,
+  HTTP_METHOD_HEAD,
+  HTTP_METHOD_POST,
+  HTTP_METHOD_PUT,
+  HTTP_METHOD_DELETE,
+  HTTP_METHOD_OPTIONS,
+};
+
+/**
+ * @brief Parser states; HTTP_PARSE_DONE and HTTP_PARSE_ERROR are final.
+ */
+enum http_parse_state {
+  HTTP_PARSE_METHOD = 0,
+  HTTP_PARSE_PATH,
+  HTTP_PARSE_QUERY,
+  HTTP_PARSE_VERSION,
+  HTTP_PARSE_VERSION_END,
+  HTTP_PARSE_HEADER_START,
+  HTTP_PARSE_HEADER_NAME,
+  HTTP_PARSE_HEADER_VALUE,
+  HTTP_PARSE_HEADER_SKIP,
+  HTTP_PARSE_BODY,
+  HTTP_PARSE_DONE,
+  HTTP_PARSE_ERROR,
+};
+
+#define HTTP_REQ_HTTP10       0x01 /**< @brief Request is HTTP/1.0 */
+#define HTTP_REQ_CLOSE        0x02 /**< @brief `Connection: close` */
+#define HTTP_REQ_GZIP         0x04 /**< @brief `Accept-Encoding` lists the gzip coding with a non-zero q-value */
+
+/**
+ * @brief Streaming HTTP/1.x request parser.
+ *
+ * Consumes a request byte by byte, so it may be split at any point across
+ * segments and pbufs. Keeps only the method, the path and the few headers
+ * the server acts on (Connection, If-None-Match, Accept-Encoding); request
+ * bodies (Content-Length) are skipped. A request with a Transfer-Encoding
+ * (chunked body) fails with 501, one with an HTTP version other than 1.0
+ * or 1.1 with 505. No allocation, no copy of the request beyond the path
+ * and the ETag.
+ */
+struct http_parser {
+  uint8_t state;                   /**< @brief enum http_parse_state */
+  uint8_t method;                  /**< @brief enum http_method */
+  uint8_t flags;                   /**< @brief HTTP_REQ_* */
+  uint8_t header;                  /**< @brief Header being parsed, index into the header table */
+  uint8_t candidates;              /**< @brief Table entries still matching the current token (bitmask) */
+  uint8_t pos;                     /**< @brief Position in the current token */
+  uint16_t status;                 /**< @brief HTTP status to answer with in HTTP_PARSE_ERROR */
+  uint16_t length;                 /**< @brief Request line and header bytes consumed */
+  uint16_t path_len;               /**< @brief Length of @ref path */
+  uint32_t content_length;         /**< @brief Body bytes left to skip */
+  char path[HTTP_PATH_MAX + 1];    /**< @brief Null-terminated request path */
+  uint8_t etag_len;                /**< @brief Length of @ref etag */
+  char etag[HTTP_ETAG_MAX + 1];    /**< @brief Null-terminated `If-None-Match` value, empty if absent */
+};
+
+/**
+ * @brief Resets the parser for the next request.
+ *
+ * @param parser Parser state.
+ */
+void http_parser_init(struct http_parser *parser);
+
+/**
+ * @brief Feeds request bytes to the parser.
+ *
+ * Stops right after a complete request (HTTP_PARSE_DONE) or an error
+ * (HTTP_PARSE_ERROR); the remaining bytes belong to the next request.
+ *
+ * @param parser Parser state.
+ * @param data Received bytes.
+ * @param len Number of bytes in @p data.
+ * @return Number of bytes consumed.
+ */
+size_t http_parser_feed(struct http_parser *parser, const char *data, size_t len);
+
+/**
+ * @brief Feeds a pbuf chain to the parser, walking the payloads in place.
+ *
+ * @param parser Parser state.
+ * @param p Received pbuf chain.
+ * @return Number of bytes consumed from the start of the chain.
+ */
+u16_t http_parser_feed_pbuf(struct http_parser *parser, const struct pbuf *p);
+
+/**
+ * @brief Checks whether the connection may stay open after this request.
+ *
+ * @param parser Parser state of a complete request.
+ * @return true for HTTP/1.1 without `Connection: close`; HTTP/1.0
+ *         connections are not kept alive.
+ */
+bool http_parser_keep_alive(const struct http_parser *parser);
+
+#endif // __HTTP_PARSER_H__
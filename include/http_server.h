@@ -0,0 +1,60 @@
+#ifndef __HTTP_SERVER_H__
+#define __HTTP_SERVER_H__
+
+#include <stdint.h>
+
+#include "lwip/opt.h"
+
+/**
+ * @brief Keep connections open for further (pipelined) requests.
+ *
+ * 0 restores one request per connection with `Connection: close`.
+ */
+#ifndef HTTP_KEEPALIVE
+#define HTTP_KEEPALIVE 1
+#endif
+
+/**
+ * @brief Size of the connection table.
+ *
+ * One PCB is left for lwIP to accept a new connection with; when the table
+ * is full, the new connection evicts the least recently used idle one.
+ */
+#ifndef HTTP_MAX_CONNS
+#define HTTP_MAX_CONNS (MEMP_NUM_TCP_PCB - 1)
+#endif
+#if HTTP_MAX_CONNS < 1
+#error "HTTP_MAX_CONNS must be at least 1"
+#endif
+
+/**
+ * @brief Close connections without traffic for this long (milliseconds).
+ */
+#ifndef HTTP_IDLE_TIMEOUT_MS
+#define HTTP_IDLE_TIMEOUT_MS 5000
+#endif
+
+/**
+ * @brief Print a serial line per accepted connection, per request, with
+ *        the CPU cycles spent queuing each response, and per closed connection.
+ *
+ * For profiling only: the serial output costs far more than the response.
+ */
+#ifndef HTTP_PROF
+#define HTTP_PROF 0
+#endif
+
+/**
+ * @brief Starts the HTTP server.
+ *
+ * @param port TCP port to listen on.
+ * @return true if the server is listening.
+ */
+bool http_server_start(uint16_t port);
+
+/**
+ * @brief Number of HTTP requests answered since startup.
+ */
+uint32_t http_server_requests(void);
+
+#endif // __HTTP_SERVER_H__
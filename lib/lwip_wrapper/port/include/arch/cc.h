@@ -107,6 +107,64 @@ typedef uintptr_t          mem_ptr_t;
 /* Make lwip/arch.h define the codes which are used throughout */
 #define LWIP_PROVIDE_ERRNO
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Read a free-running cycle counter.
+ *
+ * Used for fine-grained profiling; wraps around at 32 bits.
+ *
+ * @return Current counter value.
+ */
+u32_t sys_cycles(void);
+
+/**
+ * @brief Frequency of the counter returned by sys_cycles().
+ *
+ * @return Counter ticks per second.
+ */
+u32_t sys_cycles_hz(void);
+
+/**
+ * @brief Record how long sys_arch_protect() keeps interrupts disabled.
+ *
+ * Compiled out by default: it adds two sys_cycles() reads to each outermost
+ * critical section, and on Cortex-M0+ sys_cycles() itself reads millis()
+ * and SysTick. Sections entered without sys_arch_protect() (e.g.
+ * noInterrupts()) are not seen.
+ */
+#ifndef SYS_ARCH_IRQ_TIMING
+#define SYS_ARCH_IRQ_TIMING 0
+#endif
+
+/**
+ * @brief Longest interval with interrupts disabled by sys_arch_protect().
+ *
+ * @return Interval in sys_cycles() since startup or the last
+ *         sys_arch_irq_off_reset(), 0 without SYS_ARCH_IRQ_TIMING.
+ */
+u32_t sys_arch_irq_off_max(void);
+
+/**
+ * @brief Clears the value returned by sys_arch_irq_off_max().
+ */
+void sys_arch_irq_off_reset(void);
+
+/**
+ * @brief Sleep until the next interrupt.
+ *
+ * Call inside sys_arch_protect() after checking that no wake-up is pending:
+ * an interrupt raised after the check still ends the sleep, and its handler
+ * runs once the caller restores interrupts.
+ */
+void sys_arch_idle(void);
+
+#ifdef __cplusplus
+}
+#endif
+
 /* Debug facilities. LWIP_DEBUG must be defined to read output */
 #ifdef LWIP_DEBUG
 
@@ -117,7 +175,7 @@ extern "C" {
 /**
  * @brief Print a debug message.
  *
- * Prints a null-terminated string to the debug output.
+ * Queues a null-terminated string for the debug output.
  *
  * @param msg The message string to print.
  */
@@ -126,13 +184,31 @@ void lwip_debug_print(const char *msg);
 /**
  * @brief Print a formatted debug message.
  *
- * Prints a formatted string to the debug output, similar to printf.
+ * Records the format string pointer and binary arguments in a ring buffer,
+ * similar to printf but deferred; see lwip_debug_flush().
  *
- * @param fmt Format string (printf-style).
+ * @param fmt Format string (printf-style), must have static storage.
  * @param ... Variable arguments corresponding to format specifiers.
  */
 void lwip_debug_printf(const char *fmt, ...);
 
+/**
+ * @brief Format and print queued debug records without blocking.
+ *
+ * Call from the idle part of the main loop.
+ *
+ * @param max_records Maximum number of records to format.
+ * @return Number of records formatted.
+ */
+u32_t lwip_debug_flush(u32_t max_records);
+
+/**
+ * @brief Number of debug records dropped because the ring buffer was full.
+ *
+ * @return Total dropped records since startup.
+ */
+u32_t lwip_debug_dropped(void);
+
 /**
  * @brief Handle assertion failures.
  *
@@ -148,7 +224,9 @@ void lwip_assert(const char *msg, const char *file, int line);
 /**
  * @brief Dump raw data in hexadecimal format for debugging.
  *
- * @param label Label to print before dump.
+ * Captures at most LWIP_LOG_DUMP_MAX bytes; printed by lwip_debug_flush().
+ *
+ * @param label Label to print before dump, must have static storage.
  * @param data Pointer to data buffer.
  * @param len Length of data.
  */
@@ -0,0 +1,68 @@
+#ifndef __DHCP_LEASE_H__
+#define __DHCP_LEASE_H__
+
+#include <stdbool.h>
+
+#include "lwip/opt.h"
+#include "lwip/netif.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LWIP_DHCP
+
+/**
+ * @brief Number of interfaces whose lease can be cached, looked up by MAC address.
+ */
+#ifndef DHCP_LEASE_SLOTS
+#define DHCP_LEASE_SLOTS 1
+#endif
+
+/**
+ * @brief Linker section for the cached leases.
+ *
+ * Must not be cleared by the C runtime at startup so the cache survives an
+ * MCU reset; it is lost on power-up, where it fails its checksum.
+ */
+#ifndef DHCP_LEASE_SECTION
+#define DHCP_LEASE_SECTION ".noinit"
+#endif
+
+/**
+ * @brief Cache the address currently supplied by DHCP.
+ *
+ * Call after the interface has been bound, e.g. from the main loop or a
+ * netif status callback. Does nothing if DHCP has not supplied an address.
+ *
+ * @param netif Network interface with a started DHCP client.
+ */
+void dhcp_lease_save(struct netif *netif);
+
+/**
+ * @brief Seed the DHCP client with the cached address of an interface.
+ *
+ * Call right after dhcp_start() while the link is still down. When the link
+ * comes up, lwIP then sends a DHCPREQUEST for the cached address
+ * (INIT-REBOOT) instead of starting with DHCPDISCOVER. A NAK from the server
+ * falls back to the normal DISCOVER exchange.
+ *
+ * @param netif Network interface with a started DHCP client.
+ * @return true if a valid cached lease was applied.
+ */
+bool dhcp_lease_restore(struct netif *netif);
+
+/**
+ * @brief Forget the cached address of an interface.
+ *
+ * @param netif Network interface.
+ */
+void dhcp_lease_clear(struct netif *netif);
+
+#endif /* LWIP_DHCP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DHCP_LEASE_H__
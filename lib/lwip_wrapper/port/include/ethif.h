@@ -17,6 +17,284 @@ extern "C" {
 
 struct ethif_driver;
 
+/**
+ * @brief Enable per-phase timing instrumentation of the driver hot paths.
+ *
+ * Compiled out by default. When enabled, each phase of w5500_rx(), w5500_tx(),
+ * ethif_poll() and ethif_output() is timestamped and accumulated per interface.
+ */
+#ifndef ETHIF_PROF
+#define ETHIF_PROF 0
+#endif
+
+#if ETHIF_PROF
+
+/**
+ * @brief Number of log2 histogram bins per profiled phase.
+ */
+#ifndef ETHIF_PROF_HIST_BINS
+#define ETHIF_PROF_HIST_BINS 16
+#endif
+
+/**
+ * @brief Ticks covered by the first histogram bin, as a power of two.
+ */
+#ifndef ETHIF_PROF_HIST_SHIFT
+#define ETHIF_PROF_HIST_SHIFT 4
+#endif
+
+/**
+ * @enum ethif_prof_phase
+ * @brief Profiled phases of the receive and transmit paths.
+ */
+enum ethif_prof_phase {
+  ETHIF_PROF_RX_RSR = 0,     /**< Stable Sn_RX_RSR double read */
+  ETHIF_PROF_RX_HEADER,      /**< Sn_RX_RD and MACRAW header read */
+  ETHIF_PROF_RX_PAYLOAD,     /**< Payload clock-out */
+  ETHIF_PROF_RX_RECV,        /**< Sn_RX_RD update and Sn_CR RECV polling */
+  ETHIF_PROF_TX_FSR,         /**< Stable Sn_TX_FSR double read */
+  ETHIF_PROF_TX_PAYLOAD,     /**< Sn_SR check, Sn_TX_WR update and payload clock-in */
+  ETHIF_PROF_TX_SEND,        /**< Sn_CR SEND polling */
+  ETHIF_PROF_TX_SENDOK,      /**< Sn_IR SENDOK polling */
+  ETHIF_PROF_POLL_LINK,      /**< PHYCFGR link check */
+  ETHIF_PROF_POLL_INPUT,     /**< lwIP netif->input() */
+  ETHIF_PROF_POLL,           /**< Whole ethif_poll() call */
+  ETHIF_PROF_OUTPUT,         /**< Whole ethif_output() call */
+  ETHIF_PROF_PHASE_COUNT
+};
+
+/**
+ * @struct ethif_prof_stat
+ * @brief Accumulated timing of one profiled phase, in clock ticks.
+ */
+struct ethif_prof_stat {
+  uint32_t count;                         /**< Number of samples */
+  uint32_t min;                           /**< Shortest sample */
+  uint32_t max;                           /**< Longest sample */
+  uint64_t sum;                           /**< Sum of all samples */
+  uint32_t hist[ETHIF_PROF_HIST_BINS];    /**< log2 histogram of samples */
+};
+
+/**
+ * @struct ethif_prof
+ * @brief Timing statistics of all profiled phases of one interface.
+ */
+struct ethif_prof {
+  struct ethif_prof_stat phase[ETHIF_PROF_PHASE_COUNT]; /**< Per-phase statistics */
+};
+
+/**
+ * @brief Read the profiling clock.
+ *
+ * Cortex-M cycle counter on target, CLOCK_MONOTONIC nanoseconds on host.
+ *
+ * @return Current clock value in ticks.
+ */
+uint32_t ethif_prof_now(void);
+
+/**
+ * @brief Frequency of the profiling clock.
+ *
+ * @return Ticks per second.
+ */
+uint32_t ethif_prof_hz(void);
+
+/**
+ * @brief Account the time since @p start to a phase.
+ *
+ * @param prof Statistics to update.
+ * @param phase Profiled phase.
+ * @param start Clock value at the start of the phase.
+ * @return Current clock value, to be used as the start of the next phase.
+ */
+uint32_t ethif_prof_record(struct ethif_prof *prof, enum ethif_prof_phase phase, uint32_t start);
+
+#define ETHIF_PROF_DECL(t)            uint32_t t = ethif_prof_now()
+#define ETHIF_PROF_LAP(s, phase, t)   ((t) = ethif_prof_record(&(s)->prof, (phase), (t)))
+#else
+#define ETHIF_PROF_DECL(t)
+#define ETHIF_PROF_LAP(s, phase, t)
+#endif /* ETHIF_PROF */
+
+/**
+ * @brief Enable pcap capture of frames at the driver boundary.
+ *
+ * Compiled out by default. When enabled, frames passed between lwIP and the
+ * driver can be recorded into a RAM ring buffer in pcap record format.
+ */
+#ifndef ETHIF_PCAP
+#define ETHIF_PCAP 0
+#endif
+
+#if ETHIF_PCAP
+
+/**
+ * @brief Capture direction flags.
+ */
+#define ETHIF_PCAP_RX  0x01   /**< Capture received frames */
+#define ETHIF_PCAP_TX  0x02   /**< Capture transmitted frames */
+
+/**
+ * @struct ethif_pcap
+ * @brief State of a pcap capture attached to an interface.
+ *
+ * The ring buffer holds a stream of pcap records (16-byte record header and
+ * up to @p snaplen bytes of frame data), ready to be appended to a pcap file
+ * after the global header.
+ */
+struct ethif_pcap {
+  uint8_t *buf;                 /**< Ring buffer storage */
+  uint32_t size;                /**< Size of the ring buffer */
+  uint32_t head;                /**< Free-running write offset */
+  uint32_t tail;                /**< Free-running read offset */
+  uint16_t snaplen;             /**< Maximum bytes captured per frame */
+  uint8_t dir;                  /**< ETHIF_PCAP_RX and/or ETHIF_PCAP_TX */
+  uint8_t hdr_pos;              /**< Bytes of the pcap global header already streamed */
+  uint32_t captured;            /**< Frames recorded */
+  uint32_t dropped;             /**< Frames lost because the ring buffer was full */
+  bool (*filter)(const void *frame, size_t len, uint8_t dir, void *arg); /**< Optional filter, true to capture */
+  void *filter_arg;             /**< User argument passed to @p filter */
+#if defined(__linux__) || defined(__APPLE__)
+  void *file;                   /**< Host builds: FILE * written directly, NULL for the ring buffer */
+#endif
+};
+
+#endif /* ETHIF_PCAP */
+
+/**
+ * @brief Enable SPI transaction trace recording and replay.
+ *
+ * Compiled out by default. See ethif_trace_record() and ethif_trace_replay().
+ */
+#ifndef ETHIF_TRACE
+#define ETHIF_TRACE 0
+#endif
+
+#if ETHIF_TRACE
+
+/**
+ * @brief Maximum byte pairs buffered per trace data record.
+ */
+#ifndef ETHIF_TRACE_CHUNK
+#define ETHIF_TRACE_CHUNK 32
+#endif
+
+/**
+ * @struct ethif_trace
+ * @brief SPI trace recorder or replayer interposed on an ethif transport.
+ *
+ * Trace format (little-endian): a header `"W5TR"`, version (1 byte) and the
+ * timestamp clock in Hz (4 bytes), followed by records:
+ * - `'B'` ts(4): chip select asserted
+ * - `'D'` n(1) mosi[n] miso[n]: bytes clocked in this transaction
+ * - `'E'` ts(4): chip select deasserted
+ */
+struct ethif_trace {
+  void *spi;                                   /**< Recording: underlying SPI context */
+  void (*begin)(void *);                       /**< Recording: underlying CS assert */
+  void (*end)(void *);                         /**< Recording: underlying CS deassert */
+  uint8_t (*txn)(void *, uint8_t);             /**< Recording: underlying byte transfer */
+  void (*set_clock)(void *, uint32_t);         /**< Recording: underlying SPI clock control */
+  size_t (*write)(const void *, size_t, void *); /**< Recording: trace sink, returns bytes accepted */
+  void *arg;                                   /**< Recording: user argument passed to @p write */
+  const uint8_t *trace;                        /**< Replay: recorded trace */
+  size_t len;                                  /**< Replay: length of @p trace */
+  size_t pos;                                  /**< Replay: read offset in @p trace */
+  uint8_t chunk;                               /**< Byte pairs buffered (recording) or in the current record (replay) */
+  uint8_t index;                               /**< Replay: byte pairs consumed from the current record */
+  uint8_t mosi[ETHIF_TRACE_CHUNK];             /**< Recording: buffered MOSI bytes */
+  uint8_t miso[ETHIF_TRACE_CHUNK];             /**< Recording: buffered MISO bytes */
+  uint32_t transactions;                       /**< CS assert/deassert cycles */
+  uint32_t bytes;                              /**< Bytes clocked */
+  uint32_t lost;                               /**< Recording: trace bytes rejected by the sink */
+  uint32_t mismatches;                         /**< Replay: MOSI bytes differing from the trace */
+  uint32_t errors;                             /**< Replay: transactions not matching the trace structure */
+  size_t first_mismatch;                       /**< Replay: trace offset of the first MOSI mismatch */
+};
+
+#endif /* ETHIF_TRACE */
+
+/**
+ * @enum ethif_wait_site
+ * @brief Driver call sites that busy-wait with WAIT_OR_FAIL().
+ */
+enum ethif_wait_site {
+  ETHIF_WAIT_RX_RSR = 0,   /**< Stable Sn_RX_RSR read */
+  ETHIF_WAIT_RX_RECV,      /**< Sn_CR clear after RECV */
+  ETHIF_WAIT_TX_FSR,       /**< Stable Sn_TX_FSR read */
+  ETHIF_WAIT_TX_SEND,      /**< Sn_CR clear after SEND */
+  ETHIF_WAIT_TX_SENDOK,    /**< Sn_IR SENDOK/TIMEOUT/DISCON */
+  ETHIF_WAIT_INIT_RST,     /**< MR_RST clear after reset */
+  ETHIF_WAIT_INIT_OPEN,    /**< Sn_CR clear after OPEN */
+  ETHIF_WAIT_SITE_COUNT
+};
+
+/**
+ * @struct ethif_stats
+ * @brief Driver counters, maintained regardless of LWIP_STATS and debug settings.
+ */
+struct ethif_stats {
+  uint32_t rx_frames;                          /**< Frames passed to lwIP */
+  uint32_t rx_bytes;                           /**< Bytes passed to lwIP */
+  uint32_t rx_oversize;                        /**< Frames dropped as larger than PBUF_POOL_BUFSIZE, e.g. full-size frames with LWIP_PROFILE_MIN_RAM */
+  uint32_t rx_nomem;                           /**< pbuf allocation failures, the frame is retried at the next poll */
+  uint32_t rx_input_err;                       /**< Frames rejected by netif->input() */
+  uint32_t rx_class_drops;                     /**< Frames dropped by receive classification */
+  uint32_t tx_frames;                          /**< Frames sent */
+  uint32_t tx_bytes;                           /**< Bytes sent */
+  uint32_t tx_err;                             /**< Frames the driver failed to send */
+  uint32_t tx_nospace;                         /**< Frames rejected for lack of TX buffer space */
+  uint32_t timeouts[ETHIF_WAIT_SITE_COUNT];    /**< WAIT_OR_FAIL() timeouts per call site */
+  uint32_t sn_ir_timeout;                      /**< Sn_IR TIMEOUT events on send */
+  uint32_t sn_ir_discon;                       /**< Sn_IR DISCON events on send */
+  uint32_t unstable_retries;                   /**< Mismatched double reads of Sn_RX_RSR/Sn_TX_FSR */
+  uint32_t link_up;                            /**< Link up transitions */
+  uint32_t link_down;                          /**< Link down transitions */
+  uint32_t spi_transactions;                   /**< SPI chip-select cycles */
+  uint32_t spi_hold_max_cycles;                /**< Longest chip-select cycle (bus held), in sys_cycles(), 0 without ETHIF_SPI_HOLD_TIMING */
+  uint32_t spi_bytes;                          /**< SPI bytes clocked, including 3-byte headers */
+  uint32_t spi_errors;                         /**< Implausible register values or frame headers detected */
+  uint32_t spi_fallbacks;                      /**< SPI clock step-downs after errors */
+  uint32_t spi_step_ups;                       /**< SPI clock step-ups after an error-free period */
+  uint32_t rx_resyncs;                         /**< Socket 0 reopens to resynchronize the RX buffer */
+  uint32_t rx_resync_fails;                    /**< Resyncs that fell back to a full chip reset */
+  uint32_t rx_resync_max_us;                   /**< Longest resync, in microseconds */
+  uint32_t warm_inits;                         /**< Inits that kept the existing chip configuration */
+  uint32_t cold_inits;                         /**< Inits with a chip software reset */
+  uint32_t garp_sent;                          /**< Gratuitous ARPs sent by ethif_poll() */
+};
+
+#if LWIP_ARP
+/**
+ * @brief Number of gratuitous ARPs sent on link up or address change.
+ *
+ * These follow the single announcement lwIP makes itself, so peers and
+ * switches that missed it (e.g. while their port was still coming up)
+ * learn our address without waiting for an ARP round trip.
+ */
+#ifndef ETHIF_GARP_COUNT
+#define ETHIF_GARP_COUNT 2
+#endif
+
+/**
+ * @brief Interval between gratuitous ARPs, in milliseconds.
+ */
+#ifndef ETHIF_GARP_INTERVAL_MS
+#define ETHIF_GARP_INTERVAL_MS 1000
+#endif
+
+#if ETHARP_SUPPORT_STATIC_ENTRIES
+/**
+ * @struct ethif_static_arp
+ * @brief Known peer preloaded into the ARP table by ethif_arp_preload().
+ */
+struct ethif_static_arp {
+  ip4_addr_t ip;            /**< Peer IPv4 address */
+  struct eth_addr mac;      /**< Peer MAC address */
+};
+#endif /* ETHARP_SUPPORT_STATIC_ENTRIES */
+#endif /* LWIP_ARP */
+
 /**
  * @struct ethif
  * @brief Holds private state and function pointers for the Ethernet interface.
@@ -26,8 +304,35 @@ struct ethif {
   void (*begin)(void *);            /**< Function to select SPI slave (assert CS low) */
   void (*end)(void *);              /**< Function to deselect SPI slave (deassert CS high) */
   uint8_t (*txn)(void *, uint8_t);  /**< Function to transmit a byte over SPI and receive a response */
+  void (*set_clock)(void *, uint32_t); /**< Optional function to change the SPI clock in Hz, NULL if fixed */
   struct eth_addr *ethaddr;         /**< MAC address pointer */
   struct ethif_driver * driver;     /**< Pointer to driver-specific context */
+  uint32_t spi_hz;                  /**< SPI clock last selected by ethif_spi_autotune(), 0 if never tuned */
+  const uint32_t *spi_speeds;       /**< Candidate clocks passed to ethif_spi_autotune(), for fallback */
+  size_t spi_speed_count;           /**< Number of entries in spi_speeds */
+  size_t spi_speed_index;           /**< Index of spi_hz in spi_speeds */
+  size_t spi_tuned_index;           /**< Index selected by ethif_spi_autotune(), ceiling for ethif_spi_step_up() */
+  uint32_t spi_step_up_next;        /**< sys_now() from which ethif_spi_step_up() may try a faster clock */
+  uint32_t spi_verify_next;         /**< sys_now() of the next chip version check by the link poll */
+  uint32_t reset_next;              /**< Earliest sys_now() of a cold reset to recover from SPI errors */
+  uint16_t rx_ptr;                  /**< Driver-private read pointer of the peeked frame */
+  uint16_t rx_frame_len;            /**< Driver-private length of the peeked frame, 0 if none */
+  struct ethif_stats stats;         /**< Driver counters */
+#if LWIP_ARP
+  ip4_addr_t announced;             /**< Address last announced by gratuitous ARP */
+  uint8_t garp_left;                /**< Gratuitous ARPs still to send */
+  uint32_t garp_next;               /**< sys_now() at which the next gratuitous ARP is due */
+#if ETHARP_SUPPORT_STATIC_ENTRIES
+  const struct ethif_static_arp *arp_table; /**< Static ARP entries, applied once addressed */
+  size_t arp_count;                 /**< Number of entries in arp_table */
+#endif
+#endif /* LWIP_ARP */
+#if ETHIF_PCAP
+  struct ethif_pcap *pcap;          /**< Active capture, NULL if none */
+#endif
+#if ETHIF_PROF
+  struct ethif_prof prof;           /**< Per-phase timing statistics */
+#endif
 };
 
 /**
@@ -36,11 +341,92 @@ struct ethif {
  */
 struct ethif_driver {
   bool (*init)(struct ethif *);                         /**< Initialize the driver */
-  size_t (*tx)(const void *, size_t, struct ethif *);   /**< Transmit Ethernet frame */
-  size_t (*rx)(void *buf, size_t len, struct ethif *);  /**< Receive Ethernet frame */
+  size_t (*tx)(struct pbuf *, struct ethif *);          /**< Transmit Ethernet frame, walking the pbuf chain */
+  size_t (*rx)(void *buf, size_t len, size_t have, struct ethif *); /**< Receive Ethernet frame; the first @p have bytes are already in buf from peek */
   bool (*poll)(struct ethif *, bool);                   /**< Poll link status, return up/down */
+  size_t (*peek)(void *buf, size_t len, bool *more, struct ethif *); /**< Peek at the next frame header, return frame length */
+  bool (*skip)(struct ethif *);                         /**< Discard the next frame without reading it */
+  bool (*check)(struct ethif *);                        /**< Verify SPI integrity with known register values and buffer readback */
+  bool (*reset)(struct ethif *);                        /**< Cold-reset and initialize the chip, including the PHY */
+  bool (*flush)(struct ethif *);                        /**< Discard every received frame still buffered in the chip */
 };
 
+/**
+ * @brief Allow the driver init to keep an already configured chip.
+ *
+ * When enabled, ethif_init() on a chip that is still configured from before
+ * an MCU reset only re-opens the MACRAW socket and skips PHY renegotiation.
+ * Use ethif_reset() to force a cold reset.
+ */
+#ifndef ETHIF_WARM_INIT
+#define ETHIF_WARM_INIT 1
+#endif
+
+/**
+ * @brief Maximum data bytes per SPI transaction, 0 for unlimited.
+ *
+ * Buffer transfers longer than this are split into several chip-select
+ * cycles at consecutive addresses, so other devices on the SPI bus are
+ * served between chunks instead of waiting for a whole 1514-byte frame.
+ */
+#ifndef ETHIF_SPI_CHUNK
+#define ETHIF_SPI_CHUNK 64
+#endif
+
+/**
+ * @brief Disable all interrupts during each SPI transaction.
+ *
+ * Off by default: bus ownership comes from the begin() callback, whose
+ * SPI.beginTransaction() masks only the interrupt lines registered with
+ * SPI.usingInterrupt(), i.e. those of handlers that share the bus, and
+ * leaves every other interrupt enabled. Set to 1 only for a bus-sharing
+ * handler that cannot be registered that way; every interrupt then waits
+ * for up to one transaction of ETHIF_SPI_CHUNK bytes.
+ */
+#ifndef ETHIF_SPI_PROTECT
+#define ETHIF_SPI_PROTECT 0
+#endif
+
+/**
+ * @brief Record the longest SPI transaction in ethif_stats::spi_hold_max_cycles.
+ *
+ * Compiled out by default like SYS_ARCH_IRQ_TIMING: it adds two
+ * sys_cycles() reads to every transaction. The reads sit outside the
+ * ETHIF_SPI_PROTECT section, so they never lengthen it.
+ */
+#ifndef ETHIF_SPI_HOLD_TIMING
+#define ETHIF_SPI_HOLD_TIMING 0
+#endif
+
+/**
+ * @brief Error-free period after which a lowered SPI clock is raised again, in milliseconds.
+ *
+ * See ethif_spi_step_up(); 0 keeps the clock down for good.
+ */
+#ifndef ETHIF_SPI_STEP_UP_MS
+#define ETHIF_SPI_STEP_UP_MS 60000
+#endif
+
+/**
+ * @brief Interval between chip version checks in the link poll, in milliseconds.
+ *
+ * The link poll otherwise reads only PHYCFGR. After an SPI error the next
+ * poll checks at once.
+ */
+#ifndef ETHIF_SPI_VERIFY_MS
+#define ETHIF_SPI_VERIFY_MS 1000
+#endif
+
+/**
+ * @brief Minimum interval between cold resets triggered by SPI errors, in milliseconds.
+ *
+ * A cold reset renegotiates the PHY; a chip that keeps failing is reset at
+ * most this often instead of on every poll.
+ */
+#ifndef ETHIF_RESET_MIN_INTERVAL_MS
+#define ETHIF_RESET_MIN_INTERVAL_MS 10000
+#endif
+
 /**
  * @brief Maximum number of loop iterations for wait operations.
  */
@@ -65,6 +451,149 @@ struct ethif_driver {
         }                                                   \
     } while(0)
 
+/**
+ * @brief Enable receive classification in ethif_poll().
+ *
+ * When enabled, the header of each pending frame is peeked at and the frame
+ * is assigned to a traffic class with its own per-poll budget, so a burst of
+ * broadcast frames cannot starve ARP and TCP traffic addressed to us.
+ */
+#ifndef ETHIF_RX_CLASSIFY
+#define ETHIF_RX_CLASSIFY 1
+#endif
+
+/**
+ * @brief Maximum number of frames taken from the driver per ethif_poll() call.
+ */
+#ifndef ETHIF_RX_POLL_MAX_FRAMES
+#define ETHIF_RX_POLL_MAX_FRAMES 4
+#endif
+
+/**
+ * @brief Per-poll frame budgets for each receive class.
+ */
+#ifndef ETHIF_RX_BUDGET_ARP
+#define ETHIF_RX_BUDGET_ARP 2
+#endif
+#ifndef ETHIF_RX_BUDGET_TCP
+#define ETHIF_RX_BUDGET_TCP 4
+#endif
+#ifndef ETHIF_RX_BUDGET_UDP
+#define ETHIF_RX_BUDGET_UDP 2
+#endif
+#ifndef ETHIF_RX_BUDGET_BCAST
+#define ETHIF_RX_BUDGET_BCAST 1
+#endif
+#ifndef ETHIF_RX_BUDGET_OTHER
+#define ETHIF_RX_BUDGET_OTHER 1
+#endif
+
+/**
+ * @brief Priority of each receive class (0 is the highest).
+ */
+#ifndef ETHIF_RX_PRIO_ARP
+#define ETHIF_RX_PRIO_ARP 0
+#endif
+#ifndef ETHIF_RX_PRIO_TCP
+#define ETHIF_RX_PRIO_TCP 0
+#endif
+#ifndef ETHIF_RX_PRIO_UDP
+#define ETHIF_RX_PRIO_UDP 1
+#endif
+#ifndef ETHIF_RX_PRIO_BCAST
+#define ETHIF_RX_PRIO_BCAST 2
+#endif
+#ifndef ETHIF_RX_PRIO_OTHER
+#define ETHIF_RX_PRIO_OTHER 2
+#endif
+
+/**
+ * @brief Lowest priority that is still deferred rather than dropped.
+ *
+ * A frame whose class budget is exhausted is discarded without being read
+ * if its priority is numerically greater than this value and other frames
+ * are queued behind it; otherwise it is left for the next ethif_poll() call.
+ */
+#ifndef ETHIF_RX_DEFER_PRIO
+#define ETHIF_RX_DEFER_PRIO 1
+#endif
+
+/**
+ * @enum ethif_rx_class
+ * @brief Receive traffic classes used by ethif_poll().
+ */
+enum ethif_rx_class {
+  ETHIF_RX_CLASS_ARP = 0,  /**< ARP addressed to us */
+  ETHIF_RX_CLASS_TCP,      /**< Unicast IPv4 TCP */
+  ETHIF_RX_CLASS_UDP,      /**< Unicast IPv4 UDP */
+  ETHIF_RX_CLASS_BCAST,    /**< Broadcast and multicast not addressed to us */
+  ETHIF_RX_CLASS_OTHER,    /**< Anything else */
+  ETHIF_RX_CLASS_COUNT
+};
+
+/**
+ * @brief Number of frame bytes needed to classify a received frame.
+ *
+ * Ethernet header (14) + ARP payload up to the target IP (28).
+ */
+#define ETHIF_RX_PEEK_LEN 42
+
+/**
+ * @brief Number of integrity checks that must pass at each SPI clock during autotuning.
+ */
+#ifndef ETHIF_SPI_AUTOTUNE_ROUNDS
+#define ETHIF_SPI_AUTOTUNE_ROUNDS 16
+#endif
+
+/**
+ * @brief Number of steps below the fastest passing clock selected by autotuning.
+ */
+#ifndef ETHIF_SPI_AUTOTUNE_MARGIN
+#define ETHIF_SPI_AUTOTUNE_MARGIN 1
+#endif
+
+/**
+ * @brief Select the fastest reliable SPI clock for an Ethernet interface.
+ *
+ * Ramps the clock through @p speeds, running ETHIF_SPI_AUTOTUNE_ROUNDS
+ * driver integrity checks at each one, and stops at the first speed that
+ * fails. The selected clock is ETHIF_SPI_AUTOTUNE_MARGIN steps below the
+ * fastest passing one, also when every speed passes. Call before
+ * netif_add(); requires @p s->set_clock.
+ * The list is kept for ethif_spi_step_down() and must stay valid.
+ *
+ * @param s Ethernet interface.
+ * @param speeds Candidate SPI clocks in Hz, in ascending order.
+ * @param count Number of entries in @p speeds.
+ * @return Selected clock in Hz, or 0 if even the slowest speed failed
+ *         (the clock is then left at @p speeds[0]).
+ */
+uint32_t ethif_spi_autotune(struct ethif *s, const uint32_t *speeds, size_t count);
+
+/**
+ * @brief Switch to the next slower SPI clock from the autotuning list.
+ *
+ * Called by the driver when it detects SPI errors at runtime. Also restarts
+ * the error-free period of ethif_spi_step_up(), even at the slowest clock.
+ *
+ * @param s Ethernet interface.
+ * @return false if the clock was not tuned or is already the slowest.
+ */
+bool ethif_spi_step_down(struct ethif *s);
+
+/**
+ * @brief Try the next faster SPI clock, up to the autotuned one.
+ *
+ * Does nothing until ETHIF_SPI_STEP_UP_MS have passed since the last
+ * ethif_spi_step_down() or step-up attempt. The faster clock is kept only if
+ * it passes ETHIF_SPI_AUTOTUNE_ROUNDS driver integrity checks. Called by the
+ * driver from its link poll.
+ *
+ * @param s Ethernet interface.
+ * @return true if the clock was raised.
+ */
+bool ethif_spi_step_up(struct ethif *s);
+
 /**
  * @brief Initialize the Ethernet interface with lwIP.
  *
@@ -73,6 +602,17 @@ struct ethif_driver {
  */
 err_t ethif_init(struct netif *netif);
 
+/**
+ * @brief Cold-reset the Ethernet controller, including PHY renegotiation.
+ *
+ * The link goes down until auto-negotiation completes; ethif_poll()
+ * reports the transitions.
+ *
+ * @param netif Pointer to lwIP network interface structure.
+ * @return ERR_OK on success, ERR_IF if the controller did not come up.
+ */
+err_t ethif_reset(struct netif *netif);
+
 /**
  * @brief Poll the Ethernet interface for received frames and link status.
  *
@@ -80,6 +620,186 @@ err_t ethif_init(struct netif *netif);
  */
 void ethif_poll(struct netif *netif);
 
+/**
+ * @brief Poll every Ethernet interface added with ethif_init().
+ *
+ * Every interface is polled once per call, each taking at most
+ * ETHIF_RX_POLL_MAX_FRAMES frames, so one busy interface cannot starve
+ * the others.
+ *
+ * @return Number of received frames passed to lwIP.
+ */
+uint32_t ethif_poll_all(void);
+
+#if LWIP_ARP && ETHARP_SUPPORT_STATIC_ENTRIES
+/**
+ * @brief Preload the ARP table with known peers (gateway, servers).
+ *
+ * Saves the first-packet ARP round trip to these peers. lwIP only accepts
+ * static entries reachable through a configured address, so the table is
+ * applied as soon as the interface has one (immediately if it already
+ * does) and re-applied whenever the address changes.
+ *
+ * @param netif Pointer to lwIP network interface structure.
+ * @param table Static entries, must stay valid.
+ * @param count Number of entries in @p table.
+ */
+void ethif_arp_preload(struct netif *netif, const struct ethif_static_arp *table, size_t count);
+#endif
+
+/**
+ * @brief Take a consistent snapshot of the driver counters.
+ *
+ * May be called at any time; traffic keeps flowing.
+ *
+ * @param netif Pointer to lwIP network interface structure.
+ * @param stats Destination of the snapshot.
+ */
+void ethif_get_stats(struct netif *netif, struct ethif_stats *stats);
+
+/**
+ * @brief Clear the driver counters.
+ *
+ * @param netif Pointer to lwIP network interface structure.
+ */
+void ethif_reset_stats(struct netif *netif);
+
+/**
+ * @brief Serialize the driver counters.
+ *
+ * Emits one `name,value` CSV line per counter, preceded by a `counter,value`
+ * header line, for tracking SPI cost per frame and regressions over time.
+ *
+ * @param netif Pointer to lwIP network interface structure.
+ * @param out Callback receiving each null-terminated line.
+ * @param arg User argument passed to @p out.
+ */
+void ethif_stats_dump(struct netif *netif, void (*out)(const char *line, void *arg), void *arg);
+
+#if ETHIF_PCAP
+/**
+ * @brief Start capturing frames of an interface into a RAM ring buffer.
+ *
+ * @param netif Pointer to lwIP network interface structure.
+ * @param cap Capture state, must stay valid until ethif_pcap_stop().
+ * @param buf Ring buffer storage.
+ * @param size Size of @p buf in bytes.
+ * @param snaplen Maximum bytes captured per frame.
+ * @param dir ETHIF_PCAP_RX and/or ETHIF_PCAP_TX.
+ */
+void ethif_pcap_start(struct netif *netif, struct ethif_pcap *cap, void *buf, size_t size,
+                      uint16_t snaplen, uint8_t dir);
+
+#if defined(__linux__) || defined(__APPLE__)
+/**
+ * @brief Start capturing frames of an interface directly into a pcap file (host builds).
+ *
+ * @param netif Pointer to lwIP network interface structure.
+ * @param cap Capture state, must stay valid until ethif_pcap_stop().
+ * @param path Path of the pcap file to create.
+ * @param snaplen Maximum bytes captured per frame.
+ * @param dir ETHIF_PCAP_RX and/or ETHIF_PCAP_TX.
+ * @return true if the file was created.
+ */
+bool ethif_pcap_open(struct netif *netif, struct ethif_pcap *cap, const char *path,
+                     uint16_t snaplen, uint8_t dir);
+#endif
+
+/**
+ * @brief Stop capturing frames of an interface.
+ *
+ * Records still in the ring buffer remain available to ethif_pcap_drain().
+ *
+ * @param netif Pointer to lwIP network interface structure.
+ */
+void ethif_pcap_stop(struct netif *netif);
+
+/**
+ * @brief Stream captured data out of the ring buffer.
+ *
+ * The first call emits the pcap global header, so the concatenated output
+ * of successive calls is a valid pcap file.
+ *
+ * @param cap Capture state.
+ * @param out Callback receiving a chunk of data, returns the number of bytes accepted.
+ * @param arg User argument passed to @p out.
+ * @return Number of bytes streamed.
+ */
+size_t ethif_pcap_drain(struct ethif_pcap *cap, size_t (*out)(const void *data, size_t len, void *arg), void *arg);
+
+/**
+ * @brief Record a frame if the capture of an interface accepts it.
+ *
+ * Called by ethif.c for every received and transmitted frame. The filter
+ * sees the first pbuf of the chain, which holds at least the Ethernet header.
+ *
+ * @param ethif Ethernet interface.
+ * @param p Frame, possibly a pbuf chain.
+ * @param dir ETHIF_PCAP_RX or ETHIF_PCAP_TX.
+ */
+void ethif_pcap_record(struct ethif *ethif, const struct pbuf *p, uint8_t dir);
+#endif /* ETHIF_PCAP */
+
+#if ETHIF_TRACE
+/**
+ * @brief Start recording every SPI transaction of an Ethernet interface.
+ *
+ * Interposes @p tr on the transport of @p s; the original callbacks keep
+ * driving the bus. Call before the driver is initialized to capture a
+ * trace that can be replayed from reset.
+ *
+ * @param s Ethernet interface.
+ * @param tr Trace state, must stay valid until ethif_trace_stop().
+ * @param write Sink receiving the trace stream, returns bytes accepted.
+ * @param arg User argument passed to @p write.
+ */
+void ethif_trace_record(struct ethif *s, struct ethif_trace *tr,
+                        size_t (*write)(const void *data, size_t len, void *arg), void *arg);
+
+/**
+ * @brief Replace the transport of an Ethernet interface with a recorded trace.
+ *
+ * Each transaction returns the recorded MISO bytes and checks the MOSI
+ * bytes against the trace; differences are counted in @p tr.
+ *
+ * @param s Ethernet interface.
+ * @param tr Trace state.
+ * @param trace Trace produced by ethif_trace_record().
+ * @param len Length of @p trace.
+ * @return false if @p trace has no valid header.
+ */
+bool ethif_trace_replay(struct ethif *s, struct ethif_trace *tr, const void *trace, size_t len);
+
+/**
+ * @brief Stop recording and restore the original transport.
+ *
+ * @param s Ethernet interface.
+ * @param tr Trace state passed to ethif_trace_record().
+ */
+void ethif_trace_stop(struct ethif *s, struct ethif_trace *tr);
+#endif /* ETHIF_TRACE */
+
+#if ETHIF_PROF
+/**
+ * @brief Clear the profiling statistics of an interface.
+ *
+ * @param netif Pointer to lwIP network interface structure.
+ */
+void ethif_prof_reset(struct netif *netif);
+
+/**
+ * @brief Serialize the profiling statistics of an interface.
+ *
+ * Emits one CSV line per phase, preceded by a header line:
+ * `phase,count,min,mean,max,hz,h0,...,hN`, with times in clock ticks.
+ *
+ * @param netif Pointer to lwIP network interface structure.
+ * @param out Callback receiving each null-terminated line.
+ * @param arg User argument passed to @p out.
+ */
+void ethif_prof_dump(struct netif *netif, void (*out)(const char *line, void *arg), void *arg);
+#endif /* ETHIF_PROF */
+
 /**
  * @brief W5500 Ethernet driver instance.
  */
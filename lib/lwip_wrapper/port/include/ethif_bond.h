@@ -0,0 +1,80 @@
+#ifndef __ETHIF_BOND_H__
+#define __ETHIF_BOND_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ethif.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Interval between link checks of the bonded modules, in milliseconds.
+ *
+ * Bounds the failover time: a link loss is acted upon at the next check.
+ */
+#ifndef ETHIF_BOND_MONITOR_MS
+#define ETHIF_BOND_MONITOR_MS 100
+#endif
+
+/**
+ * @struct ethif_bond
+ * @brief Active/backup bond of two Ethernet modules behind one lwIP netif.
+ *
+ * The bond is an ethif driver (ethif_driver_bond) that forwards every call
+ * to the active module. Both modules are programmed with the MAC address of
+ * the netif, so a failover changes neither the MAC nor the IP address: the
+ * netif link stays up as long as one module has a link, DHCP and TCP
+ * connections are not disturbed, and gratuitous ARPs move the switch port
+ * of our MAC to the new module.
+ *
+ * A module whose driver init failed is not ready: its link is ignored, so
+ * traffic never moves to an unconfigured chip, and its init is retried at
+ * most every ETHIF_RESET_MIN_INTERVAL_MS.
+ *
+ * Add it with netif_add(&netif, ..., &bond->ethif, ethif_init, ethernet_input)
+ * after ethif_bond_setup(); tune the SPI clock of each module with
+ * ethif_spi_autotune() on the module itself beforehand.
+ */
+struct ethif_bond {
+  struct ethif ethif;               /**< Interface handed to ethif_init(), must be first */
+  struct ethif *slaves[2];          /**< Primary and backup module */
+  uint8_t active;                   /**< Index in slaves of the module carrying traffic */
+  bool ready[2];                    /**< Module configured by its last driver init or reset */
+  bool link[2];                     /**< Link state of each ready module at the last check */
+  uint32_t init_next;               /**< sys_now() of the next init attempt of a module that is not ready */
+  uint32_t next_check;              /**< sys_now() of the next link check */
+  uint32_t last_up;                 /**< sys_now() of the last check that saw the active link up */
+  uint32_t failovers;               /**< Switches between modules */
+  uint32_t failover_ms;             /**< Time from the last good check to the last switch (upper bound of the outage) */
+};
+
+/**
+ * @brief Ethernet driver of a bond, see struct ethif_bond.
+ */
+extern struct ethif_driver ethif_driver_bond;
+
+/**
+ * @brief Prepares a bond of two modules.
+ *
+ * @param bond Bond to set up.
+ * @param primary Module carrying the traffic while its link is up.
+ * @param backup Module taking over when the primary link is lost.
+ */
+void ethif_bond_setup(struct ethif_bond *bond, struct ethif *primary, struct ethif *backup);
+
+/**
+ * @brief Returns the module currently carrying the traffic.
+ *
+ * @param bond Bond.
+ * @return Active module.
+ */
+struct ethif *ethif_bond_active(const struct ethif_bond *bond);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __ETHIF_BOND_H__
@@ -0,0 +1,47 @@
+#ifndef __FOOTPRINT_H__
+#define __FOOTPRINT_H__
+
+#include <stddef.h>
+
+#include "lwip/opt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Upper bound in bytes for the static RAM of the lwIP pools and heap.
+ *
+ * Checked at compile time against the sizes derived from lwipopts.h;
+ * 0 disables the check.
+ */
+#ifndef LWIP_RAM_BUDGET
+#define LWIP_RAM_BUDGET 0
+#endif
+
+/**
+ * @brief Static RAM reserved by the lwIP memory pools and heap.
+ *
+ * @return Size in bytes, computed from the configured options.
+ */
+size_t footprint_static_bytes(void);
+
+/**
+ * @brief Serialize the lwIP memory usage.
+ *
+ * Emits one CSV line per memory pool and one for the heap, preceded by a
+ * `pool,size,num,bytes,used,max,err` header line and followed by a total.
+ * `size` is the element size, `bytes` the RAM reserved; `used`, `max`
+ * (high-water mark) and `err` (allocation failures) are empty unless
+ * MEMP_STATS / MEM_STATS are enabled.
+ *
+ * @param out Callback receiving each null-terminated line.
+ * @param arg User argument passed to @p out.
+ */
+void footprint_dump(void (*out)(const char *line, void *arg), void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FOOTPRINT_H__
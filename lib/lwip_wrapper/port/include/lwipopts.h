@@ -16,6 +16,9 @@
  *   ensuring dynamic allocations can be satisfied.
  * - Memory pools (MEMP_NUM_*) define counts of internal lwIP structures,
  *   scaled to support configured TCP connections and timers.
+ * - LWIP_PROFILE selects a consistent set of TCP buffer, pbuf pool and connection
+ *   sizes (default, bulk throughput, low latency, minimal RAM); the profile's RAM
+ *   is checked against LWIP_RAM_BUDGET at compile time (see footprint.h).
  * - Debug options selectively enable debug output for DHCP, ICMP, ARP, and network interfaces,
  *   while disabling others to minimize footprint.
  * - LWIP_RAND macro provides a simple random number function, required when NO_SYS=1.
@@ -37,37 +40,89 @@
 #define LWIP_ICMP                      1                /**< @brief Enable ICMP protocol */
 #define LWIP_IPV4                      1                /**< @brief Enable IPv4 support */
 #define LWIP_ARP                       1                /**< @brief Enable ARP support */
+#define ETHARP_SUPPORT_STATIC_ENTRIES  1                /**< @brief Allow ethif_arp_preload() of known peers */
 #define LWIP_ETHERNET                  1                /**< @brief Enable Ethernet support */
 #define LWIP_DHCP                      1                /**< @brief Enable DHCP client */
+#define DHCP_LEASE_SLOTS               2                /**< @brief Cached leases, one per W5500 module (W5500_COUNT in main.cpp) */
 #define LWIP_DNS                       0                /**< @brief Disable DNS support */
 #define LWIP_RAW                       0                /**< @brief Disable RAW API */
 #define LWIP_NETCONN                   0                /**< @brief Disable netconn API */
 #define LWIP_SOCKET                    0                /**< @brief Disable BSD-style socket API */
 #define LWIP_NETIF_LINK_CALLBACK       1                /**< @brief Enable link status callback */
 #define LWIP_NETIF_STATUS_CALLBACK     0                /**< @brief Disable status callback */
+/* Configuration profiles, select one with -D LWIP_PROFILE=<profile> in platformio.ini build_flags */
+#define LWIP_PROFILE_DEFAULT           0                /**< @brief Hand-tuned baseline: 2 x MSS buffers, 3 connections */
+#define LWIP_PROFILE_BULK_THROUGHPUT   1                /**< @brief 4 x MSS window and send buffer for sustained transfers */
+#define LWIP_PROFILE_LOW_LATENCY       2                /**< @brief Minimal buffers, 6 connections, 100 ms TCP timer */
+#define LWIP_PROFILE_MIN_RAM           3                /**< @brief 536-byte MSS and frames, smallest pools */
+#ifndef LWIP_PROFILE
+#define LWIP_PROFILE                   LWIP_PROFILE_DEFAULT
+#endif
 /* TCP configuration */
 #define ETHERNET_MTU                   1500             /**< @brief Standard Ethernet MTU is 1500 */
 #define TCPIP_HEADER_OVERHEAD          (40)             /**< @brief IP header (20 bytes) + TCP header (20 bytes) */
+#define PROTO_HEADER_OVERHEAD          54               /**< @brief Ethernet header (14) + IP header (20) + TCP header (20) */
+#if LWIP_PROFILE == LWIP_PROFILE_DEFAULT
 #define TCP_MSS                        (ETHERNET_MTU - TCPIP_HEADER_OVERHEAD)  /**< @brief Max TCP segment size (1460 bytes) */
 #define TCP_SND_BUF                    (2 * TCP_MSS)    /**< @brief TCP send buffer size in bytes */
 #define TCP_WND                        (2 * TCP_MSS)    /**< @brief TCP receive window size in bytes */
 #define TCP_SND_QUEUELEN               6                /**< @brief TCP send queue length (segments) */
-#define MEMP_NUM_TCP_SEG               TCP_SND_QUEUELEN /**< @brief Number of TCP segments, must be >= TCP_SND_QUEUELEN */
-/* PBUF pool configuration */
 #define PBUF_POOL_SIZE                 4                /**< @brief Number of packet buffers in pool */
-#define PROTO_HEADER_OVERHEAD          54               /**< @brief Ethernet header (14) + IP header (20) + TCP header (20) */
 #define PBUF_POOL_BUFSIZE              (TCP_SND_BUF + PROTO_HEADER_OVERHEAD) /**< @brief Size of each pbuf buffer (bytes) */
+#define MEMP_NUM_TCP_PCB               3                /**< @brief Number of active TCP connections */
+#elif LWIP_PROFILE == LWIP_PROFILE_BULK_THROUGHPUT
+#define TCP_MSS                        (ETHERNET_MTU - TCPIP_HEADER_OVERHEAD)  /**< @brief Max TCP segment size (1460 bytes) */
+#define TCP_SND_BUF                    (4 * TCP_MSS)    /**< @brief Four segments in flight before waiting for an ACK */
+#define TCP_WND                        (4 * TCP_MSS)    /**< @brief Must fit in PBUF_POOL_SIZE frames */
+#define TCP_SND_QUEUELEN               (2 * TCP_SND_BUF / TCP_MSS) /**< @brief lwIP minimum for TCP_SND_BUF */
+#define PBUF_POOL_SIZE                 6                /**< @brief Full window plus two frames of headroom */
+#define PBUF_POOL_BUFSIZE              (TCP_MSS + PROTO_HEADER_OVERHEAD) /**< @brief One full-size frame per pbuf */
+#define MEMP_NUM_TCP_PCB               2                /**< @brief Few connections, each with large buffers */
+#elif LWIP_PROFILE == LWIP_PROFILE_LOW_LATENCY
+#define TCP_MSS                        (ETHERNET_MTU - TCPIP_HEADER_OVERHEAD)  /**< @brief Max TCP segment size (1460 bytes) */
+#define TCP_SND_BUF                    (2 * TCP_MSS)    /**< @brief lwIP minimum, responses are small */
+#define TCP_WND                        (2 * TCP_MSS)    /**< @brief Requests are small */
+#define TCP_SND_QUEUELEN               6                /**< @brief Must exceed the default TCP_SNDQUEUELOWAT of 5 */
+#define PBUF_POOL_SIZE                 6                /**< @brief One frame per connection in flight */
+#define PBUF_POOL_BUFSIZE              (TCP_MSS + PROTO_HEADER_OVERHEAD) /**< @brief One full-size frame per pbuf */
+#define MEMP_NUM_TCP_PCB               6                /**< @brief Concurrent short-lived connections */
+#define TCP_TMR_INTERVAL               100              /**< @brief Send delayed ACKs after 100 ms instead of 250 ms */
+#elif LWIP_PROFILE == LWIP_PROFILE_MIN_RAM
+#define TCP_MSS                        536              /**< @brief IPv4 default MSS, peers send small segments */
+#define TCP_SND_BUF                    (2 * TCP_MSS)    /**< @brief lwIP minimum */
+#define TCP_WND                        (2 * TCP_MSS)    /**< @brief Two segments in flight */
+#define TCP_SND_QUEUELEN               6                /**< @brief Must exceed the default TCP_SNDQUEUELOWAT of 5 */
+#define PBUF_POOL_SIZE                 3                /**< @brief Receive window plus one frame */
+#define PBUF_POOL_BUFSIZE              (TCP_MSS + PROTO_HEADER_OVERHEAD) /**< @brief Larger frames are dropped by the driver, counted as rx_oversize */
+#define MEMP_NUM_TCP_PCB               2                /**< @brief One connection plus one in TIME_WAIT */
+#else
+#error "Unknown LWIP_PROFILE"
+#endif
+#define MEMP_NUM_TCP_SEG               TCP_SND_QUEUELEN /**< @brief Number of TCP segments, must be >= TCP_SND_QUEUELEN */
 /* Memory alignment and heap size */
 #define MEM_ALIGNMENT                  4                /**< @brief Memory alignment (bytes) */
 #define MEM_SIZE                       (1024 + TCP_SND_BUF + PROTO_HEADER_OVERHEAD) /**< @brief Heap size for dynamic allocations, must be > TCP_SND_BUF */
 /* Memory pools (static allocations) */
-#define MEMP_NUM_PBUF                  (PBUF_POOL_SIZE) /**< @brief Number of pbuf metadata structs */
-#define MEMP_NUM_TCP_PCB               3                /**< @brief Number of active TCP connections */
+#define MEMP_NUM_PBUF                  (TCP_SND_QUEUELEN) /**< @brief Number of ROM pbufs, one per queued segment of flash content */
 #define MEMP_NUM_SYS_TIMEOUT           (4 + 4*MEMP_NUM_TCP_PCB + LWIP_NUM_SYS_TIMEOUT_INTERNAL) /**< @brief Number of simultaneous system timers */
+/* Memory footprint (see footprint.h) */
+#define LWIP_RAM_BUDGET                (22 * 1024)      /**< @brief Compile-time limit for pools + heap (bytes), of the SAMD21's 32 KB */
 /* Ethernet + netif settings */
 #define ETH_PAD_SIZE                   0                /**< @brief Ethernet padding size */
+/* Statistics: heap and pool counters for footprint_dump() high-water marks, link counters fed by ethif.c */
+#define LWIP_STATS                     1
+#define LWIP_STATS_DISPLAY             0
+#define MEM_STATS                      1
+#define MEMP_STATS                     1
+#define LINK_STATS                     1
+#define ETHARP_STATS                   0
+#define IP_STATS                       0
+#define IPFRAG_STATS                   0
+#define ICMP_STATS                     0
+#define UDP_STATS                      0
+#define TCP_STATS                      0
+#define SYS_STATS                      0
 /* Debugging (disabled for minimal footprint) */
-#define LWIP_STATS                     0
 #define LWIP_DEBUG                     LWIP_DBG_ON
 #define LWIP_DBG_MIN_LEVEL             LWIP_DBG_LEVEL_ALL
 #define UDP_DEBUG                      LWIP_DBG_OFF
@@ -81,9 +136,24 @@
 #define PBUF_DEBUG                     LWIP_DBG_OFF
 #define MEM_DEBUG                      LWIP_DBG_OFF
 #define SYS_DEBUG                      LWIP_DBG_OFF
+/* Deferred debug output, drained by lwip_debug_flush() from the main loop */
+#define LWIP_LOG_RING_SIZE             32               /**< @brief Number of queued log records (power of two) */
+#define LWIP_LOG_RECORD_DATA           28               /**< @brief Bytes of arguments per log record */
+#define LWIP_LOG_DUMP_MAX              64               /**< @brief Bytes captured per hex dump */
 /* Custom driver debugging (disabled for minimal footprint) */
 #define ETHIF_DEBUG                    LWIP_DBG_OFF
-#define ETHIF_TX_DUMP_DEBUG            LWIP_DBG_OFF
-#define ETHIF_RX_DUMP_DEBUG            LWIP_DBG_OFF
+/* Custom driver frame capture (compiled out for minimal footprint) */
+#define ETHIF_PCAP                     0                /**< @brief pcap capture of RX/TX frames, see ethif_pcap_start() */
+#define ETHIF_TRACE                    0                /**< @brief SPI transaction trace record/replay, see ethif_trace_record() */
+/* Custom driver profiling (compiled out for minimal footprint) */
+#define ETHIF_PROF                     0                /**< @brief Per-phase timing of driver RX/TX paths */
+/* Custom driver receive classification (see ethif.h for budgets and priorities) */
+#define ETHIF_RX_CLASSIFY              1                /**< @brief Peek and classify frames, budget per class */
+#define ETHIF_RX_POLL_MAX_FRAMES       4                /**< @brief Frames handled per ethif_poll() call */
+/* Custom driver init */
+#define ETHIF_WARM_INIT                1                /**< @brief Keep a configured chip across MCU resets, see ethif_reset() */
+/* Custom driver SPI bus sharing */
+#define ETHIF_SPI_CHUNK                64               /**< @brief Data bytes per SPI transaction, bounds the bus hold time */
+#define ETHIF_SPI_PROTECT              0                /**< @brief Mask all interrupts per SPI transaction, 1 only if a bus ISR cannot use SPI.usingInterrupt() */
 
 #endif // __LWIPOPTS_H__
@@ -0,0 +1,86 @@
+#ifndef __NETSCHED_H__
+#define __NETSCHED_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lwip/opt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Longest idle sleep between two ethif_poll() calls, in milliseconds.
+ *
+ * Bounds the receive latency while the W5500 interrupt line is not wired to
+ * netsched_notify(); with it wired, this can be raised up to the lwIP timer
+ * deadlines, which always end the sleep.
+ */
+#ifndef NETSCHED_POLL_MS
+#define NETSCHED_POLL_MS 2
+#endif
+
+/**
+ * @struct netsched_stats
+ * @brief Main loop activity, for the duty cycle.
+ */
+struct netsched_stats {
+  uint32_t loops;               /**< netsched_run() calls */
+  uint32_t sleeps;              /**< Idle sleeps */
+  uint32_t notified;            /**< Sleeps ended early by netsched_notify() */
+  uint64_t busy_cycles;         /**< sys_cycles() spent outside idle sleep */
+  uint64_t sleep_cycles;        /**< sys_cycles() spent in idle sleep */
+};
+
+/**
+ * @brief Runs one main loop iteration of the network stack.
+ *
+ * Unless the previous iteration received frames or a wake-up is pending, first
+ * sleeps the MCU (sys_arch_idle()) until the next lwIP timer deadline
+ * (sys_timeouts_sleeptime()), at most NETSCHED_POLL_MS, or until
+ * netsched_notify(). Then polls every Ethernet interface (ethif_poll_all())
+ * and runs the due lwIP timers. Replaces calling ethif_poll() and
+ * sys_check_timeouts() from loop(); application work done after it in the
+ * same loop counts as busy time.
+ */
+void netsched_run(void);
+
+/**
+ * @brief Ends the current or next idle sleep.
+ *
+ * Safe to call from an interrupt handler, e.g. on the falling edge of the
+ * W5500 INTn pin.
+ */
+void netsched_notify(void);
+
+/**
+ * @brief Reads the main loop activity counters.
+ *
+ * @param stats Receives a copy of the counters.
+ */
+void netsched_get_stats(struct netsched_stats *stats);
+
+/**
+ * @brief Clears the main loop activity counters and sys_arch_irq_off_max().
+ */
+void netsched_reset_stats(void);
+
+/**
+ * @brief Serialize the duty cycle.
+ *
+ * Emits a `loops,sleeps,notified,busy_ms,sleep_ms,duty_pct,irq_off_max_us`
+ * header line and one line of values since startup or the last
+ * netsched_reset_stats(); irq_off_max_us is the longest interrupts-off
+ * interval of sys_arch_protect() (SYS_ARCH_IRQ_TIMING).
+ *
+ * @param out Callback receiving each null-terminated line.
+ * @param arg User argument passed to @p out.
+ */
+void netsched_dump(void (*out)(const char *line, void *arg), void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __NETSCHED_H__
@@ -0,0 +1,128 @@
+#ifndef __TCP_STREAM_H__
+#define __TCP_STREAM_H__
+
+#include <stdbool.h>
+
+#include "lwip/opt.h"
+#include "lwip/tcp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LWIP_TCP
+
+/**
+ * @brief Number of sources a stream can hold queued at once.
+ */
+#ifndef TCP_STREAM_QUEUE_LEN
+#define TCP_STREAM_QUEUE_LEN 4
+#endif
+
+#define TCP_STREAM_FLAG_COPY  0x01 /**< @brief Data is only valid during the producer call, copy it into lwIP */
+
+/**
+ * @brief Producer of the data of one stream source.
+ *
+ * Called whenever the send buffer has room for the next chunk. The data of
+ * a source without TCP_STREAM_FLAG_COPY is passed to lwIP by reference and
+ * must stay valid until it is acknowledged.
+ *
+ * @param arg Source argument given to tcp_stream_push().
+ * @param offset Offset of the chunk in the source (bytes).
+ * @param data Set to the chunk.
+ * @param max Maximum chunk length.
+ * @return Chunk length (at most @p max), or 0 if no data is available yet;
+ *         the producer is asked again at the next tcp_stream_pump().
+ */
+typedef u16_t (*tcp_stream_produce_fn)(void *arg, u32_t offset, const void **data, u16_t max);
+
+/**
+ * @brief A queued source of known length.
+ */
+struct tcp_stream_source {
+  tcp_stream_produce_fn produce;        /**< @brief Producer */
+  void *arg;                            /**< @brief Producer argument */
+  u32_t len;                            /**< @brief Total length (bytes) */
+  u8_t flags;                           /**< @brief TCP_STREAM_FLAG_* */
+};
+
+/**
+ * @brief Send queue of a TCP connection for payloads larger than its send buffer.
+ *
+ * Sources are sent in order. Each tcp_stream_pump() hands lwIP as many
+ * chunks as tcp_sndbuf() and TCP_SND_QUEUELEN allow. The first chunk
+ * completes the last unsent segment (e.g. behind a response head written
+ * with tcp_write()) and the others are one MSS each, shorter only at the
+ * end of a source, so every chunk (one pbuf) ends a full segment. Call it
+ * after queuing sources and from the tcp_sent() and tcp_poll() callbacks.
+ */
+struct tcp_stream {
+  struct tcp_pcb *pcb;                  /**< @brief Connection */
+  struct tcp_stream_source queue[TCP_STREAM_QUEUE_LEN]; /**< @brief Ring of pending sources */
+  u8_t head;                            /**< @brief Index of the source being sent */
+  u8_t count;                           /**< @brief Number of pending sources */
+  u32_t offset;                         /**< @brief Bytes of the head source queued so far */
+};
+
+/**
+ * @brief Resets a stream, dropping every pending source.
+ *
+ * @param stream Stream.
+ * @param pcb Connection to send on.
+ */
+void tcp_stream_init(struct tcp_stream *stream, struct tcp_pcb *pcb);
+
+/**
+ * @brief Queues a source behind the pending ones.
+ *
+ * @param stream Stream.
+ * @param produce Producer of the source data.
+ * @param arg Producer argument.
+ * @param len Total length of the source (bytes).
+ * @param flags TCP_STREAM_FLAG_*.
+ * @return ERR_OK, or ERR_MEM if TCP_STREAM_QUEUE_LEN sources are pending.
+ */
+err_t tcp_stream_push(struct tcp_stream *stream, tcp_stream_produce_fn produce, void *arg, u32_t len, u8_t flags);
+
+/**
+ * @brief Queues a buffer behind the pending sources.
+ *
+ * Without TCP_STREAM_FLAG_COPY the buffer is sent by reference and must stay
+ * valid until acknowledged (e.g. const data in flash); with it, the buffer
+ * must stay valid until it has been fully pumped.
+ *
+ * @param stream Stream.
+ * @param data Buffer.
+ * @param len Length of @p data (bytes).
+ * @param flags TCP_STREAM_FLAG_*.
+ * @return ERR_OK, or ERR_MEM if TCP_STREAM_QUEUE_LEN sources are pending.
+ */
+err_t tcp_stream_push_buf(struct tcp_stream *stream, const void *data, u32_t len, u8_t flags);
+
+/**
+ * @brief Hands lwIP as much pending data as the send buffer takes.
+ *
+ * Does not call tcp_output().
+ *
+ * @param stream Stream.
+ * @param queued Incremented by the number of bytes handed to lwIP; may be NULL.
+ * @return ERR_OK (also when the send buffer is full), or the tcp_write() error.
+ */
+err_t tcp_stream_pump(struct tcp_stream *stream, u32_t *queued);
+
+/**
+ * @brief Checks whether sources are still pending.
+ *
+ * @param stream Stream.
+ * @return true if not all data has been handed to lwIP yet.
+ */
+bool tcp_stream_pending(const struct tcp_stream *stream);
+
+#endif /* LWIP_TCP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __TCP_STREAM_H__
@@ -0,0 +1,138 @@
+/**
+ * @file
+ * @brief DHCP lease persistence across MCU resets.
+ *
+ * The address of the last bound lease is kept in a RAM section that the C
+ * runtime leaves alone at startup. After a reset it is handed back to the
+ * lwIP DHCP client, which then rebinds with INIT-REBOOT as soon as the link
+ * comes up.
+ */
+
+#include "lwip/opt.h"
+
+#if LWIP_DHCP
+
+#include <stddef.h>
+#include <string.h>
+
+#include "lwip/dhcp.h"
+#include "lwip/prot/dhcp.h"
+#include "lwip/inet_chksum.h"
+
+#include "dhcp_lease.h"
+
+#define DHCP_LEASE_MAGIC 0x4C454153UL   /**< "LEAS" */
+
+/**
+ * @brief Cached lease of one interface.
+ */
+struct dhcp_lease {
+  u32_t magic;                          /**< DHCP_LEASE_MAGIC if the slot is in use */
+  u8_t hwaddr[NETIF_MAX_HWADDR_LEN];    /**< MAC address of the interface */
+  ip4_addr_t addr;                      /**< Leased address */
+  u16_t chksum;                         /**< inet_chksum() over the fields above */
+};
+
+static struct dhcp_lease dhcp_leases[DHCP_LEASE_SLOTS] __attribute__((section(DHCP_LEASE_SECTION)));
+
+/**
+ * @brief Checksum of a cached lease, excluding the checksum field itself.
+ */
+static u16_t dhcp_lease_chksum(const struct dhcp_lease *lease)
+{
+  return inet_chksum((void *)lease, offsetof(struct dhcp_lease, chksum));
+}
+
+/**
+ * @brief Finds the valid cached lease of an interface.
+ *
+ * @return The slot, or NULL if there is none.
+ */
+static struct dhcp_lease *dhcp_lease_find(struct netif *netif)
+{
+  for (int i = 0; i < DHCP_LEASE_SLOTS; i++) {
+    struct dhcp_lease *lease = &dhcp_leases[i];
+    if (lease->magic == DHCP_LEASE_MAGIC &&
+        lease->chksum == dhcp_lease_chksum(lease) &&
+        memcmp(lease->hwaddr, netif->hwaddr, sizeof(lease->hwaddr)) == 0) {
+      return lease;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Caches the address currently supplied by DHCP.
+ *
+ * @param netif Network interface.
+ */
+void dhcp_lease_save(struct netif *netif)
+{
+  if (!dhcp_supplied_address(netif)) {
+    return;
+  }
+
+  struct dhcp_lease *lease = dhcp_lease_find(netif);
+  for (int i = 0; lease == NULL && i < DHCP_LEASE_SLOTS; i++) {
+    if (dhcp_leases[i].magic != DHCP_LEASE_MAGIC || dhcp_leases[i].chksum != dhcp_lease_chksum(&dhcp_leases[i])) {
+      lease = &dhcp_leases[i];
+    }
+  }
+  if (lease == NULL) {
+    /* All slots taken by other interfaces: reuse the first one */
+    lease = &dhcp_leases[0];
+  }
+
+  memset(lease, 0, sizeof(*lease));
+  lease->magic = DHCP_LEASE_MAGIC;
+  memcpy(lease->hwaddr, netif->hwaddr, sizeof(lease->hwaddr));
+  ip4_addr_copy(lease->addr, *netif_ip4_addr(netif));
+  lease->chksum = dhcp_lease_chksum(lease);
+
+  LWIP_DEBUGF(DHCP_DEBUG | LWIP_DBG_TRACE, ("dhcp_lease_save: cached %s\n", ip4addr_ntoa(&lease->addr)));
+}
+
+/**
+ * @brief Seeds the DHCP client with the cached address of an interface.
+ *
+ * @param netif Network interface.
+ * @return true if a cached lease was applied.
+ */
+bool dhcp_lease_restore(struct netif *netif)
+{
+  struct dhcp *dhcp = netif_dhcp_data(netif);
+  struct dhcp_lease *lease = dhcp_lease_find(netif);
+
+  if (dhcp == NULL || lease == NULL) {
+    return false;
+  }
+
+  if (netif_is_link_up(netif) || dhcp->state != DHCP_STATE_INIT) {
+    /* Too late: dhcp_start() has already sent DHCPDISCOVER */
+    LWIP_DEBUGF(DHCP_DEBUG | LWIP_DBG_LEVEL_WARNING, ("dhcp_lease_restore: DHCP already running\n"));
+    return false;
+  }
+
+  /* dhcp_network_changed() on link up sends a DHCPREQUEST for offered_ip_addr in this state */
+  ip4_addr_copy(dhcp->offered_ip_addr, lease->addr);
+  dhcp->state = DHCP_STATE_REBOOTING;
+  dhcp->tries = 0;
+
+  LWIP_DEBUGF(DHCP_DEBUG | LWIP_DBG_TRACE, ("dhcp_lease_restore: INIT-REBOOT with %s\n", ip4addr_ntoa(&lease->addr)));
+  return true;
+}
+
+/**
+ * @brief Forgets the cached address of an interface.
+ *
+ * @param netif Network interface.
+ */
+void dhcp_lease_clear(struct netif *netif)
+{
+  struct dhcp_lease *lease = dhcp_lease_find(netif);
+  if (lease != NULL) {
+    memset(lease, 0, sizeof(*lease));
+  }
+}
+
+#endif /* LWIP_DHCP */
@@ -10,11 +10,16 @@
 #include "lwip/mem.h"
 #include "lwip/pbuf.h"
 #include "lwip/stats.h"
+#include "lwip/sys.h"
 #include "lwip/snmp.h"
 #include "lwip/ethip6.h"
 #include "lwip/etharp.h"
+#include "lwip/prot/ip.h"
 #include "netif/ppp/pppoe.h"
 
+#include <stdio.h>
+#include <string.h>
+
 #include "ethif.h"
 
 /* Define those to better describe your network interface. */
@@ -22,12 +27,195 @@
 #define IFNAME1 'n'
 
 
+#if ETHIF_RX_CLASSIFY
+/**
+ * @brief Per-class receive policy: frames per poll and priority.
+ */
+static const struct {
+  uint8_t budget;
+  uint8_t prio;
+} ethif_rx_policy[ETHIF_RX_CLASS_COUNT] = {
+  { ETHIF_RX_BUDGET_ARP,   ETHIF_RX_PRIO_ARP   },
+  { ETHIF_RX_BUDGET_TCP,   ETHIF_RX_PRIO_TCP   },
+  { ETHIF_RX_BUDGET_UDP,   ETHIF_RX_PRIO_UDP   },
+  { ETHIF_RX_BUDGET_BCAST, ETHIF_RX_PRIO_BCAST },
+  { ETHIF_RX_BUDGET_OTHER, ETHIF_RX_PRIO_OTHER },
+};
+
+/**
+ * @brief Classifies a received frame from its leading bytes.
+ *
+ * @param netif lwIP network interface the frame arrived on.
+ * @param hdr Leading bytes of the Ethernet frame.
+ * @param len Number of valid bytes in @p hdr.
+ * @return Receive class of the frame.
+ */
+static enum ethif_rx_class ethif_rx_classify(struct netif *netif, const uint8_t *hdr, size_t len)
+{
+  if (len < SIZEOF_ETH_HDR) {
+    return ETHIF_RX_CLASS_OTHER;
+  }
+
+  bool group = (hdr[0] & 0x01) != 0;
+  uint16_t type = ((uint16_t)hdr[12] << 8) | hdr[13];
+
+  if (type == ETHTYPE_ARP) {
+    /* ARP target protocol address sits at offset 24 of the ARP payload */
+    if (!group || (len >= ETHIF_RX_PEEK_LEN &&
+                   memcmp(&hdr[SIZEOF_ETH_HDR + 24], netif_ip4_addr(netif), 4) == 0)) {
+      return ETHIF_RX_CLASS_ARP;
+    }
+    return ETHIF_RX_CLASS_BCAST;
+  }
+
+  if (group) {
+    return ETHIF_RX_CLASS_BCAST;
+  }
+
+  if (type == ETHTYPE_IP && len >= SIZEOF_ETH_HDR + 10) {
+    switch (hdr[SIZEOF_ETH_HDR + 9]) {
+      case IP_PROTO_TCP: return ETHIF_RX_CLASS_TCP;
+      case IP_PROTO_UDP: return ETHIF_RX_CLASS_UDP;
+      default: break;
+    }
+  }
+  return ETHIF_RX_CLASS_OTHER;
+}
+#endif /* ETHIF_RX_CLASSIFY */
+
+/**
+ * @brief Receives one frame from the driver and passes it to lwIP.
+ *
+ * The header bytes already peeked for classification are copied into the
+ * pbuf instead of being clocked out of the chip a second time.
+ *
+ * @param netif lwIP network interface.
+ * @param hdr Leading bytes of the frame from driver->peek(), NULL if none.
+ * @param have Number of bytes in @p hdr.
+ * @return true if a frame was passed up the stack.
+ */
+static bool ethif_input(struct netif *netif, const uint8_t *hdr, size_t have)
+{
+  struct ethif *ethif = (struct ethif *)netif->state;
+  struct ethif_driver *driver = (struct ethif_driver *)ethif->driver;
+
+  struct pbuf *p = pbuf_alloc(PBUF_RAW, PBUF_POOL_BUFSIZE, PBUF_POOL);
+  if (p && p->next == NULL) {
+    if (have > p->len) {
+      have = p->len;
+    }
+    if (have > 0) {
+      memcpy(p->payload, hdr, have);
+    }
+    size_t len = driver->rx(p->payload, p->len, have, ethif);
+    if (len > 0) {
+      p->len = p->tot_len = len;
+      LWIP_DEBUGF(ETHIF_DEBUG, ("ethif_poll: received %u bytes\n", len));
+
+      ethif->stats.rx_frames++;
+      ethif->stats.rx_bytes += len;
+#if ETHIF_PCAP
+      ethif_pcap_record(ethif, p, ETHIF_PCAP_RX);
+#endif
+      LINK_STATS_INC(link.recv);
+      MIB2_STATS_NETIF_ADD(netif, ifinoctets, len);
+      if ((((const uint8_t *)p->payload)[0] & 0x01) == 0) {
+        MIB2_STATS_NETIF_INC(netif, ifinucastpkts);
+      } else {
+        MIB2_STATS_NETIF_INC(netif, ifinnucastpkts);
+      }
+
+      ETHIF_PROF_DECL(t);
+      err_t err = netif->input(p, netif);
+      ETHIF_PROF_LAP(ethif, ETHIF_PROF_POLL_INPUT, t);
+      if (err == ERR_OK) return true;
+
+      ethif->stats.rx_input_err++;
+      LINK_STATS_INC(link.drop);
+      MIB2_STATS_NETIF_INC(netif, ifindiscards);
+      LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SERIOUS, ("ethif_poll: netif->input() failed\n"));
+    }
+    pbuf_free(p);
+  } else {
+    ethif->stats.rx_nomem++;
+    LINK_STATS_INC(link.memerr);
+    LINK_STATS_INC(link.drop);
+    if (p) {
+      pbuf_free(p);  // Free if it's chained or failed
+      LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SERIOUS, ("pbuf_alloc failed or chained pbuf not supported!\n"));
+    }
+  }
+  return false;
+}
+
+#if LWIP_ARP
+#if ETHARP_SUPPORT_STATIC_ENTRIES
+/**
+ * @brief Adds the preloaded static entries to the lwIP ARP table.
+ *
+ * @param ethif Ethernet interface holding the table.
+ */
+static void ethif_arp_apply(struct ethif *ethif)
+{
+  for (size_t i = 0; i < ethif->arp_count; i++) {
+    err_t err = etharp_add_static_entry(&ethif->arp_table[i].ip, (struct eth_addr *)&ethif->arp_table[i].mac);
+    if (err != ERR_OK) {
+      LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_WARNING,
+                  ("ethif_arp_apply: static entry %s rejected (%d)\n", ip4addr_ntoa(&ethif->arp_table[i].ip), (int)err));
+    }
+  }
+}
+#endif /* ETHARP_SUPPORT_STATIC_ENTRIES */
+
+/**
+ * @brief Announces the interface address and applies static ARP entries.
+ *
+ * On link up or a new address, the static ARP table is (re)applied and
+ * ETHIF_GARP_COUNT gratuitous ARPs are scheduled ETHIF_GARP_INTERVAL_MS
+ * apart; lwIP itself sends the first announcement immediately.
+ *
+ * @param netif lwIP network interface.
+ * @param ethif Ethernet interface.
+ * @param link_came_up true if the link went up during this poll.
+ */
+static void ethif_arp_update(struct netif *netif, struct ethif *ethif, bool link_came_up)
+{
+  if (!netif_is_up(netif) || !netif_is_link_up(netif) || ip4_addr_isany_val(*netif_ip4_addr(netif))) {
+    return;
+  }
+
+  if (link_came_up || !ip4_addr_cmp(&ethif->announced, netif_ip4_addr(netif))) {
+    ip4_addr_copy(ethif->announced, *netif_ip4_addr(netif));
+#if ETHARP_SUPPORT_STATIC_ENTRIES
+    ethif_arp_apply(ethif);
+#endif
+    ethif->garp_left = ETHIF_GARP_COUNT;
+    ethif->garp_next = sys_now() + ETHIF_GARP_INTERVAL_MS;
+  }
+
+  if (ethif->garp_left > 0 && (int32_t)(sys_now() - ethif->garp_next) >= 0) {
+    LWIP_DEBUGF(ETHIF_DEBUG, ("ethif_poll: gratuitous ARP for %s\n", ip4addr_ntoa(netif_ip4_addr(netif))));
+    etharp_gratuitous(netif);
+    ethif->stats.garp_sent++;
+    ethif->garp_left--;
+    ethif->garp_next += ETHIF_GARP_INTERVAL_MS;
+  }
+}
+#endif /* LWIP_ARP */
+
 /**
  * @brief Polls the Ethernet interface for link status and incoming packets.
  *
- * Checks link state and receives a frame if available. Uses lwIP's `netif->input`
+ * Checks link state and receives pending frames. Uses lwIP's `netif->input`
  * function to pass packets up the stack.
  *
+ * With ETHIF_RX_CLASSIFY, up to ETHIF_RX_POLL_MAX_FRAMES frames are taken per
+ * call. The W5500 RX buffer is a FIFO, so frames cannot be reordered; instead
+ * each class has a per-poll budget, and low priority frames over budget are
+ * discarded without clocking out their payload when traffic is queued behind
+ * them, so ACKs and ARP replies addressed to us are not stuck behind a
+ * broadcast storm.
+ *
  * @param netif Pointer to the lwIP network interface.
  */
 void ethif_poll(struct netif *netif)
@@ -35,36 +223,64 @@ void ethif_poll(struct netif *netif)
   struct ethif *ethif = (struct ethif *)netif->state;
   struct ethif_driver *driver = (struct ethif_driver *)ethif->driver;
 
+  ETHIF_PROF_DECL(t_poll);
+  ETHIF_PROF_DECL(t);
   bool connected = driver->poll(ethif, true);
+  bool link_came_up = false;
+  ETHIF_PROF_LAP(ethif, ETHIF_PROF_POLL_LINK, t);
   if (connected != netif_is_link_up(netif)) {
     if (connected) {
       LWIP_DEBUGF(ETHIF_DEBUG, ("ethif_poll: Link is UP\n"));
+      ethif->stats.link_up++;
+      link_came_up = true;
       netif_set_link_up(netif);
     }
     else {
       LWIP_DEBUGF(ETHIF_DEBUG, ("ethif_poll: Link is DOWN\n"));
+      ethif->stats.link_down++;
       netif_set_link_down(netif);
     }
   }
 
-  struct pbuf *p = pbuf_alloc(PBUF_RAW, PBUF_POOL_BUFSIZE, PBUF_POOL);
-  if (p && p->next == NULL) {
-    size_t len = driver->rx(p->payload, p->len, ethif);
-    if (len > 0) {
-      p->len = p->tot_len = len;
-      LWIP_DEBUGF(ETHIF_DEBUG, ("ethif_poll: received %u bytes\n", len));
+#if LWIP_ARP
+  ethif_arp_update(netif, ethif, link_came_up);
+#else
+  LWIP_UNUSED_ARG(link_came_up);
+#endif
 
-      if (netif->input(p, netif) == ERR_OK) return;
+#if ETHIF_RX_CLASSIFY
+  uint8_t budget[ETHIF_RX_CLASS_COUNT];
+  for (int i = 0; i < ETHIF_RX_CLASS_COUNT; i++) {
+    budget[i] = ethif_rx_policy[i].budget;
+  }
 
-      LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SERIOUS, ("ethif_poll: netif->input() failed\n"));
-    }
-    pbuf_free(p);
-  } else {
-    if (p) {
-      pbuf_free(p);  // Free if it's chained or failed
-      LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SERIOUS, ("pbuf_alloc failed or chained pbuf not supported!\n"));
+  for (int n = 0; n < ETHIF_RX_POLL_MAX_FRAMES; n++) {
+    uint8_t hdr[ETHIF_RX_PEEK_LEN];
+    bool more = false;
+    size_t len = driver->peek(hdr, sizeof(hdr), &more, ethif);
+    if (len == 0) break;
+
+    enum ethif_rx_class cls = ethif_rx_classify(netif, hdr, len < sizeof(hdr) ? len : sizeof(hdr));
+    if (budget[cls] == 0) {
+      if (ethif_rx_policy[cls].prio > ETHIF_RX_DEFER_PRIO && more) {
+        LWIP_DEBUGF(ETHIF_DEBUG, ("ethif_poll: class %d over budget, dropping %u bytes\n", (int)cls, (unsigned)len));
+        if (!driver->skip(ethif)) break;
+        ethif->stats.rx_class_drops++;
+        LINK_STATS_INC(link.drop);
+        MIB2_STATS_NETIF_INC(netif, ifindiscards);
+        continue;
+      }
+      break;
     }
+    budget[cls]--;
+
+    if (!ethif_input(netif, hdr, len < sizeof(hdr) ? len : sizeof(hdr))) break;
   }
+#else
+  ethif_input(netif, NULL, 0);
+#endif /* ETHIF_RX_CLASSIFY */
+
+  ETHIF_PROF_LAP(ethif, ETHIF_PROF_POLL, t_poll);
 }
 
 /**
@@ -94,20 +310,253 @@ static err_t ethif_output(struct netif *netif, struct pbuf *p)
     MIB2_STATS_NETIF_INC(netif, ifoutnucastpkts);
   }
   
-  sys_prot_t irq_state = sys_arch_protect();
-  size_t sent = driver->tx(p->payload, p->tot_len, ethif);
-  sys_arch_unprotect(irq_state);
+#if ETHIF_PCAP
+  ethif_pcap_record(ethif, p, ETHIF_PCAP_TX);
+#endif
+
+  // Driver calls are serialized by the NO_SYS main loop; the bus is owned
+  // per SPI transaction (begin()/end()), not for the whole frame
+  ETHIF_PROF_DECL(t);
+  size_t sent = driver->tx(p, ethif);
+  ETHIF_PROF_LAP(ethif, ETHIF_PROF_OUTPUT, t);
 
   if (sent != p->tot_len) {
+    ethif->stats.tx_err++;
+    LINK_STATS_INC(link.err);
+    MIB2_STATS_NETIF_INC(netif, ifouterrors);
     LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SERIOUS,
       ("ethif_output: TX failed, sent %u instead of %u\n",(unsigned int)sent, (unsigned int)p->tot_len));
     return ERR_IF;
   }
 
+  ethif->stats.tx_frames++;
+  ethif->stats.tx_bytes += sent;
   LWIP_DEBUGF(ETHIF_DEBUG, ("ethif_output: TX successful\n"));
   return ERR_OK;
 }
 
+/**
+ * @brief Copies the driver counters of an interface.
+ *
+ * The copy is taken inside a short critical section so that counters
+ * updated from the poll loop are consistent with each other.
+ *
+ * @param netif lwIP network interface.
+ * @param stats Destination of the snapshot.
+ */
+void ethif_get_stats(struct netif *netif, struct ethif_stats *stats)
+{
+  struct ethif *ethif = (struct ethif *)netif->state;
+
+  sys_prot_t irq_state = sys_arch_protect();
+  memcpy(stats, &ethif->stats, sizeof(*stats));
+  sys_arch_unprotect(irq_state);
+}
+
+/**
+ * @brief Clears the driver counters of an interface.
+ *
+ * @param netif lwIP network interface.
+ */
+void ethif_reset_stats(struct netif *netif)
+{
+  struct ethif *ethif = (struct ethif *)netif->state;
+
+  sys_prot_t irq_state = sys_arch_protect();
+  memset(&ethif->stats, 0, sizeof(ethif->stats));
+  sys_arch_unprotect(irq_state);
+}
+
+/**
+ * @brief Selects the fastest reliable SPI clock for an Ethernet interface.
+ *
+ * The safety margin is applied also when all candidates pass: the end of
+ * the list then counts as the failing speed, since the fastest candidate
+ * passing is no evidence of headroom above it.
+ *
+ * @param s Ethernet interface.
+ * @param speeds Candidate SPI clocks in Hz, in ascending order.
+ * @param count Number of entries in @p speeds.
+ * @return Selected clock in Hz, or 0 on failure.
+ */
+uint32_t ethif_spi_autotune(struct ethif *s, const uint32_t *speeds, size_t count)
+{
+  size_t passed = 0;
+
+  if (s->set_clock == NULL || s->driver->check == NULL || count == 0) {
+    return 0;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    int round;
+    s->set_clock(s->spi, speeds[i]);
+    for (round = 0; round < ETHIF_SPI_AUTOTUNE_ROUNDS; round++) {
+      if (!s->driver->check(s)) {
+        break;
+      }
+    }
+    LWIP_DEBUGF(ETHIF_DEBUG, ("ethif_spi_autotune: %lu Hz passed %d/%d checks\n",
+                              (unsigned long)speeds[i], round, ETHIF_SPI_AUTOTUNE_ROUNDS));
+    if (round < ETHIF_SPI_AUTOTUNE_ROUNDS) {
+      break;
+    }
+    passed = i + 1;
+  }
+
+  s->spi_speeds = speeds;
+  s->spi_speed_count = count;
+  s->spi_speed_index = 0;
+
+  if (passed == 0) {
+    LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SEVERE,
+                ("ethif_spi_autotune: SPI unreliable at %lu Hz\n", (unsigned long)speeds[0]));
+    s->set_clock(s->spi, speeds[0]);
+    s->spi_hz = 0;
+    return 0;
+  }
+
+  size_t sel = passed - 1;
+  sel = sel > ETHIF_SPI_AUTOTUNE_MARGIN ? sel - ETHIF_SPI_AUTOTUNE_MARGIN : 0;
+  s->set_clock(s->spi, speeds[sel]);
+  s->spi_speed_index = sel;
+  s->spi_tuned_index = sel;
+  s->spi_hz = speeds[sel];
+  LWIP_DEBUGF(ETHIF_DEBUG, ("ethif_spi_autotune: Selected %lu Hz\n", (unsigned long)s->spi_hz));
+  return s->spi_hz;
+}
+
+/**
+ * @brief Switches to the next slower SPI clock from the autotuning list.
+ *
+ * @param s Ethernet interface.
+ * @return false if there is no slower clock to fall back to.
+ */
+bool ethif_spi_step_down(struct ethif *s)
+{
+  s->spi_step_up_next = sys_now() + ETHIF_SPI_STEP_UP_MS;
+  if (s->set_clock == NULL || s->spi_speeds == NULL || s->spi_hz == 0 || s->spi_speed_index == 0) {
+    return false;
+  }
+
+  s->spi_speed_index--;
+  s->spi_hz = s->spi_speeds[s->spi_speed_index];
+  s->set_clock(s->spi, s->spi_hz);
+  s->stats.spi_fallbacks++;
+  LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_WARNING,
+              ("ethif_spi_step_down: SPI clock lowered to %lu Hz\n", (unsigned long)s->spi_hz));
+  return true;
+}
+
+#if LWIP_ARP && ETHARP_SUPPORT_STATIC_ENTRIES
+/**
+ * @brief Preloads the ARP table with known peers.
+ *
+ * @param netif lwIP network interface.
+ * @param table Static entries, must stay valid.
+ * @param count Number of entries in @p table.
+ */
+void ethif_arp_preload(struct netif *netif, const struct ethif_static_arp *table, size_t count)
+{
+  struct ethif *ethif = (struct ethif *)netif->state;
+
+  ethif->arp_table = table;
+  ethif->arp_count = count;
+  if (!ip4_addr_isany_val(*netif_ip4_addr(netif))) {
+    ethif_arp_apply(ethif);
+  }
+}
+#endif /* LWIP_ARP && ETHARP_SUPPORT_STATIC_ENTRIES */
+
+/**
+ * @brief Tries the next faster SPI clock after an error-free period.
+ *
+ * @param s Ethernet interface.
+ * @return true if the faster clock passed the integrity checks and was kept.
+ */
+bool ethif_spi_step_up(struct ethif *s)
+{
+  uint32_t now = sys_now();
+
+  if (ETHIF_SPI_STEP_UP_MS == 0 || s->spi_hz == 0 || s->spi_speed_index >= s->spi_tuned_index ||
+      (int32_t)(now - s->spi_step_up_next) < 0) {
+    return false;
+  }
+  s->spi_step_up_next = now + ETHIF_SPI_STEP_UP_MS;
+
+  uint32_t hz = s->spi_speeds[s->spi_speed_index + 1];
+  s->set_clock(s->spi, hz);
+  for (int round = 0; round < ETHIF_SPI_AUTOTUNE_ROUNDS; round++) {
+    if (!s->driver->check(s)) {
+      s->set_clock(s->spi, s->spi_hz);
+      LWIP_DEBUGF(ETHIF_DEBUG, ("ethif_spi_step_up: %lu Hz failed check %d\n", (unsigned long)hz, round));
+      return false;
+    }
+  }
+
+  s->spi_speed_index++;
+  s->spi_hz = hz;
+  s->stats.spi_step_ups++;
+  LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_WARNING,
+              ("ethif_spi_step_up: SPI clock raised to %lu Hz\n", (unsigned long)s->spi_hz));
+  return true;
+}
+
+/**
+ * @brief Serializes the driver counters of an interface as CSV lines.
+ *
+ * @param netif lwIP network interface.
+ * @param out Callback receiving each line.
+ * @param arg User argument passed to @p out.
+ */
+void ethif_stats_dump(struct netif *netif, void (*out)(const char *line, void *arg), void *arg)
+{
+  static const char *const wait_names[ETHIF_WAIT_SITE_COUNT] = {
+    "rx_rsr", "rx_recv", "tx_fsr", "tx_send", "tx_sendok", "init_rst", "init_open"
+  };
+  struct ethif_stats st;
+  char line[40];
+
+  ethif_get_stats(netif, &st);
+
+#define ETHIF_STATS_LINE(name, value) \
+  do { snprintf(line, sizeof(line), "%s,%lu", (name), (unsigned long)(value)); out(line, arg); } while (0)
+
+  out("counter,value", arg);
+  ETHIF_STATS_LINE("rx_frames", st.rx_frames);
+  ETHIF_STATS_LINE("rx_bytes", st.rx_bytes);
+  ETHIF_STATS_LINE("rx_oversize", st.rx_oversize);
+  ETHIF_STATS_LINE("rx_nomem", st.rx_nomem);
+  ETHIF_STATS_LINE("rx_input_err", st.rx_input_err);
+  ETHIF_STATS_LINE("rx_class_drops", st.rx_class_drops);
+  ETHIF_STATS_LINE("tx_frames", st.tx_frames);
+  ETHIF_STATS_LINE("tx_bytes", st.tx_bytes);
+  ETHIF_STATS_LINE("tx_err", st.tx_err);
+  ETHIF_STATS_LINE("tx_nospace", st.tx_nospace);
+  for (int i = 0; i < ETHIF_WAIT_SITE_COUNT; i++) {
+    snprintf(line, sizeof(line), "timeout_%s,%lu", wait_names[i], (unsigned long)st.timeouts[i]);
+    out(line, arg);
+  }
+  ETHIF_STATS_LINE("sn_ir_timeout", st.sn_ir_timeout);
+  ETHIF_STATS_LINE("sn_ir_discon", st.sn_ir_discon);
+  ETHIF_STATS_LINE("unstable_retries", st.unstable_retries);
+  ETHIF_STATS_LINE("link_up", st.link_up);
+  ETHIF_STATS_LINE("link_down", st.link_down);
+  ETHIF_STATS_LINE("spi_transactions", st.spi_transactions);
+  ETHIF_STATS_LINE("spi_hold_max_us", (uint64_t)st.spi_hold_max_cycles * 1000000u / sys_cycles_hz());
+  ETHIF_STATS_LINE("spi_bytes", st.spi_bytes);
+  ETHIF_STATS_LINE("spi_errors", st.spi_errors);
+  ETHIF_STATS_LINE("spi_fallbacks", st.spi_fallbacks);
+  ETHIF_STATS_LINE("spi_step_ups", st.spi_step_ups);
+  ETHIF_STATS_LINE("rx_resyncs", st.rx_resyncs);
+  ETHIF_STATS_LINE("rx_resync_fails", st.rx_resync_fails);
+  ETHIF_STATS_LINE("rx_resync_max_us", st.rx_resync_max_us);
+  ETHIF_STATS_LINE("warm_inits", st.warm_inits);
+  ETHIF_STATS_LINE("cold_inits", st.cold_inits);
+  ETHIF_STATS_LINE("garp_sent", st.garp_sent);
+
+#undef ETHIF_STATS_LINE
+}
+
 
 /**
  * @brief Initializes the Ethernet interface.
@@ -167,3 +616,53 @@ err_t ethif_init(struct netif *netif)
     return ERR_IF;
   }
 }
+
+/**
+ * @brief Polls every interface added with ethif_init(), in netif list order.
+ *
+ * Each ethif_poll() takes at most ETHIF_RX_POLL_MAX_FRAMES frames, so a busy
+ * interface delays the others by a bounded amount per round.
+ *
+ * @return Number of frames passed to lwIP.
+ */
+uint32_t ethif_poll_all(void)
+{
+  struct netif *netif;
+  uint32_t frames = 0;
+
+  NETIF_FOREACH(netif) {
+    if (netif->linkoutput == ethif_output) {
+      const struct ethif *ethif = (const struct ethif *)netif->state;
+      uint32_t before = ethif->stats.rx_frames;
+      ethif_poll(netif);
+      frames += ethif->stats.rx_frames - before;
+    }
+  }
+  return frames;
+}
+
+/**
+ * @brief Cold-resets the Ethernet controller of an interface.
+ *
+ * @param netif lwIP network interface.
+ * @return ERR_OK on success, ERR_IF on driver failure.
+ */
+err_t ethif_reset(struct netif *netif)
+{
+  struct ethif *ethif = (struct ethif *)netif->state;
+  struct ethif_driver *driver = (struct ethif_driver *)ethif->driver;
+
+  LWIP_DEBUGF(ETHIF_DEBUG, ("ethif_reset: cold reset requested\n"));
+
+  /* The PHY renegotiates; ethif_poll() brings the link back up */
+  if (netif_is_link_up(netif)) {
+    ethif->stats.link_down++;
+    netif_set_link_down(netif);
+  }
+
+  if (!driver->reset(ethif)) {
+    LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SERIOUS, ("ethif_reset: driver reset failed\n"));
+    return ERR_IF;
+  }
+  return ERR_OK;
+}
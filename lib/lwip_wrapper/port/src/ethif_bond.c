@@ -0,0 +1,198 @@
+/**
+ * @file
+ * @brief Active/backup bonding of two Ethernet modules.
+ *
+ * Implements struct ethif_driver on top of two other ethif instances, so
+ * ethif.c drives the bond like a single chip. Link states are checked every
+ * ETHIF_BOND_MONITOR_MS; when the active module loses its link while the
+ * other is ready and has one, traffic switches over without a netif link
+ * change.
+ */
+
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/sys.h"
+
+#include "ethif_bond.h"
+
+/**
+ * @brief The bond of a driver call.
+ */
+static struct ethif_bond *ethif_bond_of(struct ethif *s)
+{
+  return (struct ethif_bond *)s;
+}
+
+struct ethif *ethif_bond_active(const struct ethif_bond *bond)
+{
+  return bond->slaves[bond->active];
+}
+
+/**
+ * @brief Moves the traffic to the other module and re-announces our address.
+ *
+ * Frames the module received while standing by are flushed first, so the
+ * stack never sees traffic queued before the switch.
+ *
+ * @param bond Bond.
+ * @param now Current sys_now().
+ */
+static void ethif_bond_failover(struct ethif_bond *bond, uint32_t now)
+{
+  bond->active ^= 1;
+  bond->failovers++;
+  struct ethif *active = ethif_bond_active(bond);
+  if (!active->driver->flush(active)) {
+    LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_WARNING, ("ethif_bond: flushing module %u failed\n", (unsigned)bond->active));
+  }
+  bond->failover_ms = now - bond->last_up;
+  bond->last_up = now;
+
+  LWIP_DEBUGF(ETHIF_DEBUG, ("ethif_bond: failover to module %u after %lu ms\n",
+                            (unsigned)bond->active, (unsigned long)bond->failover_ms));
+#if LWIP_ARP
+  // The first gratuitous ARP goes out in this ethif_poll(), the rest at the usual interval
+  bond->ethif.garp_left = ETHIF_GARP_COUNT + 1;
+  bond->ethif.garp_next = now;
+#endif
+}
+
+/**
+ * @brief Initializes both modules with the MAC address of the bond.
+ *
+ * @return true if at least one module came up; the primary is preferred.
+ */
+static bool ethif_bond_init(struct ethif *s)
+{
+  struct ethif_bond *bond = ethif_bond_of(s);
+
+  for (int i = 0; i < 2; i++) {
+    struct ethif *slave = bond->slaves[i];
+    slave->ethaddr = s->ethaddr;
+    bond->ready[i] = slave->driver->init(slave);
+    bond->link[i] = false;
+  }
+  bond->active = bond->ready[0] ? 0 : 1;
+  bond->next_check = sys_now();
+  bond->last_up = bond->next_check;
+  bond->init_next = bond->next_check + ETHIF_RESET_MIN_INTERVAL_MS;
+  return bond->ready[0] || bond->ready[1];
+}
+
+/**
+ * @brief Cold-resets both modules.
+ */
+static bool ethif_bond_reset(struct ethif *s)
+{
+  struct ethif_bond *bond = ethif_bond_of(s);
+  for (int i = 0; i < 2; i++) {
+    bond->ready[i] = bond->slaves[i]->driver->reset(bond->slaves[i]);
+  }
+  bond->init_next = sys_now() + ETHIF_RESET_MIN_INTERVAL_MS;
+  return bond->ready[0] || bond->ready[1];
+}
+
+/**
+ * @brief Verifies the SPI link of both modules.
+ */
+static bool ethif_bond_check(struct ethif *s)
+{
+  struct ethif_bond *bond = ethif_bond_of(s);
+  bool ok0 = bond->slaves[0]->driver->check(bond->slaves[0]);
+  bool ok1 = bond->slaves[1]->driver->check(bond->slaves[1]);
+  return ok0 && ok1;
+}
+
+/**
+ * @brief Checks the module links every ETHIF_BOND_MONITOR_MS and fails over.
+ *
+ * The backup module is not read while it stands by; its RX buffer is
+ * flushed when it takes over (see ethif_bond_failover()). A module that is
+ * not ready counts as down and is re-initialized at most every
+ * ETHIF_RESET_MIN_INTERVAL_MS.
+ *
+ * @return true while the active module has a link.
+ */
+static bool ethif_bond_poll(struct ethif *s, bool s1)
+{
+  struct ethif_bond *bond = ethif_bond_of(s);
+  uint32_t now = sys_now();
+
+  if (!s1) {
+    return false;
+  }
+
+  if ((int32_t)(now - bond->next_check) >= 0) {
+    bond->next_check = now + ETHIF_BOND_MONITOR_MS;
+    for (int i = 0; i < 2; i++) {
+      struct ethif *slave = bond->slaves[i];
+      if (!bond->ready[i] && (int32_t)(now - bond->init_next) >= 0) {
+        bond->init_next = now + ETHIF_RESET_MIN_INTERVAL_MS;
+        bond->ready[i] = slave->driver->init(slave);
+        LWIP_DEBUGF(ETHIF_DEBUG, ("ethif_bond: module %d init %s\n", i, bond->ready[i] ? "passed" : "failed"));
+      }
+      bond->link[i] = bond->ready[i] && slave->driver->poll(slave, true);
+    }
+
+    if (bond->link[bond->active]) {
+      bond->last_up = now;
+    } else if (bond->link[bond->active ^ 1]) {
+      ethif_bond_failover(bond, now);
+    }
+  }
+  return bond->link[bond->active];
+}
+
+static size_t ethif_bond_tx(struct pbuf *p, struct ethif *s)
+{
+  struct ethif *active = ethif_bond_active(ethif_bond_of(s));
+  return active->driver->tx(p, active);
+}
+
+static size_t ethif_bond_rx(void *buf, size_t len, size_t have, struct ethif *s)
+{
+  struct ethif *active = ethif_bond_active(ethif_bond_of(s));
+  return active->driver->rx(buf, len, have, active);
+}
+
+static size_t ethif_bond_peek(void *buf, size_t len, bool *more, struct ethif *s)
+{
+  struct ethif *active = ethif_bond_active(ethif_bond_of(s));
+  return active->driver->peek(buf, len, more, active);
+}
+
+static bool ethif_bond_skip(struct ethif *s)
+{
+  struct ethif *active = ethif_bond_active(ethif_bond_of(s));
+  return active->driver->skip(active);
+}
+
+static bool ethif_bond_flush(struct ethif *s)
+{
+  struct ethif *active = ethif_bond_active(ethif_bond_of(s));
+  return active->driver->flush(active);
+}
+
+void ethif_bond_setup(struct ethif_bond *bond, struct ethif *primary, struct ethif *backup)
+{
+  memset(bond, 0, sizeof(*bond));
+  bond->ethif.driver = &ethif_driver_bond;
+  bond->slaves[0] = primary;
+  bond->slaves[1] = backup;
+}
+
+/**
+ * @brief Ethernet driver structure for a bond.
+ */
+struct ethif_driver ethif_driver_bond = {
+  ethif_bond_init,
+  ethif_bond_tx,
+  ethif_bond_rx,
+  ethif_bond_poll,
+  ethif_bond_peek,
+  ethif_bond_skip,
+  ethif_bond_check,
+  ethif_bond_reset,
+  ethif_bond_flush,
+};
@@ -0,0 +1,253 @@
+/**
+ * @file
+ * @brief pcap capture of frames at the Ethernet driver boundary.
+ *
+ * Frames passed between lwIP and the driver are stored as pcap records in a
+ * RAM ring buffer and streamed out on demand, or written straight to a file
+ * on host builds. Compiled out unless ETHIF_PCAP is set.
+ */
+
+#include "lwip/opt.h"
+#include "lwip/sys.h"
+
+#include "ethif.h"
+
+#if ETHIF_PCAP
+
+#include <string.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <stdio.h>
+#include <time.h>
+#endif
+
+/**
+ * @brief pcap global file header.
+ */
+struct pcap_file_header {
+  uint32_t magic;          /**< 0xa1b2c3d4, microsecond timestamps */
+  uint16_t version_major;  /**< 2 */
+  uint16_t version_minor;  /**< 4 */
+  int32_t thiszone;        /**< GMT offset, always 0 */
+  uint32_t sigfigs;        /**< Timestamp accuracy, always 0 */
+  uint32_t snaplen;        /**< Maximum captured length per record */
+  uint32_t linktype;       /**< 1 = LINKTYPE_ETHERNET */
+};
+
+/**
+ * @brief pcap per-record header.
+ */
+struct pcap_record_header {
+  uint32_t ts_sec;         /**< Timestamp, seconds */
+  uint32_t ts_usec;        /**< Timestamp, microseconds */
+  uint32_t incl_len;       /**< Bytes of frame data in the record */
+  uint32_t orig_len;       /**< Length of the frame on the wire */
+};
+
+/**
+ * @brief Fills in the global header for a capture.
+ */
+static void ethif_pcap_file_header(const struct ethif_pcap *cap, struct pcap_file_header *hdr)
+{
+  hdr->magic = 0xa1b2c3d4u;
+  hdr->version_major = 2;
+  hdr->version_minor = 4;
+  hdr->thiszone = 0;
+  hdr->sigfigs = 0;
+  hdr->snaplen = cap->snaplen;
+  hdr->linktype = 1;
+}
+
+/**
+ * @brief Timestamps a record.
+ *
+ * Wall clock on host builds, sys_now() milliseconds since boot on target.
+ */
+static void ethif_pcap_timestamp(struct pcap_record_header *rec)
+{
+#if defined(__linux__) || defined(__APPLE__)
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  rec->ts_sec = (uint32_t)ts.tv_sec;
+  rec->ts_usec = (uint32_t)(ts.tv_nsec / 1000);
+#else
+  u32_t now = sys_now();
+  rec->ts_sec = now / 1000;
+  rec->ts_usec = (now % 1000) * 1000;
+#endif
+}
+
+/**
+ * @brief Copies data into the ring buffer at the write offset, wrapping around.
+ */
+static void ethif_pcap_put(struct ethif_pcap *cap, const void *data, uint32_t len)
+{
+  uint32_t at = cap->head % cap->size;
+  uint32_t first = cap->size - at;
+  if (first > len) first = len;
+  memcpy(&cap->buf[at], data, first);
+  memcpy(cap->buf, (const uint8_t *)data + first, len - first);
+  cap->head += len;
+}
+
+/**
+ * @brief Appends data to the capture file (host builds) or the ring buffer.
+ *
+ * Ring buffer space must have been checked by the caller.
+ */
+static void ethif_pcap_write(struct ethif_pcap *cap, const void *data, uint32_t len)
+{
+#if defined(__linux__) || defined(__APPLE__)
+  if (cap->file) {
+    fwrite(data, 1, len, (FILE *)cap->file);
+    return;
+  }
+#endif
+  ethif_pcap_put(cap, data, len);
+}
+
+/**
+ * @brief Starts capturing frames of an interface into a RAM ring buffer.
+ */
+void ethif_pcap_start(struct netif *netif, struct ethif_pcap *cap, void *buf, size_t size,
+                      uint16_t snaplen, uint8_t dir)
+{
+  struct ethif *ethif = (struct ethif *)netif->state;
+
+  memset(cap, 0, sizeof(*cap));
+  cap->buf = (uint8_t *)buf;
+  cap->size = size;
+  cap->snaplen = snaplen;
+  cap->dir = dir;
+
+  sys_prot_t irq_state = sys_arch_protect();
+  ethif->pcap = cap;
+  sys_arch_unprotect(irq_state);
+}
+
+#if defined(__linux__) || defined(__APPLE__)
+/**
+ * @brief Starts capturing frames of an interface directly into a pcap file.
+ */
+bool ethif_pcap_open(struct netif *netif, struct ethif_pcap *cap, const char *path,
+                     uint16_t snaplen, uint8_t dir)
+{
+  struct ethif *ethif = (struct ethif *)netif->state;
+  struct pcap_file_header hdr;
+
+  FILE *f = fopen(path, "wb");
+  if (!f) {
+    return false;
+  }
+
+  memset(cap, 0, sizeof(*cap));
+  cap->snaplen = snaplen;
+  cap->dir = dir;
+  cap->file = f;
+  cap->hdr_pos = sizeof(hdr);
+
+  ethif_pcap_file_header(cap, &hdr);
+  fwrite(&hdr, sizeof(hdr), 1, f);
+
+  ethif->pcap = cap;
+  return true;
+}
+#endif
+
+/**
+ * @brief Stops capturing frames of an interface.
+ */
+void ethif_pcap_stop(struct netif *netif)
+{
+  struct ethif *ethif = (struct ethif *)netif->state;
+
+  sys_prot_t irq_state = sys_arch_protect();
+  struct ethif_pcap *cap = ethif->pcap;
+  ethif->pcap = NULL;
+  sys_arch_unprotect(irq_state);
+
+#if defined(__linux__) || defined(__APPLE__)
+  if (cap && cap->file) {
+    fclose((FILE *)cap->file);
+    cap->file = NULL;
+  }
+#else
+  LWIP_UNUSED_ARG(cap);
+#endif
+}
+
+/**
+ * @brief Records a frame if the capture of an interface accepts it.
+ */
+void ethif_pcap_record(struct ethif *ethif, const struct pbuf *p, uint8_t dir)
+{
+  struct ethif_pcap *cap = ethif->pcap;
+  struct pcap_record_header rec;
+
+  if (!cap || !(cap->dir & dir)) {
+    return;
+  }
+  if (cap->filter && !cap->filter(p->payload, p->len, dir, cap->filter_arg)) {
+    return;
+  }
+
+  ethif_pcap_timestamp(&rec);
+  rec.incl_len = p->tot_len < cap->snaplen ? p->tot_len : cap->snaplen;
+  rec.orig_len = p->tot_len;
+
+#if defined(__linux__) || defined(__APPLE__)
+  if (!cap->file)
+#endif
+  if (cap->size - (cap->head - cap->tail) < sizeof(rec) + rec.incl_len) {
+    cap->dropped++;
+    return;
+  }
+  ethif_pcap_write(cap, &rec, sizeof(rec));
+
+  // Frames sent by reference arrive as a header pbuf chained to the payload
+  uint32_t left = rec.incl_len;
+  for (const struct pbuf *q = p; q != NULL && left > 0; q = q->next) {
+    uint32_t n = q->len < left ? q->len : left;
+    ethif_pcap_write(cap, q->payload, n);
+    left -= n;
+  }
+  cap->captured++;
+}
+
+/**
+ * @brief Streams captured data out of the ring buffer.
+ *
+ * Emits the pcap global header first, then contiguous chunks of the ring,
+ * until the ring is empty or @p out accepts less than it was given.
+ */
+size_t ethif_pcap_drain(struct ethif_pcap *cap, size_t (*out)(const void *data, size_t len, void *arg), void *arg)
+{
+  size_t total = 0;
+
+  if (cap->hdr_pos < sizeof(struct pcap_file_header)) {
+    struct pcap_file_header hdr;
+    ethif_pcap_file_header(cap, &hdr);
+    size_t n = out((const uint8_t *)&hdr + cap->hdr_pos, sizeof(hdr) - cap->hdr_pos, arg);
+    cap->hdr_pos += n;
+    total += n;
+    if (cap->hdr_pos < sizeof(hdr)) {
+      return total;
+    }
+  }
+
+  while (cap->tail != cap->head) {
+    uint32_t at = cap->tail % cap->size;
+    uint32_t len = cap->head - cap->tail;
+    if (len > cap->size - at) len = cap->size - at;
+
+    size_t n = out(&cap->buf[at], len, arg);
+    cap->tail += n;
+    total += n;
+    if (n < len) {
+      break;
+    }
+  }
+  return total;
+}
+
+#endif /* ETHIF_PCAP */
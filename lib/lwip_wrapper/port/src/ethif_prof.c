@@ -0,0 +1,135 @@
+/**
+ * @file
+ * @brief Per-phase timing instrumentation for the Ethernet interface.
+ *
+ * Accumulates min/max/mean and a log2 histogram of each profiled phase of
+ * the receive and transmit paths. Compiled out unless ETHIF_PROF is set.
+ */
+
+#include "lwip/opt.h"
+
+#include "ethif.h"
+
+#if ETHIF_PROF
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <time.h>
+
+/**
+ * @brief Reads CLOCK_MONOTONIC in nanoseconds (host builds).
+ */
+uint32_t ethif_prof_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+
+/**
+ * @brief Returns the host profiling clock frequency.
+ */
+uint32_t ethif_prof_hz(void)
+{
+  return 1000000000u;
+}
+#else
+
+/**
+ * @brief Reads the MCU cycle counter (target builds).
+ */
+uint32_t ethif_prof_now(void)
+{
+  return sys_cycles();
+}
+
+/**
+ * @brief Returns the MCU cycle counter frequency.
+ */
+uint32_t ethif_prof_hz(void)
+{
+  return sys_cycles_hz();
+}
+#endif
+
+static const char *const ethif_prof_names[ETHIF_PROF_PHASE_COUNT] = {
+  "rx_rsr", "rx_header", "rx_payload", "rx_recv",
+  "tx_fsr", "tx_payload", "tx_send", "tx_sendok",
+  "poll_link", "poll_input", "poll", "output"
+};
+
+/**
+ * @brief Accounts the time since @p start to a phase.
+ *
+ * @param prof Statistics to update.
+ * @param phase Profiled phase.
+ * @param start Clock value at the start of the phase.
+ * @return Current clock value.
+ */
+uint32_t ethif_prof_record(struct ethif_prof *prof, enum ethif_prof_phase phase, uint32_t start)
+{
+  uint32_t now = ethif_prof_now();
+  uint32_t ticks = now - start;
+  struct ethif_prof_stat *st = &prof->phase[phase];
+
+  if (st->count == 0 || ticks < st->min) st->min = ticks;
+  if (ticks > st->max) st->max = ticks;
+  st->count++;
+  st->sum += ticks;
+
+  unsigned bin = 0;
+  for (uint32_t v = ticks >> ETHIF_PROF_HIST_SHIFT; v > 1 && bin < ETHIF_PROF_HIST_BINS - 1; v >>= 1) {
+    bin++;
+  }
+  st->hist[bin]++;
+
+  return now;
+}
+
+/**
+ * @brief Clears the profiling statistics of an interface.
+ *
+ * @param netif lwIP network interface.
+ */
+void ethif_prof_reset(struct netif *netif)
+{
+  struct ethif *ethif = (struct ethif *)netif->state;
+  memset(&ethif->prof, 0, sizeof(ethif->prof));
+}
+
+/**
+ * @brief Serializes the profiling statistics of an interface as CSV lines.
+ *
+ * @param netif lwIP network interface.
+ * @param out Callback receiving each line.
+ * @param arg User argument passed to @p out.
+ */
+void ethif_prof_dump(struct netif *netif, void (*out)(const char *line, void *arg), void *arg)
+{
+  struct ethif *ethif = (struct ethif *)netif->state;
+  char line[48 + ETHIF_PROF_HIST_BINS * 11];
+  int n;
+
+  n = snprintf(line, sizeof(line), "phase,count,min,mean,max,hz");
+  for (int b = 0; b < ETHIF_PROF_HIST_BINS; b++) {
+    n += snprintf(line + n, sizeof(line) - n, ",h%d", b);
+  }
+  out(line, arg);
+
+  for (int i = 0; i < ETHIF_PROF_PHASE_COUNT; i++) {
+    const struct ethif_prof_stat *st = &ethif->prof.phase[i];
+    uint32_t mean = st->count ? (uint32_t)(st->sum / st->count) : 0;
+
+    n = snprintf(line, sizeof(line), "%s,%lu,%lu,%lu,%lu,%lu", ethif_prof_names[i],
+                 (unsigned long)st->count, (unsigned long)st->min, (unsigned long)mean,
+                 (unsigned long)st->max, (unsigned long)ethif_prof_hz());
+    for (int b = 0; b < ETHIF_PROF_HIST_BINS && n < (int)sizeof(line); b++) {
+      n += snprintf(line + n, sizeof(line) - n, ",%lu", (unsigned long)st->hist[b]);
+    }
+    out(line, arg);
+  }
+}
+
+#endif /* ETHIF_PROF */
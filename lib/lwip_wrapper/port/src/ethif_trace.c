@@ -0,0 +1,239 @@
+/**
+ * @file
+ * @brief SPI transaction trace recording and replay for the Ethernet interface.
+ *
+ * The recorder sits between the driver and the board's SPI callbacks and
+ * streams every transaction to a sink. The replayer stands in for the SPI
+ * bus, returning recorded MISO bytes and checking MOSI bytes, so the driver
+ * can be benchmarked and validated against field traffic without hardware.
+ * Compiled out unless ETHIF_TRACE is set.
+ */
+
+#include "lwip/opt.h"
+
+#include "ethif.h"
+
+#if ETHIF_TRACE
+
+#include <string.h>
+
+#define TRACE_VERSION 1
+
+/**
+ * @brief Writes trace bytes to the sink, counting what it rejects.
+ */
+static void trace_emit(struct ethif_trace *tr, const void *data, size_t len)
+{
+  size_t n = tr->write(data, len, tr->arg);
+  if (n < len) {
+    tr->lost += len - n;
+  }
+}
+
+/**
+ * @brief Writes a tagged timestamp record.
+ */
+static void trace_emit_ts(struct ethif_trace *tr, uint8_t tag)
+{
+  uint32_t ts = sys_cycles();
+  uint8_t rec[5] = { tag, (uint8_t)ts, (uint8_t)(ts >> 8), (uint8_t)(ts >> 16), (uint8_t)(ts >> 24) };
+  trace_emit(tr, rec, sizeof(rec));
+}
+
+/**
+ * @brief Writes the buffered byte pairs as a data record.
+ */
+static void trace_flush(struct ethif_trace *tr)
+{
+  if (tr->chunk == 0) {
+    return;
+  }
+  uint8_t rec[2] = { 'D', tr->chunk };
+  trace_emit(tr, rec, sizeof(rec));
+  trace_emit(tr, tr->mosi, tr->chunk);
+  trace_emit(tr, tr->miso, tr->chunk);
+  tr->chunk = 0;
+}
+
+static void trace_record_begin(void *ctx)
+{
+  struct ethif_trace *tr = (struct ethif_trace *)ctx;
+  tr->begin(tr->spi);
+  trace_emit_ts(tr, 'B');
+}
+
+static void trace_record_end(void *ctx)
+{
+  struct ethif_trace *tr = (struct ethif_trace *)ctx;
+  tr->end(tr->spi);
+  trace_flush(tr);
+  trace_emit_ts(tr, 'E');
+  tr->transactions++;
+}
+
+static uint8_t trace_record_txn(void *ctx, uint8_t mosi)
+{
+  struct ethif_trace *tr = (struct ethif_trace *)ctx;
+  uint8_t miso = tr->txn(tr->spi, mosi);
+  tr->mosi[tr->chunk] = mosi;
+  tr->miso[tr->chunk] = miso;
+  if (++tr->chunk == ETHIF_TRACE_CHUNK) {
+    trace_flush(tr);
+  }
+  tr->bytes++;
+  return miso;
+}
+
+static void trace_record_set_clock(void *ctx, uint32_t hz)
+{
+  struct ethif_trace *tr = (struct ethif_trace *)ctx;
+  tr->set_clock(tr->spi, hz);
+}
+
+/**
+ * @brief Starts recording every SPI transaction of an Ethernet interface.
+ */
+void ethif_trace_record(struct ethif *s, struct ethif_trace *tr,
+                        size_t (*write)(const void *data, size_t len, void *arg), void *arg)
+{
+  memset(tr, 0, sizeof(*tr));
+  tr->spi = s->spi;
+  tr->begin = s->begin;
+  tr->end = s->end;
+  tr->txn = s->txn;
+  tr->set_clock = s->set_clock;
+  tr->write = write;
+  tr->arg = arg;
+
+  uint32_t hz = sys_cycles_hz();
+  uint8_t hdr[9] = { 'W', '5', 'T', 'R', TRACE_VERSION,
+                     (uint8_t)hz, (uint8_t)(hz >> 8), (uint8_t)(hz >> 16), (uint8_t)(hz >> 24) };
+  trace_emit(tr, hdr, sizeof(hdr));
+
+  s->spi = tr;
+  s->begin = trace_record_begin;
+  s->end = trace_record_end;
+  s->txn = trace_record_txn;
+  if (s->set_clock) {
+    s->set_clock = trace_record_set_clock;
+  }
+}
+
+/**
+ * @brief Stops recording and restores the original transport.
+ */
+void ethif_trace_stop(struct ethif *s, struct ethif_trace *tr)
+{
+  if (s->spi != tr || tr->write == NULL) {
+    return;
+  }
+  trace_flush(tr);
+  s->spi = tr->spi;
+  s->begin = tr->begin;
+  s->end = tr->end;
+  s->txn = tr->txn;
+  s->set_clock = tr->set_clock;
+}
+
+/**
+ * @brief Consumes a tagged record from the trace being replayed.
+ *
+ * @return true if the next record carries @p tag.
+ */
+static bool trace_expect(struct ethif_trace *tr, uint8_t tag, size_t len)
+{
+  if (tr->pos + 1 + len > tr->len || tr->trace[tr->pos] != tag) {
+    return false;
+  }
+  tr->pos += 1 + len;
+  return true;
+}
+
+static void trace_replay_begin(void *ctx)
+{
+  struct ethif_trace *tr = (struct ethif_trace *)ctx;
+  if (!trace_expect(tr, 'B', 4)) {
+    tr->errors++;
+  }
+  tr->chunk = 0;
+  tr->index = 0;
+}
+
+static void trace_replay_end(void *ctx)
+{
+  struct ethif_trace *tr = (struct ethif_trace *)ctx;
+  if (tr->index != tr->chunk || !trace_expect(tr, 'E', 4)) {
+    tr->errors++;
+    /* Resynchronize on the end of the recorded transaction */
+    while (tr->pos < tr->len && tr->trace[tr->pos] != 'E') {
+      if (tr->trace[tr->pos] == 'D' && tr->pos + 1 < tr->len) {
+        tr->pos += 2 + 2 * (size_t)tr->trace[tr->pos + 1];
+      } else {
+        tr->pos += 5;
+      }
+    }
+    trace_expect(tr, 'E', 4);
+  }
+  tr->chunk = 0;
+  tr->index = 0;
+  tr->transactions++;
+}
+
+static uint8_t trace_replay_txn(void *ctx, uint8_t mosi)
+{
+  struct ethif_trace *tr = (struct ethif_trace *)ctx;
+
+  if (tr->index == tr->chunk) {
+    if (tr->pos + 2 > tr->len || tr->trace[tr->pos] != 'D' ||
+        tr->pos + 2 + 2 * (size_t)tr->trace[tr->pos + 1] > tr->len) {
+      tr->errors++;
+      return 0xFF;
+    }
+    tr->chunk = tr->trace[tr->pos + 1];
+    tr->index = 0;
+    tr->pos += 2 + 2 * (size_t)tr->chunk;
+  }
+
+  /* The current record's MOSI bytes end chunk bytes before pos, MISO bytes at pos */
+  size_t at = tr->pos - 2 * (size_t)tr->chunk + tr->index;
+  if (tr->trace[at] != mosi) {
+    if (tr->mismatches++ == 0) {
+      tr->first_mismatch = at;
+    }
+  }
+  tr->index++;
+  tr->bytes++;
+  return tr->trace[at + tr->chunk];
+}
+
+static void trace_replay_set_clock(void *ctx, uint32_t hz)
+{
+  /* The recorded MISO bytes already reflect the clock used in the field */
+  (void)ctx;
+  (void)hz;
+}
+
+/**
+ * @brief Replaces the transport of an Ethernet interface with a recorded trace.
+ */
+bool ethif_trace_replay(struct ethif *s, struct ethif_trace *tr, const void *trace, size_t len)
+{
+  const uint8_t *t = (const uint8_t *)trace;
+
+  memset(tr, 0, sizeof(*tr));
+  if (len < 9 || memcmp(t, "W5TR", 4) != 0 || t[4] != TRACE_VERSION) {
+    return false;
+  }
+  tr->trace = t;
+  tr->len = len;
+  tr->pos = 9;
+
+  s->spi = tr;
+  s->begin = trace_replay_begin;
+  s->end = trace_replay_end;
+  s->txn = trace_replay_txn;
+  s->set_clock = trace_replay_set_clock;
+  return true;
+}
+
+#endif /* ETHIF_TRACE */
@@ -0,0 +1,133 @@
+/**
+ * @file
+ * @brief RAM footprint of the lwIP configuration.
+ *
+ * Derives the static RAM of every lwIP memory pool and of the heap from the
+ * options in lwipopts.h, the same way memp.c and mem.c declare them, checks
+ * the total against LWIP_RAM_BUDGET at compile time, and reports usage and
+ * high-water marks at runtime.
+ */
+
+#include "lwip/opt.h"
+#include "lwip/mem.h"
+#include "lwip/memp.h"
+#include "lwip/stats.h"
+#include "lwip/priv/memp_priv.h"
+
+/* Pool element types, as included by lwIP's memp.c */
+#include "lwip/pbuf.h"
+#include "lwip/raw.h"
+#include "lwip/udp.h"
+#include "lwip/tcp.h"
+#include "lwip/priv/tcp_priv.h"
+#include "lwip/altcp.h"
+#include "lwip/ip4_frag.h"
+#include "lwip/netbuf.h"
+#include "lwip/api.h"
+#include "lwip/priv/tcpip_priv.h"
+#include "lwip/priv/api_msg.h"
+#include "lwip/priv/sockets_priv.h"
+#include "lwip/etharp.h"
+#include "lwip/igmp.h"
+#include "lwip/timeouts.h"
+#include "netif/ppp/ppp_opts.h"
+#include "lwip/netdb.h"
+#include "lwip/dns.h"
+#include "lwip/priv/nd6_priv.h"
+#include "lwip/ip6_frag.h"
+#include "lwip/mld6.h"
+
+#include <stdio.h>
+
+#include "footprint.h"
+
+#if MEMP_MEM_MALLOC
+#define FOOTPRINT_POOL_BYTES(num, size) 0
+#else
+#define FOOTPRINT_POOL_BYTES(num, size) LWIP_MEM_ALIGN_BUFFER((num) * (MEMP_SIZE + MEMP_ALIGN_SIZE(size)))
+#endif
+
+#if MEM_LIBC_MALLOC || MEM_USE_POOLS
+#define FOOTPRINT_HEAP_BYTES 0
+#else
+/* ram_heap in mem.c: the heap plus two struct mem {next, prev, used} markers */
+#define FOOTPRINT_HEAP_BYTES \
+  LWIP_MEM_ALIGN_BUFFER(LWIP_MEM_ALIGN_SIZE(MEM_SIZE) + 2 * LWIP_MEM_ALIGN_SIZE(2 * sizeof(mem_size_t) + 1))
+#endif
+
+/**
+ * @brief Static RAM of all memory pools, expanded from lwIP's pool list.
+ */
+enum {
+  FOOTPRINT_POOLS_BYTES = 0
+#define LWIP_MEMPOOL(name, num, size, desc) + FOOTPRINT_POOL_BYTES(num, size)
+#include "lwip/priv/memp_std.h"
+};
+
+#if LWIP_RAM_BUDGET
+_Static_assert(FOOTPRINT_POOLS_BYTES + FOOTPRINT_HEAP_BYTES <= LWIP_RAM_BUDGET,
+               "lwIP memory pools and heap exceed LWIP_RAM_BUDGET, see footprint_dump()");
+#endif
+
+/**
+ * @brief Pool names, in memp_t order.
+ */
+static const char *const footprint_pool_names[MEMP_MAX] = {
+#define LWIP_MEMPOOL(name, num, size, desc) #name,
+#include "lwip/priv/memp_std.h"
+};
+
+/**
+ * @brief Returns the static RAM reserved by the lwIP pools and heap.
+ */
+size_t footprint_static_bytes(void)
+{
+  return FOOTPRINT_POOLS_BYTES + FOOTPRINT_HEAP_BYTES;
+}
+
+/**
+ * @brief Serializes the lwIP memory usage as CSV lines.
+ *
+ * @param out Callback receiving each line.
+ * @param arg User argument passed to @p out.
+ */
+void footprint_dump(void (*out)(const char *line, void *arg), void *arg)
+{
+  char line[72];
+
+  out("pool,size,num,bytes,used,max,err", arg);
+
+#if !MEMP_MEM_MALLOC
+  for (int i = 0; i < MEMP_MAX; i++) {
+    const struct memp_desc *pool = memp_pools[i];
+    int n = snprintf(line, sizeof(line), "%s,%u,%u,%lu,", footprint_pool_names[i],
+                     (unsigned)pool->size, (unsigned)pool->num,
+                     (unsigned long)pool->num * (MEMP_SIZE + pool->size));
+#if MEMP_STATS
+    snprintf(&line[n], sizeof(line) - n, "%u,%u,%u", (unsigned)pool->stats->used,
+             (unsigned)pool->stats->max, (unsigned)pool->stats->err);
+#else
+    snprintf(&line[n], sizeof(line) - n, ",,");
+#endif
+    out(line, arg);
+  }
+#endif /* !MEMP_MEM_MALLOC */
+
+#if !MEM_LIBC_MALLOC && !MEM_USE_POOLS
+  int n = snprintf(line, sizeof(line), "HEAP,%u,1,%lu,", (unsigned)MEM_SIZE, (unsigned long)FOOTPRINT_HEAP_BYTES);
+#if MEM_STATS
+  snprintf(&line[n], sizeof(line) - n, "%u,%u,%u", (unsigned)lwip_stats.mem.used,
+           (unsigned)lwip_stats.mem.max, (unsigned)lwip_stats.mem.err);
+#else
+  snprintf(&line[n], sizeof(line) - n, ",,");
+#endif
+  out(line, arg);
+#endif
+
+  snprintf(line, sizeof(line), "TOTAL,,,%lu,,,", (unsigned long)footprint_static_bytes());
+  out(line, arg);
+#if LWIP_RAM_BUDGET
+  snprintf(line, sizeof(line), "BUDGET,,,%lu,,,", (unsigned long)LWIP_RAM_BUDGET);
+  out(line, arg);
+#endif
+}
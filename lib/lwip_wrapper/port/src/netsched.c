@@ -0,0 +1,108 @@
+/**
+ * @file
+ * @brief Event-driven main loop: idle sleep between network events.
+ *
+ * Instead of spinning on ethif_poll() and sys_check_timeouts(), the loop
+ * sleeps while the last poll received no frames, until the next lwIP timer is
+ * due, the receive poll interval has passed or an interrupt reports a
+ * W5500 event.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/sys.h"
+#include "lwip/timeouts.h"
+
+#include "ethif.h"
+#include "netsched.h"
+
+static struct netsched_stats netsched_stats;  /**< Activity counters */
+static volatile bool netsched_pending;        /**< Set by netsched_notify() */
+static bool netsched_busy = true;             /**< Last poll received frames, poll again without sleeping */
+static u32_t netsched_mark;                   /**< sys_cycles() at the end of the last sleep */
+
+/**
+ * @brief Sleeps until the next lwIP timer, NETSCHED_POLL_MS or netsched_notify().
+ */
+static void netsched_idle(void)
+{
+  u32_t sleep_ms = sys_timeouts_sleeptime();
+  if (sleep_ms > NETSCHED_POLL_MS) {
+    sleep_ms = NETSCHED_POLL_MS;
+  }
+  if (sleep_ms == 0 || netsched_pending) {
+    return;
+  }
+
+  u32_t start_ms = sys_now();
+  u32_t start = sys_cycles();
+  netsched_stats.busy_cycles += start - netsched_mark;
+  netsched_stats.sleeps++;
+
+  // The tick interrupt wakes the MCU at least every millisecond
+  while (!netsched_pending && sys_now() - start_ms < sleep_ms) {
+    sys_prot_t lev = sys_arch_protect();
+    if (!netsched_pending) {
+      sys_arch_idle();
+    }
+    sys_arch_unprotect(lev);
+  }
+  if (netsched_pending) {
+    netsched_stats.notified++;
+  }
+
+  netsched_mark = sys_cycles();
+  netsched_stats.sleep_cycles += netsched_mark - start;
+}
+
+void netsched_run(void)
+{
+  netsched_stats.loops++;
+  if (!netsched_busy) {
+    netsched_idle();
+  }
+  // Cleared before the poll, so an event raised during it is not lost
+  netsched_pending = false;
+
+  // Frames may be left in the chips after a bounded poll
+  netsched_busy = ethif_poll_all() > 0;
+  sys_check_timeouts();
+}
+
+void netsched_notify(void)
+{
+  netsched_pending = true;
+}
+
+void netsched_get_stats(struct netsched_stats *stats)
+{
+  sys_prot_t lev = sys_arch_protect();
+  *stats = netsched_stats;
+  sys_arch_unprotect(lev);
+}
+
+void netsched_reset_stats(void)
+{
+  memset(&netsched_stats, 0, sizeof(netsched_stats));
+  netsched_mark = sys_cycles();
+  sys_arch_irq_off_reset();
+}
+
+void netsched_dump(void (*out)(const char *line, void *arg), void *arg)
+{
+  char line[96];
+  uint64_t busy = netsched_stats.busy_cycles + (u32_t)(sys_cycles() - netsched_mark);
+  uint64_t total = busy + netsched_stats.sleep_cycles;
+  uint32_t khz = sys_cycles_hz() / 1000;
+
+  out("loops,sleeps,notified,busy_ms,sleep_ms,duty_pct,irq_off_max_us", arg);
+  snprintf(line, sizeof(line), "%lu,%lu,%lu,%lu,%lu,%u,%lu",
+           (unsigned long)netsched_stats.loops, (unsigned long)netsched_stats.sleeps,
+           (unsigned long)netsched_stats.notified, (unsigned long)(busy / khz),
+           (unsigned long)(netsched_stats.sleep_cycles / khz),
+           (unsigned)(total ? busy * 100 / total : 100),
+           (unsigned long)((uint64_t)sys_arch_irq_off_max() * 1000000u / sys_cycles_hz()));
+  out(line, arg);
+}
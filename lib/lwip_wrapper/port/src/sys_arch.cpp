@@ -2,8 +2,8 @@
  * @file
  * @brief System architecture abstraction for lwIP on Arduino (AVR and ARM Cortex-M).
  *
- * Provides critical section protection, debug output, assertions, timing,
- * and utility functions required by lwIP.
+ * Provides critical section protection, timing, and utility functions
+ * required by lwIP. Debug output and assertions are in sys_log.cpp.
  */
 
 #include <Arduino.h>
@@ -12,7 +12,26 @@
 #include "lwip/sys.h"
 #include "lwip/arch.h"
 
+#if SYS_ARCH_IRQ_TIMING
+static u32_t irq_off_start;  /**< sys_cycles() at which the outermost sys_arch_protect() disabled interrupts */
+static u32_t irq_off_max;    /**< Longest interrupts-off interval, in sys_cycles() */
+
+/**
+ * @brief Accounts an interrupts-off interval ending now.
+ *
+ * Called with interrupts still disabled.
+ */
+static inline void irq_off_end(void) {
+    u32_t off = sys_cycles() - irq_off_start;
+    if (off > irq_off_max) {
+        irq_off_max = off;
+    }
+}
+#endif
+
 #if defined(__AVR__)
+#include <avr/sleep.h>
+
 /**
  * @brief Enter a critical section by disabling interrupts on AVR.
  *
@@ -23,6 +42,11 @@
 extern "C" sys_prot_t sys_arch_protect(void) {
     uint8_t state = SREG;
     cli();
+#if SYS_ARCH_IRQ_TIMING
+    if (state & _BV(SREG_I)) {
+        irq_off_start = sys_cycles();
+    }
+#endif
     return (sys_prot_t)state;
 }
 
@@ -34,9 +58,56 @@ extern "C" sys_prot_t sys_arch_protect(void) {
  * @param state The interrupt state to restore.
  */
 extern "C" void sys_arch_unprotect(sys_prot_t state) {
+#if SYS_ARCH_IRQ_TIMING
+    if (state & _BV(SREG_I)) {
+        irq_off_end();
+    }
+#endif
     SREG = (uint8_t)state;
 }
 
+/**
+ * @brief Returns a free-running counter on AVR.
+ *
+ * AVR has no cycle counter; microseconds from `micros()` are used instead.
+ *
+ * @return Current time in microseconds.
+ */
+extern "C" u32_t sys_cycles(void) {
+    return micros();
+}
+
+/**
+ * @brief Returns the frequency of sys_cycles() on AVR.
+ *
+ * @return Ticks per second.
+ */
+extern "C" u32_t sys_cycles_hz(void) {
+    return 1000000UL;
+}
+
+/**
+ * @brief Sleep until the next interrupt on AVR (idle mode).
+ *
+ * AVR only wakes on an enabled interrupt, so interrupts are re-enabled
+ * right before SLEEP; the instruction after SEI always executes first, so
+ * an interrupt cannot slip in between. Interrupts are disabled again on
+ * return, as the caller's sys_arch_protect() section expects, like WFI
+ * under PRIMASK on Cortex-M.
+ */
+extern "C" void sys_arch_idle(void) {
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+    cli();
+#if SYS_ARCH_IRQ_TIMING
+    // Interrupts were enabled while asleep; the caller's section restarts here
+    irq_off_start = sys_cycles();
+#endif
+}
+
 #elif defined(__arm__) || defined(__ARM_ARCH) || defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
 
 /**
@@ -49,6 +120,11 @@ extern "C" void sys_arch_unprotect(sys_prot_t state) {
 extern "C" sys_prot_t sys_arch_protect(void) {
     uint32_t state = __get_PRIMASK();
     __disable_irq();
+#if SYS_ARCH_IRQ_TIMING
+    if (state == 0) {
+        irq_off_start = sys_cycles();
+    }
+#endif
     return (sys_prot_t)state;
 }
 
@@ -60,98 +136,96 @@ extern "C" sys_prot_t sys_arch_protect(void) {
  * @param state The PRIMASK state to restore.
  */
 extern "C" void sys_arch_unprotect(sys_prot_t state) {
+#if SYS_ARCH_IRQ_TIMING
+    if (state == 0) {
+        irq_off_end();
+    }
+#endif
     __set_PRIMASK((uint32_t)state);
 }
 
-#else
-#error "Unsupported platform. Only AVR and ARM Cortex-M supported."
-#endif
-
-#if defined(LWIP_DEBUG) && LWIP_DEBUG
-
 /**
- * @brief Prints a debug message prefixed by [lwip].
+ * @brief Returns the CPU cycle counter on ARM Cortex-M.
+ *
+ * Uses DWT->CYCCNT where available (Cortex-M3 and up). Cortex-M0/M0+ has no
+ * DWT cycle counter, so SysTick is extended with the millisecond tick count.
  *
- * @param msg Null-terminated message string.
+ * @return Current cycle count.
  */
-extern "C" void lwip_debug_print(const char* msg) {
-  Serial.print("[lwip] ");
-  Serial.print(msg);
+extern "C" u32_t sys_cycles(void) {
+#if defined(DWT_CTRL_CYCCNTENA_Msk)
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    return DWT->CYCCNT;
+#else
+    uint32_t ms, val, pending;
+    do {
+        ms = millis();
+        val = SysTick->VAL;
+        pending = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+    } while (ms != millis());
+    if (pending) {
+        /* SysTick wrapped but the tick interrupt has not run yet */
+        val = SysTick->VAL;
+        ms++;
+    }
+    uint32_t load = SysTick->LOAD + 1;
+    return ms * load + (load - 1 - val);
+#endif
 }
 
 /**
- * @brief Prints a formatted debug message prefixed by [lwip].
+ * @brief Returns the frequency of sys_cycles() on ARM Cortex-M.
  *
- * @param fmt Format string (printf-style).
- * @param ... Format arguments.
+ * @return CPU clock in Hz.
  */
-extern "C" void lwip_debug_printf(const char* fmt, ...) {
-  char buf[128];
-  va_list args;
-  va_start(args, fmt);
-  vsnprintf(buf, sizeof(buf), fmt, args);
-  va_end(args);
-  Serial.print("[lwip] ");
-  Serial.print(buf);
+extern "C" u32_t sys_cycles_hz(void) {
+    return SystemCoreClock;
 }
 
 /**
- * @brief Prints a formatted message without prefix.
- *
- * Used mainly for hex dumps and raw data output.
+ * @brief Sleep until the next interrupt on ARM Cortex-M.
  *
- * @param fmt Format string (printf-style).
- * @param ... Format arguments.
+ * WFI wakes on a pending interrupt even while PRIMASK masks it.
  */
-extern "C" void lwip_dump_printf(const char* fmt, ...) {
-  char buf[128];
-  va_list args;
-  va_start(args, fmt);
-  vsnprintf(buf, sizeof(buf), fmt, args);
-  va_end(args);
-  Serial.print(buf);
+extern "C" void sys_arch_idle(void) {
+    __DSB();
+    __WFI();
+#if SYS_ARCH_IRQ_TIMING
+    // A pending interrupt ends the sleep at once, so it does not count as masked
+    irq_off_start = sys_cycles();
+#endif
 }
 
+#else
+#error "Unsupported platform. Only AVR and ARM Cortex-M supported."
+#endif
+
 /**
- * @brief Handles lwIP assertion failures.
- *
- * Prints assertion message, source file, and line number, then halts execution.
+ * @brief Returns the longest interrupts-off interval of sys_arch_protect().
  *
- * @param msg Assertion message.
- * @param file Source file name.
- * @param line Line number in source file.
+ * @return Interval in sys_cycles(), 0 without SYS_ARCH_IRQ_TIMING.
  */
-extern "C" void lwip_assert(const char* msg, const char* file, int line) {
-  Serial.print("ASSERT: ");
-  Serial.print(msg);
-  Serial.print(" at ");
-  Serial.print(file);
-  Serial.print(":");
-  Serial.println(line);
-  while (1);  // Halt
+extern "C" u32_t sys_arch_irq_off_max(void) {
+#if SYS_ARCH_IRQ_TIMING
+    return irq_off_max;
+#else
+    return 0;
+#endif
 }
 
 /**
- * @brief Dumps a block of memory in hex format.
- *
- * Prints a label, length, and hex dump of the data buffer.
- *
- * @param label Description label for the data.
- * @param data Pointer to the data buffer.
- * @param len Length of the data buffer in bytes.
+ * @brief Clears the longest interrupts-off interval.
  */
-extern "C" void hex_dump_lwip(const char *label, const void *data, size_t len) {
-  const uint8_t *d = (const uint8_t *)data;
-  lwip_dump_printf("%s (%u bytes):\n", label, (unsigned int)len);
-  for (size_t i = 0; i < len; i++) {
-    if (i % 16 == 0) lwip_dump_printf("%04x: ", (unsigned int)i);
-    lwip_dump_printf("%02x ", d[i]);
-    if (i % 16 == 15 || i == len - 1) lwip_dump_printf("\n");
-  }
+extern "C" void sys_arch_irq_off_reset(void) {
+#if SYS_ARCH_IRQ_TIMING
+    irq_off_max = 0;
+#endif
 }
 
-#endif //LWIP_DEBUG
-
 /**
  * @brief Returns the current system time in milliseconds.
  *
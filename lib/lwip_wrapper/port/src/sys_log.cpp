@@ -0,0 +1,469 @@
+/**
+ * @file
+ * @brief Deferred lwIP debug output for Arduino.
+ *
+ * lwip_debug_printf() and hex_dump_lwip() only record the format string
+ * and the binary arguments in a lock-free single-producer ring;
+ * lwip_debug_flush(), called from the main loop, formats the records and
+ * writes them to Serial as fast as the port accepts them.
+ */
+
+#include <Arduino.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/arch.h"
+
+#if defined(LWIP_DEBUG) && LWIP_DEBUG
+
+#ifndef LWIP_LOG_RING_SIZE
+#define LWIP_LOG_RING_SIZE    32   /**< Number of log records, must be a power of two */
+#endif
+
+#ifndef LWIP_LOG_RECORD_DATA
+#define LWIP_LOG_RECORD_DATA  28   /**< Bytes of arguments or dump data per record */
+#endif
+
+#ifndef LWIP_LOG_DUMP_MAX
+#define LWIP_LOG_DUMP_MAX     64   /**< Bytes captured per hex dump */
+#endif
+
+#if (LWIP_LOG_RING_SIZE & (LWIP_LOG_RING_SIZE - 1)) != 0
+#error "LWIP_LOG_RING_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief Kind of a deferred log record.
+ */
+enum {
+  LOG_PRINTF = 0,  /**< Format string with packed binary arguments */
+  LOG_DUMP   = 1   /**< Slice of a hex dump capture */
+};
+
+/**
+ * @brief Deferred log record.
+ *
+ * Holds a pointer to the (static) format string or dump label together with
+ * the binary arguments or captured bytes. Formatting is done by the consumer.
+ */
+struct log_record {
+  const char *fmt;                     /**< Format string or dump label */
+  uint8_t kind;                        /**< LOG_PRINTF or LOG_DUMP */
+  uint8_t len;                         /**< Bytes used in data */
+  uint16_t offset;                     /**< Dump: offset of data within the capture */
+  uint16_t total;                      /**< Dump: original length of the dumped buffer */
+  uint8_t data[LWIP_LOG_RECORD_DATA];  /**< Packed arguments or captured bytes */
+};
+
+static struct log_record log_ring[LWIP_LOG_RING_SIZE];  /**< Record storage */
+static uint16_t log_head;                               /**< Next slot to write (producer) */
+static uint16_t log_tail;                               /**< Next slot to read (consumer) */
+static u32_t log_dropped;                               /**< Records lost because the ring was full */
+static u32_t log_dropped_reported;                      /**< Drop count already reported */
+static char log_line[128];                              /**< Formatted line being written out */
+static size_t log_line_len;                             /**< Length of log_line */
+static size_t log_line_pos;                             /**< Bytes of log_line already written */
+static size_t log_dump_pos;                             /**< Dump bytes of the record at log_tail already formatted */
+static bool log_dump_open;                              /**< The record at log_tail is a dump partly formatted */
+
+/**
+ * @brief Reserves the next free record, or counts a drop if the ring is full.
+ *
+ * @return Record to fill and publish with log_commit(), or NULL.
+ */
+static struct log_record *log_reserve(void) {
+  uint16_t head = log_head;
+  uint16_t tail = __atomic_load_n(&log_tail, __ATOMIC_ACQUIRE);
+  if ((uint16_t)(head - tail) >= LWIP_LOG_RING_SIZE) {
+    log_dropped++;
+    return NULL;
+  }
+  return &log_ring[head & (LWIP_LOG_RING_SIZE - 1)];
+}
+
+/**
+ * @brief Publishes the record obtained from log_reserve() to the consumer.
+ */
+static void log_commit(void) {
+  __atomic_store_n(&log_head, (uint16_t)(log_head + 1), __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Appends a value to a record's argument area.
+ *
+ * @return false if the value does not fit.
+ */
+static bool log_pack(struct log_record *r, const void *v, size_t n) {
+  if (r->len + n > sizeof(r->data)) return false;
+  memcpy(&r->data[r->len], v, n);
+  r->len += n;
+  return true;
+}
+
+/**
+ * @brief Packs variadic arguments according to a printf format string.
+ *
+ * Integers, pointers and doubles are stored in binary; strings are copied
+ * (truncated if needed) since they may not outlive the call. Packing stops
+ * when the record is full; the formatter marks such records as truncated.
+ */
+static void log_pack_args(struct log_record *r, const char *fmt, va_list args) {
+  for (const char *f = fmt; *f; f++) {
+    if (*f != '%') continue;
+    f++;
+    while (*f && strchr("-+ #0", *f)) f++;
+    while (*f && (isdigit((unsigned char)*f) || *f == '.' || *f == '*')) {
+      if (*f == '*') {
+        int v = va_arg(args, int);
+        if (!log_pack(r, &v, sizeof(v))) return;
+      }
+      f++;
+    }
+    int lng = 0;
+    bool sz = false;
+    while (*f && strchr("hlzjt", *f)) {
+      if (*f == 'l') lng++;
+      if (*f == 'z') sz = true;
+      f++;
+    }
+    bool ok = true;
+    switch (*f) {
+      case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+        if (sz)            { size_t v = va_arg(args, size_t); ok = log_pack(r, &v, sizeof(v)); }
+        else if (lng >= 2) { long long v = va_arg(args, long long); ok = log_pack(r, &v, sizeof(v)); }
+        else if (lng == 1) { long v = va_arg(args, long); ok = log_pack(r, &v, sizeof(v)); }
+        else               { int v = va_arg(args, int); ok = log_pack(r, &v, sizeof(v)); }
+        break;
+      case 'p': {
+        void *v = va_arg(args, void *);
+        ok = log_pack(r, &v, sizeof(v));
+        break;
+      }
+      case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A': {
+        double v = va_arg(args, double);
+        ok = log_pack(r, &v, sizeof(v));
+        break;
+      }
+      case 's': {
+        const char *v = va_arg(args, const char *);
+        if (!v) v = "(null)";
+        size_t room = sizeof(r->data) - r->len;
+        if (room == 0) return;
+        size_t n = strnlen(v, room - 1);
+        memcpy(&r->data[r->len], v, n);
+        r->data[r->len + n] = '\0';
+        r->len += n + 1;
+        break;
+      }
+      case '\0':
+        return;
+      default:
+        break;
+    }
+    if (!ok) return;
+  }
+}
+
+/**
+ * @brief Reads a packed value from a record.
+ *
+ * @return false if the record was truncated before this value.
+ */
+static bool log_unpack(const struct log_record *r, size_t *pos, void *v, size_t n) {
+  if (*pos + n > r->len) return false;
+  memcpy(v, &r->data[*pos], n);
+  *pos += n;
+  return true;
+}
+
+/**
+ * @brief Formats a LOG_PRINTF record, one conversion at a time.
+ *
+ * @return Number of characters written to @p out.
+ */
+static size_t log_format_printf(const struct log_record *r, char *out, size_t size) {
+  size_t n = 0;
+  size_t pos = 0;
+  const char *f = r->fmt;
+
+  while (*f && n + 1 < size) {
+    if (*f != '%') { out[n++] = *f++; continue; }
+    if (f[1] == '%') { out[n++] = '%'; f += 2; continue; }
+
+    /* Copy one conversion spec, substituting '*' with its packed value */
+    char spec[24];
+    size_t s = 0;
+    bool ok = true;
+    spec[s++] = *f++;
+    while (*f && !isalpha((unsigned char)*f) && s < sizeof(spec) - 12) {
+      if (*f == '*') {
+        int v = 0;
+        ok = ok && log_unpack(r, &pos, &v, sizeof(v));
+        s += snprintf(&spec[s], sizeof(spec) - s, "%d", v);
+        f++;
+      } else {
+        spec[s++] = *f++;
+      }
+    }
+    int lng = 0;
+    bool sz = false;
+    while (*f && strchr("hlzjt", *f) && s < sizeof(spec) - 2) {
+      if (*f == 'l') lng++;
+      if (*f == 'z') sz = true;
+      spec[s++] = *f++;
+    }
+    if (!*f) break;
+    char conv = *f++;
+    spec[s++] = conv;
+    spec[s] = '\0';
+
+    size_t room = size - n;
+    int w = 0;
+    switch (conv) {
+      case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+        if (sz)            { size_t v;    if ((ok = ok && log_unpack(r, &pos, &v, sizeof(v)))) w = snprintf(&out[n], room, spec, v); }
+        else if (lng >= 2) { long long v; if ((ok = ok && log_unpack(r, &pos, &v, sizeof(v)))) w = snprintf(&out[n], room, spec, v); }
+        else if (lng == 1) { long v;      if ((ok = ok && log_unpack(r, &pos, &v, sizeof(v)))) w = snprintf(&out[n], room, spec, v); }
+        else               { int v;       if ((ok = ok && log_unpack(r, &pos, &v, sizeof(v)))) w = snprintf(&out[n], room, spec, v); }
+        break;
+      case 'p': {
+        void *v;
+        if ((ok = ok && log_unpack(r, &pos, &v, sizeof(v)))) w = snprintf(&out[n], room, spec, v);
+        break;
+      }
+      case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A': {
+        double v;
+        if ((ok = ok && log_unpack(r, &pos, &v, sizeof(v)))) w = snprintf(&out[n], room, spec, v);
+        break;
+      }
+      case 's':
+        ok = ok && pos < r->len;
+        if (ok) {
+          const char *v = (const char *)&r->data[pos];
+          pos += strlen(v) + 1;
+          w = snprintf(&out[n], room, spec, v);
+        }
+        break;
+      default:
+        w = snprintf(&out[n], room, "%s", spec);
+        break;
+    }
+    if (!ok) {
+      /* Arguments were truncated when packed: mark and keep the line ending */
+      size_t flen = strlen(r->fmt);
+      bool nl = flen > 0 && r->fmt[flen - 1] == '\n';
+      w = snprintf(&out[n], room, nl ? "~\n" : "~");
+      n += (size_t)w < room ? (size_t)w : room - 1;
+      break;
+    }
+    n += (size_t)w < room ? (size_t)w : room - 1;
+  }
+  out[n] = '\0';
+  return n;
+}
+
+/**
+ * @brief Formats the next lines of a LOG_DUMP record as hex dump lines.
+ *
+ * Only whole lines are written, as many as fit in @p out; the rest of the
+ * record is formatted by the next call. A label too long for the line is
+ * clipped and marked with '~'.
+ *
+ * @param finished Set to true once the whole record has been formatted.
+ * @return Number of characters written to @p out.
+ */
+static size_t log_format_dump(const struct log_record *r, char *out, size_t size, bool *finished) {
+  size_t n = 0;
+  *finished = false;
+  if (r->offset == 0 && !log_dump_open) {
+    size_t llen = strlen(r->fmt);
+    size_t lmax = size - 24;
+    bool clip = llen > lmax;
+    n += snprintf(out, size, "%.*s%s (%u bytes):\n", (int)(clip ? lmax - 1 : llen), r->fmt,
+                  clip ? "~" : "", (unsigned int)r->total);
+  }
+  log_dump_open = true;
+  while (log_dump_pos < r->len) {
+    size_t at = r->offset + log_dump_pos;
+    size_t row = 16 - at % 16;
+    if (row > r->len - log_dump_pos) row = r->len - log_dump_pos;
+    if (n + 6 + 3 * row + 2 > size) return n;
+    if (at % 16 == 0) n += snprintf(&out[n], size - n, "%04x: ", (unsigned int)at);
+    for (size_t i = 0; i < row; i++) {
+      n += snprintf(&out[n], size - n, "%02x ", r->data[log_dump_pos + i]);
+    }
+    log_dump_pos += row;
+    at += row;
+    bool last = log_dump_pos == r->len && (at == r->total || at == LWIP_LOG_DUMP_MAX);
+    if (at % 16 == 0 || last) n += snprintf(&out[n], size - n, "\n");
+  }
+  if (r->offset + r->len == LWIP_LOG_DUMP_MAX && r->total > LWIP_LOG_DUMP_MAX) {
+    if (n + 32 > size) return n;
+    n += snprintf(&out[n], size - n, "... (%u bytes not captured)\n",
+                  (unsigned int)(r->total - LWIP_LOG_DUMP_MAX));
+  }
+  log_dump_pos = 0;
+  log_dump_open = false;
+  *finished = true;
+  return n;
+}
+
+/**
+ * @brief Queues a debug message prefixed by [lwip].
+ *
+ * @param msg Null-terminated message string.
+ */
+extern "C" void lwip_debug_print(const char* msg) {
+  lwip_debug_printf("%s", msg);
+}
+
+/**
+ * @brief Queues a formatted debug message prefixed by [lwip].
+ *
+ * Only the format string pointer and the binary arguments are recorded;
+ * the message is formatted and printed later by lwip_debug_flush().
+ *
+ * @param fmt Format string (printf-style), must have static storage.
+ * @param ... Format arguments.
+ */
+extern "C" void lwip_debug_printf(const char* fmt, ...) {
+  struct log_record *r = log_reserve();
+  if (!r) return;
+  r->fmt = fmt;
+  r->kind = LOG_PRINTF;
+  r->len = 0;
+  va_list args;
+  va_start(args, fmt);
+  log_pack_args(r, fmt, args);
+  va_end(args);
+  log_commit();
+}
+
+/**
+ * @brief Writes as much of the pending output line as the serial port accepts.
+ *
+ * @return true if the line has been written completely.
+ */
+static bool log_line_write(void) {
+  while (log_line_pos < log_line_len) {
+    int room = Serial.availableForWrite();
+    if (room <= 0) return false;
+    size_t n = log_line_len - log_line_pos;
+    if (n > (size_t)room) n = (size_t)room;
+    Serial.write((const uint8_t *)&log_line[log_line_pos], n);
+    log_line_pos += n;
+  }
+  return true;
+}
+
+/**
+ * @brief Formats and prints queued log records.
+ *
+ * Never blocks on the serial port: output is written only as fast as the
+ * port accepts it, and a partially written line is resumed on the next call.
+ * Intended to be called from the idle part of the main loop.
+ *
+ * @param max_records Maximum number of records to format in this call.
+ * @return Number of records formatted.
+ */
+extern "C" u32_t lwip_debug_flush(u32_t max_records) {
+  u32_t done = 0;
+
+  while (log_line_write()) {
+    uint16_t tail = log_tail;
+    bool empty = tail == __atomic_load_n(&log_head, __ATOMIC_ACQUIRE);
+
+    if (empty && log_dropped != log_dropped_reported) {
+      log_line_len = snprintf(log_line, sizeof(log_line), "[lwip] %lu log records dropped\n",
+                              (unsigned long)(log_dropped - log_dropped_reported));
+      log_line_pos = 0;
+      log_dropped_reported = log_dropped;
+      continue;
+    }
+
+    if (empty || done >= max_records) break;
+
+    const struct log_record *r = &log_ring[tail & (LWIP_LOG_RING_SIZE - 1)];
+    if (r->kind == LOG_DUMP) {
+      bool finished;
+      log_line_len = log_format_dump(r, log_line, sizeof(log_line), &finished);
+      log_line_pos = 0;
+      if (!finished) continue;
+    } else {
+      memcpy(log_line, "[lwip] ", 7);
+      log_line_len = 7 + log_format_printf(r, &log_line[7], sizeof(log_line) - 7);
+    }
+    log_line_pos = 0;
+
+    __atomic_store_n(&log_tail, (uint16_t)(tail + 1), __ATOMIC_RELEASE);
+    done++;
+  }
+  return done;
+}
+
+/**
+ * @brief Returns the number of log records dropped because the ring was full.
+ *
+ * @return Total dropped records since startup.
+ */
+extern "C" u32_t lwip_debug_dropped(void) {
+  return log_dropped;
+}
+
+/**
+ * @brief Handles lwIP assertion failures.
+ *
+ * Prints pending log records, the assertion message, source file and line
+ * number synchronously, then halts execution.
+ *
+ * @param msg Assertion message.
+ * @param file Source file name.
+ * @param line Line number in source file.
+ */
+extern "C" void lwip_assert(const char* msg, const char* file, int line) {
+  while (log_tail != log_head || log_line_pos < log_line_len) {
+    lwip_debug_flush(LWIP_LOG_RING_SIZE);
+  }
+  Serial.print("ASSERT: ");
+  Serial.print(msg);
+  Serial.print(" at ");
+  Serial.print(file);
+  Serial.print(":");
+  Serial.println(line);
+  while (1);  // Halt
+}
+
+/**
+ * @brief Captures a block of memory for a deferred hex dump.
+ *
+ * At most LWIP_LOG_DUMP_MAX bytes are copied into consecutive log records;
+ * formatting happens later in lwip_debug_flush().
+ *
+ * @param label Description label for the data, must have static storage.
+ * @param data Pointer to the data buffer.
+ * @param len Length of the data buffer in bytes.
+ */
+extern "C" void hex_dump_lwip(const char *label, const void *data, size_t len) {
+  const uint8_t *d = (const uint8_t *)data;
+  size_t captured = len < LWIP_LOG_DUMP_MAX ? len : LWIP_LOG_DUMP_MAX;
+  size_t offset = 0;
+
+  do {
+    struct log_record *r = log_reserve();
+    if (!r) return;
+    size_t n = captured - offset;
+    if (n > sizeof(r->data)) n = sizeof(r->data);
+    r->fmt = label;
+    r->kind = LOG_DUMP;
+    r->len = n;
+    r->offset = offset;
+    r->total = len;
+    memcpy(r->data, &d[offset], n);
+    log_commit();
+    offset += n;
+  } while (offset < captured);
+}
+
+#endif //LWIP_DEBUG
@@ -0,0 +1,138 @@
+/**
+ * @file
+ * @brief Backpressure-aware send queue on top of the raw TCP API.
+ *
+ * tcp_write() fails with ERR_MEM once a payload exceeds tcp_sndbuf() or
+ * TCP_SND_QUEUELEN. A stream keeps the rest of the payload as producer
+ * callbacks and refills the send buffer as acknowledgements free it.
+ */
+
+#include "lwip/opt.h"
+
+#if LWIP_TCP
+
+#include <string.h>
+
+#include "lwip/priv/tcp_priv.h"
+
+#include "tcp_stream.h"
+
+/**
+ * @brief Producer of tcp_stream_push_buf() sources: @p arg is the buffer.
+ */
+static u16_t tcp_stream_buf_produce(void *arg, u32_t offset, const void **data, u16_t max)
+{
+  *data = (const u8_t *)arg + offset;
+  return max;
+}
+
+/**
+ * @brief Returns the bytes that complete the last unsent segment.
+ *
+ * tcp_write() appends to that segment first, so a chunk of this length
+ * ends on a segment boundary, and so does every following MSS chunk.
+ */
+static u16_t tcp_stream_seg_fill(const struct tcp_pcb *pcb)
+{
+  const struct tcp_seg *last = pcb->unsent;
+
+  if (last == NULL) {
+    return TCP_MSS;
+  }
+  while (last->next != NULL) {
+    last = last->next;
+  }
+  return last->len < TCP_MSS ? (u16_t)(TCP_MSS - last->len) : TCP_MSS;
+}
+
+/**
+ * @brief Drops the head source once it has been fully queued.
+ */
+static void tcp_stream_pop(struct tcp_stream *stream)
+{
+  stream->head = (u8_t)((stream->head + 1) % TCP_STREAM_QUEUE_LEN);
+  stream->count--;
+  stream->offset = 0;
+}
+
+void tcp_stream_init(struct tcp_stream *stream, struct tcp_pcb *pcb)
+{
+  memset(stream, 0, sizeof(*stream));
+  stream->pcb = pcb;
+}
+
+err_t tcp_stream_push(struct tcp_stream *stream, tcp_stream_produce_fn produce, void *arg, u32_t len, u8_t flags)
+{
+  if (stream->count >= TCP_STREAM_QUEUE_LEN) {
+    return ERR_MEM;
+  }
+  if (len == 0) {
+    return ERR_OK;
+  }
+
+  struct tcp_stream_source *src = &stream->queue[(stream->head + stream->count) % TCP_STREAM_QUEUE_LEN];
+  src->produce = produce;
+  src->arg = arg;
+  src->len = len;
+  src->flags = flags;
+  stream->count++;
+  return ERR_OK;
+}
+
+err_t tcp_stream_push_buf(struct tcp_stream *stream, const void *data, u32_t len, u8_t flags)
+{
+  return tcp_stream_push(stream, tcp_stream_buf_produce, (void *)data, len, flags);
+}
+
+err_t tcp_stream_pump(struct tcp_stream *stream, u32_t *queued)
+{
+  struct tcp_pcb *pcb = stream->pcb;
+
+  while (stream->count > 0 && tcp_sndqueuelen(pcb) < TCP_SND_QUEUELEN) {
+    const struct tcp_stream_source *src = &stream->queue[stream->head];
+    u32_t left = src->len - stream->offset;
+    u16_t fill = tcp_stream_seg_fill(pcb);
+    u16_t room = LWIP_MIN(tcp_sndbuf(pcb), fill);
+
+    // A short chunk would leave a segment part-filled: wait for the room to
+    // complete it, which an acknowledgement frees
+    if (room < LWIP_MIN(left, fill)) {
+      break;
+    }
+
+    const void *data;
+    u16_t n = src->produce(src->arg, stream->offset, &data, (u16_t)LWIP_MIN(left, room));
+    if (n == 0) {
+      break;
+    }
+    LWIP_ASSERT("tcp_stream: producer returned too much", n <= LWIP_MIN(left, room));
+
+    u8_t flags = (src->flags & TCP_STREAM_FLAG_COPY) ? TCP_WRITE_FLAG_COPY : 0;
+    if (n < left || stream->count > 1) {
+      flags |= TCP_WRITE_FLAG_MORE;
+    }
+    err_t err = tcp_write(pcb, data, n, flags);
+    if (err == ERR_MEM) {
+      break;  // Out of segments or pbufs, retried on the next pump
+    }
+    if (err != ERR_OK) {
+      return err;
+    }
+
+    stream->offset += n;
+    if (queued) {
+      *queued += n;
+    }
+    if (stream->offset == src->len) {
+      tcp_stream_pop(stream);
+    }
+  }
+  return ERR_OK;
+}
+
+bool tcp_stream_pending(const struct tcp_stream *stream)
+{
+  return stream->count > 0;
+}
+
+#endif /* LWIP_TCP */
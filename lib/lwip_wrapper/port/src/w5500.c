@@ -3,6 +3,10 @@
  * @brief W5500 driver low-level SPI interface and register definitions.
  */
 
+#include <string.h>
+
+#include "lwip/sys.h"
+
 #include "ethif.h"
 
 /**
@@ -71,6 +75,29 @@ enum
     Sn_KPALVTR = 0x002F     /**< Keep-Alive Timer Register (R/W) */
 };
 
+/**
+ * @brief Chip identification
+ */
+enum
+{
+    W5500_VERSION = 0x04 /**< Expected VERSIONR value */
+};
+
+/**
+ * @brief Size of the TX buffer scratch area used by the SPI integrity check.
+ */
+#define W5500_CHECK_LEN 64
+
+/**
+ * @brief Socket 0 RX buffer size configured in w5500_init().
+ */
+#define W5500_RX_BUF_SIZE (16 * 1024)
+
+/**
+ * @brief Largest plausible MACRAW frame: Ethernet header, 802.1Q tag and MTU.
+ */
+#define W5500_MAX_FRAME (SIZEOF_ETH_HDR + 4 + ETHERNET_MTU)
+
 /**
  * @brief Mode Register Values
  */
@@ -212,6 +239,11 @@ enum
 /**
  * @brief Perform SPI I/O to read or write W5500 registers.
  *
+ * Transfers are split into chip-select cycles of at most ETHIF_SPI_CHUNK data
+ * bytes, each with its own address header. A cycle owns the SPI bus from
+ * begin() to end() (with ETHIF_SPI_PROTECT, also with interrupts disabled);
+ * between cycles the bus is free for other devices.
+ *
  * @param s Pointer to Ethernet interface.
  * @param block Register block.
  * @param addr Register address.
@@ -222,26 +254,59 @@ enum
 static void w5500_spi_io(struct ethif *s, uint8_t block, uint16_t addr,
                          bool wr, void *buf, size_t len)
 {
-    size_t i;
     uint8_t *p = (uint8_t *)buf;
-    uint8_t cmd[] = {
-        (uint8_t)(addr >> 8),
-        (uint8_t)(addr & 255),
-        (uint8_t)((block << 3) | (wr ? 4 : 0))};
 
-    s->begin(s->spi);
+    do
+    {
+        size_t i;
+        size_t n = len;
+        uint8_t cmd[] = {
+            (uint8_t)(addr >> 8),
+            (uint8_t)(addr & 255),
+            (uint8_t)((block << 3) | (wr ? 4 : 0))};
+
+#if ETHIF_SPI_CHUNK > 0
+        if (n > ETHIF_SPI_CHUNK)
+            n = ETHIF_SPI_CHUNK;
+#endif
 
-    for (i = 0; i < sizeof(cmd); i++)
-        s->txn(s->spi, cmd[i]);
+#if ETHIF_SPI_HOLD_TIMING
+        uint32_t start = sys_cycles();
+#endif
+#if ETHIF_SPI_PROTECT
+        sys_prot_t lev = sys_arch_protect();
+#endif
+        s->begin(s->spi);
+
+        for (i = 0; i < sizeof(cmd); i++)
+            s->txn(s->spi, cmd[i]);
+
+        for (i = 0; i < n; i++)
+        {
+            /* Clock out a fixed dummy byte on reads so the MOSI stream is deterministic */
+            uint8_t r = s->txn(s->spi, wr ? p[i] : 0);
+            if (!wr)
+                p[i] = r;
+        }
+
+        s->end(s->spi);
+#if ETHIF_SPI_PROTECT
+        sys_arch_unprotect(lev);
+#endif
+#if ETHIF_SPI_HOLD_TIMING
+        uint32_t held = sys_cycles() - start;
+        if (held > s->stats.spi_hold_max_cycles)
+            s->stats.spi_hold_max_cycles = held;
+#endif
 
-    for (i = 0; i < len; i++)
-    {
-        uint8_t r = s->txn(s->spi, p[i]);
-        if (!wr)
-            p[i] = r;
-    }
+        s->stats.spi_transactions++;
+        s->stats.spi_bytes += sizeof(cmd) + n;
 
-    s->end(s->spi);
+        /* Buffer addresses wrap at 64 KiB like the chip's own pointers */
+        addr = (uint16_t)(addr + n);
+        p += n;
+        len -= n;
+    } while (len > 0);
 }
 
 // clang-format off
@@ -277,6 +342,172 @@ static  uint16_t w5500_read_word(struct ethif *s, uint8_t block, uint16_t addr)
 
 // clang-format on
 
+/**
+ * @brief Verify SPI signal integrity.
+ *
+ * Reads VERSIONR and writes, then reads back, several bit patterns in the
+ * socket 0 TX buffer at Sn_TX_WR. Only buffer space past the write pointer
+ * is touched, so queued frames are unaffected.
+ *
+ * @param s Ethernet interface.
+ * @return True if every value read back matches.
+ */
+static bool w5500_check(struct ethif *s)
+{
+    uint8_t wbuf[W5500_CHECK_LEN];
+    uint8_t rbuf[W5500_CHECK_LEN];
+    size_t i;
+
+    uint8_t version = w5500_read_byte(s, COMMON_REGISTER, VERSIONR);
+    if (version != W5500_VERSION)
+    {
+        LWIP_DEBUGF(ETHIF_DEBUG, ("w5500_check: VERSIONR=%02X\n", version));
+        return false;
+    }
+
+    uint16_t ptr = w5500_read_word(s, SOCKET0_REGISTER, Sn_TX_WR);
+    for (unsigned pattern = 0; pattern < 4; pattern++)
+    {
+        for (i = 0; i < sizeof(wbuf); i++)
+        {
+            switch (pattern)
+            {
+            case 0: wbuf[i] = 0xFF; break;                          /* all ones */
+            case 1: wbuf[i] = (i & 1) ? 0xAA : 0x55; break;         /* alternating bits */
+            case 2: wbuf[i] = (uint8_t)(1 << (i & 7)); break;       /* walking one */
+            default: wbuf[i] = (uint8_t)(i * 0x9D + 0x3B); break;   /* pseudo-random */
+            }
+        }
+        w5500_write(s, SOCKET0_TX_BUFFER, ptr, wbuf, sizeof(wbuf));
+        w5500_read(s, SOCKET0_TX_BUFFER, ptr, rbuf, sizeof(rbuf));
+        if (memcmp(wbuf, rbuf, sizeof(wbuf)) != 0)
+        {
+            LWIP_DEBUGF(ETHIF_DEBUG, ("w5500_check: Readback mismatch, pattern %u\n", pattern));
+            return false;
+        }
+    }
+
+    return w5500_read_byte(s, COMMON_REGISTER, VERSIONR) == W5500_VERSION;
+}
+
+static bool w5500_reset(struct ethif *s);
+
+/**
+ * @brief Open socket 0 in MACRAW mode, with MAC filtering if a MAC address is set.
+ *
+ * @param s Ethernet interface.
+ * @return True if the socket reached SOCK_MACRAW.
+ */
+static bool w5500_socket_open(struct ethif *s)
+{
+    bool passed;
+
+    if (NULL != s->ethaddr) {
+        w5500_write_byte(s, SOCKET0_REGISTER, Sn_MR, Sn_MR_MFEN | Sn_MR_MACRAW);
+    } else {
+        w5500_write_byte(s, SOCKET0_REGISTER, Sn_MR, Sn_MR_MACRAW);
+    }
+    w5500_write_byte(s, SOCKET0_REGISTER, Sn_CR, Sn_CR_OPEN);
+
+    WAIT_OR_FAIL(MAX_LOOP_ITERATIONS, (0 != w5500_read_byte(s, SOCKET0_REGISTER, Sn_CR)), passed);
+
+    if ((!passed))
+    {
+        s->stats.timeouts[ETHIF_WAIT_INIT_OPEN]++;
+        LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SEVERE, ("w5500_socket_open: Timeout waiting for Sn_CR to clear\n"));
+        return false;
+    }
+
+    return w5500_read_byte(s, SOCKET0_REGISTER, Sn_SR) == SOCK_MACRAW;
+}
+
+/**
+ * @brief Close and re-open socket 0, resetting its RX and TX buffer pointers.
+ *
+ * @param s Ethernet interface.
+ * @return True if the socket is back in MACRAW mode.
+ */
+static bool w5500_socket_reopen(struct ethif *s)
+{
+    bool passed;
+
+    s->rx_frame_len = 0;
+
+    w5500_write_byte(s, SOCKET0_REGISTER, Sn_CR, Sn_CR_CLOSE);
+    WAIT_OR_FAIL(MAX_LOOP_ITERATIONS, (0 != w5500_read_byte(s, SOCKET0_REGISTER, Sn_CR)), passed);
+    if (passed)
+        WAIT_OR_FAIL(MAX_LOOP_ITERATIONS, (SOCK_CLOSED != w5500_read_byte(s, SOCKET0_REGISTER, Sn_SR)), passed);
+
+    return passed && w5500_socket_open(s);
+}
+
+/**
+ * @brief Resynchronize the socket 0 RX buffer after a desync.
+ *
+ * Closes and re-opens socket 0 in MACRAW mode, which resets the RX and TX
+ * pointers without touching the PHY, so the link stays up. Pending frames
+ * are lost. Every wait is bounded; if the socket cannot be re-opened the
+ * chip is reset as a last resort. The duration is recorded in
+ * rx_resync_max_us.
+ *
+ * @param s Ethernet interface.
+ * @return true if socket 0 is back in MACRAW mode.
+ */
+static bool w5500_rx_resync(struct ethif *s)
+{
+    bool passed;
+    uint32_t start = sys_cycles();
+
+    s->stats.rx_resyncs++;
+
+    passed = w5500_socket_reopen(s);
+    if (!passed)
+    {
+        s->stats.rx_resync_fails++;
+        if ((int32_t)(sys_now() - s->reset_next) >= 0)
+        {
+            LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SEVERE,
+                ("w5500_rx_resync: Socket 0 reopen failed, resetting chip\n"));
+            passed = w5500_reset(s);
+        }
+        else
+        {
+            LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SEVERE,
+                ("w5500_rx_resync: Socket 0 reopen failed, chip reset too recent\n"));
+        }
+    }
+
+    uint32_t us = (uint32_t)((uint64_t)(sys_cycles() - start) * 1000000u / sys_cycles_hz());
+    if (us > s->stats.rx_resync_max_us)
+        s->stats.rx_resync_max_us = us;
+    LWIP_DEBUGF(ETHIF_DEBUG, ("w5500_rx_resync: Done in %lu us\n", (unsigned long)us));
+
+    return passed;
+}
+
+/**
+ * @brief Handle a detected SPI error.
+ *
+ * Steps the SPI clock down, further while the integrity check keeps failing,
+ * then resynchronizes the RX buffer. The next link poll verifies VERSIONR.
+ *
+ * @param s Ethernet interface.
+ * @param what Description of the inconsistency, for the debug log.
+ */
+static void w5500_spi_fault(struct ethif *s, const char *what)
+{
+    s->stats.spi_errors++;
+    s->spi_verify_next = sys_now();
+    LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SERIOUS, ("w5500: SPI error: %s\n", what));
+
+    if (ethif_spi_step_down(s))
+    {
+        while (!w5500_check(s) && ethif_spi_step_down(s))
+            ;
+    }
+    w5500_rx_resync(s);
+}
+
 /**
  * @brief Read and verify a stable value from the Receive Buffer Size Register (RX_RSR).
  *
@@ -288,71 +519,197 @@ static bool w5500_read_rx_rsr_stable(struct ethif *s, uint16_t *len)
 {
     uint16_t tmp = w5500_read_word(s, SOCKET0_REGISTER, Sn_RX_RSR);
     *len = w5500_read_word(s, SOCKET0_REGISTER, Sn_RX_RSR);
-    return (*len == tmp);
+    if (*len != tmp)
+    {
+        s->stats.unstable_retries++;
+        return false;
+    }
+    return true;
 }
 
 /**
- * @brief Receive Ethernet frame from W5500.
+ * @brief Locate the next frame in the socket 0 RX buffer.
  *
- * @param buf Pointer to receive buffer.
- * @param buflen Length of buffer.
- * @param s Ethernet interface structure.
- * @return Size of received payload.
+ * Reads the MACRAW length header of the frame at Sn_RX_RD. If @p hdr is
+ * given, the first @p hdrlen bytes following the length header are read in
+ * the same SPI transaction. The result is cached in @p s until the frame is
+ * released, so a peek followed by a receive costs no extra register reads.
+ *
+ * @param[in]  s       Ethernet interface.
+ * @param[out] hdr     Optional buffer for the leading frame bytes.
+ * @param[in]  hdrlen  Size of @p hdr.
+ * @param[out] rsr     Optional pointer to store the stable Sn_RX_RSR value.
+ * @return true if a frame is pending, false if the buffer is empty or on timeout.
  */
-static size_t w5500_rx(void *buf, size_t buflen, struct ethif *s)
+static bool w5500_rx_next(struct ethif *s, uint8_t *hdr, size_t hdrlen, uint16_t *rsr)
 {
     bool passed;
 
+    if (s->rx_frame_len != 0 && hdr == NULL && rsr == NULL)
+        return true;
+
+    ETHIF_PROF_DECL(t);
     uint16_t len = 0;
     WAIT_OR_FAIL(MAX_LOOP_ITERATIONS, (!w5500_read_rx_rsr_stable(s, &len)), passed);
+    ETHIF_PROF_LAP(s, ETHIF_PROF_RX_RSR, t);
 
     if (!passed)
     {
+        s->stats.timeouts[ETHIF_WAIT_RX_RSR]++;
         LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SEVERE,
             ("w5500_rx: Timeout waiting for stable Sn_RX_RSR\n"));
-        return 0;
+        return false;
     }
 
-    if (len == 0)
-        return 0;
+    if (len > W5500_RX_BUF_SIZE)
+    {
+        w5500_spi_fault(s, "Sn_RX_RSR out of range");
+        return false;
+    }
 
-    uint16_t ptr = w5500_read_word(s, SOCKET0_REGISTER, Sn_RX_RD); // SOCKET_RX_RD
-    uint8_t header[2];
-    w5500_read(s, SOCKET0_RX_BUFFER, ptr, header, 2);
-    uint16_t frame_len = ((uint16_t)header[0] << 8) | header[1];
-    uint16_t payload_len = frame_len > 2 ? frame_len - 2 : 0;
+    if (rsr)
+        *rsr = len;
 
-    if (payload_len > buflen)
+    if (len == 0)
+        return false;
+
+    uint8_t header[2 + ETHIF_RX_PEEK_LEN];
+    size_t n = 0;
+    if (hdr)
+        n = hdrlen < ETHIF_RX_PEEK_LEN ? hdrlen : ETHIF_RX_PEEK_LEN;
+
+    /* Sn_RX_RD and Sn_RX_WR are adjacent; Sn_RX_RSR can never exceed their distance */
+    uint8_t ptrs[4];
+    w5500_read(s, SOCKET0_REGISTER, Sn_RX_RD, ptrs, sizeof(ptrs));
+    s->rx_ptr = ((uint16_t)ptrs[0] << 8) | ptrs[1];
+    uint16_t used = (uint16_t)((((uint16_t)ptrs[2] << 8) | ptrs[3]) - s->rx_ptr);
+    if (used < len || used > W5500_RX_BUF_SIZE)
     {
-        LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SEVERE,
-            ("w5500_rx: Frame too large: payload_len=%u > buflen=%u\n", payload_len, (unsigned)buflen));
-        payload_len = 0;
+        w5500_spi_fault(s, "Sn_RX_RSR inconsistent with Sn_RX_RD/Sn_RX_WR");
+        return false;
     }
-    else
+
+    w5500_read(s, SOCKET0_RX_BUFFER, s->rx_ptr, header, 2 + n);
+    s->rx_frame_len = ((uint16_t)header[0] << 8) | header[1];
+    ETHIF_PROF_LAP(s, ETHIF_PROF_RX_HEADER, t);
+
+    if (s->rx_frame_len < 2 + SIZEOF_ETH_HDR ||
+        s->rx_frame_len > 2 + W5500_MAX_FRAME ||
+        s->rx_frame_len > len)
     {
-        LWIP_DEBUGF(ETHIF_DEBUG, ("w5500_rx: Payload received: len=%u\n", (unsigned)payload_len));
-        w5500_read(s, SOCKET0_RX_BUFFER, ptr + 2, buf, payload_len);
+        LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SERIOUS,
+            ("w5500_rx: Implausible MACRAW header: len=%u, rsr=%u\n", (unsigned)s->rx_frame_len, (unsigned)len));
+        w5500_spi_fault(s, "implausible MACRAW header");
+        return false;
     }
 
-    w5500_write_word(s, SOCKET0_REGISTER, Sn_RX_RD, ptr + frame_len);
+    if (hdr)
+        memcpy(hdr, header + 2, n);
+
+    return true;
+}
+
+/**
+ * @brief Release the cached frame and hand its RX buffer space back to the W5500.
+ *
+ * @param s Ethernet interface.
+ * @return true if the RECV command completed.
+ */
+static bool w5500_rx_release(struct ethif *s)
+{
+    bool passed;
+
+    ETHIF_PROF_DECL(t);
+    w5500_write_word(s, SOCKET0_REGISTER, Sn_RX_RD, s->rx_ptr + s->rx_frame_len);
     w5500_write_byte(s, SOCKET0_REGISTER, Sn_CR, Sn_CR_RECV);
+    s->rx_frame_len = 0;
 
     WAIT_OR_FAIL(MAX_LOOP_ITERATIONS, (w5500_read_byte(s, SOCKET0_REGISTER, Sn_CR)), passed);
+    ETHIF_PROF_LAP(s, ETHIF_PROF_RX_RECV, t);
 
     if ((!passed))
     {
+        s->stats.timeouts[ETHIF_WAIT_RX_RECV]++;
         LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SEVERE,
             ("w5500_rx: Sn_CR not cleared after RECV command\n"));
+    }
+    return passed;
+}
+
+/**
+ * @brief Receive Ethernet frame from W5500.
+ *
+ * @param buf Pointer to receive buffer.
+ * @param buflen Length of buffer.
+ * @param have Leading frame bytes already copied to @p buf from w5500_peek(),
+ *             not clocked out again.
+ * @param s Ethernet interface structure.
+ * @return Size of received payload.
+ */
+static size_t w5500_rx(void *buf, size_t buflen, size_t have, struct ethif *s)
+{
+    if (!w5500_rx_next(s, NULL, 0, NULL))
         return 0;
+
+    uint16_t payload_len = s->rx_frame_len > 2 ? s->rx_frame_len - 2 : 0;
+
+    if (payload_len > buflen)
+    {
+        s->stats.rx_oversize++;
+        LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SEVERE,
+            ("w5500_rx: Frame too large: payload_len=%u > buflen=%u\n", payload_len, (unsigned)buflen));
+        payload_len = 0;
+    }
+    else
+    {
+        LWIP_DEBUGF(ETHIF_DEBUG, ("w5500_rx: Payload received: len=%u\n", (unsigned)payload_len));
+        if (have > payload_len)
+            have = payload_len;
+        ETHIF_PROF_DECL(t);
+        w5500_read(s, SOCKET0_RX_BUFFER, s->rx_ptr + 2 + have, (uint8_t *)buf + have, payload_len - have);
+        ETHIF_PROF_LAP(s, ETHIF_PROF_RX_PAYLOAD, t);
     }
 
-#if defined(ETHIF_RX_DUMP_DEBUG) && ETHIF_RX_DUMP_DEBUG
-    hex_dump_lwip("w5500_rx: Packet", buf, payload_len);
-#endif
+    if (!w5500_rx_release(s))
+        return 0;
 
     return payload_len;
 }
 
+/**
+ * @brief Peek at the header of the next received frame without consuming it.
+ *
+ * @param buf Buffer for the leading frame bytes.
+ * @param buflen Size of @p buf (at most ETHIF_RX_PEEK_LEN bytes are read).
+ * @param more Set to true if other frames are queued behind this one.
+ * @param s Ethernet interface.
+ * @return Length of the pending frame, 0 if none.
+ */
+static size_t w5500_peek(void *buf, size_t buflen, bool *more, struct ethif *s)
+{
+    uint16_t rsr = 0;
+    if (!w5500_rx_next(s, (uint8_t *)buf, buflen, &rsr))
+        return 0;
+
+    *more = rsr > s->rx_frame_len;
+    return s->rx_frame_len > 2 ? s->rx_frame_len - 2 : 0;
+}
+
+/**
+ * @brief Discard the next received frame without clocking out its payload.
+ *
+ * @param s Ethernet interface.
+ * @return true if a frame was discarded.
+ */
+static bool w5500_skip(struct ethif *s)
+{
+    if (!w5500_rx_next(s, NULL, 0, NULL))
+        return false;
+
+    LWIP_DEBUGF(ETHIF_DEBUG, ("w5500_skip: Frame dropped: len=%u\n", (unsigned)s->rx_frame_len));
+    return w5500_rx_release(s);
+}
+
 /**
  * @brief Read and verify a stable value from the Transmit Free Size Register (TX_FSR).
  *
@@ -364,7 +721,12 @@ static bool w5500_read_tx_rsr_stable(struct ethif *s, uint16_t *freesize)
 {
     uint16_t tmp = w5500_read_word(s, SOCKET0_REGISTER, Sn_TX_FSR);
     *freesize = w5500_read_word(s, SOCKET0_REGISTER, Sn_TX_FSR);
-    return (*freesize == tmp);
+    if (*freesize != tmp)
+    {
+        s->stats.unstable_retries++;
+        return false;
+    }
+    return true;
 }
 
 /**
@@ -387,24 +749,31 @@ static uint8_t w5500_read_ir_and_clear(struct ethif *s, uint8_t *ir)
 /**
  * @brief Transmit Ethernet frame using W5500.
  *
- * @param buf Pointer to buffer to transmit.
- * @param buflen Number of bytes to send.
+ * Each pbuf of the chain (e.g. a header pbuf followed by payload sent by
+ * reference) is written at the running TX buffer offset, followed by a
+ * single SEND.
+ *
+ * @param p Frame to transmit, possibly a pbuf chain.
  * @param s Ethernet interface.
  * @return Number of bytes sent (0 on error).
  */
-static size_t w5500_tx(const void *buf, size_t buflen, struct ethif *s)
+static size_t w5500_tx(struct pbuf *p, struct ethif *s)
 {
     bool passed;
 
+    size_t buflen = p->tot_len;
     size_t len = buflen;
     if (0 == len)
         return 0;
 
+    ETHIF_PROF_DECL(t);
     uint16_t freesize = 0;
     WAIT_OR_FAIL(MAX_LOOP_ITERATIONS, (!w5500_read_tx_rsr_stable(s, &freesize)), passed);
+    ETHIF_PROF_LAP(s, ETHIF_PROF_TX_FSR, t);
 
     if ((!passed))
     {
+        s->stats.timeouts[ETHIF_WAIT_TX_FSR]++;
         LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SEVERE,
             ("w5500_tx: Timeout waiting for stable Sn_TX_FSR\n"));
         return 0;
@@ -412,6 +781,7 @@ static size_t w5500_tx(const void *buf, size_t buflen, struct ethif *s)
 
     if (freesize < buflen)
     {
+        s->stats.tx_nospace++;
         LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SEVERE,
             ("w5500_tx: Not enough space: freesize=%u, buflen=%u\n", freesize, (unsigned)buflen));
         return 0;
@@ -428,26 +798,41 @@ static size_t w5500_tx(const void *buf, size_t buflen, struct ethif *s)
     }
 
     uint16_t ptr = w5500_read_word(s, SOCKET0_REGISTER, Sn_TX_WR);
-    w5500_write(s, SOCKET0_TX_BUFFER, ptr, (void *)buf, len);
+    uint16_t offset = 0;
+    for (struct pbuf *q = p; q != NULL && offset < len; q = q->next)
+    {
+        w5500_write(s, SOCKET0_TX_BUFFER, (uint16_t)(ptr + offset), q->payload, q->len);
+        offset += q->len;
+    }
     w5500_write_word(s, SOCKET0_REGISTER, Sn_TX_WR, ptr + len);
+    ETHIF_PROF_LAP(s, ETHIF_PROF_TX_PAYLOAD, t);
     w5500_write_byte(s, SOCKET0_REGISTER, Sn_CR, Sn_CR_SEND);
 
     WAIT_OR_FAIL(MAX_LOOP_ITERATIONS, (0 != w5500_read_byte(s, SOCKET0_REGISTER, Sn_CR)), passed);
+    ETHIF_PROF_LAP(s, ETHIF_PROF_TX_SEND, t);
 
     if ((!passed))
     {
+        s->stats.timeouts[ETHIF_WAIT_TX_SEND]++;
         LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SEVERE, ("w5500_tx: Sn_CR not cleared after SEND\n"));
         return 0;
     }
 
     uint8_t ir;
     WAIT_OR_FAIL(MAX_LOOP_ITERATIONS, (0 == (w5500_read_ir_and_clear(s, &ir) & ((Sn_IR_SENDOK | Sn_IR_TIMEOUT | Sn_IR_DISCON)))), passed);
+    ETHIF_PROF_LAP(s, ETHIF_PROF_TX_SENDOK, t);
 
     if (!passed)
     {
+        s->stats.timeouts[ETHIF_WAIT_TX_SENDOK]++;
         LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SEVERE, ("w5500_tx: Send failed: Sn_IR=%02X\n", ir));
     }
 
+    if (ir & Sn_IR_TIMEOUT)
+        s->stats.sn_ir_timeout++;
+    if (ir & Sn_IR_DISCON)
+        s->stats.sn_ir_discon++;
+
     if (ir & (Sn_IR_TIMEOUT | Sn_IR_DISCON))
     {
         LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SEVERE, ("w5500_tx: Socket unexpectedly timeouted or closed\n"));
@@ -459,26 +844,28 @@ static size_t w5500_tx(const void *buf, size_t buflen, struct ethif *s)
         LWIP_DEBUGF(ETHIF_DEBUG, ("w5500_tx: Frame sent: len=%u\n", (unsigned)buflen));
     }
 
-#if defined(ETHIF_TX_DUMP_DEBUG) && ETHIF_TX_DUMP_DEBUG
-    hex_dump_lwip("w5500_tx: Packet", buf, len);
-#endif
-
     return len;
 }
 
 /**
- * @brief Initialize W5500 chip.
+ * @brief Cold-reset and configure W5500 chip.
+ *
+ * Performs a software reset and restarts PHY auto-negotiation, so the link
+ * goes down for a few seconds.
  *
  * @param s Ethernet interface.
  * @return True if initialization succeeded.
  */
-static bool w5500_init(struct ethif *s)
+static bool w5500_reset(struct ethif *s)
 {
     bool passed;
 
-    LWIP_DEBUGF(ETHIF_DEBUG, ("w5500_init: Initializing W5500 chip\n"));
+    LWIP_DEBUGF(ETHIF_DEBUG, ("w5500_reset: Initializing W5500 chip\n"));
 
     s->end(s->spi);
+    s->rx_frame_len = 0;
+    s->stats.cold_inits++;
+    s->reset_next = sys_now() + ETHIF_RESET_MIN_INTERVAL_MS;
 
     w5500_write_byte(s, COMMON_REGISTER, MR, MR_RST);
 
@@ -486,7 +873,8 @@ static bool w5500_init(struct ethif *s)
 
     if ((!passed))
     {
-        LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SEVERE, ("w5500_init: Timeout waiting for MR_RST to clear\n"));
+        s->stats.timeouts[ETHIF_WAIT_INIT_RST]++;
+        LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SEVERE, ("w5500_reset: Timeout waiting for MR_RST to clear\n"));
         return false;
     }
 
@@ -496,33 +884,119 @@ static bool w5500_init(struct ethif *s)
     w5500_write_byte(s, SOCKET0_REGISTER, Sn_TXBUF_SIZE, 16);
     if (NULL != s->ethaddr) {    
         w5500_write(s, COMMON_REGISTER, SHAR, s->ethaddr->addr, 6);
-        w5500_write_byte(s, SOCKET0_REGISTER, Sn_MR, Sn_MR_MFEN | Sn_MR_MACRAW);
-    } else {
-        w5500_write_byte(s, SOCKET0_REGISTER, Sn_MR, Sn_MR_MACRAW);
     }
-    w5500_write_byte(s, SOCKET0_REGISTER, Sn_CR, Sn_CR_OPEN);
 
-    WAIT_OR_FAIL(MAX_LOOP_ITERATIONS, (0 != w5500_read_byte(s, SOCKET0_REGISTER, Sn_CR)), passed);
+    return w5500_socket_open(s);
+}
 
-    if ((!passed))
-    {
-        LWIP_DEBUGF(ETHIF_DEBUG | LWIP_DBG_LEVEL_SEVERE, ("w5500_init: Timeout waiting for Sn_CR to clear\n"));
+/**
+ * @brief Check whether the chip still holds the configuration of a previous init.
+ *
+ * True after an MCU-only reset: the chip answers with the expected version,
+ * has our MAC address and buffer sizes, socket 0 is in MACRAW mode and the
+ * PHY is configured for auto-negotiation with the link up.
+ *
+ * @param s Ethernet interface.
+ * @return True if a warm init is possible.
+ */
+static bool w5500_is_configured(struct ethif *s)
+{
+    uint8_t mac[6];
+
+    if (w5500_read_byte(s, COMMON_REGISTER, VERSIONR) != W5500_VERSION)
         return false;
+
+    uint8_t phy = w5500_read_byte(s, COMMON_REGISTER, PHYCFGR);
+    if ((phy & (PHYCFGR_OPMD | PHYCFGR_OPMDC_ALLA | PHYCFGR_LNK_ON)) != (PHYCFGR_OPMD | PHYCFGR_OPMDC_ALLA | PHYCFGR_LNK_ON))
+        return false;
+
+    if (NULL != s->ethaddr)
+    {
+        w5500_read(s, COMMON_REGISTER, SHAR, mac, sizeof(mac));
+        if (memcmp(mac, s->ethaddr->addr, sizeof(mac)) != 0)
+            return false;
     }
 
-    return w5500_read_byte(s, SOCKET0_REGISTER, Sn_SR) == SOCK_MACRAW;
+    return w5500_read_byte(s, SOCKET0_REGISTER, Sn_RXBUF_SIZE) == 16 &&
+           w5500_read_byte(s, SOCKET0_REGISTER, Sn_TXBUF_SIZE) == 16 &&
+           w5500_read_byte(s, SOCKET0_REGISTER, Sn_SR) == SOCK_MACRAW;
+}
+
+/**
+ * @brief Initialize W5500 chip.
+ *
+ * If the chip is already configured (e.g. after an MCU soft reset) and
+ * ETHIF_WARM_INIT is enabled, only socket 0 is re-opened, which keeps the
+ * PHY link up. Otherwise the chip is cold-reset.
+ *
+ * @param s Ethernet interface.
+ * @return True if initialization succeeded.
+ */
+static bool w5500_init(struct ethif *s)
+{
+#if ETHIF_WARM_INIT
+    s->end(s->spi);
+    s->rx_frame_len = 0;
+
+    if (w5500_is_configured(s))
+    {
+        LWIP_DEBUGF(ETHIF_DEBUG, ("w5500_init: Chip already configured, re-opening socket 0\n"));
+        if (w5500_socket_reopen(s))
+        {
+            s->stats.warm_inits++;
+            return true;
+        }
+    }
+#endif /* ETHIF_WARM_INIT */
+
+    return w5500_reset(s);
+}
+
+/**
+ * @brief Discard every received frame.
+ *
+ * Re-opening socket 0 empties its RX buffer in one step, whatever the
+ * amount of queued traffic; the PHY link is not touched.
+ *
+ * @param s Ethernet interface.
+ * @return True if the socket was re-opened.
+ */
+static bool w5500_flush(struct ethif *s)
+{
+    return w5500_socket_reopen(s);
 }
 
 /**
  * @brief Check link status.
  *
+ * Every ETHIF_SPI_VERIFY_MS, and at the first poll after an SPI error,
+ * PHYCFGR is read together with VERSIONR in a single transaction to verify
+ * that the SPI link still returns the chip version; a lowered SPI clock may
+ * then be raised again. Other polls read PHYCFGR alone.
+ *
  * @param s Ethernet interface.
  * @param s1 Whether to check (true) or skip (false).
  * @return True if link is up.
  */
 static bool w5500_poll(struct ethif *s, bool s1)
 {
-    return s1 ? w5500_read_byte(s, COMMON_REGISTER, PHYCFGR) & PHYCFGR_LNK_ON : false;
+    if (!s1)
+        return false;
+
+    uint32_t now = sys_now();
+    if ((int32_t)(now - s->spi_verify_next) < 0)
+        return w5500_read_byte(s, COMMON_REGISTER, PHYCFGR) & PHYCFGR_LNK_ON;
+    s->spi_verify_next = now + ETHIF_SPI_VERIFY_MS;
+
+    uint8_t regs[VERSIONR - PHYCFGR + 1];
+    w5500_read(s, COMMON_REGISTER, PHYCFGR, regs, sizeof(regs));
+    if (regs[VERSIONR - PHYCFGR] != W5500_VERSION)
+    {
+        w5500_spi_fault(s, "VERSIONR mismatch");
+        return w5500_read_byte(s, COMMON_REGISTER, PHYCFGR) & PHYCFGR_LNK_ON;
+    }
+    ethif_spi_step_up(s);
+    return regs[0] & PHYCFGR_LNK_ON;
 }
 
 /**
@@ -532,4 +1006,9 @@ struct ethif_driver ethif_driver_w5500 = {
     w5500_init,
     w5500_tx,
     w5500_rx,
-    w5500_poll};
+    w5500_poll,
+    w5500_peek,
+    w5500_skip,
+    w5500_check,
+    w5500_reset,
+    w5500_flush};
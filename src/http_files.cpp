@@ -0,0 +1,159 @@
+// Generated by tools/http_files.py from data/, do not edit.
+
+#include "http_files.h"
+
+// /status/index.html
+static const uint8_t file0_data[] = {
+    0x3c, 0x21, 0x44, 0x4f, 0x43, 0x54, 0x59, 0x50, 0x45, 0x20, 0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x0a,
+    0x3c, 0x68, 0x74, 0x6d, 0x6c, 0x20, 0x6c, 0x61, 0x6e, 0x67, 0x3d, 0x22, 0x65, 0x6e, 0x22, 0x3e,
+    0x0a, 0x3c, 0x68, 0x65, 0x61, 0x64, 0x3e, 0x0a, 0x3c, 0x6d, 0x65, 0x74, 0x61, 0x20, 0x63, 0x68,
+    0x61, 0x72, 0x73, 0x65, 0x74, 0x3d, 0x22, 0x75, 0x74, 0x66, 0x2d, 0x38, 0x22, 0x3e, 0x0a, 0x3c,
+    0x6d, 0x65, 0x74, 0x61, 0x20, 0x6e, 0x61, 0x6d, 0x65, 0x3d, 0x22, 0x76, 0x69, 0x65, 0x77, 0x70,
+    0x6f, 0x72, 0x74, 0x22, 0x20, 0x63, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x22, 0x77, 0x69,
+    0x64, 0x74, 0x68, 0x3d, 0x64, 0x65, 0x76, 0x69, 0x63, 0x65, 0x2d, 0x77, 0x69, 0x64, 0x74, 0x68,
+    0x2c, 0x20, 0x69, 0x6e, 0x69, 0x74, 0x69, 0x61, 0x6c, 0x2d, 0x73, 0x63, 0x61, 0x6c, 0x65, 0x3d,
+    0x31, 0x22, 0x3e, 0x0a, 0x3c, 0x74, 0x69, 0x74, 0x6c, 0x65, 0x3e, 0x57, 0x35, 0x35, 0x30, 0x30,
+    0x20, 0x6c, 0x77, 0x49, 0x50, 0x20, 0x73, 0x74, 0x61, 0x74, 0x75, 0x73, 0x3c, 0x2f, 0x74, 0x69,
+    0x74, 0x6c, 0x65, 0x3e, 0x0a, 0x3c, 0x6c, 0x69, 0x6e, 0x6b, 0x20, 0x72, 0x65, 0x6c, 0x3d, 0x22,
+    0x73, 0x74, 0x79, 0x6c, 0x65, 0x73, 0x68, 0x65, 0x65, 0x74, 0x22, 0x20, 0x68, 0x72, 0x65, 0x66,
+    0x3d, 0x22, 0x73, 0x74, 0x61, 0x74, 0x75, 0x73, 0x2e, 0x63, 0x73, 0x73, 0x22, 0x3e, 0x0a, 0x3c,
+    0x2f, 0x68, 0x65, 0x61, 0x64, 0x3e, 0x0a, 0x3c, 0x62, 0x6f, 0x64, 0x79, 0x3e, 0x0a, 0x3c, 0x6d,
+    0x61, 0x69, 0x6e, 0x3e, 0x0a, 0x3c, 0x68, 0x31, 0x3e, 0x57, 0x35, 0x35, 0x30, 0x30, 0x20, 0x6c,
+    0x77, 0x49, 0x50, 0x3c, 0x2f, 0x68, 0x31, 0x3e, 0x0a, 0x3c, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x3e,
+    0x0a, 0x3c, 0x74, 0x72, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x56, 0x69, 0x65, 0x77, 0x73, 0x3c, 0x2f,
+    0x74, 0x68, 0x3e, 0x3c, 0x74, 0x64, 0x20, 0x69, 0x64, 0x3d, 0x22, 0x76, 0x69, 0x65, 0x77, 0x73,
+    0x22, 0x3e, 0x2d, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c, 0x2f, 0x74, 0x72, 0x3e, 0x0a, 0x3c, 0x74,
+    0x72, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x55, 0x70, 0x64, 0x61, 0x74, 0x65, 0x64, 0x3c, 0x2f, 0x74,
+    0x68, 0x3e, 0x3c, 0x74, 0x64, 0x20, 0x69, 0x64, 0x3d, 0x22, 0x75, 0x70, 0x64, 0x61, 0x74, 0x65,
+    0x64, 0x22, 0x3e, 0x2d, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c, 0x2f, 0x74, 0x72, 0x3e, 0x0a, 0x3c,
+    0x2f, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x3e, 0x0a, 0x3c, 0x70, 0x3e, 0x3c, 0x61, 0x20, 0x68, 0x72,
+    0x65, 0x66, 0x3d, 0x22, 0x2f, 0x22, 0x3e, 0x43, 0x6f, 0x75, 0x6e, 0x74, 0x20, 0x61, 0x20, 0x76,
+    0x69, 0x65, 0x77, 0x3c, 0x2f, 0x61, 0x3e, 0x3c, 0x2f, 0x70, 0x3e, 0x0a, 0x3c, 0x2f, 0x6d, 0x61,
+    0x69, 0x6e, 0x3e, 0x0a, 0x3c, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x20, 0x73, 0x72, 0x63, 0x3d,
+    0x22, 0x73, 0x74, 0x61, 0x74, 0x75, 0x73, 0x2e, 0x6a, 0x73, 0x22, 0x3e, 0x3c, 0x2f, 0x73, 0x63,
+    0x72, 0x69, 0x70, 0x74, 0x3e, 0x0a, 0x3c, 0x2f, 0x62, 0x6f, 0x64, 0x79, 0x3e, 0x0a, 0x3c, 0x2f,
+    0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x0a,
+};
+static const char file0_head[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/html; charset=utf-8\r\n"
+    "Content-Length: 454\r\n"
+    "ETag: \"f1b26950\"\r\n"
+    "Cache-Control: no-cache\r\n"
+    "\r\n";
+static const char file0_head_close[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/html; charset=utf-8\r\n"
+    "Content-Length: 454\r\n"
+    "ETag: \"f1b26950\"\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+
+// /status/status.css
+static const uint8_t file1_data[] = {
+    0x62, 0x6f, 0x64, 0x79, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x66, 0x6f, 0x6e, 0x74, 0x2d, 0x66, 0x61,
+    0x6d, 0x69, 0x6c, 0x79, 0x3a, 0x20, 0x73, 0x79, 0x73, 0x74, 0x65, 0x6d, 0x2d, 0x75, 0x69, 0x2c,
+    0x20, 0x73, 0x61, 0x6e, 0x73, 0x2d, 0x73, 0x65, 0x72, 0x69, 0x66, 0x3b, 0x0a, 0x20, 0x20, 0x62,
+    0x61, 0x63, 0x6b, 0x67, 0x72, 0x6f, 0x75, 0x6e, 0x64, 0x3a, 0x20, 0x23, 0x66, 0x34, 0x66, 0x35,
+    0x66, 0x37, 0x3b, 0x0a, 0x20, 0x20, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x3a, 0x20, 0x23, 0x32, 0x32,
+    0x32, 0x3b, 0x0a, 0x20, 0x20, 0x6d, 0x61, 0x72, 0x67, 0x69, 0x6e, 0x3a, 0x20, 0x30, 0x3b, 0x0a,
+    0x7d, 0x0a, 0x0a, 0x6d, 0x61, 0x69, 0x6e, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x6d, 0x61, 0x78, 0x2d,
+    0x77, 0x69, 0x64, 0x74, 0x68, 0x3a, 0x20, 0x32, 0x38, 0x72, 0x65, 0x6d, 0x3b, 0x0a, 0x20, 0x20,
+    0x6d, 0x61, 0x72, 0x67, 0x69, 0x6e, 0x3a, 0x20, 0x33, 0x72, 0x65, 0x6d, 0x20, 0x61, 0x75, 0x74,
+    0x6f, 0x3b, 0x0a, 0x20, 0x20, 0x70, 0x61, 0x64, 0x64, 0x69, 0x6e, 0x67, 0x3a, 0x20, 0x31, 0x2e,
+    0x35, 0x72, 0x65, 0x6d, 0x20, 0x32, 0x72, 0x65, 0x6d, 0x3b, 0x0a, 0x20, 0x20, 0x62, 0x61, 0x63,
+    0x6b, 0x67, 0x72, 0x6f, 0x75, 0x6e, 0x64, 0x3a, 0x20, 0x23, 0x66, 0x66, 0x66, 0x3b, 0x0a, 0x20,
+    0x20, 0x62, 0x6f, 0x72, 0x64, 0x65, 0x72, 0x2d, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3a, 0x20,
+    0x30, 0x2e, 0x35, 0x72, 0x65, 0x6d, 0x3b, 0x0a, 0x20, 0x20, 0x62, 0x6f, 0x78, 0x2d, 0x73, 0x68,
+    0x61, 0x64, 0x6f, 0x77, 0x3a, 0x20, 0x30, 0x20, 0x31, 0x70, 0x78, 0x20, 0x34, 0x70, 0x78, 0x20,
+    0x72, 0x67, 0x62, 0x61, 0x28, 0x30, 0x2c, 0x20, 0x30, 0x2c, 0x20, 0x30, 0x2c, 0x20, 0x30, 0x2e,
+    0x31, 0x29, 0x3b, 0x0a, 0x7d, 0x0a, 0x0a, 0x68, 0x31, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x66, 0x6f,
+    0x6e, 0x74, 0x2d, 0x73, 0x69, 0x7a, 0x65, 0x3a, 0x20, 0x31, 0x2e, 0x34, 0x72, 0x65, 0x6d, 0x3b,
+    0x0a, 0x20, 0x20, 0x6d, 0x61, 0x72, 0x67, 0x69, 0x6e, 0x2d, 0x74, 0x6f, 0x70, 0x3a, 0x20, 0x30,
+    0x3b, 0x0a, 0x7d, 0x0a, 0x0a, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x77,
+    0x69, 0x64, 0x74, 0x68, 0x3a, 0x20, 0x31, 0x30, 0x30, 0x25, 0x3b, 0x0a, 0x20, 0x20, 0x62, 0x6f,
+    0x72, 0x64, 0x65, 0x72, 0x2d, 0x63, 0x6f, 0x6c, 0x6c, 0x61, 0x70, 0x73, 0x65, 0x3a, 0x20, 0x63,
+    0x6f, 0x6c, 0x6c, 0x61, 0x70, 0x73, 0x65, 0x3b, 0x0a, 0x7d, 0x0a, 0x0a, 0x74, 0x68, 0x2c, 0x20,
+    0x74, 0x64, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x74, 0x65, 0x78, 0x74, 0x2d, 0x61, 0x6c, 0x69, 0x67,
+    0x6e, 0x3a, 0x20, 0x6c, 0x65, 0x66, 0x74, 0x3b, 0x0a, 0x20, 0x20, 0x70, 0x61, 0x64, 0x64, 0x69,
+    0x6e, 0x67, 0x3a, 0x20, 0x30, 0x2e, 0x34, 0x72, 0x65, 0x6d, 0x20, 0x30, 0x3b, 0x0a, 0x20, 0x20,
+    0x62, 0x6f, 0x72, 0x64, 0x65, 0x72, 0x2d, 0x62, 0x6f, 0x74, 0x74, 0x6f, 0x6d, 0x3a, 0x20, 0x31,
+    0x70, 0x78, 0x20, 0x73, 0x6f, 0x6c, 0x69, 0x64, 0x20, 0x23, 0x65, 0x65, 0x65, 0x3b, 0x0a, 0x7d,
+    0x0a, 0x0a, 0x74, 0x68, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3a, 0x20,
+    0x34, 0x30, 0x25, 0x3b, 0x0a, 0x20, 0x20, 0x66, 0x6f, 0x6e, 0x74, 0x2d, 0x77, 0x65, 0x69, 0x67,
+    0x68, 0x74, 0x3a, 0x20, 0x36, 0x30, 0x30, 0x3b, 0x0a, 0x7d, 0x0a,
+};
+static const char file1_head[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/css\r\n"
+    "Content-Length: 491\r\n"
+    "ETag: \"ddfdad98\"\r\n"
+    "Cache-Control: no-cache\r\n"
+    "\r\n";
+static const char file1_head_close[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/css\r\n"
+    "Content-Length: 491\r\n"
+    "ETag: \"ddfdad98\"\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+
+// /status/status.js
+static const uint8_t file2_data[] = {
+    0x2f, 0x2f, 0x20, 0x50, 0x6f, 0x6c, 0x6c, 0x73, 0x20, 0x74, 0x68, 0x65, 0x20, 0x76, 0x69, 0x65,
+    0x77, 0x20, 0x63, 0x6f, 0x75, 0x6e, 0x74, 0x65, 0x72, 0x20, 0x77, 0x69, 0x74, 0x68, 0x6f, 0x75,
+    0x74, 0x20, 0x63, 0x6f, 0x75, 0x6e, 0x74, 0x69, 0x6e, 0x67, 0x20, 0x61, 0x20, 0x76, 0x69, 0x65,
+    0x77, 0x0a, 0x66, 0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x72, 0x65, 0x66, 0x72, 0x65,
+    0x73, 0x68, 0x28, 0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x27,
+    0x2f, 0x63, 0x6f, 0x75, 0x6e, 0x74, 0x27, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x2e, 0x74, 0x68,
+    0x65, 0x6e, 0x28, 0x66, 0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x28, 0x72, 0x29, 0x20,
+    0x7b, 0x20, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x20, 0x72, 0x2e, 0x74, 0x65, 0x78, 0x74, 0x28,
+    0x29, 0x3b, 0x20, 0x7d, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x2e, 0x74, 0x68, 0x65, 0x6e, 0x28,
+    0x66, 0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x28, 0x74, 0x65, 0x78, 0x74, 0x29, 0x20,
+    0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x64, 0x6f, 0x63, 0x75, 0x6d, 0x65, 0x6e, 0x74,
+    0x2e, 0x67, 0x65, 0x74, 0x45, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x42, 0x79, 0x49, 0x64, 0x28,
+    0x27, 0x76, 0x69, 0x65, 0x77, 0x73, 0x27, 0x29, 0x2e, 0x74, 0x65, 0x78, 0x74, 0x43, 0x6f, 0x6e,
+    0x74, 0x65, 0x6e, 0x74, 0x20, 0x3d, 0x20, 0x74, 0x65, 0x78, 0x74, 0x2e, 0x72, 0x65, 0x70, 0x6c,
+    0x61, 0x63, 0x65, 0x28, 0x27, 0x56, 0x69, 0x65, 0x77, 0x20, 0x43, 0x6f, 0x75, 0x6e, 0x74, 0x3a,
+    0x20, 0x27, 0x2c, 0x20, 0x27, 0x27, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x64,
+    0x6f, 0x63, 0x75, 0x6d, 0x65, 0x6e, 0x74, 0x2e, 0x67, 0x65, 0x74, 0x45, 0x6c, 0x65, 0x6d, 0x65,
+    0x6e, 0x74, 0x42, 0x79, 0x49, 0x64, 0x28, 0x27, 0x75, 0x70, 0x64, 0x61, 0x74, 0x65, 0x64, 0x27,
+    0x29, 0x2e, 0x74, 0x65, 0x78, 0x74, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x3d, 0x20,
+    0x6e, 0x65, 0x77, 0x20, 0x44, 0x61, 0x74, 0x65, 0x28, 0x29, 0x2e, 0x74, 0x6f, 0x4c, 0x6f, 0x63,
+    0x61, 0x6c, 0x65, 0x54, 0x69, 0x6d, 0x65, 0x53, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x28, 0x29, 0x3b,
+    0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x2e, 0x63, 0x61, 0x74,
+    0x63, 0x68, 0x28, 0x66, 0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x28, 0x29, 0x20, 0x7b,
+    0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x64, 0x6f, 0x63, 0x75, 0x6d, 0x65, 0x6e, 0x74, 0x2e,
+    0x67, 0x65, 0x74, 0x45, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x42, 0x79, 0x49, 0x64, 0x28, 0x27,
+    0x75, 0x70, 0x64, 0x61, 0x74, 0x65, 0x64, 0x27, 0x29, 0x2e, 0x74, 0x65, 0x78, 0x74, 0x43, 0x6f,
+    0x6e, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x3d, 0x20, 0x27, 0x6f, 0x66, 0x66, 0x6c, 0x69, 0x6e, 0x65,
+    0x27, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x29, 0x3b, 0x0a, 0x7d, 0x0a, 0x0a, 0x72, 0x65,
+    0x66, 0x72, 0x65, 0x73, 0x68, 0x28, 0x29, 0x3b, 0x0a, 0x73, 0x65, 0x74, 0x49, 0x6e, 0x74, 0x65,
+    0x72, 0x76, 0x61, 0x6c, 0x28, 0x72, 0x65, 0x66, 0x72, 0x65, 0x73, 0x68, 0x2c, 0x20, 0x32, 0x30,
+    0x30, 0x30, 0x29, 0x3b, 0x0a,
+};
+static const char file2_head[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/javascript\r\n"
+    "Content-Length: 485\r\n"
+    "ETag: \"eee2f35c\"\r\n"
+    "Cache-Control: no-cache\r\n"
+    "\r\n";
+static const char file2_head_close[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/javascript\r\n"
+    "Content-Length: 485\r\n"
+    "ETag: \"eee2f35c\"\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+
+const struct http_file http_files[] = {
+  {"/status/index.html", "\"f1b26950\"", file0_head, file0_head_close, file0_data, 123, 142, 454, false},
+  {"/status/", "\"f1b26950\"", file0_head, file0_head_close, file0_data, 123, 142, 454, false},
+  {"/status/status.css", "\"ddfdad98\"", file1_head, file1_head_close, file1_data, 107, 126, 491, false},
+  {"/status/status.js", "\"eee2f35c\"", file2_head, file2_head_close, file2_data, 121, 140, 485, false},
+};
+const size_t http_files_count = 4;
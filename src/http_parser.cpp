@@ -0,0 +1,437 @@
+#include <string.h>
+
+#include "http_parser.h"
+
+/**
+ * @brief Method tokens, indexed by enum http_method - 1 (case-sensitive).
+ */
+static const char *const http_methods[] = {"GET", "HEAD", "POST", "PUT", "DELETE", "OPTIONS"};
+
+/**
+ * @brief Headers the parser acts on, lowercase; index + 1 is stored in http_parser::header.
+ */
+static const char *const http_headers[] = {"connection", "content-length", "if-none-match", "accept-encoding",
+                                           "transfer-encoding"};
+#define HTTP_HEADER_CONNECTION        1
+#define HTTP_HEADER_CONTENT_LENGTH    2
+#define HTTP_HEADER_IF_NONE_MATCH     3
+#define HTTP_HEADER_ACCEPT_ENCODING   4
+#define HTTP_HEADER_TRANSFER_ENCODING 5
+
+/**
+ * @brief `Connection` header tokens, lowercase.
+ */
+static const char *const http_connection_tokens[] = {"close"};
+
+/**
+ * @brief `Accept-Encoding` content codings the server has, lowercase.
+ */
+static const char *const http_codings[] = {"gzip"};
+
+/*
+ * While an `Accept-Encoding` element is in its parameters, candidates holds
+ * these flags instead of the coding match and pos the q parameter state.
+ */
+#define HTTP_CODING_PARAMS 0x80 /**< @brief Parsing the parameters after ';' */
+#define HTTP_CODING_GZIP   0x40 /**< @brief The coding is gzip */
+#define HTTP_CODING_Q0     0x20 /**< @brief Its q-value is zero ("not acceptable") */
+#define HTTP_Q_NAME        0    /**< @brief At the start of a parameter name */
+#define HTTP_Q_EQUALS      1    /**< @brief After "q" */
+#define HTTP_Q_VALUE       2    /**< @brief In the q-value */
+#define HTTP_Q_OTHER       3    /**< @brief In another parameter */
+
+#define HTTP_TABLE_SIZE(t) (sizeof(t) / sizeof((t)[0]))
+#define HTTP_ALL(t) ((uint8_t)((1u << HTTP_TABLE_SIZE(t)) - 1))
+
+static const char http_version[] = "HTTP/1.";
+#define HTTP_VERSION_MAJOR 5 /**< @brief Position of the major version digit in http_version */
+
+#define HTTP_CONTENT_LENGTH_MAX 0xFFFFFF /**< @brief Larger bodies fail with 413 */
+
+/**
+ * @brief Narrows the entries of a token table still matching after one more character.
+ *
+ * @param candidates Matching entries so far (bitmask).
+ * @param table Token table.
+ * @param count Number of entries in @p table.
+ * @param pos Position of @p ch in the token.
+ * @param ch Next character, or '\0' to end the token at @p pos.
+ * @return Entries still matching.
+ */
+static uint8_t http_match(uint8_t candidates, const char *const *table, size_t count, uint8_t pos, char ch)
+{
+  for (size_t i = 0; i < count; i++) {
+    if ((candidates & (1u << i)) && table[i][pos] != ch) {
+      candidates &= ~(1u << i);
+    }
+  }
+  return candidates;
+}
+
+/**
+ * @brief Finds the entry matched completely by a token of @p pos characters.
+ *
+ * @return Entry index + 1, or 0 if none.
+ */
+static uint8_t http_matched(uint8_t candidates, const char *const *table, size_t count, uint8_t pos)
+{
+  for (size_t i = 0; i < count; i++) {
+    if ((candidates & (1u << i)) && table[i][pos] == '\0') {
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Fails the request.
+ *
+ * @param parser Parser state.
+ * @param status HTTP status to answer with.
+ */
+static void http_fail(struct http_parser *parser, uint16_t status)
+{
+  parser->state = HTTP_PARSE_ERROR;
+  parser->status = status;
+}
+
+/**
+ * @brief Resets the per-token match state.
+ */
+static void http_token(struct http_parser *parser, uint8_t candidates)
+{
+  parser->candidates = candidates;
+  parser->pos = 0;
+}
+
+/**
+ * @brief Applies the `Connection` token matched so far.
+ */
+static void http_connection_token(struct http_parser *parser)
+{
+  if (http_matched(parser->candidates, http_connection_tokens, HTTP_TABLE_SIZE(http_connection_tokens), parser->pos)) {
+    parser->flags |= HTTP_REQ_CLOSE;
+  }
+  http_token(parser, HTTP_ALL(http_connection_tokens));
+}
+
+/**
+ * @brief Parses one character of the parameters of an `Accept-Encoding` element.
+ *
+ * Only the q parameter is interpreted: a q-value made of zeros only
+ * ("0", "0.0", "0.000") marks the coding as not acceptable.
+ */
+static void http_coding_param(struct http_parser *parser, char ch)
+{
+  if (ch == ' ' || ch == '\t') {
+    return;
+  }
+  if (ch == ';') {
+    parser->pos = HTTP_Q_NAME;
+    return;
+  }
+  switch (parser->pos) {
+  case HTTP_Q_NAME:
+    parser->pos = ch == 'q' ? HTTP_Q_EQUALS : HTTP_Q_OTHER;
+    break;
+  case HTTP_Q_EQUALS:
+    if (ch == '=') {
+      parser->candidates |= HTTP_CODING_Q0;
+      parser->pos = HTTP_Q_VALUE;
+    } else {
+      parser->pos = HTTP_Q_OTHER;
+    }
+    break;
+  case HTTP_Q_VALUE:
+    if (ch != '0' && ch != '.') {
+      parser->candidates &= ~HTTP_CODING_Q0;
+    }
+    break;
+  }
+}
+
+/**
+ * @brief Applies the `Accept-Encoding` element parsed so far and starts the next one.
+ */
+static void http_coding_end(struct http_parser *parser)
+{
+  bool gzip;
+
+  if (parser->candidates & HTTP_CODING_PARAMS) {
+    gzip = (parser->candidates & (HTTP_CODING_GZIP | HTTP_CODING_Q0)) == HTTP_CODING_GZIP;
+  } else {
+    gzip = http_matched(parser->candidates, http_codings, HTTP_TABLE_SIZE(http_codings), parser->pos) != 0;
+  }
+  if (gzip) {
+    parser->flags |= HTTP_REQ_GZIP;
+  }
+  http_token(parser, HTTP_ALL(http_codings));
+}
+
+/**
+ * @brief Finishes the request head: skip a body if announced, else done.
+ */
+static void http_end_of_head(struct http_parser *parser)
+{
+  parser->state = parser->content_length ? HTTP_PARSE_BODY : HTTP_PARSE_DONE;
+}
+
+/**
+ * @brief Resets the parser for the next request.
+ */
+void http_parser_init(struct http_parser *parser)
+{
+  memset(parser, 0, sizeof(*parser));
+  parser->state = HTTP_PARSE_METHOD;
+  http_token(parser, HTTP_ALL(http_methods));
+}
+
+/**
+ * @brief Feeds request bytes to the parser, up to the end of one request.
+ */
+size_t http_parser_feed(struct http_parser *parser, const char *data, size_t len)
+{
+  size_t i = 0;
+
+  while (i < len && parser->state < HTTP_PARSE_DONE) {
+    if (parser->state == HTTP_PARSE_BODY) {
+      size_t n = len - i < parser->content_length ? len - i : parser->content_length;
+      i += n;
+      parser->content_length -= n;
+      if (parser->content_length == 0) {
+        parser->state = HTTP_PARSE_DONE;
+      }
+      continue;
+    }
+
+    char ch = data[i++];
+    if (ch == '\0') {
+      http_fail(parser, 400);
+      break;
+    }
+    if (++parser->length > HTTP_MAX_REQUEST) {
+      http_fail(parser, 431);
+      break;
+    }
+
+    switch (parser->state) {
+    case HTTP_PARSE_METHOD:
+      if (ch == ' ') {
+        parser->method = http_matched(parser->candidates, http_methods, HTTP_TABLE_SIZE(http_methods), parser->pos);
+        parser->state = HTTP_PARSE_PATH;
+      } else if ((ch == '\r' || ch == '\n') && parser->pos == 0) {
+        parser->length--;  // Empty lines before a request are ignored
+      } else if (ch < 'A' || ch > 'Z') {
+        http_fail(parser, 400);
+      } else {
+        parser->candidates = http_match(parser->candidates, http_methods, HTTP_TABLE_SIZE(http_methods), parser->pos, ch);
+        parser->pos = parser->pos < UINT8_MAX ? parser->pos + 1 : parser->pos;
+      }
+      break;
+
+    case HTTP_PARSE_PATH:
+    case HTTP_PARSE_QUERY:
+      if (ch == ' ') {
+        if (parser->path_len == 0) {
+          http_fail(parser, 400);
+        } else if (parser->path_len > HTTP_PATH_MAX) {
+          http_fail(parser, 414);
+        } else {
+          parser->path[parser->path_len] = '\0';
+          parser->state = HTTP_PARSE_VERSION;
+          http_token(parser, 0);
+        }
+      } else if (ch == '\r' || ch == '\n') {
+        http_fail(parser, 400);
+      } else if (ch == '?') {
+        parser->state = HTTP_PARSE_QUERY;
+      } else if (parser->state == HTTP_PARSE_PATH) {
+        if (parser->path_len < HTTP_PATH_MAX) {
+          parser->path[parser->path_len] = ch;
+        }
+        if (parser->path_len <= HTTP_PATH_MAX) {
+          parser->path_len++;
+        }
+      }
+      break;
+
+    case HTTP_PARSE_VERSION:
+      if (parser->pos < sizeof(http_version) - 1) {
+        if (ch == http_version[parser->pos]) {
+          parser->pos++;
+        } else if (parser->pos == HTTP_VERSION_MAJOR && ch >= '0' && ch <= '9') {
+          http_fail(parser, 505);  // Another major version, e.g. HTTP/2.0
+        } else {
+          http_fail(parser, 400);
+        }
+      } else if (ch == '0' || ch == '1') {
+        if (ch == '0') {
+          parser->flags |= HTTP_REQ_HTTP10;
+        }
+        parser->state = HTTP_PARSE_VERSION_END;
+      } else {
+        http_fail(parser, 505);
+      }
+      break;
+
+    case HTTP_PARSE_VERSION_END:
+      if (ch == '\n') {
+        parser->state = HTTP_PARSE_HEADER_START;
+      } else if (ch != '\r') {
+        http_fail(parser, 400);
+      }
+      break;
+
+    case HTTP_PARSE_HEADER_START:
+      if (ch == '\n') {
+        http_end_of_head(parser);
+        break;
+      }
+      if (ch == '\r') {
+        break;
+      }
+      parser->state = HTTP_PARSE_HEADER_NAME;
+      http_token(parser, HTTP_ALL(http_headers));
+      // fall through
+    case HTTP_PARSE_HEADER_NAME:
+      if (ch == ':') {
+        parser->header = http_matched(parser->candidates, http_headers, HTTP_TABLE_SIZE(http_headers), parser->pos);
+        if (parser->header == HTTP_HEADER_CONNECTION) {
+          http_token(parser, HTTP_ALL(http_connection_tokens));
+        } else if (parser->header == HTTP_HEADER_CONTENT_LENGTH) {
+          parser->content_length = 0;
+          http_token(parser, 0);
+        } else if (parser->header == HTTP_HEADER_IF_NONE_MATCH) {
+          parser->etag_len = 0;
+          http_token(parser, 0);
+        } else if (parser->header == HTTP_HEADER_ACCEPT_ENCODING) {
+          http_token(parser, HTTP_ALL(http_codings));
+        } else {
+          http_token(parser, 0);
+        }
+        parser->state = parser->header ? HTTP_PARSE_HEADER_VALUE : HTTP_PARSE_HEADER_SKIP;
+      } else if (ch == '\r' || ch == '\n' || ch == ' ' || ch == '\t') {
+        http_fail(parser, 400);
+      } else {
+        if (ch >= 'A' && ch <= 'Z') {
+          ch += 'a' - 'A';
+        }
+        parser->candidates = http_match(parser->candidates, http_headers, HTTP_TABLE_SIZE(http_headers), parser->pos, ch);
+        parser->pos = parser->pos < UINT8_MAX ? parser->pos + 1 : parser->pos;
+      }
+      break;
+
+    case HTTP_PARSE_HEADER_VALUE:
+      if (ch == '\r') {
+        break;
+      }
+      if (parser->header == HTTP_HEADER_CONNECTION) {
+        if (ch == ',' || ch == '\n') {
+          http_connection_token(parser);
+        } else if ((ch == ' ' || ch == '\t') && parser->pos == 0) {
+          // Leading whitespace
+        } else if (ch == ' ' || ch == '\t') {
+          // Trailing whitespace ends the token
+          parser->candidates = http_match(parser->candidates, http_connection_tokens,
+                                          HTTP_TABLE_SIZE(http_connection_tokens), parser->pos, '\0');
+        } else {
+          if (ch >= 'A' && ch <= 'Z') {
+            ch += 'a' - 'A';
+          }
+          parser->candidates = http_match(parser->candidates, http_connection_tokens,
+                                          HTTP_TABLE_SIZE(http_connection_tokens), parser->pos, ch);
+          parser->pos = parser->pos < UINT8_MAX ? parser->pos + 1 : parser->pos;
+        }
+      } else if (parser->header == HTTP_HEADER_CONTENT_LENGTH) {
+        if (ch >= '0' && ch <= '9') {
+          parser->content_length = parser->content_length * 10 + (ch - '0');
+          if (parser->content_length > HTTP_CONTENT_LENGTH_MAX) {
+            http_fail(parser, 413);
+          }
+        } else if (ch != ' ' && ch != '\t' && ch != '\n') {
+          http_fail(parser, 400);
+        }
+      } else if (parser->header == HTTP_HEADER_IF_NONE_MATCH) {
+        if (ch == '\n') {
+          if (parser->etag_len > HTTP_ETAG_MAX) {
+            parser->etag_len = 0;  // Too long to be one of ours
+          }
+          while (parser->etag_len > 0 &&
+                 (parser->etag[parser->etag_len - 1] == ' ' || parser->etag[parser->etag_len - 1] == '\t')) {
+            parser->etag_len--;
+          }
+          parser->etag[parser->etag_len] = '\0';
+        } else if ((ch == ' ' || ch == '\t') && parser->etag_len == 0) {
+          // Leading whitespace
+        } else if (parser->etag_len < HTTP_ETAG_MAX) {
+          parser->etag[parser->etag_len++] = ch;
+        } else {
+          parser->etag_len = HTTP_ETAG_MAX + 1;
+        }
+      } else if (parser->header == HTTP_HEADER_TRANSFER_ENCODING) {
+        // The body framing of any transfer coding (chunked) is not implemented
+        if (ch != ' ' && ch != '\t' && ch != '\n') {
+          http_fail(parser, 501);
+        }
+      } else if (parser->header == HTTP_HEADER_ACCEPT_ENCODING) {
+        if (ch >= 'A' && ch <= 'Z') {
+          ch += 'a' - 'A';
+        }
+        if (ch == ',' || ch == '\n') {
+          http_coding_end(parser);
+        } else if (parser->candidates & HTTP_CODING_PARAMS) {
+          http_coding_param(parser, ch);
+        } else if (ch == ';') {
+          bool gzip = http_matched(parser->candidates, http_codings, HTTP_TABLE_SIZE(http_codings), parser->pos) != 0;
+          parser->candidates = HTTP_CODING_PARAMS | (gzip ? HTTP_CODING_GZIP : 0);
+          parser->pos = HTTP_Q_NAME;
+        } else if (ch == ' ' || ch == '\t') {
+          // Whitespace around the coding; after it, ends the token
+          if (parser->pos > 0) {
+            parser->candidates = http_match(parser->candidates, http_codings, HTTP_TABLE_SIZE(http_codings), parser->pos, '\0');
+          }
+        } else {
+          parser->candidates = http_match(parser->candidates, http_codings, HTTP_TABLE_SIZE(http_codings), parser->pos, ch);
+          parser->pos = parser->pos < UINT8_MAX ? parser->pos + 1 : parser->pos;
+        }
+      }
+      if (ch == '\n' && parser->state == HTTP_PARSE_HEADER_VALUE) {
+        parser->state = HTTP_PARSE_HEADER_START;
+      }
+      break;
+
+    case HTTP_PARSE_HEADER_SKIP:
+      if (ch == '\n') {
+        parser->state = HTTP_PARSE_HEADER_START;
+      }
+      break;
+    }
+  }
+
+  return i;
+}
+
+/**
+ * @brief Feeds a pbuf chain to the parser, walking the payloads in place.
+ */
+u16_t http_parser_feed_pbuf(struct http_parser *parser, const struct pbuf *p)
+{
+  u16_t consumed = 0;
+
+  for (const struct pbuf *q = p; q && parser->state < HTTP_PARSE_DONE; q = q->next) {
+    size_t n = http_parser_feed(parser, (const char *)q->payload, q->len);
+    consumed += n;
+    if (n < q->len) {
+      break;
+    }
+  }
+  return consumed;
+}
+
+/**
+ * @brief Checks whether the connection may stay open after this request.
+ */
+bool http_parser_keep_alive(const struct http_parser *parser)
+{
+  return (parser->flags & (HTTP_REQ_HTTP10 | HTTP_REQ_CLOSE)) == 0;
+}
@@ -0,0 +1,620 @@
+#include <Arduino.h>
+
+#include "lwip/tcp.h"
+#include "tcp_stream.h"
+
+#include "http_files.h"
+#include "http_parser.h"
+#include "http_server.h"
+
+#define HTTP_POLL_INTERVAL 2       /**< @brief tcp_poll() interval in TCP coarse timer ticks (2 per second) */
+
+/**
+ * @brief State of an open HTTP connection.
+ */
+struct http_conn {
+  struct tcp_pcb *pcb;             /**< @brief Connection PCB, NULL if the slot is free */
+  struct pbuf *rx;                 /**< @brief Received request bytes not parsed yet */
+  struct http_parser parser;       /**< @brief Request being parsed */
+  uint32_t last_ms;                /**< @brief millis() of the last activity */
+  uint32_t unacked;                /**< @brief Response bytes queued but not acknowledged */
+  struct tcp_stream stream;        /**< @brief Response content larger than the send buffer */
+  bool close;                      /**< @brief Close once all response bytes are acknowledged */
+};
+
+static struct tcp_pcb *http_pcb;   /**< @brief Listening PCB */
+static struct http_conn http_conns[HTTP_MAX_CONNS]; /**< @brief Connection table */
+static uint32_t view_counter = 0;  /**< @brief Counter for root HTTP GET requests */
+static uint32_t request_counter = 0; /**< @brief Requests answered */
+
+/**
+ * @brief Constant parts of the HTTP response, kept in flash and handed to lwIP
+ *        by reference (no TCP_WRITE_FLAG_COPY): they outlive every connection.
+ */
+static const char http_response_head[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/plain\r\n"
+    "Content-Length: ";
+static const char http_response_head_close[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/plain\r\n"
+    "Connection: close\r\n"
+    "Content-Length: ";
+
+#define HTTP_TAIL_BODY    6        /**< @brief Offset of the body in http_response_tail, after "NN\r\n\r\n" */
+#define HTTP_BODY_DIGITS  12       /**< @brief Offset of the counter digits in the body, after "View Count: " */
+#define HTTP_TAIL_DIGITS  (HTTP_TAIL_BODY + HTTP_BODY_DIGITS)
+#define HTTP_MAX_DIGITS   10       /**< @brief Digits of UINT32_MAX */
+#define HTTP_RESPONSE_MAX LWIP_MAX(sizeof(http_response_head_close) - 1 + HTTP_TAIL_DIGITS + HTTP_MAX_DIGITS, \
+                                   HTTP_FILE_HEAD_MAX)
+#define HTTP_RESPONSE_PBUFS 3      /**< @brief Send queue entries per response: headers, flash head, tail */
+
+/**
+ * @brief Variable part of the HTTP response: the Content-Length value, the
+ *        end of the header and the body. The body is 13..22 bytes, so the
+ *        Content-Length is always two digits. http_count_view() patches the
+ *        counter digits in place; the tail is copied into lwIP per request,
+ *        as it changes while earlier responses may still be unacknowledged.
+ */
+static char http_response_tail[HTTP_TAIL_DIGITS + HTTP_MAX_DIGITS] = "13\r\n\r\nView Count: 0";
+static size_t http_response_tail_len = HTTP_TAIL_DIGITS + 1; /**< @brief Used length of http_response_tail */
+
+/**
+ * @brief Increments the view counter and its decimal digits in the response tail.
+ *
+ * Only the digits that change are rewritten (carry from the last digit);
+ * the Content-Length is patched when the number of digits grows.
+ */
+static void http_count_view()
+{
+  char *digits = &http_response_tail[HTTP_TAIL_DIGITS];
+  size_t n = http_response_tail_len - HTTP_TAIL_DIGITS;
+
+  if (++view_counter == 0) {
+    digits[0] = '0';
+    n = 1;
+  } else {
+    size_t i = n;
+    while (i > 0 && digits[i - 1] == '9') digits[--i] = '0';
+    if (i > 0) {
+      digits[i - 1]++;
+    } else {
+      digits[0] = '1';
+      digits[n++] = '0';
+    }
+  }
+
+  if (n != http_response_tail_len - HTTP_TAIL_DIGITS) {
+    http_response_tail_len = HTTP_TAIL_DIGITS + n;
+    http_response_tail[0] = '0' + (HTTP_BODY_DIGITS + n) / 10;
+    http_response_tail[1] = '0' + (HTTP_BODY_DIGITS + n) % 10;
+  }
+}
+
+/**
+ * @brief Queues the view count response.
+ *
+ * @param c Connection
+ * @return err_t ERR_OK on success, or the tcp_write() error
+ */
+static err_t http_send_count(struct http_conn *c)
+{
+  const char *head = c->close ? http_response_head_close : http_response_head;
+  size_t head_len = c->close ? sizeof(http_response_head_close) - 1 : sizeof(http_response_head) - 1;
+
+  err_t err = tcp_write(c->pcb, head, head_len, TCP_WRITE_FLAG_MORE);
+  if (err == ERR_OK) {
+    err = tcp_write(c->pcb, http_response_tail, http_response_tail_len, TCP_WRITE_FLAG_COPY);
+  }
+  if (err == ERR_OK) {
+    c->unacked += head_len + http_response_tail_len;
+  }
+  return err;
+}
+
+/**
+ * @brief Handles `GET /`: counts the view and queues the view count response.
+ *
+ * @param c Connection
+ * @return err_t ERR_OK on success, or the tcp_write() error
+ */
+static err_t http_get_root(struct http_conn *c)
+{
+  http_count_view();
+#if HTTP_PROF
+  Serial.printf("HTTP request #%lu received\n", view_counter);
+#endif
+  return http_send_count(c);
+}
+
+/**
+ * @brief Handles `GET /count`: queues the view count without counting a view,
+ *        for the status page to poll.
+ *
+ * @param c Connection
+ * @return err_t ERR_OK on success, or the tcp_write() error
+ */
+static err_t http_get_count(struct http_conn *c)
+{
+  return http_send_count(c);
+}
+
+/**
+ * @brief Queues a status-only response, e.g. 404 Not Found.
+ *
+ * @param c Connection
+ * @param status HTTP status code
+ * @return err_t ERR_OK on success, or the tcp_write() error
+ */
+static err_t http_send_status(struct http_conn *c, uint16_t status)
+{
+  const char *reason;
+  switch (status) {
+  case 400: reason = "Bad Request"; break;
+  case 404: reason = "Not Found"; break;
+  case 405: reason = "Method Not Allowed"; break;
+  case 406: reason = "Not Acceptable"; break;
+  case 413: reason = "Content Too Large"; break;
+  case 414: reason = "URI Too Long"; break;
+  case 431: reason = "Request Header Fields Too Large"; break;
+  case 501: reason = "Not Implemented"; break;
+  case 505: reason = "HTTP Version Not Supported"; break;
+  default: reason = "Error"; break;
+  }
+
+  char response[HTTP_RESPONSE_MAX + 64];
+  int len = snprintf(response, sizeof(response),
+                     "HTTP/1.1 %u %s\r\n"
+                     "Content-Type: text/plain\r\n"
+                     "%s"
+                     "Content-Length: %u\r\n"
+                     "\r\n"
+                     "%s\n",
+                     status, reason, c->close ? "Connection: close\r\n" : "",
+                     (unsigned)strlen(reason) + 1, reason);
+
+  err_t err = tcp_write(c->pcb, response, len, TCP_WRITE_FLAG_COPY);
+  if (err == ERR_OK) {
+    c->unacked += len;
+  }
+  return err;
+}
+
+/**
+ * @brief Request handler, see http_routes.
+ */
+typedef err_t (*http_handler)(struct http_conn *c);
+
+/**
+ * @brief Maps a method and an exact path to a handler.
+ */
+struct http_route {
+  uint8_t method;                  /**< @brief enum http_method */
+  const char *path;                /**< @brief Request path, without query */
+  http_handler handler;            /**< @brief Queues the response */
+};
+
+/**
+ * @brief Served endpoints; other paths get 404 Not Found.
+ */
+static const struct http_route http_routes[] = {
+  {HTTP_METHOD_GET, "/", http_get_root},
+  {HTTP_METHOD_GET, "/count", http_get_count},
+};
+
+/**
+ * @brief Queues 304 Not Modified for a file the client already has.
+ *
+ * @param c Connection
+ * @param file Requested file
+ * @return err_t ERR_OK on success, or the tcp_write() error
+ */
+static err_t http_send_not_modified(struct http_conn *c, const struct http_file *file)
+{
+  char response[HTTP_RESPONSE_MAX];
+  int len = snprintf(response, sizeof(response),
+                     "HTTP/1.1 304 Not Modified\r\n"
+                     "ETag: %s\r\n"
+                     "Cache-Control: no-cache\r\n"
+                     "%s"
+                     "\r\n",
+                     file->etag, c->close ? "Connection: close\r\n" : "");
+
+  err_t err = tcp_write(c->pcb, response, len, TCP_WRITE_FLAG_COPY);
+  if (err == ERR_OK) {
+    c->unacked += len;
+  }
+  return err;
+}
+
+/**
+ * @brief Answers a GET or HEAD request for a file of the static file table.
+ *
+ * The precomputed head is queued by reference; the content follows through
+ * the connection's stream, also by reference. A matching `If-None-Match` gets 304 without content.
+ *
+ * @param c Connection
+ * @param file Requested file
+ * @return err_t ERR_OK on success, or the tcp_write() error
+ */
+static err_t http_send_file(struct http_conn *c, const struct http_file *file)
+{
+  const struct http_parser *req = &c->parser;
+
+  if (req->method != HTTP_METHOD_GET && req->method != HTTP_METHOD_HEAD) {
+    return http_send_status(c, 405);
+  }
+  if (strcmp(req->etag, file->etag) == 0) {
+    return http_send_not_modified(c, file);
+  }
+  if (file->gzip && !(req->flags & HTTP_REQ_GZIP)) {
+    return http_send_status(c, 406);
+  }
+
+  const char *head = c->close ? file->head_close : file->head;
+  size_t head_len = c->close ? file->head_close_len : file->head_len;
+  err_t err = tcp_write(c->pcb, head, head_len, req->method == HTTP_METHOD_GET ? TCP_WRITE_FLAG_MORE : 0);
+  if (err != ERR_OK) {
+    return err;
+  }
+  c->unacked += head_len;
+
+  if (req->method == HTTP_METHOD_GET) {
+    err = tcp_stream_push_buf(&c->stream, file->data, file->len, 0);
+    if (err == ERR_OK) {
+      err = tcp_stream_pump(&c->stream, &c->unacked);
+    }
+  }
+  return err;
+}
+
+/**
+ * @brief Routes a parsed request by method and path and queues the response.
+ *
+ * @param c Connection with a complete (or failed) request in its parser
+ * @return err_t ERR_OK on success, or the tcp_write() error
+ */
+static err_t http_dispatch(struct http_conn *c)
+{
+  const struct http_parser *req = &c->parser;
+
+  if (req->state == HTTP_PARSE_ERROR) {
+    return http_send_status(c, req->status);
+  }
+  if (req->method == HTTP_METHOD_UNKNOWN) {
+    return http_send_status(c, 501);
+  }
+  for (size_t i = 0; i < sizeof(http_routes) / sizeof(http_routes[0]); i++) {
+    if (http_routes[i].method == req->method && strcmp(http_routes[i].path, req->path) == 0) {
+      return http_routes[i].handler(c);
+    }
+  }
+  for (size_t i = 0; i < http_files_count; i++) {
+    if (strcmp(http_files[i].path, req->path) == 0) {
+      return http_send_file(c, &http_files[i]);
+    }
+  }
+  return http_send_status(c, 404);
+}
+
+/**
+ * @brief Releases a connection slot and its buffered request bytes.
+ *
+ * @param c Connection
+ */
+static void http_conn_free(struct http_conn *c)
+{
+  if (c->rx) {
+    pbuf_free(c->rx);
+  }
+  memset(c, 0, sizeof(*c));
+}
+
+/**
+ * @brief Closes a connection and frees its slot.
+ *
+ * @param c Connection
+ * @return err_t ERR_OK, or ERR_ABRT if the PCB had to be aborted
+ */
+static err_t http_conn_close(struct http_conn *c)
+{
+  struct tcp_pcb *pcb = c->pcb;
+  http_conn_free(c);
+
+  tcp_arg(pcb, NULL);
+  tcp_recv(pcb, NULL);
+  tcp_sent(pcb, NULL);
+  tcp_err(pcb, NULL);
+  tcp_poll(pcb, NULL, 0);
+  if (tcp_close(pcb) != ERR_OK) {
+    tcp_abort(pcb);
+    return ERR_ABRT;
+  }
+  return ERR_OK;
+}
+
+/**
+ * @brief Finds a free connection slot, evicting the least recently used idle
+ *        connection when the table is full.
+ *
+ * @return Free slot, or NULL if every connection is busy.
+ */
+static struct http_conn *http_conn_alloc()
+{
+  struct http_conn *lru = NULL;
+
+  for (size_t i = 0; i < HTTP_MAX_CONNS; i++) {
+    struct http_conn *c = &http_conns[i];
+    if (!c->pcb) {
+      return c;
+    }
+    bool idle = !c->rx && c->unacked == 0 && !tcp_stream_pending(&c->stream) && c->parser.state == HTTP_PARSE_METHOD && c->parser.length == 0;
+    if (idle && (!lru || (int32_t)(c->last_ms - lru->last_ms) < 0)) {
+      lru = c;
+    }
+  }
+
+  if (lru) {
+    Serial.println("Connection table full, closing least recently used idle connection");
+    http_conn_close(lru);
+  }
+  return lru;
+}
+
+/**
+ * @brief Answers every complete request buffered on the connection, in order.
+ *
+ * Streamed response content is finished first. Stops early when the send buffer
+ * cannot take another response; http_sent() and http_poll() resume once
+ * acknowledgements free it.
+ *
+ * @param c Connection
+ * @return err_t ERR_OK, or ERR_ABRT if the PCB was aborted
+ */
+static err_t http_process(struct http_conn *c)
+{
+  while (true) {
+    struct http_parser *req = &c->parser;
+
+    if (tcp_stream_pending(&c->stream)) {
+      err_t err = tcp_stream_pump(&c->stream, &c->unacked);
+      if (err != ERR_OK) {
+        Serial.printf("tcp_write failed: %d\n", err);
+        return http_conn_close(c);
+      }
+      if (tcp_stream_pending(&c->stream)) {
+        break;
+      }
+    }
+    if (c->close) {
+      break;
+    }
+
+    if (req->state < HTTP_PARSE_DONE) {
+      if (!c->rx) {
+        break;
+      }
+      u16_t n = http_parser_feed_pbuf(req, c->rx);
+      c->rx = pbuf_free_header(c->rx, n);
+      tcp_recved(c->pcb, n);
+      if (req->state < HTTP_PARSE_DONE) {
+        break;
+      }
+    }
+
+    if (tcp_sndbuf(c->pcb) < HTTP_RESPONSE_MAX ||
+        tcp_sndqueuelen(c->pcb) + HTTP_RESPONSE_PBUFS > TCP_SND_QUEUELEN) {
+      break;
+    }
+
+#if HTTP_PROF
+    if (req->state == HTTP_PARSE_DONE) {
+      Serial.printf("Received request: %s\n", req->path);
+    } else {
+      Serial.printf("Invalid request, answering %u\n", req->status);
+    }
+#endif
+    c->close = !HTTP_KEEPALIVE || req->state == HTTP_PARSE_ERROR || !http_parser_keep_alive(req);
+
+#if HTTP_PROF
+    u32_t t0 = sys_cycles();
+    err_t wr_err = http_dispatch(c);
+    Serial.printf("Response queued in %lu cycles\n", (unsigned long)(sys_cycles() - t0));
+#else
+    err_t wr_err = http_dispatch(c);
+#endif
+
+    if (wr_err != ERR_OK) {
+      Serial.printf("tcp_write failed: %d\n", wr_err);
+      return http_conn_close(c);
+    }
+    request_counter++;
+    http_parser_init(req);
+  }
+
+  tcp_output(c->pcb);
+  return ERR_OK;
+}
+
+/**
+ * @brief Called when sent data has been acknowledged by the client.
+ *        Closes the connection once a final response is delivered, otherwise
+ *        resumes pipelined requests held back by a full send buffer.
+ *
+ * @param arg Connection
+ * @param tpcb TCP protocol control block
+ * @param len Number of bytes acknowledged
+ * @return err_t ERR_OK on success
+ */
+static err_t http_sent(void *arg, struct tcp_pcb *tpcb, u16_t len)
+{
+  struct http_conn *c = (struct http_conn *)arg;
+  LWIP_UNUSED_ARG(tpcb);
+
+  c->unacked -= LWIP_MIN(len, c->unacked);
+  c->last_ms = millis();
+  if (c->close && !tcp_stream_pending(&c->stream)) {
+    if (c->unacked == 0) {
+#if HTTP_PROF
+      Serial.println("All data sent, closing connection");
+#endif
+      return http_conn_close(c);
+    }
+    return ERR_OK;
+  }
+  return http_process(c);
+}
+
+/**
+ * @brief Called when data is received on the TCP connection.
+ *        Buffers the bytes and answers every complete request.
+ *
+ * @param arg Connection
+ * @param tpcb TCP protocol control block
+ * @param p Pointer to received pbuf buffer, NULL when the client closed
+ * @param err Error code
+ * @return err_t ERR_OK on success
+ */
+static err_t http_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
+{
+  struct http_conn *c = (struct http_conn *)arg;
+  LWIP_UNUSED_ARG(err);
+
+  if (!p) {
+#if HTTP_PROF
+    Serial.println("Connection closed by client");
+#endif
+    return http_conn_close(c);
+  }
+
+  if (c->close) {
+    // Requests after the final response are discarded
+    tcp_recved(tpcb, p->tot_len);
+    pbuf_free(p);
+    return ERR_OK;
+  }
+
+  c->last_ms = millis();
+  if (c->rx) {
+    pbuf_cat(c->rx, p);
+  } else {
+    c->rx = p;
+  }
+  return http_process(c);
+}
+
+/**
+ * @brief Called periodically by lwIP for each connection.
+ *        Closes idle connections and retries held back requests.
+ *
+ * @param arg Connection
+ * @param tpcb TCP protocol control block
+ * @return err_t ERR_OK on success
+ */
+static err_t http_poll(void *arg, struct tcp_pcb *tpcb)
+{
+  struct http_conn *c = (struct http_conn *)arg;
+  LWIP_UNUSED_ARG(tpcb);
+
+  if (c->unacked == 0 && !tcp_stream_pending(&c->stream) && millis() - c->last_ms >= HTTP_IDLE_TIMEOUT_MS) {
+#if HTTP_PROF
+    Serial.println("Closing idle connection");
+#endif
+    return http_conn_close(c);
+  }
+  return http_process(c);
+}
+
+/**
+ * @brief Called when lwIP has aborted the connection; the PCB is already freed.
+ *
+ * @param arg Connection
+ * @param err Error code
+ */
+static void http_err(void *arg, err_t err)
+{
+  struct http_conn *c = (struct http_conn *)arg;
+
+  Serial.printf("HTTP connection error: %d\n", err);
+  if (c) {
+    http_conn_free(c);
+  }
+}
+
+/**
+ * @brief Called when a new TCP connection is accepted by the server.
+ *        Assigns a connection slot and sets the connection callbacks.
+ *
+ * @param arg User argument pointer (unused)
+ * @param newpcb New TCP protocol control block for accepted connection
+ * @param err Error code
+ * @return err_t ERR_OK on success
+ */
+static err_t http_accept(void *arg, struct tcp_pcb *newpcb, err_t err)
+{
+  LWIP_UNUSED_ARG(arg);
+  if (err != ERR_OK || !newpcb) {
+    return ERR_VAL;
+  }
+
+  struct http_conn *c = http_conn_alloc();
+  if (!c) {
+    Serial.println("Connection table full, rejecting connection");
+    tcp_abort(newpcb);
+    return ERR_ABRT;
+  }
+
+  c->pcb = newpcb;
+  c->last_ms = millis();
+  http_parser_init(&c->parser);
+  tcp_stream_init(&c->stream, newpcb);
+  tcp_arg(newpcb, c);
+  tcp_recv(newpcb, http_recv);
+  tcp_sent(newpcb, http_sent);
+  tcp_err(newpcb, http_err);
+  tcp_poll(newpcb, http_poll, HTTP_POLL_INTERVAL);
+  // Responses are complete messages, do not hold them back for ACKs
+  tcp_nagle_disable(newpcb);
+
+#if HTTP_PROF
+  size_t open = 0;
+  for (size_t i = 0; i < HTTP_MAX_CONNS; i++) {
+    open += http_conns[i].pcb != NULL;
+  }
+  Serial.printf("HTTP connection accepted (%u/%u)\n", (unsigned)open, (unsigned)HTTP_MAX_CONNS);
+#endif
+  return ERR_OK;
+}
+
+/**
+ * @brief Starts the HTTP server listening on the given port.
+ *        Creates a new TCP PCB, binds, and listens for incoming connections.
+ */
+bool http_server_start(uint16_t port)
+{
+  http_pcb = tcp_new();
+  if (!http_pcb) {
+    Serial.println("Failed to create PCB");
+    return false;
+  }
+
+  if (tcp_bind(http_pcb, IP_ADDR_ANY, port) != ERR_OK) {
+    Serial.println("Failed to bind HTTP server");
+    tcp_close(http_pcb);
+    http_pcb = NULL;
+    return false;
+  }
+
+  http_pcb = tcp_listen(http_pcb);
+  tcp_accept(http_pcb, http_accept);
+  Serial.printf("HTTP server started on port %u\n", port);
+  return true;
+}
+
+/**
+ * @brief Returns the number of HTTP requests answered since startup.
+ */
+uint32_t http_server_requests(void)
+{
+  return request_counter;
+}
@@ -9,170 +9,132 @@
 #include "netif/ethernet.h"
 
 #include "ethif.h"
+#include "ethif_bond.h"
+#include "dhcp_lease.h"
+#include "footprint.h"
+#include "netsched.h"
+#include "http_server.h"
 
 #define USE_STATIC_IP 0            /**< @brief Set to 1 for static IP, 0 for DHCP */
+#define DUTY_REPORT_MS 60000       /**< @brief Interval of the main loop duty cycle report */
+#define W5500_COUNT 1              /**< @brief Number of W5500 modules (1 or 2), see w5500_ports */
+#define W5500_BOND 0               /**< @brief Set to 1 to bond both modules (W5500_COUNT 2) into one failover interface */
+#define SPI_SHARED_IRQ_PIN -1      /**< @brief Pin whose interrupt handler also uses the SPI bus (e.g. an ADC data-ready line), -1 for none */
+
+#if W5500_BOND && W5500_COUNT != 2
+#error "W5500_BOND needs W5500_COUNT 2"
+#endif
+
+#if W5500_BOND
+#define NETIF_COUNT 1              /**< @brief Network interfaces: the bond */
+#else
+#define NETIF_COUNT W5500_COUNT    /**< @brief Network interfaces: one per module */
+#endif
 
 const int BUILTIN_LED_PIN = 13;    /**< @brief Built-in LED pin number */
 const int LED1_PIN = 11;           /**< @brief External LED1 pin */
 const int LED2_PIN = 12;           /**< @brief External LED2 pin */
-const int W5500_CS_PIN = 7;        /**< @brief W5500 chip select pin */
 
-static struct netif netif;         /**< @brief Network interface structure */
+/**
+ * @brief SPI context of one W5500 module, passed to its ethif callbacks.
+ */
+struct w5500_port {
+  int cs_pin;                      /**< @brief Chip select pin */
+  uint32_t spi_hz;                 /**< @brief SPI clock, updated by autotuning */
+  uint8_t mac[6];                  /**< @brief MAC address */
+  uint8_t static_ip;               /**< @brief Last byte of the static IP address (USE_STATIC_IP) */
+};
 
 /**
- * @brief Ethernet interface driver instance for W5500 with SPI callbacks.
+ * @brief W5500 modules on the shared SPI bus, one network interface each.
  */
-static struct ethif ethif_w5500 = {
-    NULL, /* SPI handler/context not used*/
-    [](void *) { digitalWrite(W5500_CS_PIN, LOW); SPI.beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE0)); },
-    [](void *) { digitalWrite(W5500_CS_PIN, HIGH); SPI.endTransaction(); },
-    [](void *, uint8_t c) { return SPI.transfer(c); },
-    (struct eth_addr *)&netif.hwaddr,
-    &ethif_driver_w5500
+static struct w5500_port w5500_ports[W5500_COUNT] = {
+  {7, 4000000, {0x02, 0x00, 0x00, 0x00, 0x00, 0x01}, 40},
+#if W5500_COUNT > 1
+  {6, 4000000, {0x02, 0x00, 0x00, 0x00, 0x00, 0x02}, 41},
+#endif
 };
 
-static struct tcp_pcb *http_pcb;   /**< @brief TCP protocol control block for HTTP server */
-static uint32_t view_counter = 0;  /**< @brief Counter for root HTTP GET requests */
+/**
+ * @brief Candidate W5500 SPI clocks in ascending order (SAMD21 SERCOM tops out at F_CPU / 2).
+ */
+static const uint32_t w5500_spi_speeds[] = {4000000, 8000000, 12000000, 16000000, 24000000};
 
-bool dhcp_bound = false;           /**< @brief Flag to indicate DHCP IP assignment */
-bool http_server_started = false;  /**< @brief Flag to indicate HTTP server running */
+static struct netif netifs[NETIF_COUNT]; /**< @brief Network interface structures, netifs[0] is the default */
+static struct ethif ethifs[W5500_COUNT]; /**< @brief Ethernet interface driver instances, set up in setup() */
+#if W5500_BOND
+static struct ethif_bond bond;           /**< @brief Active/backup bond of ethifs[0] and ethifs[1] */
+#endif
 
 /**
- * @brief Called when all sent data has been acknowledged by the client.
- *        Closes the TCP connection.
- * 
- * @param arg User argument pointer (unused)
- * @param tpcb TCP protocol control block
- * @param len Number of bytes acknowledged
- * @return err_t ERR_OK on success
+ * @brief Claims the SPI bus at the clock of a W5500 module and selects it.
+ *
+ * The bus is claimed before chip select. SPI.beginTransaction() masks the
+ * interrupt lines registered with SPI.usingInterrupt() in setup()
+ * (SPI_SHARED_IRQ_PIN) until SPI.endTransaction(), so a handler using the
+ * bus for another device never runs while a W5500 is selected; all other
+ * interrupts stay enabled.
  */
-static err_t http_sent(void *arg, struct tcp_pcb *tpcb, u16_t len) {
-  Serial.println("All data sent, closing connection");
-  tcp_close(tpcb);
-  return ERR_OK;
+static void w5500_begin(void *ctx)
+{
+  struct w5500_port *port = (struct w5500_port *)ctx;
+  SPI.beginTransaction(SPISettings(port->spi_hz, MSBFIRST, SPI_MODE0));
+  digitalWrite(port->cs_pin, LOW);
 }
 
 /**
- * @brief Called when data is received on the TCP connection.
- *        Handles HTTP GET requests for the root path and sends the view count response.
- * 
- * @param arg User argument pointer (unused)
- * @param tpcb TCP protocol control block
- * @param p Pointer to received pbuf buffer
- * @param err Error code
- * @return err_t ERR_OK on success
+ * @brief Deselects a W5500 module and ends the SPI transaction.
  */
-static err_t http_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
+static void w5500_end(void *ctx)
 {
-  if (!p) {
-    Serial.println("Connection closed by client");
-    tcp_close(tpcb);
-    return ERR_OK;
-  }
-
-  char request[128] = {0};
-  pbuf_copy_partial(p, request, sizeof(request) - 1, 0);
-  Serial.printf("Received request: %s\n", request);
-
-  if (strncmp(request, "GET / ", 6) == 0) {
-    view_counter++;
-    Serial.printf("HTTP request #%lu received\n", view_counter);
-  } else {
-    Serial.println("Non-root request, not incrementing view counter");
-  }
-
-  char response_body[64];
-  snprintf(response_body, sizeof(response_body), "View Count: %lu", view_counter);
-
-  char http_response[256];
-  snprintf(http_response, sizeof(http_response),
-           "HTTP/1.1 200 OK\r\n"
-           "Content-Type: text/plain\r\n"
-           "Content-Length: %d\r\n"
-           "Connection: close\r\n"
-           "\r\n"
-           "%s",
-           strlen(response_body),
-           response_body);
-
-  err_t wr_err = tcp_write(tpcb, http_response, strlen(http_response), TCP_WRITE_FLAG_COPY);
-  if (wr_err != ERR_OK) {
-    Serial.printf("tcp_write failed: %d\n", wr_err);
-  }
-  tcp_output(tpcb);
-
-  pbuf_free(p);
-
-  // Set callback to close connection after data is fully sent
-  tcp_sent(tpcb, http_sent);
-
-  return ERR_OK;
+  struct w5500_port *port = (struct w5500_port *)ctx;
+  digitalWrite(port->cs_pin, HIGH);
+  SPI.endTransaction();
 }
 
 /**
- * @brief Called when a new TCP connection is accepted by the server.
- *        Sets the receive callback to handle incoming data.
- * 
- * @param arg User argument pointer (unused)
- * @param newpcb New TCP protocol control block for accepted connection
- * @param err Error code
- * @return err_t ERR_OK on success
+ * @brief Transfers one byte on the shared SPI bus.
  */
-static err_t http_accept(void *arg, struct tcp_pcb *newpcb, err_t err)
+static uint8_t w5500_txn(void *, uint8_t c)
 {
-  Serial.println("HTTP connection accepted");
-  tcp_recv(newpcb, http_recv);
-  return ERR_OK;
+  return SPI.transfer(c);
 }
 
 /**
- * @brief Starts the HTTP server listening on port 80.
- *        Creates a new TCP PCB, binds, and listens for incoming connections.
+ * @brief Sets the SPI clock of a W5500 module, used from its next transaction.
  */
-void start_http_server()
+static void w5500_set_clock(void *ctx, uint32_t hz)
 {
-  http_pcb = tcp_new();
-  if (!http_pcb) {
-    Serial.println("Failed to create PCB");
-    return;
-  }
-
-  if (tcp_bind(http_pcb, IP_ADDR_ANY, 80) != ERR_OK) {
-    Serial.println("Failed to bind HTTP server");
-    return;
-  }
-
-  http_pcb = tcp_listen(http_pcb);
-  tcp_accept(http_pcb, http_accept);
-  Serial.println("HTTP server started on port 80");
+  ((struct w5500_port *)ctx)->spi_hz = hz;
 }
 
+bool addr_reported[NETIF_COUNT];   /**< @brief Per interface: assigned IP address printed */
+bool http_server_started = false;  /**< @brief Flag to indicate HTTP server running */
+static uint32_t link_up_ms = 0;    /**< @brief millis() at the last link up, 0 once the first request was served */
+static uint32_t link_up_requests;  /**< @brief http_server_requests() at the last link up */
+static uint32_t duty_report_ms;    /**< @brief millis() of the last duty cycle report */
+#if W5500_BOND
+static uint32_t bond_failovers;    /**< @brief bond.failovers at the last report */
+#endif
+
 /**
  * @brief Callback for network interface link status changes.
- *        Starts or stops DHCP as appropriate.
+ *        lwIP's DHCP client itself reacts to link up: a bound (or restored)
+ *        lease is confirmed with a single DHCPREQUEST (INIT-REBOOT) instead
+ *        of a new DISCOVER/OFFER/REQUEST/ACK exchange.
  * 
  * @param netif Pointer to the network interface
  */
 static void netif_link_callback(struct netif *netif)
 {
   if (netif_is_link_up(netif)) {
-    Serial.println("Link is UP");
-
-#if !USE_STATIC_IP
-    Serial.println("Restarting DHCP...");
-    dhcp_release(netif);  // optional: free existing lease
-    dhcp_stop(netif);
-    dhcp_bound = false;
-    dhcp_start(netif);
-#endif
-
+    Serial.printf("Interface #%d link is UP\n", (int)(netif - netifs));
+    link_up_ms = millis();
+    if (link_up_ms == 0) link_up_ms = 1;
+    link_up_requests = http_server_requests();
   } else {
-    Serial.println("Link is DOWN");
-
-#if !USE_STATIC_IP
-    dhcp_stop(netif);     // stop any existing session
-    dhcp_bound = false;
-#endif
+    Serial.printf("Interface #%d link is DOWN\n", (int)(netif - netifs));
+    addr_reported[netif - netifs] = false;
   }
 }
 
@@ -185,54 +147,143 @@ void setup() {
   while (!Serial) delay(50);         
 
   SPI.begin();                       
-  pinMode(W5500_CS_PIN, OUTPUT);
-  digitalWrite(W5500_CS_PIN, HIGH);
+#if SPI_SHARED_IRQ_PIN >= 0
+  // Held off only while a W5500 transaction owns the bus
+  SPI.usingInterrupt(digitalPinToInterrupt(SPI_SHARED_IRQ_PIN));
+#endif
+  // Deselect every module before talking to any of them
+  for (int i = 0; i < W5500_COUNT; i++) {
+    pinMode(w5500_ports[i].cs_pin, OUTPUT);
+    digitalWrite(w5500_ports[i].cs_pin, HIGH);
+  }
   pinMode(BUILTIN_LED_PIN, OUTPUT);  
 
   Serial.printf("Starting, CPU freq %.2f MHz\n", (double)F_CPU / 1000000);
   
   lwip_init();
+  Serial.printf("lwIP static RAM %u bytes\n", (unsigned)footprint_static_bytes());
+
+  for (int i = 0; i < W5500_COUNT; i++) {
+    struct w5500_port *port = &w5500_ports[i];
+    struct ethif *ethif = &ethifs[i];
+
+    // The MAC address pointer is set by ethif_init() (or the bond) from the netif
+    memset(ethif, 0, sizeof(*ethif));
+    ethif->spi = port;
+    ethif->begin = w5500_begin;
+    ethif->end = w5500_end;
+    ethif->txn = w5500_txn;
+    ethif->set_clock = w5500_set_clock;
+    ethif->driver = &ethif_driver_w5500;
+
+    if (ethif_spi_autotune(ethif, w5500_spi_speeds, sizeof(w5500_spi_speeds) / sizeof(w5500_spi_speeds[0]))) {
+      Serial.printf("W5500 #%d SPI clock %lu Hz\n", i, port->spi_hz);
+    } else {
+      Serial.printf("W5500 #%d SPI integrity check failed\n", i);
+    }
+  }
+
+#if W5500_BOND
+  // Both modules answer for the MAC and IP address of the primary
+  ethif_bond_setup(&bond, &ethifs[0], &ethifs[1]);
+#endif
 
-  const uint8_t mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
-  memcpy(netif.hwaddr, mac, 6);
+  for (int i = 0; i < NETIF_COUNT; i++) {
+    struct w5500_port *port = &w5500_ports[i];
+    struct netif *netif = &netifs[i];
+#if W5500_BOND
+    struct ethif *ethif = &bond.ethif;
+#else
+    struct ethif *ethif = &ethifs[i];
+#endif
+
+    memcpy(netif->hwaddr, port->mac, 6);
 
 #if USE_STATIC_IP
-  ip4_addr_t ipaddr, netmask, gw;
-  IP4_ADDR(&ipaddr, 192, 168, 50, 40);
-  IP4_ADDR(&netmask, 255, 255, 255, 0);
-  IP4_ADDR(&gw, 192, 168, 50, 1);
-  netif_add(&netif, &ipaddr, &netmask, &gw, &ethif_w5500, ethif_init, ethernet_input);
+    ip4_addr_t ipaddr, netmask, gw;
+    IP4_ADDR(&ipaddr, 192, 168, 50, port->static_ip);
+    IP4_ADDR(&netmask, 255, 255, 255, 0);
+    IP4_ADDR(&gw, 192, 168, 50, 1);
+    netif_add(netif, &ipaddr, &netmask, &gw, ethif, ethif_init, ethernet_input);
 #else
-  netif_add(&netif, IP_ADDR_ANY, IP_ADDR_ANY, IP_ADDR_ANY, &ethif_w5500, ethif_init, ethernet_input);
+    netif_add(netif, IP_ADDR_ANY, IP_ADDR_ANY, IP_ADDR_ANY, ethif, ethif_init, ethernet_input);
 #endif
-  netif_set_default(&netif);
-  netif_set_link_callback(&netif, netif_link_callback);
-  netif_set_up(&netif);
+    netif_set_link_callback(netif, netif_link_callback);
+    netif_set_up(netif);
+
+#if !USE_STATIC_IP
+    // The link is still down: DHCP waits for it, starting from a cached lease if one survived the reset
+    dhcp_start(netif);
+    if (dhcp_lease_restore(netif)) {
+      Serial.printf("Interface #%d rebinding cached DHCP lease\n", i);
+    }
+#endif
+  }
+  netif_set_default(&netifs[0]);
 }
 
 /**
  * @brief Arduino main loop.
- *        Polls ethernet, checks DHCP assignment, and starts HTTP server once ready.
+ *        Sleeps until the next network event, polls ethernet, checks DHCP
+ *        assignment, and starts HTTP server once ready.
  */
 void loop() {
-  ethif_poll(&netif);
-  sys_check_timeouts();
-
-  if (!dhcp_bound && netif_is_up(&netif) && netif.ip_addr.addr != 0) {
-    dhcp_bound = true;
-
-    Serial.print("Assigned IP: ");
-    Serial.println(ip4addr_ntoa(&netif.ip_addr));
-    Serial.print("Netmask: ");
-    Serial.println(ip4addr_ntoa(&netif.netmask));
-    Serial.print("Gateway: ");
-    Serial.println(ip4addr_ntoa(&netif.gw));
+  netsched_run();
+
+  bool any_addr = false;
+  for (int i = 0; i < NETIF_COUNT; i++) {
+    struct netif *netif = &netifs[i];
+#if USE_STATIC_IP
+    bool have_addr = netif->ip_addr.addr != 0;
+#else
+    bool have_addr = dhcp_supplied_address(netif);
+#endif
+
+    if (!addr_reported[i] && netif_is_up(netif) && have_addr) {
+      addr_reported[i] = true;
+
+      Serial.printf("Interface #%d assigned IP: ", i);
+      Serial.println(ip4addr_ntoa(&netif->ip_addr));
+      Serial.print("Netmask: ");
+      Serial.println(ip4addr_ntoa(&netif->netmask));
+      Serial.print("Gateway: ");
+      Serial.println(ip4addr_ntoa(&netif->gw));
+
+#if !USE_STATIC_IP
+      dhcp_lease_save(netif);
+#endif
+    }
+    any_addr |= addr_reported[i] && netif_is_up(netif) && netif->ip_addr.addr != 0;
   }
 
-  if (!http_server_started && dhcp_bound && netif_is_up(&netif) && netif.ip_addr.addr != 0) {
+  // The server listens on every interface
+  if (!http_server_started && any_addr) {
     http_server_started = true;
 
     Serial.println("Starting HTTP server...");
-    start_http_server();
+    http_server_start(80);
+    footprint_dump([](const char *line, void *) { Serial.println(line); }, NULL);
   }
+
+  if (link_up_ms != 0 && http_server_requests() != link_up_requests) {
+    Serial.printf("First request served %lu ms after link up\n", millis() - link_up_ms);
+    link_up_ms = 0;
+  }
+
+#if W5500_BOND
+  if (bond.failovers != bond_failovers) {
+    bond_failovers = bond.failovers;
+    Serial.printf("Bond failed over to W5500 #%u within %lu ms\n", (unsigned)bond.active, bond.failover_ms);
+  }
+#endif
+
+  if (millis() - duty_report_ms >= DUTY_REPORT_MS) {
+    duty_report_ms = millis();
+    netsched_dump([](const char *line, void *) { Serial.println(line); }, NULL);
+    netsched_reset_stats();
+  }
+
+#ifdef LWIP_DEBUG
+  lwip_debug_flush(4);
+#endif
 }
@@ -0,0 +1,90 @@
+/**
+ * @file
+ * @brief Host stand-in for the parts of the Arduino core the sketch uses.
+ *
+ * Time comes from the simulated clock of sim.h, pins only matter as W5500
+ * chip selects (see SPI.h), and Serial output is charged to the simulated
+ * CPU at USB CDC speed, then echoed on stderr in verbose mode and handed to
+ * the line hook of the running test.
+ */
+
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define F_CPU 48000000UL
+
+#define LOW    0
+#define HIGH   1
+#define INPUT  0
+#define OUTPUT 1
+
+/**
+ * @brief External interrupt number of a pin: the simulated interrupt line
+ *        is the pin number (see sim_irq_after()).
+ */
+#define digitalPinToInterrupt(pin) (pin)
+
+/**
+ * @brief Estimated target cost of Serial output (SAMD21 native USB CDC).
+ */
+#define ARDUINO_SIM_SERIAL_CALL_NS  20000u  /**< One print call */
+#define ARDUINO_SIM_SERIAL_BYTE_PS  1000000u /**< Per byte, about 1 MB/s */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int val);
+void noInterrupts(void);
+void interrupts(void);
+
+/**
+ * @brief Receives every complete line printed on Serial.
+ */
+void arduino_serial_hook(void (*fn)(const char *line, void *arg), void *arg);
+
+/**
+ * @brief Serial bytes printed since the start of the run.
+ */
+uint64_t arduino_serial_bytes(void);
+
+/**
+ * @brief Sets what Serial.availableForWrite() reports, -1 for the default
+ *        of a USB CDC port that is always drained (64).
+ */
+void arduino_serial_room(int bytes);
+
+#ifdef __cplusplus
+}
+
+/**
+ * @brief Serial port: the subset of Arduino's Print used by the sketch.
+ */
+class HostSerial {
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  operator bool() const { return true; }
+  size_t write(const uint8_t *data, size_t len);
+  size_t write(uint8_t c) { return write(&c, 1); }
+  int availableForWrite(void);
+  size_t print(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  size_t println(const char *s);
+  size_t println(void) { return print("\n"); }
+  size_t println(int n) { return printf("%d\n", n); }
+  size_t printf(const char *fmt, ...);
+};
+
+extern HostSerial Serial;
+
+#endif /* __cplusplus */
+
+#endif // __HOST_ARDUINO_H__
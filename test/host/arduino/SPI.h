@@ -0,0 +1,58 @@
+/**
+ * @file
+ * @brief Host stand-in for the Arduino SPI library.
+ *
+ * The bus routes transfers to the simulated W5500 whose chip select pin was
+ * driven low with digitalWrite(); chips are attached to pins by the board
+ * code. The clock of SPISettings is applied to the chip at chip select.
+ * beginTransaction() masks the simulated interrupt lines registered with
+ * usingInterrupt() until endTransaction(), like the SAMD core does for
+ * external interrupts.
+ */
+
+#ifndef __HOST_SPI_H__
+#define __HOST_SPI_H__
+
+#include <stdint.h>
+
+#include "w5500_sim.h"
+
+#define MSBFIRST  1
+#define SPI_MODE0 0
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Connects the chip select of @p chip to @p pin, NULL to disconnect.
+ */
+void arduino_spi_attach(int pin, struct w5500_sim *chip);
+
+#ifdef __cplusplus
+}
+
+class SPISettings {
+public:
+  SPISettings(uint32_t clock, uint8_t bit_order, uint8_t data_mode)
+    : clock(clock) { (void)bit_order; (void)data_mode; }
+  uint32_t clock;
+};
+
+/**
+ * @brief SPI bus shared by the attached chips.
+ */
+class HostSPI {
+public:
+  void begin(void) {}
+  void usingInterrupt(int interruptNumber);
+  void beginTransaction(SPISettings settings);
+  void endTransaction(void);
+  uint8_t transfer(uint8_t data);
+};
+
+extern HostSPI SPI;
+
+#endif /* __cplusplus */
+
+#endif // __HOST_SPI_H__
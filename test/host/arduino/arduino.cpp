@@ -0,0 +1,171 @@
+/**
+ * @file
+ * @brief Host stand-in for the Arduino core and SPI library.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "Arduino.h"
+#include "SPI.h"
+#include "sim.h"
+
+#define ARDUINO_SIM_PINS 64
+
+HostSerial Serial;
+HostSPI SPI;
+
+static struct w5500_sim *spi_chips[ARDUINO_SIM_PINS]; /**< Chip behind each chip select pin */
+static struct w5500_sim *spi_selected;                 /**< Chip currently selected */
+static uint32_t spi_clock = 4000000;                   /**< Clock of the current transaction */
+static uint32_t spi_irq_lines;                         /**< Lines registered with usingInterrupt() */
+
+static void (*serial_hook)(const char *line, void *arg);
+static void *serial_hook_arg;
+static char serial_line[256];
+static size_t serial_line_len;
+static uint64_t serial_bytes;
+static int serial_room = -1;                          /**< Free bytes of the port, -1 if always drained */
+
+unsigned long millis(void)
+{
+  return (unsigned long)(uint32_t)(sim_now_ns() / 1000000u);
+}
+
+unsigned long micros(void)
+{
+  return (unsigned long)(uint32_t)(sim_now_ns() / 1000u);
+}
+
+void delay(unsigned long ms)
+{
+  sim_advance((uint64_t)ms * 1000000u);
+}
+
+void pinMode(int pin, int mode)
+{
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(int pin, int val)
+{
+  if (pin < 0 || pin >= ARDUINO_SIM_PINS || spi_chips[pin] == NULL) {
+    return;
+  }
+  struct w5500_sim *chip = spi_chips[pin];
+  if (val == LOW && spi_selected == NULL) {
+    chip->spi_hz = spi_clock;
+    spi_selected = chip;
+    w5500_sim_begin(chip);
+  } else if (val == HIGH && spi_selected == chip) {
+    w5500_sim_end(chip);
+    spi_selected = NULL;
+  }
+}
+
+void noInterrupts(void)
+{
+}
+
+void interrupts(void)
+{
+}
+
+void arduino_spi_attach(int pin, struct w5500_sim *chip)
+{
+  if (pin >= 0 && pin < ARDUINO_SIM_PINS) {
+    spi_chips[pin] = chip;
+  }
+}
+
+void arduino_serial_hook(void (*fn)(const char *line, void *arg), void *arg)
+{
+  serial_hook = fn;
+  serial_hook_arg = arg;
+}
+
+uint64_t arduino_serial_bytes(void)
+{
+  return serial_bytes;
+}
+
+void arduino_serial_room(int bytes)
+{
+  serial_room = bytes;
+}
+
+int HostSerial::availableForWrite(void)
+{
+  return serial_room < 0 ? 64 : serial_room;
+}
+
+void HostSPI::usingInterrupt(int interruptNumber)
+{
+  if (interruptNumber >= 0 && interruptNumber < 32) {
+    spi_irq_lines |= 1u << interruptNumber;
+  }
+}
+
+void HostSPI::beginTransaction(SPISettings settings)
+{
+  sim_irq_mask(spi_irq_lines);
+  spi_clock = settings.clock;
+}
+
+void HostSPI::endTransaction(void)
+{
+  sim_irq_unmask(spi_irq_lines);
+}
+
+uint8_t HostSPI::transfer(uint8_t data)
+{
+  return spi_selected ? w5500_sim_txn(spi_selected, data) : 0xff;
+}
+
+size_t HostSerial::write(const uint8_t *data, size_t len)
+{
+  sim_advance(ARDUINO_SIM_SERIAL_CALL_NS);
+  sim_cpu_bytes((uint32_t)len, ARDUINO_SIM_SERIAL_BYTE_PS);
+  serial_bytes += len;
+  if (serial_room >= 0) {
+    serial_room = (size_t)serial_room > len ? serial_room - (int)len : 0;
+  }
+  for (size_t i = 0; i < len; i++) {
+    if (data[i] != '\n' && serial_line_len < sizeof(serial_line) - 1) {
+      serial_line[serial_line_len++] = (char)data[i];
+      continue;
+    }
+    if (data[i] != '\n') {
+      continue;
+    }
+    serial_line[serial_line_len] = '\0';
+    serial_line_len = 0;
+    if (sim_verbose()) {
+      fprintf(stderr, "[%10.3f] %s\n", (double)sim_now_ns() / 1e6, serial_line);
+    }
+    if (serial_hook) {
+      serial_hook(serial_line, serial_hook_arg);
+    }
+  }
+  return len;
+}
+
+size_t HostSerial::println(const char *s)
+{
+  size_t n = print(s);
+  return n + print("\n");
+}
+
+size_t HostSerial::printf(const char *fmt, ...)
+{
+  char buf[256];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  if (n < 0) {
+    return 0;
+  }
+  return write((const uint8_t *)buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+}
@@ -0,0 +1,305 @@
+/**
+ * @file
+ * @brief Simulated board for the host tests and benchmarks.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "lwip/init.h"
+#include "lwip/dhcp.h"
+#include "lwip/tcp.h"
+#include "lwip/timeouts.h"
+#include "netif/ethernet.h"
+
+#include "board.h"
+
+#define BOARD_IFS 4
+
+static struct board_if *board_ifs[BOARD_IFS];
+static size_t board_if_count;
+
+int board_scenario(const char *name, int (*fn)(void *arg), void *arg)
+{
+  fflush(stdout);
+  fflush(stderr);
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    return 1;
+  }
+  if (pid == 0) {
+    int rc = fn(arg);
+    fflush(stdout);
+    fflush(stderr);
+    _exit(rc == 0 ? 0 : 1);
+  }
+  int status = 0;
+  if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    if (WIFSIGNALED(status)) {
+      fprintf(stderr, "FAIL %s (signal %d)\n", name, WTERMSIG(status));
+    } else {
+      fprintf(stderr, "FAIL %s\n", name);
+    }
+    return 1;
+  }
+  fprintf(stderr, "ok   %s\n", name);
+  return 0;
+}
+
+void board_init(void)
+{
+  sim_reset();
+  net_reset();
+  board_if_count = 0;
+  lwip_init();
+}
+
+void board_mac(uint8_t index, uint8_t mac[6])
+{
+  static const uint8_t base[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x00};
+  memcpy(mac, base, 6);
+  mac[5] = index;
+}
+
+void board_if_power(struct board_if *bif, uint8_t index)
+{
+  memset(bif, 0, sizeof(*bif));
+  w5500_sim_init(&bif->chip);
+  net_attach_chip(&bif->port, &bif->chip);
+  net_set_cable(&bif->port, true);
+  bif->ethif.spi = &bif->chip;
+  bif->ethif.begin = w5500_sim_begin;
+  bif->ethif.end = w5500_sim_end;
+  bif->ethif.txn = w5500_sim_txn;
+  bif->ethif.driver = &ethif_driver_w5500;
+  board_mac(index, bif->netif.hwaddr);
+}
+
+bool board_if_up(struct board_if *bif, uint32_t ip, netif_input_fn input)
+{
+  ip4_addr_t addr, mask, gw;
+  ip4_addr_set_u32(&addr, lwip_htonl(ip));
+  ip4_addr_set_u32(&mask, ip ? lwip_htonl(BOARD_NETMASK) : 0);
+  ip4_addr_set_u32(&gw, ip ? lwip_htonl(BOARD_ROUTER) : 0);
+  if (netif_add(&bif->netif, &addr, &mask, &gw, &bif->ethif, ethif_init,
+                input ? input : ethernet_input) == NULL) {
+    return false;
+  }
+  if (board_if_count < BOARD_IFS) {
+    board_ifs[board_if_count++] = bif;
+  }
+  netif_set_up(&bif->netif);
+  if (board_if_count == 1) {
+    netif_set_default(&bif->netif);
+  }
+  if (ip == 0) {
+    dhcp_start(&bif->netif);
+  }
+  return true;
+}
+
+void board_if_mcu_reset(struct board_if *bif)
+{
+  uint8_t mac[6];
+  netif_remove(&bif->netif);
+  for (size_t i = 0; i < board_if_count; i++) {
+    if (board_ifs[i] == bif) {
+      memmove(&board_ifs[i], &board_ifs[i + 1], (board_if_count - i - 1) * sizeof(board_ifs[0]));
+      board_if_count--;
+      break;
+    }
+  }
+  memcpy(mac, bif->netif.hwaddr, sizeof(mac));
+  memset(&bif->netif, 0, sizeof(bif->netif));
+  memset(&bif->ethif, 0, sizeof(bif->ethif));
+  bif->ethif.spi = &bif->chip;
+  bif->ethif.begin = w5500_sim_begin;
+  bif->ethif.end = w5500_sim_end;
+  bif->ethif.txn = w5500_sim_txn;
+  bif->ethif.driver = &ethif_driver_w5500;
+  memcpy(bif->netif.hwaddr, mac, sizeof(mac));
+}
+
+void board_router(struct peer *router)
+{
+  static const uint8_t mac[6] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x01};
+  peer_init(router, mac, BOARD_ROUTER, BOARD_NETMASK);
+  peer_dhcp_server(router, BOARD_POOL, 3600);
+}
+
+void board_poll(void)
+{
+  for (size_t i = 0; i < board_if_count; i++) {
+    ethif_poll(&board_ifs[i]->netif);
+  }
+  sys_check_timeouts();
+  sim_advance(SIM_CPU_LOOP_NS);
+}
+
+bool board_run(bool (*done)(void *arg), void *arg, uint32_t timeout_ms)
+{
+  uint64_t end = sim_now_ns() + (uint64_t)timeout_ms * 1000000u;
+  while (!done(arg)) {
+    if (sim_now_ns() >= end) {
+      return false;
+    }
+    board_poll();
+  }
+  return true;
+}
+
+static bool board_never(void *arg)
+{
+  (void)arg;
+  return false;
+}
+
+void board_run_for(uint32_t ms)
+{
+  board_run(board_never, NULL, ms);
+}
+
+static bool board_all_addr(void *arg)
+{
+  (void)arg;
+  for (size_t i = 0; i < board_if_count; i++) {
+    struct netif *netif = &board_ifs[i]->netif;
+    if (ip4_addr_isany_val(*netif_ip4_addr(netif)) || !netif_is_link_up(netif)) {
+      return false;
+    }
+#if LWIP_DHCP
+    if (netif_dhcp_data(netif) != NULL && !dhcp_supplied_address(netif)) {
+      return false;
+    }
+#endif
+  }
+  return true;
+}
+
+bool board_wait_addr(uint32_t timeout_ms)
+{
+  return board_run(board_all_addr, NULL, timeout_ms);
+}
+
+uint32_t board_ip(const struct board_if *bif)
+{
+  return lwip_ntohl(ip4_addr_get_u32(netif_ip4_addr(&bif->netif)));
+}
+
+static err_t board_echo_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+  (void)arg;
+  (void)err;
+  if (p == NULL) {
+    tcp_close(pcb);
+    return ERR_OK;
+  }
+  for (struct pbuf *q = p; q != NULL; q = q->next) {
+    if (tcp_write(pcb, q->payload, q->len, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+      break;
+    }
+  }
+  tcp_output(pcb);
+  tcp_recved(pcb, p->tot_len);
+  pbuf_free(p);
+  return ERR_OK;
+}
+
+static err_t board_echo_accept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+  (void)arg;
+  if (err != ERR_OK || pcb == NULL) {
+    return ERR_VAL;
+  }
+  tcp_nagle_disable(pcb);
+  tcp_recv(pcb, board_echo_recv);
+  return ERR_OK;
+}
+
+bool board_echo_start(uint16_t port)
+{
+  struct tcp_pcb *pcb = tcp_new();
+  if (pcb == NULL || tcp_bind(pcb, IP_ADDR_ANY, port) != ERR_OK) {
+    return false;
+  }
+  pcb = tcp_listen(pcb);
+  if (pcb == NULL) {
+    return false;
+  }
+  tcp_accept(pcb, board_echo_accept);
+  return true;
+}
+
+static void board_probe_tick(void *arg)
+{
+  struct board_probe *pr = (struct board_probe *)arg;
+  static uint8_t msg[1460];
+  if (!pr->running) {
+    return;
+  }
+  sim_after((uint64_t)pr->interval_ms * 1000000u, board_probe_tick, pr);
+  if (pr->conn.state != PEER_TCP_ESTABLISHED) {
+    return;
+  }
+  if (pr->waiting) {
+    pr->skipped++;
+    return;
+  }
+  pr->waiting = true;
+  pr->got = 0;
+  pr->sent_ns = sim_now_ns();
+  peer_write(&pr->conn, msg, pr->size);
+}
+
+static void board_probe_recv(struct peer_conn *c, const uint8_t *data, size_t len, void *arg)
+{
+  struct board_probe *pr = (struct board_probe *)arg;
+  (void)c;
+  (void)data;
+  pr->got += len;
+  if (pr->waiting && pr->got >= pr->size) {
+    pr->waiting = false;
+    pr->got -= pr->size;
+    if (pr->count < BOARD_PROBE_MAX) {
+      pr->rtt_us[pr->count++] = (uint32_t)((sim_now_ns() - pr->sent_ns) / 1000u);
+    }
+  }
+}
+
+void board_probe_start(struct board_probe *pr, struct peer *peer, uint32_t ip, uint16_t port,
+                       size_t size, uint32_t interval_ms)
+{
+  memset(pr, 0, sizeof(*pr));
+  pr->size = size;
+  pr->interval_ms = interval_ms;
+  pr->running = true;
+  pr->conn.on_recv = board_probe_recv;
+  pr->conn.arg = pr;
+  peer_connect(peer, &pr->conn, ip, port);
+  sim_after((uint64_t)interval_ms * 1000000u, board_probe_tick, pr);
+}
+
+void board_probe_stop(struct board_probe *pr)
+{
+  pr->running = false;
+  sim_cancel(board_probe_tick, pr);
+}
+
+static int board_u32_cmp(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  return x < y ? -1 : x > y;
+}
+
+uint32_t board_probe_pct(struct board_probe *pr, unsigned pct)
+{
+  if (pr->count == 0) {
+    return 0;
+  }
+  qsort(pr->rtt_us, pr->count, sizeof(pr->rtt_us[0]), board_u32_cmp);
+  size_t i = (size_t)(((uint64_t)pr->count * pct + 99) / 100);
+  return pr->rtt_us[i == 0 ? 0 : i - 1];
+}
@@ -0,0 +1,180 @@
+/**
+ * @file
+ * @brief Simulated board for the host tests and benchmarks.
+ *
+ * Wires simulated W5500 chips to the port's ethif driver and to the switch,
+ * runs the main loop on the simulated clock and isolates scenarios: each
+ * one runs in a forked child, so the static state of lwIP, the driver and
+ * the sketch starts fresh, and a crash fails only that scenario. Scenarios
+ * print CSV rows on stdout; diagnostics go to stderr.
+ *
+ * The network is 192.168.50.0/24 with a router and DHCP server at .1.
+ */
+
+#ifndef __BOARD_H__
+#define __BOARD_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "lwip/netif.h"
+#include "ethif.h"
+
+#include "sim.h"
+#include "w5500_sim.h"
+#include "net.h"
+#include "peer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BOARD_NET      PEER_IP(192, 168, 50, 0)
+#define BOARD_NETMASK  PEER_IP(255, 255, 255, 0)
+#define BOARD_ROUTER   PEER_IP(192, 168, 50, 1)
+#define BOARD_POOL     PEER_IP(192, 168, 50, 100)   /**< First DHCP address */
+#define BOARD_STATIC   PEER_IP(192, 168, 50, 40)    /**< Static address of the first module */
+
+/**
+ * @brief One W5500 module and its network interface.
+ */
+struct board_if {
+  struct w5500_sim chip;
+  struct net_port port;
+  struct ethif ethif;
+  struct netif netif;
+};
+
+/**
+ * @brief Fails the running scenario if @p cond is false.
+ */
+#define BOARD_CHECK(cond)                                                        \
+  do {                                                                           \
+    if (!(cond)) {                                                               \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);   \
+      return 1;                                                                  \
+    }                                                                            \
+  } while (0)
+
+/**
+ * @brief Runs @p fn in a forked child and reports its result.
+ *
+ * @return 0 if the scenario returned 0, else 1.
+ */
+int board_scenario(const char *name, int (*fn)(void *arg), void *arg);
+
+/**
+ * @brief Resets the clock and the switch, then calls lwip_init().
+ */
+void board_init(void);
+
+/**
+ * @brief Powers on a module with MAC 02:00:00:00:00:<index> and plugs its cable.
+ *
+ * The chip runs at 8 MHz with the ethif transport callbacks set, but is not
+ * initialized; call board_if_up() next, or let the sketch do it.
+ */
+void board_if_power(struct board_if *bif, uint8_t index);
+
+/**
+ * @brief Adds the interface with a static address, or DHCP if @p ip is 0.
+ *
+ * @param input netif input function, NULL for ethernet_input().
+ * @return true if ethif_init() succeeded.
+ */
+bool board_if_up(struct board_if *bif, uint32_t ip, netif_input_fn input);
+
+/**
+ * @brief MCU reset of a module: its netif is removed and the driver state
+ *        cleared, while the chip keeps its registers, buffers and link.
+ *
+ * Call board_if_up() next, as setup() would after the reset.
+ */
+void board_if_mcu_reset(struct board_if *bif);
+
+/**
+ * @brief MAC address of module @p index.
+ */
+void board_mac(uint8_t index, uint8_t mac[6]);
+
+/**
+ * @brief Adds the router peer at .1, serving DHCP from BOARD_POOL.
+ */
+void board_router(struct peer *router);
+
+/**
+ * @brief One main loop pass over every interface added with board_if_up().
+ */
+void board_poll(void);
+
+/**
+ * @brief Runs the main loop until @p done returns true or @p timeout_ms passes.
+ *
+ * @return true if @p done returned true.
+ */
+bool board_run(bool (*done)(void *arg), void *arg, uint32_t timeout_ms);
+
+/**
+ * @brief Runs the main loop for @p ms.
+ */
+void board_run_for(uint32_t ms);
+
+/**
+ * @brief Runs the main loop until every interface added has a DHCP or static address.
+ */
+bool board_wait_addr(uint32_t timeout_ms);
+
+/**
+ * @brief Address of an interface, host byte order.
+ */
+uint32_t board_ip(const struct board_if *bif);
+
+/**
+ * @brief Starts a TCP echo server on the board, on every interface.
+ */
+bool board_echo_start(uint16_t port);
+
+#define BOARD_PROBE_MAX 4096  /**< Round trips a probe keeps */
+
+/**
+ * @brief Peer side of a request/response flow to the echo server.
+ *
+ * Every interval a message of size bytes is written, unless the previous
+ * one is still unanswered; its round trip time is recorded when the whole
+ * echo is back.
+ */
+struct board_probe {
+  struct peer_conn conn;
+  size_t size;                    /**< Message size */
+  uint32_t interval_ms;
+  bool running;
+  bool waiting;                   /**< A message is unanswered */
+  uint64_t sent_ns;               /**< Time the unanswered message was written */
+  size_t got;                     /**< Echo bytes of the unanswered message */
+  uint32_t skipped;               /**< Intervals skipped while waiting */
+  uint32_t count;                 /**< Round trips recorded */
+  uint32_t rtt_us[BOARD_PROBE_MAX];
+};
+
+/**
+ * @brief Connects @p peer to the echo server at @p ip and starts probing.
+ */
+void board_probe_start(struct board_probe *pr, struct peer *peer, uint32_t ip, uint16_t port,
+                       size_t size, uint32_t interval_ms);
+
+/**
+ * @brief Stops sending; the connection stays open.
+ */
+void board_probe_stop(struct board_probe *pr);
+
+/**
+ * @brief Percentile @p pct (0-100) of the recorded round trips in us.
+ */
+uint32_t board_probe_pct(struct board_probe *pr, unsigned pct);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BOARD_H__
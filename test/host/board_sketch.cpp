@@ -0,0 +1,86 @@
+/**
+ * @file
+ * @brief Runs the sketch (src/main.cpp) on the simulated board.
+ */
+
+#include <string.h>
+
+#include "Arduino.h"
+#include "SPI.h"
+
+#include "board_sketch.h"
+
+void setup();
+void loop();
+
+#define BOARD_SKETCH_LINES 32
+
+static char sketch_lines[BOARD_SKETCH_LINES][160];
+static uint64_t sketch_line_ns[BOARD_SKETCH_LINES];
+static unsigned sketch_line_next;
+
+static void sketch_serial(const char *line, void *arg)
+{
+  (void)arg;
+  strncpy(sketch_lines[sketch_line_next % BOARD_SKETCH_LINES], line, sizeof(sketch_lines[0]) - 1);
+  sketch_line_ns[sketch_line_next % BOARD_SKETCH_LINES] = sim_now_ns();
+  sketch_line_next++;
+}
+
+void board_sketch_init(struct w5500_sim *chips, struct net_port *ports, int count)
+{
+  static const int pins[] = {BOARD_SKETCH_CS0, BOARD_SKETCH_CS1};
+  sim_reset();
+  net_reset();
+  arduino_serial_hook(sketch_serial, NULL);
+  for (int i = 0; i < count && i < 2; i++) {
+    w5500_sim_init(&chips[i]);
+    net_attach_chip(&ports[i], &chips[i]);
+    net_set_cable(&ports[i], true);
+    arduino_spi_attach(pins[i], &chips[i]);
+  }
+}
+
+void board_sketch_setup(void)
+{
+  setup();
+}
+
+bool board_sketch_run(bool (*done)(void *arg), void *arg, uint32_t timeout_ms)
+{
+  uint64_t end = sim_now_ns() + (uint64_t)timeout_ms * 1000000u;
+  while (!done(arg)) {
+    if (sim_now_ns() >= end) {
+      return false;
+    }
+    loop();
+    sim_advance(SIM_CPU_LOOP_NS);
+  }
+  return true;
+}
+
+static bool sketch_never(void *arg)
+{
+  (void)arg;
+  return false;
+}
+
+void board_sketch_run_for(uint32_t ms)
+{
+  board_sketch_run(sketch_never, NULL, ms);
+}
+
+const char *board_sketch_line(const char *prefix, uint64_t *at_ns)
+{
+  size_t n = strlen(prefix);
+  for (unsigned i = 0; i < BOARD_SKETCH_LINES && i < sketch_line_next; i++) {
+    unsigned k = (sketch_line_next - 1 - i) % BOARD_SKETCH_LINES;
+    if (strncmp(sketch_lines[k], prefix, n) == 0) {
+      if (at_ns) {
+        *at_ns = sketch_line_ns[k];
+      }
+      return sketch_lines[k];
+    }
+  }
+  return NULL;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file
+ * @brief Runs the sketch (src/main.cpp) on the simulated board.
+ *
+ * The sketch drives the chips through the Arduino SPI stand-in: module i of
+ * main.cpp (chip select pin 7, then 6) is attached to chips[i], whose cable
+ * is plugged into the switch.
+ */
+
+#ifndef __BOARD_SKETCH_H__
+#define __BOARD_SKETCH_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "board.h"
+#include "Arduino.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Chip select pins of the modules in main.cpp.
+ */
+#define BOARD_SKETCH_CS0 7
+#define BOARD_SKETCH_CS1 6
+
+/**
+ * @brief Resets the clock and the switch and powers @p count chips.
+ */
+void board_sketch_init(struct w5500_sim *chips, struct net_port *ports, int count);
+
+/**
+ * @brief Calls the sketch's setup().
+ */
+void board_sketch_setup(void);
+
+/**
+ * @brief Calls the sketch's loop() until @p done returns true or @p timeout_ms passes.
+ *
+ * @return true if @p done returned true.
+ */
+bool board_sketch_run(bool (*done)(void *arg), void *arg, uint32_t timeout_ms);
+
+/**
+ * @brief Calls the sketch's loop() for @p ms.
+ */
+void board_sketch_run_for(uint32_t ms);
+
+/**
+ * @brief Line printed on Serial most recently that starts with @p prefix, NULL if none.
+ *
+ * @param at_ns Receives the time the line was printed, may be NULL.
+ */
+const char *board_sketch_line(const char *prefix, uint64_t *at_ns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BOARD_SKETCH_H__
@@ -0,0 +1,957 @@
+/**
+ * @file
+ * @brief Stand-in lwIP core: pools, heap, pbufs, netif, timeouts, checksums.
+ *
+ * Memory comes from the host heap, but every allocation is charged against
+ * the configured lwIP pools and MEM_SIZE so that exhaustion happens where it
+ * would on the target. The heap is charged block sizes as lwIP's mem.c
+ * would; fragmentation is not modelled.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/def.h"
+#include "lwip/mem.h"
+#include "lwip/memp.h"
+#include "lwip/priv/memp_priv.h"
+#include "lwip/priv/tcp_priv.h"
+#include "lwip/pbuf.h"
+#include "lwip/stats.h"
+#include "lwip/netif.h"
+#include "lwip/etharp.h"
+#include "lwip/dhcp.h"
+#include "lwip/timeouts.h"
+#include "lwip/inet_chksum.h"
+#include "lwip/init.h"
+#include "lwip/sys.h"
+
+#include "host_priv.h"
+#include "sim.h"
+
+u32_t host_generation;
+
+/* Byte order */
+
+u16_t lwip_htons(u16_t n)
+{
+  return PP_HTONS(n);
+}
+
+u32_t lwip_htonl(u32_t n)
+{
+  return PP_HTONL(n);
+}
+
+/* Statistics and pools */
+
+struct stats_ lwip_stats;
+
+/* Pool descriptors generated from memp_std.h, as lwIP's memp.c does */
+#define LWIP_MEMPOOL(name, num, size, desc) \
+  static struct stats_mem memp_stats_##name; \
+  static const struct memp_desc memp_##name = {desc, &memp_stats_##name, (u16_t)LWIP_MEM_ALIGN_SIZE(size), (num)};
+#include "lwip/priv/memp_std.h"
+
+const struct memp_desc *const memp_pools[MEMP_MAX] = {
+#define LWIP_MEMPOOL(name, num, size, desc) &memp_##name,
+#include "lwip/priv/memp_std.h"
+};
+
+static void memp_reset(void)
+{
+  for (int i = 0; i < MEMP_MAX; i++) {
+    struct stats_mem *st = memp_pools[i]->stats;
+    memset(st, 0, sizeof(*st));
+    st->name = memp_pools[i]->desc;
+    st->avail = memp_pools[i]->num;
+    lwip_stats.memp[i] = st;
+  }
+}
+
+int memp_take(memp_t type)
+{
+  struct stats_mem *st = memp_pools[type]->stats;
+  if (st->used >= st->avail) {
+    st->err++;
+    return 0;
+  }
+  if (++st->used > st->max) {
+    st->max = st->used;
+  }
+  return 1;
+}
+
+void memp_give(memp_t type)
+{
+  struct stats_mem *st = memp_pools[type]->stats;
+  LWIP_ASSERT("memp_give: pool underflow", st->used > 0);
+  st->used--;
+}
+
+u16_t memp_num(memp_t type)
+{
+  return memp_pools[type]->num;
+}
+
+/* Heap */
+
+#define SIZEOF_STRUCT_MEM 8u      /**< lwIP's struct mem with MEM_ALIGNMENT 4 */
+#define MIN_SIZE 12u              /**< lwIP's MIN_SIZE */
+
+/**
+ * @brief Host header in front of each heap block.
+ */
+struct host_mem {
+  u32_t generation;               /**< host_generation at allocation */
+  mem_size_t charged;             /**< Bytes charged to the heap */
+  u8_t pad[2];
+};
+
+/**
+ * @brief Charges @p size bytes of lwIP heap, as mem_malloc() would take them.
+ */
+static mem_size_t mem_charge(mem_size_t size)
+{
+  size_t need = LWIP_MEM_ALIGN_SIZE(LWIP_MAX(size, MIN_SIZE)) + SIZEOF_STRUCT_MEM;
+  struct stats_mem *st = &lwip_stats.mem;
+  if (size == 0 || need > (size_t)(st->avail - st->used)) {
+    st->err++;
+    return 0;
+  }
+  st->used = (mem_size_t)(st->used + need);
+  if (st->used > st->max) {
+    st->max = st->used;
+  }
+  return (mem_size_t)need;
+}
+
+void *mem_malloc(mem_size_t size)
+{
+  mem_size_t charged = mem_charge(size);
+  if (charged == 0) {
+    return NULL;
+  }
+  struct host_mem *m = (struct host_mem *)malloc(sizeof(*m) + size);
+  if (m == NULL) {
+    abort();
+  }
+  m->generation = host_generation;
+  m->charged = charged;
+  return m + 1;
+}
+
+void mem_free(void *mem)
+{
+  if (mem == NULL) {
+    return;
+  }
+  struct host_mem *m = (struct host_mem *)mem - 1;
+  if (m->generation == host_generation) {
+    lwip_stats.mem.used = (mem_size_t)(lwip_stats.mem.used - m->charged);
+  }
+  free(m);
+}
+
+/* Packet buffers */
+
+#define SIZEOF_STRUCT_PBUF LWIP_MEM_ALIGN_SIZE(sizeof(struct pbuf))
+#define PBUF_POOL_BUFSIZE_ALIGNED LWIP_MEM_ALIGN_SIZE(PBUF_POOL_BUFSIZE)
+
+/**
+ * @brief Host storage of a pbuf: the pbuf, its accounting and its buffer.
+ */
+struct host_pbuf {
+  struct pbuf p;                  /**< Must be first */
+  u32_t generation;               /**< host_generation at allocation */
+  mem_size_t charged;             /**< Heap bytes of a PBUF_RAM */
+  u16_t size;                     /**< Bytes in buf */
+  u8_t buf[];                     /**< Header space and payload of RAM and POOL pbufs */
+};
+
+#define PBUF_TYPE(p) ((pbuf_type)(p)->type_internal)
+
+static struct host_pbuf *pbuf_host(const struct pbuf *p)
+{
+  return (struct host_pbuf *)p;
+}
+
+static struct pbuf *pbuf_new(pbuf_type type, u16_t size, mem_size_t charged)
+{
+  struct host_pbuf *h = (struct host_pbuf *)calloc(1, sizeof(*h) + size);
+  if (h == NULL) {
+    abort();
+  }
+  h->generation = host_generation;
+  h->charged = charged;
+  h->size = size;
+  h->p.type_internal = (u8_t)type;
+  h->p.ref = 1;
+  return &h->p;
+}
+
+struct pbuf *pbuf_alloc(pbuf_layer layer, u16_t length, pbuf_type type)
+{
+  u16_t offset = (u16_t)layer;
+  struct pbuf *p = NULL;
+
+  switch (type) {
+    case PBUF_REF:
+    case PBUF_ROM:
+      if (!memp_take(MEMP_PBUF)) {
+        return NULL;
+      }
+      p = pbuf_new(type, 0, 0);
+      p->len = p->tot_len = length;
+      return p;
+
+    case PBUF_POOL: {
+      struct pbuf *last = NULL;
+      u16_t rem = length;
+      do {
+        if (!memp_take(MEMP_PBUF_POOL)) {
+          if (p) {
+            pbuf_free(p);
+          }
+          return NULL;
+        }
+        struct pbuf *q = pbuf_new(type, PBUF_POOL_BUFSIZE_ALIGNED, 0);
+        u16_t off = (u16_t)LWIP_MEM_ALIGN_SIZE(offset);
+        q->payload = pbuf_host(q)->buf + off;
+        q->len = (u16_t)LWIP_MIN(rem, PBUF_POOL_BUFSIZE_ALIGNED - off);
+        q->tot_len = rem;
+        rem = (u16_t)(rem - q->len);
+        offset = 0;
+        if (last) {
+          last->next = q;
+        } else {
+          p = q;
+        }
+        last = q;
+      } while (rem > 0);
+      return p;
+    }
+
+    case PBUF_RAM: {
+      u16_t payload_len = (u16_t)(LWIP_MEM_ALIGN_SIZE(offset) + LWIP_MEM_ALIGN_SIZE(length));
+      mem_size_t charged = mem_charge((mem_size_t)(SIZEOF_STRUCT_PBUF + payload_len));
+      if (charged == 0) {
+        return NULL;
+      }
+      p = pbuf_new(type, payload_len, charged);
+      p->payload = pbuf_host(p)->buf + LWIP_MEM_ALIGN_SIZE(offset);
+      p->len = p->tot_len = length;
+      return p;
+    }
+  }
+  return NULL;
+}
+
+void pbuf_realloc(struct pbuf *p, u16_t new_len)
+{
+  if (new_len >= p->tot_len) {
+    return;
+  }
+
+  s32_t grow = (s32_t)new_len - p->tot_len;
+  u16_t rem = new_len;
+  struct pbuf *q = p;
+  while (rem > q->len) {
+    rem = (u16_t)(rem - q->len);
+    q->tot_len = (u16_t)(q->tot_len + grow);
+    q = q->next;
+  }
+
+  if (PBUF_TYPE(q) == PBUF_RAM && rem != q->len) {
+    /* mem_trim() of the heap block */
+    struct host_pbuf *h = pbuf_host(q);
+    mem_size_t used = (mem_size_t)((u8_t *)q->payload - h->buf + rem);
+    mem_size_t trimmed = (mem_size_t)(LWIP_MEM_ALIGN_SIZE(LWIP_MAX(SIZEOF_STRUCT_PBUF + used, MIN_SIZE)) + SIZEOF_STRUCT_MEM);
+    if (h->generation == host_generation && trimmed < h->charged) {
+      lwip_stats.mem.used = (mem_size_t)(lwip_stats.mem.used - (h->charged - trimmed));
+      h->charged = trimmed;
+    }
+  }
+  q->len = rem;
+  q->tot_len = rem;
+
+  if (q->next != NULL) {
+    pbuf_free(q->next);
+  }
+  q->next = NULL;
+}
+
+static u8_t pbuf_add_header_impl(struct pbuf *p, size_t increment, u8_t force)
+{
+  if (p == NULL || increment > 0xFFFF) {
+    return 1;
+  }
+  if (increment == 0) {
+    return 0;
+  }
+  if ((u16_t)(increment + p->tot_len) < increment) {
+    return 1;
+  }
+
+  pbuf_type type = PBUF_TYPE(p);
+  if (type == PBUF_RAM || type == PBUF_POOL) {
+    u8_t *payload = (u8_t *)p->payload - increment;
+    if (payload < pbuf_host(p)->buf) {
+      return 1;
+    }
+    p->payload = payload;
+  } else {
+    if (!force) {
+      return 1;
+    }
+    p->payload = (u8_t *)p->payload - increment;
+  }
+  p->len = (u16_t)(p->len + increment);
+  p->tot_len = (u16_t)(p->tot_len + increment);
+  return 0;
+}
+
+u8_t pbuf_add_header(struct pbuf *p, size_t header_size_increment)
+{
+  return pbuf_add_header_impl(p, header_size_increment, 0);
+}
+
+u8_t pbuf_remove_header(struct pbuf *p, size_t header_size_decrement)
+{
+  if (p == NULL || header_size_decrement > 0xFFFF) {
+    return 1;
+  }
+  if (header_size_decrement == 0) {
+    return 0;
+  }
+  if (header_size_decrement > p->len) {
+    return 1;
+  }
+  p->payload = (u8_t *)p->payload + header_size_decrement;
+  p->len = (u16_t)(p->len - header_size_decrement);
+  p->tot_len = (u16_t)(p->tot_len - header_size_decrement);
+  return 0;
+}
+
+u8_t pbuf_header(struct pbuf *p, s16_t header_size_increment)
+{
+  if (header_size_increment < 0) {
+    return pbuf_remove_header(p, (size_t)-header_size_increment);
+  }
+  return pbuf_add_header_impl(p, (size_t)header_size_increment, 1);
+}
+
+struct pbuf *pbuf_free_header(struct pbuf *q, u16_t size)
+{
+  struct pbuf *p = q;
+  u16_t free_left = size;
+  while (free_left && p) {
+    if (free_left >= p->len) {
+      struct pbuf *f = p;
+      free_left = (u16_t)(free_left - p->len);
+      p = p->next;
+      f->next = NULL;
+      pbuf_free(f);
+    } else {
+      pbuf_remove_header(p, free_left);
+      free_left = 0;
+    }
+  }
+  return p;
+}
+
+void pbuf_ref(struct pbuf *p)
+{
+  if (p != NULL) {
+    p->ref++;
+    LWIP_ASSERT("pbuf ref overflow", p->ref > 0);
+  }
+}
+
+u8_t pbuf_free(struct pbuf *p)
+{
+  u8_t count = 0;
+
+  while (p != NULL) {
+    LWIP_ASSERT("pbuf_free: p->ref > 0", p->ref > 0);
+    if (--p->ref > 0) {
+      break;
+    }
+    struct pbuf *q = p->next;
+    struct host_pbuf *h = pbuf_host(p);
+    if (h->generation == host_generation) {
+      switch (PBUF_TYPE(p)) {
+        case PBUF_POOL:
+          memp_give(MEMP_PBUF_POOL);
+          break;
+        case PBUF_ROM:
+        case PBUF_REF:
+          memp_give(MEMP_PBUF);
+          break;
+        case PBUF_RAM:
+          lwip_stats.mem.used = (mem_size_t)(lwip_stats.mem.used - h->charged);
+          break;
+      }
+    }
+    free(h);
+    count++;
+    p = q;
+  }
+  return count;
+}
+
+u16_t pbuf_clen(const struct pbuf *p)
+{
+  u16_t len = 0;
+  while (p != NULL) {
+    ++len;
+    p = p->next;
+  }
+  return len;
+}
+
+void pbuf_cat(struct pbuf *h, struct pbuf *t)
+{
+  struct pbuf *p;
+
+  LWIP_ASSERT("pbuf_cat: h != NULL && t != NULL", h != NULL && t != NULL);
+  for (p = h; p->next != NULL; p = p->next) {
+    p->tot_len = (u16_t)(p->tot_len + t->tot_len);
+  }
+  p->tot_len = (u16_t)(p->tot_len + t->tot_len);
+  p->next = t;
+}
+
+void pbuf_chain(struct pbuf *h, struct pbuf *t)
+{
+  pbuf_cat(h, t);
+  pbuf_ref(t);
+}
+
+u16_t pbuf_copy_partial(const struct pbuf *buf, void *dataptr, u16_t len, u16_t offset)
+{
+  u16_t copied = 0;
+
+  for (const struct pbuf *p = buf; len != 0 && p != NULL; p = p->next) {
+    if (offset != 0 && offset >= p->len) {
+      offset = (u16_t)(offset - p->len);
+    } else {
+      u16_t n = (u16_t)LWIP_MIN(p->len - offset, len);
+      memcpy((u8_t *)dataptr + copied, (const u8_t *)p->payload + offset, n);
+      copied = (u16_t)(copied + n);
+      len = (u16_t)(len - n);
+      offset = 0;
+    }
+  }
+  sim_cpu_bytes(copied, SIM_CPU_COPY_PS);
+  return copied;
+}
+
+err_t pbuf_take(struct pbuf *buf, const void *dataptr, u16_t len)
+{
+  u16_t copied = 0;
+
+  if (buf == NULL || dataptr == NULL || buf->tot_len < len) {
+    return ERR_ARG;
+  }
+  for (struct pbuf *p = buf; copied < len; p = p->next) {
+    u16_t n = (u16_t)LWIP_MIN(p->len, len - copied);
+    memcpy(p->payload, (const u8_t *)dataptr + copied, n);
+    copied = (u16_t)(copied + n);
+  }
+  sim_cpu_bytes(copied, SIM_CPU_COPY_PS);
+  return ERR_OK;
+}
+
+u8_t pbuf_get_at(const struct pbuf *p, u16_t offset)
+{
+  while (p != NULL && offset >= p->len) {
+    offset = (u16_t)(offset - p->len);
+    p = p->next;
+  }
+  return p != NULL ? ((const u8_t *)p->payload)[offset] : 0;
+}
+
+u16_t pbuf_memcmp(const struct pbuf *p, u16_t offset, const void *s2, u16_t n)
+{
+  if (p == NULL || (u32_t)offset + n > p->tot_len) {
+    return 0xffff;
+  }
+  for (u16_t i = 0; i < n; i++) {
+    if (pbuf_get_at(p, (u16_t)(offset + i)) != ((const u8_t *)s2)[i]) {
+      return (u16_t)(i + 1);
+    }
+  }
+  return 0;
+}
+
+u16_t pbuf_memfind(const struct pbuf *p, const void *mem, u16_t mem_len, u16_t start_offset)
+{
+  if (p == NULL || (u32_t)start_offset + mem_len > p->tot_len) {
+    return 0xffff;
+  }
+  for (u16_t i = start_offset; i <= p->tot_len - mem_len; i++) {
+    if (pbuf_memcmp(p, i, mem, mem_len) == 0) {
+      return i;
+    }
+  }
+  return 0xffff;
+}
+
+/* Network interfaces */
+
+struct netif *netif_list;
+struct netif *netif_default;
+static u8_t netif_num;
+
+const ip_addr_t ip_addr_any = IPADDR4_INIT(IPADDR_ANY);
+const ip_addr_t ip_addr_broadcast = IPADDR4_INIT(IPADDR_BROADCAST);
+
+/**
+ * @brief Announces the address with a gratuitous ARP, as netif_issue_reports().
+ */
+static void netif_issue_reports(struct netif *netif)
+{
+  if (netif_is_up(netif) && netif_is_link_up(netif) && !ip4_addr_isany_val(*netif_ip4_addr(netif)) &&
+      (netif->flags & NETIF_FLAG_ETHARP)) {
+    etharp_gratuitous(netif);
+  }
+}
+
+struct netif *netif_add(struct netif *netif, const ip4_addr_t *ipaddr, const ip4_addr_t *netmask,
+                        const ip4_addr_t *gw, void *state, netif_init_fn init, netif_input_fn input)
+{
+  ip_addr_set_zero(&netif->ip_addr);
+  ip_addr_set_zero(&netif->netmask);
+  ip_addr_set_zero(&netif->gw);
+  netif->output = NULL;
+  netif->flags = 0;
+  memset(netif->client_data, 0, sizeof(netif->client_data));
+#if LWIP_NETIF_STATUS_CALLBACK
+  netif->status_callback = NULL;
+#endif
+#if LWIP_NETIF_LINK_CALLBACK
+  netif->link_callback = NULL;
+#endif
+#if LWIP_NETIF_HOSTNAME
+  netif->hostname = NULL;
+#endif
+  netif->mtu = 0;
+  netif->state = state;
+  netif->num = netif_num++;
+  netif->input = input;
+
+  netif_set_addr(netif, ipaddr, netmask, gw);
+
+  if (init(netif) != ERR_OK) {
+    return NULL;
+  }
+
+  netif->next = netif_list;
+  netif_list = netif;
+
+  LWIP_DEBUGF(NETIF_DEBUG, ("netif: added interface %c%c IP addr %s\n",
+                            netif->name[0], netif->name[1], ip4addr_ntoa(netif_ip4_addr(netif))));
+  return netif;
+}
+
+void netif_remove(struct netif *netif)
+{
+  if (netif == NULL) {
+    return;
+  }
+  if (!ip4_addr_isany_val(*netif_ip4_addr(netif))) {
+    tcp_netif_ip_addr_changed(netif_ip4_addr(netif), NULL);
+  }
+  if (netif_is_up(netif)) {
+    netif_set_down(netif);
+  }
+  if (netif_default == netif) {
+    netif_set_default(NULL);
+  }
+  for (struct netif **pp = &netif_list; *pp != NULL; pp = &(*pp)->next) {
+    if (*pp == netif) {
+      *pp = netif->next;
+      break;
+    }
+  }
+}
+
+void netif_set_ipaddr(struct netif *netif, const ip4_addr_t *ipaddr)
+{
+  ip4_addr_t new_addr;
+  ip4_addr_set(&new_addr, ipaddr);
+  if (ip4_addr_cmp(&new_addr, netif_ip4_addr(netif))) {
+    return;
+  }
+
+  tcp_netif_ip_addr_changed(netif_ip4_addr(netif), &new_addr);
+  ip4_addr_copy(netif->ip_addr, new_addr);
+  netif_issue_reports(netif);
+
+  LWIP_DEBUGF(NETIF_DEBUG, ("netif: IP address of interface %c%c set to %s\n",
+                            netif->name[0], netif->name[1], ip4addr_ntoa(netif_ip4_addr(netif))));
+}
+
+void netif_set_addr(struct netif *netif, const ip4_addr_t *ipaddr, const ip4_addr_t *netmask,
+                    const ip4_addr_t *gw)
+{
+  if (ip4_addr_isany(ipaddr)) {
+    /* when removing an address, we have to remove it *before* changing netmask/gw
+       to ensure that tcp RST segment can be sent correctly */
+    netif_set_ipaddr(netif, ipaddr);
+    ip4_addr_set(&netif->netmask, netmask);
+    ip4_addr_set(&netif->gw, gw);
+  } else {
+    ip4_addr_set(&netif->netmask, netmask);
+    ip4_addr_set(&netif->gw, gw);
+    netif_set_ipaddr(netif, ipaddr);
+  }
+}
+
+void netif_set_default(struct netif *netif)
+{
+  netif_default = netif;
+}
+
+void netif_set_up(struct netif *netif)
+{
+  if (!(netif->flags & NETIF_FLAG_UP)) {
+    netif->flags |= NETIF_FLAG_UP;
+    netif_issue_reports(netif);
+  }
+}
+
+void netif_set_down(struct netif *netif)
+{
+  if (netif->flags & NETIF_FLAG_UP) {
+    netif->flags &= (u8_t)~NETIF_FLAG_UP;
+    if (netif->flags & NETIF_FLAG_ETHARP) {
+      etharp_cleanup_netif(netif);
+    }
+  }
+}
+
+void netif_set_link_up(struct netif *netif)
+{
+  if (!(netif->flags & NETIF_FLAG_LINK_UP)) {
+    netif->flags |= NETIF_FLAG_LINK_UP;
+#if LWIP_DHCP
+    dhcp_network_changed(netif);
+#endif
+    netif_issue_reports(netif);
+#if LWIP_NETIF_LINK_CALLBACK
+    if (netif->link_callback) {
+      netif->link_callback(netif);
+    }
+#endif
+  }
+}
+
+void netif_set_link_down(struct netif *netif)
+{
+  if (netif->flags & NETIF_FLAG_LINK_UP) {
+    netif->flags &= (u8_t)~NETIF_FLAG_LINK_UP;
+#if LWIP_NETIF_LINK_CALLBACK
+    if (netif->link_callback) {
+      netif->link_callback(netif);
+    }
+#endif
+  }
+}
+
+#if LWIP_NETIF_LINK_CALLBACK
+void netif_set_link_callback(struct netif *netif, netif_status_callback_fn link_callback)
+{
+  if (netif) {
+    netif->link_callback = link_callback;
+  }
+}
+#endif
+
+/* IPv4 addresses */
+
+u8_t ip4_addr_isbroadcast_u32(u32_t addr, const struct netif *netif)
+{
+  ip4_addr_t ipaddr;
+  ip4_addr_set_u32(&ipaddr, addr);
+
+  if ((~addr == IPADDR_ANY) || (addr == IPADDR_ANY)) {
+    return 1;
+  } else if ((netif->flags & NETIF_FLAG_BROADCAST) == 0) {
+    return 0;
+  } else if (addr == ip4_addr_get_u32(netif_ip4_addr(netif))) {
+    return 0;
+  } else if (ip4_addr_netcmp(&ipaddr, netif_ip4_addr(netif), netif_ip4_netmask(netif)) &&
+             ((addr & ~ip4_addr_get_u32(netif_ip4_netmask(netif))) ==
+              (IPADDR_BROADCAST & ~ip4_addr_get_u32(netif_ip4_netmask(netif))))) {
+    return 1;
+  }
+  return 0;
+}
+
+char *ip4addr_ntoa(const ip4_addr_t *addr)
+{
+  static char str[16];
+  const u8_t *b = (const u8_t *)&addr->addr;
+  snprintf(str, sizeof(str), "%u.%u.%u.%u", b[0], b[1], b[2], b[3]);
+  return str;
+}
+
+struct netif *ip4_route(const ip4_addr_t *dest)
+{
+  struct netif *netif;
+
+  NETIF_FOREACH(netif) {
+    if (netif_is_up(netif) && netif_is_link_up(netif) && !ip4_addr_isany_val(*netif_ip4_addr(netif))) {
+      if (ip4_addr_netcmp(dest, netif_ip4_addr(netif), netif_ip4_netmask(netif))) {
+        return netif;
+      }
+    }
+  }
+  if (netif_default == NULL || !netif_is_up(netif_default) || !netif_is_link_up(netif_default) ||
+      ip4_addr_isany_val(*netif_ip4_addr(netif_default))) {
+    return NULL;
+  }
+  return netif_default;
+}
+
+/* Timeouts */
+
+/**
+ * @brief Timer of lwIP's lwip_cyclic_timers[].
+ */
+struct lwip_cyclic_timer {
+  u32_t interval_ms;
+  void (*handler)(void);
+};
+
+static const struct lwip_cyclic_timer lwip_cyclic_timers[] = {
+#if LWIP_TCP
+  /* started on demand by tcp_timer_needed() */
+  {TCP_TMR_INTERVAL, tcp_tmr},
+#endif
+#if LWIP_ARP
+  {ARP_TMR_INTERVAL, etharp_tmr},
+#endif
+#if LWIP_DHCP
+  {DHCP_COARSE_TIMER_MSECS, dhcp_coarse_tmr},
+  {DHCP_FINE_TIMER_MSECS, dhcp_fine_tmr},
+#endif
+};
+
+static struct sys_timeo *next_timeout;
+static u32_t current_timeout_due_time;
+static int tcpip_tcp_timer_active;
+
+#define TIME_LESS_THAN(t, compare_to) ((((u32_t)((t)-(compare_to))) & 0x80000000u) != 0)
+
+static void sys_timeout_abs(u32_t abs_time, sys_timeout_handler handler, void *arg)
+{
+  if (!memp_take(MEMP_SYS_TIMEOUT)) {
+    LWIP_ASSERT("sys_timeout: timeout != NULL, pool MEMP_SYS_TIMEOUT is empty", 0);
+    return;
+  }
+  struct sys_timeo *timeout = (struct sys_timeo *)malloc(sizeof(*timeout));
+  timeout->next = NULL;
+  timeout->h = handler;
+  timeout->arg = arg;
+  timeout->time = abs_time;
+
+  if (next_timeout == NULL || TIME_LESS_THAN(timeout->time, next_timeout->time)) {
+    timeout->next = next_timeout;
+    next_timeout = timeout;
+    return;
+  }
+  struct sys_timeo *t = next_timeout;
+  while (t->next != NULL && !TIME_LESS_THAN(timeout->time, t->next->time)) {
+    t = t->next;
+  }
+  timeout->next = t->next;
+  t->next = timeout;
+}
+
+static void lwip_cyclic_timer(void *arg)
+{
+  const struct lwip_cyclic_timer *cyclic = (const struct lwip_cyclic_timer *)arg;
+  cyclic->handler();
+
+  u32_t now = sys_now();
+  u32_t next_timeout_time = current_timeout_due_time + cyclic->interval_ms;
+  if (TIME_LESS_THAN(next_timeout_time, now)) {
+    /* timer would immediately expire again -> "overload" -> restart without any correction */
+    sys_timeout_abs(now + cyclic->interval_ms, lwip_cyclic_timer, arg);
+  } else {
+    sys_timeout_abs(next_timeout_time, lwip_cyclic_timer, arg);
+  }
+}
+
+void sys_timeout(u32_t msecs, sys_timeout_handler handler, void *arg)
+{
+  sys_timeout_abs(sys_now() + msecs, handler, arg);
+}
+
+void sys_untimeout(sys_timeout_handler handler, void *arg)
+{
+  for (struct sys_timeo *prev = NULL, *t = next_timeout; t != NULL; prev = t, t = t->next) {
+    if (t->h == handler && t->arg == arg) {
+      if (prev == NULL) {
+        next_timeout = t->next;
+      } else {
+        prev->next = t->next;
+      }
+      memp_give(MEMP_SYS_TIMEOUT);
+      free(t);
+      return;
+    }
+  }
+}
+
+void sys_check_timeouts(void)
+{
+  for (;;) {
+    struct sys_timeo *t = next_timeout;
+    if (t == NULL || TIME_LESS_THAN(sys_now(), t->time)) {
+      return;
+    }
+    next_timeout = t->next;
+    sys_timeout_handler handler = t->h;
+    void *arg = t->arg;
+    current_timeout_due_time = t->time;
+    memp_give(MEMP_SYS_TIMEOUT);
+    free(t);
+    sim_advance(SIM_CPU_TIMER_NS);
+    handler(arg);
+  }
+}
+
+u32_t sys_timeouts_sleeptime(void)
+{
+  if (next_timeout == NULL) {
+    return SYS_TIMEOUTS_SLEEPTIME_INFINITE;
+  }
+  u32_t now = sys_now();
+  if (TIME_LESS_THAN(next_timeout->time, now)) {
+    return 0;
+  }
+  return next_timeout->time - now;
+}
+
+/**
+ * @brief Runs tcp_tmr() while there are PCBs to serve, as lwIP's tcpip_tcp_timer().
+ */
+static void tcpip_tcp_timer(void *arg)
+{
+  LWIP_UNUSED_ARG(arg);
+  tcp_tmr();
+  if (tcp_timer_wanted()) {
+    sys_timeout(TCP_TMR_INTERVAL, tcpip_tcp_timer, NULL);
+  } else {
+    tcpip_tcp_timer_active = 0;
+  }
+}
+
+void tcp_timer_needed(void)
+{
+  if (!tcpip_tcp_timer_active && tcp_timer_wanted()) {
+    tcpip_tcp_timer_active = 1;
+    sys_timeout(TCP_TMR_INTERVAL, tcpip_tcp_timer, NULL);
+  }
+}
+
+void sys_timeouts_init(void)
+{
+  while (next_timeout != NULL) {
+    struct sys_timeo *t = next_timeout;
+    next_timeout = t->next;
+    free(t);
+  }
+  tcpip_tcp_timer_active = 0;
+  for (size_t i = LWIP_TCP ? 1 : 0; i < LWIP_ARRAYSIZE(lwip_cyclic_timers); i++) {
+    sys_timeout(lwip_cyclic_timers[i].interval_ms, lwip_cyclic_timer, (void *)&lwip_cyclic_timers[i]);
+  }
+}
+
+/* Checksums */
+
+/**
+ * @brief Ones' complement sum of a buffer, folded to 16 bits in network order.
+ */
+static u32_t chksum_add(u32_t acc, const void *dataptr, u16_t len, int *odd)
+{
+  const u8_t *b = (const u8_t *)dataptr;
+  for (u16_t i = 0; i < len; i++) {
+    acc += *odd ? b[i] : (u32_t)b[i] << 8;
+    *odd ^= 1;
+  }
+  return acc;
+}
+
+static u16_t chksum_fold(u32_t acc)
+{
+  while (acc >> 16) {
+    acc = (acc & 0xffffu) + (acc >> 16);
+  }
+  return lwip_htons((u16_t)~acc);
+}
+
+u16_t inet_chksum(const void *dataptr, u16_t len)
+{
+  int odd = 0;
+  sim_cpu_bytes(len, SIM_CPU_CHKSUM_PS);
+  return chksum_fold(chksum_add(0, dataptr, len, &odd));
+}
+
+u16_t inet_chksum_pbuf(struct pbuf *p)
+{
+  u32_t acc = 0;
+  int odd = 0;
+  sim_cpu_bytes(p->tot_len, SIM_CPU_CHKSUM_PS);
+  for (struct pbuf *q = p; q != NULL; q = q->next) {
+    acc = chksum_add(acc, q->payload, q->len, &odd);
+  }
+  return chksum_fold(acc);
+}
+
+u16_t inet_chksum_pseudo(struct pbuf *p, u8_t proto, u16_t proto_len,
+                         const ip4_addr_t *src, const ip4_addr_t *dest)
+{
+  u32_t acc = 0;
+  int odd = 0;
+  u8_t pseudo[12];
+
+  memcpy(&pseudo[0], &src->addr, 4);
+  memcpy(&pseudo[4], &dest->addr, 4);
+  pseudo[8] = 0;
+  pseudo[9] = proto;
+  pseudo[10] = (u8_t)(proto_len >> 8);
+  pseudo[11] = (u8_t)proto_len;
+  acc = chksum_add(acc, pseudo, sizeof(pseudo), &odd);
+  sim_cpu_bytes(p->tot_len, SIM_CPU_CHKSUM_PS);
+  for (struct pbuf *q = p; q != NULL; q = q->next) {
+    acc = chksum_add(acc, q->payload, q->len, &odd);
+  }
+  return chksum_fold(acc);
+}
+
+/* Initialization */
+
+void lwip_init(void)
+{
+  host_generation++;
+  memset(&lwip_stats, 0, sizeof(lwip_stats));
+  lwip_stats.mem.name = "HEAP";
+  lwip_stats.mem.avail = MEM_SIZE;
+  memp_reset();
+
+  netif_list = NULL;
+  netif_default = NULL;
+  netif_num = 0;
+
+  etharp_reset();
+  ip4_reset();
+  tcp_reset();
+  sys_timeouts_init();
+}
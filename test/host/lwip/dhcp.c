@@ -0,0 +1,649 @@
+/**
+ * @file
+ * @brief Stand-in lwIP DHCP client.
+ *
+ * Same state machine and timing as lwIP 2.1.2: DISCOVER/REQUEST with
+ * exponential backoff, ARP probe of the offered address (DHCP_CHECKING,
+ * two probes 500 ms apart), INIT-REBOOT on link up, renew and rebind on T1
+ * and T2. Options are limited to those lwIP parses.
+ */
+
+#include <string.h>
+
+#include "lwip/opt.h"
+
+#if LWIP_DHCP
+
+#include "lwip/def.h"
+#include "lwip/mem.h"
+#include "lwip/pbuf.h"
+#include "lwip/netif.h"
+#include "lwip/dhcp.h"
+#include "lwip/etharp.h"
+#include "lwip/prot/dhcp.h"
+
+#include "host_priv.h"
+
+#define DHCP_MAX_MSG_LEN 576
+#define DHCP_MAX_TRIES_REBOOT 2
+#define DHCP_DECLINE_BACKOFF_MS 10000
+
+static u32_t xid;
+static u8_t xid_initialised;
+
+static void dhcp_set_state(struct dhcp *dhcp, u8_t new_state)
+{
+  if (new_state != dhcp->state) {
+    dhcp->state = new_state;
+    dhcp->tries = 0;
+    dhcp->request_timeout = 0;
+  }
+}
+
+static void dhcp_set_timeout(struct dhcp *dhcp, u32_t msecs)
+{
+  dhcp->request_timeout = (u16_t)((msecs + DHCP_FINE_TIMER_MSECS - 1) / DHCP_FINE_TIMER_MSECS);
+}
+
+/**
+ * @brief Outgoing message being built.
+ */
+struct dhcp_out {
+  struct pbuf *p;
+  struct dhcp_msg *msg;
+  u16_t options_len;
+};
+
+static int dhcp_create_msg(struct netif *netif, struct dhcp *dhcp, u8_t message_type, struct dhcp_out *out)
+{
+  out->p = pbuf_alloc(PBUF_TRANSPORT, sizeof(struct dhcp_msg), PBUF_RAM);
+  if (out->p == NULL) {
+    return 0;
+  }
+  if (message_type != DHCP_REQUEST || dhcp->state == DHCP_STATE_REBOOTING) {
+    /* reuse transaction identifier in retransmissions */
+    if (dhcp->tries == 0) {
+      if (!xid_initialised) {
+        xid = LWIP_RAND();
+        xid_initialised = 1;
+      }
+      xid++;
+    }
+    dhcp->xid = xid;
+  }
+
+  struct dhcp_msg *msg = (struct dhcp_msg *)out->p->payload;
+  memset(msg, 0, sizeof(*msg));
+  msg->op = DHCP_BOOTREQUEST;
+  msg->htype = DHCP_HTYPE_ETH;
+  msg->hlen = netif->hwaddr_len;
+  msg->xid = lwip_htonl(dhcp->xid);
+  if (message_type == DHCP_INFORM || message_type == DHCP_DECLINE || message_type == DHCP_RELEASE ||
+      (message_type == DHCP_REQUEST &&
+       (dhcp->state == DHCP_STATE_RENEWING || dhcp->state == DHCP_STATE_REBINDING))) {
+    ip4_addr_copy(msg->ciaddr, *netif_ip4_addr(netif));
+  }
+  memcpy(msg->chaddr, netif->hwaddr, netif->hwaddr_len);
+  msg->cookie = PP_HTONL(DHCP_MAGIC_COOKIE);
+
+  out->msg = msg;
+  out->options_len = 0;
+  msg->options[out->options_len++] = DHCP_OPTION_MESSAGE_TYPE;
+  msg->options[out->options_len++] = 1;
+  msg->options[out->options_len++] = message_type;
+  return 1;
+}
+
+static void dhcp_option(struct dhcp_out *out, u8_t code, const void *data, u8_t len)
+{
+  LWIP_ASSERT("dhcp_option: options overflow", out->options_len + 2U + len < DHCP_OPTIONS_LEN);
+  out->msg->options[out->options_len++] = code;
+  out->msg->options[out->options_len++] = len;
+  memcpy(&out->msg->options[out->options_len], data, len);
+  out->options_len = (u16_t)(out->options_len + len);
+}
+
+static void dhcp_option_common(struct netif *netif, struct dhcp_out *out)
+{
+  static const u8_t params[] = {DHCP_OPTION_SUBNET_MASK, DHCP_OPTION_ROUTER, DHCP_OPTION_BROADCAST};
+  u8_t max_size[2] = {(u8_t)(DHCP_MAX_MSG_LEN >> 8), (u8_t)DHCP_MAX_MSG_LEN};
+
+  dhcp_option(out, DHCP_OPTION_MAX_MSG_SIZE, max_size, sizeof(max_size));
+  dhcp_option(out, DHCP_OPTION_PARAMETER_REQUEST_LIST, params, sizeof(params));
+#if LWIP_NETIF_HOSTNAME
+  if (netif->hostname != NULL) {
+    dhcp_option(out, DHCP_OPTION_HOSTNAME, netif->hostname, (u8_t)strlen(netif->hostname));
+  }
+#else
+  LWIP_UNUSED_ARG(netif);
+#endif
+}
+
+static err_t dhcp_send(struct netif *netif, struct dhcp_out *out, const ip4_addr_t *dest)
+{
+  out->msg->options[out->options_len++] = DHCP_OPTION_END;
+  /* lwIP pads to the minimum message length */
+  while (out->options_len < DHCP_MIN_OPTIONS_LEN) {
+    out->msg->options[out->options_len++] = 0;
+  }
+  pbuf_realloc(out->p, (u16_t)(sizeof(struct dhcp_msg) - DHCP_OPTIONS_LEN + out->options_len));
+
+  const ip4_addr_t *src = IP4_ADDR_ANY4;
+  if (dhcp_supplied_address(netif)) {
+    src = netif_ip4_addr(netif);
+  }
+  err_t err = udp_sendto_if_raw(netif, out->p, src, DHCP_CLIENT_PORT, dest, DHCP_SERVER_PORT);
+  pbuf_free(out->p);
+  return err;
+}
+
+static u32_t dhcp_backoff_ms(struct dhcp *dhcp)
+{
+  return (dhcp->tries < 6 ? (1UL << dhcp->tries) : 60) * 1000UL;
+}
+
+static void dhcp_tries_inc(struct dhcp *dhcp)
+{
+  if (dhcp->tries < 255) {
+    dhcp->tries++;
+  }
+}
+
+static err_t dhcp_discover(struct netif *netif)
+{
+  struct dhcp *dhcp = netif_dhcp_data(netif);
+  struct dhcp_out out;
+
+  ip4_addr_set_any(&dhcp->offered_ip_addr);
+  dhcp_set_state(dhcp, DHCP_STATE_SELECTING);
+  err_t result = ERR_MEM;
+  if (dhcp_create_msg(netif, dhcp, DHCP_DISCOVER, &out)) {
+    dhcp_option_common(netif, &out);
+    LWIP_DEBUGF(DHCP_DEBUG | LWIP_DBG_TRACE, ("dhcp_discover: sending DHCP_DISCOVER\n"));
+    result = dhcp_send(netif, &out, IP4_ADDR_BROADCAST);
+  }
+  dhcp_tries_inc(dhcp);
+  dhcp_set_timeout(dhcp, dhcp_backoff_ms(dhcp));
+  return result;
+}
+
+static err_t dhcp_select(struct netif *netif)
+{
+  struct dhcp *dhcp = netif_dhcp_data(netif);
+  struct dhcp_out out;
+
+  dhcp_set_state(dhcp, DHCP_STATE_REQUESTING);
+  err_t result = ERR_MEM;
+  if (dhcp_create_msg(netif, dhcp, DHCP_REQUEST, &out)) {
+    dhcp_option_common(netif, &out);
+    dhcp_option(&out, DHCP_OPTION_REQUESTED_IP, &dhcp->offered_ip_addr.addr, 4);
+    dhcp_option(&out, DHCP_OPTION_SERVER_ID, &dhcp->server_ip_addr.addr, 4);
+    LWIP_DEBUGF(DHCP_DEBUG | LWIP_DBG_TRACE, ("dhcp_select: sending DHCP_REQUEST\n"));
+    result = dhcp_send(netif, &out, IP4_ADDR_BROADCAST);
+  }
+  dhcp_tries_inc(dhcp);
+  dhcp_set_timeout(dhcp, dhcp_backoff_ms(dhcp));
+  return result;
+}
+
+static err_t dhcp_reboot(struct netif *netif)
+{
+  struct dhcp *dhcp = netif_dhcp_data(netif);
+  struct dhcp_out out;
+
+  dhcp_set_state(dhcp, DHCP_STATE_REBOOTING);
+  err_t result = ERR_MEM;
+  if (dhcp_create_msg(netif, dhcp, DHCP_REQUEST, &out)) {
+    dhcp_option_common(netif, &out);
+    dhcp_option(&out, DHCP_OPTION_REQUESTED_IP, &dhcp->offered_ip_addr.addr, 4);
+    LWIP_DEBUGF(DHCP_DEBUG | LWIP_DBG_TRACE, ("dhcp_reboot: sending DHCP_REQUEST for %s\n",
+                                              ip4addr_ntoa(&dhcp->offered_ip_addr)));
+    result = dhcp_send(netif, &out, IP4_ADDR_BROADCAST);
+  }
+  dhcp_tries_inc(dhcp);
+  dhcp_set_timeout(dhcp, dhcp->tries < 10 ? dhcp->tries * 1000UL : 10000UL);
+  return result;
+}
+
+static void dhcp_check(struct netif *netif)
+{
+  struct dhcp *dhcp = netif_dhcp_data(netif);
+
+  dhcp_set_state(dhcp, DHCP_STATE_CHECKING);
+  etharp_query(netif, &dhcp->offered_ip_addr, NULL);
+  dhcp_tries_inc(dhcp);
+  dhcp_set_timeout(dhcp, 500);
+}
+
+static void dhcp_decline(struct netif *netif)
+{
+  struct dhcp *dhcp = netif_dhcp_data(netif);
+  struct dhcp_out out;
+
+  dhcp_set_state(dhcp, DHCP_STATE_BACKING_OFF);
+  if (dhcp_create_msg(netif, dhcp, DHCP_DECLINE, &out)) {
+    dhcp_option(&out, DHCP_OPTION_REQUESTED_IP, &dhcp->offered_ip_addr.addr, 4);
+    dhcp_send(netif, &out, IP4_ADDR_BROADCAST);
+  }
+  dhcp_tries_inc(dhcp);
+  dhcp_set_timeout(dhcp, DHCP_DECLINE_BACKOFF_MS);
+}
+
+static u16_t dhcp_coarse_ticks(u32_t secs)
+{
+  u32_t ticks = (secs + DHCP_COARSE_TIMER_SECS / 2) / DHCP_COARSE_TIMER_SECS;
+  return (u16_t)LWIP_MIN(LWIP_MAX(ticks, 1), 0xffff);
+}
+
+static void dhcp_bind(struct netif *netif)
+{
+  struct dhcp *dhcp = netif_dhcp_data(netif);
+
+  dhcp->lease_used = 0;
+  dhcp->t0_timeout = dhcp->offered_t0_lease != 0xffffffffUL ? dhcp_coarse_ticks(dhcp->offered_t0_lease) : 0;
+  dhcp->t1_timeout = dhcp_coarse_ticks(dhcp->offered_t1_renew != 0 ? dhcp->offered_t1_renew : dhcp->offered_t0_lease / 2);
+  dhcp->t2_timeout = dhcp_coarse_ticks(dhcp->offered_t2_rebind != 0 ? dhcp->offered_t2_rebind
+                                                                     : dhcp->offered_t0_lease / 8 * 7);
+  dhcp->t1_renew_time = dhcp->t1_timeout;
+  dhcp->t2_rebind_time = dhcp->t2_timeout;
+
+  ip4_addr_t sn_mask = dhcp->offered_sn_mask;
+  if (!dhcp->subnet_mask_given) {
+    IP4_ADDR(&sn_mask, 255, 255, 255, 0);
+  }
+
+  LWIP_DEBUGF(DHCP_DEBUG | LWIP_DBG_STATE, ("dhcp_bind: IP: %s\n", ip4addr_ntoa(&dhcp->offered_ip_addr)));
+  dhcp_set_state(dhcp, DHCP_STATE_BOUND);
+  netif_set_addr(netif, &dhcp->offered_ip_addr, &sn_mask, &dhcp->offered_gw_addr);
+}
+
+static err_t dhcp_renew_rebind(struct netif *netif, u8_t state, const ip4_addr_t *dest)
+{
+  struct dhcp *dhcp = netif_dhcp_data(netif);
+  struct dhcp_out out;
+
+  dhcp_set_state(dhcp, state);
+  err_t result = ERR_MEM;
+  if (dhcp_create_msg(netif, dhcp, DHCP_REQUEST, &out)) {
+    dhcp_option_common(netif, &out);
+    result = dhcp_send(netif, &out, dest);
+  }
+  dhcp_tries_inc(dhcp);
+  dhcp_set_timeout(dhcp, dhcp->tries < 10 ? dhcp->tries * 2000UL : 20000UL);
+  return result;
+}
+
+err_t dhcp_renew(struct netif *netif)
+{
+  struct dhcp *dhcp = netif_dhcp_data(netif);
+  return dhcp_renew_rebind(netif, DHCP_STATE_RENEWING, &dhcp->server_ip_addr);
+}
+
+static void dhcp_rebind(struct netif *netif)
+{
+  dhcp_renew_rebind(netif, DHCP_STATE_REBINDING, IP4_ADDR_BROADCAST);
+}
+
+err_t dhcp_start(struct netif *netif)
+{
+  struct dhcp *dhcp = netif_dhcp_data(netif);
+
+  if (netif->mtu < DHCP_MAX_MSG_LEN) {
+    return ERR_MEM;
+  }
+  if (dhcp == NULL) {
+    dhcp = (struct dhcp *)mem_malloc(sizeof(struct dhcp));
+    if (dhcp == NULL) {
+      return ERR_MEM;
+    }
+    netif_set_client_data(netif, LWIP_NETIF_CLIENT_DATA_INDEX_DHCP, dhcp);
+  }
+  memset(dhcp, 0, sizeof(struct dhcp));
+  dhcp->pcb_allocated = 1;
+
+  if (!netif_is_link_up(netif)) {
+    /* set state INIT and wait for dhcp_network_changed() to call dhcp_discover() */
+    dhcp_set_state(dhcp, DHCP_STATE_INIT);
+    return ERR_OK;
+  }
+  if (dhcp_discover(netif) != ERR_OK) {
+    dhcp_release_and_stop(netif);
+    return ERR_MEM;
+  }
+  return ERR_OK;
+}
+
+void dhcp_network_changed(struct netif *netif)
+{
+  struct dhcp *dhcp = netif_dhcp_data(netif);
+
+  if (!dhcp) {
+    return;
+  }
+  switch (dhcp->state) {
+    case DHCP_STATE_REBINDING:
+    case DHCP_STATE_RENEWING:
+    case DHCP_STATE_BOUND:
+    case DHCP_STATE_REBOOTING:
+      dhcp->tries = 0;
+      dhcp_reboot(netif);
+      break;
+    case DHCP_STATE_OFF:
+      break;
+    default:
+      dhcp->tries = 0;
+      dhcp_discover(netif);
+      break;
+  }
+}
+
+#if DHCP_DOES_ARP_CHECK
+void dhcp_arp_reply(struct netif *netif, const ip4_addr_t *addr)
+{
+  struct dhcp *dhcp = netif_dhcp_data(netif);
+
+  if (dhcp != NULL && dhcp->state == DHCP_STATE_CHECKING && ip4_addr_cmp(addr, &dhcp->offered_ip_addr)) {
+    LWIP_DEBUGF(DHCP_DEBUG | LWIP_DBG_STATE, ("dhcp_arp_reply: arp reply matched with offered address, declining\n"));
+    dhcp_decline(netif);
+  }
+}
+#endif
+
+u8_t dhcp_supplied_address(const struct netif *netif)
+{
+  struct dhcp *dhcp = netif != NULL ? netif_dhcp_data(netif) : NULL;
+  return dhcp != NULL && (dhcp->state == DHCP_STATE_BOUND || dhcp->state == DHCP_STATE_RENEWING ||
+                          dhcp->state == DHCP_STATE_REBINDING);
+}
+
+void dhcp_release_and_stop(struct netif *netif)
+{
+  struct dhcp *dhcp = netif_dhcp_data(netif);
+
+  if (dhcp == NULL || dhcp->state == DHCP_STATE_OFF) {
+    return;
+  }
+  u8_t bound = dhcp_supplied_address(netif);
+  ip4_addr_t server_ip_addr = dhcp->server_ip_addr;
+
+  ip4_addr_set_zero(&dhcp->server_ip_addr);
+  ip4_addr_set_zero(&dhcp->offered_ip_addr);
+  ip4_addr_set_zero(&dhcp->offered_sn_mask);
+  ip4_addr_set_zero(&dhcp->offered_gw_addr);
+  dhcp->offered_t0_lease = dhcp->offered_t1_renew = dhcp->offered_t2_rebind = 0;
+  dhcp->t1_renew_time = dhcp->t2_rebind_time = dhcp->lease_used = dhcp->t0_timeout = 0;
+
+  if (bound) {
+    struct dhcp_out out;
+    if (dhcp_create_msg(netif, dhcp, DHCP_RELEASE, &out)) {
+      dhcp_option(&out, DHCP_OPTION_SERVER_ID, &server_ip_addr.addr, 4);
+      dhcp_send(netif, &out, &server_ip_addr);
+    }
+    netif_set_addr(netif, IP4_ADDR_ANY4, IP4_ADDR_ANY4, IP4_ADDR_ANY4);
+  }
+  dhcp_set_state(dhcp, DHCP_STATE_OFF);
+  dhcp->pcb_allocated = 0;
+}
+
+err_t dhcp_release(struct netif *netif)
+{
+  dhcp_release_and_stop(netif);
+  return ERR_OK;
+}
+
+void dhcp_stop(struct netif *netif)
+{
+  dhcp_release_and_stop(netif);
+}
+
+void dhcp_cleanup(struct netif *netif)
+{
+  dhcp_stop(netif);
+  mem_free(netif_dhcp_data(netif));
+  netif_set_client_data(netif, LWIP_NETIF_CLIENT_DATA_INDEX_DHCP, NULL);
+}
+
+static void dhcp_timeout(struct netif *netif)
+{
+  struct dhcp *dhcp = netif_dhcp_data(netif);
+
+  switch (dhcp->state) {
+    case DHCP_STATE_BACKING_OFF:
+    case DHCP_STATE_SELECTING:
+      dhcp_discover(netif);
+      break;
+    case DHCP_STATE_REQUESTING:
+      if (dhcp->tries <= 5) {
+        dhcp_select(netif);
+      } else {
+        dhcp_release_and_stop(netif);
+        dhcp_start(netif);
+      }
+      break;
+    case DHCP_STATE_CHECKING:
+      if (dhcp->tries <= 1) {
+        dhcp_check(netif);
+      } else {
+        dhcp_bind(netif);
+      }
+      break;
+    case DHCP_STATE_REBOOTING:
+      if (dhcp->tries < DHCP_MAX_TRIES_REBOOT) {
+        dhcp_reboot(netif);
+      } else {
+        dhcp_discover(netif);
+      }
+      break;
+    case DHCP_STATE_RENEWING:
+      dhcp_renew(netif);
+      break;
+    case DHCP_STATE_REBINDING:
+      dhcp_rebind(netif);
+      break;
+    default:
+      break;
+  }
+}
+
+void dhcp_fine_tmr(void)
+{
+  struct netif *netif;
+
+  NETIF_FOREACH(netif) {
+    struct dhcp *dhcp = netif_dhcp_data(netif);
+    if (dhcp != NULL && dhcp->request_timeout > 1) {
+      dhcp->request_timeout--;
+    } else if (dhcp != NULL && dhcp->request_timeout == 1) {
+      dhcp->request_timeout--;
+      dhcp_timeout(netif);
+    }
+  }
+}
+
+void dhcp_coarse_tmr(void)
+{
+  struct netif *netif;
+
+  NETIF_FOREACH(netif) {
+    struct dhcp *dhcp = netif_dhcp_data(netif);
+    if (dhcp == NULL || dhcp->state == DHCP_STATE_OFF) {
+      continue;
+    }
+    if (dhcp->t0_timeout && (++dhcp->lease_used == dhcp->t0_timeout)) {
+      /* lease expired */
+      dhcp_release_and_stop(netif);
+      dhcp_start(netif);
+    } else if (dhcp->t2_rebind_time && (dhcp->t2_rebind_time-- == 1)) {
+      if (dhcp->state == DHCP_STATE_BOUND || dhcp->state == DHCP_STATE_RENEWING) {
+        dhcp_rebind(netif);
+      }
+    } else if (dhcp->t1_renew_time && (dhcp->t1_renew_time-- == 1)) {
+      if (dhcp->state == DHCP_STATE_BOUND) {
+        dhcp_renew(netif);
+      }
+    }
+  }
+}
+
+/* Input */
+
+/**
+ * @brief Options of a received message that lwIP evaluates.
+ */
+struct dhcp_rx {
+  u8_t msg_type;
+  u8_t have_server_id, have_mask, have_router;
+  ip4_addr_t server_id, mask, router;
+  u32_t lease, t1, t2;
+};
+
+static u32_t dhcp_get_u32(const u8_t *b)
+{
+  return ((u32_t)b[0] << 24) | ((u32_t)b[1] << 16) | ((u32_t)b[2] << 8) | b[3];
+}
+
+static int dhcp_parse_options(const u8_t *opt, u16_t len, struct dhcp_rx *rx)
+{
+  u16_t i = 0;
+  while (i < len && opt[i] != DHCP_OPTION_END) {
+    u8_t code = opt[i];
+    if (code == DHCP_OPTION_PAD) {
+      i++;
+      continue;
+    }
+    if (i + 2 > len || i + 2 + opt[i + 1] > len) {
+      return 0;
+    }
+    u8_t olen = opt[i + 1];
+    const u8_t *v = &opt[i + 2];
+    switch (code) {
+      case DHCP_OPTION_MESSAGE_TYPE:
+        if (olen == 1) {
+          rx->msg_type = v[0];
+        }
+        break;
+      case DHCP_OPTION_SERVER_ID:
+        if (olen == 4) {
+          memcpy(&rx->server_id.addr, v, 4);
+          rx->have_server_id = 1;
+        }
+        break;
+      case DHCP_OPTION_SUBNET_MASK:
+        if (olen == 4) {
+          memcpy(&rx->mask.addr, v, 4);
+          rx->have_mask = 1;
+        }
+        break;
+      case DHCP_OPTION_ROUTER:
+        if (olen >= 4) {
+          memcpy(&rx->router.addr, v, 4);
+          rx->have_router = 1;
+        }
+        break;
+      case DHCP_OPTION_LEASE_TIME:
+        if (olen == 4) {
+          rx->lease = dhcp_get_u32(v);
+        }
+        break;
+      case DHCP_OPTION_T1:
+        if (olen == 4) {
+          rx->t1 = dhcp_get_u32(v);
+        }
+        break;
+      case DHCP_OPTION_T2:
+        if (olen == 4) {
+          rx->t2 = dhcp_get_u32(v);
+        }
+        break;
+      default:
+        break;
+    }
+    i = (u16_t)(i + 2 + olen);
+  }
+  return 1;
+}
+
+static void dhcp_handle_ack(struct dhcp *dhcp, const struct dhcp_msg *msg, const struct dhcp_rx *rx)
+{
+  dhcp->offered_t0_lease = rx->lease;
+  dhcp->offered_t1_renew = rx->t1;
+  dhcp->offered_t2_rebind = rx->t2;
+  ip4_addr_copy(dhcp->offered_ip_addr, msg->yiaddr);
+  dhcp->subnet_mask_given = rx->have_mask;
+  if (rx->have_mask) {
+    dhcp->offered_sn_mask = rx->mask;
+  }
+  if (rx->have_router) {
+    dhcp->offered_gw_addr = rx->router;
+  } else {
+    ip4_addr_set_zero(&dhcp->offered_gw_addr);
+  }
+}
+
+void dhcp_recv(struct pbuf *p, struct netif *netif)
+{
+  struct dhcp *dhcp = netif_dhcp_data(netif);
+  static u8_t buf[DHCP_MAX_MSG_LEN];
+
+  if (dhcp == NULL || !dhcp->pcb_allocated || p->tot_len < DHCP_OPTIONS_OFS) {
+    pbuf_free(p);
+    return;
+  }
+  u16_t len = pbuf_copy_partial(p, buf, LWIP_MIN(p->tot_len, sizeof(buf)), 0);
+  pbuf_free(p);
+
+  const struct dhcp_msg *msg = (const struct dhcp_msg *)buf;
+  struct dhcp_rx rx;
+  memset(&rx, 0, sizeof(rx));
+  if (msg->op != DHCP_BOOTREPLY || memcmp(msg->chaddr, netif->hwaddr, netif->hwaddr_len) != 0 ||
+      lwip_ntohl(msg->xid) != dhcp->xid || msg->cookie != PP_HTONL(DHCP_MAGIC_COOKIE) ||
+      !dhcp_parse_options(&buf[DHCP_OPTIONS_OFS], (u16_t)(len - DHCP_OPTIONS_OFS), &rx) || rx.msg_type == 0) {
+    return;
+  }
+
+  switch (rx.msg_type) {
+    case DHCP_OFFER:
+      if (dhcp->state == DHCP_STATE_SELECTING && rx.have_server_id) {
+        LWIP_DEBUGF(DHCP_DEBUG | LWIP_DBG_TRACE, ("dhcp_recv: DHCP_OFFER received\n"));
+        dhcp->request_timeout = 0;
+        dhcp->server_ip_addr = rx.server_id;
+        ip4_addr_copy(dhcp->offered_ip_addr, msg->yiaddr);
+        dhcp_select(netif);
+      }
+      break;
+    case DHCP_ACK:
+      if (dhcp->state == DHCP_STATE_REQUESTING) {
+        dhcp_handle_ack(dhcp, msg, &rx);
+#if DHCP_DOES_ARP_CHECK
+        if (netif->flags & NETIF_FLAG_ETHARP) {
+          dhcp_check(netif);
+        } else {
+          dhcp_bind(netif);
+        }
+#else
+        dhcp_bind(netif);
+#endif
+      } else if (dhcp->state == DHCP_STATE_REBOOTING || dhcp->state == DHCP_STATE_REBINDING ||
+                 dhcp->state == DHCP_STATE_RENEWING) {
+        dhcp_handle_ack(dhcp, msg, &rx);
+        if (rx.have_server_id) {
+          dhcp->server_ip_addr = rx.server_id;
+        }
+        dhcp_bind(netif);
+      }
+      break;
+    case DHCP_NAK:
+      if (dhcp->state == DHCP_STATE_REBOOTING || dhcp->state == DHCP_STATE_REQUESTING ||
+          dhcp->state == DHCP_STATE_REBINDING || dhcp->state == DHCP_STATE_RENEWING) {
+        LWIP_DEBUGF(DHCP_DEBUG | LWIP_DBG_TRACE, ("dhcp_recv: DHCP_NAK received\n"));
+        dhcp_set_state(dhcp, DHCP_STATE_BACKING_OFF);
+        netif_set_addr(netif, IP4_ADDR_ANY4, IP4_ADDR_ANY4, IP4_ADDR_ANY4);
+        dhcp_discover(netif);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+#endif /* LWIP_DHCP */
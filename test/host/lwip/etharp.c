@@ -0,0 +1,494 @@
+/**
+ * @file
+ * @brief Stand-in lwIP ARP and Ethernet layer.
+ *
+ * Follows lwIP 2.1's etharp.c without ARP_QUEUEING: one packet is queued
+ * per pending entry, pending entries are re-requested every ARP_TMR_INTERVAL
+ * and dropped after ARP_MAXPENDING, stable entries expire after ARP_MAXAGE
+ * and are re-requested shortly before. Only ARP traffic updates the table.
+ */
+
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/def.h"
+#include "lwip/pbuf.h"
+#include "lwip/stats.h"
+#include "lwip/netif.h"
+#include "lwip/etharp.h"
+#include "lwip/dhcp.h"
+#include "lwip/prot/ip4.h"
+#include "netif/ethernet.h"
+
+#include "host_priv.h"
+#include "sim.h"
+
+#define ARP_MAXPENDING 5
+#define ARP_AGE_REREQUEST_USED_UNICAST   (ARP_MAXAGE - 30)
+#define ARP_AGE_REREQUEST_USED_BROADCAST (ARP_MAXAGE - 15)
+
+#define ETHARP_FLAG_TRY_HARD     1
+#define ETHARP_FLAG_FIND_ONLY    2
+#define ETHARP_FLAG_STATIC_ENTRY 4
+
+enum etharp_state {
+  ETHARP_STATE_EMPTY = 0,
+  ETHARP_STATE_PENDING,
+  ETHARP_STATE_STABLE,
+  ETHARP_STATE_STABLE_REREQUESTING_1,
+  ETHARP_STATE_STABLE_REREQUESTING_2,
+  ETHARP_STATE_STATIC
+};
+
+struct etharp_entry {
+  struct pbuf *q;               /**< Packet waiting for the address to resolve */
+  ip4_addr_t ipaddr;
+  struct netif *netif;
+  struct eth_addr ethaddr;
+  u16_t ctime;                  /**< Age in ARP_TMR_INTERVAL ticks */
+  u8_t state;
+};
+
+const struct eth_addr ethbroadcast = {{0xff, 0xff, 0xff, 0xff, 0xff, 0xff}};
+const struct eth_addr ethzero = {{0, 0, 0, 0, 0, 0}};
+
+static struct etharp_entry arp_table[ARP_TABLE_SIZE];
+
+static void etharp_free_entry(int i)
+{
+  if (arp_table[i].q != NULL) {
+    pbuf_free(arp_table[i].q);
+    arp_table[i].q = NULL;
+  }
+  arp_table[i].state = ETHARP_STATE_EMPTY;
+  arp_table[i].ctime = 0;
+  arp_table[i].netif = NULL;
+  ip4_addr_set_zero(&arp_table[i].ipaddr);
+  arp_table[i].ethaddr = ethzero;
+}
+
+void etharp_reset(void)
+{
+  /* Packets of an older lwip_init() generation are freed without accounting */
+  for (int i = 0; i < ARP_TABLE_SIZE; i++) {
+    etharp_free_entry(i);
+  }
+}
+
+/**
+ * @brief Sends an ARP packet.
+ */
+static err_t etharp_raw(struct netif *netif, const struct eth_addr *ethsrc_addr, const struct eth_addr *ethdst_addr,
+                        const struct eth_addr *hwsrc_addr, const ip4_addr_t *ipsrc_addr,
+                        const struct eth_addr *hwdst_addr, const ip4_addr_t *ipdst_addr, u16_t opcode)
+{
+  struct pbuf *p = pbuf_alloc(PBUF_LINK, SIZEOF_ETHARP_HDR, PBUF_RAM);
+  if (p == NULL) {
+    ETHARP_STATS_INC(etharp.memerr);
+    return ERR_MEM;
+  }
+
+  struct etharp_hdr *hdr = (struct etharp_hdr *)p->payload;
+  hdr->opcode = lwip_htons(opcode);
+  memcpy(&hdr->shwaddr, hwsrc_addr, ETH_HWADDR_LEN);
+  memcpy(&hdr->dhwaddr, hwdst_addr, ETH_HWADDR_LEN);
+  memcpy(&hdr->sipaddr, ipsrc_addr, 4);
+  memcpy(&hdr->dipaddr, ipdst_addr, 4);
+  hdr->hwtype = PP_HTONS(HWTYPE_ETHERNET);
+  hdr->proto = PP_HTONS(ETHTYPE_IP);
+  hdr->hwlen = ETH_HWADDR_LEN;
+  hdr->protolen = 4;
+
+  ethernet_output(netif, p, ethsrc_addr, ethdst_addr, ETHTYPE_ARP);
+  ETHARP_STATS_INC(etharp.xmit);
+  pbuf_free(p);
+  return ERR_OK;
+}
+
+static err_t etharp_request_dst(struct netif *netif, const ip4_addr_t *ipaddr, const struct eth_addr *hw_dst_addr)
+{
+  return etharp_raw(netif, (struct eth_addr *)netif->hwaddr, hw_dst_addr, (struct eth_addr *)netif->hwaddr,
+                    netif_ip4_addr(netif), &ethzero, ipaddr, ARP_REQUEST);
+}
+
+err_t etharp_request(struct netif *netif, const ip4_addr_t *ipaddr)
+{
+  LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_request: sending ARP request for %s\n", ip4addr_ntoa(ipaddr)));
+  return etharp_request_dst(netif, ipaddr, &ethbroadcast);
+}
+
+void etharp_tmr(void)
+{
+  for (int i = 0; i < ARP_TABLE_SIZE; i++) {
+    u8_t state = arp_table[i].state;
+    if (state == ETHARP_STATE_EMPTY || state == ETHARP_STATE_STATIC) {
+      continue;
+    }
+    arp_table[i].ctime++;
+    if (arp_table[i].ctime >= ARP_MAXAGE ||
+        (state == ETHARP_STATE_PENDING && arp_table[i].ctime >= ARP_MAXPENDING)) {
+      LWIP_DEBUGF(ETHARP_DEBUG, ("etharp_tmr: expired entry %s\n", ip4addr_ntoa(&arp_table[i].ipaddr)));
+      etharp_free_entry(i);
+    } else if (state == ETHARP_STATE_STABLE_REREQUESTING_1) {
+      arp_table[i].state = ETHARP_STATE_STABLE_REREQUESTING_2;
+    } else if (state == ETHARP_STATE_STABLE_REREQUESTING_2) {
+      arp_table[i].state = ETHARP_STATE_STABLE;
+    } else if (state == ETHARP_STATE_PENDING) {
+      etharp_request(arp_table[i].netif, &arp_table[i].ipaddr);
+    }
+  }
+}
+
+/**
+ * @brief Finds the entry of @p ipaddr, or allocates one as lwIP's etharp_find_entry().
+ *
+ * @return Entry index, or -1.
+ */
+static int etharp_find_entry(const ip4_addr_t *ipaddr, u8_t flags, struct netif *netif)
+{
+  int empty = ARP_TABLE_SIZE;
+  int old_pending = ARP_TABLE_SIZE, old_queue = ARP_TABLE_SIZE, old_stable = ARP_TABLE_SIZE;
+  u16_t age_pending = 0, age_queue = 0, age_stable = 0;
+
+  for (int i = 0; i < ARP_TABLE_SIZE; i++) {
+    u8_t state = arp_table[i].state;
+    if (state == ETHARP_STATE_EMPTY) {
+      if (empty == ARP_TABLE_SIZE) {
+        empty = i;
+      }
+      continue;
+    }
+    if (ipaddr && ip4_addr_cmp(ipaddr, &arp_table[i].ipaddr) && (netif == NULL || netif == arp_table[i].netif)) {
+      return i;
+    }
+    if (state == ETHARP_STATE_PENDING) {
+      if (arp_table[i].q != NULL) {
+        if (arp_table[i].ctime >= age_queue) {
+          old_queue = i;
+          age_queue = arp_table[i].ctime;
+        }
+      } else if (arp_table[i].ctime >= age_pending) {
+        old_pending = i;
+        age_pending = arp_table[i].ctime;
+      }
+    } else if (state >= ETHARP_STATE_STABLE && state != ETHARP_STATE_STATIC) {
+      if (arp_table[i].ctime >= age_stable) {
+        old_stable = i;
+        age_stable = arp_table[i].ctime;
+      }
+    }
+  }
+
+  if ((flags & ETHARP_FLAG_FIND_ONLY) || (empty == ARP_TABLE_SIZE && !(flags & ETHARP_FLAG_TRY_HARD))) {
+    return -1;
+  }
+
+  int i;
+  if (empty < ARP_TABLE_SIZE) {
+    i = empty;
+  } else {
+    if (old_stable < ARP_TABLE_SIZE) {
+      i = old_stable;
+    } else if (old_pending < ARP_TABLE_SIZE) {
+      i = old_pending;
+    } else if (old_queue < ARP_TABLE_SIZE) {
+      i = old_queue;
+    } else {
+      return -1;
+    }
+    etharp_free_entry(i);
+  }
+
+  if (ipaddr != NULL) {
+    ip4_addr_copy(arp_table[i].ipaddr, *ipaddr);
+  }
+  arp_table[i].ctime = 0;
+  arp_table[i].netif = netif;
+  return i;
+}
+
+static err_t etharp_send_ip(struct netif *netif, struct pbuf *p, const struct eth_addr *src, const struct eth_addr *dst)
+{
+  return ethernet_output(netif, p, src, dst, ETHTYPE_IP);
+}
+
+static err_t etharp_update_arp_entry(struct netif *netif, const ip4_addr_t *ipaddr, const struct eth_addr *ethaddr, u8_t flags)
+{
+  if (ip4_addr_isany(ipaddr) || ip4_addr_isbroadcast(ipaddr, netif) || ip4_addr_ismulticast(ipaddr)) {
+    return ERR_ARG;
+  }
+  int i = etharp_find_entry(ipaddr, flags, netif);
+  if (i < 0) {
+    return ERR_MEM;
+  }
+
+  if (flags & ETHARP_FLAG_STATIC_ENTRY) {
+    arp_table[i].state = ETHARP_STATE_STATIC;
+  } else if (arp_table[i].state == ETHARP_STATE_STATIC) {
+    /* Static entries are not overwritten by ARP traffic */
+    return ERR_VAL;
+  } else {
+    arp_table[i].state = ETHARP_STATE_STABLE;
+  }
+  arp_table[i].netif = netif;
+  memcpy(&arp_table[i].ethaddr, ethaddr, ETH_HWADDR_LEN);
+  arp_table[i].ctime = 0;
+
+  if (arp_table[i].q != NULL) {
+    struct pbuf *p = arp_table[i].q;
+    arp_table[i].q = NULL;
+    etharp_send_ip(netif, p, (struct eth_addr *)netif->hwaddr, ethaddr);
+    pbuf_free(p);
+  }
+  return ERR_OK;
+}
+
+#if ETHARP_SUPPORT_STATIC_ENTRIES
+err_t etharp_add_static_entry(const ip4_addr_t *ipaddr, struct eth_addr *ethaddr)
+{
+  struct netif *netif = ip4_route(ipaddr);
+  if (netif == NULL) {
+    return ERR_RTE;
+  }
+  return etharp_update_arp_entry(netif, ipaddr, ethaddr, ETHARP_FLAG_TRY_HARD | ETHARP_FLAG_STATIC_ENTRY);
+}
+
+err_t etharp_remove_static_entry(const ip4_addr_t *ipaddr)
+{
+  int i = etharp_find_entry(ipaddr, ETHARP_FLAG_FIND_ONLY, NULL);
+  if (i < 0) {
+    return ERR_VAL;
+  }
+  if (arp_table[i].state != ETHARP_STATE_STATIC) {
+    return ERR_VAL;
+  }
+  etharp_free_entry(i);
+  return ERR_OK;
+}
+#endif /* ETHARP_SUPPORT_STATIC_ENTRIES */
+
+void etharp_cleanup_netif(struct netif *netif)
+{
+  for (int i = 0; i < ARP_TABLE_SIZE; i++) {
+    if (arp_table[i].state != ETHARP_STATE_EMPTY && arp_table[i].netif == netif) {
+      etharp_free_entry(i);
+    }
+  }
+}
+
+ssize_t etharp_find_addr(struct netif *netif, const ip4_addr_t *ipaddr,
+                         struct eth_addr **eth_ret, const ip4_addr_t **ip_ret)
+{
+  int i = etharp_find_entry(ipaddr, ETHARP_FLAG_FIND_ONLY, netif);
+  if (i >= 0 && arp_table[i].state >= ETHARP_STATE_STABLE) {
+    *eth_ret = &arp_table[i].ethaddr;
+    *ip_ret = &arp_table[i].ipaddr;
+    return i;
+  }
+  return -1;
+}
+
+void etharp_input(struct pbuf *p, struct netif *netif)
+{
+  if (p->len < SIZEOF_ETHARP_HDR) {
+    ETHARP_STATS_INC(etharp.lenerr);
+    pbuf_free(p);
+    return;
+  }
+  struct etharp_hdr *hdr = (struct etharp_hdr *)p->payload;
+  if (hdr->hwtype != PP_HTONS(HWTYPE_ETHERNET) || hdr->hwlen != ETH_HWADDR_LEN || hdr->protolen != 4 ||
+      hdr->proto != PP_HTONS(ETHTYPE_IP)) {
+    ETHARP_STATS_INC(etharp.proterr);
+    pbuf_free(p);
+    return;
+  }
+  ETHARP_STATS_INC(etharp.recv);
+
+  ip4_addr_t sipaddr, dipaddr;
+  memcpy(&sipaddr, &hdr->sipaddr, 4);
+  memcpy(&dipaddr, &hdr->dipaddr, 4);
+
+  u8_t for_us = !ip4_addr_isany_val(*netif_ip4_addr(netif)) && ip4_addr_cmp(&dipaddr, netif_ip4_addr(netif));
+
+  /* Requests to us create an entry for the sender, other ARP traffic only updates one */
+  etharp_update_arp_entry(netif, &sipaddr, &hdr->shwaddr, for_us ? ETHARP_FLAG_TRY_HARD : ETHARP_FLAG_FIND_ONLY);
+
+  switch (hdr->opcode) {
+    case PP_HTONS(ARP_REQUEST):
+      if (for_us) {
+        etharp_raw(netif, (struct eth_addr *)netif->hwaddr, &hdr->shwaddr, (struct eth_addr *)netif->hwaddr,
+                   netif_ip4_addr(netif), &hdr->shwaddr, &sipaddr, ARP_REPLY);
+      }
+      break;
+    case PP_HTONS(ARP_REPLY):
+#if LWIP_DHCP && DHCP_DOES_ARP_CHECK
+      dhcp_arp_reply(netif, &sipaddr);
+#endif
+      break;
+    default:
+      ETHARP_STATS_INC(etharp.err);
+      break;
+  }
+  pbuf_free(p);
+}
+
+err_t etharp_query(struct netif *netif, const ip4_addr_t *ipaddr, struct pbuf *q)
+{
+  if (ip4_addr_isbroadcast(ipaddr, netif) || ip4_addr_ismulticast(ipaddr) || ip4_addr_isany(ipaddr)) {
+    return ERR_ARG;
+  }
+
+  int i = etharp_find_entry(ipaddr, ETHARP_FLAG_TRY_HARD, netif);
+  if (i < 0) {
+    if (q) {
+      ETHARP_STATS_INC(etharp.memerr);
+    }
+    return ERR_MEM;
+  }
+
+  u8_t is_new = arp_table[i].state == ETHARP_STATE_EMPTY;
+  if (is_new) {
+    arp_table[i].state = ETHARP_STATE_PENDING;
+    arp_table[i].netif = netif;
+  }
+
+  err_t result = ERR_MEM;
+  if (is_new || q == NULL) {
+    result = etharp_request(netif, ipaddr);
+    if (q == NULL) {
+      return result;
+    }
+  }
+
+  if (arp_table[i].state >= ETHARP_STATE_STABLE) {
+    return etharp_send_ip(netif, q, (struct eth_addr *)netif->hwaddr, &arp_table[i].ethaddr);
+  }
+
+  /* Pending: keep the packet, copying it if it references volatile data */
+  struct pbuf *p = q;
+  u8_t copy = 0;
+  for (struct pbuf *r = q; r != NULL; r = r->next) {
+    if (r->type_internal == PBUF_REF) {
+      copy = 1;
+    }
+  }
+  if (copy) {
+    p = pbuf_alloc(PBUF_LINK, q->tot_len, PBUF_RAM);
+    if (p != NULL) {
+      pbuf_copy_partial(q, p->payload, q->tot_len, 0);
+    }
+  } else {
+    pbuf_ref(p);
+  }
+  if (p == NULL) {
+    ETHARP_STATS_INC(etharp.memerr);
+    return ERR_MEM;
+  }
+  if (arp_table[i].q != NULL) {
+    pbuf_free(arp_table[i].q);
+  }
+  arp_table[i].q = p;
+  return ERR_OK;
+}
+
+/**
+ * @brief Sends to a resolved entry, re-requesting it shortly before it expires.
+ */
+static err_t etharp_output_to_arp_index(struct netif *netif, struct pbuf *q, int i)
+{
+  if (arp_table[i].state == ETHARP_STATE_STABLE) {
+    if (arp_table[i].ctime >= ARP_AGE_REREQUEST_USED_BROADCAST) {
+      if (etharp_request(netif, &arp_table[i].ipaddr) == ERR_OK) {
+        arp_table[i].state = ETHARP_STATE_STABLE_REREQUESTING_1;
+      }
+    } else if (arp_table[i].ctime >= ARP_AGE_REREQUEST_USED_UNICAST) {
+      if (etharp_request_dst(netif, &arp_table[i].ipaddr, &arp_table[i].ethaddr) == ERR_OK) {
+        arp_table[i].state = ETHARP_STATE_STABLE_REREQUESTING_1;
+      }
+    }
+  }
+  return etharp_send_ip(netif, q, (struct eth_addr *)netif->hwaddr, &arp_table[i].ethaddr);
+}
+
+err_t etharp_output(struct netif *netif, struct pbuf *q, const ip4_addr_t *ipaddr)
+{
+  const ip4_addr_t *dst_addr = ipaddr;
+
+  if (ip4_addr_isbroadcast(ipaddr, netif)) {
+    return etharp_send_ip(netif, q, (struct eth_addr *)netif->hwaddr, &ethbroadcast);
+  }
+  if (ip4_addr_ismulticast(ipaddr)) {
+    struct eth_addr mcast = {{0x01, 0x00, 0x5e, (u8_t)(ip4_addr2(ipaddr) & 0x7f), ip4_addr3(ipaddr), ip4_addr4(ipaddr)}};
+    return etharp_send_ip(netif, q, (struct eth_addr *)netif->hwaddr, &mcast);
+  }
+
+  if (!ip4_addr_netcmp(ipaddr, netif_ip4_addr(netif), netif_ip4_netmask(netif))) {
+    if (ip4_addr_isany_val(*netif_ip4_gw(netif))) {
+      return ERR_RTE;
+    }
+    dst_addr = netif_ip4_gw(netif);
+  }
+
+  for (int i = 0; i < ARP_TABLE_SIZE; i++) {
+    if (arp_table[i].state >= ETHARP_STATE_STABLE && arp_table[i].netif == netif &&
+        ip4_addr_cmp(dst_addr, &arp_table[i].ipaddr)) {
+      return etharp_output_to_arp_index(netif, q, i);
+    }
+  }
+  return etharp_query(netif, dst_addr, q);
+}
+
+/* Ethernet */
+
+err_t ethernet_input(struct pbuf *p, struct netif *netif)
+{
+  sim_advance(SIM_CPU_FRAME_IN_NS);
+
+  if (p->len <= SIZEOF_ETH_HDR) {
+    LINK_STATS_INC(link.proterr);
+    LINK_STATS_INC(link.drop);
+    pbuf_free(p);
+    return ERR_OK;
+  }
+  struct eth_hdr *ethhdr = (struct eth_hdr *)p->payload;
+  u16_t type = ethhdr->type;
+
+  switch (type) {
+    case PP_HTONS(ETHTYPE_IP):
+      if (!(netif->flags & NETIF_FLAG_ETHARP) || pbuf_remove_header(p, SIZEOF_ETH_HDR)) {
+        pbuf_free(p);
+        return ERR_OK;
+      }
+      ip4_input(p, netif);
+      break;
+    case PP_HTONS(ETHTYPE_ARP):
+      if (!(netif->flags & NETIF_FLAG_ETHARP) || pbuf_remove_header(p, SIZEOF_ETH_HDR)) {
+        pbuf_free(p);
+        return ERR_OK;
+      }
+      etharp_input(p, netif);
+      break;
+    default:
+      LINK_STATS_INC(link.proterr);
+      LINK_STATS_INC(link.drop);
+      pbuf_free(p);
+      break;
+  }
+  return ERR_OK;
+}
+
+err_t ethernet_output(struct netif *netif, struct pbuf *p, const struct eth_addr *src,
+                      const struct eth_addr *dst, u16_t eth_type)
+{
+  if (pbuf_add_header(p, SIZEOF_ETH_HDR) != 0) {
+    LINK_STATS_INC(link.lenerr);
+    return ERR_BUF;
+  }
+  struct eth_hdr *ethhdr = (struct eth_hdr *)p->payload;
+  ethhdr->type = lwip_htons(eth_type);
+  memcpy(&ethhdr->dest, dst, ETH_HWADDR_LEN);
+  memcpy(&ethhdr->src, src, ETH_HWADDR_LEN);
+
+  sim_advance(SIM_CPU_FRAME_OUT_NS);
+  return netif->linkoutput(netif, p);
+}
@@ -0,0 +1,105 @@
+/**
+ * @file
+ * @brief Internal interfaces between the modules of the stand-in lwIP stack.
+ *
+ * The stand-in follows lwIP 2.1 behaviour closely enough for the port code
+ * and the HTTP server to be exercised on the host: pool and heap limits,
+ * ARP queueing and aging, the DHCP state machine, and TCP with Nagle, delayed
+ * ACKs, congestion window, retransmission and TIME_WAIT. It is not lwIP:
+ * no IP fragments, no out-of-order TCP queue, no persist timer.
+ */
+
+#ifndef __HOST_PRIV_H__
+#define __HOST_PRIV_H__
+
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
+#include "lwip/netif.h"
+#include "lwip/ip_addr.h"
+#include "lwip/prot/ip4.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* core.c */
+
+/**
+ * @brief Incremented by lwip_init(); memory from an older generation is not
+ *        returned to the pools and heap of the new one.
+ */
+extern u32_t host_generation;
+
+/**
+ * @brief Starts the on-demand TCP timer, as lwIP's tcp_timer_needed().
+ */
+void tcp_timer_needed(void);
+
+/**
+ * @brief Route lookup: the interface whose subnet holds @p dest, else the default.
+ */
+struct netif *ip4_route(const ip4_addr_t *dest);
+
+/* etharp.c */
+
+void etharp_reset(void);
+
+/* ip4.c */
+
+/**
+ * @brief Headers of the IP packet being processed by ip4_input().
+ */
+struct ip_globals {
+  struct netif *current_netif;          /**< Interface the packet arrived on */
+  const struct ip_hdr *current_ip4_header; /**< IP header of the packet */
+  u16_t current_ip_header_tot_len;      /**< Length of that header */
+  ip4_addr_t current_iphdr_src;         /**< Source address */
+  ip4_addr_t current_iphdr_dest;        /**< Destination address */
+};
+extern struct ip_globals ip_data;
+
+#define ip_current_netif()    (ip_data.current_netif)
+#define ip4_current_src_addr()  (&ip_data.current_iphdr_src)
+#define ip4_current_dest_addr() (&ip_data.current_iphdr_dest)
+
+void ip4_reset(void);
+err_t ip4_input(struct pbuf *p, struct netif *inp);
+err_t ip4_output_if(struct pbuf *p, const ip4_addr_t *src, const ip4_addr_t *dest,
+                    u8_t ttl, u8_t tos, u8_t proto, struct netif *netif);
+err_t ip4_output_if_src(struct pbuf *p, const ip4_addr_t *src, const ip4_addr_t *dest,
+                        u8_t ttl, u8_t tos, u8_t proto, struct netif *netif);
+err_t ip4_output(struct pbuf *p, const ip4_addr_t *src, const ip4_addr_t *dest,
+                 u8_t ttl, u8_t tos, u8_t proto);
+
+/**
+ * @brief Sends a UDP datagram without a PCB (the DHCP client's socket).
+ *
+ * Prepends the UDP header to @p p, which must have PBUF_TRANSPORT headroom.
+ */
+err_t udp_sendto_if_raw(struct netif *netif, struct pbuf *p, const ip4_addr_t *src, u16_t src_port,
+                        const ip4_addr_t *dest, u16_t dest_port);
+
+/* dhcp.c */
+
+/**
+ * @brief DHCP client input, @p p starts at the UDP payload.
+ */
+void dhcp_recv(struct pbuf *p, struct netif *netif);
+
+/* tcp.c */
+
+void tcp_reset(void);
+void tcp_input(struct pbuf *p, struct netif *inp);
+void tcp_tmr(void);
+void tcp_netif_ip_addr_changed(const ip4_addr_t *old_addr, const ip4_addr_t *new_addr);
+
+/**
+ * @brief True while an active or TIME_WAIT PCB needs the TCP timer.
+ */
+int tcp_timer_wanted(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __HOST_PRIV_H__
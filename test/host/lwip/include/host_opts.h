@@ -0,0 +1,54 @@
+/**
+ * @file
+ * @brief Per-target overrides of lwipopts.h for the host suite.
+ *
+ * lwipopts.h defines the driver options unconditionally, so a benchmark
+ * that compares both settings of an option cannot pass -D on the command
+ * line. Instead it passes -DHOST_<option>=<value>, which replaces the value
+ * of lwipopts.h here.
+ */
+
+#ifndef __HOST_OPTS_H__
+#define __HOST_OPTS_H__
+
+#ifdef HOST_ETHIF_RX_CLASSIFY
+#undef ETHIF_RX_CLASSIFY
+#define ETHIF_RX_CLASSIFY HOST_ETHIF_RX_CLASSIFY
+#endif
+
+#ifdef HOST_ETHIF_RX_POLL_MAX_FRAMES
+#undef ETHIF_RX_POLL_MAX_FRAMES
+#define ETHIF_RX_POLL_MAX_FRAMES HOST_ETHIF_RX_POLL_MAX_FRAMES
+#endif
+
+#ifdef HOST_ETHIF_TRACE
+#undef ETHIF_TRACE
+#define ETHIF_TRACE HOST_ETHIF_TRACE
+#endif
+
+#ifdef HOST_ETHIF_PCAP
+#undef ETHIF_PCAP
+#define ETHIF_PCAP HOST_ETHIF_PCAP
+#endif
+
+#ifdef HOST_ETHIF_PROF
+#undef ETHIF_PROF
+#define ETHIF_PROF HOST_ETHIF_PROF
+#endif
+
+#ifdef HOST_ETHIF_SPI_CHUNK
+#undef ETHIF_SPI_CHUNK
+#define ETHIF_SPI_CHUNK HOST_ETHIF_SPI_CHUNK
+#endif
+
+#ifdef HOST_ETHIF_SPI_PROTECT
+#undef ETHIF_SPI_PROTECT
+#define ETHIF_SPI_PROTECT HOST_ETHIF_SPI_PROTECT
+#endif
+
+#ifdef HOST_ETHIF_SPI_HOLD_TIMING
+#undef ETHIF_SPI_HOLD_TIMING
+#define ETHIF_SPI_HOLD_TIMING HOST_ETHIF_SPI_HOLD_TIMING
+#endif
+
+#endif // __HOST_OPTS_H__
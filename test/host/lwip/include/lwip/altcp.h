@@ -0,0 +1,11 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's application layered TCP (LWIP_ALTCP is off).
+ */
+
+#ifndef LWIP_HDR_ALTCP_H
+#define LWIP_HDR_ALTCP_H
+
+#include "lwip/opt.h"
+
+#endif /* LWIP_HDR_ALTCP_H */
@@ -0,0 +1,11 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's netconn API (LWIP_NETCONN is off).
+ */
+
+#ifndef LWIP_HDR_API_H
+#define LWIP_HDR_API_H
+
+#include "lwip/opt.h"
+
+#endif /* LWIP_HDR_API_H */
@@ -0,0 +1,41 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's architecture abstraction.
+ */
+
+#ifndef LWIP_HDR_ARCH_H
+#define LWIP_HDR_ARCH_H
+
+#ifndef LITTLE_ENDIAN
+#define LITTLE_ENDIAN 1234
+#endif
+#ifndef BIG_ENDIAN
+#define BIG_ENDIAN 4321
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "arch/cc.h"
+
+#ifndef SZT_F
+#define SZT_F "zu"
+#endif
+
+#define LWIP_UNUSED_ARG(x) (void)x
+
+#define LWIP_CONST_CAST(target_type, val) ((target_type)((ptrdiff_t)val))
+#define LWIP_ALIGNMENT_CAST(target_type, val) LWIP_CONST_CAST(target_type, val)
+#define LWIP_PTR_NUMERIC_CAST(target_type, val) LWIP_CONST_CAST(target_type, val)
+
+#define LWIP_MEM_ALIGN_SIZE(size) (((size) + MEM_ALIGNMENT - 1U) & ~(MEM_ALIGNMENT-1U))
+#define LWIP_MEM_ALIGN_BUFFER(size) (((size) + MEM_ALIGNMENT - 1U))
+#define LWIP_MEM_ALIGN(addr) ((void *)(((mem_ptr_t)(addr) + MEM_ALIGNMENT - 1) & ~(mem_ptr_t)(MEM_ALIGNMENT-1)))
+
+#define PACK_STRUCT_FLD_8(x) PACK_STRUCT_FIELD(x)
+#define PACK_STRUCT_FLD_S(x) PACK_STRUCT_FIELD(x)
+
+#endif /* LWIP_HDR_ARCH_H */
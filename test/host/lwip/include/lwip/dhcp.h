@@ -0,0 +1,72 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's DHCP client.
+ */
+
+#ifndef LWIP_HDR_DHCP_H
+#define LWIP_HDR_DHCP_H
+
+#include "lwip/opt.h"
+
+#if LWIP_DHCP
+
+#include "lwip/netif.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** period (in seconds) of the application calling dhcp_coarse_tmr() */
+#define DHCP_COARSE_TIMER_SECS  60
+/** period (in milliseconds) of the application calling dhcp_coarse_tmr() */
+#define DHCP_COARSE_TIMER_MSECS (DHCP_COARSE_TIMER_SECS * 1000UL)
+/** period (in milliseconds) of the application calling dhcp_fine_tmr() */
+#define DHCP_FINE_TIMER_MSECS   500
+
+#define DHCP_BOOT_FILE_LEN      128U
+
+struct dhcp {
+  u32_t xid;                    /**< transaction identifier of last sent request */
+  u8_t pcb_allocated;           /**< track PCB allocation state */
+  u8_t state;                   /**< current DHCP state machine state */
+  u8_t tries;                   /**< retries of current request */
+  u8_t subnet_mask_given;
+  u16_t request_timeout;        /**< #ticks with period DHCP_FINE_TIMER_SECS for request timeout */
+  u16_t t1_timeout;             /**< #ticks with period DHCP_COARSE_TIMER_SECS for renewal time */
+  u16_t t2_timeout;             /**< #ticks with period DHCP_COARSE_TIMER_SECS for rebind time */
+  u16_t t1_renew_time;          /**< #ticks with period DHCP_COARSE_TIMER_SECS until next renew try */
+  u16_t t2_rebind_time;         /**< #ticks with period DHCP_COARSE_TIMER_SECS until next rebind try */
+  u16_t lease_used;             /**< #ticks with period DHCP_COARSE_TIMER_SECS since last received DHCP ack */
+  u16_t t0_timeout;             /**< #ticks with period DHCP_COARSE_TIMER_SECS for lease time */
+  ip_addr_t server_ip_addr;     /**< dhcp server address that offered this lease */
+  ip4_addr_t offered_ip_addr;
+  ip4_addr_t offered_sn_mask;
+  ip4_addr_t offered_gw_addr;
+  u32_t offered_t0_lease;       /**< lease period (in seconds) */
+  u32_t offered_t1_renew;       /**< recommended renew time (usually 50% of lease period) */
+  u32_t offered_t2_rebind;      /**< recommended rebind time (usually 87.5 of lease period)  */
+};
+
+err_t dhcp_start(struct netif *netif);
+err_t dhcp_renew(struct netif *netif);
+void dhcp_release_and_stop(struct netif *netif);
+err_t dhcp_release(struct netif *netif);
+void dhcp_stop(struct netif *netif);
+void dhcp_cleanup(struct netif *netif);
+void dhcp_network_changed(struct netif *netif);
+#if DHCP_DOES_ARP_CHECK
+void dhcp_arp_reply(struct netif *netif, const ip4_addr_t *addr);
+#endif
+u8_t dhcp_supplied_address(const struct netif *netif);
+void dhcp_coarse_tmr(void);
+void dhcp_fine_tmr(void);
+
+#define netif_dhcp_data(netif) ((struct dhcp*)netif_get_client_data(netif, LWIP_NETIF_CLIENT_DATA_INDEX_DHCP))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_DHCP */
+
+#endif /*LWIP_HDR_DHCP_H*/
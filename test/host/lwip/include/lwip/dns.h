@@ -0,0 +1,11 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's DNS client (LWIP_DNS is off).
+ */
+
+#ifndef LWIP_HDR_DNS_H
+#define LWIP_HDR_DNS_H
+
+#include "lwip/opt.h"
+
+#endif /* LWIP_HDR_DNS_H */
@@ -0,0 +1,11 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's IPv6 over Ethernet (LWIP_IPV6 is off).
+ */
+
+#ifndef LWIP_HDR_ETHIP6_H
+#define LWIP_HDR_ETHIP6_H
+
+#include "lwip/opt.h"
+
+#endif /* LWIP_HDR_ETHIP6_H */
@@ -0,0 +1,11 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's IGMP (LWIP_IGMP is off).
+ */
+
+#ifndef LWIP_HDR_IGMP_H
+#define LWIP_HDR_IGMP_H
+
+#include "lwip/opt.h"
+
+#endif /* LWIP_HDR_IGMP_H */
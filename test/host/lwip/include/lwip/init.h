@@ -0,0 +1,26 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's initialization.
+ */
+
+#ifndef LWIP_HDR_INIT_H
+#define LWIP_HDR_INIT_H
+
+#include "lwip/opt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Resets every module of the stand-in stack and starts its timers.
+ *
+ * Unlike lwIP, may be called again to start a new scenario from scratch.
+ */
+void lwip_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_INIT_H */
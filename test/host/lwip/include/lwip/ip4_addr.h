@@ -0,0 +1,58 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's IPv4 address type and helpers.
+ */
+
+#ifndef LWIP_HDR_IP4_ADDR_H
+#define LWIP_HDR_IP4_ADDR_H
+
+#include "lwip/opt.h"
+#include "lwip/def.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** IPv4 address in network byte order */
+struct ip4_addr {
+  u32_t addr;
+};
+typedef struct ip4_addr ip4_addr_t;
+
+struct netif;
+
+#define IPADDR_NONE         ((u32_t)0xffffffffUL)
+#define IPADDR_LOOPBACK     ((u32_t)0x7f000001UL)
+#define IPADDR_ANY          ((u32_t)0x00000000UL)
+#define IPADDR_BROADCAST    ((u32_t)0xffffffffUL)
+
+#define IP4_ADDR(ipaddr, a,b,c,d)  (ipaddr)->addr = PP_HTONL(LWIP_MAKEU32(a,b,c,d))
+
+#define ip4_addr_copy(dest, src) ((dest).addr = (src).addr)
+#define ip4_addr_set(dest, src) ((dest)->addr = ((src) == NULL ? 0 : (src)->addr))
+#define ip4_addr_set_zero(ipaddr) ((ipaddr)->addr = 0)
+#define ip4_addr_set_any(ipaddr) ((ipaddr)->addr = IPADDR_ANY)
+#define ip4_addr_set_u32(dest_ipaddr, src_u32) ((dest_ipaddr)->addr = (src_u32))
+#define ip4_addr_get_u32(src_ipaddr) ((src_ipaddr)->addr)
+
+#define ip4_addr_netcmp(addr1, addr2, mask) (((addr1)->addr & (mask)->addr) == ((addr2)->addr & (mask)->addr))
+#define ip4_addr_cmp(addr1, addr2) ((addr1)->addr == (addr2)->addr)
+#define ip4_addr_isany_val(addr1) ((addr1).addr == IPADDR_ANY)
+#define ip4_addr_isany(addr1) ((addr1) == NULL || ip4_addr_isany_val(*(addr1)))
+#define ip4_addr_ismulticast(addr1) (((addr1)->addr & PP_HTONL(0xf0000000UL)) == PP_HTONL(0xe0000000UL))
+
+#define ip4_addr_isbroadcast(addr1, netif) ip4_addr_isbroadcast_u32((addr1)->addr, netif)
+u8_t ip4_addr_isbroadcast_u32(u32_t addr, const struct netif *netif);
+
+#define ip4_addr1(ipaddr) (((const u8_t*)(&(ipaddr)->addr))[0])
+#define ip4_addr2(ipaddr) (((const u8_t*)(&(ipaddr)->addr))[1])
+#define ip4_addr3(ipaddr) (((const u8_t*)(&(ipaddr)->addr))[2])
+#define ip4_addr4(ipaddr) (((const u8_t*)(&(ipaddr)->addr))[3])
+
+char *ip4addr_ntoa(const ip4_addr_t *addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_IP4_ADDR_H */
@@ -0,0 +1,11 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's IPv6 fragmentation (LWIP_IPV6 is off).
+ */
+
+#ifndef LWIP_HDR_IP6_FRAG_H
+#define LWIP_HDR_IP6_FRAG_H
+
+#include "lwip/opt.h"
+
+#endif /* LWIP_HDR_IP6_FRAG_H */
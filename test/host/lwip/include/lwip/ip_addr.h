@@ -0,0 +1,46 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's generic IP address type (IPv4 only).
+ */
+
+#ifndef LWIP_HDR_IP_ADDR_H
+#define LWIP_HDR_IP_ADDR_H
+
+#include "lwip/opt.h"
+#include "lwip/def.h"
+#include "lwip/ip4_addr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef ip4_addr_t ip_addr_t;
+
+#define IPADDR4_INIT(u32val)          { u32val }
+#define IPADDR4_INIT_BYTES(a,b,c,d)   IPADDR4_INIT(PP_HTONL(LWIP_MAKEU32(a,b,c,d)))
+#define IP_ADDR4(ipaddr,a,b,c,d)      IP4_ADDR(ipaddr,a,b,c,d)
+
+#define ip_2_ip4(ipaddr)              (ipaddr)
+#define ip_addr_copy(dest, src)       ip4_addr_copy(dest, src)
+#define ip_addr_set(dest, src)        ip4_addr_set(dest, src)
+#define ip_addr_set_zero(ipaddr)      ip4_addr_set_zero(ipaddr)
+#define ip_addr_cmp(addr1, addr2)     ip4_addr_cmp(addr1, addr2)
+#define ip_addr_isany(ipaddr)         ip4_addr_isany(ipaddr)
+#define ip_addr_isany_val(ipaddr)     ip4_addr_isany_val(ipaddr)
+#define ipaddr_ntoa(ipaddr)           ip4addr_ntoa(ipaddr)
+
+extern const ip_addr_t ip_addr_any;
+extern const ip_addr_t ip_addr_broadcast;
+
+#define IP_ADDR_ANY         (&ip_addr_any)
+#define IP_ADDR_BROADCAST   (&ip_addr_broadcast)
+#define IP4_ADDR_ANY        (&ip_addr_any)
+#define IP4_ADDR_ANY4       (&ip_addr_any)
+#define IP4_ADDR_BROADCAST  (&ip_addr_broadcast)
+#define IP_ANY_TYPE         (&ip_addr_any)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_IP_ADDR_H */
@@ -0,0 +1,24 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's heap.
+ */
+
+#ifndef LWIP_HDR_MEM_H
+#define LWIP_HDR_MEM_H
+
+#include "lwip/opt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef u16_t mem_size_t;
+
+void *mem_malloc(mem_size_t size);
+void mem_free(void *mem);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_MEM_H */
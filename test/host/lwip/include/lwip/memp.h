@@ -0,0 +1,46 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's memory pools.
+ *
+ * The pools are listed in lwip/priv/memp_std.h: only those the stand-in
+ * stack allocates from. Their usage is kept in lwip_stats.memp[] like
+ * lwIP's MEMP_STATS.
+ */
+
+#ifndef LWIP_HDR_MEMP_H
+#define LWIP_HDR_MEMP_H
+
+#include "lwip/opt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+#define LWIP_MEMPOOL(name, num, size, desc) MEMP_##name,
+#include "lwip/priv/memp_std.h"
+  MEMP_MAX
+} memp_t;
+
+/**
+ * @brief Takes one element of a pool.
+ *
+ * @return false if the pool is exhausted (counted in its err statistic).
+ */
+int memp_take(memp_t type);
+
+/**
+ * @brief Returns one element to a pool.
+ */
+void memp_give(memp_t type);
+
+/**
+ * @brief Configured number of elements of a pool.
+ */
+u16_t memp_num(memp_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_MEMP_H */
@@ -0,0 +1,111 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's network interface API.
+ */
+
+#ifndef LWIP_HDR_NETIF_H
+#define LWIP_HDR_NETIF_H
+
+#include "lwip/opt.h"
+#include "lwip/err.h"
+#include "lwip/ip_addr.h"
+#include "lwip/def.h"
+#include "lwip/pbuf.h"
+#if MIB2_STATS
+#include "lwip/stats.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NETIF_MAX_HWADDR_LEN 6U
+
+#define NETIF_FLAG_UP           0x01U
+#define NETIF_FLAG_BROADCAST    0x02U
+#define NETIF_FLAG_LINK_UP      0x04U
+#define NETIF_FLAG_ETHARP       0x08U
+#define NETIF_FLAG_ETHERNET     0x10U
+#define NETIF_FLAG_IGMP         0x20U
+#define NETIF_FLAG_MLD6         0x40U
+
+enum lwip_internal_netif_client_data_index {
+#if LWIP_DHCP
+  LWIP_NETIF_CLIENT_DATA_INDEX_DHCP,
+#endif
+  LWIP_NETIF_CLIENT_DATA_INDEX_MAX
+};
+
+struct netif;
+
+typedef err_t (*netif_init_fn)(struct netif *netif);
+typedef err_t (*netif_input_fn)(struct pbuf *p, struct netif *inp);
+typedef err_t (*netif_output_fn)(struct netif *netif, struct pbuf *p, const ip4_addr_t *ipaddr);
+typedef err_t (*netif_linkoutput_fn)(struct netif *netif, struct pbuf *p);
+typedef void (*netif_status_callback_fn)(struct netif *netif);
+
+struct netif {
+  struct netif *next;
+  ip_addr_t ip_addr;
+  ip_addr_t netmask;
+  ip_addr_t gw;
+  netif_input_fn input;
+  netif_output_fn output;
+  netif_linkoutput_fn linkoutput;
+#if LWIP_NETIF_STATUS_CALLBACK
+  netif_status_callback_fn status_callback;
+#endif
+#if LWIP_NETIF_LINK_CALLBACK
+  netif_status_callback_fn link_callback;
+#endif
+  void *state;
+  void *client_data[LWIP_NETIF_CLIENT_DATA_INDEX_MAX + LWIP_NUM_NETIF_CLIENT_DATA + 1];
+#if LWIP_NETIF_HOSTNAME
+  const char *hostname;
+#endif
+  u16_t mtu;
+  u8_t hwaddr[NETIF_MAX_HWADDR_LEN];
+  u8_t hwaddr_len;
+  u8_t flags;
+  char name[2];
+  u8_t num;
+#if MIB2_STATS
+  struct stats_mib2_netif_ctrs mib2_counters;
+#endif
+};
+
+extern struct netif *netif_list;
+extern struct netif *netif_default;
+
+#define NETIF_FOREACH(netif) for ((netif) = netif_list; (netif) != NULL; (netif) = (netif)->next)
+
+struct netif *netif_add(struct netif *netif, const ip4_addr_t *ipaddr, const ip4_addr_t *netmask,
+                        const ip4_addr_t *gw, void *state, netif_init_fn init, netif_input_fn input);
+void netif_remove(struct netif *netif);
+void netif_set_addr(struct netif *netif, const ip4_addr_t *ipaddr, const ip4_addr_t *netmask,
+                    const ip4_addr_t *gw);
+void netif_set_ipaddr(struct netif *netif, const ip4_addr_t *ipaddr);
+void netif_set_default(struct netif *netif);
+void netif_set_up(struct netif *netif);
+void netif_set_down(struct netif *netif);
+void netif_set_link_up(struct netif *netif);
+void netif_set_link_down(struct netif *netif);
+#if LWIP_NETIF_LINK_CALLBACK
+void netif_set_link_callback(struct netif *netif, netif_status_callback_fn link_callback);
+#endif
+
+#define netif_is_up(netif) (((netif)->flags & NETIF_FLAG_UP) ? (u8_t)1 : (u8_t)0)
+#define netif_is_link_up(netif) (((netif)->flags & NETIF_FLAG_LINK_UP) ? (u8_t)1 : (u8_t)0)
+
+#define netif_ip4_addr(netif)    ((const ip4_addr_t*)ip_2_ip4(&((netif)->ip_addr)))
+#define netif_ip4_netmask(netif) ((const ip4_addr_t*)ip_2_ip4(&((netif)->netmask)))
+#define netif_ip4_gw(netif)      ((const ip4_addr_t*)ip_2_ip4(&((netif)->gw)))
+
+#define netif_get_client_data(netif, id)       (netif)->client_data[(id)]
+#define netif_set_client_data(netif, id, data) netif_get_client_data(netif, id) = (data)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_NETIF_H */
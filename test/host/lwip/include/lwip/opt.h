@@ -0,0 +1,133 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's option defaults.
+ *
+ * Includes the port's lwipopts.h, applies the host_opts.h overrides and
+ * supplies the lwIP 2.1 defaults of the options the stand-in stack uses.
+ */
+
+#ifndef LWIP_HDR_OPT_H
+#define LWIP_HDR_OPT_H
+
+#include "lwipopts.h"
+#include "lwip/debug.h"
+#include "host_opts.h"
+
+#ifndef LWIP_IPV6
+#define LWIP_IPV6                       0
+#endif
+#ifndef LWIP_IGMP
+#define LWIP_IGMP                       0
+#endif
+#ifndef LWIP_AUTOIP
+#define LWIP_AUTOIP                     0
+#endif
+#ifndef PPPOE_SUPPORT
+#define PPPOE_SUPPORT                   0
+#endif
+#ifndef MIB2_STATS
+#define MIB2_STATS                      0
+#endif
+#ifndef ETH_PAD_SIZE
+#define ETH_PAD_SIZE                    0
+#endif
+
+/* Pools */
+#ifndef MEMP_NUM_TCP_PCB_LISTEN
+#define MEMP_NUM_TCP_PCB_LISTEN         8
+#endif
+#ifndef MEMP_NUM_PBUF
+#define MEMP_NUM_PBUF                   16
+#endif
+#ifndef LWIP_NUM_NETIF_CLIENT_DATA
+#define LWIP_NUM_NETIF_CLIENT_DATA      0
+#endif
+
+/* ARP */
+#ifndef ARP_TABLE_SIZE
+#define ARP_TABLE_SIZE                  10
+#endif
+#ifndef ARP_MAXAGE
+#define ARP_MAXAGE                      300
+#endif
+#ifndef ETHARP_SUPPORT_STATIC_ENTRIES
+#define ETHARP_SUPPORT_STATIC_ENTRIES   0
+#endif
+
+/* IP */
+#ifndef IP_DEFAULT_TTL
+#define IP_DEFAULT_TTL                  255
+#endif
+
+/* DHCP */
+#ifndef DHCP_DOES_ARP_CHECK
+#define DHCP_DOES_ARP_CHECK             (LWIP_DHCP && LWIP_ARP)
+#endif
+
+/* TCP */
+#ifndef TCP_TTL
+#define TCP_TTL                         IP_DEFAULT_TTL
+#endif
+#ifndef TCP_TMR_INTERVAL
+#define TCP_TMR_INTERVAL                250
+#endif
+#ifndef TCP_MSL
+#define TCP_MSL                         60000UL
+#endif
+#ifndef TCP_MAXRTX
+#define TCP_MAXRTX                      12
+#endif
+#ifndef TCP_SYNMAXRTX
+#define TCP_SYNMAXRTX                   6
+#endif
+#ifndef TCP_WND_UPDATE_THRESHOLD
+#define TCP_WND_UPDATE_THRESHOLD        LWIP_MIN((TCP_WND / 4), (TCP_MSS * 4))
+#endif
+#ifndef TCP_SNDLOWAT
+#define TCP_SNDLOWAT                    LWIP_MIN(LWIP_MAX(((TCP_SND_BUF)/2), (2 * TCP_MSS) + 1), (TCP_SND_BUF) - 1)
+#endif
+#ifndef TCP_SNDQUEUELOWAT
+#define TCP_SNDQUEUELOWAT               LWIP_MAX(((TCP_SND_QUEUELEN)/2), 5)
+#endif
+#ifndef TCP_DEFAULT_LISTEN_BACKLOG
+#define TCP_DEFAULT_LISTEN_BACKLOG      0xff
+#endif
+#ifndef LWIP_TCP_KEEPALIVE
+#define LWIP_TCP_KEEPALIVE              0
+#endif
+
+/* Pbuf header space, as lwIP derives it */
+#ifndef PBUF_LINK_HLEN
+#define PBUF_LINK_HLEN                  (14 + ETH_PAD_SIZE)
+#endif
+#ifndef PBUF_LINK_ENCAPSULATION_HLEN
+#define PBUF_LINK_ENCAPSULATION_HLEN    0
+#endif
+
+/* Debug switches not set by lwipopts.h */
+#ifndef LWIP_DBG_TYPES_ON
+#define LWIP_DBG_TYPES_ON               LWIP_DBG_ON
+#endif
+#ifndef ETHARP_DEBUG
+#define ETHARP_DEBUG                    LWIP_DBG_OFF
+#endif
+#ifndef NETIF_DEBUG
+#define NETIF_DEBUG                     LWIP_DBG_OFF
+#endif
+#ifndef PBUF_DEBUG
+#define PBUF_DEBUG                      LWIP_DBG_OFF
+#endif
+#ifndef IP_DEBUG
+#define IP_DEBUG                        LWIP_DBG_OFF
+#endif
+#ifndef TCP_DEBUG
+#define TCP_DEBUG                       LWIP_DBG_OFF
+#endif
+#ifndef DHCP_DEBUG
+#define DHCP_DEBUG                      LWIP_DBG_OFF
+#endif
+#ifndef TIMERS_DEBUG
+#define TIMERS_DEBUG                    LWIP_DBG_OFF
+#endif
+
+#endif /* LWIP_HDR_OPT_H */
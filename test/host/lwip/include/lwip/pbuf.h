@@ -0,0 +1,77 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's packet buffers.
+ *
+ * Same types and API as lwIP 2.1. PBUF_POOL allocations are limited to
+ * PBUF_POOL_SIZE buffers of PBUF_POOL_BUFSIZE bytes and PBUF_RAM
+ * allocations to the MEM_SIZE heap, so pool exhaustion behaves as on the
+ * target.
+ */
+
+#ifndef LWIP_HDR_PBUF_H
+#define LWIP_HDR_PBUF_H
+
+#include "lwip/opt.h"
+#include "lwip/err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PBUF_TRANSPORT_HLEN 20
+#define PBUF_IP_HLEN        20
+
+/** Header space reserved in front of the payload, as in lwIP 2.1 */
+typedef enum {
+  PBUF_TRANSPORT = PBUF_LINK_ENCAPSULATION_HLEN + PBUF_LINK_HLEN + PBUF_IP_HLEN + PBUF_TRANSPORT_HLEN,
+  PBUF_IP = PBUF_LINK_ENCAPSULATION_HLEN + PBUF_LINK_HLEN + PBUF_IP_HLEN,
+  PBUF_LINK = PBUF_LINK_ENCAPSULATION_HLEN + PBUF_LINK_HLEN,
+  PBUF_RAW_TX = PBUF_LINK_ENCAPSULATION_HLEN,
+  PBUF_RAW = 0
+} pbuf_layer;
+
+typedef enum {
+  PBUF_RAM,   /**< Payload allocated from the heap, contiguous with the pbuf */
+  PBUF_ROM,   /**< Payload by reference, never changes */
+  PBUF_REF,   /**< Payload by reference, may change */
+  PBUF_POOL   /**< Payload in a buffer of the pbuf pool */
+} pbuf_type;
+
+/** The last data pbuf of a segment, push to the application */
+#define PBUF_FLAG_PUSH      0x01U
+/** The packet carried a TCP FIN */
+#define PBUF_FLAG_TCP_FIN   0x20U
+
+struct pbuf {
+  struct pbuf *next;
+  void *payload;
+  u16_t tot_len;
+  u16_t len;
+  u8_t type_internal;
+  u8_t flags;
+  u8_t ref;
+  u8_t if_idx;
+};
+
+struct pbuf *pbuf_alloc(pbuf_layer l, u16_t length, pbuf_type type);
+void pbuf_realloc(struct pbuf *p, u16_t size);
+u8_t pbuf_add_header(struct pbuf *p, size_t header_size_increment);
+u8_t pbuf_remove_header(struct pbuf *p, size_t header_size);
+u8_t pbuf_header(struct pbuf *p, s16_t header_size);
+struct pbuf *pbuf_free_header(struct pbuf *q, u16_t size);
+void pbuf_ref(struct pbuf *p);
+u8_t pbuf_free(struct pbuf *p);
+u16_t pbuf_clen(const struct pbuf *p);
+void pbuf_cat(struct pbuf *head, struct pbuf *tail);
+void pbuf_chain(struct pbuf *head, struct pbuf *tail);
+u16_t pbuf_copy_partial(const struct pbuf *p, void *dataptr, u16_t len, u16_t offset);
+err_t pbuf_take(struct pbuf *buf, const void *dataptr, u16_t len);
+u8_t pbuf_get_at(const struct pbuf *p, u16_t offset);
+u16_t pbuf_memcmp(const struct pbuf *p, u16_t offset, const void *s2, u16_t n);
+u16_t pbuf_memfind(const struct pbuf *p, const void *mem, u16_t mem_len, u16_t start_offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_PBUF_H */
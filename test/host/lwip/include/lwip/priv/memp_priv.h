@@ -0,0 +1,37 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's pool descriptors.
+ */
+
+#ifndef LWIP_HDR_MEMP_PRIV_H
+#define LWIP_HDR_MEMP_PRIV_H
+
+#include "lwip/opt.h"
+#include "lwip/mem.h"
+#include "lwip/memp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** No overflow check area in front of the elements (MEMP_OVERFLOW_CHECK 0) */
+#define MEMP_SIZE           0
+#define MEMP_ALIGN_SIZE(x)  (LWIP_MEM_ALIGN_SIZE(x))
+
+struct stats_mem;
+
+/** Memory pool descriptor */
+struct memp_desc {
+  const char *desc;           /**< Textual description */
+  struct stats_mem *stats;    /**< Statistics */
+  u16_t size;                 /**< Element size */
+  u16_t num;                  /**< Number of elements */
+};
+
+extern const struct memp_desc *const memp_pools[MEMP_MAX];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_MEMP_PRIV_H */
@@ -0,0 +1,26 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's pool list.
+ *
+ * Include with LWIP_MEMPOOL(name, num, size, desc) defined, as lwIP's
+ * memp_std.h. Lists the pools the stand-in stack allocates from, with the
+ * element sizes of the host structures; pools the port's configuration
+ * would add on the target (UDP PCBs, IP reassembly) are not modelled.
+ */
+
+#ifndef LWIP_PBUF_MEMPOOL
+#define LWIP_PBUF_MEMPOOL(name, num, payload, desc) \
+  LWIP_MEMPOOL(name, num, (LWIP_MEM_ALIGN_SIZE(sizeof(struct pbuf)) + LWIP_MEM_ALIGN_SIZE(payload)), desc)
+#endif
+
+#if LWIP_TCP
+LWIP_MEMPOOL(TCP_PCB,        MEMP_NUM_TCP_PCB,         sizeof(struct tcp_pcb),  "TCP_PCB")
+LWIP_MEMPOOL(TCP_PCB_LISTEN, MEMP_NUM_TCP_PCB_LISTEN,  sizeof(struct tcp_pcb),  "TCP_PCB_LISTEN")
+LWIP_MEMPOOL(TCP_SEG,        MEMP_NUM_TCP_SEG,         sizeof(struct tcp_seg),  "TCP_SEG")
+#endif
+LWIP_MEMPOOL(PBUF,           MEMP_NUM_PBUF,            sizeof(struct pbuf),     "PBUF_REF/ROM")
+LWIP_PBUF_MEMPOOL(PBUF_POOL, PBUF_POOL_SIZE,           PBUF_POOL_BUFSIZE,       "PBUF_POOL")
+LWIP_MEMPOOL(SYS_TIMEOUT,    MEMP_NUM_SYS_TIMEOUT,     sizeof(struct sys_timeo), "SYS_TMR")
+
+#undef LWIP_MEMPOOL
+#undef LWIP_PBUF_MEMPOOL
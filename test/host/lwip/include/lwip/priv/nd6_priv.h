@@ -0,0 +1,11 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's IPv6 neighbor discovery internals (LWIP_IPV6 is off).
+ */
+
+#ifndef LWIP_HDR_ND6_PRIV_H
+#define LWIP_HDR_ND6_PRIV_H
+
+#include "lwip/opt.h"
+
+#endif /* LWIP_HDR_ND6_PRIV_H */
@@ -0,0 +1,23 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's MIB2 hooks.
+ *
+ * With MIB2_STATS, the netif counters are kept as in lwIP; the interface
+ * type and speed are not modelled.
+ */
+
+#ifndef LWIP_HDR_SNMP_H
+#define LWIP_HDR_SNMP_H
+
+#include "lwip/opt.h"
+
+#define MIB2_INIT_NETIF(netif, type, speed)
+#if MIB2_STATS
+#define MIB2_STATS_NETIF_ADD(n, x, val) do { (n)->mib2_counters.x += (val); } while (0)
+#define MIB2_STATS_NETIF_INC(n, x)      do { ++(n)->mib2_counters.x; } while (0)
+#else
+#define MIB2_STATS_NETIF_ADD(n, x, val)
+#define MIB2_STATS_NETIF_INC(n, x)
+#endif
+
+#endif /* LWIP_HDR_SNMP_H */
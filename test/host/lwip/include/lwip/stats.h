@@ -0,0 +1,86 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's statistics.
+ */
+
+#ifndef LWIP_HDR_STATS_H
+#define LWIP_HDR_STATS_H
+
+#include "lwip/opt.h"
+#include "lwip/mem.h"
+#include "lwip/memp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct stats_proto {
+  u16_t xmit;
+  u16_t recv;
+  u16_t fw;
+  u16_t drop;
+  u16_t chkerr;
+  u16_t lenerr;
+  u16_t memerr;
+  u16_t rterr;
+  u16_t proterr;
+  u16_t opterr;
+  u16_t err;
+  u16_t cachehit;
+};
+
+struct stats_mem {
+  const char *name;
+  u16_t err;
+  mem_size_t avail;
+  mem_size_t used;
+  mem_size_t max;
+  u16_t illegal;
+};
+
+/**
+ * @brief MIB2 counters of a network interface, kept with MIB2_STATS.
+ */
+struct stats_mib2_netif_ctrs {
+  u32_t ifinoctets;
+  u32_t ifinucastpkts;
+  u32_t ifinnucastpkts;
+  u32_t ifindiscards;
+  u32_t ifinerrors;
+  u32_t ifinunknownprotos;
+  u32_t ifoutoctets;
+  u32_t ifoutucastpkts;
+  u32_t ifoutnucastpkts;
+  u32_t ifoutdiscards;
+  u32_t ifouterrors;
+};
+
+struct stats_ {
+  struct stats_proto link;
+  struct stats_proto etharp;
+  struct stats_proto ip;
+  struct stats_proto tcp;
+  struct stats_mem mem;
+  struct stats_mem *memp[MEMP_MAX];
+};
+
+extern struct stats_ lwip_stats;
+
+#define STATS_INC(x) ++lwip_stats.x
+#define STATS_DEC(x) --lwip_stats.x
+
+#if LINK_STATS
+#define LINK_STATS_INC(x) STATS_INC(x)
+#else
+#define LINK_STATS_INC(x)
+#endif
+
+#define ETHARP_STATS_INC(x) STATS_INC(x)
+#define IP_STATS_INC(x) STATS_INC(x)
+#define TCP_STATS_INC(x) STATS_INC(x)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_STATS_H */
@@ -0,0 +1,32 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's system abstraction (NO_SYS).
+ *
+ * Implemented by the simulated clock in sim/sim.c.
+ */
+
+#ifndef LWIP_HDR_SYS_H
+#define LWIP_HDR_SYS_H
+
+#include "lwip/opt.h"
+#include "lwip/arch.h"
+#include "arch/sys_arch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+u32_t sys_now(void);
+
+sys_prot_t sys_arch_protect(void);
+void sys_arch_unprotect(sys_prot_t pval);
+
+#define SYS_ARCH_DECL_PROTECT(lev) sys_prot_t lev
+#define SYS_ARCH_PROTECT(lev) lev = sys_arch_protect()
+#define SYS_ARCH_UNPROTECT(lev) sys_arch_unprotect(lev)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_SYS_H */
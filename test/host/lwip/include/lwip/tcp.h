@@ -0,0 +1,183 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's TCP raw API.
+ *
+ * Same API and PCB fields as lwIP 2.1; see host_priv.h for what the
+ * implementation leaves out.
+ */
+
+#ifndef LWIP_HDR_TCP_H
+#define LWIP_HDR_TCP_H
+
+#include "lwip/opt.h"
+
+#if LWIP_TCP
+
+#include "lwip/mem.h"
+#include "lwip/pbuf.h"
+#include "lwip/ip_addr.h"
+#include "lwip/err.h"
+#include "lwip/prot/tcp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct tcp_pcb;
+struct tcp_seg;
+
+typedef err_t (*tcp_accept_fn)(void *arg, struct tcp_pcb *newpcb, err_t err);
+typedef err_t (*tcp_recv_fn)(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err);
+typedef err_t (*tcp_sent_fn)(void *arg, struct tcp_pcb *tpcb, u16_t len);
+typedef err_t (*tcp_poll_fn)(void *arg, struct tcp_pcb *tpcb);
+typedef void  (*tcp_err_fn)(void *arg, err_t err);
+typedef err_t (*tcp_connected_fn)(void *arg, struct tcp_pcb *tpcb, err_t err);
+
+enum tcp_state {
+  CLOSED      = 0,
+  LISTEN      = 1,
+  SYN_SENT    = 2,
+  SYN_RCVD    = 3,
+  ESTABLISHED = 4,
+  FIN_WAIT_1  = 5,
+  FIN_WAIT_2  = 6,
+  CLOSE_WAIT  = 7,
+  CLOSING     = 8,
+  LAST_ACK    = 9,
+  TIME_WAIT   = 10
+};
+
+typedef u16_t tcpwnd_size_t;
+typedef u16_t tcpflags_t;
+
+#define TF_ACK_DELAY   0x01U   /* Delayed ACK. */
+#define TF_ACK_NOW     0x02U   /* Immediate ACK. */
+#define TF_INFR        0x04U   /* In fast recovery. */
+#define TF_CLOSEPEND   0x08U   /* If this is set, tcp_close failed to enqueue the FIN (retried in tcp_tmr) */
+#define TF_RXCLOSED    0x10U   /* rx closed by tcp_shutdown */
+#define TF_FIN         0x20U   /* Connection was closed locally (FIN segment enqueued). */
+#define TF_NODELAY     0x40U   /* Disable Nagle algorithm */
+#define TF_NAGLEMEMERR 0x80U   /* nagle enabled, memerr, try to output to prevent delayed ACK to happen */
+#define TF_RTO         0x0800U /* RTO timer has fired, in-flight data moved to unsent and being retransmitted */
+
+#define TCP_PRIO_MIN    1
+#define TCP_PRIO_NORMAL 64
+#define TCP_PRIO_MAX    127
+
+#define TCP_WRITE_FLAG_COPY 0x01
+#define TCP_WRITE_FLAG_MORE 0x02
+
+struct tcp_pcb {
+  /* IP_PCB */
+  ip_addr_t local_ip;
+  ip_addr_t remote_ip;
+  u8_t netif_idx;
+  u8_t so_options;
+  u8_t tos;
+  u8_t ttl;
+
+  /* TCP_PCB_COMMON */
+  struct tcp_pcb *next;
+  void *callback_arg;
+  enum tcp_state state;
+  u8_t prio;
+  u16_t local_port;
+
+  /* Listening PCBs only */
+  tcp_accept_fn accept;
+
+  u16_t remote_port;
+  tcpflags_t flags;
+
+  /* the rest of the fields are in host byte order */
+  u8_t polltmr, pollinterval;
+  u8_t last_timer;
+  u32_t tmr;
+
+  /* receiver variables */
+  u32_t rcv_nxt;
+  tcpwnd_size_t rcv_wnd;
+  tcpwnd_size_t rcv_ann_wnd;
+  u32_t rcv_ann_right_edge;
+
+  /* Retransmission timer. */
+  s16_t rtime;
+  u16_t mss;
+
+  /* RTT (round trip time) estimation variables */
+  u32_t rttest;
+  u32_t rtseq;
+  s16_t sa, sv;
+  s16_t rto;
+  u8_t nrtx;
+
+  /* fast retransmit/recovery */
+  u8_t dupacks;
+  u32_t lastack;
+
+  /* congestion avoidance/control variables */
+  tcpwnd_size_t cwnd;
+  tcpwnd_size_t ssthresh;
+  u32_t rto_end;
+
+  /* sender variables */
+  u32_t snd_nxt;
+  u32_t snd_wl1, snd_wl2;
+  u32_t snd_lbb;
+  tcpwnd_size_t snd_wnd;
+  tcpwnd_size_t snd_wnd_max;
+  tcpwnd_size_t snd_buf;
+  u16_t snd_queuelen;
+  u16_t unsent_oversize;
+  tcpwnd_size_t bytes_acked;
+
+  struct tcp_seg *unsent;
+  struct tcp_seg *unacked;
+  struct pbuf *refused_data;
+
+  struct tcp_pcb *listener;     /**< Listening PCB of a connection in SYN_RCVD */
+
+  tcp_sent_fn sent;
+  tcp_recv_fn recv;
+  tcp_connected_fn connected;
+  tcp_poll_fn poll;
+  tcp_err_fn errf;
+};
+
+struct tcp_pcb *tcp_new(void);
+struct tcp_pcb *tcp_new_ip_type(u8_t type);
+
+void tcp_arg(struct tcp_pcb *pcb, void *arg);
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv);
+void tcp_sent(struct tcp_pcb *pcb, tcp_sent_fn sent);
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn err);
+void tcp_accept(struct tcp_pcb *pcb, tcp_accept_fn accept);
+void tcp_poll(struct tcp_pcb *pcb, tcp_poll_fn poll, u8_t interval);
+
+#define tcp_mss(pcb)             ((pcb)->mss)
+#define tcp_sndbuf(pcb)          ((tcpwnd_size_t)(pcb)->snd_buf)
+#define tcp_sndqueuelen(pcb)     ((pcb)->snd_queuelen)
+#define tcp_nagle_disable(pcb)   ((pcb)->flags = (tcpflags_t)((pcb)->flags | TF_NODELAY))
+#define tcp_nagle_enable(pcb)    ((pcb)->flags = (tcpflags_t)((pcb)->flags & ~TF_NODELAY))
+#define tcp_nagle_disabled(pcb)  (((pcb)->flags & TF_NODELAY) != 0)
+
+void tcp_recved(struct tcp_pcb *pcb, u16_t len);
+err_t tcp_bind(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port);
+struct tcp_pcb *tcp_listen_with_backlog_and_err(struct tcp_pcb *pcb, u8_t backlog, err_t *err);
+struct tcp_pcb *tcp_listen_with_backlog(struct tcp_pcb *pcb, u8_t backlog);
+#define tcp_listen(pcb) tcp_listen_with_backlog(pcb, TCP_DEFAULT_LISTEN_BACKLOG)
+
+void tcp_abort(struct tcp_pcb *pcb);
+err_t tcp_close(struct tcp_pcb *pcb);
+err_t tcp_shutdown(struct tcp_pcb *pcb, int shut_rx, int shut_tx);
+
+err_t tcp_write(struct tcp_pcb *pcb, const void *dataptr, u16_t len, u8_t apiflags);
+err_t tcp_output(struct tcp_pcb *pcb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_TCP */
+
+#endif /* LWIP_HDR_TCP_H */
@@ -0,0 +1,40 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's timeouts (NO_SYS).
+ */
+
+#ifndef LWIP_HDR_TIMEOUTS_H
+#define LWIP_HDR_TIMEOUTS_H
+
+#include "lwip/opt.h"
+#include "lwip/err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYS_TIMEOUTS_SLEEPTIME_INFINITE 0xFFFFFFFF
+
+#define LWIP_NUM_SYS_TIMEOUT_INTERNAL (LWIP_TCP + LWIP_ARP + (2 * LWIP_DHCP))
+
+typedef void (*sys_timeout_handler)(void *arg);
+
+/** Pending timeout, kept in a list sorted by due time */
+struct sys_timeo {
+  struct sys_timeo *next;
+  u32_t time;
+  sys_timeout_handler h;
+  void *arg;
+};
+
+void sys_timeouts_init(void);
+void sys_timeout(u32_t msecs, sys_timeout_handler handler, void *arg);
+void sys_untimeout(sys_timeout_handler handler, void *arg);
+void sys_check_timeouts(void);
+u32_t sys_timeouts_sleeptime(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_TIMEOUTS_H */
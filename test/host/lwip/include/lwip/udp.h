@@ -0,0 +1,11 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's UDP API (only the DHCP client uses UDP, see ip4.c).
+ */
+
+#ifndef LWIP_HDR_UDP_H
+#define LWIP_HDR_UDP_H
+
+#include "lwip/opt.h"
+
+#endif /* LWIP_HDR_UDP_H */
@@ -0,0 +1,11 @@
+/**
+ * @file
+ * @brief Host stand-in for lwIP's PPPoE header (PPPOE_SUPPORT is off).
+ */
+
+#ifndef LWIP_HDR_NETIF_PPP_PPPOE_H
+#define LWIP_HDR_NETIF_PPP_PPPOE_H
+
+#include "lwip/opt.h"
+
+#endif /* LWIP_HDR_NETIF_PPP_PPPOE_H */
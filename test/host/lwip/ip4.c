@@ -0,0 +1,199 @@
+/**
+ * @file
+ * @brief Stand-in lwIP IPv4 and UDP layers.
+ *
+ * Validates and dispatches received packets to TCP and to the DHCP client,
+ * the only UDP user of the port. Fragments, options and ICMP are dropped.
+ */
+
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/def.h"
+#include "lwip/pbuf.h"
+#include "lwip/stats.h"
+#include "lwip/netif.h"
+#include "lwip/inet_chksum.h"
+#include "lwip/prot/ip.h"
+#include "lwip/prot/ip4.h"
+#include "lwip/prot/udp.h"
+#include "lwip/prot/dhcp.h"
+
+#include "host_priv.h"
+
+struct ip_globals ip_data;
+static u16_t ip_id;
+
+void ip4_reset(void)
+{
+  memset(&ip_data, 0, sizeof(ip_data));
+  ip_id = 0;
+}
+
+/**
+ * @brief UDP input: only the DHCP client port is open.
+ */
+static void udp_input(struct pbuf *p, struct netif *inp)
+{
+  if (p->len < UDP_HLEN) {
+    pbuf_free(p);
+    return;
+  }
+  struct udp_hdr *udphdr = (struct udp_hdr *)p->payload;
+  if (udphdr->chksum != 0 &&
+      inet_chksum_pseudo(p, IP_PROTO_UDP, p->tot_len, ip4_current_src_addr(), ip4_current_dest_addr()) != 0) {
+    pbuf_free(p);
+    return;
+  }
+#if LWIP_DHCP
+  if (udphdr->dest == PP_HTONS(DHCP_CLIENT_PORT) && udphdr->src == PP_HTONS(DHCP_SERVER_PORT)) {
+    pbuf_remove_header(p, UDP_HLEN);
+    dhcp_recv(p, inp);
+    return;
+  }
+#else
+  LWIP_UNUSED_ARG(inp);
+#endif
+  pbuf_free(p);
+}
+
+err_t ip4_input(struct pbuf *p, struct netif *inp)
+{
+  struct ip_hdr *iphdr = (struct ip_hdr *)p->payload;
+
+  if (p->len < IP_HLEN || IPH_V(iphdr) != 4) {
+    IP_STATS_INC(ip.err);
+    pbuf_free(p);
+    return ERR_OK;
+  }
+  u16_t iphdr_hlen = IPH_HL_BYTES(iphdr);
+  u16_t iphdr_len = lwip_ntohs(IPH_LEN(iphdr));
+  if (iphdr_len < p->tot_len) {
+    pbuf_realloc(p, iphdr_len);
+  }
+  if (iphdr_hlen != IP_HLEN || iphdr_hlen > p->len || iphdr_len > p->tot_len) {
+    IP_STATS_INC(ip.lenerr);
+    pbuf_free(p);
+    return ERR_OK;
+  }
+  if (inet_chksum(iphdr, iphdr_hlen) != 0) {
+    IP_STATS_INC(ip.chkerr);
+    pbuf_free(p);
+    return ERR_OK;
+  }
+  if ((IPH_OFFSET(iphdr) & PP_HTONS(IP_OFFMASK | IP_MF)) != 0) {
+    IP_STATS_INC(ip.opterr);
+    pbuf_free(p);
+    return ERR_OK;
+  }
+
+  ip4_addr_copy(ip_data.current_iphdr_dest, iphdr->dest);
+  ip4_addr_copy(ip_data.current_iphdr_src, iphdr->src);
+
+  /* Accept packets to our address or broadcast; DHCP replies also before we have one */
+  int for_us = netif_is_up(inp) &&
+               ((!ip4_addr_isany_val(*netif_ip4_addr(inp)) &&
+                 ip4_addr_cmp(ip4_current_dest_addr(), netif_ip4_addr(inp))) ||
+                ip4_addr_isbroadcast(ip4_current_dest_addr(), inp));
+  if (!for_us && IPH_PROTO(iphdr) == IP_PROTO_UDP && p->len >= iphdr_hlen + UDP_HLEN) {
+    struct udp_hdr *udphdr = (struct udp_hdr *)((u8_t *)iphdr + iphdr_hlen);
+    for_us = udphdr->dest == PP_HTONS(DHCP_CLIENT_PORT);
+  }
+  if (!for_us) {
+    IP_STATS_INC(ip.drop);
+    pbuf_free(p);
+    return ERR_OK;
+  }
+
+  ip_data.current_netif = inp;
+  ip_data.current_ip4_header = iphdr;
+  ip_data.current_ip_header_tot_len = iphdr_hlen;
+
+  pbuf_remove_header(p, iphdr_hlen);
+  switch (IPH_PROTO(iphdr)) {
+#if LWIP_TCP
+    case IP_PROTO_TCP:
+      tcp_input(p, inp);
+      break;
+#endif
+    case IP_PROTO_UDP:
+      udp_input(p, inp);
+      break;
+    default:
+      IP_STATS_INC(ip.proterr);
+      pbuf_free(p);
+      break;
+  }
+
+  ip_data.current_netif = NULL;
+  ip_data.current_ip4_header = NULL;
+  ip_data.current_ip_header_tot_len = 0;
+  ip4_addr_set_any(&ip_data.current_iphdr_src);
+  ip4_addr_set_any(&ip_data.current_iphdr_dest);
+  return ERR_OK;
+}
+
+err_t ip4_output_if(struct pbuf *p, const ip4_addr_t *src, const ip4_addr_t *dest,
+                    u8_t ttl, u8_t tos, u8_t proto, struct netif *netif)
+{
+  if (src == NULL || ip4_addr_isany(src)) {
+    src = netif_ip4_addr(netif);
+  }
+  return ip4_output_if_src(p, src, dest, ttl, tos, proto, netif);
+}
+
+err_t ip4_output_if_src(struct pbuf *p, const ip4_addr_t *src, const ip4_addr_t *dest,
+                        u8_t ttl, u8_t tos, u8_t proto, struct netif *netif)
+{
+  if (pbuf_add_header(p, IP_HLEN)) {
+    IP_STATS_INC(ip.err);
+    return ERR_BUF;
+  }
+  struct ip_hdr *iphdr = (struct ip_hdr *)p->payload;
+  IPH_TTL_SET(iphdr, ttl);
+  IPH_PROTO_SET(iphdr, proto);
+  ip4_addr_copy(iphdr->dest, *dest);
+  IPH_VHL_SET(iphdr, 4, IP_HLEN / 4);
+  IPH_TOS_SET(iphdr, tos);
+  IPH_LEN_SET(iphdr, lwip_htons(p->tot_len));
+  IPH_OFFSET_SET(iphdr, 0);
+  IPH_ID_SET(iphdr, lwip_htons(ip_id));
+  ++ip_id;
+  ip4_addr_copy(iphdr->src, *src);
+  IPH_CHKSUM_SET(iphdr, 0);
+  IPH_CHKSUM_SET(iphdr, inet_chksum(iphdr, IP_HLEN));
+
+  IP_STATS_INC(ip.xmit);
+  return netif->output(netif, p, dest);
+}
+
+err_t ip4_output(struct pbuf *p, const ip4_addr_t *src, const ip4_addr_t *dest,
+                 u8_t ttl, u8_t tos, u8_t proto)
+{
+  struct netif *netif = ip4_route(dest);
+  if (netif == NULL) {
+    IP_STATS_INC(ip.rterr);
+    return ERR_RTE;
+  }
+  return ip4_output_if(p, src, dest, ttl, tos, proto, netif);
+}
+
+err_t udp_sendto_if_raw(struct netif *netif, struct pbuf *p, const ip4_addr_t *src, u16_t src_port,
+                        const ip4_addr_t *dest, u16_t dest_port)
+{
+  if (pbuf_add_header(p, UDP_HLEN)) {
+    return ERR_BUF;
+  }
+  struct udp_hdr *udphdr = (struct udp_hdr *)p->payload;
+  udphdr->src = lwip_htons(src_port);
+  udphdr->dest = lwip_htons(dest_port);
+  udphdr->len = lwip_htons(p->tot_len);
+  udphdr->chksum = 0;
+
+  ip4_addr_t src_addr;
+  ip4_addr_set(&src_addr, src);
+  u16_t chksum = inet_chksum_pseudo(p, IP_PROTO_UDP, p->tot_len, &src_addr, dest);
+  udphdr->chksum = chksum == 0 ? 0xffff : chksum;
+
+  return ip4_output_if_src(p, &src_addr, dest, IP_DEFAULT_TTL, 0, IP_PROTO_UDP, netif);
+}
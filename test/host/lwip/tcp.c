@@ -0,0 +1,2179 @@
+/**
+ * @file
+ * @brief Stand-in lwIP TCP: PCBs, output, input and timers.
+ *
+ * Follows lwIP 2.1's tcp.c, tcp_out.c and tcp_in.c closely: writes are
+ * queued into segments the same way (so TCP_SND_QUEUELEN, MEMP_NUM_TCP_SEG,
+ * the pbuf oversize and TCP_WRITE_FLAG_MORE behave as on the target), with
+ * Nagle, delayed ACKs, slow start and congestion avoidance, fast
+ * retransmit, RTO backoff and the PCB reuse order when the pool runs out.
+ *
+ * Left out: active open (the port only listens), the out-of-order queue
+ * (such segments are dropped and re-ACKed), the persist timer, keepalive
+ * and window scaling.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/def.h"
+#include "lwip/memp.h"
+#include "lwip/pbuf.h"
+#include "lwip/stats.h"
+#include "lwip/netif.h"
+#include "lwip/inet_chksum.h"
+#include "lwip/tcp.h"
+#include "lwip/priv/tcp_priv.h"
+#include "lwip/prot/ip.h"
+
+#include "host_priv.h"
+#include "sim.h"
+
+struct tcp_pcb *tcp_bound_pcbs;
+struct tcp_pcb *tcp_listen_pcbs;
+struct tcp_pcb *tcp_active_pcbs;
+struct tcp_pcb *tcp_tw_pcbs;
+
+static struct tcp_pcb *tcp_input_pcb;
+static u32_t tcp_ticks;
+static u8_t tcp_timer;
+static u8_t tcp_timer_ctr;
+static u8_t tcp_active_pcbs_changed;
+static u16_t tcp_port;
+static u32_t tcp_iss;
+
+/* Incoming segment, as the globals of lwIP's tcp_in.c */
+static struct tcp_seg inseg;
+static struct tcp_hdr *tcphdr;
+static u16_t tcphdr_optlen;
+static u32_t seqno, ackno;
+static tcpwnd_size_t recv_acked;
+static u16_t tcplen;
+static u8_t flags;
+static u8_t recv_flags;
+static struct pbuf *recv_data;
+
+#define TF_RESET     (u8_t)0x08U   /* Connection was reset. */
+#define TF_CLOSED    (u8_t)0x10U   /* Connection was successfully closed. */
+#define TF_GOT_FIN   (u8_t)0x20U   /* Connection was closed by the remote end. */
+
+static const u8_t tcp_backoff[13] = { 1, 2, 3, 4, 5, 6, 7, 7, 7, 7, 7, 7, 7};
+
+#define tcp_set_flags(pcb, set_flags)   do { (pcb)->flags = (tcpflags_t)((pcb)->flags | (set_flags)); } while (0)
+#define tcp_clear_flags(pcb, clr_flags) do { (pcb)->flags = (tcpflags_t)((pcb)->flags & (tcpflags_t)(~(clr_flags))); } while (0)
+#define tcp_ack_now(pcb)                tcp_set_flags(pcb, TF_ACK_NOW)
+
+#define TCP_WND_MAX(pcb)                ((tcpwnd_size_t)TCP_WND)
+#define TCP_WND_INC(wnd, inc)           do { \
+    if ((tcpwnd_size_t)((wnd) + (inc)) >= (wnd)) { (wnd) = (tcpwnd_size_t)((wnd) + (inc)); } \
+    else { (wnd) = (tcpwnd_size_t)-1; } } while (0)
+#define LWIP_TCP_CALC_INITIAL_CWND(mss) ((tcpwnd_size_t)LWIP_MIN((4U * (mss)), LWIP_MAX((2U * (mss)), 4380U)))
+#define TCP_OVERSIZE_CALC_LENGTH(length) ((length) + TCP_MSS)
+
+#define tcp_do_output_nagle(tpcb) ((((tpcb)->unacked == NULL) || \
+                            ((tpcb)->flags & (TF_NODELAY | TF_INFR)) || \
+                            (((tpcb)->unsent != NULL) && (((tpcb)->unsent->next != NULL) || \
+                              ((tpcb)->unsent->len >= (tpcb)->mss))) || \
+                            ((tcp_sndbuf(tpcb) == 0) || (tcp_sndqueuelen(tpcb) >= TCP_SND_QUEUELEN)) \
+                            ) ? 1 : 0)
+
+#define TCP_REG(pcbs, npcb) do { (npcb)->next = *(pcbs); *(pcbs) = (npcb); tcp_timer_needed(); } while (0)
+#define TCP_RMV(pcbs, npcb) do { \
+    if (*(pcbs) == (npcb)) { *(pcbs) = (*(pcbs))->next; } \
+    else { for (struct tcp_pcb *tcp_tmp_pcb = *(pcbs); tcp_tmp_pcb != NULL; tcp_tmp_pcb = tcp_tmp_pcb->next) { \
+        if (tcp_tmp_pcb->next == (npcb)) { tcp_tmp_pcb->next = (npcb)->next; break; } } } \
+    (npcb)->next = NULL; } while (0)
+#define TCP_REG_ACTIVE(npcb)        do { TCP_REG(&tcp_active_pcbs, npcb); tcp_active_pcbs_changed = 1; } while (0)
+#define TCP_RMV_ACTIVE(npcb)        do { TCP_RMV(&tcp_active_pcbs, npcb); tcp_active_pcbs_changed = 1; } while (0)
+#define TCP_PCB_REMOVE_ACTIVE(pcb)  do { tcp_pcb_remove(&tcp_active_pcbs, pcb); tcp_active_pcbs_changed = 1; } while (0)
+
+/* Application callbacks, each charged as one dispatch on the target */
+
+#define TCP_EVENT_ACCEPT(lpcb, pcb, arg, err, ret) do { \
+    sim_advance(SIM_CPU_CALLBACK_NS); \
+    if ((lpcb)->accept != NULL) { (ret) = (lpcb)->accept((arg), (pcb), (err)); } \
+    else { (ret) = ERR_ARG; } } while (0)
+#define TCP_EVENT_SENT(pcb, space, ret) do { \
+    if ((pcb)->sent != NULL) { sim_advance(SIM_CPU_CALLBACK_NS); (ret) = (pcb)->sent((pcb)->callback_arg, (pcb), (space)); } \
+    else { (ret) = ERR_OK; } } while (0)
+#define TCP_EVENT_RECV(pcb, p, err, ret) do { \
+    sim_advance(SIM_CPU_CALLBACK_NS); \
+    if ((pcb)->recv != NULL) { (ret) = (pcb)->recv((pcb)->callback_arg, (pcb), (p), (err)); } \
+    else { (ret) = tcp_recv_null(NULL, (pcb), (p), (err)); } } while (0)
+#define TCP_EVENT_CLOSED(pcb, ret) do { \
+    if ((pcb)->recv != NULL) { sim_advance(SIM_CPU_CALLBACK_NS); (ret) = (pcb)->recv((pcb)->callback_arg, (pcb), NULL, ERR_OK); } \
+    else { (ret) = ERR_OK; } } while (0)
+#define TCP_EVENT_POLL(pcb, ret) do { \
+    if ((pcb)->poll != NULL) { sim_advance(SIM_CPU_CALLBACK_NS); (ret) = (pcb)->poll((pcb)->callback_arg, (pcb)); } \
+    else { (ret) = ERR_OK; } } while (0)
+#define TCP_EVENT_ERR(errf, arg, err) do { \
+    if ((errf) != NULL) { sim_advance(SIM_CPU_CALLBACK_NS); (errf)((arg), (err)); } } while (0)
+
+static err_t tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb, struct netif *netif);
+static err_t tcp_send_empty_ack(struct tcp_pcb *pcb);
+static err_t tcp_close_shutdown_fin(struct tcp_pcb *pcb);
+static void tcp_pcb_remove(struct tcp_pcb **pcblist, struct tcp_pcb *pcb);
+static void tcp_pcb_purge(struct tcp_pcb *pcb);
+static void tcp_abandon(struct tcp_pcb *pcb, int reset);
+
+/* Segments and PCBs */
+
+static struct tcp_seg *tcp_seg_alloc(void)
+{
+  if (!memp_take(MEMP_TCP_SEG)) {
+    return NULL;
+  }
+  struct tcp_seg *seg = (struct tcp_seg *)calloc(1, sizeof(*seg));
+  if (seg == NULL) {
+    abort();
+  }
+  return seg;
+}
+
+static void tcp_seg_free(struct tcp_seg *seg)
+{
+  if (seg != NULL) {
+    if (seg->p != NULL) {
+      pbuf_free(seg->p);
+    }
+    free(seg);
+    memp_give(MEMP_TCP_SEG);
+  }
+}
+
+static void tcp_segs_free(struct tcp_seg *seg)
+{
+  while (seg != NULL) {
+    struct tcp_seg *next = seg->next;
+    tcp_seg_free(seg);
+    seg = next;
+  }
+}
+
+static int tcp_output_segment_busy(const struct tcp_seg *seg)
+{
+  /* The pbuf is still queued by the driver or ARP */
+  return seg->p->ref != 1;
+}
+
+static void tcp_free(struct tcp_pcb *pcb)
+{
+  free(pcb);
+  memp_give(MEMP_TCP_PCB);
+}
+
+static void tcp_free_listen(struct tcp_pcb *pcb)
+{
+  free(pcb);
+  memp_give(MEMP_TCP_PCB_LISTEN);
+}
+
+static u32_t tcp_next_iss(void)
+{
+  tcp_iss += tcp_ticks;
+  return tcp_iss;
+}
+
+static u16_t tcp_eff_send_mss(u16_t sendmss, const ip_addr_t *dest)
+{
+  struct netif *netif = ip4_route(dest);
+  if (netif != NULL && netif->mtu != 0) {
+    u16_t mss_s = (u16_t)(netif->mtu - IP_HLEN - TCP_HLEN);
+    sendmss = LWIP_MIN(sendmss, mss_s);
+  }
+  return sendmss;
+}
+
+static void tcp_kill_prio(u8_t prio)
+{
+  u8_t mprio = LWIP_MIN(TCP_PRIO_MAX, prio);
+  if (mprio == 0) {
+    return;
+  }
+  mprio--;
+
+  u32_t inactivity = 0;
+  struct tcp_pcb *inactive = NULL;
+  for (struct tcp_pcb *pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next) {
+    if ((pcb->prio < mprio) ||
+        ((pcb->prio == mprio) && ((u32_t)(tcp_ticks - pcb->tmr) >= inactivity))) {
+      inactivity = tcp_ticks - pcb->tmr;
+      inactive = pcb;
+      mprio = pcb->prio;
+    }
+  }
+  if (inactive != NULL) {
+    tcp_abort(inactive);
+  }
+}
+
+static void tcp_kill_state(enum tcp_state state)
+{
+  u32_t inactivity = 0;
+  struct tcp_pcb *inactive = NULL;
+  for (struct tcp_pcb *pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next) {
+    if (pcb->state == state && (u32_t)(tcp_ticks - pcb->tmr) >= inactivity) {
+      inactivity = tcp_ticks - pcb->tmr;
+      inactive = pcb;
+    }
+  }
+  if (inactive != NULL) {
+    tcp_abandon(inactive, 0);
+  }
+}
+
+static void tcp_kill_timewait(void)
+{
+  u32_t inactivity = 0;
+  struct tcp_pcb *inactive = NULL;
+  for (struct tcp_pcb *pcb = tcp_tw_pcbs; pcb != NULL; pcb = pcb->next) {
+    if ((u32_t)(tcp_ticks - pcb->tmr) >= inactivity) {
+      inactivity = tcp_ticks - pcb->tmr;
+      inactive = pcb;
+    }
+  }
+  if (inactive != NULL) {
+    tcp_abort(inactive);
+  }
+}
+
+static void tcp_handle_closepend(void)
+{
+  struct tcp_pcb *pcb = tcp_active_pcbs;
+  while (pcb != NULL) {
+    struct tcp_pcb *next = pcb->next;
+    if (pcb->flags & TF_CLOSEPEND) {
+      tcp_clear_flags(pcb, TF_CLOSEPEND);
+      tcp_close_shutdown_fin(pcb);
+    }
+    pcb = next;
+  }
+}
+
+static err_t tcp_recv_null(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+  LWIP_UNUSED_ARG(arg);
+  if (p != NULL) {
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+  } else if (err == ERR_OK) {
+    return tcp_close(pcb);
+  }
+  return ERR_OK;
+}
+
+static err_t tcp_accept_null(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+  LWIP_UNUSED_ARG(arg);
+  LWIP_UNUSED_ARG(err);
+  tcp_abort(pcb);
+  return ERR_ABRT;
+}
+
+/**
+ * @brief Allocates a PCB, reclaiming TIME_WAIT, LAST_ACK, CLOSING and then
+ *        lower-priority connections when the pool is empty, as lwIP does.
+ */
+static struct tcp_pcb *tcp_alloc(u8_t prio)
+{
+  int ok = memp_take(MEMP_TCP_PCB);
+  if (!ok) {
+    tcp_handle_closepend();
+    tcp_kill_timewait();
+    ok = memp_take(MEMP_TCP_PCB);
+    if (!ok) {
+      tcp_kill_state(LAST_ACK);
+      ok = memp_take(MEMP_TCP_PCB);
+      if (!ok) {
+        tcp_kill_state(CLOSING);
+        ok = memp_take(MEMP_TCP_PCB);
+        if (!ok) {
+          tcp_kill_prio(prio);
+          ok = memp_take(MEMP_TCP_PCB);
+        }
+      }
+    }
+  }
+  if (!ok) {
+    return NULL;
+  }
+
+  struct tcp_pcb *pcb = (struct tcp_pcb *)calloc(1, sizeof(*pcb));
+  if (pcb == NULL) {
+    abort();
+  }
+  pcb->prio = prio;
+  pcb->snd_buf = TCP_SND_BUF;
+  pcb->rcv_wnd = TCP_WND;
+  pcb->rcv_ann_wnd = TCP_WND;
+  pcb->ttl = TCP_TTL;
+  pcb->mss = TCP_MSS;
+  pcb->rto = 3000 / TCP_SLOW_INTERVAL;
+  pcb->sv = 3000 / TCP_SLOW_INTERVAL;
+  pcb->rtime = -1;
+  pcb->cwnd = 1;
+  pcb->tmr = tcp_ticks;
+  pcb->last_timer = tcp_timer_ctr;
+  pcb->ssthresh = TCP_SND_BUF;
+  pcb->recv = tcp_recv_null;
+  return pcb;
+}
+
+struct tcp_pcb *tcp_new(void)
+{
+  return tcp_alloc(TCP_PRIO_NORMAL);
+}
+
+struct tcp_pcb *tcp_new_ip_type(u8_t type)
+{
+  LWIP_UNUSED_ARG(type);
+  return tcp_new();
+}
+
+void tcp_arg(struct tcp_pcb *pcb, void *arg)
+{
+  if (pcb != NULL) {
+    pcb->callback_arg = arg;
+  }
+}
+
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv)
+{
+  if (pcb != NULL) {
+    pcb->recv = recv;
+  }
+}
+
+void tcp_sent(struct tcp_pcb *pcb, tcp_sent_fn sent)
+{
+  if (pcb != NULL) {
+    pcb->sent = sent;
+  }
+}
+
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn err)
+{
+  if (pcb != NULL) {
+    pcb->errf = err;
+  }
+}
+
+void tcp_accept(struct tcp_pcb *pcb, tcp_accept_fn accept)
+{
+  if (pcb != NULL && pcb->state == LISTEN) {
+    pcb->accept = accept;
+  }
+}
+
+void tcp_poll(struct tcp_pcb *pcb, tcp_poll_fn poll, u8_t interval)
+{
+  if (pcb != NULL) {
+    pcb->poll = poll;
+    pcb->pollinterval = interval;
+  }
+}
+
+static u16_t tcp_new_port(void)
+{
+  if (tcp_port == 0) {
+    tcp_port = 0xc000;
+  }
+again:
+  if (tcp_port++ == 0xffff) {
+    tcp_port = 0xc000;
+  }
+  struct tcp_pcb *const *lists[] = {&tcp_bound_pcbs, &tcp_listen_pcbs, &tcp_active_pcbs, &tcp_tw_pcbs};
+  for (size_t i = 0; i < LWIP_ARRAYSIZE(lists); i++) {
+    for (struct tcp_pcb *pcb = *lists[i]; pcb != NULL; pcb = pcb->next) {
+      if (pcb->local_port == tcp_port) {
+        goto again;
+      }
+    }
+  }
+  return tcp_port;
+}
+
+err_t tcp_bind(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port)
+{
+  if (pcb == NULL || pcb->state != CLOSED) {
+    return ERR_VAL;
+  }
+  if (ipaddr == NULL) {
+    ipaddr = IP_ADDR_ANY;
+  }
+  if (port == 0) {
+    port = tcp_new_port();
+  } else {
+    struct tcp_pcb *const *lists[] = {&tcp_bound_pcbs, &tcp_listen_pcbs, &tcp_active_pcbs};
+    for (size_t i = 0; i < LWIP_ARRAYSIZE(lists); i++) {
+      for (struct tcp_pcb *cpcb = *lists[i]; cpcb != NULL; cpcb = cpcb->next) {
+        if (cpcb->local_port == port &&
+            (ip_addr_isany(&cpcb->local_ip) || ip_addr_isany(ipaddr) ||
+             ip_addr_cmp(&cpcb->local_ip, ipaddr))) {
+          return ERR_USE;
+        }
+      }
+    }
+  }
+  ip_addr_set(&pcb->local_ip, ipaddr);
+  pcb->local_port = port;
+  TCP_REG(&tcp_bound_pcbs, pcb);
+  return ERR_OK;
+}
+
+struct tcp_pcb *tcp_listen_with_backlog_and_err(struct tcp_pcb *pcb, u8_t backlog, err_t *err)
+{
+  LWIP_UNUSED_ARG(backlog);
+  err_t res = ERR_OK;
+  struct tcp_pcb *lpcb = NULL;
+
+  if (pcb->state == LISTEN) {
+    lpcb = pcb;
+    res = ERR_ALREADY;
+    goto done;
+  }
+  if (!memp_take(MEMP_TCP_PCB_LISTEN)) {
+    res = ERR_MEM;
+    goto done;
+  }
+  lpcb = (struct tcp_pcb *)calloc(1, sizeof(*lpcb));
+  if (lpcb == NULL) {
+    abort();
+  }
+  lpcb->callback_arg = pcb->callback_arg;
+  lpcb->local_port = pcb->local_port;
+  lpcb->state = LISTEN;
+  lpcb->prio = pcb->prio;
+  lpcb->so_options = pcb->so_options;
+  lpcb->netif_idx = pcb->netif_idx;
+  lpcb->ttl = pcb->ttl;
+  lpcb->tos = pcb->tos;
+  ip_addr_copy(lpcb->local_ip, pcb->local_ip);
+  if (pcb->local_port != 0) {
+    TCP_RMV(&tcp_bound_pcbs, pcb);
+  }
+  tcp_free(pcb);
+  lpcb->accept = tcp_accept_null;
+  TCP_REG(&tcp_listen_pcbs, lpcb);
+done:
+  if (err != NULL) {
+    *err = res;
+  }
+  return lpcb;
+}
+
+struct tcp_pcb *tcp_listen_with_backlog(struct tcp_pcb *pcb, u8_t backlog)
+{
+  return tcp_listen_with_backlog_and_err(pcb, backlog, NULL);
+}
+
+/**
+ * @brief Recomputes the announced window, returning how far its right edge moved.
+ */
+static u32_t tcp_update_rcv_ann_wnd(struct tcp_pcb *pcb)
+{
+  u32_t new_right_edge = pcb->rcv_nxt + pcb->rcv_wnd;
+
+  if (TCP_SEQ_GEQ(new_right_edge, pcb->rcv_ann_right_edge + LWIP_MIN((TCP_WND / 2), pcb->mss))) {
+    pcb->rcv_ann_wnd = pcb->rcv_wnd;
+    return new_right_edge - pcb->rcv_ann_right_edge;
+  }
+  if (TCP_SEQ_GT(pcb->rcv_nxt, pcb->rcv_ann_right_edge)) {
+    pcb->rcv_ann_wnd = 0;
+  } else {
+    pcb->rcv_ann_wnd = (tcpwnd_size_t)(pcb->rcv_ann_right_edge - pcb->rcv_nxt);
+  }
+  return 0;
+}
+
+void tcp_recved(struct tcp_pcb *pcb, u16_t len)
+{
+  tcpwnd_size_t rcv_wnd = (tcpwnd_size_t)(pcb->rcv_wnd + len);
+  if ((rcv_wnd > TCP_WND_MAX(pcb)) || (rcv_wnd < pcb->rcv_wnd)) {
+    rcv_wnd = TCP_WND_MAX(pcb);
+  }
+  pcb->rcv_wnd = rcv_wnd;
+
+  u32_t wnd_inflation = tcp_update_rcv_ann_wnd(pcb);
+  if (wnd_inflation >= TCP_WND_UPDATE_THRESHOLD) {
+    tcp_ack_now(pcb);
+    tcp_output(pcb);
+  }
+}
+
+/* Closing and aborting */
+
+static void tcp_pcb_purge(struct tcp_pcb *pcb)
+{
+  if (pcb->state != CLOSED && pcb->state != TIME_WAIT && pcb->state != LISTEN) {
+    if (pcb->refused_data != NULL) {
+      pbuf_free(pcb->refused_data);
+      pcb->refused_data = NULL;
+    }
+    pcb->rtime = -1;
+    tcp_segs_free(pcb->unsent);
+    tcp_segs_free(pcb->unacked);
+    pcb->unacked = pcb->unsent = NULL;
+    pcb->unsent_oversize = 0;
+  }
+}
+
+static void tcp_pcb_remove(struct tcp_pcb **pcblist, struct tcp_pcb *pcb)
+{
+  TCP_RMV(pcblist, pcb);
+  tcp_pcb_purge(pcb);
+
+  /* if there is an outstanding delayed ACK, send it */
+  if ((pcb->state != TIME_WAIT) && (pcb->state != LISTEN) && (pcb->flags & TF_ACK_DELAY)) {
+    tcp_ack_now(pcb);
+    tcp_output(pcb);
+  }
+  pcb->state = CLOSED;
+  pcb->local_port = 0;
+}
+
+static void tcp_listen_closed(struct tcp_pcb *lpcb)
+{
+  for (struct tcp_pcb *pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next) {
+    if (pcb->listener == lpcb) {
+      pcb->listener = NULL;
+    }
+  }
+}
+
+/**
+ * @brief Sends a RST, for a PCB or in reply to a segment without one.
+ */
+static void tcp_rst(const struct tcp_pcb *pcb, u32_t seqno_, u32_t ackno_,
+                    const ip_addr_t *local_ip, const ip_addr_t *remote_ip,
+                    u16_t local_port, u16_t remote_port)
+{
+  struct pbuf *p = pbuf_alloc(PBUF_IP, TCP_HLEN, PBUF_RAM);
+  if (p == NULL) {
+    return;
+  }
+  struct tcp_hdr *hdr = (struct tcp_hdr *)p->payload;
+  hdr->src = lwip_htons(local_port);
+  hdr->dest = lwip_htons(remote_port);
+  hdr->seqno = lwip_htonl(seqno_);
+  hdr->ackno = lwip_htonl(ackno_);
+  TCPH_HDRLEN_FLAGS_SET(hdr, TCP_HLEN / 4, TCP_RST | TCP_ACK);
+  hdr->wnd = PP_HTONS(TCP_WND);
+  hdr->chksum = 0;
+  hdr->urgp = 0;
+
+  struct netif *netif = ip4_route(remote_ip);
+  if (netif != NULL) {
+    hdr->chksum = inet_chksum_pseudo(p, IP_PROTO_TCP, p->tot_len, local_ip, remote_ip);
+    ip4_output_if(p, local_ip, remote_ip, pcb ? pcb->ttl : TCP_TTL, pcb ? pcb->tos : 0, IP_PROTO_TCP, netif);
+  }
+  pbuf_free(p);
+}
+
+static void tcp_abandon(struct tcp_pcb *pcb, int reset)
+{
+  if (pcb->state == TIME_WAIT) {
+    tcp_pcb_remove(&tcp_tw_pcbs, pcb);
+    tcp_free(pcb);
+    return;
+  }
+
+  int send_rst = 0;
+  u16_t local_port = 0;
+  u32_t seqno_ = pcb->snd_nxt;
+  u32_t ackno_ = pcb->rcv_nxt;
+  tcp_err_fn errf = pcb->errf;
+  void *errf_arg = pcb->callback_arg;
+
+  if (pcb->state == CLOSED) {
+    if (pcb->local_port != 0) {
+      TCP_RMV(&tcp_bound_pcbs, pcb);
+    }
+  } else {
+    send_rst = reset;
+    local_port = pcb->local_port;
+    TCP_PCB_REMOVE_ACTIVE(pcb);
+  }
+  if (send_rst) {
+    tcp_rst(pcb, seqno_, ackno_, &pcb->local_ip, &pcb->remote_ip, local_port, pcb->remote_port);
+  }
+  tcp_free(pcb);
+  TCP_EVENT_ERR(errf, errf_arg, ERR_ABRT);
+}
+
+void tcp_abort(struct tcp_pcb *pcb)
+{
+  tcp_abandon(pcb, 1);
+}
+
+/**
+ * @brief Marks the PCB being processed by tcp_input() for removal on return.
+ */
+static void tcp_trigger_input_pcb_close(void)
+{
+  recv_flags |= TF_CLOSED;
+}
+
+static err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t tcp_flags);
+
+static err_t tcp_send_fin(struct tcp_pcb *pcb)
+{
+  /* first, try to add the fin to the last unsent segment */
+  if (pcb->unsent != NULL) {
+    struct tcp_seg *last_unsent;
+    for (last_unsent = pcb->unsent; last_unsent->next != NULL; last_unsent = last_unsent->next) {
+    }
+    if ((TCPH_FLAGS(last_unsent->tcphdr) & (TCP_SYN | TCP_FIN | TCP_RST)) == 0) {
+      TCPH_SET_FLAG(last_unsent->tcphdr, TCP_FIN);
+      tcp_set_flags(pcb, TF_FIN);
+      return ERR_OK;
+    }
+  }
+  return tcp_enqueue_flags(pcb, TCP_FIN);
+}
+
+static err_t tcp_close_shutdown_fin(struct tcp_pcb *pcb)
+{
+  err_t err;
+  switch (pcb->state) {
+    case SYN_RCVD:
+    case ESTABLISHED:
+      err = tcp_send_fin(pcb);
+      if (err == ERR_OK) {
+        pcb->state = FIN_WAIT_1;
+      }
+      break;
+    case CLOSE_WAIT:
+      err = tcp_send_fin(pcb);
+      if (err == ERR_OK) {
+        pcb->state = LAST_ACK;
+      }
+      break;
+    default:
+      return ERR_OK;
+  }
+
+  if (err == ERR_OK) {
+    tcp_output(pcb);
+  } else if (err == ERR_MEM) {
+    /* Mark this pcb for closing. Closing is retried from tcp_tmr. */
+    tcp_set_flags(pcb, TF_CLOSEPEND);
+    return ERR_OK;
+  }
+  return err;
+}
+
+static err_t tcp_close_shutdown(struct tcp_pcb *pcb, u8_t rst_on_unacked_data)
+{
+  if (rst_on_unacked_data && ((pcb->state == ESTABLISHED) || (pcb->state == CLOSE_WAIT))) {
+    if ((pcb->refused_data != NULL) || (pcb->rcv_wnd != TCP_WND_MAX(pcb))) {
+      /* Not all data received by application, send RST to tell the remote side. */
+      tcp_rst(pcb, pcb->snd_nxt, pcb->rcv_nxt, &pcb->local_ip, &pcb->remote_ip,
+              pcb->local_port, pcb->remote_port);
+      tcp_pcb_purge(pcb);
+      TCP_RMV_ACTIVE(pcb);
+      if (tcp_input_pcb == pcb) {
+        tcp_trigger_input_pcb_close();
+      } else {
+        tcp_free(pcb);
+      }
+      return ERR_OK;
+    }
+  }
+
+  switch (pcb->state) {
+    case CLOSED:
+      if (pcb->local_port != 0) {
+        TCP_RMV(&tcp_bound_pcbs, pcb);
+      }
+      tcp_free(pcb);
+      break;
+    case LISTEN:
+      tcp_listen_closed(pcb);
+      tcp_pcb_remove(&tcp_listen_pcbs, pcb);
+      tcp_free_listen(pcb);
+      break;
+    case SYN_SENT:
+      TCP_PCB_REMOVE_ACTIVE(pcb);
+      tcp_free(pcb);
+      break;
+    default:
+      return tcp_close_shutdown_fin(pcb);
+  }
+  return ERR_OK;
+}
+
+err_t tcp_close(struct tcp_pcb *pcb)
+{
+  if (pcb->state != LISTEN) {
+    /* Set a flag not to receive any more data... */
+    tcp_set_flags(pcb, TF_RXCLOSED);
+  }
+  return tcp_close_shutdown(pcb, 1);
+}
+
+err_t tcp_shutdown(struct tcp_pcb *pcb, int shut_rx, int shut_tx)
+{
+  if (pcb->state == LISTEN) {
+    return ERR_CONN;
+  }
+  if (shut_rx) {
+    tcp_set_flags(pcb, TF_RXCLOSED);
+    if (shut_tx) {
+      return tcp_close_shutdown(pcb, 1);
+    }
+    if (pcb->refused_data != NULL) {
+      pbuf_free(pcb->refused_data);
+      pcb->refused_data = NULL;
+    }
+  }
+  if (shut_tx) {
+    switch (pcb->state) {
+      case SYN_RCVD:
+      case ESTABLISHED:
+      case CLOSE_WAIT:
+        return tcp_close_shutdown(pcb, (u8_t)shut_rx);
+      default:
+        return ERR_CONN;
+    }
+  }
+  return ERR_OK;
+}
+
+void tcp_netif_ip_addr_changed(const ip4_addr_t *old_addr, const ip4_addr_t *new_addr)
+{
+  if (old_addr == NULL || ip4_addr_isany(old_addr)) {
+    return;
+  }
+  struct tcp_pcb **lists[] = {&tcp_active_pcbs, &tcp_bound_pcbs};
+  for (size_t i = 0; i < LWIP_ARRAYSIZE(lists); i++) {
+    struct tcp_pcb *pcb = *lists[i];
+    while (pcb != NULL) {
+      struct tcp_pcb *next = pcb->next;
+      if (ip4_addr_cmp(&pcb->local_ip, old_addr)) {
+        tcp_abort(pcb);
+      }
+      pcb = next;
+    }
+  }
+  if (new_addr != NULL && !ip4_addr_isany(new_addr)) {
+    for (struct tcp_pcb *lpcb = tcp_listen_pcbs; lpcb != NULL; lpcb = lpcb->next) {
+      if (ip4_addr_cmp(&lpcb->local_ip, old_addr)) {
+        ip4_addr_copy(lpcb->local_ip, *new_addr);
+      }
+    }
+  }
+}
+
+/* Output */
+
+static struct tcp_seg *tcp_create_segment(const struct tcp_pcb *pcb, struct pbuf *p, u8_t hdrflags,
+                                          u32_t seqno_, u8_t optflags)
+{
+  u8_t optlen = LWIP_TCP_OPT_LENGTH(optflags);
+  struct tcp_seg *seg = tcp_seg_alloc();
+  if (seg == NULL) {
+    pbuf_free(p);
+    return NULL;
+  }
+  seg->flags = optflags;
+  seg->next = NULL;
+  seg->p = p;
+  seg->len = (u16_t)(p->tot_len - optlen);
+
+  if (pbuf_add_header(p, TCP_HLEN)) {
+    tcp_seg_free(seg);
+    return NULL;
+  }
+  seg->tcphdr = (struct tcp_hdr *)seg->p->payload;
+  seg->tcphdr->src = lwip_htons(pcb->local_port);
+  seg->tcphdr->dest = lwip_htons(pcb->remote_port);
+  seg->tcphdr->seqno = lwip_htonl(seqno_);
+  TCPH_HDRLEN_FLAGS_SET(seg->tcphdr, (5 + optlen / 4), hdrflags);
+  seg->tcphdr->urgp = 0;
+  return seg;
+}
+
+/**
+ * @brief Allocates a PBUF_RAM for @p length bytes, oversized up to
+ *        @p max_length when more data is expected to follow (lwIP's TCP_OVERSIZE).
+ */
+static struct pbuf *tcp_pbuf_prealloc(pbuf_layer layer, u16_t length, u16_t max_length,
+                                      u16_t *oversize, const struct tcp_pcb *pcb, u8_t apiflags,
+                                      u8_t first_seg)
+{
+  u16_t alloc = length;
+  if (length < max_length) {
+    if ((apiflags & TCP_WRITE_FLAG_MORE) ||
+        (!(pcb->flags & TF_NODELAY) &&
+         (!first_seg || pcb->unsent != NULL || pcb->unacked != NULL))) {
+      alloc = LWIP_MIN(max_length, LWIP_MEM_ALIGN_SIZE(TCP_OVERSIZE_CALC_LENGTH(length)));
+    }
+  }
+  struct pbuf *p = pbuf_alloc(layer, alloc, PBUF_RAM);
+  if (p == NULL) {
+    return NULL;
+  }
+  *oversize = (u16_t)(p->len - length);
+  p->len = p->tot_len = length;
+  return p;
+}
+
+static err_t tcp_write_checks(struct tcp_pcb *pcb, u16_t len)
+{
+  if ((pcb->state != ESTABLISHED) && (pcb->state != CLOSE_WAIT) &&
+      (pcb->state != SYN_SENT) && (pcb->state != SYN_RCVD)) {
+    return ERR_CONN;
+  } else if (len == 0) {
+    return ERR_OK;
+  }
+  if (len > pcb->snd_buf) {
+    tcp_set_flags(pcb, TF_NAGLEMEMERR);
+    return ERR_MEM;
+  }
+  if (pcb->snd_queuelen >= TCP_SND_QUEUELEN) {
+    tcp_set_flags(pcb, TF_NAGLEMEMERR);
+    return ERR_MEM;
+  }
+  return ERR_OK;
+}
+
+err_t tcp_write(struct tcp_pcb *pcb, const void *arg, u16_t len, u8_t apiflags)
+{
+  struct pbuf *concat_p = NULL;
+  struct tcp_seg *last_unsent = NULL, *seg = NULL, *prev_seg = NULL, *queue = NULL;
+  u16_t pos = 0;
+  u16_t oversize = 0;
+  u16_t oversize_used = 0;
+  u16_t extendlen = 0;
+
+  u16_t mss_local = LWIP_MIN(pcb->mss, (u16_t)(pcb->snd_wnd_max / 2));
+  mss_local = mss_local ? mss_local : pcb->mss;
+
+  err_t err = tcp_write_checks(pcb, len);
+  if (err != ERR_OK) {
+    return err;
+  }
+  u16_t queuelen = pcb->snd_queuelen;
+
+  if (pcb->unsent != NULL) {
+    for (last_unsent = pcb->unsent; last_unsent->next != NULL; last_unsent = last_unsent->next) {
+    }
+    u16_t unsent_optlen = LWIP_TCP_OPT_LENGTH(last_unsent->flags);
+    u16_t space = (u16_t)(mss_local - (last_unsent->len + unsent_optlen));
+
+    /* Phase 1: fill the oversized tail of the last unsent pbuf */
+    oversize = pcb->unsent_oversize;
+    if (oversize > 0) {
+      seg = last_unsent;
+      oversize_used = LWIP_MIN(space, LWIP_MIN(oversize, len));
+      pos = (u16_t)(pos + oversize_used);
+      oversize = (u16_t)(oversize - oversize_used);
+      space = (u16_t)(space - oversize_used);
+    }
+
+    /* Phase 2: chain a new pbuf to the last unsent segment */
+    if ((pos < len) && (space > 0) && (last_unsent->len > 0)) {
+      u16_t seglen = LWIP_MIN(space, (u16_t)(len - pos));
+      seg = last_unsent;
+
+      if (apiflags & TCP_WRITE_FLAG_COPY) {
+        concat_p = tcp_pbuf_prealloc(PBUF_RAW, seglen, space, &oversize, pcb, apiflags, 1);
+        if (concat_p == NULL) {
+          goto memerr;
+        }
+        sim_cpu_bytes(seglen, SIM_CPU_COPY_PS);
+        memcpy(concat_p->payload, (const u8_t *)arg + pos, seglen);
+        queuelen = (u16_t)(queuelen + pbuf_clen(concat_p));
+      } else {
+        /* If the last unsent pbuf is a PBUF_ROM ending where this data starts, extend it */
+        struct pbuf *p;
+        for (p = last_unsent->p; p->next != NULL; p = p->next) {
+        }
+        if (p->type_internal == PBUF_ROM && (const u8_t *)p->payload + p->len == (const u8_t *)arg) {
+          extendlen = seglen;
+        } else {
+          concat_p = pbuf_alloc(PBUF_RAW, seglen, PBUF_ROM);
+          if (concat_p == NULL) {
+            goto memerr;
+          }
+          concat_p->payload = (u8_t *)(uintptr_t)arg + pos;
+          queuelen = (u16_t)(queuelen + pbuf_clen(concat_p));
+        }
+      }
+      pos = (u16_t)(pos + seglen);
+    }
+  }
+
+  /* Phase 3: new segments */
+  while (pos < len) {
+    struct pbuf *p;
+    u16_t left = (u16_t)(len - pos);
+    u16_t seglen = LWIP_MIN(left, mss_local);
+
+    if (apiflags & TCP_WRITE_FLAG_COPY) {
+      p = tcp_pbuf_prealloc(PBUF_TRANSPORT, seglen, mss_local, &oversize, pcb, apiflags, queue == NULL);
+      if (p == NULL) {
+        goto memerr;
+      }
+      sim_cpu_bytes(seglen, SIM_CPU_COPY_PS);
+      memcpy(p->payload, (const u8_t *)arg + pos, seglen);
+    } else {
+      struct pbuf *p2 = pbuf_alloc(PBUF_TRANSPORT, seglen, PBUF_ROM);
+      if (p2 == NULL) {
+        goto memerr;
+      }
+      p2->payload = (u8_t *)(uintptr_t)arg + pos;
+      p = pbuf_alloc(PBUF_TRANSPORT, 0, PBUF_RAM);
+      if (p == NULL) {
+        pbuf_free(p2);
+        goto memerr;
+      }
+      pbuf_cat(p, p2);
+    }
+
+    queuelen = (u16_t)(queuelen + pbuf_clen(p));
+    if (queuelen > TCP_SND_QUEUELEN) {
+      pbuf_free(p);
+      goto memerr;
+    }
+    seg = tcp_create_segment(pcb, p, 0, pcb->snd_lbb + pos, 0);
+    if (seg == NULL) {
+      goto memerr;
+    }
+    if (queue == NULL) {
+      queue = seg;
+    } else {
+      prev_seg->next = seg;
+    }
+    prev_seg = seg;
+    pos = (u16_t)(pos + seglen);
+  }
+
+  /* All three phases succeeded, commit */
+  if (oversize_used > 0) {
+    for (struct pbuf *p = last_unsent->p; p != NULL; p = p->next) {
+      p->tot_len = (u16_t)(p->tot_len + oversize_used);
+      if (p->next == NULL) {
+        sim_cpu_bytes(oversize_used, SIM_CPU_COPY_PS);
+        memcpy((u8_t *)p->payload + p->len, arg, oversize_used);
+        p->len = (u16_t)(p->len + oversize_used);
+      }
+    }
+    last_unsent->len = (u16_t)(last_unsent->len + oversize_used);
+  }
+  pcb->unsent_oversize = oversize;
+
+  if (concat_p != NULL) {
+    pbuf_cat(last_unsent->p, concat_p);
+    last_unsent->len = (u16_t)(last_unsent->len + concat_p->tot_len);
+  } else if (extendlen > 0) {
+    struct pbuf *p;
+    for (p = last_unsent->p; p->next != NULL; p = p->next) {
+      p->tot_len = (u16_t)(p->tot_len + extendlen);
+    }
+    p->tot_len = (u16_t)(p->tot_len + extendlen);
+    p->len = (u16_t)(p->len + extendlen);
+    last_unsent->len = (u16_t)(last_unsent->len + extendlen);
+  }
+
+  if (last_unsent == NULL) {
+    pcb->unsent = queue;
+  } else {
+    last_unsent->next = queue;
+  }
+
+  pcb->snd_lbb += len;
+  pcb->snd_buf = (tcpwnd_size_t)(pcb->snd_buf - len);
+  pcb->snd_queuelen = queuelen;
+
+  /* Set the PSH flag in the last segment that we enqueued. */
+  if (seg != NULL && seg->tcphdr != NULL && ((apiflags & TCP_WRITE_FLAG_MORE) == 0)) {
+    TCPH_SET_FLAG(seg->tcphdr, TCP_PSH);
+  }
+  return ERR_OK;
+
+memerr:
+  tcp_set_flags(pcb, TF_NAGLEMEMERR);
+  if (concat_p != NULL) {
+    pbuf_free(concat_p);
+  }
+  tcp_segs_free(queue);
+  return ERR_MEM;
+}
+
+static err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t tcp_flags)
+{
+  u8_t optflags = (tcp_flags & TCP_SYN) ? TF_SEG_OPTS_MSS : 0;
+  u8_t optlen = LWIP_TCP_OPT_LENGTH(optflags);
+
+  struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, optlen, PBUF_RAM);
+  if (p == NULL) {
+    tcp_set_flags(pcb, TF_NAGLEMEMERR);
+    return ERR_MEM;
+  }
+  struct tcp_seg *seg = tcp_create_segment(pcb, p, tcp_flags, pcb->snd_lbb, optflags);
+  if (seg == NULL) {
+    tcp_set_flags(pcb, TF_NAGLEMEMERR);
+    return ERR_MEM;
+  }
+
+  if (pcb->unsent == NULL) {
+    pcb->unsent = seg;
+  } else {
+    struct tcp_seg *useg;
+    for (useg = pcb->unsent; useg->next != NULL; useg = useg->next) {
+    }
+    useg->next = seg;
+  }
+  pcb->unsent_oversize = 0;
+
+  /* SYN and FIN bump the sequence number */
+  pcb->snd_lbb++;
+  pcb->snd_buf--;
+  if (tcp_flags & TCP_FIN) {
+    tcp_set_flags(pcb, TF_FIN);
+  }
+  pcb->snd_queuelen = (u16_t)(pcb->snd_queuelen + pbuf_clen(seg->p));
+  return ERR_OK;
+}
+
+static err_t tcp_send_empty_ack(struct tcp_pcb *pcb)
+{
+  struct pbuf *p = pbuf_alloc(PBUF_IP, TCP_HLEN, PBUF_RAM);
+  if (p == NULL) {
+    tcp_set_flags(pcb, TF_ACK_DELAY | TF_ACK_NOW);
+    return ERR_BUF;
+  }
+  struct tcp_hdr *hdr = (struct tcp_hdr *)p->payload;
+  hdr->src = lwip_htons(pcb->local_port);
+  hdr->dest = lwip_htons(pcb->remote_port);
+  hdr->seqno = lwip_htonl(pcb->snd_nxt);
+  hdr->ackno = lwip_htonl(pcb->rcv_nxt);
+  TCPH_HDRLEN_FLAGS_SET(hdr, TCP_HLEN / 4, TCP_ACK);
+  hdr->wnd = lwip_htons(pcb->rcv_ann_wnd);
+  hdr->chksum = 0;
+  hdr->urgp = 0;
+  pcb->rcv_ann_right_edge = pcb->rcv_nxt + pcb->rcv_ann_wnd;
+
+  err_t err = ERR_RTE;
+  struct netif *netif = ip4_route(&pcb->remote_ip);
+  if (netif != NULL) {
+    hdr->chksum = inet_chksum_pseudo(p, IP_PROTO_TCP, p->tot_len, &pcb->local_ip, &pcb->remote_ip);
+    err = ip4_output_if(p, &pcb->local_ip, &pcb->remote_ip, pcb->ttl, pcb->tos, IP_PROTO_TCP, netif);
+  }
+  pbuf_free(p);
+
+  if (err != ERR_OK) {
+    tcp_set_flags(pcb, TF_ACK_DELAY | TF_ACK_NOW);
+  } else {
+    tcp_clear_flags(pcb, TF_ACK_DELAY | TF_ACK_NOW);
+  }
+  return err;
+}
+
+static err_t tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb, struct netif *netif)
+{
+  if (tcp_output_segment_busy(seg)) {
+    return ERR_OK;
+  }
+
+  seg->tcphdr->ackno = lwip_htonl(pcb->rcv_nxt);
+  seg->tcphdr->wnd = lwip_htons(pcb->rcv_ann_wnd);
+  pcb->rcv_ann_right_edge = pcb->rcv_nxt + pcb->rcv_ann_wnd;
+
+  if (seg->flags & TF_SEG_OPTS_MSS) {
+    u16_t mss = tcp_eff_send_mss(TCP_MSS, &pcb->remote_ip);
+    u32_t opt = lwip_htonl(0x02040000UL | mss);
+    memcpy(seg->tcphdr + 1, &opt, sizeof(opt));
+  }
+
+  /* Set retransmission timer running if it is not currently enabled */
+  if (pcb->rtime < 0) {
+    pcb->rtime = 0;
+  }
+  if (pcb->rttest == 0) {
+    pcb->rttest = tcp_ticks;
+    pcb->rtseq = lwip_ntohl(seg->tcphdr->seqno);
+  }
+
+  /* The pbuf may still carry the headers of a previous transmission */
+  u16_t len = (u16_t)((u8_t *)seg->tcphdr - (u8_t *)seg->p->payload);
+  seg->p->len = (u16_t)(seg->p->len - len);
+  seg->p->tot_len = (u16_t)(seg->p->tot_len - len);
+  seg->p->payload = seg->tcphdr;
+
+  seg->tcphdr->chksum = 0;
+  seg->tcphdr->chksum = inet_chksum_pseudo(seg->p, IP_PROTO_TCP, seg->p->tot_len,
+                                           &pcb->local_ip, &pcb->remote_ip);
+  return ip4_output_if(seg->p, &pcb->local_ip, &pcb->remote_ip, pcb->ttl, pcb->tos, IP_PROTO_TCP, netif);
+}
+
+err_t tcp_output(struct tcp_pcb *pcb)
+{
+  /* Don't output from within tcp_input(), it sends on return */
+  if (tcp_input_pcb == pcb) {
+    return ERR_OK;
+  }
+
+  tcpwnd_size_t wnd = LWIP_MIN(pcb->snd_wnd, pcb->cwnd);
+  struct tcp_seg *seg = pcb->unsent;
+
+  if (seg == NULL) {
+    if (pcb->flags & TF_ACK_NOW) {
+      return tcp_send_empty_ack(pcb);
+    }
+    goto output_done;
+  }
+
+  struct netif *netif = ip4_route(&pcb->remote_ip);
+  if (netif == NULL) {
+    return ERR_RTE;
+  }
+  if (ip_addr_isany(&pcb->local_ip)) {
+    ip4_addr_copy(pcb->local_ip, *netif_ip4_addr(netif));
+  }
+
+  if (lwip_ntohl(seg->tcphdr->seqno) - pcb->lastack + seg->len > wnd) {
+    /* Nothing fits the window; ACK if asked to */
+    if (pcb->flags & TF_ACK_NOW) {
+      return tcp_send_empty_ack(pcb);
+    }
+    goto output_done;
+  }
+
+  struct tcp_seg *useg = pcb->unacked;
+  if (useg != NULL) {
+    for (; useg->next != NULL; useg = useg->next) {
+    }
+  }
+
+  while (seg != NULL && lwip_ntohl(seg->tcphdr->seqno) - pcb->lastack + seg->len <= wnd) {
+    /* Stop sending if the nagle algorithm would prevent it */
+    if ((tcp_do_output_nagle(pcb) == 0) && ((pcb->flags & (TF_NAGLEMEMERR | TF_FIN)) == 0)) {
+      break;
+    }
+    if (pcb->state != SYN_SENT) {
+      TCPH_SET_FLAG(seg->tcphdr, TCP_ACK);
+    }
+
+    err_t err = tcp_output_segment(seg, pcb, netif);
+    if (err != ERR_OK) {
+      tcp_set_flags(pcb, TF_NAGLEMEMERR);
+      return err;
+    }
+    pcb->unsent = seg->next;
+    if (pcb->state != SYN_SENT) {
+      tcp_clear_flags(pcb, TF_ACK_DELAY | TF_ACK_NOW);
+    }
+    u32_t snd_nxt = lwip_ntohl(seg->tcphdr->seqno) + TCP_TCPLEN(seg);
+    if (TCP_SEQ_LT(pcb->snd_nxt, snd_nxt)) {
+      pcb->snd_nxt = snd_nxt;
+    }
+    /* put segment on unacknowledged list if length > 0 */
+    if (TCP_TCPLEN(seg) > 0) {
+      seg->next = NULL;
+      if (pcb->unacked == NULL) {
+        pcb->unacked = seg;
+        useg = seg;
+      } else if (TCP_SEQ_LT(lwip_ntohl(seg->tcphdr->seqno), lwip_ntohl(useg->tcphdr->seqno))) {
+        /* a retransmission goes before the newer segments */
+        struct tcp_seg **cur_seg = &pcb->unacked;
+        while (*cur_seg &&
+               TCP_SEQ_LT(lwip_ntohl((*cur_seg)->tcphdr->seqno), lwip_ntohl(seg->tcphdr->seqno))) {
+          cur_seg = &((*cur_seg)->next);
+        }
+        seg->next = *cur_seg;
+        *cur_seg = seg;
+      } else {
+        useg->next = seg;
+        useg = seg;
+      }
+    } else {
+      tcp_seg_free(seg);
+    }
+    seg = pcb->unsent;
+  }
+  if (pcb->unsent == NULL) {
+    pcb->unsent_oversize = 0;
+  }
+
+output_done:
+  tcp_clear_flags(pcb, TF_NAGLEMEMERR);
+  return ERR_OK;
+}
+
+/* Retransmission */
+
+static err_t tcp_rexmit_rto_prepare(struct tcp_pcb *pcb)
+{
+  if (pcb->unacked == NULL) {
+    return ERR_VAL;
+  }
+  struct tcp_seg *seg;
+  for (seg = pcb->unacked; seg->next != NULL; seg = seg->next) {
+    if (tcp_output_segment_busy(seg)) {
+      return ERR_VAL;
+    }
+  }
+  if (tcp_output_segment_busy(seg)) {
+    return ERR_VAL;
+  }
+  /* concatenate unsent queue after unacked queue */
+  seg->next = pcb->unsent;
+  pcb->unsent = pcb->unacked;
+  pcb->unacked = NULL;
+
+  tcp_set_flags(pcb, TF_RTO);
+  pcb->rto_end = lwip_ntohl(seg->tcphdr->seqno) + TCP_TCPLEN(seg);
+  pcb->rttest = 0;
+  return ERR_OK;
+}
+
+static void tcp_rexmit_rto_commit(struct tcp_pcb *pcb)
+{
+  if (pcb->nrtx < 0xff) {
+    ++pcb->nrtx;
+  }
+  tcp_output(pcb);
+}
+
+static err_t tcp_rexmit(struct tcp_pcb *pcb)
+{
+  if (pcb->unacked == NULL) {
+    return ERR_VAL;
+  }
+  struct tcp_seg *seg = pcb->unacked;
+  if (tcp_output_segment_busy(seg)) {
+    return ERR_VAL;
+  }
+
+  /* Move the first unacked segment to the unsent queue, keeping it sorted */
+  pcb->unacked = seg->next;
+  struct tcp_seg **cur_seg = &pcb->unsent;
+  while (*cur_seg &&
+         TCP_SEQ_LT(lwip_ntohl((*cur_seg)->tcphdr->seqno), lwip_ntohl(seg->tcphdr->seqno))) {
+    cur_seg = &((*cur_seg)->next);
+  }
+  seg->next = *cur_seg;
+  *cur_seg = seg;
+  if (seg->next == NULL) {
+    pcb->unsent_oversize = 0;
+  }
+
+  if (pcb->nrtx < 0xff) {
+    ++pcb->nrtx;
+  }
+  /* Don't take any rtt measurements after retransmitting. */
+  pcb->rttest = 0;
+  return ERR_OK;
+}
+
+static void tcp_rexmit_fast(struct tcp_pcb *pcb)
+{
+  if (pcb->unacked != NULL && !(pcb->flags & TF_INFR)) {
+    if (tcp_rexmit(pcb) == ERR_OK) {
+      /* Set ssthresh to half of the minimum of the current cwnd and the advertised window */
+      pcb->ssthresh = (tcpwnd_size_t)(LWIP_MIN(pcb->cwnd, pcb->snd_wnd) / 2);
+      if (pcb->ssthresh < (2U * pcb->mss)) {
+        pcb->ssthresh = (tcpwnd_size_t)(2 * pcb->mss);
+      }
+      pcb->cwnd = (tcpwnd_size_t)(pcb->ssthresh + 3 * pcb->mss);
+      tcp_set_flags(pcb, TF_INFR);
+      pcb->rtime = 0;
+    }
+  }
+}
+
+/* Timers */
+
+static err_t tcp_process_refused_data(struct tcp_pcb *pcb);
+
+static void tcp_fasttmr(void)
+{
+  ++tcp_timer_ctr;
+
+tcp_fasttmr_start:
+  for (struct tcp_pcb *pcb = tcp_active_pcbs; pcb != NULL;) {
+    if (pcb->last_timer == tcp_timer_ctr) {
+      pcb = pcb->next;
+      continue;
+    }
+    pcb->last_timer = tcp_timer_ctr;
+    /* send delayed ACKs */
+    if (pcb->flags & TF_ACK_DELAY) {
+      tcp_ack_now(pcb);
+      tcp_output(pcb);
+      tcp_clear_flags(pcb, TF_ACK_DELAY | TF_ACK_NOW);
+    }
+    /* send pending FIN */
+    if (pcb->flags & TF_CLOSEPEND) {
+      tcp_clear_flags(pcb, TF_CLOSEPEND);
+      tcp_close_shutdown_fin(pcb);
+    }
+
+    struct tcp_pcb *next = pcb->next;
+    /* If there is data which was previously "refused" by upper layer */
+    if (pcb->refused_data != NULL) {
+      tcp_active_pcbs_changed = 0;
+      tcp_process_refused_data(pcb);
+      if (tcp_active_pcbs_changed) {
+        goto tcp_fasttmr_start;
+      }
+    }
+    pcb = next;
+  }
+}
+
+static void tcp_slowtmr(void)
+{
+  ++tcp_ticks;
+  ++tcp_timer_ctr;
+
+tcp_slowtmr_start:
+  {
+    struct tcp_pcb *prev = NULL;
+    struct tcp_pcb *pcb = tcp_active_pcbs;
+    while (pcb != NULL) {
+      if (pcb->last_timer == tcp_timer_ctr) {
+        prev = pcb;
+        pcb = pcb->next;
+        continue;
+      }
+      pcb->last_timer = tcp_timer_ctr;
+
+      u8_t pcb_remove = 0;
+      if (pcb->state == SYN_SENT && pcb->nrtx >= TCP_SYNMAXRTX) {
+        ++pcb_remove;
+      } else if (pcb->nrtx >= TCP_MAXRTX) {
+        ++pcb_remove;
+      } else {
+        /* Increase the retransmission timer if it is running */
+        if ((pcb->rtime >= 0) && (pcb->rtime < 0x7fff)) {
+          ++pcb->rtime;
+        }
+        if (pcb->rtime >= pcb->rto) {
+          if ((tcp_rexmit_rto_prepare(pcb) == ERR_OK) || ((pcb->unacked == NULL) && (pcb->unsent != NULL))) {
+            /* Double retransmission time-out unless we are trying to connect to somebody */
+            if (pcb->state != SYN_SENT) {
+              u8_t backoff_idx = LWIP_MIN(pcb->nrtx, sizeof(tcp_backoff) - 1);
+              int calc_rto = ((pcb->sa >> 3) + pcb->sv) << tcp_backoff[backoff_idx];
+              pcb->rto = (s16_t)LWIP_MIN(calc_rto, 0x7fff);
+            }
+            pcb->rtime = 0;
+
+            /* Reduce congestion window and ssthresh. */
+            tcpwnd_size_t eff_wnd = LWIP_MIN(pcb->cwnd, pcb->snd_wnd);
+            pcb->ssthresh = (tcpwnd_size_t)(eff_wnd >> 1);
+            if (pcb->ssthresh < (tcpwnd_size_t)(pcb->mss << 1)) {
+              pcb->ssthresh = (tcpwnd_size_t)(pcb->mss << 1);
+            }
+            pcb->cwnd = pcb->mss;
+            pcb->bytes_acked = 0;
+
+            tcp_rexmit_rto_commit(pcb);
+          }
+        }
+      }
+
+      /* Check if this PCB has stayed too long in FIN-WAIT-2 */
+      if (pcb->state == FIN_WAIT_2 && (pcb->flags & TF_RXCLOSED) &&
+          (u32_t)(tcp_ticks - pcb->tmr) > TCP_FIN_WAIT_TIMEOUT / TCP_SLOW_INTERVAL) {
+        ++pcb_remove;
+      }
+      /* Check if this PCB has stayed too long in SYN-RCVD */
+      if (pcb->state == SYN_RCVD &&
+          (u32_t)(tcp_ticks - pcb->tmr) > TCP_SYN_RCVD_TIMEOUT / TCP_SLOW_INTERVAL) {
+        ++pcb_remove;
+      }
+      /* Check if this PCB has stayed too long in LAST-ACK */
+      if (pcb->state == LAST_ACK &&
+          (u32_t)(tcp_ticks - pcb->tmr) > 2 * TCP_MSL / TCP_SLOW_INTERVAL) {
+        ++pcb_remove;
+      }
+
+      if (pcb_remove) {
+        tcp_pcb_purge(pcb);
+        if (prev != NULL) {
+          prev->next = pcb->next;
+        } else {
+          tcp_active_pcbs = pcb->next;
+        }
+        tcp_err_fn err_fn = pcb->errf;
+        void *err_arg = pcb->callback_arg;
+        struct tcp_pcb *pcb2 = pcb;
+        pcb = pcb->next;
+        tcp_free(pcb2);
+
+        tcp_active_pcbs_changed = 0;
+        TCP_EVENT_ERR(err_fn, err_arg, ERR_ABRT);
+        if (tcp_active_pcbs_changed) {
+          goto tcp_slowtmr_start;
+        }
+      } else {
+        /* get the 'next' element now and work with 'prev' below */
+        prev = pcb;
+        pcb = pcb->next;
+
+        ++prev->polltmr;
+        if (prev->polltmr >= prev->pollinterval) {
+          err_t err;
+          prev->polltmr = 0;
+          tcp_active_pcbs_changed = 0;
+          TCP_EVENT_POLL(prev, err);
+          if (tcp_active_pcbs_changed) {
+            goto tcp_slowtmr_start;
+          }
+          if (err == ERR_OK) {
+            tcp_output(prev);
+          }
+        }
+      }
+    }
+  }
+
+  /* Steps through all of the TIME-WAIT PCBs. */
+  struct tcp_pcb *prev = NULL;
+  struct tcp_pcb *pcb = tcp_tw_pcbs;
+  while (pcb != NULL) {
+    if ((u32_t)(tcp_ticks - pcb->tmr) > 2 * TCP_MSL / TCP_SLOW_INTERVAL) {
+      tcp_pcb_purge(pcb);
+      if (prev != NULL) {
+        prev->next = pcb->next;
+      } else {
+        tcp_tw_pcbs = pcb->next;
+      }
+      struct tcp_pcb *pcb2 = pcb;
+      pcb = pcb->next;
+      tcp_free(pcb2);
+    } else {
+      prev = pcb;
+      pcb = pcb->next;
+    }
+  }
+}
+
+void tcp_tmr(void)
+{
+  tcp_fasttmr();
+  if (++tcp_timer & 1) {
+    /* Call tcp_slowtmr() every 500 ms, i.e., every other timer tcp_tmr() is called. */
+    tcp_slowtmr();
+  }
+}
+
+int tcp_timer_wanted(void)
+{
+  return tcp_active_pcbs != NULL || tcp_tw_pcbs != NULL;
+}
+
+void tcp_reset(void)
+{
+  /* The pools were reset by lwip_init(), release the host memory only */
+  struct tcp_pcb **lists[] = {&tcp_bound_pcbs, &tcp_listen_pcbs, &tcp_active_pcbs, &tcp_tw_pcbs};
+  for (size_t i = 0; i < LWIP_ARRAYSIZE(lists); i++) {
+    struct tcp_pcb *pcb = *lists[i];
+    while (pcb != NULL) {
+      struct tcp_pcb *next = pcb->next;
+      struct tcp_seg *queues[] = {pcb->unsent, pcb->unacked};
+      for (size_t q = 0; q < LWIP_ARRAYSIZE(queues); q++) {
+        for (struct tcp_seg *seg = queues[q]; seg != NULL;) {
+          struct tcp_seg *snext = seg->next;
+          pbuf_free(seg->p);
+          free(seg);
+          seg = snext;
+        }
+      }
+      if (pcb->refused_data != NULL) {
+        pbuf_free(pcb->refused_data);
+      }
+      free(pcb);
+      pcb = next;
+    }
+    *lists[i] = NULL;
+  }
+  tcp_input_pcb = NULL;
+  tcp_ticks = 0;
+  tcp_timer = 0;
+  tcp_timer_ctr = 0;
+  tcp_port = 0;
+  tcp_iss = 6510;
+}
+
+/* Input */
+
+/**
+ * @brief Parses the options of the incoming segment: only MSS is used.
+ */
+static void tcp_parseopt(struct tcp_pcb *pcb)
+{
+  const u8_t *opts = (const u8_t *)(tcphdr + 1);
+  for (u16_t i = 0; i < tcphdr_optlen;) {
+    u8_t opt = opts[i];
+    if (opt == 0) {
+      return;
+    }
+    if (opt == 1) {
+      i++;
+      continue;
+    }
+    if (i + 1 >= tcphdr_optlen || opts[i + 1] < 2 || i + opts[i + 1] > tcphdr_optlen) {
+      return;
+    }
+    if (opt == 2 && opts[i + 1] == 4 && (flags & TCP_SYN)) {
+      u16_t mss = (u16_t)((opts[i + 2] << 8) | opts[i + 3]);
+      pcb->mss = ((mss > TCP_MSS) || (mss == 0)) ? TCP_MSS : mss;
+    }
+    i = (u16_t)(i + opts[i + 1]);
+  }
+}
+
+static err_t tcp_process_refused_data(struct tcp_pcb *pcb)
+{
+  u8_t refused_flags = pcb->refused_data->flags;
+  struct pbuf *refused_data = pcb->refused_data;
+  err_t err;
+
+  pcb->refused_data = NULL;
+  TCP_EVENT_RECV(pcb, refused_data, ERR_OK, err);
+  if (err == ERR_OK) {
+    /* did refused_data include a FIN? */
+    if (refused_flags & PBUF_FLAG_TCP_FIN) {
+      if (pcb->rcv_wnd != TCP_WND_MAX(pcb)) {
+        pcb->rcv_wnd++;
+      }
+      TCP_EVENT_CLOSED(pcb, err);
+      if (err == ERR_ABRT) {
+        return ERR_ABRT;
+      }
+    }
+  } else if (err == ERR_ABRT) {
+    return ERR_ABRT;
+  } else {
+    /* data is still refused, pbuf is still valid (go on for ACK-only packets) */
+    pcb->refused_data = refused_data;
+    return ERR_INPROGRESS;
+  }
+  return ERR_OK;
+}
+
+static void tcp_ack(struct tcp_pcb *pcb)
+{
+  /* ACK every second full segment at once, delay the others */
+  if (pcb->flags & TF_ACK_DELAY) {
+    tcp_clear_flags(pcb, TF_ACK_DELAY);
+    tcp_ack_now(pcb);
+  } else {
+    tcp_set_flags(pcb, TF_ACK_DELAY);
+  }
+}
+
+static void tcp_receive(struct tcp_pcb *pcb)
+{
+  if (flags & TCP_ACK) {
+    u32_t right_wnd_edge = pcb->snd_wnd + pcb->snd_wl2;
+
+    /* Update window. */
+    if (TCP_SEQ_LT(pcb->snd_wl1, seqno) ||
+        (pcb->snd_wl1 == seqno && TCP_SEQ_LT(pcb->snd_wl2, ackno)) ||
+        (pcb->snd_wl2 == ackno && tcphdr->wnd > pcb->snd_wnd)) {
+      pcb->snd_wnd = tcphdr->wnd;
+      if (pcb->snd_wnd_max < pcb->snd_wnd) {
+        pcb->snd_wnd_max = pcb->snd_wnd;
+      }
+      pcb->snd_wl1 = seqno;
+      pcb->snd_wl2 = ackno;
+    }
+
+    if (TCP_SEQ_LEQ(ackno, pcb->lastack)) {
+      /* Duplicate ACK detection, RFC 5681 */
+      int found_dupack = 0;
+      if (tcplen == 0 && pcb->snd_wl2 + pcb->snd_wnd == right_wnd_edge &&
+          pcb->rtime >= 0 && pcb->lastack == ackno) {
+        found_dupack = 1;
+        if ((u8_t)(pcb->dupacks + 1) > pcb->dupacks) {
+          ++pcb->dupacks;
+        }
+        if (pcb->dupacks > 3) {
+          TCP_WND_INC(pcb->cwnd, pcb->mss);
+        }
+        if (pcb->dupacks >= 3) {
+          tcp_rexmit_fast(pcb);
+        }
+      }
+      if (!found_dupack) {
+        pcb->dupacks = 0;
+      }
+    } else if (TCP_SEQ_BETWEEN(ackno, pcb->lastack + 1, pcb->snd_nxt)) {
+      /* The ACK acknowledges new data */
+      if (pcb->flags & TF_INFR) {
+        tcp_clear_flags(pcb, TF_INFR);
+        pcb->cwnd = pcb->ssthresh;
+        pcb->bytes_acked = 0;
+      }
+      pcb->nrtx = 0;
+      pcb->rto = (s16_t)((pcb->sa >> 3) + pcb->sv);
+
+      tcpwnd_size_t acked = (tcpwnd_size_t)(ackno - pcb->lastack);
+      pcb->snd_buf = (tcpwnd_size_t)(pcb->snd_buf + acked);
+      recv_acked = acked;
+      pcb->dupacks = 0;
+      pcb->lastack = ackno;
+
+      /* Update the congestion control variables (cwnd and ssthresh). */
+      if (pcb->state >= ESTABLISHED) {
+        if (pcb->cwnd < pcb->ssthresh) {
+          /* RFC 3465, section 2.2 Slow Start, one SMSS after an RTO */
+          u8_t num_seg = (pcb->flags & TF_RTO) ? 1 : 2;
+          tcpwnd_size_t increase = LWIP_MIN(acked, (tcpwnd_size_t)(num_seg * pcb->mss));
+          TCP_WND_INC(pcb->cwnd, increase);
+        } else {
+          /* RFC 3465, section 2.1 Congestion Avoidance */
+          TCP_WND_INC(pcb->bytes_acked, acked);
+          if (pcb->bytes_acked >= pcb->cwnd) {
+            pcb->bytes_acked = (tcpwnd_size_t)(pcb->bytes_acked - pcb->cwnd);
+            TCP_WND_INC(pcb->cwnd, pcb->mss);
+          }
+        }
+      }
+
+      /* Free the acknowledged segments of both queues */
+      struct tcp_seg **queues[] = {&pcb->unacked, &pcb->unsent};
+      for (size_t i = 0; i < LWIP_ARRAYSIZE(queues); i++) {
+        while (*queues[i] != NULL &&
+               TCP_SEQ_LEQ(lwip_ntohl((*queues[i])->tcphdr->seqno) + TCP_TCPLEN(*queues[i]), ackno)) {
+          struct tcp_seg *next = *queues[i];
+          *queues[i] = next->next;
+          pcb->snd_queuelen = (u16_t)(pcb->snd_queuelen - pbuf_clen(next->p));
+          tcp_seg_free(next);
+        }
+      }
+      if (pcb->unsent == NULL) {
+        pcb->unsent_oversize = 0;
+      }
+
+      /* Stop the retransmit timer if nothing is left in flight, else restart it */
+      if (pcb->unacked == NULL) {
+        pcb->rtime = -1;
+      } else {
+        pcb->rtime = 0;
+      }
+      pcb->polltmr = 0;
+
+      /* The RTO recovery ends once everything sent before it is acknowledged */
+      if (pcb->flags & TF_RTO) {
+        if (pcb->unacked == NULL) {
+          if ((pcb->unsent == NULL) ||
+              (TCP_SEQ_LEQ(pcb->rto_end, lwip_ntohl(pcb->unsent->tcphdr->seqno)))) {
+            tcp_clear_flags(pcb, TF_RTO);
+          }
+        } else if (TCP_SEQ_LEQ(pcb->rto_end, lwip_ntohl(pcb->unacked->tcphdr->seqno))) {
+          tcp_clear_flags(pcb, TF_RTO);
+        }
+      }
+    } else {
+      /* Out of sequence ACK, didn't really ack anything */
+      tcp_send_empty_ack(pcb);
+    }
+
+    /* RTT estimation, Van Jacobson */
+    if (pcb->rttest && TCP_SEQ_LT(pcb->rtseq, ackno)) {
+      s16_t m = (s16_t)(tcp_ticks - pcb->rttest);
+      m = (s16_t)(m - (pcb->sa >> 3));
+      pcb->sa = (s16_t)(pcb->sa + m);
+      if (m < 0) {
+        m = (s16_t)-m;
+      }
+      m = (s16_t)(m - (pcb->sv >> 2));
+      pcb->sv = (s16_t)(pcb->sv + m);
+      pcb->rto = (s16_t)((pcb->sa >> 3) + pcb->sv);
+      pcb->rttest = 0;
+    }
+  }
+
+  if ((tcplen > 0) && (pcb->state < CLOSE_WAIT)) {
+    /* Trim data the peer retransmitted and we already have */
+    if (TCP_SEQ_BETWEEN(pcb->rcv_nxt, seqno + 1, seqno + tcplen - 1)) {
+      u16_t off = (u16_t)(pcb->rcv_nxt - seqno);
+      struct pbuf *p = inseg.p;
+      if (inseg.p->len < off) {
+        u16_t new_tot_len = (u16_t)(inseg.p->tot_len - off);
+        while (p->len < off) {
+          off = (u16_t)(off - p->len);
+          p->tot_len = new_tot_len;
+          p->len = 0;
+          p = p->next;
+        }
+      }
+      pbuf_remove_header(p, off);
+      inseg.len = (u16_t)(inseg.len - (u16_t)(pcb->rcv_nxt - seqno));
+      seqno = pcb->rcv_nxt;
+    } else if (TCP_SEQ_LT(seqno, pcb->rcv_nxt)) {
+      /* the whole segment is < rcv_nxt, must be a duplicate of a packet that has already been correctly handled */
+      tcp_ack_now(pcb);
+    }
+
+    if (TCP_SEQ_BETWEEN(seqno, pcb->rcv_nxt, pcb->rcv_nxt + pcb->rcv_wnd - 1)) {
+      if (pcb->rcv_nxt == seqno) {
+        tcplen = TCP_TCPLEN(&inseg);
+        if (tcplen > pcb->rcv_wnd) {
+          /* Cut the segment to the window */
+          if (TCPH_FLAGS(inseg.tcphdr) & TCP_FIN) {
+            TCPH_FLAGS_SET(inseg.tcphdr, TCPH_FLAGS(inseg.tcphdr) & ~(unsigned int)TCP_FIN);
+          }
+          inseg.len = (u16_t)pcb->rcv_wnd;
+          if (TCPH_FLAGS(inseg.tcphdr) & TCP_SYN) {
+            inseg.len -= 1;
+          }
+          pbuf_realloc(inseg.p, inseg.len);
+          tcplen = TCP_TCPLEN(&inseg);
+        }
+
+        pcb->rcv_nxt = seqno + tcplen;
+        pcb->rcv_wnd = (tcpwnd_size_t)(pcb->rcv_wnd - tcplen);
+        tcp_update_rcv_ann_wnd(pcb);
+
+        if (inseg.p->tot_len > 0) {
+          recv_data = inseg.p;
+          /* the pbuf is passed to the application, don't free it on return */
+          inseg.p = NULL;
+        }
+        if (TCPH_FLAGS(inseg.tcphdr) & TCP_FIN) {
+          recv_flags |= TF_GOT_FIN;
+        }
+        tcp_ack(pcb);
+      } else {
+        /* lwIP keeps this on the out-of-sequence queue; the stand-in drops it */
+        tcp_send_empty_ack(pcb);
+      }
+    } else {
+      /* The incoming segment is not within the window. */
+      tcp_send_empty_ack(pcb);
+    }
+  } else if (!TCP_SEQ_BETWEEN(seqno, pcb->rcv_nxt, pcb->rcv_nxt + pcb->rcv_wnd - 1)) {
+    tcp_ack_now(pcb);
+  }
+}
+
+static void tcp_to_time_wait(struct tcp_pcb *pcb)
+{
+  tcp_ack_now(pcb);
+  tcp_pcb_purge(pcb);
+  TCP_RMV_ACTIVE(pcb);
+  pcb->state = TIME_WAIT;
+  TCP_REG(&tcp_tw_pcbs, pcb);
+}
+
+static err_t tcp_process(struct tcp_pcb *pcb)
+{
+  err_t err = ERR_OK;
+
+  /* Process incoming RST segments. */
+  if (flags & TCP_RST) {
+    int acceptable = 0;
+    if (seqno == pcb->rcv_nxt) {
+      acceptable = 1;
+    } else if (TCP_SEQ_BETWEEN(seqno, pcb->rcv_nxt, pcb->rcv_nxt + pcb->rcv_wnd)) {
+      /* Not exact, but in window: send a challenge ACK */
+      tcp_ack_now(pcb);
+    }
+    if (acceptable) {
+      recv_flags |= TF_RESET;
+      tcp_clear_flags(pcb, TF_ACK_DELAY);
+      return ERR_RST;
+    }
+    return ERR_OK;
+  }
+
+  if ((flags & TCP_SYN) && (pcb->state != SYN_SENT && pcb->state != SYN_RCVD)) {
+    /* Cope with new connection attempt after remote end crashed */
+    tcp_ack_now(pcb);
+    return ERR_OK;
+  }
+
+  if ((pcb->flags & TF_RXCLOSED) == 0) {
+    /* Update the PCB (in)activity timer unless rx is closed (see tcp_shutdown) */
+    pcb->tmr = tcp_ticks;
+  }
+
+  switch (pcb->state) {
+    case SYN_RCVD:
+      if (flags & TCP_ACK) {
+        if (TCP_SEQ_BETWEEN(ackno, pcb->lastack + 1, pcb->snd_nxt)) {
+          pcb->state = ESTABLISHED;
+          if (pcb->listener == NULL) {
+            /* listen pcb might be closed by now */
+            err = ERR_VAL;
+          } else {
+            TCP_EVENT_ACCEPT(pcb->listener, pcb, pcb->callback_arg, ERR_OK, err);
+          }
+          if (err != ERR_OK) {
+            /* If the accept function returns with an error, we abort the connection. */
+            if (err != ERR_ABRT) {
+              tcp_abort(pcb);
+            }
+            return ERR_ABRT;
+          }
+          tcp_receive(pcb);
+          /* Prevent ACK for SYN to generate a sent event */
+          if (recv_acked != 0) {
+            recv_acked--;
+          }
+          pcb->cwnd = LWIP_TCP_CALC_INITIAL_CWND(pcb->mss);
+          if (recv_flags & TF_GOT_FIN) {
+            tcp_ack_now(pcb);
+            pcb->state = CLOSE_WAIT;
+          }
+        } else {
+          /* incorrect ACK number, send RST */
+          tcp_rst(pcb, ackno, seqno + tcplen, ip4_current_dest_addr(), ip4_current_src_addr(),
+                  tcphdr->dest, tcphdr->src);
+        }
+      } else if ((flags & TCP_SYN) && (seqno == pcb->rcv_nxt - 1)) {
+        /* Looks like another copy of the SYN - retransmit our SYN-ACK */
+        tcp_rexmit(pcb);
+      }
+      break;
+    case CLOSE_WAIT:
+    case ESTABLISHED:
+      tcp_receive(pcb);
+      if (recv_flags & TF_GOT_FIN) {
+        tcp_ack_now(pcb);
+        pcb->state = CLOSE_WAIT;
+      }
+      break;
+    case FIN_WAIT_1:
+      tcp_receive(pcb);
+      if (recv_flags & TF_GOT_FIN) {
+        if ((flags & TCP_ACK) && (ackno == pcb->snd_nxt) && pcb->unsent == NULL) {
+          tcp_to_time_wait(pcb);
+        } else {
+          tcp_ack_now(pcb);
+          pcb->state = CLOSING;
+        }
+      } else if ((flags & TCP_ACK) && (ackno == pcb->snd_nxt) && pcb->unsent == NULL) {
+        pcb->state = FIN_WAIT_2;
+      }
+      break;
+    case FIN_WAIT_2:
+      tcp_receive(pcb);
+      if (recv_flags & TF_GOT_FIN) {
+        tcp_to_time_wait(pcb);
+      }
+      break;
+    case CLOSING:
+      tcp_receive(pcb);
+      if ((flags & TCP_ACK) && ackno == pcb->snd_nxt && pcb->unsent == NULL) {
+        tcp_pcb_purge(pcb);
+        TCP_RMV_ACTIVE(pcb);
+        pcb->state = TIME_WAIT;
+        TCP_REG(&tcp_tw_pcbs, pcb);
+      }
+      break;
+    case LAST_ACK:
+      tcp_receive(pcb);
+      if ((flags & TCP_ACK) && ackno == pcb->snd_nxt && pcb->unsent == NULL) {
+        recv_flags |= TF_CLOSED;
+      }
+      break;
+    default:
+      break;
+  }
+  return ERR_OK;
+}
+
+static void tcp_listen_input(struct tcp_pcb *pcb)
+{
+  if (flags & TCP_RST) {
+    return;
+  }
+  if (flags & TCP_ACK) {
+    /* For incoming segments with the ACK flag set, respond with a RST. */
+    tcp_rst(NULL, ackno, seqno + tcplen, ip4_current_dest_addr(), ip4_current_src_addr(),
+            tcphdr->dest, tcphdr->src);
+    return;
+  }
+  if (!(flags & TCP_SYN)) {
+    return;
+  }
+
+  struct tcp_pcb *npcb = tcp_alloc(pcb->prio);
+  if (npcb == NULL) {
+    err_t err;
+    TCP_EVENT_ACCEPT(pcb, NULL, pcb->callback_arg, ERR_MEM, err);
+    LWIP_UNUSED_ARG(err);
+    return;
+  }
+  ip4_addr_copy(npcb->local_ip, *ip4_current_dest_addr());
+  ip4_addr_copy(npcb->remote_ip, *ip4_current_src_addr());
+  npcb->local_port = pcb->local_port;
+  npcb->remote_port = tcphdr->src;
+  npcb->state = SYN_RCVD;
+  npcb->rcv_nxt = seqno + 1;
+  npcb->rcv_ann_right_edge = npcb->rcv_nxt;
+  u32_t iss = tcp_next_iss();
+  npcb->snd_wl2 = iss;
+  npcb->snd_nxt = iss;
+  npcb->lastack = iss;
+  npcb->snd_lbb = iss;
+  npcb->snd_wl1 = seqno - 1;
+  npcb->callback_arg = pcb->callback_arg;
+  npcb->listener = pcb;
+  npcb->so_options = pcb->so_options;
+  npcb->netif_idx = pcb->netif_idx;
+  TCP_REG_ACTIVE(npcb);
+
+  tcp_parseopt(npcb);
+  npcb->snd_wnd = tcphdr->wnd;
+  npcb->snd_wnd_max = npcb->snd_wnd;
+  npcb->mss = tcp_eff_send_mss(npcb->mss, &npcb->remote_ip);
+
+  /* Send a SYN|ACK together with the MSS option. */
+  if (tcp_enqueue_flags(npcb, TCP_SYN | TCP_ACK) != ERR_OK) {
+    tcp_abandon(npcb, 0);
+    return;
+  }
+  tcp_output(npcb);
+}
+
+static void tcp_timewait_input(struct tcp_pcb *pcb)
+{
+  if (flags & TCP_RST) {
+    return;
+  }
+  if (flags & TCP_SYN) {
+    /* If the SYN is in the window it is an error, send a reset */
+    if (TCP_SEQ_BETWEEN(seqno, pcb->rcv_nxt, pcb->rcv_nxt + pcb->rcv_wnd)) {
+      tcp_rst(pcb, ackno, seqno + tcplen, ip4_current_dest_addr(), ip4_current_src_addr(),
+              tcphdr->dest, tcphdr->src);
+      return;
+    }
+  } else if (flags & TCP_FIN) {
+    /* Restart the 2 MSL time-wait timeout. */
+    pcb->tmr = tcp_ticks;
+  }
+  if (tcplen > 0) {
+    /* Acknowledge data, FIN or out-of-window SYN */
+    tcp_ack_now(pcb);
+    tcp_output(pcb);
+  }
+}
+
+/**
+ * @brief Removes the PCB if tcp_process() or the application closed it.
+ */
+static int tcp_input_delayed_close(struct tcp_pcb *pcb)
+{
+  if (recv_flags & TF_CLOSED) {
+    if (!(pcb->flags & TF_RXCLOSED)) {
+      /* Connection closed although the application has only shut down the tx side */
+      TCP_EVENT_ERR(pcb->errf, pcb->callback_arg, ERR_CLSD);
+    }
+    tcp_pcb_remove(&tcp_active_pcbs, pcb);
+    tcp_free(pcb);
+    return 1;
+  }
+  return 0;
+}
+
+void tcp_input(struct pbuf *p, struct netif *inp)
+{
+  tcphdr = (struct tcp_hdr *)p->payload;
+
+  if (p->len < TCP_HLEN) {
+    goto dropped;
+  }
+  /* Don't even process incoming broadcasts/multicasts. */
+  if (ip4_addr_isbroadcast(ip4_current_dest_addr(), inp) ||
+      ip4_addr_ismulticast(ip4_current_dest_addr())) {
+    goto dropped;
+  }
+  if (inet_chksum_pseudo(p, IP_PROTO_TCP, p->tot_len, ip4_current_src_addr(), ip4_current_dest_addr()) != 0) {
+    goto dropped;
+  }
+  u8_t hdrlen_bytes = TCPH_HDRLEN_BYTES(tcphdr);
+  if ((hdrlen_bytes < TCP_HLEN) || (hdrlen_bytes > p->len)) {
+    goto dropped;
+  }
+  tcphdr_optlen = (u16_t)(hdrlen_bytes - TCP_HLEN);
+  pbuf_remove_header(p, hdrlen_bytes);
+
+  /* Convert fields in TCP header to host byte order. */
+  tcphdr->src = lwip_ntohs(tcphdr->src);
+  tcphdr->dest = lwip_ntohs(tcphdr->dest);
+  seqno = tcphdr->seqno = lwip_ntohl(tcphdr->seqno);
+  ackno = tcphdr->ackno = lwip_ntohl(tcphdr->ackno);
+  tcphdr->wnd = lwip_ntohs(tcphdr->wnd);
+
+  flags = TCPH_FLAGS(tcphdr);
+  tcplen = p->tot_len;
+  if (flags & (TCP_FIN | TCP_SYN)) {
+    tcplen++;
+    if (tcplen < p->tot_len) {
+      goto dropped;
+    }
+  }
+
+  /* Demultiplex an incoming segment. First, we check if it is destined for an active connection. */
+  struct tcp_pcb *pcb;
+  struct tcp_pcb *prev = NULL;
+  for (pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next) {
+    if (pcb->remote_port == tcphdr->src && pcb->local_port == tcphdr->dest &&
+        ip4_addr_cmp(&pcb->remote_ip, ip4_current_src_addr()) &&
+        ip4_addr_cmp(&pcb->local_ip, ip4_current_dest_addr())) {
+      /* Move this PCB to the front of the list so that subsequent lookups will be faster */
+      if (prev != NULL) {
+        prev->next = pcb->next;
+        pcb->next = tcp_active_pcbs;
+        tcp_active_pcbs = pcb;
+      }
+      break;
+    }
+    prev = pcb;
+  }
+
+  if (pcb == NULL) {
+    for (pcb = tcp_tw_pcbs; pcb != NULL; pcb = pcb->next) {
+      if (pcb->remote_port == tcphdr->src && pcb->local_port == tcphdr->dest &&
+          ip4_addr_cmp(&pcb->remote_ip, ip4_current_src_addr()) &&
+          ip4_addr_cmp(&pcb->local_ip, ip4_current_dest_addr())) {
+        tcp_timewait_input(pcb);
+        pbuf_free(p);
+        return;
+      }
+    }
+
+    struct tcp_pcb *lpcb_any = NULL;
+    struct tcp_pcb *lpcb;
+    for (lpcb = tcp_listen_pcbs; lpcb != NULL; lpcb = lpcb->next) {
+      if (lpcb->local_port == tcphdr->dest) {
+        if (ip4_addr_cmp(&lpcb->local_ip, ip4_current_dest_addr())) {
+          break;
+        }
+        if (ip4_addr_isany(&lpcb->local_ip)) {
+          lpcb_any = lpcb;
+        }
+      }
+    }
+    if (lpcb == NULL) {
+      lpcb = lpcb_any;
+    }
+    if (lpcb != NULL) {
+      tcp_listen_input(lpcb);
+      pbuf_free(p);
+      return;
+    }
+  }
+
+  if (pcb != NULL) {
+    err_t err;
+    inseg.next = NULL;
+    inseg.len = p->tot_len;
+    inseg.p = p;
+    inseg.tcphdr = tcphdr;
+    recv_data = NULL;
+    recv_flags = 0;
+    recv_acked = 0;
+
+    if (flags & TCP_PSH) {
+      p->flags |= PBUF_FLAG_PUSH;
+    }
+
+    /* If there is data which was previously "refused" by upper layer */
+    if (pcb->refused_data != NULL) {
+      if ((tcp_process_refused_data(pcb) == ERR_ABRT) ||
+          ((pcb->refused_data != NULL) && (tcplen > 0))) {
+        /* pcb has been aborted or refused data is still refused and the new segment contains data */
+        if (pcb->rcv_ann_wnd == 0) {
+          /* this is a zero-window probe, we respond to it with current RCV.NXT */
+          tcp_send_empty_ack(pcb);
+        }
+        goto aborted;
+      }
+    }
+    tcp_input_pcb = pcb;
+    err = tcp_process(pcb);
+    /* A return value of ERR_ABRT means that tcp_abort() was called and that the pcb has been freed. */
+    if (err != ERR_ABRT) {
+      if (recv_flags & TF_RESET) {
+        /* TF_RESET means that the connection was reset by the other end. */
+        TCP_EVENT_ERR(pcb->errf, pcb->callback_arg, ERR_RST);
+        tcp_pcb_remove(&tcp_active_pcbs, pcb);
+        tcp_free(pcb);
+      } else {
+        err = ERR_OK;
+        /* If the application has registered a "sent" function to be called when new send buffer space is available, we call it now. */
+        if (recv_acked > 0) {
+          TCP_EVENT_SENT(pcb, (u16_t)recv_acked, err);
+          if (err == ERR_ABRT) {
+            goto aborted;
+          }
+          recv_acked = 0;
+        }
+        if (tcp_input_delayed_close(pcb)) {
+          goto aborted;
+        }
+        if (recv_data != NULL) {
+          if (pcb->flags & TF_RXCLOSED) {
+            /* received data although already closed -> abort (send RST) to notify the remote host */
+            pbuf_free(recv_data);
+            tcp_abort(pcb);
+            goto aborted;
+          }
+          /* Notify application that data has been received. */
+          TCP_EVENT_RECV(pcb, recv_data, ERR_OK, err);
+          if (err == ERR_ABRT) {
+            goto aborted;
+          }
+          /* If the upper layer can't receive this data, store it */
+          if (err != ERR_OK) {
+            pcb->refused_data = recv_data;
+          }
+        }
+
+        /* If a FIN segment was received, we call the callback function with a NULL buffer to indicate EOF. */
+        if (recv_flags & TF_GOT_FIN) {
+          if (pcb->refused_data != NULL) {
+            /* Delay this if we have refused data. */
+            pcb->refused_data->flags |= PBUF_FLAG_TCP_FIN;
+          } else {
+            /* correct rcv_wnd as the application won't call tcp_recved() for the FIN's seqno */
+            if (pcb->rcv_wnd != TCP_WND_MAX(pcb)) {
+              pcb->rcv_wnd++;
+            }
+            TCP_EVENT_CLOSED(pcb, err);
+            if (err == ERR_ABRT) {
+              goto aborted;
+            }
+          }
+        }
+
+        tcp_input_pcb = NULL;
+        if (tcp_input_delayed_close(pcb)) {
+          goto aborted;
+        }
+        /* Try to send something out. */
+        tcp_output(pcb);
+      }
+    }
+aborted:
+    tcp_input_pcb = NULL;
+    recv_data = NULL;
+    if (inseg.p != NULL) {
+      pbuf_free(inseg.p);
+      inseg.p = NULL;
+    }
+  } else {
+    /* If no matching PCB was found, send a TCP RST (reset) to the sender. */
+    if (!(flags & TCP_RST)) {
+      tcp_rst(NULL, ackno, seqno + tcplen, ip4_current_dest_addr(), ip4_current_src_addr(),
+              tcphdr->dest, tcphdr->src);
+    }
+    pbuf_free(p);
+  }
+  return;
+
+dropped:
+  pbuf_free(p);
+}
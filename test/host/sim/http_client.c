@@ -0,0 +1,169 @@
+/**
+ * @file
+ * @brief HTTP/1.1 client on a simulated peer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "sim.h"
+#include "http_client.h"
+
+static void http_client_done(struct http_client *h)
+{
+  h->in_body = false;
+  h->responses++;
+  h->done_ns = sim_now_ns();
+  if (h->on_response) {
+    h->on_response(h, h->arg);
+  }
+}
+
+const char *http_client_header(struct http_client *h, const char *name, char *out, size_t size)
+{
+  size_t nlen = strlen(name);
+  const char *p = strstr(h->head, "\r\n");
+  while (p != NULL && p[2] != '\r' && p[2] != '\0') {
+    const char *line = p + 2;
+    const char *end = strstr(line, "\r\n");
+    if (end == NULL) {
+      break;
+    }
+    if ((size_t)(end - line) > nlen && line[nlen] == ':' && strncasecmp(line, name, nlen) == 0) {
+      const char *v = line + nlen + 1;
+      while (*v == ' ') v++;
+      size_t n = (size_t)(end - v) < size - 1 ? (size_t)(end - v) : size - 1;
+      memcpy(out, v, n);
+      out[n] = '\0';
+      return out;
+    }
+    p = end;
+  }
+  return NULL;
+}
+
+/**
+ * @brief Parses a complete response head.
+ */
+static void http_client_head(struct http_client *h)
+{
+  char v[32];
+  h->status = 0;
+  if (sscanf(h->head, "HTTP/1.%*d %d", &h->status) != 1) {
+    h->bad++;
+  }
+  h->content_length = -1;
+  if (http_client_header(h, "Content-Length", v, sizeof(v))) {
+    h->content_length = strtol(v, NULL, 10);
+  }
+  h->close = http_client_header(h, "Connection", v, sizeof(v)) && strcasecmp(v, "close") == 0;
+  if (h->status / 100 == 1 || h->status == 204 || h->status == 304) {
+    h->content_length = 0;
+  }
+  h->in_body = true;
+  h->body_got = 0;
+  if (h->content_length == 0) {
+    http_client_done(h);
+  }
+}
+
+static void http_client_recv(struct peer_conn *c, const uint8_t *data, size_t len, void *arg)
+{
+  struct http_client *h = (struct http_client *)arg;
+  (void)c;
+  while (len > 0) {
+    if (!h->in_body) {
+      if (h->head_len >= sizeof(h->head) - 1) {
+        h->bad++;
+        return;
+      }
+      if (h->head_len == 0 || (h->head_len >= 4 && strcmp(h->head + h->head_len - 4, "\r\n\r\n") == 0)) {
+        h->head_len = 0;
+      }
+      h->head[h->head_len++] = (char)*data++;
+      h->head[h->head_len] = '\0';
+      len--;
+      if (h->head_len >= 4 && strcmp(h->head + h->head_len - 4, "\r\n\r\n") == 0) {
+        http_client_head(h);
+      }
+      continue;
+    }
+    size_t n = len;
+    if (h->content_length >= 0 && n > (size_t)h->content_length - h->body_got) {
+      n = (size_t)h->content_length - h->body_got;
+    }
+    if (h->body_got + n > h->body_cap) {
+      h->body_cap = (h->body_got + n) * 2;
+      h->body = (uint8_t *)realloc(h->body, h->body_cap);
+    }
+    memcpy(h->body + h->body_got, data, n);
+    h->body_got += n;
+    data += n;
+    len -= n;
+    if (h->content_length >= 0 && h->body_got == (size_t)h->content_length) {
+      http_client_done(h);
+    }
+  }
+}
+
+static void http_client_event(struct peer_conn *c, enum peer_conn_event ev, void *arg)
+{
+  struct http_client *h = (struct http_client *)arg;
+  switch (ev) {
+    case PEER_CONN_CONNECTED:
+      h->connected = true;
+      break;
+    case PEER_CONN_REMOTE_CLOSED:
+      h->closed = true;
+      if (h->in_body && h->content_length < 0) {
+        http_client_done(h);
+      }
+      peer_close(c);
+      break;
+    case PEER_CONN_RESET:
+      h->reset = true;
+      h->closed = true;
+      break;
+    case PEER_CONN_CLOSED:
+      break;
+  }
+}
+
+void http_client_connect(struct http_client *h, struct peer *peer, uint32_t ip, uint16_t port)
+{
+  h->head_len = 0;
+  h->head[0] = '\0';
+  h->in_body = false;
+  h->status = 0;
+  h->close = h->connected = h->closed = h->reset = false;
+  h->conn.on_recv = http_client_recv;
+  h->conn.on_event = http_client_event;
+  h->conn.arg = h;
+  peer_connect(peer, &h->conn, ip, port);
+}
+
+void http_client_send(struct http_client *h, const void *data, size_t len)
+{
+  h->sent_ns = sim_now_ns();
+  peer_write(&h->conn, data, len);
+}
+
+void http_client_get(struct http_client *h, const char *path, bool keep_alive)
+{
+  char req[256];
+  int n = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: board\r\nConnection: %s\r\n\r\n",
+                   path, keep_alive ? "keep-alive" : "close");
+  http_client_send(h, req, (size_t)n);
+}
+
+void http_client_free(struct http_client *h)
+{
+  free(h->body);
+  h->body = NULL;
+  h->body_cap = 0;
+  free(h->conn.tx);
+  h->conn.tx = NULL;
+  h->conn.tx_cap = 0;
+}
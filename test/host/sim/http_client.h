@@ -0,0 +1,83 @@
+/**
+ * @file
+ * @brief HTTP/1.1 client on a simulated peer.
+ *
+ * Sends raw requests over one connection and splits the byte stream back
+ * into responses by Content-Length (or connection close), so pipelined and
+ * keep-alive exchanges can be checked response by response.
+ */
+
+#ifndef __SIM_HTTP_CLIENT_H__
+#define __SIM_HTTP_CLIENT_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "peer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HTTP_CLIENT_HEAD_MAX 1024
+
+struct http_client;
+
+/**
+ * @brief Called from an event when a response is complete.
+ */
+typedef void (*http_client_fn)(struct http_client *h, void *arg);
+
+struct http_client {
+  struct peer_conn conn;
+  char head[HTTP_CLIENT_HEAD_MAX];      /**< Head of the response being received, then of the last one */
+  size_t head_len;
+  bool in_body;                         /**< Head complete, receiving the body */
+  long content_length;                  /**< Body length, -1 until the connection closes */
+  size_t body_got;                      /**< Body bytes of the current response */
+  uint8_t *body;                        /**< Body of the current or last response */
+  size_t body_cap;
+  int status;                           /**< Status of the current or last response */
+  bool close;                           /**< Connection: close in the last head */
+  bool connected;
+  bool closed;                          /**< Board closed the connection */
+  bool reset;
+  uint32_t responses;                   /**< Complete responses */
+  uint32_t bad;                         /**< Malformed heads */
+  uint64_t sent_ns;                     /**< Time of the last http_client_send() */
+  uint64_t done_ns;                     /**< Time the last response completed */
+  http_client_fn on_response;
+  void *arg;
+};
+
+/**
+ * @brief Opens a connection; on_response and arg may be set beforehand.
+ */
+void http_client_connect(struct http_client *h, struct peer *peer, uint32_t ip, uint16_t port);
+
+/**
+ * @brief Sends raw request bytes.
+ */
+void http_client_send(struct http_client *h, const void *data, size_t len);
+
+/**
+ * @brief Sends "GET @p path HTTP/1.1" with Connection: keep-alive or close.
+ */
+void http_client_get(struct http_client *h, const char *path, bool keep_alive);
+
+/**
+ * @brief Value of a header of the last response head, NULL if absent.
+ */
+const char *http_client_header(struct http_client *h, const char *name, char *out, size_t size);
+
+/**
+ * @brief Frees the body buffer.
+ */
+void http_client_free(struct http_client *h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SIM_HTTP_CLIENT_H__
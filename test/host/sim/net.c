@@ -0,0 +1,175 @@
+/**
+ * @file
+ * @brief Simulated Ethernet switch connecting chips and peers.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "net.h"
+
+#define NET_PORTS 8
+#define NET_MACS 64
+
+/**
+ * @brief Learned source address.
+ */
+struct net_mac {
+  uint8_t mac[6];
+  struct net_port *port;
+};
+
+/**
+ * @brief Frame on its way out of a port.
+ */
+struct net_frame {
+  struct net_port *port;
+  size_t len;
+  uint8_t data[];
+};
+
+static struct net_port *net_ports[NET_PORTS];
+static size_t net_port_count;
+static struct net_mac net_macs[NET_MACS];
+static size_t net_mac_count;
+
+void net_reset(void)
+{
+  net_port_count = 0;
+  net_mac_count = 0;
+}
+
+void net_attach(struct net_port *port)
+{
+  if (net_port_count < NET_PORTS) {
+    port->busy_until = 0;
+    port->frames_in = port->frames_out = 0;
+    net_ports[net_port_count++] = port;
+  }
+}
+
+static void net_chip_deliver(struct net_port *port, const uint8_t *frame, size_t len)
+{
+  w5500_sim_receive((struct w5500_sim *)port->arg, frame, len);
+}
+
+static void net_chip_tx(struct w5500_sim *chip, const uint8_t *frame, size_t len, void *arg)
+{
+  (void)chip;
+  net_send((struct net_port *)arg, frame, len);
+}
+
+void net_attach_chip(struct net_port *port, struct w5500_sim *chip)
+{
+  port->deliver = net_chip_deliver;
+  port->arg = chip;
+  chip->tx_hook = net_chip_tx;
+  chip->tx_arg = port;
+  net_attach(port);
+}
+
+/**
+ * @brief Drops the learned addresses of a port.
+ */
+static void net_flush(struct net_port *port)
+{
+  size_t j = 0;
+  for (size_t i = 0; i < net_mac_count; i++) {
+    if (net_macs[i].port != port) {
+      net_macs[j++] = net_macs[i];
+    }
+  }
+  net_mac_count = j;
+}
+
+void net_set_cable(struct net_port *port, bool plugged)
+{
+  w5500_sim_set_cable((struct w5500_sim *)port->arg, plugged);
+  if (!plugged) {
+    net_flush(port);
+  }
+}
+
+uint64_t net_wire_ns(size_t len)
+{
+  /* Preamble, minimum frame, FCS and inter-frame gap */
+  uint64_t wire = (len < 60 ? 60 : len) + 4 + 8 + 12;
+  return wire * 8u * 1000000000u / NET_BPS;
+}
+
+static void net_learn(const uint8_t *src, struct net_port *port)
+{
+  if (src[0] & 0x01) {
+    return;
+  }
+  for (size_t i = 0; i < net_mac_count; i++) {
+    if (memcmp(net_macs[i].mac, src, 6) == 0) {
+      net_macs[i].port = port;
+      return;
+    }
+  }
+  if (net_mac_count < NET_MACS) {
+    memcpy(net_macs[net_mac_count].mac, src, 6);
+    net_macs[net_mac_count++].port = port;
+  }
+}
+
+static struct net_port *net_lookup(const uint8_t *dst)
+{
+  if (dst[0] & 0x01) {
+    return NULL;
+  }
+  for (size_t i = 0; i < net_mac_count; i++) {
+    if (memcmp(net_macs[i].mac, dst, 6) == 0) {
+      return net_macs[i].port;
+    }
+  }
+  return NULL;
+}
+
+static void net_deliver(void *arg)
+{
+  struct net_frame *f = (struct net_frame *)arg;
+  f->port->frames_out++;
+  f->port->deliver(f->port, f->data, f->len);
+  free(f);
+}
+
+/**
+ * @brief Queues a frame on the egress of @p port, received completely at @p at.
+ */
+static void net_forward(struct net_port *port, const void *frame, size_t len, uint64_t at)
+{
+  struct net_frame *f = (struct net_frame *)malloc(sizeof(*f) + len);
+  f->port = port;
+  f->len = len;
+  memcpy(f->data, frame, len);
+  uint64_t start = port->busy_until > at ? port->busy_until : at;
+  port->busy_until = start + net_wire_ns(len);
+  sim_at(port->busy_until, net_deliver, f);
+}
+
+void net_send(struct net_port *from, const void *frame, size_t len)
+{
+  const uint8_t *f = (const uint8_t *)frame;
+  if (len < 14) {
+    return;
+  }
+  from->frames_in++;
+  net_learn(f + 6, from);
+
+  uint64_t at = sim_now_ns() + net_wire_ns(len);
+  struct net_port *to = net_lookup(f);
+  if (to != NULL) {
+    if (to != from) {
+      net_forward(to, frame, len, at);
+    }
+    return;
+  }
+  for (size_t i = 0; i < net_port_count; i++) {
+    if (net_ports[i] != from) {
+      net_forward(net_ports[i], frame, len, at);
+    }
+  }
+}
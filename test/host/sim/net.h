@@ -0,0 +1,76 @@
+/**
+ * @file
+ * @brief Simulated Ethernet switch connecting chips and peers.
+ *
+ * Store-and-forward at 100 Mbit/s with per-port egress serialization and
+ * MAC learning. Unknown unicast, broadcast and multicast are flooded;
+ * learned addresses are forgotten when a port loses its link, as a switch
+ * does, so traffic follows a MAC address that moves to another port.
+ */
+
+#ifndef __SIM_NET_H__
+#define __SIM_NET_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "w5500_sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Line rate of every port.
+ */
+#define NET_BPS 100000000u
+
+/**
+ * @brief One switch port and the device behind it.
+ */
+struct net_port {
+  /** Delivers a frame to the device, called from an event */
+  void (*deliver)(struct net_port *port, const uint8_t *frame, size_t len);
+  void *arg;                    /**< Device, for deliver */
+  uint64_t busy_until;          /**< End of the frame being sent out of the port */
+  uint64_t frames_out;          /**< Frames sent out of the port */
+  uint64_t frames_in;           /**< Frames received on the port */
+};
+
+/**
+ * @brief Forgets every port and learned address.
+ */
+void net_reset(void);
+
+/**
+ * @brief Connects a device to the next free port.
+ */
+void net_attach(struct net_port *port);
+
+/**
+ * @brief Connects a simulated chip: its transmitted frames enter the switch
+ *        and forwarded frames are stored in its RX buffer.
+ */
+void net_attach_chip(struct net_port *port, struct w5500_sim *chip);
+
+/**
+ * @brief Plugs or unplugs the cable of a chip port.
+ */
+void net_set_cable(struct net_port *port, bool plugged);
+
+/**
+ * @brief A frame enters the switch on @p from.
+ */
+void net_send(struct net_port *from, const void *frame, size_t len);
+
+/**
+ * @brief Time a frame of @p len bytes takes on the wire, with preamble and gap.
+ */
+uint64_t net_wire_ns(size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SIM_NET_H__
@@ -0,0 +1,838 @@
+/**
+ * @file
+ * @brief Simulated hosts on the switch: ARP, DHCP server and TCP client.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "peer.h"
+
+#define ETH_HLEN 14
+#define IP_HLEN 20
+#define TCP_HLEN 20
+#define UDP_HLEN 8
+#define FRAME_MAX 1514
+
+#define TCP_FIN 0x01
+#define TCP_SYN 0x02
+#define TCP_RST 0x04
+#define TCP_PSH 0x08
+#define TCP_ACK 0x10
+
+#define PEER_TCP_MAX_RETRIES 12
+
+static const uint8_t broadcast_mac[6] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+
+static void put16(uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t)(v >> 8);
+  p[1] = (uint8_t)v;
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)(v >> 24);
+  p[1] = (uint8_t)(v >> 16);
+  p[2] = (uint8_t)(v >> 8);
+  p[3] = (uint8_t)v;
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+  return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint32_t csum_add(uint32_t acc, const uint8_t *p, size_t len)
+{
+  for (size_t i = 0; i + 1 < len; i += 2) {
+    acc += get16(p + i);
+  }
+  if (len & 1) {
+    acc += (uint32_t)p[len - 1] << 8;
+  }
+  return acc;
+}
+
+static uint16_t csum_fold(uint32_t acc)
+{
+  while (acc >> 16) {
+    acc = (acc & 0xffff) + (acc >> 16);
+  }
+  return (uint16_t)~acc;
+}
+
+/**
+ * @brief Checksum of a TCP or UDP segment with its IPv4 pseudo header.
+ */
+static uint16_t csum_pseudo(uint32_t src, uint32_t dst, uint8_t proto, const uint8_t *seg, size_t len)
+{
+  uint32_t acc = (src >> 16) + (src & 0xffff) + (dst >> 16) + (dst & 0xffff) + proto + (uint32_t)len;
+  return csum_fold(csum_add(acc, seg, len));
+}
+
+static bool seq_lt(uint32_t a, uint32_t b)
+{
+  return (int32_t)(a - b) < 0;
+}
+
+static bool seq_leq(uint32_t a, uint32_t b)
+{
+  return (int32_t)(a - b) <= 0;
+}
+
+/* Transmission */
+
+/**
+ * @brief Frame leaving the peer after its processing time.
+ */
+struct peer_tx {
+  struct peer *peer;
+  size_t len;
+  uint8_t data[];
+};
+
+static void peer_tx_event(void *arg)
+{
+  struct peer_tx *tx = (struct peer_tx *)arg;
+  net_send(&tx->peer->port, tx->data, tx->len);
+  free(tx);
+}
+
+static void peer_xmit_after(struct peer *peer, const uint8_t *frame, size_t len, uint64_t delay)
+{
+  if (delay == 0) {
+    net_send(&peer->port, frame, len);
+    return;
+  }
+  struct peer_tx *tx = (struct peer_tx *)malloc(sizeof(*tx) + len);
+  tx->peer = peer;
+  tx->len = len;
+  memcpy(tx->data, frame, len);
+  sim_after(delay, peer_tx_event, tx);
+}
+
+void peer_send_frame(struct peer *peer, const void *frame, size_t len)
+{
+  peer_xmit_after(peer, (const uint8_t *)frame, len, peer->proc_ns);
+}
+
+static void eth_header(uint8_t *f, const uint8_t *dst, const uint8_t *src, uint16_t type)
+{
+  memcpy(f, dst, 6);
+  memcpy(f + 6, src, 6);
+  put16(f + 12, type);
+}
+
+static void arp_send(struct peer *peer, uint16_t op, const uint8_t *dst_mac, const uint8_t *tha, uint32_t tpa)
+{
+  uint8_t f[60];
+  memset(f, 0, sizeof(f));
+  eth_header(f, dst_mac, peer->mac, 0x0806);
+  put16(f + 14, 1);
+  put16(f + 16, 0x0800);
+  f[18] = 6;
+  f[19] = 4;
+  put16(f + 20, op);
+  memcpy(f + 22, peer->mac, 6);
+  put32(f + 28, peer->ip);
+  memcpy(f + 32, tha, 6);
+  put32(f + 38, tpa);
+  peer_send_frame(peer, f, sizeof(f));
+}
+
+static const uint8_t *arp_lookup(struct peer *peer, uint32_t ip)
+{
+  for (size_t i = 0; i < PEER_ARP_SIZE; i++) {
+    if (peer->arp[i].valid && peer->arp[i].ip == ip) {
+      return peer->arp[i].mac;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Updates the cache; adds the entry only if @p create.
+ */
+static void arp_learn(struct peer *peer, uint32_t ip, const uint8_t *mac, bool create)
+{
+  size_t slot = PEER_ARP_SIZE;
+  for (size_t i = 0; i < PEER_ARP_SIZE; i++) {
+    if (peer->arp[i].valid && peer->arp[i].ip == ip) {
+      slot = i;
+      break;
+    }
+    if (!peer->arp[i].valid && slot == PEER_ARP_SIZE) {
+      slot = i;
+    }
+  }
+  if (slot == PEER_ARP_SIZE || (!create && !(peer->arp[slot].valid && peer->arp[slot].ip == ip))) {
+    return;
+  }
+  peer->arp[slot].ip = ip;
+  memcpy(peer->arp[slot].mac, mac, 6);
+  peer->arp[slot].valid = true;
+
+  for (size_t i = 0; i < PEER_ARP_QUEUE; i++) {
+    if (peer->arp_queue[i].frame != NULL && peer->arp_queue[i].ip == ip) {
+      memcpy(peer->arp_queue[i].frame, mac, 6);
+      peer_send_frame(peer, peer->arp_queue[i].frame, peer->arp_queue[i].len);
+      free(peer->arp_queue[i].frame);
+      peer->arp_queue[i].frame = NULL;
+    }
+  }
+}
+
+void peer_arp_flush(struct peer *peer)
+{
+  memset(peer->arp, 0, sizeof(peer->arp));
+}
+
+void peer_arp_add(struct peer *peer, uint32_t ip, const uint8_t mac[6])
+{
+  arp_learn(peer, ip, mac, true);
+}
+
+/**
+ * @brief Sends an IPv4 packet whose frame is complete but for the destination MAC.
+ */
+static void ip_send(struct peer *peer, uint8_t *f, size_t len, uint32_t dst_ip)
+{
+  if (dst_ip == 0xffffffffu || (dst_ip | peer->netmask) == 0xffffffffu) {
+    memcpy(f, broadcast_mac, 6);
+    peer_send_frame(peer, f, len);
+    return;
+  }
+  const uint8_t *mac = arp_lookup(peer, dst_ip);
+  if (mac != NULL) {
+    memcpy(f, mac, 6);
+    peer_send_frame(peer, f, len);
+    return;
+  }
+  /* A full queue drops its oldest frame, as Linux does */
+  size_t slot = 0;
+  for (size_t i = 0; i < PEER_ARP_QUEUE; i++) {
+    if (peer->arp_queue[i].frame == NULL) {
+      slot = i;
+      break;
+    }
+    if (peer->arp_queue[i].at_ns < peer->arp_queue[slot].at_ns) {
+      slot = i;
+    }
+  }
+  free(peer->arp_queue[slot].frame);
+  peer->arp_queue[slot].frame = (uint8_t *)malloc(len);
+  memcpy(peer->arp_queue[slot].frame, f, len);
+  peer->arp_queue[slot].len = len;
+  peer->arp_queue[slot].ip = dst_ip;
+  peer->arp_queue[slot].at_ns = sim_now_ns();
+  static const uint8_t zero_mac[6];
+  peer->arp_requests_sent++;
+  arp_send(peer, 1, broadcast_mac, zero_mac, dst_ip);
+}
+
+static void ip_header(struct peer *peer, uint8_t *f, size_t payload_len, uint8_t proto, uint32_t dst_ip)
+{
+  uint8_t *ip = f + ETH_HLEN;
+  static uint16_t ip_id;
+  memset(ip, 0, IP_HLEN);
+  ip[0] = 0x45;
+  put16(ip + 2, (uint16_t)(IP_HLEN + payload_len));
+  put16(ip + 4, ip_id++);
+  put16(ip + 6, 0x4000);
+  ip[8] = 64;
+  ip[9] = proto;
+  put32(ip + 12, peer->ip);
+  put32(ip + 16, dst_ip);
+  put16(ip + 10, csum_fold(csum_add(0, ip, IP_HLEN)));
+  eth_header(f, broadcast_mac, peer->mac, 0x0800);
+}
+
+static size_t udp_frame(struct peer *peer, uint8_t *f, uint32_t src_ip, uint32_t dst_ip, uint16_t sport,
+                        uint16_t dport, const void *data, size_t len)
+{
+  uint8_t *udp = f + ETH_HLEN + IP_HLEN;
+  put16(udp, sport);
+  put16(udp + 2, dport);
+  put16(udp + 4, (uint16_t)(UDP_HLEN + len));
+  put16(udp + 6, 0);
+  memcpy(udp + UDP_HLEN, data, len);
+  uint16_t sum = csum_pseudo(src_ip, dst_ip, 17, udp, UDP_HLEN + len);
+  put16(udp + 6, sum == 0 ? 0xffff : sum);
+  ip_header(peer, f, UDP_HLEN + len, 17, dst_ip);
+  put32(f + ETH_HLEN + 12, src_ip);
+  f[ETH_HLEN + 10] = f[ETH_HLEN + 11] = 0;
+  put16(f + ETH_HLEN + 10, csum_fold(csum_add(0, f + ETH_HLEN, IP_HLEN)));
+  return ETH_HLEN + IP_HLEN + UDP_HLEN + len;
+}
+
+void peer_send_udp(struct peer *peer, uint32_t dst_ip, uint16_t sport, uint16_t dport,
+                   const void *data, size_t len)
+{
+  uint8_t f[FRAME_MAX];
+  if (len > FRAME_MAX - ETH_HLEN - IP_HLEN - UDP_HLEN) {
+    return;
+  }
+  memset(f, 0, 60);
+  size_t n = udp_frame(peer, f, peer->ip, dst_ip, sport, dport, data, len);
+  ip_send(peer, f, n < 60 ? 60 : n, dst_ip);
+}
+
+/* DHCP server */
+
+void peer_dhcp_server(struct peer *peer, uint32_t pool, uint32_t lease_s)
+{
+  peer->dhcp_server = true;
+  peer->dhcp_pool = pool;
+  peer->dhcp_lease_s = lease_s;
+  peer->dhcp_delay_ns = 1000000;
+}
+
+static uint32_t dhcp_binding(struct peer *peer, const uint8_t *chaddr, uint32_t want)
+{
+  for (size_t i = 0; i < peer->dhcp_binding_count; i++) {
+    if (memcmp(peer->dhcp_bindings[i].mac, chaddr, 6) == 0) {
+      return peer->dhcp_bindings[i].ip;
+    }
+  }
+  if (peer->dhcp_binding_count == PEER_DHCP_BINDINGS) {
+    return 0;
+  }
+  for (size_t i = 0; i < peer->dhcp_binding_count; i++) {
+    if (peer->dhcp_bindings[i].ip == want) {
+      want = 0;   /* leased to another client */
+    }
+  }
+  uint32_t ip = want ? want : peer->dhcp_pool + (uint32_t)peer->dhcp_binding_count;
+  memcpy(peer->dhcp_bindings[peer->dhcp_binding_count].mac, chaddr, 6);
+  peer->dhcp_bindings[peer->dhcp_binding_count++].ip = ip;
+  return ip;
+}
+
+static void dhcp_reply(struct peer *peer, const uint8_t *req, uint8_t type, uint32_t yiaddr)
+{
+  uint8_t msg[300];
+  memset(msg, 0, sizeof(msg));
+  msg[0] = 2;
+  msg[1] = 1;
+  msg[2] = 6;
+  memcpy(msg + 4, req + 4, 4);          /* xid */
+  memcpy(msg + 10, req + 10, 2);        /* flags */
+  put32(msg + 16, yiaddr);
+  put32(msg + 20, peer->ip);
+  memcpy(msg + 28, req + 28, 16);       /* chaddr */
+  put32(msg + 236, 0x63825363u);
+  uint8_t *o = msg + 240;
+  *o++ = 53; *o++ = 1; *o++ = type;
+  *o++ = 54; *o++ = 4; put32(o, peer->ip); o += 4;
+  if (type != 6) {
+    *o++ = 51; *o++ = 4; put32(o, peer->dhcp_lease_s); o += 4;
+    *o++ = 1; *o++ = 4; put32(o, peer->netmask); o += 4;
+    *o++ = 3; *o++ = 4; put32(o, peer->ip); o += 4;
+  }
+  *o++ = 255;
+
+  uint8_t f[FRAME_MAX];
+  bool bcast = type == 6 || (req[10] & 0x80);
+  uint32_t dst = bcast ? 0xffffffffu : yiaddr;
+  size_t n = udp_frame(peer, f, peer->ip, dst, 67, 68, msg, sizeof(msg));
+  eth_header(f, bcast ? broadcast_mac : req + 28, peer->mac, 0x0800);
+  peer_xmit_after(peer, f, n, peer->dhcp_delay_ns);
+  if (type == 5) {
+    peer->dhcp.acks++;
+    peer->dhcp.last_ack_ns = sim_now_ns() + peer->dhcp_delay_ns;
+  } else if (type == 6) {
+    peer->dhcp.naks++;
+  } else {
+    peer->dhcp.offers++;
+  }
+}
+
+static void dhcp_input(struct peer *peer, const uint8_t *msg, size_t len)
+{
+  if (len < 241 || msg[0] != 1 || get32(msg + 236) != 0x63825363u) {
+    return;
+  }
+  uint8_t type = 0;
+  uint32_t requested = 0, server_id = 0;
+  for (size_t i = 240; i < len && msg[i] != 255;) {
+    if (msg[i] == 0) {
+      i++;
+      continue;
+    }
+    if (i + 1 >= len || i + 2 + msg[i + 1] > len) {
+      return;
+    }
+    const uint8_t *v = msg + i + 2;
+    switch (msg[i]) {
+      case 53: type = v[0]; break;
+      case 50: requested = get32(v); break;
+      case 54: server_id = get32(v); break;
+      default: break;
+    }
+    i += 2u + msg[i + 1];
+  }
+
+  uint32_t ciaddr = get32(msg + 12);
+  if (type == 1) {
+    peer->dhcp.discovers++;
+    uint32_t ip = dhcp_binding(peer, msg + 28, 0);
+    if (ip) {
+      dhcp_reply(peer, msg, 2, ip);
+    }
+  } else if (type == 3) {
+    peer->dhcp.requests++;
+    if (server_id != 0 && server_id != peer->ip) {
+      return;
+    }
+    uint32_t want = requested ? requested : ciaddr;
+    uint32_t ip = dhcp_binding(peer, msg + 28, want);
+    dhcp_reply(peer, msg, ip == want ? 5 : 6, ip == want ? ip : 0);
+  }
+}
+
+/* TCP client */
+
+static void tcp_rto(void *arg);
+static void tcp_delack(void *arg);
+
+static void tcp_send(struct peer_conn *c, uint8_t flags, uint32_t seq, const uint8_t *data, size_t len)
+{
+  struct peer *peer = c->peer;
+  uint8_t f[FRAME_MAX];
+  size_t opt = (flags & TCP_SYN) ? 4 : 0;
+  uint8_t *tcp = f + ETH_HLEN + IP_HLEN;
+  put16(tcp, c->local_port);
+  put16(tcp + 2, c->remote_port);
+  put32(tcp + 4, seq);
+  put32(tcp + 8, (flags & TCP_ACK) ? c->rcv_nxt : 0);
+  tcp[12] = (uint8_t)(((TCP_HLEN + opt) / 4) << 4);
+  tcp[13] = flags;
+  put16(tcp + 14, PEER_TCP_WND);
+  put16(tcp + 16, 0);
+  put16(tcp + 18, 0);
+  if (opt) {
+    tcp[20] = 2;
+    tcp[21] = 4;
+    put16(tcp + 22, PEER_TCP_MSS);
+  }
+  memcpy(tcp + TCP_HLEN + opt, data, len);
+  size_t seg = TCP_HLEN + opt + len;
+  put16(tcp + 16, csum_pseudo(peer->ip, c->remote_ip, 6, tcp, seg));
+  ip_header(peer, f, seg, 6, c->remote_ip);
+  size_t n = ETH_HLEN + IP_HLEN + seg;
+  if (n < 60) {
+    memset(f + n, 0, 60 - n);
+    n = 60;
+  }
+  if (flags & TCP_ACK) {
+    c->unacked_segs = 0;
+    sim_cancel(tcp_delack, c);
+  }
+  ip_send(peer, f, n, c->remote_ip);
+}
+
+static void tcp_ack_now(struct peer_conn *c)
+{
+  tcp_send(c, TCP_ACK, c->snd_nxt, NULL, 0);
+}
+
+static void tcp_delack(void *arg)
+{
+  struct peer_conn *c = (struct peer_conn *)arg;
+  if (c->state == PEER_TCP_ESTABLISHED) {
+    tcp_ack_now(c);
+  }
+}
+
+static void tcp_arm_rto(struct peer_conn *c)
+{
+  sim_cancel(tcp_rto, c);
+  sim_after((uint64_t)PEER_TCP_RTO_MS * 1000000u, tcp_rto, c);
+  c->rto_armed = true;
+}
+
+static void tcp_stop_rto(struct peer_conn *c)
+{
+  sim_cancel(tcp_rto, c);
+  c->rto_armed = false;
+}
+
+/**
+ * @brief Sends what the window allows; @p probe sends one byte into a zero window.
+ */
+static void tcp_output(struct peer_conn *c, bool probe)
+{
+  if (c->state != PEER_TCP_ESTABLISHED) {
+    return;
+  }
+  for (;;) {
+    size_t off = c->snd_nxt - c->snd_una;
+    if (off < c->tx_len) {
+      int64_t avail = (int64_t)c->snd_una + c->snd_wnd - c->snd_nxt;
+      if (avail <= 0) {
+        if (!probe) {
+          break;
+        }
+        avail = 1;
+      }
+      probe = false;
+      size_t n = c->tx_len - off;
+      if (n > c->mss) n = c->mss;
+      if ((int64_t)n > avail) n = (size_t)avail;
+      tcp_send(c, TCP_ACK | TCP_PSH, c->snd_nxt, c->tx + off, n);
+      c->snd_nxt += (uint32_t)n;
+    } else if (c->fin_queued && !c->fin_sent) {
+      tcp_send(c, TCP_ACK | TCP_FIN, c->snd_nxt, NULL, 0);
+      c->snd_nxt++;
+      c->fin_sent = true;
+      break;
+    } else {
+      break;
+    }
+  }
+  if (!c->rto_armed && (c->snd_nxt != c->snd_una || c->snd_nxt - c->snd_una < c->tx_len)) {
+    tcp_arm_rto(c);
+  }
+}
+
+static void tcp_unlink(struct peer_conn *c)
+{
+  tcp_stop_rto(c);
+  sim_cancel(tcp_delack, c);
+  for (size_t i = 0; i < PEER_CONNS; i++) {
+    if (c->peer->conns[i] == c) {
+      c->peer->conns[i] = NULL;
+    }
+  }
+  c->state = PEER_TCP_CLOSED;
+}
+
+static void tcp_event(struct peer_conn *c, enum peer_conn_event ev)
+{
+  if (c->on_event) {
+    c->on_event(c, ev, c->arg);
+  }
+}
+
+static void tcp_rto(void *arg)
+{
+  struct peer_conn *c = (struct peer_conn *)arg;
+  c->rto_armed = false;
+  if (++c->retries > PEER_TCP_MAX_RETRIES) {
+    tcp_unlink(c);
+    tcp_event(c, PEER_CONN_RESET);
+    return;
+  }
+  if (c->state == PEER_TCP_SYN_SENT) {
+    c->retransmits++;
+    tcp_send(c, TCP_SYN, c->iss, NULL, 0);
+    tcp_arm_rto(c);
+    return;
+  }
+  if (c->snd_nxt != c->snd_una) {
+    c->retransmits++;
+  }
+  c->snd_nxt = c->snd_una;
+  c->fin_sent = false;
+  tcp_output(c, true);
+}
+
+static void tcp_maybe_closed(struct peer_conn *c)
+{
+  if (c->local_closed && c->remote_closed) {
+    tcp_unlink(c);
+    tcp_event(c, PEER_CONN_CLOSED);
+  }
+}
+
+static void tcp_input(struct peer *peer, const uint8_t *ip, const uint8_t *tcp, size_t len)
+{
+  uint32_t src = get32(ip + 12);
+  uint16_t sport = get16(tcp), dport = get16(tcp + 2);
+  uint32_t seq = get32(tcp + 4), ack = get32(tcp + 8);
+  size_t hlen = (size_t)(tcp[12] >> 4) * 4;
+  uint8_t flags = tcp[13];
+  uint16_t wnd = get16(tcp + 14);
+  if (hlen < TCP_HLEN || hlen > len) {
+    return;
+  }
+  const uint8_t *data = tcp + hlen;
+  size_t dlen = len - hlen;
+
+  struct peer_conn *c = NULL;
+  for (size_t i = 0; i < PEER_CONNS; i++) {
+    struct peer_conn *k = peer->conns[i];
+    if (k && k->remote_ip == src && k->remote_port == sport && k->local_port == dport) {
+      c = k;
+      break;
+    }
+  }
+  if (c == NULL) {
+    if (!(flags & TCP_RST)) {
+      struct peer_conn rst;
+      memset(&rst, 0, sizeof(rst));
+      rst.peer = peer;
+      rst.remote_ip = src;
+      rst.remote_port = sport;
+      rst.local_port = dport;
+      rst.rcv_nxt = seq + (uint32_t)dlen + ((flags & TCP_SYN) ? 1 : 0) + ((flags & TCP_FIN) ? 1 : 0);
+      tcp_send(&rst, (flags & TCP_ACK) ? TCP_RST : TCP_RST | TCP_ACK, (flags & TCP_ACK) ? ack : 0, NULL, 0);
+    }
+    return;
+  }
+
+  if (flags & TCP_RST) {
+    tcp_unlink(c);
+    tcp_event(c, PEER_CONN_RESET);
+    return;
+  }
+
+  if (c->state == PEER_TCP_SYN_SENT) {
+    if ((flags & (TCP_SYN | TCP_ACK)) != (TCP_SYN | TCP_ACK) || ack != c->iss + 1) {
+      return;
+    }
+    c->snd_una = c->snd_nxt = ack;
+    c->rcv_nxt = seq + 1;
+    c->snd_wnd = wnd;
+    c->mss = 536;
+    for (size_t i = TCP_HLEN; i + 1 < hlen;) {
+      uint8_t kind = tcp[i];
+      if (kind == 0) break;
+      if (kind == 1) { i++; continue; }
+      uint8_t olen = tcp[i + 1];
+      if (olen < 2 || i + olen > hlen) break;
+      if (kind == 2 && olen == 4) c->mss = get16(tcp + i + 2);
+      i += olen;
+    }
+    if (c->mss > PEER_TCP_MSS) {
+      c->mss = PEER_TCP_MSS;
+    }
+    c->state = PEER_TCP_ESTABLISHED;
+    c->connected_ns = sim_now_ns();
+    c->retries = 0;
+    tcp_stop_rto(c);
+    tcp_ack_now(c);
+    tcp_event(c, PEER_CONN_CONNECTED);
+    tcp_output(c, false);
+    return;
+  }
+  if (c->state != PEER_TCP_ESTABLISHED) {
+    return;
+  }
+
+  if (flags & TCP_ACK) {
+    if (seq_lt(c->snd_una, ack) && seq_leq(ack, c->snd_nxt)) {
+      uint32_t acked = ack - c->snd_una;
+      size_t data_acked = acked < c->tx_len ? acked : c->tx_len;
+      memmove(c->tx, c->tx + data_acked, c->tx_len - data_acked);
+      c->tx_len -= data_acked;
+      if (acked > data_acked) {
+        c->local_closed = true;
+      }
+      c->snd_una = ack;
+      c->retries = 0;
+      if (c->snd_una == c->snd_nxt && c->tx_len == 0) {
+        tcp_stop_rto(c);
+      } else {
+        tcp_arm_rto(c);
+      }
+    }
+    if (seq_leq(c->snd_una, ack)) {
+      c->snd_wnd = wnd;
+    }
+  }
+
+  bool fin = (flags & TCP_FIN) != 0;
+  if (dlen > 0 || fin) {
+    if (seq != c->rcv_nxt) {
+      c->rx_ooo++;
+      tcp_ack_now(c);
+    } else {
+      if (dlen > 0) {
+        c->rcv_nxt += (uint32_t)dlen;
+        c->rx_bytes += dlen;
+        c->rx_segs++;
+        if (dlen == c->mss) c->rx_full_segs++;
+        if (dlen > c->rx_max_seg) c->rx_max_seg = (uint32_t)dlen;
+        if (c->on_recv) {
+          c->on_recv(c, data, dlen, c->arg);
+        }
+        if (c->state != PEER_TCP_ESTABLISHED) {
+          return;
+        }
+      }
+      if (fin) {
+        c->rcv_nxt++;
+        c->remote_closed = true;
+        tcp_ack_now(c);
+        tcp_event(c, PEER_CONN_REMOTE_CLOSED);
+        if (c->state != PEER_TCP_ESTABLISHED) {
+          return;
+        }
+      } else if (!c->peer->delayed_ack || c->rx_segs <= PEER_TCP_QUICKACKS || ++c->unacked_segs >= 2) {
+        tcp_ack_now(c);
+      } else {
+        sim_cancel(tcp_delack, c);
+        sim_after((uint64_t)PEER_TCP_DELACK_MS * 1000000u, tcp_delack, c);
+      }
+    }
+  }
+
+  tcp_output(c, false);
+  tcp_maybe_closed(c);
+}
+
+void peer_connect(struct peer *peer, struct peer_conn *c, uint32_t ip, uint16_t port)
+{
+  static uint32_t iss = 0x10000000u;
+  c->peer = peer;
+  c->state = PEER_TCP_SYN_SENT;
+  c->remote_ip = ip;
+  c->remote_port = port;
+  c->local_port = peer->next_port++;
+  if (peer->next_port < 40000) {
+    peer->next_port = 40000;
+  }
+  iss += 0x01000000u;
+  c->iss = iss;
+  c->snd_una = iss;
+  c->snd_nxt = iss + 1;
+  c->snd_wnd = 0;
+  c->rcv_nxt = 0;
+  c->mss = 536;
+  c->tx_len = 0;
+  c->fin_queued = c->fin_sent = c->local_closed = c->remote_closed = false;
+  c->unacked_segs = 0;
+  c->retries = 0;
+  c->syn_ns = sim_now_ns();
+  c->connected_ns = 0;
+  c->rx_bytes = 0;
+  c->rx_segs = c->rx_full_segs = c->rx_max_seg = c->rx_ooo = c->retransmits = 0;
+  for (size_t i = 0; i < PEER_CONNS; i++) {
+    if (peer->conns[i] == NULL) {
+      peer->conns[i] = c;
+      break;
+    }
+  }
+  tcp_send(c, TCP_SYN, c->iss, NULL, 0);
+  tcp_arm_rto(c);
+}
+
+void peer_write(struct peer_conn *c, const void *data, size_t len)
+{
+  if (c->tx_len + len > c->tx_cap) {
+    c->tx_cap = (c->tx_len + len) * 2;
+    c->tx = (uint8_t *)realloc(c->tx, c->tx_cap);
+  }
+  memcpy(c->tx + c->tx_len, data, len);
+  c->tx_len += len;
+  tcp_output(c, false);
+}
+
+void peer_close(struct peer_conn *c)
+{
+  c->fin_queued = true;
+  tcp_output(c, false);
+}
+
+void peer_drop(struct peer_conn *c)
+{
+  tcp_unlink(c);
+}
+
+/* Input */
+
+static void arp_input(struct peer *peer, const uint8_t *f, size_t len)
+{
+  if (len < 42 || get16(f + 14) != 1 || get16(f + 16) != 0x0800) {
+    return;
+  }
+  uint16_t op = get16(f + 20);
+  const uint8_t *sha = f + 22;
+  uint32_t spa = get32(f + 28), tpa = get32(f + 38);
+  if (spa != 0 && spa == tpa) {
+    peer->garp_seen++;
+    arp_learn(peer, spa, sha, false);
+    return;
+  }
+  if (tpa != peer->ip || spa == 0) {
+    return;
+  }
+  arp_learn(peer, spa, sha, true);
+  if (op == 1) {
+    arp_send(peer, 2, sha, sha, spa);
+  }
+}
+
+static void peer_deliver(struct net_port *port, const uint8_t *f, size_t len)
+{
+  struct peer *peer = (struct peer *)port->arg;
+  peer->rx_frames++;
+  if (peer->on_frame) {
+    peer->on_frame(peer, f, len, peer->frame_arg);
+  }
+  if (len < ETH_HLEN || ((f[0] & 1) == 0 && memcmp(f, peer->mac, 6) != 0)) {
+    return;
+  }
+  uint16_t type = get16(f + 12);
+  if (type == 0x0806) {
+    arp_input(peer, f, len);
+    return;
+  }
+  if (type != 0x0800 || len < ETH_HLEN + IP_HLEN) {
+    return;
+  }
+  const uint8_t *ip = f + ETH_HLEN;
+  size_t ihl = (size_t)(ip[0] & 0x0f) * 4;
+  size_t tot = get16(ip + 2);
+  if ((ip[0] >> 4) != 4 || ihl < IP_HLEN || tot < ihl || ETH_HLEN + tot > len) {
+    return;
+  }
+  if (csum_fold(csum_add(0, ip, ihl)) != 0) {
+    peer->rx_bad_checksum++;
+    return;
+  }
+  uint32_t src = get32(ip + 12), dst = get32(ip + 16);
+  bool bcast = dst == 0xffffffffu || (dst | peer->netmask) == 0xffffffffu;
+  if (dst != peer->ip && !bcast) {
+    return;
+  }
+  const uint8_t *l4 = ip + ihl;
+  size_t l4len = tot - ihl;
+  if (ip[9] == 6 && !bcast && l4len >= TCP_HLEN) {
+    if (csum_pseudo(src, dst, 6, l4, l4len) != 0) {
+      peer->rx_bad_checksum++;
+      return;
+    }
+    tcp_input(peer, ip, l4, l4len);
+  } else if (ip[9] == 17 && l4len >= UDP_HLEN) {
+    if (get16(l4 + 6) != 0 && csum_pseudo(src, dst, 17, l4, l4len) != 0) {
+      peer->rx_bad_checksum++;
+      return;
+    }
+    if (peer->dhcp_server && get16(l4 + 2) == 67) {
+      dhcp_input(peer, l4 + UDP_HLEN, l4len - UDP_HLEN);
+    }
+  }
+}
+
+void peer_init(struct peer *peer, const uint8_t mac[6], uint32_t ip, uint32_t netmask)
+{
+  memset(peer, 0, sizeof(*peer));
+  memcpy(peer->mac, mac, 6);
+  peer->ip = ip;
+  peer->netmask = netmask;
+  peer->proc_ns = 20000;
+  peer->delayed_ack = true;
+  peer->next_port = 40000;
+  peer->port.deliver = peer_deliver;
+  peer->port.arg = peer;
+  net_attach(&peer->port);
+}
@@ -0,0 +1,210 @@
+/**
+ * @file
+ * @brief Simulated hosts on the switch: ARP, DHCP server and TCP client.
+ *
+ * Peers are written independently of the stand-in lwIP stack so they check
+ * what the board puts on the wire rather than sharing its assumptions. The
+ * TCP client opens connections, sends data within the advertised window,
+ * retransmits after a fixed RTO and acknowledges like Linux with quick ACKs
+ * off: every second full segment, or after the delayed-ACK timeout.
+ */
+
+#ifndef __SIM_PEER_H__
+#define __SIM_PEER_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "net.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PEER_ARP_SIZE 16        /**< ARP cache entries */
+#define PEER_ARP_QUEUE 8        /**< Frames waiting for ARP resolution */
+#define PEER_DHCP_BINDINGS 8    /**< DHCP server leases */
+#define PEER_CONNS 16           /**< Open TCP connections per peer */
+#define PEER_TCP_MSS 1460       /**< MSS announced in SYN */
+#define PEER_TCP_WND 65535      /**< Receive window, the application reads immediately */
+#define PEER_TCP_RTO_MS 200     /**< Retransmission timeout (Linux minimum) */
+#define PEER_TCP_DELACK_MS 40   /**< Delayed ACK timeout (Linux minimum) */
+#define PEER_TCP_QUICKACKS 16   /**< Segments acknowledged at once at the start of a connection (Linux quickack) */
+
+struct peer;
+struct peer_conn;
+
+/**
+ * @brief TCP connection events.
+ */
+enum peer_conn_event {
+  PEER_CONN_CONNECTED,          /**< SYN-ACK received */
+  PEER_CONN_REMOTE_CLOSED,      /**< FIN received */
+  PEER_CONN_RESET,              /**< RST received or retransmissions exhausted */
+  PEER_CONN_CLOSED              /**< Both directions closed */
+};
+
+enum peer_conn_state {
+  PEER_TCP_CLOSED = 0,
+  PEER_TCP_SYN_SENT,
+  PEER_TCP_ESTABLISHED
+};
+
+/**
+ * @brief Client side of a TCP connection.
+ */
+struct peer_conn {
+  struct peer *peer;
+  uint8_t state;                /**< enum peer_conn_state */
+  uint32_t remote_ip;
+  uint16_t remote_port;
+  uint16_t local_port;
+  uint32_t iss;
+  uint32_t snd_una;             /**< Oldest unacknowledged sequence number */
+  uint32_t snd_nxt;             /**< Next sequence number to send */
+  uint32_t snd_wnd;             /**< Window advertised by the board */
+  uint32_t rcv_nxt;             /**< Next sequence number expected */
+  uint16_t mss;                 /**< MSS announced by the board */
+  uint8_t *tx;                  /**< Data from snd_una on, sent or not */
+  size_t tx_len;
+  size_t tx_cap;
+  bool fin_queued;              /**< peer_close() was called */
+  bool fin_sent;
+  bool local_closed;            /**< Our FIN was acknowledged */
+  bool remote_closed;           /**< FIN received */
+  uint8_t unacked_segs;         /**< Full segments received since our last ACK */
+  uint8_t retries;              /**< Consecutive retransmissions */
+  bool rto_armed;               /**< Retransmission timer running */
+  /** Called with in-order data, from an event */
+  void (*on_recv)(struct peer_conn *c, const uint8_t *data, size_t len, void *arg);
+  /** Called on connection events, from an event */
+  void (*on_event)(struct peer_conn *c, enum peer_conn_event ev, void *arg);
+  void *arg;                    /**< Argument of the callbacks */
+  /* Counters */
+  uint64_t syn_ns;              /**< Time the SYN was sent */
+  uint64_t connected_ns;        /**< Time the SYN-ACK arrived */
+  uint64_t rx_bytes;            /**< Payload received in order */
+  uint32_t rx_segs;             /**< Segments with payload received */
+  uint32_t rx_full_segs;        /**< Segments carrying exactly mss bytes */
+  uint32_t rx_max_seg;          /**< Largest payload of one segment */
+  uint32_t rx_ooo;              /**< Segments dropped as out of order */
+  uint32_t retransmits;         /**< Our retransmitted segments */
+};
+
+/**
+ * @brief DHCP server counters.
+ */
+struct peer_dhcp_stats {
+  uint32_t discovers;
+  uint32_t offers;
+  uint32_t requests;
+  uint32_t acks;
+  uint32_t naks;
+  uint64_t last_ack_ns;         /**< Time of the last ACK sent */
+};
+
+/**
+ * @brief Simulated host.
+ */
+struct peer {
+  struct net_port port;         /**< Switch port */
+  uint8_t mac[6];
+  uint32_t ip;                  /**< Host byte order */
+  uint32_t netmask;
+  uint32_t proc_ns;             /**< Time to process a frame before answering */
+  bool delayed_ack;             /**< Acknowledge every second segment instead of each one */
+  struct {
+    uint32_t ip;
+    uint8_t mac[6];
+    bool valid;
+  } arp[PEER_ARP_SIZE];
+  struct {
+    uint32_t ip;
+    size_t len;
+    uint8_t *frame;
+    uint64_t at_ns;             /**< Time the frame was queued */
+  } arp_queue[PEER_ARP_QUEUE];
+  bool dhcp_server;             /**< Answer DHCP clients */
+  uint32_t dhcp_pool;           /**< First address handed out */
+  uint32_t dhcp_lease_s;        /**< Lease time */
+  uint32_t dhcp_delay_ns;       /**< Server response time */
+  struct {
+    uint8_t mac[6];
+    uint32_t ip;
+  } dhcp_bindings[PEER_DHCP_BINDINGS];
+  size_t dhcp_binding_count;
+  struct peer_dhcp_stats dhcp;
+  struct peer_conn *conns[PEER_CONNS];
+  uint16_t next_port;
+  /** Sees every frame the peer receives, before processing */
+  void (*on_frame)(struct peer *peer, const uint8_t *frame, size_t len, void *arg);
+  void *frame_arg;
+  /* Counters */
+  uint64_t rx_frames;
+  uint32_t rx_bad_checksum;
+  uint32_t arp_requests_sent;
+  uint32_t garp_seen;           /**< Gratuitous ARPs received */
+};
+
+/**
+ * @brief Sets up a peer and connects it to the switch.
+ */
+void peer_init(struct peer *peer, const uint8_t mac[6], uint32_t ip, uint32_t netmask);
+
+/**
+ * @brief Makes the peer a DHCP server and router handing out addresses from @p pool.
+ */
+void peer_dhcp_server(struct peer *peer, uint32_t pool, uint32_t lease_s);
+
+/**
+ * @brief Sends a raw frame.
+ */
+void peer_send_frame(struct peer *peer, const void *frame, size_t len);
+
+/**
+ * @brief Sends a UDP datagram, resolving the destination with ARP.
+ */
+void peer_send_udp(struct peer *peer, uint32_t dst_ip, uint16_t sport, uint16_t dport,
+                   const void *data, size_t len);
+
+/**
+ * @brief Forgets the ARP cache.
+ */
+void peer_arp_flush(struct peer *peer);
+
+/**
+ * @brief Adds a static ARP entry.
+ */
+void peer_arp_add(struct peer *peer, uint32_t ip, const uint8_t mac[6]);
+
+/**
+ * @brief Opens a connection; callbacks and arg must be set in @p c beforehand.
+ */
+void peer_connect(struct peer *peer, struct peer_conn *c, uint32_t ip, uint16_t port);
+
+/**
+ * @brief Queues data on an open connection.
+ */
+void peer_write(struct peer_conn *c, const void *data, size_t len);
+
+/**
+ * @brief Sends FIN after the queued data.
+ */
+void peer_close(struct peer_conn *c);
+
+/**
+ * @brief Forgets a connection without telling the board.
+ */
+void peer_drop(struct peer_conn *c);
+
+/**
+ * @brief Builds an IPv4 address in host byte order.
+ */
+#define PEER_IP(a, b, c, d) (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | ((uint32_t)(c) << 8) | (uint32_t)(d))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SIM_PEER_H__
@@ -0,0 +1,328 @@
+/**
+ * @file
+ * @brief Simulated time and events for the host suite.
+ *
+ * Also provides the sys_arch functions, which sys_arch.cpp implements on
+ * the target; the debug output hooks are in sim_log.c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lwip/opt.h"
+#include "lwip/sys.h"
+
+#include "sim.h"
+
+/**
+ * @brief Pending event.
+ */
+struct sim_event {
+  uint64_t at;          /**< Due time */
+  uint64_t seq;         /**< Scheduling order, breaks ties */
+  sim_event_fn fn;      /**< Handler, NULL once cancelled */
+  void *arg;            /**< Handler argument */
+  int line;             /**< Interrupt line, -1 for a plain event */
+};
+
+#define SIM_PENDING_MAX 64  /**< Interrupts held pending at once */
+
+static uint64_t sim_ns;                 /**< Simulated time */
+static uint64_t sim_seq;                /**< Next scheduling sequence number */
+static struct sim_event *sim_heap;      /**< Binary min-heap of pending events */
+static size_t sim_heap_len;             /**< Events in sim_heap */
+static size_t sim_heap_cap;             /**< Capacity of sim_heap */
+static bool sim_in_event;               /**< An event handler is running */
+static uint64_t sim_event_ns;           /**< Host time spent in event handlers */
+static int sim_irq_depth;               /**< sys_arch_protect() nesting */
+static uint64_t sim_irq_start;          /**< Simulated time interrupts were disabled */
+static uint64_t sim_irq_max;            /**< Longest interrupts-off interval */
+static uint32_t sim_irq_lines;          /**< Lines masked with sim_irq_mask() */
+static struct sim_event sim_pending[SIM_PENDING_MAX]; /**< Interrupts due while masked, in due order */
+static size_t sim_pending_len;          /**< Entries in sim_pending */
+static int sim_verbose_flag = -1;       /**< Debug output, -1 until HOST_VERBOSE was read */
+
+static bool sim_before(const struct sim_event *a, const struct sim_event *b)
+{
+  return a->at < b->at || (a->at == b->at && a->seq < b->seq);
+}
+
+static void sim_heap_swap(size_t i, size_t j)
+{
+  struct sim_event t = sim_heap[i];
+  sim_heap[i] = sim_heap[j];
+  sim_heap[j] = t;
+}
+
+static void sim_heap_pop(void)
+{
+  sim_heap[0] = sim_heap[--sim_heap_len];
+  size_t i = 0;
+  for (;;) {
+    size_t l = 2 * i + 1, r = l + 1, m = i;
+    if (l < sim_heap_len && sim_before(&sim_heap[l], &sim_heap[m])) m = l;
+    if (r < sim_heap_len && sim_before(&sim_heap[r], &sim_heap[m])) m = r;
+    if (m == i) break;
+    sim_heap_swap(i, m);
+    i = m;
+  }
+}
+
+void sim_reset(void)
+{
+  sim_ns = 0;
+  sim_seq = 0;
+  sim_heap_len = 0;
+  sim_event_ns = 0;
+  sim_irq_depth = 0;
+  sim_irq_max = 0;
+  sim_irq_lines = 0;
+  sim_pending_len = 0;
+}
+
+uint64_t sim_now_ns(void)
+{
+  return sim_ns;
+}
+
+static void sim_push(uint64_t at_ns, int line, sim_event_fn fn, void *arg)
+{
+  if (sim_heap_len == sim_heap_cap) {
+    sim_heap_cap = sim_heap_cap ? 2 * sim_heap_cap : 256;
+    sim_heap = (struct sim_event *)realloc(sim_heap, sim_heap_cap * sizeof(*sim_heap));
+    if (sim_heap == NULL) {
+      abort();
+    }
+  }
+  size_t i = sim_heap_len++;
+  sim_heap[i].at = at_ns;
+  sim_heap[i].seq = sim_seq++;
+  sim_heap[i].fn = fn;
+  sim_heap[i].arg = arg;
+  sim_heap[i].line = line;
+  while (i > 0 && sim_before(&sim_heap[i], &sim_heap[(i - 1) / 2])) {
+    sim_heap_swap(i, (i - 1) / 2);
+    i = (i - 1) / 2;
+  }
+}
+
+void sim_at(uint64_t at_ns, sim_event_fn fn, void *arg)
+{
+  sim_push(at_ns, -1, fn, arg);
+}
+
+void sim_after(uint64_t delay_ns, sim_event_fn fn, void *arg)
+{
+  sim_at(sim_ns + delay_ns, fn, arg);
+}
+
+void sim_irq_after(uint64_t delay_ns, unsigned line, sim_event_fn fn, void *arg)
+{
+  sim_push(sim_ns + delay_ns, (int)line, fn, arg);
+}
+
+void sim_cancel(sim_event_fn fn, void *arg)
+{
+  for (size_t i = 0; i < sim_heap_len; i++) {
+    if (sim_heap[i].fn == fn && sim_heap[i].arg == arg) {
+      sim_heap[i].fn = NULL;
+    }
+  }
+  for (size_t i = 0; i < sim_pending_len; i++) {
+    if (sim_pending[i].fn == fn && sim_pending[i].arg == arg) {
+      sim_pending[i].fn = NULL;
+    }
+  }
+}
+
+uint64_t sim_next_event(void)
+{
+  while (sim_heap_len > 0 && sim_heap[0].fn == NULL) {
+    sim_heap_pop();
+  }
+  return sim_heap_len > 0 ? sim_heap[0].at : UINT64_MAX;
+}
+
+static bool sim_masked(int line)
+{
+  return line >= 0 && (sim_irq_depth > 0 || (sim_irq_lines & (1u << line)) != 0);
+}
+
+static void sim_dispatch(const struct sim_event *ev)
+{
+  uint64_t start = sim_host_ns();
+  sim_in_event = true;
+  ev->fn(ev->arg);
+  sim_in_event = false;
+  sim_event_ns += sim_host_ns() - start;
+}
+
+/**
+ * @brief Runs the pending interrupts whose line is no longer masked.
+ */
+static void sim_deliver(void)
+{
+  if (sim_in_event) {
+    return;
+  }
+  size_t i = 0;
+  while (i < sim_pending_len) {
+    struct sim_event ev = sim_pending[i];
+    if (ev.fn != NULL && sim_masked(ev.line)) {
+      i++;
+      continue;
+    }
+    memmove(&sim_pending[i], &sim_pending[i + 1], (sim_pending_len - i - 1) * sizeof(sim_pending[0]));
+    sim_pending_len--;
+    if (ev.fn != NULL) {
+      sim_dispatch(&ev);
+      i = 0;
+    }
+  }
+}
+
+void sim_run_until(uint64_t t_ns)
+{
+  if (sim_in_event) {
+    fprintf(stderr, "sim: time advanced from an event handler\n");
+    abort();
+  }
+  sim_deliver();
+  while (sim_next_event() <= t_ns) {
+    struct sim_event ev = sim_heap[0];
+    sim_heap_pop();
+    if (ev.at > sim_ns) {
+      sim_ns = ev.at;
+    }
+    if (sim_masked(ev.line)) {
+      if (sim_pending_len == SIM_PENDING_MAX) {
+        fprintf(stderr, "sim: too many pending interrupts\n");
+        abort();
+      }
+      sim_pending[sim_pending_len++] = ev;
+      continue;
+    }
+    sim_dispatch(&ev);
+  }
+  if (t_ns > sim_ns) {
+    sim_ns = t_ns;
+  }
+}
+
+void sim_advance(uint64_t ns)
+{
+  sim_run_until(sim_ns + ns);
+}
+
+void sim_cpu_bytes(uint32_t bytes, uint32_t ps_per_byte)
+{
+  sim_advance((uint64_t)bytes * ps_per_byte / 1000u);
+}
+
+uint64_t sim_host_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t sim_host_event_ns(void)
+{
+  return sim_event_ns;
+}
+
+uint64_t sim_irq_off_max_ns(void)
+{
+  return sim_irq_max;
+}
+
+void sim_irq_mask(uint32_t lines)
+{
+  sim_irq_lines |= lines;
+}
+
+void sim_irq_unmask(uint32_t lines)
+{
+  sim_irq_lines &= ~lines;
+  sim_deliver();
+}
+
+void sim_set_verbose(bool on)
+{
+  sim_verbose_flag = on;
+}
+
+bool sim_verbose(void)
+{
+  if (sim_verbose_flag < 0) {
+    sim_verbose_flag = getenv("HOST_VERBOSE") != NULL;
+  }
+  return sim_verbose_flag != 0;
+}
+
+/* sys_arch */
+
+u32_t sys_now(void)
+{
+  return (u32_t)(sim_ns / 1000000u);
+}
+
+u32_t sys_cycles(void)
+{
+  return (u32_t)(sim_ns * (SIM_CPU_HZ / 1000000u) / 1000u);
+}
+
+u32_t sys_cycles_hz(void)
+{
+  return SIM_CPU_HZ;
+}
+
+sys_prot_t sys_arch_protect(void)
+{
+  if (sim_irq_depth++ == 0) {
+    sim_irq_start = sim_ns;
+  }
+  return (sys_prot_t)(uintptr_t)(sim_irq_depth - 1);
+}
+
+void sys_arch_unprotect(sys_prot_t pval)
+{
+  sim_irq_depth = (int)(uintptr_t)pval;
+  if (sim_irq_depth == 0) {
+    if (sim_ns - sim_irq_start > sim_irq_max) {
+      sim_irq_max = sim_ns - sim_irq_start;
+    }
+    sim_deliver();
+  }
+}
+
+u32_t sys_arch_irq_off_max(void)
+{
+  return (u32_t)(sim_irq_max * (SIM_CPU_HZ / 1000000u) / 1000u);
+}
+
+void sys_arch_irq_off_reset(void)
+{
+  sim_irq_max = 0;
+}
+
+/**
+ * @brief Sleeps until the next event or millisecond tick, like WFI.
+ *
+ * Called with interrupts disabled; the sleep does not count as masked. A
+ * pending interrupt on an unmasked line ends it at once.
+ */
+void sys_arch_idle(void)
+{
+  for (size_t i = 0; i < sim_pending_len; i++) {
+    if (sim_pending[i].fn != NULL && (sim_irq_lines & (1u << sim_pending[i].line)) == 0) {
+      return;
+    }
+  }
+  uint64_t tick = (sim_ns / 1000000u + 1) * 1000000u;
+  uint64_t next = sim_next_event();
+  sim_run_until(next < tick ? next : tick);
+  sim_irq_start = sim_ns;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file
+ * @brief Simulated time and events for the host suite.
+ *
+ * Host port of sys_arch.cpp: sys_now(), sys_cycles() and the interrupt
+ * masking run on a simulated nanosecond clock instead of the MCU. Board code
+ * advances the clock by the time its work takes on the target (SPI clocking
+ * in the W5500 model, SIM_CPU_* estimates in the stand-in stack); the
+ * network side (switch, peers, chip receive path) runs as events at
+ * simulated times. sys_arch_idle() jumps to the next event or tick.
+ *
+ * Host CPU time of the board code is measured separately with
+ * sim_host_ns(), excluding the time spent in event handlers.
+ */
+
+#ifndef __SIM_H__
+#define __SIM_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Simulated MCU clock, as sys_cycles_hz() on the SAMD21.
+ */
+#define SIM_CPU_HZ 48000000u
+
+/**
+ * @brief Estimated target CPU costs charged by the stand-in stack.
+ *
+ * Rough SAMD21 (Cortex-M0+, 48 MHz, -Os) figures for lwIP's own processing,
+ * which the host build does not run. They only shift absolute latencies;
+ * comparisons between driver or server variants do not depend on them.
+ */
+#define SIM_CPU_FRAME_IN_NS     20000u  /**< ethernet_input() to protocol input, per frame */
+#define SIM_CPU_FRAME_OUT_NS    15000u  /**< Protocol output to linkoutput, per frame */
+#define SIM_CPU_CHKSUM_PS       62500u  /**< Internet checksum, per byte (3 cycles) */
+#define SIM_CPU_COPY_PS         41667u  /**< memcpy, per byte (2 cycles) */
+#define SIM_CPU_TIMER_NS        5000u   /**< One lwIP timer handler */
+#define SIM_CPU_CALLBACK_NS     2000u   /**< Dispatch of one application callback */
+#define SIM_CPU_LOOP_NS         3000u   /**< One pass of the main loop besides the calls above */
+
+/**
+ * @brief Event handler.
+ */
+typedef void (*sim_event_fn)(void *arg);
+
+/**
+ * @brief Clears the clock, the event queue and the interrupt timing.
+ */
+void sim_reset(void);
+
+/**
+ * @brief Current simulated time in nanoseconds.
+ */
+uint64_t sim_now_ns(void);
+
+/**
+ * @brief Schedules @p fn at absolute simulated time @p at_ns.
+ *
+ * Events due at the same time run in the order they were scheduled. Times
+ * in the past run at the next advance.
+ */
+void sim_at(uint64_t at_ns, sim_event_fn fn, void *arg);
+
+/**
+ * @brief Schedules @p fn @p delay_ns from now.
+ */
+void sim_after(uint64_t delay_ns, sim_event_fn fn, void *arg);
+
+/**
+ * @brief Schedules interrupt handler @p fn on interrupt line @p line (0..31)
+ *        @p delay_ns from now.
+ *
+ * It runs when due unless interrupts are disabled (sys_arch_protect()) or
+ * the line is masked (sim_irq_mask()); then it stays pending and runs as
+ * soon as both are lifted, as with the NVIC.
+ */
+void sim_irq_after(uint64_t delay_ns, unsigned line, sim_event_fn fn, void *arg);
+
+/**
+ * @brief Masks the interrupt lines set in @p lines, e.g. for SPI.beginTransaction().
+ */
+void sim_irq_mask(uint32_t lines);
+
+/**
+ * @brief Unmasks the interrupt lines set in @p lines and runs what became deliverable.
+ */
+void sim_irq_unmask(uint32_t lines);
+
+/**
+ * @brief Cancels every pending event or interrupt with this handler and argument.
+ */
+void sim_cancel(sim_event_fn fn, void *arg);
+
+/**
+ * @brief Time of the next event, UINT64_MAX if none.
+ */
+uint64_t sim_next_event(void);
+
+/**
+ * @brief Board code took @p ns: runs the events falling due meanwhile.
+ *
+ * Must not be called from an event handler.
+ */
+void sim_advance(uint64_t ns);
+
+/**
+ * @brief Advances to absolute time @p t_ns, running the events due until then.
+ */
+void sim_run_until(uint64_t t_ns);
+
+/**
+ * @brief Charges @p bytes at @p ps_per_byte picoseconds to the board CPU.
+ */
+void sim_cpu_bytes(uint32_t bytes, uint32_t ps_per_byte);
+
+/**
+ * @brief Host monotonic clock in nanoseconds.
+ */
+uint64_t sim_host_ns(void);
+
+/**
+ * @brief Host nanoseconds spent in event handlers since sim_reset().
+ *
+ * Subtract from a host interval around board code to get the board share.
+ */
+uint64_t sim_host_event_ns(void);
+
+/**
+ * @brief Longest interrupts-off interval of sys_arch_protect(), in nanoseconds.
+ */
+uint64_t sim_irq_off_max_ns(void);
+
+/**
+ * @brief Enables debug output of the stand-in stack and the port on stderr.
+ *
+ * Also enabled by the HOST_VERBOSE environment variable.
+ */
+void sim_set_verbose(bool on);
+
+/**
+ * @brief True if debug output is enabled.
+ */
+bool sim_verbose(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SIM_H__
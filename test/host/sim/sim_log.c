@@ -0,0 +1,64 @@
+/**
+ * @file
+ * @brief Debug output hooks of arch/cc.h for the host suite.
+ *
+ * Printed at once on stderr in verbose mode, instead of being queued as by
+ * sys_log.cpp on the target. A test that links sys_log.cpp itself gets its
+ * ring instead, as this file is then not pulled from the library.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lwip/opt.h"
+#include "lwip/arch.h"
+
+#include "sim.h"
+
+void lwip_debug_printf(const char *fmt, ...)
+{
+  if (!sim_verbose()) {
+    return;
+  }
+  va_list ap;
+  va_start(ap, fmt);
+  fprintf(stderr, "[%10.3f] ", (double)sim_now_ns() / 1e6);
+  vfprintf(stderr, fmt, ap);
+  va_end(ap);
+}
+
+void lwip_debug_print(const char *msg)
+{
+  lwip_debug_printf("%s", msg);
+}
+
+u32_t lwip_debug_flush(u32_t max_records)
+{
+  (void)max_records;
+  return 0;
+}
+
+u32_t lwip_debug_dropped(void)
+{
+  return 0;
+}
+
+void lwip_assert(const char *msg, const char *file, int line)
+{
+  fprintf(stderr, "Assertion \"%s\" failed at %s:%d\n", msg, file, line);
+  abort();
+}
+
+void hex_dump_lwip(const char *label, const void *data, size_t len)
+{
+  if (!sim_verbose()) {
+    return;
+  }
+  const uint8_t *p = (const uint8_t *)data;
+  fprintf(stderr, "%s:", label);
+  for (size_t i = 0; i < len; i++) {
+    fprintf(stderr, "%s%02x", (i % 16) ? " " : "\n  ", p[i]);
+  }
+  fprintf(stderr, "\n");
+}
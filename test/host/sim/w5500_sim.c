@@ -0,0 +1,371 @@
+/**
+ * @file
+ * @brief Simulated W5500 behind a fake SPI transport.
+ */
+
+#include <string.h>
+
+#include "sim.h"
+#include "w5500_sim.h"
+
+/* Register addresses and values, as in the W5500 datasheet */
+#define REG_MR          0x00
+#define REG_SHAR        0x09
+#define REG_PHYCFGR     0x2E
+#define REG_VERSIONR    0x39
+#define SN_MR           0x00
+#define SN_CR           0x01
+#define SN_IR           0x02
+#define SN_SR           0x03
+#define SN_RXBUF_SIZE   0x1E
+#define SN_TXBUF_SIZE   0x1F
+#define SN_TX_FSR       0x20
+#define SN_TX_RD        0x22
+#define SN_TX_WR        0x24
+#define SN_RX_RSR       0x26
+#define SN_RX_RD        0x28
+#define SN_RX_WR        0x2A
+
+#define MR_RST          0x80
+#define PHYCFGR_RST     0x80
+#define PHYCFGR_STATUS  0x07    /* LNK, SPD and DPX: 100 Mbit full duplex when up */
+#define SN_MR_MACRAW    0x04
+#define SN_MR_MFEN      0x80
+#define SN_IR_RECV      0x04
+#define SN_IR_SENDOK    0x10
+#define SOCK_CLOSED     0x00
+#define SOCK_INIT       0x13
+#define SOCK_MACRAW     0x42
+
+#define CR_OPEN         0x01
+#define CR_CLOSE        0x10
+#define CR_SEND         0x20
+#define CR_RECV         0x40
+
+static uint16_t rd16(const uint8_t *r, int a)
+{
+  return (uint16_t)((r[a] << 8) | r[a + 1]);
+}
+
+static void wr16(uint8_t *r, int a, uint16_t v)
+{
+  r[a] = (uint8_t)(v >> 8);
+  r[a + 1] = (uint8_t)v;
+}
+
+/**
+ * @brief Buffer size from Sn_RXBUF_SIZE/Sn_TXBUF_SIZE (in KB), capped to the model.
+ */
+static uint32_t buf_size(uint8_t kb)
+{
+  uint32_t size = (uint32_t)kb * 1024u;
+  return size > W5500_SIM_BUF_SIZE ? W5500_SIM_BUF_SIZE : size;
+}
+
+static uint16_t buf_mask(uint8_t kb)
+{
+  uint32_t size = buf_size(kb);
+  return size ? (uint16_t)(size - 1) : 0;
+}
+
+/**
+ * @brief Refreshes the pointer and size registers from the buffer state.
+ */
+static void update_regs(struct w5500_sim *chip)
+{
+  wr16(chip->sock, SN_RX_RSR, (uint16_t)(chip->rx_wr - chip->rx_rd));
+  wr16(chip->sock, SN_RX_WR, chip->rx_wr);
+  wr16(chip->sock, SN_TX_RD, chip->tx_rd);
+  uint16_t queued = (uint16_t)(rd16(chip->sock, SN_TX_WR) - chip->tx_rd);
+  uint32_t size = buf_size(chip->sock[SN_TXBUF_SIZE]);
+  wr16(chip->sock, SN_TX_FSR, (uint16_t)(queued < size ? size - queued : 0));
+}
+
+/**
+ * @brief PHY reset: the link drops and renegotiates once the reset ends.
+ */
+static void phy_restart(struct w5500_sim *chip)
+{
+  chip->link_at_ns = sim_now_ns() + (uint64_t)chip->autoneg_ms * 1000000u;
+}
+
+/**
+ * @brief Software reset: every register back to its default.
+ */
+static void chip_reset(struct w5500_sim *chip)
+{
+  memset(chip->common, 0, sizeof(chip->common));
+  memset(chip->sock, 0, sizeof(chip->sock));
+  wr16(chip->common, 0x19, 0x07D0);       /* RTR */
+  chip->common[0x1B] = 0x08;              /* RCR */
+  chip->common[REG_PHYCFGR] = 0xB8;       /* RST released, OPMD from pins, all capable */
+  chip->common[REG_VERSIONR] = 0x04;
+  chip->sock[0x16] = 0x80;                /* Sn_TTL */
+  chip->sock[SN_RXBUF_SIZE] = 2;
+  chip->sock[SN_TXBUF_SIZE] = 2;
+  chip->sock[0x2C] = 0xFF;                /* Sn_IMR */
+  chip->rx_rd = chip->rx_wr = chip->tx_rd = 0;
+  chip->send_done_ns = 0;
+  update_regs(chip);
+  phy_restart(chip);
+}
+
+void w5500_sim_init(struct w5500_sim *chip)
+{
+  memset(chip, 0, sizeof(*chip));
+  chip->spi_hz = 8000000;
+  chip->max_hz = 16000000;
+  chip->byte_overhead_ns = 800;
+  chip->begin_ns = 3000;
+  chip->end_ns = 1500;
+  chip->autoneg_ms = 2000;
+  chip->wire_bps = 100000000;
+  chip->noise = 0x12345678;
+  chip_reset(chip);
+}
+
+bool w5500_sim_link(const struct w5500_sim *chip)
+{
+  return chip->cable && (chip->common[REG_PHYCFGR] & PHYCFGR_RST) && sim_now_ns() >= chip->link_at_ns;
+}
+
+void w5500_sim_set_cable(struct w5500_sim *chip, bool plugged)
+{
+  if (plugged && !chip->cable) {
+    phy_restart(chip);
+  }
+  chip->cable = plugged;
+}
+
+uint16_t w5500_sim_rx_pending(const struct w5500_sim *chip)
+{
+  return (uint16_t)(chip->rx_wr - chip->rx_rd);
+}
+
+bool w5500_sim_receive(struct w5500_sim *chip, const void *frame, size_t len)
+{
+  const uint8_t *f = (const uint8_t *)frame;
+
+  if (!w5500_sim_link(chip) || chip->sock[SN_SR] != SOCK_MACRAW) {
+    chip->st.rx_no_link++;
+    return false;
+  }
+  if ((chip->sock[SN_MR] & SN_MR_MFEN) && !(f[0] & 0x01) && memcmp(f, &chip->common[REG_SHAR], 6) != 0) {
+    chip->st.rx_filtered++;
+    return false;
+  }
+
+  uint32_t size = buf_size(chip->sock[SN_RXBUF_SIZE]);
+  uint16_t mask = buf_mask(chip->sock[SN_RXBUF_SIZE]);
+  uint32_t used = (uint16_t)(chip->rx_wr - chip->rx_rd);
+  if (used + len + 2 > size) {
+    chip->st.rx_overflows++;
+    return false;
+  }
+
+  uint16_t ptr = chip->rx_wr;
+  chip->rx[ptr & mask] = (uint8_t)((len + 2) >> 8);
+  chip->rx[(uint16_t)(ptr + 1) & mask] = (uint8_t)(len + 2);
+  for (size_t i = 0; i < len; i++) {
+    chip->rx[(uint16_t)(ptr + 2 + i) & mask] = f[i];
+  }
+  chip->rx_wr = (uint16_t)(ptr + len + 2);
+  chip->sock[SN_IR] |= SN_IR_RECV;
+  chip->st.rx_frames++;
+  update_regs(chip);
+  return true;
+}
+
+/**
+ * @brief Executes a socket command written to Sn_CR.
+ */
+static void sock_command(struct w5500_sim *chip, uint8_t cmd)
+{
+  if (chip->sock_stuck) {
+    chip->sock[SN_CR] = cmd;
+    return;
+  }
+  switch (cmd) {
+    case CR_OPEN:
+      chip->st.sock_opens++;
+      chip->sock[SN_SR] = (chip->sock[SN_MR] & 0x0F) == SN_MR_MACRAW ? SOCK_MACRAW : SOCK_INIT;
+      chip->rx_rd = chip->rx_wr = chip->tx_rd = 0;
+      wr16(chip->sock, SN_RX_RD, 0);
+      wr16(chip->sock, SN_TX_WR, 0);
+      break;
+    case CR_CLOSE:
+      chip->sock[SN_SR] = SOCK_CLOSED;
+      break;
+    case CR_SEND: {
+      if (chip->sock[SN_SR] != SOCK_MACRAW) {
+        break;
+      }
+      uint16_t mask = buf_mask(chip->sock[SN_TXBUF_SIZE]);
+      uint16_t wr = rd16(chip->sock, SN_TX_WR);
+      uint16_t len = (uint16_t)(wr - chip->tx_rd);
+      uint8_t frame[W5500_SIM_BUF_SIZE];
+      for (uint16_t i = 0; i < len; i++) {
+        frame[i] = chip->tx[(uint16_t)(chip->tx_rd + i) & mask];
+      }
+      chip->tx_rd = wr;
+
+      /* Preamble, minimum frame, FCS and inter-frame gap on the wire */
+      uint32_t wire = (len < 60 ? 60 : len) + 4 + 8 + 12;
+      uint64_t start = chip->send_done_ns > sim_now_ns() ? chip->send_done_ns : sim_now_ns();
+      chip->send_done_ns = start + (uint64_t)wire * 8u * 1000000000u / chip->wire_bps;
+      chip->st.tx_frames++;
+      if (w5500_sim_link(chip) && chip->tx_hook) {
+        chip->tx_hook(chip, frame, len, chip->tx_arg);
+      }
+      break;
+    }
+    case CR_RECV:
+      chip->rx_rd = rd16(chip->sock, SN_RX_RD);
+      break;
+    default:
+      break;
+  }
+  update_regs(chip);
+}
+
+/**
+ * @brief Reads one register or buffer byte.
+ */
+static uint8_t chip_read(struct w5500_sim *chip, uint8_t block, uint16_t addr)
+{
+  switch (block) {
+    case 0:
+      if (addr == REG_PHYCFGR) {
+        return (uint8_t)((chip->common[addr] & ~PHYCFGR_STATUS) | (w5500_sim_link(chip) ? PHYCFGR_STATUS : 0));
+      }
+      return addr < sizeof(chip->common) ? chip->common[addr] : 0;
+    case 1:
+      if (addr == SN_IR && chip->send_done_ns != 0 && sim_now_ns() >= chip->send_done_ns) {
+        chip->sock[SN_IR] |= SN_IR_SENDOK;
+        chip->send_done_ns = 0;
+      }
+      return addr < sizeof(chip->sock) ? chip->sock[addr] : 0;
+    case 2:
+      return chip->tx[addr & buf_mask(chip->sock[SN_TXBUF_SIZE])];
+    case 3:
+      return chip->rx[addr & buf_mask(chip->sock[SN_RXBUF_SIZE])];
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief Writes one register or buffer byte.
+ */
+static void chip_write(struct w5500_sim *chip, uint8_t block, uint16_t addr, uint8_t val)
+{
+  switch (block) {
+    case 0:
+      if (addr == REG_MR && (val & MR_RST)) {
+        chip->st.resets++;
+        chip->sock_stuck = false;
+        chip_reset(chip);
+      } else if (addr == REG_PHYCFGR) {
+        bool was_reset = !(chip->common[REG_PHYCFGR] & PHYCFGR_RST);
+        chip->common[REG_PHYCFGR] = (uint8_t)(val & ~PHYCFGR_STATUS);
+        if (was_reset && (val & PHYCFGR_RST)) {
+          phy_restart(chip);
+        }
+      } else if (addr < sizeof(chip->common) && addr != REG_VERSIONR) {
+        chip->common[addr] = val;
+      }
+      break;
+    case 1:
+      if (addr == SN_CR) {
+        sock_command(chip, val);
+      } else if (addr == SN_IR) {
+        chip->sock[SN_IR] &= (uint8_t)~val;
+      } else if (addr == SN_SR || addr == SN_TX_FSR || addr == SN_TX_FSR + 1 ||
+                 addr == SN_TX_RD || addr == SN_TX_RD + 1 || addr == SN_RX_RSR ||
+                 addr == SN_RX_RSR + 1 || addr == SN_RX_WR || addr == SN_RX_WR + 1) {
+        /* Read-only */
+      } else if (addr < sizeof(chip->sock)) {
+        chip->sock[addr] = val;
+        if (addr == SN_TX_WR + 1) {
+          update_regs(chip);
+        }
+      }
+      break;
+    case 2:
+      chip->tx[addr & buf_mask(chip->sock[SN_TXBUF_SIZE])] = val;
+      break;
+    default:
+      break;
+  }
+}
+
+void w5500_sim_begin(void *ctx)
+{
+  struct w5500_sim *chip = (struct w5500_sim *)ctx;
+  sim_irq_mask(chip->irq_mask);
+  chip->cs_start_ns = sim_now_ns();
+  chip->st.calls++;
+  chip->st.cs_cycles++;
+  sim_advance(chip->begin_ns);
+  chip->selected = true;
+  chip->phase = 0;
+}
+
+void w5500_sim_end(void *ctx)
+{
+  struct w5500_sim *chip = (struct w5500_sim *)ctx;
+  chip->st.calls++;
+  if (!chip->selected) {
+    /* The driver deselects defensively before a reset */
+    sim_irq_unmask(chip->irq_mask);
+    return;
+  }
+  chip->selected = false;
+  sim_advance(chip->end_ns);
+  uint64_t held = sim_now_ns() - chip->cs_start_ns;
+  chip->st.bus_ns += held;
+  if (held > chip->st.hold_max_ns) {
+    chip->st.hold_max_ns = held;
+  }
+  sim_irq_unmask(chip->irq_mask);
+}
+
+uint8_t w5500_sim_txn(void *ctx, uint8_t mosi)
+{
+  struct w5500_sim *chip = (struct w5500_sim *)ctx;
+  uint8_t miso = 0;
+
+  chip->st.calls++;
+  chip->st.bytes++;
+  if (chip->selected) {
+    switch (chip->phase) {
+      case 0: chip->addr = (uint16_t)(mosi << 8); chip->phase++; break;
+      case 1: chip->addr |= mosi; chip->phase++; break;
+      case 2: chip->ctl = mosi; chip->phase++; break;
+      default:
+        if (chip->ctl & 0x04) {
+          chip_write(chip, chip->ctl >> 3, chip->addr, mosi);
+        } else {
+          miso = chip_read(chip, chip->ctl >> 3, chip->addr);
+          if (chip->max_hz && chip->spi_hz > chip->max_hz) {
+            chip->noise = chip->noise * 1103515245u + 12345u;
+            if (((chip->noise >> 16) & 0x3F) == 0) {
+              miso ^= 0x10;
+              chip->st.corrupted++;
+            }
+          }
+        }
+        chip->addr++;
+        break;
+    }
+  }
+  sim_advance(8000000000ull / chip->spi_hz + chip->byte_overhead_ns);
+  return miso;
+}
+
+void w5500_sim_set_clock(void *ctx, uint32_t hz)
+{
+  struct w5500_sim *chip = (struct w5500_sim *)ctx;
+  chip->st.calls++;
+  chip->spi_hz = hz;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file
+ * @brief Simulated W5500 behind a fake SPI transport.
+ *
+ * Models the parts of the chip w5500.c uses: the SPI frame format, the
+ * common registers, socket 0 in MACRAW mode with its 16-bit buffer pointers,
+ * the PHY link with auto-negotiation delay, MAC filtering and RX buffer
+ * overflow. Every transport call advances the simulated clock by the time
+ * it takes at the current SPI clock, and is counted.
+ *
+ * Plug into a struct ethif with spi set to the chip, begin, end, txn and
+ * set_clock to the w5500_sim_* callbacks and driver to &ethif_driver_w5500,
+ * as board_if_power() does.
+ */
+
+#ifndef __W5500_SIM_H__
+#define __W5500_SIM_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Size of each socket buffer of the model (the driver uses 16 KB).
+ */
+#define W5500_SIM_BUF_SIZE 16384
+
+/**
+ * @brief Transport counters of one chip.
+ */
+struct w5500_sim_stats {
+  uint64_t cs_cycles;           /**< begin()/end() pairs */
+  uint64_t bytes;               /**< Bytes clocked, headers included */
+  uint64_t calls;               /**< Transport calls: begin, end, txn and set_clock */
+  uint64_t bus_ns;              /**< Time the chip was selected */
+  uint64_t hold_max_ns;         /**< Longest chip-select cycle */
+  uint64_t rx_frames;           /**< Frames stored in the RX buffer */
+  uint64_t rx_filtered;         /**< Frames rejected by the MAC filter */
+  uint64_t rx_overflows;        /**< Frames lost to a full RX buffer */
+  uint64_t rx_no_link;          /**< Frames lost while the link or socket was down */
+  uint64_t tx_frames;           /**< Frames sent with SEND */
+  uint64_t corrupted;           /**< Bytes corrupted by clocking faster than max_hz */
+  uint64_t resets;              /**< Software resets (MR_RST) */
+  uint64_t sock_opens;          /**< Socket 0 OPEN commands executed */
+};
+
+/**
+ * @brief Simulated chip.
+ */
+struct w5500_sim {
+  /* Configuration, set after w5500_sim_init() */
+  uint32_t spi_hz;              /**< SPI clock, changed by w5500_sim_set_clock() */
+  uint32_t max_hz;              /**< Fastest clock read back reliably, 0 for no limit */
+  uint32_t byte_overhead_ns;    /**< MCU time per transferred byte besides clocking */
+  uint32_t begin_ns;            /**< MCU time of begin(): bus claim and CS assert */
+  uint32_t end_ns;              /**< MCU time of end(): CS deassert and bus release */
+  uint32_t irq_mask;            /**< Interrupt lines masked from begin() to end(), as by
+                                     SPI.beginTransaction() after SPI.usingInterrupt() */
+  uint32_t autoneg_ms;          /**< PHY auto-negotiation time after a reset or cable plug */
+  uint32_t wire_bps;            /**< Line rate, for SENDOK timing */
+  bool sock_stuck;              /**< Socket commands never complete (Sn_CR stays set) until a reset */
+  /** Called with every frame the chip puts on the wire */
+  void (*tx_hook)(struct w5500_sim *chip, const uint8_t *frame, size_t len, void *arg);
+  void *tx_arg;                 /**< Argument of tx_hook */
+
+  /* State */
+  uint8_t common[0x40];         /**< Common registers */
+  uint8_t sock[0x30];           /**< Socket 0 registers */
+  uint8_t tx[W5500_SIM_BUF_SIZE]; /**< Socket 0 TX buffer */
+  uint8_t rx[W5500_SIM_BUF_SIZE]; /**< Socket 0 RX buffer */
+  uint16_t rx_rd;               /**< Sn_RX_RD as of the last RECV */
+  uint16_t rx_wr;               /**< Sn_RX_WR */
+  uint16_t tx_rd;               /**< Sn_TX_RD */
+  bool cable;                   /**< Link partner connected */
+  uint64_t link_at_ns;          /**< Time the PHY link comes up, UINT64_MAX while it cannot */
+  uint64_t send_done_ns;        /**< End of the frame on the wire after SEND */
+  bool selected;                /**< Chip select asserted */
+  uint8_t phase;                /**< Bytes of the current SPI frame so far, up to 3 */
+  uint16_t addr;                /**< Current address of the SPI frame */
+  uint8_t ctl;                  /**< Control byte of the SPI frame */
+  uint64_t cs_start_ns;         /**< Time of the last begin() */
+  uint32_t noise;               /**< Corruption generator state */
+  struct w5500_sim_stats st;    /**< Counters */
+};
+
+/**
+ * @brief Powers the chip on with default settings: 8 MHz SPI, no cable.
+ */
+void w5500_sim_init(struct w5500_sim *chip);
+
+/**
+ * @brief Plugs or unplugs the cable; the link comes up autoneg_ms after plugging.
+ */
+void w5500_sim_set_cable(struct w5500_sim *chip, bool plugged);
+
+/**
+ * @brief True if the PHY reports a link now.
+ */
+bool w5500_sim_link(const struct w5500_sim *chip);
+
+/**
+ * @brief A frame arrives from the wire.
+ *
+ * @return true if it was stored in the RX buffer.
+ */
+bool w5500_sim_receive(struct w5500_sim *chip, const void *frame, size_t len);
+
+/**
+ * @brief Bytes waiting in the RX buffer (Sn_RX_RSR).
+ */
+uint16_t w5500_sim_rx_pending(const struct w5500_sim *chip);
+
+/* Transport callbacks for struct ethif, ctx is the struct w5500_sim */
+void w5500_sim_begin(void *ctx);
+void w5500_sim_end(void *ctx);
+uint8_t w5500_sim_txn(void *ctx, uint8_t mosi);
+void w5500_sim_set_clock(void *ctx, uint32_t hz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __W5500_SIM_H__
@@ -0,0 +1,269 @@
+/**
+ * @file
+ * @brief Active/backup bond (ethif_bond) failover under traffic.
+ *
+ * Two modules are bonded behind one netif with a DHCP address. The router
+ * probes the echo server every 5 ms and broadcasts a numbered UDP datagram
+ * every 10 ms, which both modules receive, while the cable of the active
+ * module is pulled. Prints one row per scenario:
+ *
+ *     scenario,failovers,failover_ms,garp_ms,outage_ms,probe_p99_us,probe_max_us,broadcasts_lost,broadcasts_dup
+ *
+ * failover_ms is the bond's own bound on the outage, garp_ms the time from
+ * the cable pull to the first gratuitous ARP at the router, outage_ms the
+ * longest gap between two echoes: the probe segment lost with the cable is
+ * only resent after the router's RTO. A failover must keep the netif link,
+ * the address, the DHCP lease and the TCP connection, stay within
+ * ETHIF_BOND_MONITOR_MS plus a poll, and never pass a broadcast to lwIP
+ * twice: the copies the backup received while standing by are flushed.
+ * Plugging the primary back does not move the traffic; losing the backup
+ * link then fails back.
+ *
+ * In the last scenario the backup's MISO floats while the bond comes up,
+ * so its driver init fails; it is reconnected before the primary cable is
+ * pulled. The bond must not move the traffic to the unconfigured chip, even
+ * though its PHY reports a link, and fails over only after the retried init
+ * (ETHIF_RESET_MIN_INTERVAL_MS) and the renegotiation that follows it.
+ */
+
+#include <string.h>
+
+#include "lwip/dhcp.h"
+#include "lwip/timeouts.h"
+#include "netif/ethernet.h"
+
+#include "board.h"
+#include "ethif_bond.h"
+
+#define BF_PROBE_MS 5
+#define BF_BCAST_MS 10
+#define BF_BCAST_PORT 9999
+
+enum bf_scenario { BF_PRIMARY_PULLED, BF_NO_FAILBACK, BF_FAILBACK, BF_BACKUP_UNREADY };
+static const char *const bf_names[] = {"primary pulled", "primary replugged", "backup pulled", "backup not ready"};
+
+static struct board_if bf_mod[2];
+static struct ethif_bond bf_bond;
+static struct netif bf_netif;
+static struct peer bf_router;
+static struct board_probe bf_probe;
+
+static uint32_t bf_bcast_seq;
+static uint8_t bf_bcast_seen[4096];
+static uint32_t bf_bcast_dup;
+static uint64_t bf_pulled_ns;
+static uint64_t bf_garp_ns;
+static uint32_t bf_link_changes;
+
+static void bf_poll(void)
+{
+  ethif_poll_all();
+  sys_check_timeouts();
+  sim_advance(SIM_CPU_LOOP_NS);
+}
+
+static bool bf_run(bool (*done)(void *arg), void *arg, uint32_t timeout_ms)
+{
+  uint64_t end = sim_now_ns() + (uint64_t)timeout_ms * 1000000u;
+  while (done == NULL || !done(arg)) {
+    if (sim_now_ns() >= end) {
+      return false;
+    }
+    bf_poll();
+  }
+  return true;
+}
+
+static bool bf_bound(void *arg)
+{
+  (void)arg;
+  return netif_is_link_up(&bf_netif) && dhcp_supplied_address(&bf_netif);
+}
+
+static void bf_link_callback(struct netif *netif)
+{
+  (void)netif;
+  bf_link_changes++;
+}
+
+/**
+ * @brief netif input: counts the numbered broadcasts the bond passes to lwIP.
+ */
+static err_t bf_input(struct pbuf *p, struct netif *netif)
+{
+  uint8_t hdr[14 + 20 + 8 + 4];
+  if (pbuf_copy_partial(p, hdr, sizeof(hdr), 0) == sizeof(hdr) && hdr[12] == 0x08 && hdr[13] == 0x00 &&
+      hdr[14 + 9] == 17 && (hdr[14 + 22] << 8 | hdr[14 + 23]) == BF_BCAST_PORT) {
+    uint32_t seq;
+    memcpy(&seq, hdr + 14 + 28, sizeof(seq));
+    if (seq < sizeof(bf_bcast_seen) && bf_bcast_seen[seq]++) {
+      bf_bcast_dup++;
+    }
+  }
+  return ethernet_input(p, netif);
+}
+
+static void bf_bcast(void *arg)
+{
+  (void)arg;
+  uint32_t seq = bf_bcast_seq++;
+  peer_send_udp(&bf_router, BOARD_NET | 0xff, BF_BCAST_PORT, BF_BCAST_PORT, &seq, sizeof(seq));
+  sim_after(BF_BCAST_MS * 1000000ull, bf_bcast, NULL);
+}
+
+static void bf_router_frame(struct peer *peer, const uint8_t *frame, size_t len, void *arg)
+{
+  (void)peer;
+  (void)arg;
+  /* Gratuitous ARP: sender and target address equal */
+  if (bf_pulled_ns && !bf_garp_ns && len >= 42 && frame[12] == 0x08 && frame[13] == 0x06 &&
+      memcmp(frame + 28, frame + 38, 4) == 0) {
+    bf_garp_ns = sim_now_ns();
+  }
+}
+
+/**
+ * @brief SPI transfer with nothing driving MISO.
+ */
+static uint8_t bf_miso_float(void *ctx, uint8_t mosi)
+{
+  (void)ctx;
+  (void)mosi;
+  return 0xff;
+}
+
+static void bf_pull(struct board_if *mod)
+{
+  net_set_cable(&mod->port, false);
+  bf_pulled_ns = sim_now_ns();
+  bf_garp_ns = 0;
+}
+
+static int bf_scenario(void *arg)
+{
+  enum bf_scenario sc = (enum bf_scenario)(uintptr_t)arg;
+
+  board_init();
+  board_router(&bf_router);
+  bf_router.on_frame = bf_router_frame;
+  board_if_power(&bf_mod[0], 1);
+  board_if_power(&bf_mod[1], 2);
+  ethif_bond_setup(&bf_bond, &bf_mod[0].ethif, &bf_mod[1].ethif);
+  if (sc == BF_BACKUP_UNREADY) {
+    bf_mod[1].ethif.txn = bf_miso_float;
+  }
+  board_mac(1, bf_netif.hwaddr);
+  BOARD_CHECK(netif_add(&bf_netif, IP4_ADDR_ANY4, IP4_ADDR_ANY4, IP4_ADDR_ANY4, &bf_bond.ethif,
+                        ethif_init, bf_input) != NULL);
+  netif_set_default(&bf_netif);
+  netif_set_link_callback(&bf_netif, bf_link_callback);
+  netif_set_up(&bf_netif);
+  BOARD_CHECK(dhcp_start(&bf_netif) == ERR_OK);
+  BOARD_CHECK(bf_run(bf_bound, NULL, 10000));
+  BOARD_CHECK(ethif_bond_active(&bf_bond) == &bf_mod[0].ethif);
+  BOARD_CHECK(bf_bond.ready[0] && bf_bond.ready[1] == (sc != BF_BACKUP_UNREADY));
+  bf_mod[1].ethif.txn = w5500_sim_txn;
+  uint32_t ip = lwip_ntohl(ip4_addr_get_u32(netif_ip4_addr(&bf_netif)));
+  uint32_t dhcp_acks = bf_router.dhcp.acks;
+
+  BOARD_CHECK(board_echo_start(7));
+  board_probe_start(&bf_probe, &bf_router, ip, 7, 64, BF_PROBE_MS);
+  sim_after(BF_BCAST_MS * 1000000ull, bf_bcast, NULL);
+  bf_run(NULL, NULL, 1000);
+  uint32_t links = bf_link_changes;
+
+  bf_probe.count = bf_probe.skipped = 0;
+  struct board_if *pulled = &bf_mod[0];
+  uint32_t want_failovers = 1;
+  uint64_t window_ns = 2000000000ull;
+  if (sc == BF_PRIMARY_PULLED) {
+    bf_pull(pulled);
+  } else if (sc == BF_BACKUP_UNREADY) {
+    /* The unconfigured backup has a link, but must not take the traffic */
+    BOARD_CHECK(w5500_sim_link(&bf_mod[1].chip));
+    bf_pull(pulled);
+    bf_run(NULL, NULL, 10 * ETHIF_BOND_MONITOR_MS);
+    BOARD_CHECK(bf_bond.failovers == 0 && !bf_bond.ready[1]);
+    window_ns = (ETHIF_RESET_MIN_INTERVAL_MS + 5000) * 1000000ull;
+  } else {
+    bf_pull(&bf_mod[0]);
+    bf_run(NULL, NULL, 1000);
+    net_set_cable(&bf_mod[0].port, true);
+    bf_run(NULL, NULL, 3000);
+    BOARD_CHECK(ethif_bond_active(&bf_bond) == &bf_mod[1].ethif && bf_bond.failovers == 1);
+    bf_probe.count = bf_probe.skipped = 0;
+    if (sc == BF_FAILBACK) {
+      pulled = &bf_mod[1];
+      bf_pull(pulled);
+      want_failovers = 2;
+    }
+  }
+  uint32_t first_seq = bf_bcast_seq;
+  uint64_t t0 = sim_now_ns();
+  uint32_t last_count = 0;
+  uint64_t last_echo = t0, outage = 0;
+  while (sim_now_ns() - t0 < window_ns) {
+    bf_poll();
+    if (bf_probe.count != last_count) {
+      last_count = bf_probe.count;
+      outage = sim_now_ns() - last_echo > outage ? sim_now_ns() - last_echo : outage;
+      last_echo = sim_now_ns();
+    }
+  }
+  board_probe_stop(&bf_probe);
+  sim_cancel(bf_bcast, NULL);
+  bf_run(NULL, NULL, 100);
+
+  uint32_t lost = 0;
+  for (uint32_t i = first_seq; i < bf_bcast_seq && i < sizeof(bf_bcast_seen); i++) {
+    lost += bf_bcast_seen[i] == 0;
+  }
+  uint32_t p99 = board_probe_pct(&bf_probe, 99);
+  uint32_t max = board_probe_pct(&bf_probe, 100);
+  bool pulled_now = sc != BF_NO_FAILBACK;
+  printf("%s,%lu,%lu,%.1f,%.1f,%lu,%lu,%lu,%lu\n", bf_names[sc], (unsigned long)bf_bond.failovers,
+         (unsigned long)bf_bond.failover_ms, pulled_now && bf_garp_ns ? (double)(bf_garp_ns - bf_pulled_ns) / 1e6 : 0.0,
+         (double)outage / 1e6, (unsigned long)p99, (unsigned long)max, (unsigned long)lost,
+         (unsigned long)bf_bcast_dup);
+
+  BOARD_CHECK(bf_bond.failovers == want_failovers);
+  BOARD_CHECK(ethif_bond_active(&bf_bond) == (want_failovers == 1 ? &bf_mod[1].ethif : &bf_mod[0].ethif));
+  if (sc == BF_BACKUP_UNREADY) {
+    /* The netif link went down with the primary and came back with the
+       backup; the probe connection gave up during the outage, but every
+       broadcast of the last second arrived through the backup */
+    uint32_t tail_lost = 0;
+    for (uint32_t i = bf_bcast_seq - 1000 / BF_BCAST_MS; i < bf_bcast_seq; i++) {
+      tail_lost += bf_bcast_seen[i] == 0;
+    }
+    BOARD_CHECK(bf_bond.ready[1] && bf_mod[1].chip.st.tx_frames > 0);
+    BOARD_CHECK(bf_link_changes == links + 2 && netif_is_link_up(&bf_netif));
+    BOARD_CHECK(bf_garp_ns != 0 && tail_lost == 0 && bf_bcast_dup == 0);
+    BOARD_CHECK(bf_bond.failover_ms <= ETHIF_RESET_MIN_INTERVAL_MS + 5000);
+    return 0;
+  }
+  BOARD_CHECK(bf_link_changes == links && netif_is_link_up(&bf_netif));
+  BOARD_CHECK(lwip_ntohl(ip4_addr_get_u32(netif_ip4_addr(&bf_netif))) == ip && dhcp_supplied_address(&bf_netif));
+  BOARD_CHECK(bf_router.dhcp.acks == dhcp_acks);
+  BOARD_CHECK(bf_probe.conn.state == PEER_TCP_ESTABLISHED && bf_probe.count > 0);
+  BOARD_CHECK(bf_bcast_dup == 0);
+  if (pulled_now) {
+    BOARD_CHECK(bf_bond.failover_ms <= ETHIF_BOND_MONITOR_MS + 1);
+    BOARD_CHECK(bf_garp_ns != 0 && bf_garp_ns - bf_pulled_ns <= (ETHIF_BOND_MONITOR_MS + 5) * 1000000ull);
+    BOARD_CHECK(outage < (ETHIF_BOND_MONITOR_MS + PEER_TCP_RTO_MS + 2 * BF_PROBE_MS) * 1000000ull);
+    BOARD_CHECK(lost <= ETHIF_BOND_MONITOR_MS / BF_BCAST_MS + 1);
+  } else {
+    BOARD_CHECK(lost == 0 && bf_probe.skipped == 0);
+  }
+  return 0;
+}
+
+int main(void)
+{
+  int failed = 0;
+  printf("scenario,failovers,failover_ms,garp_ms,outage_ms,probe_p99_us,probe_max_us,broadcasts_lost,broadcasts_dup\n");
+  for (int sc = BF_PRIMARY_PULLED; sc <= BF_BACKUP_UNREADY; sc++) {
+    failed |= board_scenario(bf_names[sc], bf_scenario, (void *)(uintptr_t)sc);
+  }
+  return failed;
+}
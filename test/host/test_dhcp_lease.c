@@ -0,0 +1,166 @@
+/**
+ * @file
+ * @brief Time from link up to the first served request, with and without a
+ *        cached DHCP lease (dhcp_lease.h).
+ *
+ * Runs the sketch with DHCP. A poller on the router requests / every 50 ms
+ * (a new connection each time, dropped if unanswered after 50 ms), like a
+ * SCADA master waiting for the board. Scenarios:
+ *
+ * - cold boot: empty lease cache, full DISCOVER/OFFER/REQUEST/ACK exchange;
+ *   the retained RAM holding the cache is saved for the next scenario
+ * - reset: the saved retained RAM is restored before setup(), as after an
+ *   MCU reset, so the client rebinds with a single REQUEST (INIT-REBOOT)
+ * - replug: after the cold boot, the cable is out for 3 s
+ * - reset, NAK: as reset, but the router has given the address to another
+ *   client, so the REQUEST is NAKed and the client falls back to DISCOVER
+ *
+ *     scenario,link_to_ack_ms,link_to_served_ms,discovers,requests,naks
+ *
+ * link_to_ack_ms is when the router sent its last DHCPACK. After a
+ * DISCOVER exchange lwIP probes the address with ARP before using it, so
+ * the first request is served about a second later.
+ *
+ * The retained RAM is the DHCP_LEASE_SECTION section, named host_noinit
+ * in this build so its bounds can be found through the linker.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "board_sketch.h"
+#include "http_client.h"
+
+#define LEASE_FILE "dhcp_lease.noinit"
+#define LEASE_POLL_MS 20
+
+extern uint8_t __start_host_noinit[];
+extern uint8_t __stop_host_noinit[];
+
+enum lease_scenario { LEASE_COLD, LEASE_RESET, LEASE_REPLUG, LEASE_RESET_NAK };
+static const char *const lease_names[] = {"cold boot", "reset", "replug", "reset, NAK"};
+
+static struct w5500_sim lease_chip;
+static struct net_port lease_port;
+static struct peer lease_router;
+static struct http_client lease_client;
+static uint64_t lease_try_ns;
+static uint32_t lease_addr;       /**< Address the router hands the board */
+
+/**
+ * @brief Requests / until the first response, retrying every LEASE_POLL_MS.
+ */
+static void lease_poll(void *arg)
+{
+  (void)arg;
+  struct http_client *h = &lease_client;
+  if (h->responses > 0) {
+    return;
+  }
+  if (lease_try_ns != 0) {
+    peer_drop(&h->conn);
+    http_client_free(h);
+  }
+  memset(h, 0, sizeof(*h));
+  lease_try_ns = sim_now_ns();
+  http_client_connect(h, &lease_router, lease_addr, 80);
+  http_client_get(h, "/", false);
+  sim_after((uint64_t)LEASE_POLL_MS * 1000000u, lease_poll, NULL);
+}
+
+static bool lease_served(void *arg)
+{
+  (void)arg;
+  return lease_client.responses > 0;
+}
+
+static void lease_poll_start(void)
+{
+  lease_try_ns = 0;
+  memset(&lease_client, 0, sizeof(lease_client));
+  lease_poll(NULL);
+}
+
+static int lease_run(void *arg)
+{
+  enum lease_scenario sc = *(const enum lease_scenario *)arg;
+  size_t noinit_len = (size_t)(__stop_host_noinit - __start_host_noinit);
+
+  if (sc == LEASE_RESET || sc == LEASE_RESET_NAK) {
+    FILE *f = fopen(LEASE_FILE, "rb");
+    BOARD_CHECK(f != NULL);
+    BOARD_CHECK(fread(__start_host_noinit, 1, noinit_len, f) == noinit_len);
+    fclose(f);
+  }
+
+  board_sketch_init(&lease_chip, &lease_port, 1);
+  board_router(&lease_router);
+  lease_addr = BOARD_POOL;
+  if (sc == LEASE_RESET_NAK) {
+    lease_addr = BOARD_POOL + 1;
+    static const uint8_t other[6] = {0x02, 0x00, 0x00, 0x00, 0x09, 0x09};
+    memcpy(lease_router.dhcp_bindings[0].mac, other, 6);
+    lease_router.dhcp_bindings[0].ip = BOARD_POOL;
+    lease_router.dhcp_binding_count = 1;
+  }
+  board_sketch_setup();
+  lease_poll_start();
+  BOARD_CHECK(board_sketch_run(lease_served, NULL, 20000));
+
+  if (sc == LEASE_COLD) {
+    FILE *f = fopen(LEASE_FILE, "wb");
+    BOARD_CHECK(f != NULL);
+    BOARD_CHECK(fwrite(__start_host_noinit, 1, noinit_len, f) == noinit_len);
+    fclose(f);
+  }
+
+  struct peer_dhcp_stats before = lease_router.dhcp;
+  if (sc == LEASE_REPLUG) {
+    board_sketch_run_for(1000);
+    before = lease_router.dhcp;
+    net_set_cable(&lease_port, false);
+    board_sketch_run_for(3000);
+    net_set_cable(&lease_port, true);
+    lease_poll_start();
+    BOARD_CHECK(board_sketch_run(lease_served, NULL, 20000));
+  }
+  if (sc == LEASE_RESET || sc == LEASE_RESET_NAK || sc == LEASE_COLD) {
+    memset(&before, 0, sizeof(before));
+  }
+
+  uint64_t link_ns = 0;
+  BOARD_CHECK(board_sketch_line("Interface #0 link is UP", &link_ns) != NULL);
+  BOARD_CHECK(board_sketch_line("First request served", NULL) != NULL);
+  const struct peer_dhcp_stats *d = &lease_router.dhcp;
+  uint32_t discovers = d->discovers - before.discovers;
+  uint32_t requests = d->requests - before.requests;
+  uint32_t naks = d->naks - before.naks;
+  printf("%s,%.1f,%.1f,%lu,%lu,%lu\n", lease_names[sc], (double)(d->last_ack_ns - link_ns) / 1e6,
+         (double)(lease_client.done_ns - link_ns) / 1e6, (unsigned long)discovers,
+         (unsigned long)requests, (unsigned long)naks);
+
+  switch (sc) {
+    case LEASE_COLD:
+      BOARD_CHECK(discovers >= 1 && naks == 0);
+      break;
+    case LEASE_RESET:
+    case LEASE_REPLUG:
+      BOARD_CHECK(discovers == 0 && requests == 1 && naks == 0);
+      break;
+    case LEASE_RESET_NAK:
+      BOARD_CHECK(naks == 1 && discovers >= 1);
+      break;
+  }
+  return 0;
+}
+
+int main(void)
+{
+  static const enum lease_scenario order[] = {LEASE_COLD, LEASE_RESET, LEASE_REPLUG, LEASE_RESET_NAK};
+  int failed = 0;
+  printf("scenario,link_to_ack_ms,link_to_served_ms,discovers,requests,naks\n");
+  for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+    failed |= board_scenario(lease_names[order[i]], lease_run, (void *)&order[i]);
+  }
+  return failed;
+}
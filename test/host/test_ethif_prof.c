@@ -0,0 +1,144 @@
+/**
+ * @file
+ * @brief Per-phase timing of the driver (ethif_prof_reset(),
+ *        ethif_prof_dump()).
+ *
+ * Built with ETHIF_PROF. Once the module is up and quiet, the statistics
+ * are cleared, frames are received one at a time and sent through
+ * netif->linkoutput. Each receive phase, from the header read to lwIP
+ * input, must count one sample per received frame, each transmit phase
+ * and the whole ethif_output() one per sent frame, and ethif_poll() and
+ * its link check one per pass of the loop. The samples of every phase must
+ * add up in the histogram and lie between min and max. Prints the
+ * ethif_prof_dump() lines:
+ *
+ *     phase,count,min,mean,max,hz,h0,...,hN
+ *
+ * The host profiling clock is CLOCK_MONOTONIC, so the times are those of
+ * the host, not of the simulated MCU.
+ */
+
+#include <string.h>
+
+#include "lwip/pbuf.h"
+
+#include "board.h"
+
+#define PF_FRAME_SIZE 200
+#define PF_RX 12
+#define PF_TX 7
+
+static struct board_if pf_if;
+static unsigned pf_lines;
+static char pf_rx_header[64];   /**< Dumped line of the rx_header phase */
+
+static void pf_out(const char *line, void *arg)
+{
+  (void)arg;
+  printf("%s\n", line);
+  if (strncmp(line, "rx_header,", 10) == 0) {
+    snprintf(pf_rx_header, sizeof(pf_rx_header), "%s", line);
+  }
+  pf_lines++;
+}
+
+static void pf_frame(uint8_t *f, const uint8_t *dst, const uint8_t *src)
+{
+  memset(f, 0x5a, PF_FRAME_SIZE);
+  memcpy(f, dst, 6);
+  memcpy(f + 6, src, 6);
+  f[12] = 0x88;
+  f[13] = 0xB5;
+}
+
+/**
+ * @brief Checks that the samples of one phase are consistent.
+ */
+static int pf_consistent(const struct ethif_prof_stat *st)
+{
+  uint64_t binned = 0;
+  for (int b = 0; b < ETHIF_PROF_HIST_BINS; b++) {
+    binned += st->hist[b];
+  }
+  BOARD_CHECK(binned == st->count);
+  if (st->count != 0) {
+    BOARD_CHECK(st->min <= st->max);
+    BOARD_CHECK(st->sum >= (uint64_t)st->min * st->count && st->sum <= (uint64_t)st->max * st->count);
+  } else {
+    BOARD_CHECK(st->min == 0 && st->max == 0 && st->sum == 0);
+  }
+  return 0;
+}
+
+static int pf_run(void *arg)
+{
+  (void)arg;
+  static const uint8_t peer[6] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x01};
+  uint8_t f[PF_FRAME_SIZE];
+
+  board_init();
+  board_if_power(&pf_if, 1);
+  BOARD_CHECK(board_if_up(&pf_if, BOARD_STATIC, NULL));
+  BOARD_CHECK(board_wait_addr(5000));
+  /* Past the link-up announcements */
+  board_run_for(5000);
+
+  ethif_prof_reset(&pf_if.netif);
+  const struct ethif_prof *prof = &pf_if.ethif.prof;
+  for (int i = 0; i < ETHIF_PROF_PHASE_COUNT; i++) {
+    BOARD_CHECK(prof->phase[i].count == 0);
+  }
+  uint64_t chip_tx = pf_if.chip.st.tx_frames;
+
+  for (int i = 0; i < PF_RX; i++) {
+    pf_frame(f, pf_if.netif.hwaddr, peer);
+    BOARD_CHECK(w5500_sim_receive(&pf_if.chip, f, sizeof(f)));
+    board_run_for(2);
+  }
+  BOARD_CHECK(w5500_sim_rx_pending(&pf_if.chip) == 0);
+  for (int i = 0; i < PF_TX; i++) {
+    struct pbuf *p = pbuf_alloc(PBUF_RAW, PF_FRAME_SIZE, PBUF_RAM);
+    BOARD_CHECK(p != NULL);
+    pf_frame((uint8_t *)p->payload, peer, pf_if.netif.hwaddr);
+    BOARD_CHECK(pf_if.netif.linkoutput(&pf_if.netif, p) == ERR_OK);
+    pbuf_free(p);
+  }
+  /* Nothing else was sent meanwhile */
+  BOARD_CHECK(pf_if.chip.st.tx_frames - chip_tx == PF_TX);
+
+  ethif_prof_dump(&pf_if.netif, pf_out, NULL);
+  BOARD_CHECK(pf_lines == 1 + ETHIF_PROF_PHASE_COUNT);
+
+  /* One sample per frame received, per frame sent, per ethif_poll() */
+  const struct ethif_prof_stat *ph = prof->phase;
+  BOARD_CHECK(ph[ETHIF_PROF_RX_HEADER].count == PF_RX && ph[ETHIF_PROF_RX_PAYLOAD].count == PF_RX);
+  BOARD_CHECK(ph[ETHIF_PROF_RX_RECV].count == PF_RX && ph[ETHIF_PROF_POLL_INPUT].count == PF_RX);
+  BOARD_CHECK(ph[ETHIF_PROF_RX_RSR].count >= PF_RX);
+  BOARD_CHECK(ph[ETHIF_PROF_TX_FSR].count == PF_TX && ph[ETHIF_PROF_TX_PAYLOAD].count == PF_TX);
+  BOARD_CHECK(ph[ETHIF_PROF_TX_SEND].count == PF_TX && ph[ETHIF_PROF_TX_SENDOK].count == PF_TX);
+  BOARD_CHECK(ph[ETHIF_PROF_OUTPUT].count == PF_TX);
+  BOARD_CHECK(ph[ETHIF_PROF_POLL].count >= PF_RX && ph[ETHIF_PROF_POLL].count == ph[ETHIF_PROF_POLL_LINK].count);
+  for (int i = 0; i < ETHIF_PROF_PHASE_COUNT; i++) {
+    BOARD_CHECK(pf_consistent(&ph[i]) == 0);
+  }
+  /* Time passes in the whole calls, which contain the phases */
+  BOARD_CHECK(ph[ETHIF_PROF_POLL].sum > 0 && ph[ETHIF_PROF_OUTPUT].sum > 0);
+  BOARD_CHECK(ph[ETHIF_PROF_OUTPUT].sum >= ph[ETHIF_PROF_TX_PAYLOAD].sum);
+  BOARD_CHECK(ph[ETHIF_PROF_POLL].max >= ph[ETHIF_PROF_POLL_INPUT].max);
+
+  char want[32];
+  snprintf(want, sizeof(want), "rx_header,%u,", PF_RX);
+  BOARD_CHECK(strncmp(pf_rx_header, want, strlen(want)) == 0);
+
+  /* Cleared again */
+  ethif_prof_reset(&pf_if.netif);
+  for (int i = 0; i < ETHIF_PROF_PHASE_COUNT; i++) {
+    BOARD_CHECK(ph[i].count == 0 && ph[i].sum == 0);
+  }
+  return 0;
+}
+
+int main(void)
+{
+  return board_scenario("per-phase timing", pf_run, NULL);
+}
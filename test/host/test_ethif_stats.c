@@ -0,0 +1,188 @@
+/**
+ * @file
+ * @brief Driver counters (ethif_get_stats(), ethif_reset_stats()) and the
+ *        lwIP LINK_STATS and MIB2 counters fed by the driver.
+ *
+ * Built with MIB2_STATS. Once the module is up and quiet, the counters are
+ * cleared and a known mix of traffic goes through:
+ *
+ * - received: unicast and broadcast frames accepted by netif->input, and
+ *   unicast frames it rejects, one at a time; then a burst, part of which
+ *   the receive classifier drops;
+ * - sent: unicast and broadcast frames through netif->linkoutput;
+ * - failed: frames sent while socket 0 is wedged (SEND never completes).
+ *
+ * Every counter must match the mix, then read zero after
+ * ethif_reset_stats(). Prints the counters as one row:
+ *
+ *     rx_frames,rx_bytes,rx_input_err,rx_class_drops,tx_frames,tx_bytes,tx_err,link_recv,link_xmit,link_drop,link_err,if_in_octets,if_in_ucast,if_in_nucast,if_in_discards,if_out_octets,if_out_ucast,if_out_nucast,if_out_errors
+ */
+
+#include <string.h>
+
+#include "lwip/pbuf.h"
+#include "lwip/stats.h"
+#include "netif/ethernet.h"
+
+#include "board.h"
+
+#define ST_FRAME_SIZE 100
+#define ST_ACCEPT 0x88B5    /**< Ethertype taken by st_input */
+#define ST_REJECT 0x88B6    /**< Ethertype st_input refuses */
+
+#define ST_RX_UCAST 10
+#define ST_RX_BCAST 3
+#define ST_RX_REJECT 2
+#define ST_RX_BURST 20
+#define ST_TX_UCAST 4
+#define ST_TX_BCAST 2
+#define ST_TX_FAIL 2
+
+static struct board_if st_if;
+
+static void st_frame(uint8_t *f, const uint8_t *dst, uint16_t type)
+{
+  static const uint8_t src[6] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x01};
+  memset(f, 0x5a, ST_FRAME_SIZE);
+  memcpy(f, dst, 6);
+  memcpy(f + 6, src, 6);
+  f[12] = (uint8_t)(type >> 8);
+  f[13] = (uint8_t)type;
+}
+
+/**
+ * @brief netif input: takes ST_ACCEPT frames, refuses ST_REJECT ones.
+ */
+static err_t st_input(struct pbuf *p, struct netif *netif)
+{
+  uint8_t h[14];
+  if (pbuf_copy_partial(p, h, sizeof(h), 0) == sizeof(h)) {
+    uint16_t type = (uint16_t)(h[12] << 8 | h[13]);
+    if (type == ST_REJECT) {
+      return ERR_VAL;
+    }
+    if (type == ST_ACCEPT) {
+      pbuf_free(p);
+      return ERR_OK;
+    }
+  }
+  return ethernet_input(p, netif);
+}
+
+/**
+ * @brief A frame arrives, then the main loop runs until it has been read.
+ */
+static int st_receive(const uint8_t *dst, uint16_t type)
+{
+  uint8_t f[ST_FRAME_SIZE];
+  st_frame(f, dst, type);
+  BOARD_CHECK(w5500_sim_receive(&st_if.chip, f, sizeof(f)));
+  board_run_for(2);
+  return 0;
+}
+
+static void st_send(const uint8_t *dst, unsigned count)
+{
+  for (unsigned i = 0; i < count; i++) {
+    struct pbuf *p = pbuf_alloc(PBUF_RAW, ST_FRAME_SIZE, PBUF_RAM);
+    st_frame((uint8_t *)p->payload, dst, ST_ACCEPT);
+    st_if.netif.linkoutput(&st_if.netif, p);
+    pbuf_free(p);
+  }
+}
+
+static int st_run(void *arg)
+{
+  (void)arg;
+  static const uint8_t bcast[6] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+  static const uint8_t peer[6] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x01};
+  uint8_t f[ST_FRAME_SIZE];
+
+  board_init();
+  board_if_power(&st_if, 1);
+  BOARD_CHECK(board_if_up(&st_if, BOARD_STATIC, st_input));
+  BOARD_CHECK(board_wait_addr(5000));
+  /* Past the link-up announcements */
+  board_run_for(5000);
+
+  struct ethif_stats st;
+  struct ethif_stats zero;
+  memset(&zero, 0, sizeof(zero));
+  ethif_reset_stats(&st_if.netif);
+  ethif_get_stats(&st_if.netif, &st);
+  BOARD_CHECK(memcmp(&st, &zero, sizeof(st)) == 0);
+  memset(&lwip_stats.link, 0, sizeof(lwip_stats.link));
+  memset(&st_if.netif.mib2_counters, 0, sizeof(st_if.netif.mib2_counters));
+  uint64_t chip_tx = st_if.chip.st.tx_frames;
+
+  for (int i = 0; i < ST_RX_UCAST; i++) {
+    BOARD_CHECK(st_receive(st_if.netif.hwaddr, ST_ACCEPT) == 0);
+  }
+  for (int i = 0; i < ST_RX_BCAST; i++) {
+    BOARD_CHECK(st_receive(bcast, ST_ACCEPT) == 0);
+  }
+  for (int i = 0; i < ST_RX_REJECT; i++) {
+    BOARD_CHECK(st_receive(st_if.netif.hwaddr, ST_REJECT) == 0);
+  }
+  ethif_get_stats(&st_if.netif, &st);
+  BOARD_CHECK(st.rx_class_drops == 0);
+  for (int i = 0; i < ST_RX_BURST; i++) {
+    st_frame(f, st_if.netif.hwaddr, ST_ACCEPT);
+    BOARD_CHECK(w5500_sim_receive(&st_if.chip, f, sizeof(f)));
+  }
+  board_run_for(50);
+  BOARD_CHECK(w5500_sim_rx_pending(&st_if.chip) == 0);
+  st_send(peer, ST_TX_UCAST);
+  st_send(bcast, ST_TX_BCAST);
+  /* Nothing else was sent meanwhile */
+  BOARD_CHECK(st_if.chip.st.tx_frames - chip_tx == ST_TX_UCAST + ST_TX_BCAST);
+
+  st_if.chip.sock_stuck = true;
+  st_send(peer, ST_TX_FAIL);
+
+  ethif_get_stats(&st_if.netif, &st);
+  const struct stats_proto *link = &lwip_stats.link;
+  const struct stats_mib2_netif_ctrs *mib = &st_if.netif.mib2_counters;
+  printf("rx_frames,rx_bytes,rx_input_err,rx_class_drops,tx_frames,tx_bytes,tx_err,link_recv,link_xmit,link_drop,link_err,"
+         "if_in_octets,if_in_ucast,if_in_nucast,if_in_discards,if_out_octets,if_out_ucast,if_out_nucast,if_out_errors\n");
+  printf("%lu,%lu,%lu,%lu,%lu,%lu,%lu,%u,%u,%u,%u,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n", (unsigned long)st.rx_frames,
+         (unsigned long)st.rx_bytes, (unsigned long)st.rx_input_err, (unsigned long)st.rx_class_drops,
+         (unsigned long)st.tx_frames, (unsigned long)st.tx_bytes, (unsigned long)st.tx_err, link->recv, link->xmit,
+         link->drop, link->err,
+         (unsigned long)mib->ifinoctets, (unsigned long)mib->ifinucastpkts, (unsigned long)mib->ifinnucastpkts,
+         (unsigned long)mib->ifindiscards, (unsigned long)mib->ifoutoctets, (unsigned long)mib->ifoutucastpkts,
+         (unsigned long)mib->ifoutnucastpkts, (unsigned long)mib->ifouterrors);
+
+  /* Received: every frame passed up counts, refused ones also as drops;
+     frames the classifier dropped only as drops */
+  const unsigned drops = st.rx_class_drops;
+  const unsigned rx = ST_RX_UCAST + ST_RX_BCAST + ST_RX_REJECT + ST_RX_BURST - drops;
+  BOARD_CHECK(drops > 0 && drops < ST_RX_BURST);
+  BOARD_CHECK(st.rx_frames == rx && st.rx_bytes == rx * ST_FRAME_SIZE);
+  BOARD_CHECK(st.rx_input_err == ST_RX_REJECT);
+  BOARD_CHECK(link->recv == rx && link->drop == ST_RX_REJECT + drops);
+  BOARD_CHECK(mib->ifinoctets == rx * ST_FRAME_SIZE);
+  BOARD_CHECK(mib->ifinucastpkts == rx - ST_RX_BCAST && mib->ifinnucastpkts == ST_RX_BCAST);
+  BOARD_CHECK(mib->ifindiscards == ST_RX_REJECT + drops);
+
+  /* Sent: attempts count in LINK/MIB2, only completed ones in the driver */
+  const unsigned tx = ST_TX_UCAST + ST_TX_BCAST;
+  BOARD_CHECK(st.tx_frames == tx && st.tx_bytes == tx * ST_FRAME_SIZE);
+  BOARD_CHECK(st.tx_err == ST_TX_FAIL && st.timeouts[ETHIF_WAIT_TX_SEND] == ST_TX_FAIL);
+  BOARD_CHECK(link->xmit == tx + ST_TX_FAIL && link->err == ST_TX_FAIL);
+  BOARD_CHECK(mib->ifoutoctets == (tx + ST_TX_FAIL) * ST_FRAME_SIZE);
+  BOARD_CHECK(mib->ifoutucastpkts == ST_TX_UCAST + ST_TX_FAIL && mib->ifoutnucastpkts == ST_TX_BCAST);
+  BOARD_CHECK(mib->ifouterrors == ST_TX_FAIL);
+
+  /* The live counters are the snapshot, until cleared */
+  BOARD_CHECK(memcmp(&st, &st_if.ethif.stats, sizeof(st)) == 0);
+  ethif_reset_stats(&st_if.netif);
+  ethif_get_stats(&st_if.netif, &st);
+  BOARD_CHECK(memcmp(&st, &zero, sizeof(st)) == 0);
+  return 0;
+}
+
+int main(void)
+{
+  return board_scenario("driver, LINK and MIB2 counters", st_run, NULL);
+}
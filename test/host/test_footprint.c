@@ -0,0 +1,124 @@
+/**
+ * @file
+ * @brief Static RAM of the lwIP pools and heap (footprint_static_bytes(),
+ *        footprint_dump()).
+ *
+ * The stand-in stack takes its memory from the host heap, so the arrays
+ * lwIP would reserve are declared here the way memp.c and mem.c declare
+ * them: one memp_memory_<pool>_base per entry of the pool list and
+ * ram_heap for MEM_SIZE and its two block headers. footprint_static_bytes()
+ * must equal the sum of their sizes, footprint_dump() must list every pool
+ * with the size and count of its descriptor, and its HEAP and TOTAL lines
+ * must match the arrays. Built for each LWIP_PROFILE whose pool counts and
+ * heap differ. Prints one row per array and the totals:
+ *
+ *     array,bytes
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lwip/mem.h"
+#include "lwip/memp.h"
+#include "lwip/pbuf.h"
+#include "lwip/priv/memp_priv.h"
+#include "lwip/priv/tcp_priv.h"
+#include "lwip/tcp.h"
+#include "lwip/timeouts.h"
+#include "footprint.h"
+
+#include "board.h"
+
+/* As lwIP's arch.h */
+#ifndef LWIP_DECLARE_MEMORY_ALIGNED
+#define LWIP_DECLARE_MEMORY_ALIGNED(variable_name, size) u8_t variable_name[LWIP_MEM_ALIGN_BUFFER(size)]
+#endif
+
+/* As memp.h: LWIP_MEMPOOL_DECLARE() */
+#define LWIP_MEMPOOL(name, num, size, desc) \
+  static LWIP_DECLARE_MEMORY_ALIGNED(memp_memory_##name##_base, (num) * (MEMP_SIZE + MEMP_ALIGN_SIZE(size)));
+#include "lwip/priv/memp_std.h"
+
+/* As mem.c */
+struct mem {
+  mem_size_t next;
+  mem_size_t prev;
+  u8_t used;
+};
+#define SIZEOF_STRUCT_MEM LWIP_MEM_ALIGN_SIZE(sizeof(struct mem))
+#define MEM_SIZE_ALIGNED LWIP_MEM_ALIGN_SIZE(MEM_SIZE)
+static LWIP_DECLARE_MEMORY_ALIGNED(ram_heap, MEM_SIZE_ALIGNED + (2U * SIZEOF_STRUCT_MEM));
+
+static const struct {
+  const char *name;
+  size_t bytes;
+} fp_arrays[] = {
+#define LWIP_MEMPOOL(name, num, size, desc) {"memp_memory_" #name "_base", sizeof(memp_memory_##name##_base)},
+#include "lwip/priv/memp_std.h"
+  {"ram_heap", sizeof(ram_heap)},
+};
+
+#define FP_LINES_MAX 16
+
+static char fp_lines[FP_LINES_MAX][80];
+static size_t fp_count;
+
+static void fp_out(const char *line, void *arg)
+{
+  (void)arg;
+  if (fp_count < FP_LINES_MAX) {
+    snprintf(fp_lines[fp_count], sizeof(fp_lines[0]), "%s", line);
+  }
+  fp_count++;
+}
+
+/**
+ * @brief Returns field @p index of a CSV line, as a number.
+ */
+static unsigned long fp_field(const char *line, int index)
+{
+  for (int i = 0; i < index && line != NULL; i++) {
+    line = strchr(line, ',');
+    line = line != NULL ? line + 1 : NULL;
+  }
+  return line != NULL ? strtoul(line, NULL, 10) : 0;
+}
+
+static int fp_run(void *arg)
+{
+  (void)arg;
+  board_init();
+
+  size_t total = 0;
+  for (size_t i = 0; i < sizeof(fp_arrays) / sizeof(fp_arrays[0]); i++) {
+    printf("%s,%lu\n", fp_arrays[i].name, (unsigned long)fp_arrays[i].bytes);
+    total += fp_arrays[i].bytes;
+  }
+  printf("total,%lu\n", (unsigned long)total);
+  printf("footprint_static_bytes,%lu\n", (unsigned long)footprint_static_bytes());
+  BOARD_CHECK(footprint_static_bytes() == total);
+
+  /* Header, one line per pool, HEAP, TOTAL and BUDGET if set */
+  footprint_dump(fp_out, NULL);
+  BOARD_CHECK(fp_count == 1 + MEMP_MAX + 2 + (LWIP_RAM_BUDGET ? 1 : 0));
+  BOARD_CHECK(strcmp(fp_lines[0], "pool,size,num,bytes,used,max,err") == 0);
+  for (int i = 0; i < MEMP_MAX; i++) {
+    const char *line = fp_lines[1 + i];
+    const struct memp_desc *pool = memp_pools[i];
+    BOARD_CHECK(fp_field(line, 1) == pool->size && fp_field(line, 2) == pool->num);
+    /* The array adds only the alignment slack */
+    BOARD_CHECK(fp_field(line, 3) <= fp_arrays[i].bytes && fp_arrays[i].bytes - fp_field(line, 3) < MEM_ALIGNMENT);
+  }
+  const char *heap = fp_lines[1 + MEMP_MAX];
+  BOARD_CHECK(strncmp(heap, "HEAP,", 5) == 0);
+  BOARD_CHECK(fp_field(heap, 1) == MEM_SIZE && fp_field(heap, 3) == sizeof(ram_heap));
+  const char *sum = fp_lines[2 + MEMP_MAX];
+  BOARD_CHECK(strncmp(sum, "TOTAL,", 6) == 0 && fp_field(sum, 3) == total);
+  return 0;
+}
+
+int main(void)
+{
+  printf("array,bytes\n");
+  return board_scenario("pool and heap arrays", fp_run, NULL);
+}
@@ -0,0 +1,211 @@
+/**
+ * @file
+ * @brief Static files of the example server: content, ETags, 304 and load.
+ *
+ * Every entry of the generated file table is fetched and compared with its
+ * source file under data/, so a stale src/http_files.cpp fails too; the
+ * ETag must be the CRC-32 of the content. A request with the ETag gets
+ * 304 Not Modified without content, a POST 405, and `Connection: close`
+ * gets the close head and a closed connection. The load scenario fetches
+ * each file 200 times over one keep-alive connection, with and without
+ * `If-None-Match`, and prints:
+ *
+ *     path,revalidate,bytes,requests,req_per_s,ms_per_req,spi_bytes
+ *
+ * bytes is the response size (head and content), spi_bytes the SPI bytes
+ * per request.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "http_client.h"
+#include "http_files.h"
+#include "http_server.h"
+
+#define HF_REQUESTS 200
+
+static struct board_if hf_if;
+static struct peer hf_router;
+
+static int hf_board(void)
+{
+  board_init();
+  board_router(&hf_router);
+  board_if_power(&hf_if, 1);
+  BOARD_CHECK(board_if_up(&hf_if, BOARD_STATIC, NULL));
+  BOARD_CHECK(board_wait_addr(5000));
+  BOARD_CHECK(http_server_start(80));
+  return 0;
+}
+
+static uint32_t hf_crc32(const uint8_t *data, size_t len)
+{
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+/**
+ * @brief Reads the source of a table entry from data/, index.html for a directory.
+ */
+static uint8_t *hf_source(const char *path, size_t *len)
+{
+  char name[256];
+  size_t n = strlen(path);
+  snprintf(name, sizeof(name), "%s%s%s", HOST_DATA_DIR, path, path[n - 1] == '/' ? "index.html" : "");
+  FILE *f = fopen(name, "rb");
+  if (f == NULL) {
+    return NULL;
+  }
+  static uint8_t buf[65536];
+  *len = fread(buf, 1, sizeof(buf), f);
+  fclose(f);
+  return buf;
+}
+
+static bool hf_closed(void *arg)
+{
+  return ((struct http_client *)arg)->closed;
+}
+
+/**
+ * @brief Sends @p request and waits for the next complete response.
+ */
+static int hf_exchange(struct http_client *h, const char *request)
+{
+  uint32_t before = h->responses;
+  http_client_send(h, request, strlen(request));
+  uint64_t end = sim_now_ns() + 5000000000ull;
+  while (h->responses == before) {
+    BOARD_CHECK(!h->reset && !h->closed && sim_now_ns() < end);
+    board_poll();
+  }
+  BOARD_CHECK(h->bad == 0);
+  return 0;
+}
+
+static int hf_content(void *arg)
+{
+  (void)arg;
+  static struct http_client h;
+  BOARD_CHECK(hf_board() == 0);
+  memset(&h, 0, sizeof(h));
+  http_client_connect(&h, &hf_router, BOARD_STATIC, 80);
+
+  BOARD_CHECK(http_files_count > 0);
+  for (size_t i = 0; i < http_files_count; i++) {
+    const struct http_file *file = &http_files[i];
+    char request[256], etag[32], value[64];
+
+    size_t len = 0;
+    const uint8_t *source = hf_source(file->path, &len);
+    BOARD_CHECK(source != NULL);
+    BOARD_CHECK(!file->gzip && len == file->len && memcmp(source, file->data, len) == 0);
+    snprintf(etag, sizeof(etag), "\"%08lx\"", (unsigned long)hf_crc32(file->data, file->len));
+    BOARD_CHECK(strcmp(etag, file->etag) == 0);
+    BOARD_CHECK(file->head_len < HTTP_FILE_HEAD_MAX && file->head_close_len < HTTP_FILE_HEAD_MAX);
+
+    snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: board\r\n\r\n", file->path);
+    BOARD_CHECK(hf_exchange(&h, request) == 0);
+    BOARD_CHECK(h.status == 200 && !h.close);
+    BOARD_CHECK(h.body_got == file->len && memcmp(h.body, file->data, file->len) == 0);
+    BOARD_CHECK(http_client_header(&h, "ETag", value, sizeof(value)) && strcmp(value, file->etag) == 0);
+    BOARD_CHECK(strncmp(h.head, file->head, file->head_len) == 0);
+
+    /* Query strings are not part of the path */
+    snprintf(request, sizeof(request), "GET %s?v=2 HTTP/1.1\r\n\r\n", file->path);
+    BOARD_CHECK(hf_exchange(&h, request) == 0);
+    BOARD_CHECK(h.status == 200 && h.body_got == file->len);
+
+    snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nIf-None-Match: %s\r\n\r\n", file->path, file->etag);
+    BOARD_CHECK(hf_exchange(&h, request) == 0);
+    BOARD_CHECK(h.status == 304 && h.body_got == 0);
+    BOARD_CHECK(http_client_header(&h, "ETag", value, sizeof(value)) && strcmp(value, file->etag) == 0);
+
+    snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nIf-None-Match: \"00000000\"\r\n\r\n", file->path);
+    BOARD_CHECK(hf_exchange(&h, request) == 0);
+    BOARD_CHECK(h.status == 200 && h.body_got == file->len);
+
+    snprintf(request, sizeof(request), "POST %s HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc", file->path);
+    BOARD_CHECK(hf_exchange(&h, request) == 0);
+    BOARD_CHECK(h.status == 405);
+  }
+
+  BOARD_CHECK(hf_exchange(&h, "GET /status/missing.html HTTP/1.1\r\n\r\n") == 0);
+  BOARD_CHECK(h.status == 404);
+
+  /* The close head, then the connection closes */
+  const struct http_file *file = &http_files[0];
+  char request[256];
+  snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nConnection: close\r\n\r\n", file->path);
+  uint32_t before = h.responses;
+  http_client_send(&h, request, strlen(request));
+  BOARD_CHECK(board_run(hf_closed, &h, 5000));
+  BOARD_CHECK(h.responses == before + 1 && h.status == 200 && h.close && !h.reset);
+  BOARD_CHECK(strncmp(h.head, file->head_close, file->head_close_len) == 0);
+  BOARD_CHECK(h.body_got == file->len && memcmp(h.body, file->data, file->len) == 0);
+  http_client_free(&h);
+  return 0;
+}
+
+struct hf_load_case {
+  const struct http_file *file;
+  bool revalidate;
+};
+
+static int hf_load(void *arg)
+{
+  const struct hf_load_case *lc = (const struct hf_load_case *)arg;
+  static struct http_client h;
+  BOARD_CHECK(hf_board() == 0);
+  memset(&h, 0, sizeof(h));
+  http_client_connect(&h, &hf_router, BOARD_STATIC, 80);
+
+  char request[256];
+  if (lc->revalidate) {
+    snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: board\r\nIf-None-Match: %s\r\n\r\n",
+             lc->file->path, lc->file->etag);
+  } else {
+    snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: board\r\n\r\n", lc->file->path);
+  }
+  /* The first exchange opens the connection */
+  BOARD_CHECK(hf_exchange(&h, request) == 0);
+
+  uint64_t t0 = sim_now_ns();
+  uint64_t spi0 = hf_if.chip.st.bytes;
+  for (uint32_t i = 0; i < HF_REQUESTS; i++) {
+    BOARD_CHECK(hf_exchange(&h, request) == 0);
+    BOARD_CHECK(h.status == (lc->revalidate ? 304 : 200));
+    BOARD_CHECK(h.body_got == (lc->revalidate ? 0 : lc->file->len));
+  }
+  double ns = (double)(sim_now_ns() - t0) / HF_REQUESTS;
+  printf("%s,%d,%lu,%u,%.0f,%.3f,%.0f\n", lc->file->path, lc->revalidate,
+         (unsigned long)(h.head_len + h.body_got), HF_REQUESTS, 1e9 / ns, ns / 1e6,
+         (double)(hf_if.chip.st.bytes - spi0) / HF_REQUESTS);
+  http_client_free(&h);
+  return 0;
+}
+
+int main(void)
+{
+  int failed = 0;
+  failed |= board_scenario("file content, ETag, 304", hf_content, NULL);
+  printf("path,revalidate,bytes,requests,req_per_s,ms_per_req,spi_bytes\n");
+  for (size_t i = 0; i < http_files_count; i++) {
+    for (int revalidate = 0; revalidate <= 1; revalidate++) {
+      struct hf_load_case lc = {&http_files[i], revalidate != 0};
+      char name[96];
+      snprintf(name, sizeof(name), "load %s%s", http_files[i].path, revalidate ? " (304)" : "");
+      failed |= board_scenario(name, hf_load, &lc);
+    }
+  }
+  return failed;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file
+ * @brief Example server response from flash with the patched view counter.
+ *
+ * Runs the sketch with DHCP from the router and fetches / on a fresh
+ * connection per request. Checks that every body reads "View Count: N" with
+ * N counting up across the digit carries (9, 99, 999) and that
+ * Content-Length matches the body, then prints per request:
+ *
+ *     test,requests,req_per_s,ms_per_req,spi_bytes,serial_bytes
+ *
+ * req_per_s is sequential requests per second of simulated time, each
+ * paying the TCP handshake and teardown; spi_bytes and serial_bytes are the
+ * SPI bytes clocked and the Serial bytes printed by the sketch.
+ * test_http_flash_prof builds the sketch with HTTP_PROF=1 for comparison.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "board_sketch.h"
+#include "http_client.h"
+
+#define FLASH_REQUESTS 1005
+
+static struct w5500_sim flash_chip;
+static struct net_port flash_port;
+static struct peer flash_router;
+
+static bool flash_server_up(void *arg)
+{
+  (void)arg;
+  return board_sketch_line("Starting HTTP server", NULL) != NULL;
+}
+
+static bool flash_done(void *arg)
+{
+  struct http_client *h = (struct http_client *)arg;
+  return h->responses == 1 && h->closed;
+}
+
+/**
+ * @brief Fetches / and checks the body against @p expected.
+ */
+static int flash_get(struct http_client *h, uint32_t expected)
+{
+  memset(h, 0, sizeof(*h));
+  http_client_connect(h, &flash_router, BOARD_POOL, 80);
+  http_client_get(h, "/", false);
+  BOARD_CHECK(board_sketch_run(flash_done, h, 5000));
+  BOARD_CHECK(h->status == 200 && h->bad == 0 && !h->reset);
+
+  char want[32], length[16];
+  int n = snprintf(want, sizeof(want), "View Count: %lu", (unsigned long)expected);
+  BOARD_CHECK(h->body_got == (size_t)n && memcmp(h->body, want, (size_t)n) == 0);
+  BOARD_CHECK(http_client_header(h, "Content-Length", length, sizeof(length)) != NULL);
+  BOARD_CHECK(strtol(length, NULL, 10) == n);
+  http_client_free(h);
+  return 0;
+}
+
+static int flash_run(void *arg)
+{
+  (void)arg;
+  board_sketch_init(&flash_chip, &flash_port, 1);
+  board_router(&flash_router);
+  board_sketch_setup();
+  BOARD_CHECK(board_sketch_run(flash_server_up, NULL, 10000));
+
+  struct http_client h;
+  BOARD_CHECK(flash_get(&h, 1) == 0);
+
+  uint64_t t0 = sim_now_ns();
+  uint64_t spi0 = flash_chip.st.bytes;
+  uint64_t serial0 = arduino_serial_bytes();
+  for (uint32_t i = 2; i <= FLASH_REQUESTS; i++) {
+    if (flash_get(&h, i) != 0) {
+      fprintf(stderr, "request %lu\n", (unsigned long)i);
+      return 1;
+    }
+  }
+  uint32_t n = FLASH_REQUESTS - 1;
+  double ns = (double)(sim_now_ns() - t0) / n;
+  printf("sequential,%lu,%.0f,%.3f,%.0f,%.1f\n", (unsigned long)n, 1e9 / ns, ns / 1e6,
+         (double)(flash_chip.st.bytes - spi0) / n, (double)(arduino_serial_bytes() - serial0) / n);
+  return 0;
+}
+
+int main(void)
+{
+  printf("test,requests,req_per_s,ms_per_req,spi_bytes,serial_bytes\n");
+  return board_scenario("http view counter", flash_run, NULL);
+}
@@ -0,0 +1,210 @@
+/**
+ * @file
+ * @brief HTTP keep-alive, pipelining, idle timeout and the connection table
+ *        of the example server.
+ *
+ * Built with HTTP_KEEPALIVE 1 and 0. The load scenario fetches / 500 times
+ * in a row, over one connection with keep-alive and a new connection per
+ * request without, and prints:
+ *
+ *     keepalive,requests,req_per_s,ms_per_req,pcb_max,time_wait_end,spi_bytes
+ *
+ * pcb_max is the most TCP PCBs in use at once (the listening PCB is a
+ * separate pool), time_wait_end the PCBs left in TIME_WAIT at the end and
+ * spi_bytes the SPI bytes per request. With keep-alive, further scenarios
+ * check that eight pipelined requests are answered in order, that an idle
+ * connection is closed after HTTP_IDLE_TIMEOUT_MS, and that a new
+ * connection evicts the least recently used idle one when the table is
+ * full.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lwip/stats.h"
+#include "lwip/priv/tcp_priv.h"
+
+#include "board.h"
+#include "http_client.h"
+#include "http_server.h"
+
+#define KA_REQUESTS 500
+
+static struct board_if ka_if;
+static struct peer ka_router;
+
+static int ka_board(void)
+{
+  board_init();
+  board_router(&ka_router);
+  board_if_power(&ka_if, 1);
+  BOARD_CHECK(board_if_up(&ka_if, BOARD_STATIC, NULL));
+  BOARD_CHECK(board_wait_addr(5000));
+  BOARD_CHECK(http_server_start(80));
+  return 0;
+}
+
+static bool ka_responses(void *arg)
+{
+  struct http_client *h = (struct http_client *)arg;
+  return h->responses > 0 && !h->in_body;
+}
+
+static bool ka_closed(void *arg)
+{
+  struct http_client *h = (struct http_client *)arg;
+  return h->closed;
+}
+
+/**
+ * @brief Checks that the last response is the view count @p n.
+ */
+static int ka_check_body(struct http_client *h, uint32_t n)
+{
+  char want[32];
+  int len = snprintf(want, sizeof(want), "View Count: %lu", (unsigned long)n);
+  BOARD_CHECK(h->status == 200 && h->bad == 0);
+  BOARD_CHECK(h->body_got == (size_t)len && memcmp(h->body, want, (size_t)len) == 0);
+  return 0;
+}
+
+static uint32_t ka_time_wait(void)
+{
+  uint32_t n = 0;
+  for (struct tcp_pcb *pcb = tcp_tw_pcbs; pcb != NULL; pcb = pcb->next) {
+    n++;
+  }
+  return n;
+}
+
+static int ka_load(void *arg)
+{
+  (void)arg;
+  static struct http_client h;
+  BOARD_CHECK(ka_board() == 0);
+
+  uint64_t t0 = sim_now_ns();
+  uint64_t spi0 = ka_if.chip.st.bytes;
+  memset(&h, 0, sizeof(h));
+  for (uint32_t i = 1; i <= KA_REQUESTS; i++) {
+    if (!HTTP_KEEPALIVE || i == 1) {
+      http_client_free(&h);
+      memset(&h, 0, sizeof(h));
+      http_client_connect(&h, &ka_router, BOARD_STATIC, 80);
+    }
+    uint32_t before = h.responses;
+    http_client_get(&h, "/", HTTP_KEEPALIVE != 0);
+    while (h.responses == before) {
+      BOARD_CHECK(!h.reset && !(h.closed && h.responses == before));
+      BOARD_CHECK(sim_now_ns() - t0 < 600000000000ull);
+      board_poll();
+    }
+    BOARD_CHECK(ka_check_body(&h, i) == 0);
+    BOARD_CHECK(h.close == !HTTP_KEEPALIVE);
+    if (!HTTP_KEEPALIVE) {
+      BOARD_CHECK(board_run(ka_closed, &h, 5000));
+    }
+  }
+  double ns = (double)(sim_now_ns() - t0) / KA_REQUESTS;
+  printf("%d,%u,%.0f,%.3f,%u,%lu,%.0f\n", HTTP_KEEPALIVE, KA_REQUESTS, 1e9 / ns, ns / 1e6,
+         (unsigned)lwip_stats.memp[MEMP_TCP_PCB]->max, (unsigned long)ka_time_wait(),
+         (double)(ka_if.chip.st.bytes - spi0) / KA_REQUESTS);
+  http_client_free(&h);
+  return 0;
+}
+
+static uint32_t ka_pipelined_views;
+static int ka_pipelined_bad;
+
+static void ka_pipelined_response(struct http_client *h, void *arg)
+{
+  (void)arg;
+  char want[32];
+  int len = snprintf(want, sizeof(want), "View Count: %lu", (unsigned long)++ka_pipelined_views);
+  if (h->status != 200 || h->body_got != (size_t)len || memcmp(h->body, want, (size_t)len) != 0) {
+    ka_pipelined_bad++;
+  }
+}
+
+static bool ka_eight(void *arg)
+{
+  return ((struct http_client *)arg)->responses == 8;
+}
+
+static int ka_pipelined(void *arg)
+{
+  (void)arg;
+  static struct http_client h;
+  BOARD_CHECK(ka_board() == 0);
+  memset(&h, 0, sizeof(h));
+  h.on_response = ka_pipelined_response;
+  http_client_connect(&h, &ka_router, BOARD_STATIC, 80);
+
+  char req[8 * 64];
+  size_t n = 0;
+  for (int i = 0; i < 8; i++) {
+    n += (size_t)snprintf(req + n, sizeof(req) - n, "GET / HTTP/1.1\r\nHost: board\r\n\r\n");
+  }
+  http_client_send(&h, req, n);
+  BOARD_CHECK(board_run(ka_eight, &h, 5000));
+  BOARD_CHECK(ka_pipelined_bad == 0 && !h.closed);
+  http_client_free(&h);
+  return 0;
+}
+
+static int ka_idle(void *arg)
+{
+  (void)arg;
+  static struct http_client h;
+  BOARD_CHECK(ka_board() == 0);
+  memset(&h, 0, sizeof(h));
+  http_client_connect(&h, &ka_router, BOARD_STATIC, 80);
+  http_client_get(&h, "/", true);
+  BOARD_CHECK(board_run(ka_responses, &h, 5000));
+  uint64_t t0 = h.done_ns;
+  BOARD_CHECK(board_run(ka_closed, &h, HTTP_IDLE_TIMEOUT_MS + 2000));
+  uint64_t idle_ms = (sim_now_ns() - t0) / 1000000u;
+  BOARD_CHECK(idle_ms >= HTTP_IDLE_TIMEOUT_MS && !h.reset);
+  board_run_for(500);
+  BOARD_CHECK(lwip_stats.memp[MEMP_TCP_PCB]->used - ka_time_wait() == 0);
+  http_client_free(&h);
+  return 0;
+}
+
+static int ka_evict(void *arg)
+{
+  (void)arg;
+  static struct http_client h[HTTP_MAX_CONNS + 1];
+  BOARD_CHECK(ka_board() == 0);
+  for (int i = 0; i <= HTTP_MAX_CONNS; i++) {
+    memset(&h[i], 0, sizeof(h[i]));
+    http_client_connect(&h[i], &ka_router, BOARD_STATIC, 80);
+    http_client_get(&h[i], "/", true);
+    BOARD_CHECK(board_run(ka_responses, &h[i], 5000));
+    BOARD_CHECK(ka_check_body(&h[i], (uint32_t)i + 1) == 0);
+    board_run_for(100);
+  }
+  /* The first connection was idle longest */
+  board_run_for(100);
+  BOARD_CHECK(h[0].closed);
+  for (int i = 1; i <= HTTP_MAX_CONNS; i++) {
+    BOARD_CHECK(!h[i].closed);
+  }
+  for (int i = 0; i <= HTTP_MAX_CONNS; i++) {
+    http_client_free(&h[i]);
+  }
+  return 0;
+}
+
+int main(void)
+{
+  int failed = 0;
+  printf("keepalive,requests,req_per_s,ms_per_req,pcb_max,time_wait_end,spi_bytes\n");
+  failed |= board_scenario(HTTP_KEEPALIVE ? "keep-alive load" : "connection per request load", ka_load, NULL);
+  if (HTTP_KEEPALIVE) {
+    failed |= board_scenario("pipelined requests", ka_pipelined, NULL);
+    failed |= board_scenario("idle timeout", ka_idle, NULL);
+    failed |= board_scenario("connection table eviction", ka_evict, NULL);
+  }
+  return failed;
+}
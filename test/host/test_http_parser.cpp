@@ -0,0 +1,485 @@
+/**
+ * @file
+ * @brief Request parser of the example server: expected results, split
+ *        invariance, pipelining, fuzzing and throughput.
+ *
+ * Every request of the table is parsed whole, byte by byte, split at every
+ * point in two and as a chain of small pbufs; all must give the expected
+ * method, path, flags, ETag or error status. The fuzz scenario mutates the
+ * table requests at random (fixed seed) and checks that every way of
+ * feeding a request gives the same result and that the parser never
+ * writes past its buffers. The throughput scenario parses a typical
+ * browser request and prints:
+ *
+ *     feed,request_bytes,requests,ns_per_req,ns_per_byte
+ *
+ * Built with -DHOST_FUZZ=ON (clang), the same checks run as a libFuzzer
+ * target, test_http_parser_fuzz, on arbitrary input.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lwip/pbuf.h"
+
+#include "board.h"
+#include "http_parser.h"
+
+#define HP_FUZZ_CASES 20000
+#define HP_BENCH_REQUESTS 20000
+
+/* HTTP_PATH_MAX bytes */
+#define HP_PATH_MAX "/abcdefghijklmnopqrstuvwxyz/abcdefghijklmnopqrstuvwxyz/012345678"
+
+#define HP_DONE  HTTP_PARSE_DONE
+#define HP_ERROR HTTP_PARSE_ERROR
+
+struct hp_case {
+  const char *request;
+  uint8_t state;
+  uint16_t status;
+  uint8_t method;
+  const char *path;
+  uint8_t flags;
+  const char *etag;
+};
+
+static const struct hp_case hp_cases[] = {
+  {"GET / HTTP/1.1\r\nHost: board\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", 0, ""},
+  {"HEAD /index.html?x=1&y=2 HTTP/1.1\r\n\r\n", HP_DONE, 0, HTTP_METHOD_HEAD, "/index.html", 0, ""},
+  {"GET / HTTP/1.0\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", HTTP_REQ_HTTP10, ""},
+  {"GET / HTTP/1.1\n\n", HP_DONE, 0, HTTP_METHOD_GET, "/", 0, ""},
+  {"\r\n\r\nGET /a HTTP/1.1\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/a", 0, ""},
+  {"OPTIONS * HTTP/1.1\r\n\r\n", HP_DONE, 0, HTTP_METHOD_OPTIONS, "*", 0, ""},
+  {"BREW /pot HTTP/1.1\r\n\r\n", HP_DONE, 0, HTTP_METHOD_UNKNOWN, "/pot", 0, ""},
+  {"GETS / HTTP/1.1\r\n\r\n", HP_DONE, 0, HTTP_METHOD_UNKNOWN, "/", 0, ""},
+  {"GET / HTTP/1.1\r\nConnection: close\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", HTTP_REQ_CLOSE, ""},
+  {"GET / HTTP/1.1\r\nconnection: Keep-Alive, CLOSE\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", HTTP_REQ_CLOSE, ""},
+  {"GET / HTTP/1.1\r\nConnection: closed\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", 0, ""},
+  {"GET / HTTP/1.1\r\nConnection: keep-alive\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", 0, ""},
+  {"GET / HTTP/1.1\r\nX-Connection: close\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", 0, ""},
+  {"GET / HTTP/1.1\r\nConnection: close \r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", HTTP_REQ_CLOSE, ""},
+  {"GET / HTTP/1.1\r\nIf-None-Match: \"5f3c9a1e\"\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", 0, "\"5f3c9a1e\""},
+  {"GET / HTTP/1.1\r\nif-none-match:\t\"a\" \t\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", 0, "\"a\""},
+  {"GET / HTTP/1.1\r\nIf-None-Match: \"0123456789012345678901234\"\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", 0, ""},
+  {"GET / HTTP/1.1\r\nAccept-Encoding: gzip, deflate\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", HTTP_REQ_GZIP, ""},
+  {"GET / HTTP/1.1\r\nAccept-Encoding: br,GZIP\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", HTTP_REQ_GZIP, ""},
+  {"GET / HTTP/1.1\r\nAccept-Encoding:  gzip \r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", HTTP_REQ_GZIP, ""},
+  {"GET / HTTP/1.1\r\nAccept-Encoding: gzip;q=0.5\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", HTTP_REQ_GZIP, ""},
+  {"GET / HTTP/1.1\r\nAccept-Encoding: gzip; q=0.000, br\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", 0, ""},
+  {"GET / HTTP/1.1\r\nAccept-Encoding: x-gzip, gzipped, gz ip\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", 0, ""},
+  {"POST /form HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello", HP_DONE, 0, HTTP_METHOD_POST, "/form", 0, ""},
+  {"PUT /f HTTP/1.1\r\nContent-Length: 0\r\n\r\n", HP_DONE, 0, HTTP_METHOD_PUT, "/f", 0, ""},
+  {"GET " HP_PATH_MAX "/ HTTP/1.1\r\n\r\n", HP_ERROR, 414, HTTP_METHOD_GET, NULL, 0, NULL},
+  {"get / HTTP/1.1\r\n\r\n", HP_ERROR, 400, 0, NULL, 0, NULL},
+  {"GET  HTTP/1.1\r\n\r\n", HP_ERROR, 400, HTTP_METHOD_GET, NULL, 0, NULL},
+  {"GET /x\r\n\r\n", HP_ERROR, 400, HTTP_METHOD_GET, NULL, 0, NULL},
+  {"GET / HTTP/1.1 \r\n\r\n", HP_ERROR, 400, HTTP_METHOD_GET, NULL, 0, NULL},
+  {"GET / HTTX/1.1\r\n\r\n", HP_ERROR, 400, HTTP_METHOD_GET, NULL, 0, NULL},
+  {"GET / HTTP/1.2\r\n\r\n", HP_ERROR, 505, HTTP_METHOD_GET, NULL, 0, NULL},
+  {"GET / HTTP/2.0\r\n\r\n", HP_ERROR, 505, HTTP_METHOD_GET, NULL, 0, NULL},
+  {"GET / HTTP/0.9\r\n\r\n", HP_ERROR, 505, HTTP_METHOD_GET, NULL, 0, NULL},
+  {"GET / HTTP/x.1\r\n\r\n", HP_ERROR, 400, HTTP_METHOD_GET, NULL, 0, NULL},
+  {"POST /form HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n0\r\n\r\n", HP_ERROR, 501, HTTP_METHOD_POST, NULL, 0, NULL},
+  {"POST / HTTP/1.1\r\ntransfer-encoding:\tgzip, chunked\r\n\r\n", HP_ERROR, 501, HTTP_METHOD_POST, NULL, 0, NULL},
+  {"GET / HTTP/1.1\r\nX-Transfer-Encoding: chunked\r\n\r\n", HP_DONE, 0, HTTP_METHOD_GET, "/", 0, ""},
+  {"GET / HTTP/1.1\r\nBad Header: x\r\n\r\n", HP_ERROR, 400, HTTP_METHOD_GET, NULL, 0, NULL},
+  {"GET / HTTP/1.1\r\n: x\r\nNo-Colon\r\n\r\n", HP_ERROR, 400, HTTP_METHOD_GET, NULL, 0, NULL},
+  {"POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n", HP_ERROR, 400, HTTP_METHOD_POST, NULL, 0, NULL},
+  {"POST / HTTP/1.1\r\nContent-Length: 99999999\r\n\r\n", HP_ERROR, 413, HTTP_METHOD_POST, NULL, 0, NULL},
+};
+
+static char hp_long_header[HTTP_MAX_REQUEST + 64];
+
+/**
+ * @brief Result of parsing one request, compared between feeding methods.
+ */
+struct hp_result {
+  uint8_t state;
+  uint16_t status;
+  uint8_t method;
+  uint8_t flags;
+  size_t consumed;
+  char path[HTTP_PATH_MAX + 1];
+  char etag[HTTP_ETAG_MAX + 1];
+};
+
+/**
+ * @brief Parser surrounded by guard bytes, to catch writes past its buffers.
+ */
+struct hp_guarded {
+  uint8_t before[16];
+  struct http_parser parser;
+  uint8_t after[16];
+};
+
+static void hp_result(const struct http_parser *parser, size_t consumed, struct hp_result *r)
+{
+  memset(r, 0, sizeof(*r));
+  r->state = parser->state;
+  r->status = parser->status;
+  r->method = parser->method;
+  r->flags = parser->flags;
+  r->consumed = consumed;
+  if (parser->state == HTTP_PARSE_DONE) {
+    memcpy(r->path, parser->path, sizeof(r->path));
+    memcpy(r->etag, parser->etag, sizeof(r->etag));
+  }
+}
+
+static bool hp_guard_ok(const struct hp_guarded *g)
+{
+  for (size_t i = 0; i < sizeof(g->before); i++) {
+    if (g->before[i] != 0xA5 || g->after[i] != 0xA5) {
+      return false;
+    }
+  }
+  const struct http_parser *p = &g->parser;
+  return p->path_len <= HTTP_PATH_MAX + 1 && p->etag_len <= HTTP_ETAG_MAX + 1 &&
+         p->length <= HTTP_MAX_REQUEST + 1 && memchr(p->path, '\0', sizeof(p->path)) != NULL &&
+         memchr(p->etag, '\0', sizeof(p->etag)) != NULL;
+}
+
+static void hp_guard_init(struct hp_guarded *g)
+{
+  memset(g, 0xA5, sizeof(*g));
+  http_parser_init(&g->parser);
+}
+
+/**
+ * @brief Feeds @p data in pieces of the given sizes (cycled), up to the end of one request.
+ */
+static bool hp_feed_split(const char *data, size_t len, const size_t *sizes, size_t nsizes, struct hp_result *r)
+{
+  struct hp_guarded g;
+  hp_guard_init(&g);
+  size_t off = 0;
+  for (size_t i = 0; off < len && g.parser.state < HTTP_PARSE_DONE; i++) {
+    size_t n = sizes[i % nsizes];
+    if (n > len - off) {
+      n = len - off;
+    }
+    size_t used = http_parser_feed(&g.parser, data + off, n);
+    off += used;
+    if (used < n && g.parser.state < HTTP_PARSE_DONE) {
+      return false;  // Stopped early without finishing
+    }
+  }
+  hp_result(&g.parser, off, r);
+  return hp_guard_ok(&g);
+}
+
+/**
+ * @brief Feeds @p data as a pbuf chain of the given payload sizes (cycled).
+ *
+ * The chain is built in place over @p data, like the PBUF_REF chains of a
+ * received segment, so long inputs do not depend on the lwIP heap size.
+ */
+static bool hp_feed_chain(const char *data, size_t len, const size_t *sizes, size_t nsizes, struct hp_result *r)
+{
+  static struct pbuf chain[HTTP_MAX_REQUEST * 2];
+  size_t count = 0, off = 0;
+  for (size_t i = 0; off < len; i++) {
+    size_t n = sizes[i % nsizes];
+    if (n > len - off) {
+      n = len - off;
+    }
+    if (count == sizeof(chain) / sizeof(chain[0])) {
+      return false;
+    }
+    struct pbuf *q = &chain[count++];
+    memset(q, 0, sizeof(*q));
+    q->payload = (void *)(data + off);
+    q->len = (u16_t)n;
+    q->tot_len = (u16_t)(len - off);
+    q->next = off + n < len ? q + 1 : NULL;
+    off += n;
+  }
+
+  struct hp_guarded g;
+  hp_guard_init(&g);
+  size_t consumed = count ? http_parser_feed_pbuf(&g.parser, chain) : 0;
+  hp_result(&g.parser, consumed, r);
+  return hp_guard_ok(&g);
+}
+
+static bool hp_same(const struct hp_result *a, const struct hp_result *b)
+{
+  return memcmp(a, b, sizeof(*a)) == 0;
+}
+
+/**
+ * @brief Parses @p data whole, byte by byte, split in two everywhere and as pbuf chains.
+ *
+ * @param r Result of the whole feed.
+ * @return true if every way gives the same result and the guards hold.
+ */
+static bool hp_invariant(const char *data, size_t len, struct hp_result *r)
+{
+  static const size_t one[] = {1};
+  static const size_t odd[] = {3, 1, 7, 2};
+  size_t all = len ? len : 1;
+  struct hp_result other;
+
+  if (!hp_feed_split(data, len, &all, 1, r)) {
+    return false;
+  }
+  if (!hp_feed_split(data, len, one, 1, &other) || !hp_same(r, &other)) {
+    return false;
+  }
+  if (!hp_feed_split(data, len, odd, 4, &other) || !hp_same(r, &other)) {
+    return false;
+  }
+  for (size_t cut = 1; cut < len; cut++) {
+    size_t sizes[2] = {cut, len - cut};
+    if (!hp_feed_split(data, len, sizes, 2, &other) || !hp_same(r, &other)) {
+      return false;
+    }
+  }
+  if (len > 0) {
+    if (!hp_feed_chain(data, len, odd, 4, &other) || !hp_same(r, &other)) {
+      return false;
+    }
+    if (!hp_feed_chain(data, len, &all, 1, &other) || !hp_same(r, &other)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static int hp_check_case(const char *request, size_t len, const struct hp_case *c)
+{
+  struct hp_result r;
+  if (!hp_invariant(request, len, &r)) {
+    fprintf(stderr, "split or guard mismatch: %.60s\n", request);
+    return 1;
+  }
+  if (r.state != c->state || r.status != c->status || r.method != c->method) {
+    fprintf(stderr, "%.60s: state %u status %u method %u\n", request, r.state, r.status, r.method);
+    return 1;
+  }
+  if (c->state == HP_DONE) {
+    BOARD_CHECK(r.consumed == len);
+    BOARD_CHECK(strcmp(r.path, c->path) == 0);
+    BOARD_CHECK(r.flags == c->flags);
+    BOARD_CHECK(strcmp(r.etag, c->etag) == 0);
+  }
+  return 0;
+}
+
+static int hp_table(void *arg)
+{
+  (void)arg;
+  for (size_t i = 0; i < sizeof(hp_cases) / sizeof(hp_cases[0]); i++) {
+    const struct hp_case *c = &hp_cases[i];
+    if (hp_check_case(c->request, strlen(c->request), c) != 0) {
+      return 1;
+    }
+  }
+
+  /* A path of exactly HTTP_PATH_MAX bytes is kept whole */
+  static const char max_path[] = "GET " HP_PATH_MAX "?q HTTP/1.1\r\n\r\n";
+  static const struct hp_case max_path_case = {max_path, HP_DONE, 0, HTTP_METHOD_GET, HP_PATH_MAX, 0, ""};
+  if (hp_check_case(max_path, sizeof(max_path) - 1, &max_path_case) != 0) {
+    return 1;
+  }
+
+  /* NUL bytes are not allowed anywhere in the head */
+  static const char nul[] = "GET / HTTP/1.1\r\nHost: a\0b\r\n\r\n";
+  static const struct hp_case nul_case = {nul, HP_ERROR, 400, HTTP_METHOD_GET, NULL, 0, NULL};
+  if (hp_check_case(nul, sizeof(nul) - 1, &nul_case) != 0) {
+    return 1;
+  }
+
+  /* A head one byte over HTTP_MAX_REQUEST fails, one at the limit does not */
+  static const char line[] = "GET / HTTP/1.1\r\nX: ";
+  static const char end[] = "\r\n\r\n";
+  for (int over = 0; over <= 1; over++) {
+    size_t fill = HTTP_MAX_REQUEST - (sizeof(line) - 1) - (sizeof(end) - 1) + over;
+    memcpy(hp_long_header, line, sizeof(line) - 1);
+    memset(hp_long_header + sizeof(line) - 1, 'x', fill);
+    memcpy(hp_long_header + sizeof(line) - 1 + fill, end, sizeof(end));
+    struct hp_case limit = {hp_long_header, over ? HP_ERROR : HP_DONE, (uint16_t)(over ? 431 : 0),
+                            HTTP_METHOD_GET, "/", 0, ""};
+    if (hp_check_case(hp_long_header, strlen(hp_long_header), &limit) != 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Three requests in one buffer, the second with a body, parsed one after the other.
+ */
+static int hp_pipelined(void *arg)
+{
+  (void)arg;
+  static const char data[] =
+      "GET /one HTTP/1.1\r\n\r\n"
+      "POST /two HTTP/1.1\r\nContent-Length: 10\r\n\r\n0123456789"
+      "GET /three HTTP/1.1\r\nConnection: close\r\n\r\n";
+  static const char *const paths[] = {"/one", "/two", "/three"};
+  static const size_t sizes[] = {1, 5, 64, sizeof(data)};
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    struct http_parser parser;
+    http_parser_init(&parser);
+    size_t off = 0, got = 0;
+    while (off < sizeof(data) - 1) {
+      size_t n = sizeof(data) - 1 - off < sizes[s] ? sizeof(data) - 1 - off : sizes[s];
+      size_t used = http_parser_feed(&parser, data + off, n);
+      off += used;
+      if (parser.state == HTTP_PARSE_DONE) {
+        BOARD_CHECK(got < 3 && strcmp(parser.path, paths[got]) == 0);
+        BOARD_CHECK(http_parser_keep_alive(&parser) == (got < 2));
+        got++;
+        http_parser_init(&parser);
+      } else {
+        BOARD_CHECK(parser.state != HTTP_PARSE_ERROR && used == n);
+      }
+    }
+    BOARD_CHECK(got == 3);
+  }
+  return 0;
+}
+
+static uint32_t hp_rand_state = 12345;
+
+static uint32_t hp_rand(void)
+{
+  hp_rand_state = hp_rand_state * 1103515245u + 12345u;
+  return hp_rand_state >> 8;
+}
+
+/**
+ * @brief Characters the mutations insert: the ones the parser acts on, and any byte.
+ */
+static char hp_rand_char(void)
+{
+  static const char special[] = " \t\r\n:;,=?/.0123456789qHTP";
+  uint32_t r = hp_rand();
+  return (r & 1) ? special[(r >> 1) % (sizeof(special) - 1)] : (char)(r >> 8);
+}
+
+static int hp_fuzz(void *arg)
+{
+  (void)arg;
+  static char buf[HTTP_MAX_REQUEST * 2];
+  uint32_t done = 0, errors = 0;
+
+  for (uint32_t n = 0; n < HP_FUZZ_CASES; n++) {
+    const struct hp_case *c = &hp_cases[hp_rand() % (sizeof(hp_cases) / sizeof(hp_cases[0]))];
+    size_t len = strlen(c->request);
+    memcpy(buf, c->request, len);
+    for (uint32_t m = 1 + hp_rand() % 4; m > 0; m--) {
+      size_t at = len ? hp_rand() % len : 0;
+      switch (hp_rand() % 4) {
+      case 0:  // Replace
+        if (len) {
+          buf[at] = hp_rand_char();
+        }
+        break;
+      case 1:  // Insert
+        if (len < sizeof(buf)) {
+          memmove(buf + at + 1, buf + at, len - at);
+          buf[at] = hp_rand_char();
+          len++;
+        }
+        break;
+      case 2:  // Delete
+        if (len) {
+          memmove(buf + at, buf + at + 1, len - at - 1);
+          len--;
+        }
+        break;
+      case 3:  // Repeat a run
+        if (len && len < sizeof(buf) / 2) {
+          size_t run = 1 + hp_rand() % 16;
+          run = run > len - at ? len - at : run;
+          memmove(buf + at + run, buf + at, len - at);
+          len += run;
+        }
+        break;
+      }
+    }
+    struct hp_result r;
+    if (!hp_invariant(buf, len, &r)) {
+      fprintf(stderr, "fuzz case %lu: split or guard mismatch: %.*s\n", (unsigned long)n, (int)(len < 80 ? len : 80), buf);
+      return 1;
+    }
+    BOARD_CHECK(r.state != HTTP_PARSE_ERROR || r.status >= 400);
+    done += r.state == HTTP_PARSE_DONE;
+    errors += r.state == HTTP_PARSE_ERROR;
+  }
+  fprintf(stderr, "fuzz: %u cases, %lu done, %lu errors\n", HP_FUZZ_CASES, (unsigned long)done, (unsigned long)errors);
+  BOARD_CHECK(done > 0 && errors > 0);
+  return 0;
+}
+
+static int hp_bench(void *arg)
+{
+  (void)arg;
+  static const char request[] =
+      "GET /status.css HTTP/1.1\r\n"
+      "Host: 192.168.50.40\r\n"
+      "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+      "Accept: text/css,*/*;q=0.1\r\n"
+      "Accept-Language: en-US,en;q=0.5\r\n"
+      "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+      "Connection: keep-alive\r\n"
+      "Referer: http://192.168.50.40/\r\n"
+      "If-None-Match: \"5f3c9a1e\"\r\n"
+      "Cache-Control: max-age=0\r\n"
+      "\r\n";
+  const size_t len = sizeof(request) - 1;
+  static const size_t sizes[] = {len, 536, 64, 1};
+  static const char *const names[] = {"whole", "segment_536", "pbuf_64", "byte"};
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    struct http_parser parser;
+    uint64_t t0 = sim_host_ns();
+    for (uint32_t n = 0; n < HP_BENCH_REQUESTS; n++) {
+      http_parser_init(&parser);
+      for (size_t off = 0; off < len;) {
+        size_t k = len - off < sizes[s] ? len - off : sizes[s];
+        off += http_parser_feed(&parser, request + off, k);
+      }
+    }
+    uint64_t ns = sim_host_ns() - t0;
+    BOARD_CHECK(parser.state == HTTP_PARSE_DONE && (parser.flags & HTTP_REQ_GZIP));
+    BOARD_CHECK(strcmp(parser.path, "/status.css") == 0 && strcmp(parser.etag, "\"5f3c9a1e\"") == 0);
+    printf("%s,%u,%u,%.0f,%.2f\n", names[s], (unsigned)len, HP_BENCH_REQUESTS,
+           (double)ns / HP_BENCH_REQUESTS, (double)ns / HP_BENCH_REQUESTS / len);
+  }
+  return 0;
+}
+
+#ifdef HOST_FUZZ
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+  struct hp_result r;
+  if (size > HTTP_MAX_REQUEST * 2) {
+    return 0;
+  }
+  if (!hp_invariant((const char *)data, size, &r)) {
+    abort();
+  }
+  return 0;
+}
+
+#else
+
+int main(void)
+{
+  int failed = 0;
+  failed |= board_scenario("table", hp_table, NULL);
+  failed |= board_scenario("pipelined", hp_pipelined, NULL);
+  failed |= board_scenario("fuzz", hp_fuzz, NULL);
+  printf("feed,request_bytes,requests,ns_per_req,ns_per_byte\n");
+  failed |= board_scenario("throughput", hp_bench, NULL);
+  return failed;
+}
+
+#endif
@@ -0,0 +1,204 @@
+/**
+ * @file
+ * @brief Deferred debug output of sys_log.cpp: the record ring, argument
+ *        packing and hex dump capture, drained by lwip_debug_flush().
+ *
+ * Links the target's sys_log.cpp in place of the host's immediate output
+ * and checks the lines it writes to Serial:
+ *
+ * - wrap-around: 70000 numbered messages in batches, past the end of the
+ *   ring and past the wrap of its 16-bit indices, all printed in order;
+ * - full ring: messages queued beyond LWIP_LOG_RING_SIZE are dropped,
+ *   counted by lwip_debug_dropped() and reported once the ring drains;
+ * - arguments: %s is copied at the call, %u and the other integer
+ *   conversions are packed in binary, arguments beyond
+ *   LWIP_LOG_RECORD_DATA are cut and the line marked with '~';
+ * - slow port: with Serial.availableForWrite() short, a line is written in
+ *   parts over several calls and never twice;
+ * - hex dump: at most LWIP_LOG_DUMP_MAX bytes are captured, over several
+ *   records, and the rest reported as not captured.
+ *
+ * Prints one row per scenario:
+ *
+ *     scenario,queued,records,lines,dropped
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Arduino.h"
+#include "board.h"
+
+#define LOG_LINES_MAX 64
+
+static char log_lines[LOG_LINES_MAX][160];
+static size_t log_count;        /**< Lines captured, including those beyond LOG_LINES_MAX */
+
+static void log_hook(const char *line, void *arg)
+{
+  (void)arg;
+  if (log_count < LOG_LINES_MAX) {
+    snprintf(log_lines[log_count], sizeof(log_lines[0]), "%s", line);
+  }
+  log_count++;
+}
+
+static void log_setup(void)
+{
+  board_init();
+  arduino_serial_hook(log_hook, NULL);
+  log_count = 0;
+}
+
+static int log_wrap(void *arg)
+{
+  (void)arg;
+  log_setup();
+  uint32_t next = 0, records = 0;
+  for (uint32_t seq = 0; seq < 70000; seq++) {
+    lwip_debug_printf("msg %lu\n", (unsigned long)seq);
+    if (seq % 20 == 19) {
+      log_count = 0;
+      records += lwip_debug_flush(LWIP_LOG_RING_SIZE);
+      BOARD_CHECK(log_count == 20);
+      for (size_t i = 0; i < log_count; i++) {
+        char want[32];
+        snprintf(want, sizeof(want), "[lwip] msg %lu", (unsigned long)next++);
+        BOARD_CHECK(strcmp(log_lines[i], want) == 0);
+      }
+    }
+  }
+  BOARD_CHECK(records == 70000 && next == 70000 && lwip_debug_dropped() == 0);
+  printf("wrap-around,70000,%lu,%lu,%lu\n", (unsigned long)records, (unsigned long)next,
+         (unsigned long)lwip_debug_dropped());
+  return 0;
+}
+
+static int log_full(void *arg)
+{
+  (void)arg;
+  log_setup();
+  for (unsigned i = 0; i < LWIP_LOG_RING_SIZE + 5; i++) {
+    lwip_debug_printf("msg %u\n", i);
+  }
+  BOARD_CHECK(lwip_debug_dropped() == 5);
+  uint32_t records = lwip_debug_flush(1000);
+  printf("full ring,%u,%lu,%lu,%lu\n", LWIP_LOG_RING_SIZE + 5, (unsigned long)records,
+         (unsigned long)log_count, (unsigned long)lwip_debug_dropped());
+
+  /* The queued records in order, then the drop report */
+  BOARD_CHECK(records == LWIP_LOG_RING_SIZE && log_count == LWIP_LOG_RING_SIZE + 1);
+  BOARD_CHECK(strcmp(log_lines[0], "[lwip] msg 0") == 0);
+  char want[32];
+  snprintf(want, sizeof(want), "[lwip] msg %u", LWIP_LOG_RING_SIZE - 1);
+  BOARD_CHECK(strcmp(log_lines[LWIP_LOG_RING_SIZE - 1], want) == 0);
+  BOARD_CHECK(strcmp(log_lines[LWIP_LOG_RING_SIZE], "[lwip] 5 log records dropped") == 0);
+
+  /* Reported once; the ring takes new records again */
+  lwip_debug_printf("after\n");
+  BOARD_CHECK(lwip_debug_flush(1000) == 1 && log_count == LWIP_LOG_RING_SIZE + 2);
+  BOARD_CHECK(strcmp(log_lines[LWIP_LOG_RING_SIZE + 1], "[lwip] after") == 0);
+  BOARD_CHECK(lwip_debug_dropped() == 5);
+  return 0;
+}
+
+static int log_args(void *arg)
+{
+  (void)arg;
+  log_setup();
+  char name[16];
+  strcpy(name, "eth0");
+  lwip_debug_printf("%s: %u frames, %d, %lx, %c\n", name, 42u, -7, 0xbeefUL, 'k');
+  /* The caller's buffer may change before the flush */
+  strcpy(name, "gone");
+  lwip_debug_printf("%-6s|%5u|%zu|%%\n", "ab", 7u, (size_t)1500);
+  /* 27 characters and the terminator fill the record: %u no longer fits */
+  lwip_debug_printf("%s %u\n", "0123456789abcdefghijklmnopqrstuvwxyz", 9u);
+  lwip_debug_print("plain\n");
+
+  uint32_t records = lwip_debug_flush(1000);
+  printf("arguments,4,%lu,%lu,%lu\n", (unsigned long)records, (unsigned long)log_count,
+         (unsigned long)lwip_debug_dropped());
+  BOARD_CHECK(records == 4 && log_count == 4);
+  BOARD_CHECK(strcmp(log_lines[0], "[lwip] eth0: 42 frames, -7, beef, k") == 0);
+  BOARD_CHECK(strcmp(log_lines[1], "[lwip] ab    |    7|1500|%") == 0);
+  BOARD_CHECK(strcmp(log_lines[2], "[lwip] 0123456789abcdefghijklmnopq ~") == 0);
+  BOARD_CHECK(strcmp(log_lines[3], "[lwip] plain") == 0);
+  return 0;
+}
+
+static int log_slow(void *arg)
+{
+  (void)arg;
+  log_setup();
+  lwip_debug_printf("a line longer than ten bytes %u\n", 1u);
+  lwip_debug_printf("next %u\n", 2u);
+
+  /* Ten bytes now, none on the next call: no line completes */
+  arduino_serial_room(10);
+  uint32_t records = lwip_debug_flush(1);
+  uint64_t written = arduino_serial_bytes();
+  records += lwip_debug_flush(1);
+  BOARD_CHECK(log_count == 0 && arduino_serial_bytes() == written);
+
+  /* The port drains: the rest of the line, then the next record */
+  arduino_serial_room(-1);
+  records += lwip_debug_flush(1000);
+  printf("slow port,2,%lu,%lu,%lu\n", (unsigned long)records, (unsigned long)log_count,
+         (unsigned long)lwip_debug_dropped());
+  BOARD_CHECK(records == 2 && log_count == 2);
+  BOARD_CHECK(strcmp(log_lines[0], "[lwip] a line longer than ten bytes 1") == 0);
+  BOARD_CHECK(strcmp(log_lines[1], "[lwip] next 2") == 0);
+  return 0;
+}
+
+static int log_dump(void *arg)
+{
+  (void)arg;
+  log_setup();
+  uint8_t data[100];
+  for (size_t i = 0; i < sizeof(data); i++) {
+    data[i] = (uint8_t)i;
+  }
+  hex_dump_lwip("frame", data, sizeof(data));
+  hex_dump_lwip("short", data, 10);
+  /* Changed after the capture: not seen in the output */
+  memset(data, 0xee, sizeof(data));
+
+  uint32_t records = lwip_debug_flush(1000);
+  uint32_t want_records = (LWIP_LOG_DUMP_MAX + LWIP_LOG_RECORD_DATA - 1) / LWIP_LOG_RECORD_DATA + 1;
+  printf("hex dump,2,%lu,%lu,%lu\n", (unsigned long)records, (unsigned long)log_count,
+         (unsigned long)lwip_debug_dropped());
+  BOARD_CHECK(records == want_records);
+
+  /* Header, LWIP_LOG_DUMP_MAX / 16 rows, the truncation note; then the short one */
+  size_t rows = LWIP_LOG_DUMP_MAX / 16;
+  BOARD_CHECK(log_count == 1 + rows + 1 + 2);
+  BOARD_CHECK(strcmp(log_lines[0], "frame (100 bytes):") == 0);
+  for (size_t r = 0; r < rows; r++) {
+    char want[64];
+    int n = snprintf(want, sizeof(want), "%04x: ", (unsigned)(r * 16));
+    for (size_t i = 0; i < 16; i++) {
+      n += snprintf(&want[n], sizeof(want) - n, "%02x ", (unsigned)(r * 16 + i));
+    }
+    BOARD_CHECK(strcmp(log_lines[1 + r], want) == 0);
+  }
+  char note[48];
+  snprintf(note, sizeof(note), "... (%u bytes not captured)", (unsigned)(sizeof(data) - LWIP_LOG_DUMP_MAX));
+  BOARD_CHECK(strcmp(log_lines[1 + rows], note) == 0);
+  BOARD_CHECK(strcmp(log_lines[2 + rows], "short (10 bytes):") == 0);
+  BOARD_CHECK(strcmp(log_lines[3 + rows], "0000: 00 01 02 03 04 05 06 07 08 09 ") == 0);
+  return 0;
+}
+
+int main(void)
+{
+  int failed = 0;
+  printf("scenario,queued,records,lines,dropped\n");
+  failed |= board_scenario("wrap-around", log_wrap, NULL);
+  failed |= board_scenario("full ring", log_full, NULL);
+  failed |= board_scenario("arguments", log_args, NULL);
+  failed |= board_scenario("slow port", log_slow, NULL);
+  failed |= board_scenario("hex dump", log_dump, NULL);
+  return failed;
+}
@@ -0,0 +1,207 @@
+/**
+ * @file
+ * @brief Idle sleep of the event-driven main loop (netsched_run()).
+ *
+ * Built with NETSCHED_POLL_MS at 20, so that the limits on a sleep can be
+ * told apart from the 1 ms tick that wakes the simulated MCU. The module
+ * comes up with a static address, then the loop runs:
+ *
+ * - idle: no traffic for a second; the loop sleeps most of it, in passes
+ *   of up to NETSCHED_POLL_MS;
+ * - notify: an interrupt calls netsched_notify() 5 ms into a sleep, 20
+ *   times; each sleep ends at the interrupt;
+ * - timer: a lwIP timeout of 5 ms, shorter than NETSCHED_POLL_MS, re-armed
+ *   20 times, runs at its deadline instead of at the end of the poll
+ *   interval;
+ * - busy: a backlog of frames in the chip is drained without sleeping in
+ *   between, ETHIF_RX_POLL_MAX_FRAMES per pass.
+ *
+ * Prints one row per scenario:
+ *
+ *     scenario,ms,loops,sleeps,notified,sleep_pct,late_max_us
+ *
+ * sleep_pct is the share of the elapsed time spent asleep. late_max_us is,
+ * for notify, the longest time from the interrupt to the return of
+ * netsched_run(), and for timer the longest delay of the timeout past its
+ * deadline.
+ */
+
+#include <string.h>
+
+#include "lwip/sys.h"
+#include "lwip/timeouts.h"
+#include "netsched.h"
+
+#include "board.h"
+
+#define NS_IRQ_LINE 3
+#define NS_ROUNDS 20
+#define NS_DELAY_MS 5
+
+static struct board_if ns_if;
+static uint64_t ns_event_ns;        /**< Time of the last notify or timeout, 0 if none pending */
+static uint64_t ns_due_ns;          /**< Deadline of the pending timeout */
+
+/**
+ * @brief One main loop pass, as loop() with netsched.
+ */
+static void ns_loop(void)
+{
+  netsched_run();
+  sim_advance(SIM_CPU_LOOP_NS);
+}
+
+/**
+ * @brief Runs the loop for @p ms.
+ */
+static void ns_run_for(uint32_t ms)
+{
+  uint64_t end = sim_now_ns() + (uint64_t)ms * 1000000u;
+  while (sim_now_ns() < end) {
+    ns_loop();
+  }
+}
+
+static void ns_row(const char *name, uint64_t t0, const struct netsched_stats *st, uint64_t late_ns)
+{
+  /* busy_cycles is only settled at the next sleep: share of the elapsed time */
+  uint64_t total = (sim_now_ns() - t0) * (SIM_CPU_HZ / 1000000u) / 1000u;
+  printf("%s,%.1f,%lu,%lu,%lu,%u,%lu\n", name, (double)(sim_now_ns() - t0) / 1e6, (unsigned long)st->loops,
+         (unsigned long)st->sleeps, (unsigned long)st->notified,
+         (unsigned)(total ? st->sleep_cycles * 100 / total : 0), (unsigned long)(late_ns / 1000));
+}
+
+static void ns_notify(void *arg)
+{
+  (void)arg;
+  ns_event_ns = sim_now_ns();
+  netsched_notify();
+}
+
+static void ns_timeout(void *arg)
+{
+  (void)arg;
+  ns_event_ns = sim_now_ns();
+}
+
+static int ns_setup(void)
+{
+  board_init();
+  board_if_power(&ns_if, 1);
+  BOARD_CHECK(board_if_up(&ns_if, BOARD_STATIC, NULL));
+  BOARD_CHECK(board_wait_addr(5000));
+  board_run_for(3000);
+  /* Settle into sleeping, then count from here */
+  ns_run_for(100);
+  netsched_reset_stats();
+  return 0;
+}
+
+static int ns_idle(void *arg)
+{
+  (void)arg;
+  BOARD_CHECK(ns_setup() == 0);
+  uint64_t t0 = sim_now_ns();
+  ns_run_for(1000);
+  struct netsched_stats st;
+  netsched_get_stats(&st);
+  ns_row("idle", t0, &st, 0);
+
+  /* About one pass per NETSCHED_POLL_MS, a few more for the lwIP timers */
+  BOARD_CHECK(st.sleeps >= 1000 / NETSCHED_POLL_MS && st.loops <= 2 * 1000 / NETSCHED_POLL_MS);
+  BOARD_CHECK(st.notified == 0);
+  BOARD_CHECK(st.sleep_cycles * 100 >= (uint64_t)SIM_CPU_HZ * 95);
+  return 0;
+}
+
+static int ns_notified(void *arg)
+{
+  (void)arg;
+  BOARD_CHECK(ns_setup() == 0);
+  uint64_t t0 = sim_now_ns();
+  uint64_t late_max = 0;
+  for (int i = 0; i < NS_ROUNDS; i++) {
+    ns_event_ns = 0;
+    sim_irq_after(NS_DELAY_MS * 1000000ull, NS_IRQ_LINE, ns_notify, NULL);
+    while (ns_event_ns == 0) {
+      ns_loop();
+    }
+    /* The pass that slept through the interrupt has returned */
+    uint64_t late = sim_now_ns() - SIM_CPU_LOOP_NS - ns_event_ns;
+    late_max = late > late_max ? late : late_max;
+    ns_run_for(30);
+  }
+  struct netsched_stats st;
+  netsched_get_stats(&st);
+  ns_row("notify", t0, &st, late_max);
+
+  BOARD_CHECK(st.notified == NS_ROUNDS);
+  BOARD_CHECK(late_max < 100000u);
+  return 0;
+}
+
+static int ns_timer(void *arg)
+{
+  (void)arg;
+  BOARD_CHECK(ns_setup() == 0);
+  uint64_t t0 = sim_now_ns();
+  uint64_t late_max = 0;
+  for (int i = 0; i < NS_ROUNDS; i++) {
+    ns_event_ns = 0;
+    /* sys_now() has millisecond resolution: due at the tick NS_DELAY_MS on */
+    ns_due_ns = ((uint64_t)sys_now() + NS_DELAY_MS) * 1000000u;
+    sys_timeout(NS_DELAY_MS, ns_timeout, NULL);
+    while (ns_event_ns == 0) {
+      ns_loop();
+    }
+    uint64_t late = ns_event_ns - ns_due_ns;
+    late_max = late > late_max ? late : late_max;
+    ns_run_for(30);
+  }
+  struct netsched_stats st;
+  netsched_get_stats(&st);
+  ns_row("timer", t0, &st, late_max);
+
+  BOARD_CHECK(st.notified == 0);
+  BOARD_CHECK(late_max < 1000000u);
+  return 0;
+}
+
+static int ns_busy(void *arg)
+{
+  (void)arg;
+  BOARD_CHECK(ns_setup() == 0);
+  uint8_t f[200];
+  memset(f, 0, sizeof(f));
+  memcpy(f, ns_if.netif.hwaddr, 6);
+  f[6] = 0x02;
+  f[12] = 0x88;
+  f[13] = 0xB5;
+  for (int i = 0; i < 40; i++) {
+    BOARD_CHECK(w5500_sim_receive(&ns_if.chip, f, sizeof(f)));
+  }
+
+  uint64_t t0 = sim_now_ns();
+  while (w5500_sim_rx_pending(&ns_if.chip) > 0) {
+    ns_loop();
+  }
+  struct netsched_stats st;
+  netsched_get_stats(&st);
+  ns_row("busy", t0, &st, 0);
+
+  /* One sleep, the one that ends with the backlog already there at most */
+  BOARD_CHECK(st.sleeps <= 1);
+  BOARD_CHECK(st.loops >= 40 / ETHIF_RX_POLL_MAX_FRAMES && st.loops <= 40 / ETHIF_RX_POLL_MAX_FRAMES + 2);
+  return 0;
+}
+
+int main(void)
+{
+  int failed = 0;
+  printf("scenario,ms,loops,sleeps,notified,sleep_pct,late_max_us\n");
+  failed |= board_scenario("idle", ns_idle, NULL);
+  failed |= board_scenario("notify", ns_notified, NULL);
+  failed |= board_scenario("timer", ns_timer, NULL);
+  failed |= board_scenario("busy", ns_busy, NULL);
+  return failed;
+}
@@ -0,0 +1,297 @@
+/**
+ * @file
+ * @brief Throughput, latency, connections and RAM of the lwIP configuration
+ *        profiles (LWIP_PROFILE in lwipopts.h).
+ *
+ * Built once per profile. The traffic mix, each part on a fresh board:
+ *
+ * - download: the router reads 128 KB from a source server on the board
+ * - upload: the router writes 128 KB to a discard server on the board
+ * - latency: 64 byte echo every 10 ms for 1 s, idle and during a download
+ * - connections: 8 peers open an echo connection each and send one byte;
+ *   conns counts the ones echoed within 1 s
+ * - oversize frame: the router sends a 1514-byte UDP frame and a short
+ *   one; a profile whose PBUF_POOL_BUFSIZE cannot hold the first must
+ *   count it as rx_oversize (not rx_nomem) and still receive the second
+ *
+ *     profile,metric,value
+ *
+ * with the metrics download_kbps, upload_kbps, rtt_p50_us,
+ * loaded_rtt_p50_us, loaded_rtt_p99_us, conns, rx_oversize and static_ram,
+ * which is footprint_static_bytes(): lwIP pools and heap.
+ */
+
+#include <string.h>
+
+#include "lwip/tcp.h"
+#include "lwip/prot/ethernet.h"
+#include "lwip/prot/ip.h"
+#include "lwip/prot/ip4.h"
+#include "lwip/prot/udp.h"
+#include "footprint.h"
+
+#include "board.h"
+
+#define PROF_BYTES (128u * 1024u)
+#define PROF_SOURCE_PORT 19
+#define PROF_DISCARD_PORT 9
+#define PROF_ECHO_PORT 7
+#define PROF_UDP_PORT 5000
+#define PROF_PEERS 8
+
+static const char *const prof_names[] = {"default", "bulk_throughput", "low_latency", "min_ram"};
+
+static struct board_if prof_if;
+static struct peer prof_router;
+static uint8_t prof_data[TCP_MSS];
+
+/* Source server: sends PROF_BYTES to each client, then closes */
+
+static void prof_source_fill(struct tcp_pcb *pcb, uint32_t *left)
+{
+  while (*left > 0) {
+    u16_t n = tcp_sndbuf(pcb);
+    if (n > *left) n = (u16_t)*left;
+    if (n > sizeof(prof_data)) n = sizeof(prof_data);
+    if (n == 0 || tcp_sndqueuelen(pcb) >= TCP_SND_QUEUELEN ||
+        tcp_write(pcb, prof_data, n, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+      break;
+    }
+    *left -= n;
+  }
+  tcp_output(pcb);
+  if (*left == 0) {
+    tcp_arg(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_close(pcb);
+  }
+}
+
+static err_t prof_source_sent(void *arg, struct tcp_pcb *pcb, u16_t len)
+{
+  (void)len;
+  if (arg != NULL) {
+    prof_source_fill(pcb, (uint32_t *)arg);
+  }
+  return ERR_OK;
+}
+
+static err_t prof_source_accept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+  static uint32_t left;
+  (void)arg;
+  if (err != ERR_OK || pcb == NULL) {
+    return ERR_VAL;
+  }
+  left = PROF_BYTES;
+  tcp_arg(pcb, &left);
+  tcp_sent(pcb, prof_source_sent);
+  prof_source_fill(pcb, &left);
+  return ERR_OK;
+}
+
+/* Discard server */
+
+static err_t prof_discard_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+  (void)arg;
+  (void)err;
+  if (p == NULL) {
+    tcp_close(pcb);
+    return ERR_OK;
+  }
+  tcp_recved(pcb, p->tot_len);
+  pbuf_free(p);
+  return ERR_OK;
+}
+
+static err_t prof_discard_accept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+  (void)arg;
+  if (err != ERR_OK || pcb == NULL) {
+    return ERR_VAL;
+  }
+  tcp_recv(pcb, prof_discard_recv);
+  return ERR_OK;
+}
+
+static bool prof_listen(uint16_t port, tcp_accept_fn accept)
+{
+  struct tcp_pcb *pcb = tcp_new();
+  if (pcb == NULL || tcp_bind(pcb, IP_ADDR_ANY, port) != ERR_OK) {
+    return false;
+  }
+  pcb = tcp_listen(pcb);
+  if (pcb == NULL) {
+    return false;
+  }
+  tcp_accept(pcb, accept);
+  return true;
+}
+
+static int prof_board(void)
+{
+  board_init();
+  board_router(&prof_router);
+  board_if_power(&prof_if, 1);
+  BOARD_CHECK(board_if_up(&prof_if, BOARD_STATIC, NULL));
+  BOARD_CHECK(board_wait_addr(5000));
+  BOARD_CHECK(board_echo_start(PROF_ECHO_PORT));
+  BOARD_CHECK(prof_listen(PROF_SOURCE_PORT, prof_source_accept));
+  BOARD_CHECK(prof_listen(PROF_DISCARD_PORT, prof_discard_accept));
+  return 0;
+}
+
+static bool prof_download_done(void *arg)
+{
+  struct peer_conn *c = (struct peer_conn *)arg;
+  return c->remote_closed;
+}
+
+static bool prof_upload_done(void *arg)
+{
+  struct peer_conn *c = (struct peer_conn *)arg;
+  return c->state == PEER_TCP_ESTABLISHED && c->tx_len == 0;
+}
+
+static const char *prof_name(void)
+{
+  return prof_names[LWIP_PROFILE];
+}
+
+static int prof_download(void *arg)
+{
+  static struct peer_conn c;
+  (void)arg;
+  BOARD_CHECK(prof_board() == 0);
+  memset(&c, 0, sizeof(c));
+  peer_connect(&prof_router, &c, BOARD_STATIC, PROF_SOURCE_PORT);
+  uint64_t t0 = sim_now_ns();
+  BOARD_CHECK(board_run(prof_download_done, &c, 60000));
+  BOARD_CHECK(c.rx_bytes == PROF_BYTES);
+  printf("%s,download_kbps,%.0f\n", prof_name(), (double)PROF_BYTES * 8 / ((double)(sim_now_ns() - t0) / 1e6));
+  return 0;
+}
+
+static int prof_upload(void *arg)
+{
+  static struct peer_conn c;
+  static uint8_t data[PROF_BYTES];
+  (void)arg;
+  BOARD_CHECK(prof_board() == 0);
+  memset(&c, 0, sizeof(c));
+  peer_connect(&prof_router, &c, BOARD_STATIC, PROF_DISCARD_PORT);
+  uint64_t t0 = sim_now_ns();
+  peer_write(&c, data, sizeof(data));
+  BOARD_CHECK(board_run(prof_upload_done, &c, 60000));
+  printf("%s,upload_kbps,%.0f\n", prof_name(), (double)PROF_BYTES * 8 / ((double)(sim_now_ns() - t0) / 1e6));
+  return 0;
+}
+
+static int prof_latency(void *arg)
+{
+  static struct board_probe probe;
+  static struct peer_conn c;
+  (void)arg;
+  BOARD_CHECK(prof_board() == 0);
+
+  board_probe_start(&probe, &prof_router, BOARD_STATIC, PROF_ECHO_PORT, 64, 10);
+  board_run_for(1000);
+  board_probe_stop(&probe);
+  BOARD_CHECK(probe.count > 0 && probe.skipped == 0);
+  printf("%s,rtt_p50_us,%lu\n", prof_name(), (unsigned long)board_probe_pct(&probe, 50));
+
+  /* Free the probe's connection for MIN_RAM's two PCBs */
+  peer_close(&probe.conn);
+  board_run_for(500);
+  memset(&c, 0, sizeof(c));
+  peer_connect(&prof_router, &c, BOARD_STATIC, PROF_SOURCE_PORT);
+  board_probe_start(&probe, &prof_router, BOARD_STATIC, PROF_ECHO_PORT, 64, 10);
+  board_run_for(1000);
+  board_probe_stop(&probe);
+  BOARD_CHECK(probe.count > 0);
+  printf("%s,loaded_rtt_p50_us,%lu\n", prof_name(), (unsigned long)board_probe_pct(&probe, 50));
+  printf("%s,loaded_rtt_p99_us,%lu\n", prof_name(), (unsigned long)board_probe_pct(&probe, 99));
+  return 0;
+}
+
+static int prof_conns(void *arg)
+{
+  static struct peer peers[PROF_PEERS];
+  static struct board_probe probes[PROF_PEERS];
+  (void)arg;
+  BOARD_CHECK(prof_board() == 0);
+  for (int i = 0; i < PROF_PEERS; i++) {
+    uint8_t mac[6] = {0x02, 0x00, 0x00, 0x00, 0x03, (uint8_t)i};
+    peer_init(&peers[i], mac, PEER_IP(192, 168, 50, 200 + i), BOARD_NETMASK);
+    board_probe_start(&probes[i], &peers[i], BOARD_STATIC, PROF_ECHO_PORT, 1, 1000);
+  }
+  board_run_for(1500);
+  uint32_t conns = 0;
+  for (int i = 0; i < PROF_PEERS; i++) {
+    board_probe_stop(&probes[i]);
+    conns += probes[i].count > 0;
+  }
+  printf("%s,conns,%lu\n", prof_name(), (unsigned long)conns);
+  BOARD_CHECK(conns == (MEMP_NUM_TCP_PCB < PROF_PEERS ? MEMP_NUM_TCP_PCB : PROF_PEERS));
+  return 0;
+}
+
+static netif_input_fn prof_input;
+static uint32_t prof_datagrams;
+
+/**
+ * @brief Counts the datagrams to PROF_UDP_PORT that the driver hands lwIP.
+ */
+static err_t prof_count_input(struct pbuf *p, struct netif *netif)
+{
+  const uint8_t *f = (const uint8_t *)p->payload;
+  if (p->len >= SIZEOF_ETH_HDR + IP_HLEN + UDP_HLEN && f[12] == 0x08 && f[13] == 0x00 && f[23] == IP_PROTO_UDP &&
+      ((f[36] << 8) | f[37]) == PROF_UDP_PORT) {
+    prof_datagrams++;
+  }
+  return prof_input(p, netif);
+}
+
+static int prof_oversize(void *arg)
+{
+  static uint8_t big[1472];
+  struct ethif_stats before, after;
+  (void)arg;
+  BOARD_CHECK(prof_board() == 0);
+  prof_input = prof_if.netif.input;
+  prof_if.netif.input = prof_count_input;
+  ethif_get_stats(&prof_if.netif, &before);
+  peer_send_udp(&prof_router, BOARD_STATIC, PROF_UDP_PORT, PROF_UDP_PORT, big, sizeof(big));
+  peer_send_udp(&prof_router, BOARD_STATIC, PROF_UDP_PORT, PROF_UDP_PORT, big, 64);
+  board_run_for(100);
+  ethif_get_stats(&prof_if.netif, &after);
+
+  uint32_t oversize = after.rx_oversize - before.rx_oversize;
+  printf("%s,rx_oversize,%lu\n", prof_name(), (unsigned long)oversize);
+  BOARD_CHECK(after.rx_nomem == before.rx_nomem);
+  BOARD_CHECK(oversize == (SIZEOF_ETH_HDR + IP_HLEN + UDP_HLEN + sizeof(big) > PBUF_POOL_BUFSIZE ? 1 : 0));
+  BOARD_CHECK(prof_datagrams == 2 - oversize);
+  return 0;
+}
+
+static int prof_ram(void *arg)
+{
+  (void)arg;
+  board_init();
+  printf("%s,static_ram,%lu\n", prof_name(), (unsigned long)footprint_static_bytes());
+  return 0;
+}
+
+int main(void)
+{
+  int failed = 0;
+  printf("profile,metric,value\n");
+  failed |= board_scenario("download", prof_download, NULL);
+  failed |= board_scenario("upload", prof_upload, NULL);
+  failed |= board_scenario("latency", prof_latency, NULL);
+  failed |= board_scenario("connections", prof_conns, NULL);
+  failed |= board_scenario("oversize frame", prof_oversize, NULL);
+  failed |= board_scenario("static RAM", prof_ram, NULL);
+  return failed;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file
+ * @brief TCP round trip latency under broadcast load, with and without
+ *        receive classification (ETHIF_RX_CLASSIFY).
+ *
+ * A peer sends a 64 byte message to the board's echo server every 5 ms
+ * while another port floods 512 byte broadcast UDP frames at a fixed rate.
+ * Built once per setting of ETHIF_RX_CLASSIFY; prints one row per rate:
+ *
+ *     classify,bcast_fps,probes,rtt_p50_us,rtt_p99_us,rtt_max_us,skipped,class_drops,chip_overflows
+ *
+ * skipped counts probe intervals that passed with the previous echo still
+ * outstanding, class_drops frames skipped by classification and
+ * chip_overflows frames the chip dropped with its RX buffer full. With
+ * classification, the echo p99 must stay below two probe intervals at every
+ * rate the chip absorbs without overflowing.
+ */
+
+#include <string.h>
+
+#include "board.h"
+
+#define RXC_SECONDS 2
+#define RXC_PROBE_MS 5
+#define RXC_BCAST_LEN 512
+
+static const uint32_t rxc_rates[] = {0, 500, 2000, 8000, 20000};
+
+static struct board_if rxc_if;
+static struct peer rxc_router;
+static struct net_port rxc_flooder;
+static struct board_probe rxc_probe;
+static uint8_t rxc_frame[RXC_BCAST_LEN];
+static uint64_t rxc_flood_ns;
+
+static void rxc_flooder_deliver(struct net_port *port, const uint8_t *frame, size_t len)
+{
+  (void)port;
+  (void)frame;
+  (void)len;
+}
+
+static void rxc_flood(void *arg)
+{
+  (void)arg;
+  net_send(&rxc_flooder, rxc_frame, sizeof(rxc_frame));
+  sim_after(rxc_flood_ns, rxc_flood, NULL);
+}
+
+/**
+ * @brief Broadcast IPv4/UDP frame to 192.168.50.255:9 from .2.
+ */
+static void rxc_build_frame(void)
+{
+  uint8_t *f = rxc_frame;
+  memset(f, 0, sizeof(rxc_frame));
+  memset(f, 0xff, 6);
+  static const uint8_t src[6] = {0x02, 0x00, 0x00, 0x00, 0x02, 0x01};
+  memcpy(f + 6, src, 6);
+  f[12] = 0x08;
+  f[14] = 0x45;
+  uint16_t ip_len = RXC_BCAST_LEN - 14;
+  f[16] = (uint8_t)(ip_len >> 8);
+  f[17] = (uint8_t)ip_len;
+  f[22] = 64;
+  f[23] = 17;
+  f[26] = 192; f[27] = 168; f[28] = 50; f[29] = 2;
+  f[30] = 192; f[31] = 168; f[32] = 50; f[33] = 255;
+  f[34] = 0x30; f[35] = 0x39;
+  f[37] = 9;
+  uint16_t udp_len = ip_len - 20;
+  f[38] = (uint8_t)(udp_len >> 8);
+  f[39] = (uint8_t)udp_len;
+}
+
+static int rxc_run(void *arg)
+{
+  uint32_t fps = *(const uint32_t *)arg;
+
+  board_init();
+  board_router(&rxc_router);
+  board_if_power(&rxc_if, 1);
+  BOARD_CHECK(board_if_up(&rxc_if, BOARD_STATIC, NULL));
+  BOARD_CHECK(board_wait_addr(5000));
+  BOARD_CHECK(board_echo_start(7));
+
+  rxc_flooder.deliver = rxc_flooder_deliver;
+  net_attach(&rxc_flooder);
+  rxc_build_frame();
+  if (fps != 0) {
+    rxc_flood_ns = 1000000000u / fps;
+    sim_after(rxc_flood_ns, rxc_flood, NULL);
+  }
+
+  board_probe_start(&rxc_probe, &rxc_router, BOARD_STATIC, 7, 64, RXC_PROBE_MS);
+  board_run_for(RXC_SECONDS * 1000);
+  board_probe_stop(&rxc_probe);
+  sim_cancel(rxc_flood, NULL);
+
+  BOARD_CHECK(rxc_probe.count > 0);
+  uint32_t p50 = board_probe_pct(&rxc_probe, 50);
+  uint32_t p99 = board_probe_pct(&rxc_probe, 99);
+  uint32_t max = board_probe_pct(&rxc_probe, 100);
+  printf("%d,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n", ETHIF_RX_CLASSIFY, (unsigned long)fps,
+         (unsigned long)rxc_probe.count, (unsigned long)p50, (unsigned long)p99, (unsigned long)max,
+         (unsigned long)rxc_probe.skipped, (unsigned long)rxc_if.ethif.stats.rx_class_drops,
+         (unsigned long)rxc_if.chip.st.rx_overflows);
+
+  /* Without load every echo returns within one probe interval */
+  if (fps == 0) {
+    BOARD_CHECK(rxc_probe.skipped == 0 && max < RXC_PROBE_MS * 1000u);
+  }
+#if ETHIF_RX_CLASSIFY
+  /* While the chip keeps up, broadcasts over budget are skipped and the
+     echoes stay within two probe intervals */
+  if (fps != 0 && rxc_if.chip.st.rx_overflows == 0) {
+    BOARD_CHECK(p99 < 2 * RXC_PROBE_MS * 1000u);
+  }
+#endif
+  return 0;
+}
+
+int main(void)
+{
+  int failed = 0;
+  printf("classify,bcast_fps,probes,rtt_p50_us,rtt_p99_us,rtt_max_us,skipped,class_drops,chip_overflows\n");
+  for (size_t i = 0; i < sizeof(rxc_rates) / sizeof(rxc_rates[0]); i++) {
+    char name[48];
+    snprintf(name, sizeof(name), "classify %d, %lu broadcasts/s", ETHIF_RX_CLASSIFY,
+             (unsigned long)rxc_rates[i]);
+    failed |= board_scenario(name, rxc_run, (void *)&rxc_rates[i]);
+  }
+  return failed;
+}
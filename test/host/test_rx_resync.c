@@ -0,0 +1,184 @@
+/**
+ * @file
+ * @brief RX ring resynchronization after a desync, and its reset fallback.
+ *
+ * Frames arrive every millisecond; then one of them is corrupted in the
+ * chip's RX ring:
+ *
+ * - header length: its MACRAW length header is implausible;
+ * - RX pointers: Sn_RX_RD no longer agrees with Sn_RX_RSR and Sn_RX_WR;
+ * - reopen fails: as header length, with socket 0 wedged (its commands
+ *   never complete) until the chip is reset.
+ *
+ * The first two must be recovered by re-opening socket 0 alone: no chip
+ * reset, no link loss, only the frames pending at the resync lost. In the
+ * third, the resync keeps failing and the chip may be reset no earlier than
+ * ETHIF_RESET_MIN_INTERVAL_MS after the last reset (the cold init here),
+ * and then only once. Prints one row per scenario:
+ *
+ *     scenario,resyncs,resync_fails,cold_inits,chip_resets,socket_opens,resync_max_us,outage_ms,frames_lost,link_downs
+ *
+ * chip_resets and socket_opens count MR_RST writes and socket OPEN
+ * commands seen by the chip after the interface came up, resync_max_us is
+ * the driver's own longest resync, outage_ms the longest gap between two
+ * delivered frames.
+ */
+
+#include <string.h>
+
+#include "lwip/pbuf.h"
+#include "netif/ethernet.h"
+
+#include "board.h"
+
+#define RS_FRAME_SIZE 100
+#define RS_ETHERTYPE 0x88B5
+#define RS_FRAMES_MAX 40000
+#define RS_SN_RX_RD 0x28    /**< Sn_RX_RD in w5500_sim.sock */
+
+enum rs_scenario { RS_HEADER, RS_POINTERS, RS_REOPEN_FAILS };
+static const char *const rs_names[] = {"header length", "RX pointers", "reopen fails"};
+
+static struct board_if rs_if;
+static uint32_t rs_seq;
+static bool rs_seen[RS_FRAMES_MAX];
+static int rs_corrupt = -1;          /**< Scenario to apply to the next frame, -1 for none */
+static uint64_t rs_last_ns;          /**< Time the last frame was delivered */
+static uint64_t rs_outage_ns;        /**< Longest gap between two delivered frames */
+
+static void rs_fill(uint8_t *f, uint32_t seq)
+{
+  static const uint8_t src[6] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x01};
+  memcpy(f, rs_if.netif.hwaddr, 6);
+  memcpy(f + 6, src, 6);
+  f[12] = RS_ETHERTYPE >> 8;
+  f[13] = RS_ETHERTYPE & 0xff;
+  memcpy(f + 14, &seq, sizeof(seq));
+  memset(f + 18, (int)(seq & 0xff), RS_FRAME_SIZE - 18);
+}
+
+static void rs_send(void *arg)
+{
+  (void)arg;
+  uint8_t f[RS_FRAME_SIZE];
+  struct w5500_sim *chip = &rs_if.chip;
+  uint16_t at = chip->rx_wr;
+  if (rs_seq < RS_FRAMES_MAX) {
+    rs_fill(f, rs_seq++);
+    w5500_sim_receive(chip, f, sizeof(f));
+  }
+  if (rs_corrupt == RS_HEADER || rs_corrupt == RS_REOPEN_FAILS) {
+    /* A length below an Ethernet header */
+    chip->rx[at & (W5500_SIM_BUF_SIZE - 1)] = 0;
+    chip->rx[(uint16_t)(at + 1) & (W5500_SIM_BUF_SIZE - 1)] = 4;
+    chip->sock_stuck = rs_corrupt == RS_REOPEN_FAILS;
+  } else if (rs_corrupt == RS_POINTERS) {
+    /* Sn_RX_RD moved past the frame: fewer bytes used than Sn_RX_RSR */
+    uint16_t rd = (uint16_t)((chip->sock[RS_SN_RX_RD] << 8 | chip->sock[RS_SN_RX_RD + 1]) + 0x100);
+    chip->sock[RS_SN_RX_RD] = (uint8_t)(rd >> 8);
+    chip->sock[RS_SN_RX_RD + 1] = (uint8_t)rd;
+  }
+  rs_corrupt = -1;
+  sim_after(1000000u, rs_send, NULL);
+}
+
+/**
+ * @brief netif input: notes the numbered frames, passes the rest to lwIP.
+ */
+static err_t rs_input(struct pbuf *p, struct netif *netif)
+{
+  uint8_t f[RS_FRAME_SIZE], want[RS_FRAME_SIZE];
+  uint32_t seq;
+  if (p->tot_len != RS_FRAME_SIZE || pbuf_copy_partial(p, f, RS_FRAME_SIZE, 0) != RS_FRAME_SIZE ||
+      f[12] != (RS_ETHERTYPE >> 8) || f[13] != (RS_ETHERTYPE & 0xff)) {
+    return ethernet_input(p, netif);
+  }
+  memcpy(&seq, f + 14, sizeof(seq));
+  rs_fill(want, seq);
+  if (seq < RS_FRAMES_MAX && memcmp(f, want, RS_FRAME_SIZE) == 0) {
+    rs_seen[seq] = true;
+    if (rs_last_ns && sim_now_ns() - rs_last_ns > rs_outage_ns) {
+      rs_outage_ns = sim_now_ns() - rs_last_ns;
+    }
+    rs_last_ns = sim_now_ns();
+  }
+  pbuf_free(p);
+  return ERR_OK;
+}
+
+static bool rs_link_up(void *arg)
+{
+  (void)arg;
+  return netif_is_link_up(&rs_if.netif);
+}
+
+static int rs_run(void *arg)
+{
+  enum rs_scenario sc = (enum rs_scenario)(uintptr_t)arg;
+
+  board_init();
+  board_if_power(&rs_if, 1);
+  BOARD_CHECK(board_if_up(&rs_if, BOARD_STATIC, rs_input));
+  uint64_t init_ns = sim_now_ns();
+  BOARD_CHECK(board_run(rs_link_up, NULL, 5000));
+  const struct ethif_stats *st = &rs_if.ethif.stats;
+  BOARD_CHECK(st->cold_inits == 1);
+
+  sim_after(1000000u, rs_send, NULL);
+  board_run_for(200);
+  struct w5500_sim_stats chip0 = rs_if.chip.st;
+  uint32_t links = st->link_down;
+  uint32_t first = rs_seq;
+
+  rs_corrupt = sc;
+  uint64_t reset_ns = 0;
+  uint32_t run_ms = sc == RS_REOPEN_FAILS ? ETHIF_RESET_MIN_INTERVAL_MS + 5000 : 1000;
+  uint64_t end = sim_now_ns() + (uint64_t)run_ms * 1000000u;
+  while (sim_now_ns() < end) {
+    board_poll();
+    if (!reset_ns && rs_if.chip.st.resets != chip0.resets) {
+      reset_ns = sim_now_ns();
+    }
+  }
+  sim_cancel(rs_send, NULL);
+  board_run_for(10);
+
+  uint32_t lost = 0;
+  for (uint32_t i = first; i < rs_seq; i++) {
+    lost += !rs_seen[i];
+  }
+  uint64_t resets = rs_if.chip.st.resets - chip0.resets;
+  uint64_t opens = rs_if.chip.st.sock_opens - chip0.sock_opens;
+  printf("%s,%lu,%lu,%lu,%lu,%lu,%lu,%.1f,%lu,%lu\n", rs_names[sc], (unsigned long)st->rx_resyncs,
+         (unsigned long)st->rx_resync_fails, (unsigned long)st->cold_inits, (unsigned long)resets,
+         (unsigned long)opens, (unsigned long)st->rx_resync_max_us, (double)rs_outage_ns / 1e6,
+         (unsigned long)lost, (unsigned long)(st->link_down - links));
+
+  /* Frames flow again at the end */
+  BOARD_CHECK(rs_seen[rs_seq - 1] && rs_seen[rs_seq - 2]);
+  if (sc != RS_REOPEN_FAILS) {
+    /* Socket 0 alone was re-opened: no reset, the link never dropped */
+    BOARD_CHECK(st->rx_resyncs == 1 && st->rx_resync_fails == 0);
+    BOARD_CHECK(st->cold_inits == 1 && resets == 0 && opens == 1);
+    BOARD_CHECK(st->link_down == links && netif_is_link_up(&rs_if.netif));
+    BOARD_CHECK(lost <= 2 && rs_outage_ns < 5000000u);
+  } else {
+    /* Failed resyncs retry, but the chip is reset once, and only once the
+       interval since the cold init has passed */
+    BOARD_CHECK(st->rx_resync_fails > 1 && st->rx_resyncs == st->rx_resync_fails);
+    BOARD_CHECK(st->cold_inits == 2 && resets == 1 && reset_ns != 0);
+    BOARD_CHECK(reset_ns - init_ns >= (uint64_t)ETHIF_RESET_MIN_INTERVAL_MS * 1000000u);
+    BOARD_CHECK(reset_ns - init_ns < (uint64_t)(ETHIF_RESET_MIN_INTERVAL_MS + 100) * 1000000u);
+  }
+  return 0;
+}
+
+int main(void)
+{
+  int failed = 0;
+  printf("scenario,resyncs,resync_fails,cold_inits,chip_resets,socket_opens,resync_max_us,outage_ms,frames_lost,link_downs\n");
+  for (int sc = RS_HEADER; sc <= RS_REOPEN_FAILS; sc++) {
+    failed |= board_scenario(rs_names[sc], rs_run, (void *)(uintptr_t)sc);
+  }
+  return failed;
+}
@@ -0,0 +1,259 @@
+/**
+ * @file
+ * @brief Sharing the SPI bus with another device (ETHIF_SPI_CHUNK).
+ *
+ * While the driver receives or transmits frames, the interrupt handler of a
+ * second device on the bus (an ADC data-ready line, say) fires every 100 to
+ * 150 us. Its line is masked from begin() to end(), as SPI.usingInterrupt()
+ * arranges on the target, so it waits for the current W5500 cycle and must
+ * never find a chip selected. An unrelated timer interrupt fires every
+ * 37 us and must never be delayed by the driver unless ETHIF_SPI_PROTECT
+ * masks all interrupts. Built once with the default chunk size, once with
+ * ETHIF_SPI_CHUNK 0 (one cycle per buffer transfer), once with
+ * ETHIF_SPI_PROTECT 1 and once with ETHIF_SPI_HOLD_TIMING, where the
+ * driver's own spi_hold_max_cycles must match the model. Prints one row per direction and frame size:
+ *
+ *     chunk,protect,dir,size,frames,cs_cycles,spi_bytes,target_ns,hold_max_us,irq_off_max_us,bus_wait_p99_us,bus_wait_max_us,timer_late_max_us
+ *
+ * cs_cycles, spi_bytes and target_ns are per frame. hold_max_us is the
+ * longest chip-select cycle, irq_off_max_us the longest sys_arch_protect()
+ * section, bus_wait the time the other device's handler was held off and
+ * timer_late_max_us the longest delay of the timer handler. With a chunk
+ * size, the first three must stay within one chunk transaction whatever
+ * the frame size, and without ETHIF_SPI_PROTECT the timer is never late;
+ * every frame must still arrive intact.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lwip/pbuf.h"
+
+#include "board.h"
+
+#define SA_FRAMES 256
+#define SA_WAITS_MAX 16384
+
+static const uint16_t sa_sizes[] = {60, 512, 1514};
+
+struct sa_case {
+  bool tx;
+  uint16_t size;
+};
+
+static struct board_if sa_if;
+static uint8_t sa_frame[1514];
+static uint32_t sa_rx_count;
+static uint32_t sa_tx_count;
+static uint32_t sa_bad;
+
+#define SA_DEVICE_LINE 4  /**< Interrupt line of the other bus device */
+#define SA_TIMER_LINE 5   /**< Interrupt line of the unrelated timer */
+#define SA_TIMER_NS 37000u
+
+static uint32_t sa_seed = 12345;
+static bool sa_running;
+static uint64_t sa_device_due;
+static uint32_t sa_waits[SA_WAITS_MAX];
+static size_t sa_wait_count;
+static uint32_t sa_collisions;
+static uint64_t sa_timer_due;
+static uint64_t sa_timer_late_max;
+
+static void sa_fill(uint8_t *f, uint16_t size, uint32_t seq)
+{
+  memset(f, 0, size);
+  memcpy(f, sa_if.netif.hwaddr, 6);
+  static const uint8_t src[6] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x01};
+  memcpy(f + 6, src, 6);
+  f[12] = 0x08;
+  f[13] = 0x00;
+  f[14] = 0x45;
+  f[23] = 17;
+  for (uint16_t i = 34; i < size; i++) {
+    f[i] = (uint8_t)(seq * 31 + i);
+  }
+}
+
+static err_t sa_input(struct pbuf *p, struct netif *netif)
+{
+  (void)netif;
+  static uint8_t got[1514];
+  sa_fill(sa_frame, p->tot_len, sa_rx_count++);
+  sa_bad += pbuf_copy_partial(p, got, p->tot_len, 0) != p->tot_len || memcmp(got, sa_frame, p->tot_len) != 0;
+  pbuf_free(p);
+  return ERR_OK;
+}
+
+static void sa_wire(struct w5500_sim *chip, const uint8_t *frame, size_t len, void *arg)
+{
+  (void)chip;
+  (void)arg;
+  uint8_t want[1514];
+  sa_fill(want, (uint16_t)len, sa_tx_count++);
+  sa_bad += memcmp(frame, want, len) != 0;
+}
+static void sa_device(void *arg);
+static void sa_timer(void *arg);
+
+static void sa_device_schedule(void)
+{
+  sa_seed = sa_seed * 1103515245u + 12345u;
+  uint64_t delay = 100000u + (sa_seed >> 16) % 50000u;
+  sa_device_due = sim_now_ns() + delay;
+  sim_irq_after(delay, SA_DEVICE_LINE, sa_device, NULL);
+}
+
+/**
+ * @brief Interrupt handler of the other device: uses the bus at once.
+ */
+static void sa_device(void *arg)
+{
+  (void)arg;
+  if (!sa_running) {
+    return;
+  }
+  sa_collisions += sa_if.chip.selected;
+  if (sa_wait_count < SA_WAITS_MAX) {
+    sa_waits[sa_wait_count++] = (uint32_t)((sim_now_ns() - sa_device_due) / 1000u);
+  }
+  sa_device_schedule();
+}
+
+/**
+ * @brief Unrelated timer interrupt: only notes how late it runs.
+ */
+static void sa_timer(void *arg)
+{
+  (void)arg;
+  if (!sa_running) {
+    return;
+  }
+  if (sim_now_ns() - sa_timer_due > sa_timer_late_max) {
+    sa_timer_late_max = sim_now_ns() - sa_timer_due;
+  }
+  /* A free-running timer: ticks missed while masked collapse into one */
+  uint64_t now = sim_now_ns();
+  while (sa_timer_due <= now) {
+    sa_timer_due += SA_TIMER_NS;
+  }
+  sim_irq_after(sa_timer_due - now, SA_TIMER_LINE, sa_timer, NULL);
+}
+
+static int sa_cmp(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  return x < y ? -1 : x > y;
+}
+
+static bool sa_link_up(void *arg)
+{
+  (void)arg;
+  return netif_is_link_up(&sa_if.netif);
+}
+
+static int sa_run(void *arg)
+{
+  const struct sa_case *sc = (const struct sa_case *)arg;
+
+  board_init();
+  board_if_power(&sa_if, 1);
+  BOARD_CHECK(board_if_up(&sa_if, BOARD_STATIC, sa_input));
+  BOARD_CHECK(board_run(sa_link_up, NULL, 5000));
+  sa_if.chip.tx_hook = sa_wire;
+  sa_if.chip.irq_mask = 1u << SA_DEVICE_LINE;
+
+  struct w5500_sim_stats before = sa_if.chip.st;
+  sa_if.chip.st.hold_max_ns = 0;
+  sa_if.ethif.stats.spi_hold_max_cycles = 0;
+  sys_arch_irq_off_reset();
+  sa_tx_count = 0;
+  sa_running = true;
+  sa_device_schedule();
+  sa_timer_due = sim_now_ns() + SA_TIMER_NS;
+  sim_irq_after(SA_TIMER_NS, SA_TIMER_LINE, sa_timer, NULL);
+  uint64_t t0 = sim_now_ns();
+
+  for (uint32_t i = 0; i < SA_FRAMES; i++) {
+    if (sc->tx) {
+      sa_fill(sa_frame, sc->size, i);
+      struct pbuf *p = pbuf_alloc(PBUF_RAW, sc->size, PBUF_RAM);
+      BOARD_CHECK(p != NULL);
+      pbuf_take(p, sa_frame, sc->size);
+      sa_if.netif.linkoutput(&sa_if.netif, p);
+      pbuf_free(p);
+    } else {
+      sa_fill(sa_frame, sc->size, i);
+      w5500_sim_receive(&sa_if.chip, sa_frame, sc->size);
+      while (w5500_sim_rx_pending(&sa_if.chip) != 0) {
+        ethif_poll(&sa_if.netif);
+      }
+    }
+  }
+  uint64_t target = sim_now_ns() - t0;
+  sa_running = false;
+  sim_cancel(sa_device, NULL);
+  sim_cancel(sa_timer, NULL);
+
+  const struct w5500_sim_stats *st = &sa_if.chip.st;
+  BOARD_CHECK(sa_bad == 0);
+  BOARD_CHECK(sc->tx ? sa_tx_count == SA_FRAMES : sa_rx_count == SA_FRAMES);
+  BOARD_CHECK(sa_wait_count > 0);
+  BOARD_CHECK(sa_collisions == 0);
+  qsort(sa_waits, sa_wait_count, sizeof(sa_waits[0]), sa_cmp);
+  uint32_t p99 = sa_waits[sa_wait_count * 99 / 100];
+  uint32_t wait_max = sa_waits[sa_wait_count - 1];
+  uint64_t irq_off = sim_irq_off_max_ns();
+
+  printf("%u,%u,%s,%u,%u,%.2f,%.1f,%.0f,%.1f,%.1f,%lu,%lu,%.1f\n", ETHIF_SPI_CHUNK, ETHIF_SPI_PROTECT, sc->tx ? "tx" : "rx", sc->size,
+         SA_FRAMES, (double)(st->cs_cycles - before.cs_cycles) / SA_FRAMES,
+         (double)(st->bytes - before.bytes) / SA_FRAMES, (double)target / SA_FRAMES,
+         (double)st->hold_max_ns / 1e3, (double)irq_off / 1e3, (unsigned long)p99, (unsigned long)wait_max,
+         (double)sa_timer_late_max / 1e3);
+
+#if ETHIF_SPI_HOLD_TIMING
+  /* The driver's own hold time agrees with the model, to a cycle */
+  uint64_t hold_cycles = st->hold_max_ns * (SIM_CPU_HZ / 1000000u) / 1000u;
+  BOARD_CHECK(sa_if.ethif.stats.spi_hold_max_cycles + 1 >= hold_cycles &&
+              sa_if.ethif.stats.spi_hold_max_cycles <= hold_cycles + 1);
+#else
+  BOARD_CHECK(sa_if.ethif.stats.spi_hold_max_cycles == 0);
+#endif
+
+  uint64_t byte_ns = 8000000000ull / sa_if.chip.spi_hz + sa_if.chip.byte_overhead_ns;
+  uint64_t cycle_ns = sa_if.chip.begin_ns + sa_if.chip.end_ns + byte_ns * 3;
+#if ETHIF_SPI_CHUNK > 0
+  uint64_t bound_ns = cycle_ns + byte_ns * ETHIF_SPI_CHUNK + 1000u;
+  BOARD_CHECK(st->hold_max_ns <= bound_ns);
+#if ETHIF_SPI_PROTECT
+  BOARD_CHECK(irq_off <= bound_ns);
+  BOARD_CHECK(sa_timer_late_max <= bound_ns);
+#endif
+  BOARD_CHECK(wait_max * 1000ull <= bound_ns);
+#else
+  /* One cycle moves the frame (less the header bytes the driver peeked on RX) */
+  BOARD_CHECK(sc->size < 512 || st->hold_max_ns >= cycle_ns + byte_ns * (sc->size - 64u));
+#endif
+#if !ETHIF_SPI_PROTECT
+  /* Bus ownership masks the device's line only: interrupts are never
+     disabled for a transaction and the timer always runs on time */
+  BOARD_CHECK(irq_off < cycle_ns);
+  BOARD_CHECK(sa_timer_late_max == 0);
+#endif
+  return 0;
+}
+
+int main(void)
+{
+  int failed = 0;
+  printf("chunk,protect,dir,size,frames,cs_cycles,spi_bytes,target_ns,hold_max_us,irq_off_max_us,bus_wait_p99_us,bus_wait_max_us,timer_late_max_us\n");
+  for (size_t s = 0; s < sizeof(sa_sizes) / sizeof(sa_sizes[0]); s++) {
+    for (int tx = 0; tx <= 1; tx++) {
+      struct sa_case sc = {tx != 0, sa_sizes[s]};
+      char name[32];
+      snprintf(name, sizeof(name), "%s %u", tx ? "tx" : "rx", sc.size);
+      failed |= board_scenario(name, sa_run, &sc);
+    }
+  }
+  return failed;
+}
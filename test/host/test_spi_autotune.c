@@ -0,0 +1,103 @@
+/**
+ * @file
+ * @brief SPI clock autotuning (ethif_spi_autotune()) against chips that
+ *        read back reliably up to different clocks.
+ *
+ * Tunes over the sketch's list (4, 8, 12, 16 and 24 MHz), then brings the
+ * interface up with DHCP at the selected clock. Each chip prints:
+ *
+ *     max_mhz,selected_mhz,tuned_index,tune_ms,tune_spi_bytes,corrupted_after
+ *
+ * max_mhz is the fastest clock the chip reads back reliably (0: no limit),
+ * tune_ms and tune_spi_bytes the simulated time and SPI bytes of the tuning
+ * run, and corrupted_after the bytes corrupted after tuning, which must be
+ * 0. The selected clock is ETHIF_SPI_AUTOTUNE_MARGIN steps below the
+ * fastest passing one, also when every clock in the list passes.
+ */
+
+#include <string.h>
+
+#include "board.h"
+
+static const uint32_t tune_speeds[] = {4000000, 8000000, 12000000, 16000000, 24000000};
+#define TUNE_COUNT (sizeof(tune_speeds) / sizeof(tune_speeds[0]))
+
+static struct board_if tune_if;
+static struct peer tune_router;
+
+/**
+ * @brief Expected index: the failing one (TUNE_COUNT if none fails) less
+ *        one, less the margin, and not below the slowest.
+ */
+static size_t tune_expected(uint32_t max_hz)
+{
+  size_t fail = 0;
+  while (fail < TUNE_COUNT && (max_hz == 0 || tune_speeds[fail] <= max_hz)) {
+    fail++;
+  }
+  return fail > ETHIF_SPI_AUTOTUNE_MARGIN + 1 ? fail - 1 - ETHIF_SPI_AUTOTUNE_MARGIN : 0;
+}
+
+static int tune_run(void *arg)
+{
+  uint32_t max_hz = (uint32_t)(uintptr_t)arg;
+
+  board_init();
+  board_router(&tune_router);
+  board_if_power(&tune_if, 1);
+  tune_if.ethif.set_clock = w5500_sim_set_clock;
+  tune_if.chip.max_hz = max_hz;
+
+  uint64_t t0 = sim_now_ns();
+  uint64_t bytes0 = tune_if.chip.st.bytes;
+  uint32_t hz = ethif_spi_autotune(&tune_if.ethif, tune_speeds, TUNE_COUNT);
+  uint64_t tune_ns = sim_now_ns() - t0;
+  uint64_t tune_bytes = tune_if.chip.st.bytes - bytes0;
+
+  size_t sel = tune_expected(max_hz);
+  BOARD_CHECK(hz == tune_speeds[sel]);
+  BOARD_CHECK(tune_if.ethif.spi_tuned_index == sel && tune_if.ethif.spi_speed_index == sel);
+  BOARD_CHECK(tune_if.chip.spi_hz == tune_speeds[sel]);
+
+  uint64_t corrupted = tune_if.chip.st.corrupted;
+  BOARD_CHECK(board_if_up(&tune_if, 0, NULL));
+  BOARD_CHECK(board_wait_addr(10000));
+  BOARD_CHECK(tune_if.chip.st.corrupted == corrupted);
+
+  printf("%lu,%lu,%u,%.2f,%lu,%lu\n", (unsigned long)(max_hz / 1000000), (unsigned long)(hz / 1000000),
+         (unsigned)sel, (double)tune_ns / 1e6, (unsigned long)tune_bytes,
+         (unsigned long)(tune_if.chip.st.corrupted - corrupted));
+  return 0;
+}
+
+static int tune_unreliable(void *arg)
+{
+  (void)arg;
+  board_init();
+  board_if_power(&tune_if, 1);
+  tune_if.ethif.set_clock = w5500_sim_set_clock;
+  tune_if.chip.max_hz = 2000000;
+
+  BOARD_CHECK(ethif_spi_autotune(&tune_if.ethif, tune_speeds, TUNE_COUNT) == 0);
+  BOARD_CHECK(tune_if.ethif.spi_hz == 0);
+  BOARD_CHECK(tune_if.chip.spi_hz == tune_speeds[0]);
+  return 0;
+}
+
+int main(void)
+{
+  int failed = 0;
+  static const uint32_t max_hz[] = {0, 24000000, 16000000, 12000000, 8000000, 5000000};
+  printf("max_mhz,selected_mhz,tuned_index,tune_ms,tune_spi_bytes,corrupted_after\n");
+  for (size_t i = 0; i < sizeof(max_hz) / sizeof(max_hz[0]); i++) {
+    char name[40];
+    if (max_hz[i] == 0) {
+      snprintf(name, sizeof(name), "autotune, reliable at any clock");
+    } else {
+      snprintf(name, sizeof(name), "autotune, reliable to %lu MHz", (unsigned long)(max_hz[i] / 1000000));
+    }
+    failed |= board_scenario(name, tune_run, (void *)(uintptr_t)max_hz[i]);
+  }
+  failed |= board_scenario("autotune, unreliable at the slowest clock", tune_unreliable, NULL);
+  return failed;
+}
@@ -0,0 +1,203 @@
+/**
+ * @file
+ * @brief Runtime SPI clock fallback and step-up under traffic.
+ *
+ * The clock is autotuned on a clean chip, then frames arrive every 2 ms
+ * while the chip starts corrupting MISO at the tuned clock (max_hz just
+ * below it), as a marginal bus would when it warms up. The driver must
+ * step the clock down and keep passing frames; once the fault clears it
+ * must raise the clock back to the tuned one, but not before
+ * ETHIF_SPI_STEP_UP_MS has passed since the step-down. Prints one row per
+ * phase:
+ *
+ *     phase,spi_mhz,spi_errors,fallbacks,step_ups,frames,frames_ok,frames_bad,frames_lost,class_drops,stall_ms
+ *
+ * frames_bad are frames passed up with a corrupted payload (SPI has no
+ * checksum), frames_lost those dropped, class_drops the part of them the
+ * receive classifier shed from a backlog, and stall_ms the longest main
+ * loop pass. Corruption may only occur around the step-down. The
+ * integrity checks of a step-up stall the loop for a few frame intervals,
+ * so frames lost then must all be classifier drops. The last second of
+ * every phase must be clean.
+ */
+
+#include <string.h>
+
+#include "lwip/pbuf.h"
+#include "netif/ethernet.h"
+
+#include "board.h"
+
+#define FB_FRAME_MS 2
+#define FB_FRAME_SIZE 200
+#define FB_ETHERTYPE 0x88B5
+#define FB_FRAMES_MAX 100000
+
+static const uint32_t fb_speeds[] = {4000000, 8000000, 12000000, 16000000, 24000000};
+#define FB_SPEED_COUNT (sizeof(fb_speeds) / sizeof(fb_speeds[0]))
+
+static struct board_if fb_if;
+static uint32_t fb_seq;
+static uint8_t fb_seen[FB_FRAMES_MAX];   /**< Per frame: 0 missing, 1 intact, 2 corrupted */
+static uint64_t fb_stall_ns;             /**< Longest main loop pass of the phase */
+
+static void fb_fill(uint8_t *f, uint32_t seq)
+{
+  static const uint8_t src[6] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x01};
+  memcpy(f, fb_if.netif.hwaddr, 6);
+  memcpy(f + 6, src, 6);
+  f[12] = FB_ETHERTYPE >> 8;
+  f[13] = FB_ETHERTYPE & 0xff;
+  memcpy(f + 14, &seq, sizeof(seq));
+  for (int i = 18; i < FB_FRAME_SIZE; i++) {
+    f[i] = (uint8_t)(seq * 7 + i);
+  }
+}
+
+static void fb_send(void *arg)
+{
+  (void)arg;
+  uint8_t f[FB_FRAME_SIZE];
+  if (fb_seq < FB_FRAMES_MAX) {
+    fb_fill(f, fb_seq++);
+    w5500_sim_receive(&fb_if.chip, f, sizeof(f));
+  }
+  sim_after(FB_FRAME_MS * 1000000ull, fb_send, NULL);
+}
+
+/**
+ * @brief netif input: checks the numbered frames, passes the rest to lwIP.
+ */
+static err_t fb_input(struct pbuf *p, struct netif *netif)
+{
+  uint8_t f[FB_FRAME_SIZE], want[FB_FRAME_SIZE];
+  uint32_t seq;
+  if (p->tot_len != FB_FRAME_SIZE || pbuf_copy_partial(p, f, FB_FRAME_SIZE, 0) != FB_FRAME_SIZE ||
+      f[12] != (FB_ETHERTYPE >> 8) || f[13] != (FB_ETHERTYPE & 0xff)) {
+    return ethernet_input(p, netif);
+  }
+  memcpy(&seq, f + 14, sizeof(seq));
+  if (seq < FB_FRAMES_MAX) {
+    fb_fill(want, seq);
+    fb_seen[seq] = memcmp(f, want, FB_FRAME_SIZE) == 0 ? 1 : 2;
+  }
+  pbuf_free(p);
+  return ERR_OK;
+}
+
+/**
+ * @brief Counts the frames sent since @p first: intact, corrupted and lost.
+ */
+static void fb_count(uint32_t first, uint32_t *ok, uint32_t *bad, uint32_t *lost)
+{
+  *ok = *bad = *lost = 0;
+  for (uint32_t i = first; i < fb_seq; i++) {
+    *ok += fb_seen[i] == 1;
+    *bad += fb_seen[i] == 2;
+    *lost += fb_seen[i] == 0;
+  }
+}
+
+/**
+ * @brief Runs the main loop for @p ms, noting when the clock last changed.
+ */
+static void fb_run(uint32_t ms, uint64_t *change_ns)
+{
+  uint64_t end = sim_now_ns() + (uint64_t)ms * 1000000u;
+  uint32_t hz = fb_if.ethif.spi_hz;
+  while (sim_now_ns() < end) {
+    uint64_t t0 = sim_now_ns();
+    board_poll();
+    if (sim_now_ns() - t0 > fb_stall_ns) {
+      fb_stall_ns = sim_now_ns() - t0;
+    }
+    if (fb_if.ethif.spi_hz != hz) {
+      hz = fb_if.ethif.spi_hz;
+      *change_ns = sim_now_ns();
+    }
+  }
+}
+
+/**
+ * @brief Runs one phase and checks that its last second was clean.
+ */
+static int fb_phase(const char *name, uint32_t ms, uint64_t *change_ns, uint32_t *lost_out)
+{
+  uint32_t first = fb_seq;
+  uint32_t drops = fb_if.ethif.stats.rx_class_drops;
+  fb_stall_ns = 0;
+  fb_run(ms, change_ns);
+  /* Frames still in the chip are read in the next main loop passes */
+  uint32_t sent = fb_seq;
+  fb_run(10, change_ns);
+
+  uint32_t ok, bad, lost, tail_ok, tail_bad, tail_lost;
+  fb_count(first, &ok, &bad, &lost);
+  const struct ethif_stats *st = &fb_if.ethif.stats;
+  drops = st->rx_class_drops - drops;
+  printf("%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%.2f\n", name, (unsigned long)(fb_if.ethif.spi_hz / 1000000),
+         (unsigned long)st->spi_errors, (unsigned long)st->spi_fallbacks, (unsigned long)st->spi_step_ups,
+         (unsigned long)(fb_seq - first), (unsigned long)ok, (unsigned long)bad, (unsigned long)lost,
+         (unsigned long)drops, (double)fb_stall_ns / 1e6);
+  *lost_out = lost - drops;
+
+  uint32_t tail = sent - 1000 / FB_FRAME_MS;
+  uint32_t saved = fb_seq;
+  fb_seq = sent;
+  fb_count(tail, &tail_ok, &tail_bad, &tail_lost);
+  fb_seq = saved;
+  BOARD_CHECK(tail_ok == sent - tail && tail_bad == 0 && tail_lost == 0);
+  return 0;
+}
+
+static int fb_run_scenario(void *arg)
+{
+  (void)arg;
+  board_init();
+  board_if_power(&fb_if, 1);
+  fb_if.ethif.set_clock = w5500_sim_set_clock;
+  fb_if.chip.max_hz = 0;
+  uint32_t top = ethif_spi_autotune(&fb_if.ethif, fb_speeds, FB_SPEED_COUNT);
+  size_t top_index = fb_if.ethif.spi_tuned_index;
+  BOARD_CHECK(top != 0 && top_index > 0);
+  BOARD_CHECK(board_if_up(&fb_if, BOARD_STATIC, fb_input));
+  BOARD_CHECK(board_wait_addr(5000));
+
+  uint64_t change_ns = 0;
+  uint32_t lost;
+  sim_after(FB_FRAME_MS * 1000000ull, fb_send, NULL);
+  BOARD_CHECK(fb_phase("clean", 2000, &change_ns, &lost) == 0);
+  BOARD_CHECK(fb_if.ethif.stats.spi_errors == 0 && change_ns == 0 && lost == 0);
+
+  /* The tuned clock starts corrupting: step down, keep passing frames */
+  fb_if.chip.max_hz = fb_speeds[top_index - 1];
+  BOARD_CHECK(fb_phase("fault", 3000, &change_ns, &lost) == 0);
+  BOARD_CHECK(fb_if.ethif.stats.spi_errors > 0 && fb_if.ethif.stats.spi_fallbacks > 0);
+  BOARD_CHECK(fb_if.ethif.spi_hz < top && fb_if.ethif.spi_hz <= fb_if.chip.max_hz);
+  uint64_t down_ns = change_ns;
+  BOARD_CHECK(down_ns != 0);
+
+  /* The fault clears: the clock stays down until ETHIF_SPI_STEP_UP_MS has
+     passed since the step-down, then climbs back to the tuned one */
+  fb_if.chip.max_hz = 0;
+  uint64_t elapsed_ms = (sim_now_ns() - down_ns) / 1000000u;
+  BOARD_CHECK(elapsed_ms < ETHIF_SPI_STEP_UP_MS);
+  BOARD_CHECK(fb_phase("cleared", (uint32_t)(ETHIF_SPI_STEP_UP_MS - elapsed_ms - ETHIF_SPI_VERIFY_MS), &change_ns, &lost) == 0);
+  BOARD_CHECK(fb_if.ethif.stats.spi_step_ups == 0 && change_ns == down_ns && lost == 0);
+
+  uint32_t steps = (uint32_t)(top_index - fb_if.ethif.spi_speed_index);
+  BOARD_CHECK(fb_phase("stepped up", steps * ETHIF_SPI_STEP_UP_MS + 2 * ETHIF_SPI_VERIFY_MS, &change_ns, &lost) == 0);
+  BOARD_CHECK(lost == 0);
+  BOARD_CHECK(fb_if.ethif.spi_hz == top && fb_if.ethif.spi_speed_index == top_index);
+  BOARD_CHECK(fb_if.ethif.stats.spi_step_ups == fb_if.ethif.stats.spi_fallbacks);
+  BOARD_CHECK(change_ns - down_ns >= (uint64_t)steps * ETHIF_SPI_STEP_UP_MS * 1000000u);
+
+  sim_cancel(fb_send, NULL);
+  return 0;
+}
+
+int main(void)
+{
+  printf("phase,spi_mhz,spi_errors,fallbacks,step_ups,frames,frames_ok,frames_bad,frames_lost,class_drops,stall_ms\n");
+  return board_scenario("fallback and step-up under traffic", fb_run_scenario, NULL);
+}
@@ -0,0 +1,251 @@
+/**
+ * @file
+ * @brief SPI trace recording and replay (ETHIF_TRACE).
+ *
+ * The record scenario brings the interface up against the simulated chip,
+ * then for 300 ms receives and transmits frames of mixed sizes while polling
+ * every millisecond, recording every SPI transaction to spi_trace.w5tr. The
+ * driver calls made (init, poll, transmit) and their times are logged next
+ * to it. The replay scenario repeats the same calls at the same times with
+ * the trace as the only transport and checks that the driver clocks out the
+ * same MOSI bytes and delivers the same frames. A third scenario flips one
+ * received payload byte in the trace and checks that replay delivers it.
+ *
+ *     phase,transactions,spi_bytes,trace_bytes,rx_frames,tx_frames,mismatches,errors,host_ns
+ *
+ * host_ns is the host CPU time of the driver calls (with the chip model
+ * when recording).
+ */
+
+#include <string.h>
+
+#include "lwip/pbuf.h"
+
+#include "board.h"
+
+#define TRACE_FILE "spi_trace.w5tr"
+#define TRACE_OPS_FILE "spi_trace.ops"
+#define TRACE_RUN_MS 300
+#define TRACE_OPS_MAX 4096
+
+enum trace_op_kind { TRACE_OP_INIT, TRACE_OP_POLL, TRACE_OP_TX };
+
+struct trace_op {
+  uint64_t at_ns;
+  uint8_t kind;                   /**< enum trace_op_kind */
+  uint16_t len;                   /**< TRACE_OP_TX: frame length */
+  uint32_t seed;                  /**< TRACE_OP_TX: frame contents */
+};
+
+struct trace_result {
+  uint32_t rx_frames;
+  uint32_t rx_hash;               /**< FNV-1a over every received frame */
+};
+
+static struct board_if trace_if;
+static struct ethif_trace trace;
+static struct trace_result trace_rx;
+static struct trace_op trace_ops[TRACE_OPS_MAX];
+static size_t trace_op_count;
+static uint32_t trace_tx_frames;
+static uint64_t trace_host_ns;
+
+static size_t trace_write(const void *data, size_t len, void *arg)
+{
+  return fwrite(data, 1, len, (FILE *)arg);
+}
+
+static err_t trace_input(struct pbuf *p, struct netif *netif)
+{
+  (void)netif;
+  uint32_t h = trace_rx.rx_hash ? trace_rx.rx_hash : 2166136261u;
+  for (struct pbuf *q = p; q != NULL; q = q->next) {
+    for (uint16_t i = 0; i < q->len; i++) {
+      h = (h ^ ((const uint8_t *)q->payload)[i]) * 16777619u;
+    }
+  }
+  trace_rx.rx_hash = h;
+  trace_rx.rx_frames++;
+  pbuf_free(p);
+  return ERR_OK;
+}
+
+static void trace_frame(uint8_t *f, uint16_t len, uint32_t seed, const uint8_t *dst)
+{
+  memcpy(f, dst, 6);
+  static const uint8_t src[6] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x01};
+  memcpy(f + 6, src, 6);
+  f[12] = 0x08;
+  f[13] = 0x00;
+  for (uint16_t i = 14; i < len; i++) {
+    seed = seed * 1103515245u + 12345u;
+    f[i] = (uint8_t)(seed >> 16);
+  }
+}
+
+/**
+ * @brief Runs one driver call, timing it on the host.
+ */
+static void trace_do(const struct trace_op *op)
+{
+  uint64_t h0 = sim_host_ns();
+  switch (op->kind) {
+    case TRACE_OP_INIT:
+      board_if_up(&trace_if, BOARD_STATIC, trace_input);
+      break;
+    case TRACE_OP_POLL:
+      ethif_poll(&trace_if.netif);
+      break;
+    case TRACE_OP_TX: {
+      uint8_t f[1514];
+      static const uint8_t router[6] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x01};
+      trace_frame(f, op->len, op->seed, router);
+      struct pbuf *p = pbuf_alloc(PBUF_RAW, op->len, PBUF_RAM);
+      pbuf_take(p, f, op->len);
+      if (trace_if.netif.linkoutput(&trace_if.netif, p) == ERR_OK) {
+        trace_tx_frames++;
+      }
+      pbuf_free(p);
+      break;
+    }
+  }
+  trace_host_ns += sim_host_ns() - h0;
+}
+
+static void trace_record_op(uint8_t kind, uint16_t len, uint32_t seed)
+{
+  struct trace_op *op = &trace_ops[trace_op_count++];
+  op->at_ns = sim_now_ns();
+  op->kind = kind;
+  op->len = len;
+  op->seed = seed;
+  trace_do(op);
+}
+
+static void trace_print(const char *phase)
+{
+  printf("%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%llu\n", phase, (unsigned long)trace.transactions,
+         (unsigned long)trace.bytes, (unsigned long)trace.len, (unsigned long)trace_rx.rx_frames,
+         (unsigned long)trace_tx_frames, (unsigned long)trace.mismatches, (unsigned long)trace.errors,
+         (unsigned long long)trace_host_ns);
+}
+
+static int trace_record_run(void *arg)
+{
+  (void)arg;
+  FILE *f = fopen(TRACE_FILE, "wb");
+  BOARD_CHECK(f != NULL);
+
+  board_init();
+  board_if_power(&trace_if, 1);
+  ethif_trace_record(&trace_if.ethif, &trace, trace_write, f);
+  trace_record_op(TRACE_OP_INIT, 0, 0);
+  while (!netif_is_link_up(&trace_if.netif) && sim_now_ns() < 5000000000u) {
+    trace_record_op(TRACE_OP_POLL, 0, 0);
+    sim_advance(1000000);
+  }
+  BOARD_CHECK(netif_is_link_up(&trace_if.netif));
+
+  for (uint32_t ms = 0; ms < TRACE_RUN_MS; ms++) {
+    static const uint16_t sizes[] = {60, 98, 342, 590, 1066, 1514};
+    uint8_t frame[1514];
+    uint16_t len = sizes[ms % 6];
+    if (ms % 3 != 2) {
+      trace_frame(frame, len, ms, trace_if.netif.hwaddr);
+      w5500_sim_receive(&trace_if.chip, frame, len);
+    }
+    if (ms % 4 == 0) {
+      trace_record_op(TRACE_OP_TX, sizes[(ms / 4) % 6], ms ^ 0x5a5a);
+    }
+    trace_record_op(TRACE_OP_POLL, 0, 0);
+    sim_advance(1000000);
+    BOARD_CHECK(trace_op_count < TRACE_OPS_MAX - 2);
+  }
+  ethif_trace_stop(&trace_if.ethif, &trace);
+  long len = ftell(f);
+  fclose(f);
+  BOARD_CHECK(trace.lost == 0);
+  BOARD_CHECK(trace_rx.rx_frames == TRACE_RUN_MS - TRACE_RUN_MS / 3);
+
+  f = fopen(TRACE_OPS_FILE, "wb");
+  BOARD_CHECK(f != NULL);
+  fwrite(&trace_rx, sizeof(trace_rx), 1, f);
+  fwrite(trace_ops, sizeof(trace_ops[0]), trace_op_count, f);
+  fclose(f);
+
+  trace.len = (size_t)len;
+  trace_print("record");
+  return 0;
+}
+
+/**
+ * @brief Replays the recorded calls; @p corrupt flips a received payload byte first.
+ */
+static int trace_replay_run(void *arg)
+{
+  bool corrupt = arg != NULL;
+  static uint8_t buf[4 << 20];
+  struct trace_result recorded;
+
+  FILE *f = fopen(TRACE_FILE, "rb");
+  BOARD_CHECK(f != NULL);
+  size_t len = fread(buf, 1, sizeof(buf), f);
+  fclose(f);
+  f = fopen(TRACE_OPS_FILE, "rb");
+  BOARD_CHECK(f != NULL);
+  BOARD_CHECK(fread(&recorded, sizeof(recorded), 1, f) == 1);
+  trace_op_count = fread(trace_ops, sizeof(trace_ops[0]), TRACE_OPS_MAX, f);
+  fclose(f);
+
+  if (corrupt) {
+    /* Last MISO byte of a full data record clocked with zero MOSI bytes,
+       that is a frame payload read, in the second half of the trace */
+    static const uint8_t zero[ETHIF_TRACE_CHUNK];
+    size_t pos = 9, target = 0;
+    while (pos < len) {
+      if (buf[pos] == 'D') {
+        uint8_t n = buf[pos + 1];
+        if (n == ETHIF_TRACE_CHUNK && pos > len / 2 && target == 0 && memcmp(buf + pos + 2, zero, n) == 0) {
+          target = pos + 2 + n + n - 1;
+        }
+        pos += 2 + 2 * (size_t)n;
+      } else {
+        pos += 5;
+      }
+    }
+    BOARD_CHECK(target != 0);
+    buf[target] ^= 0x01;
+  }
+
+  board_init();
+  board_if_power(&trace_if, 1);
+  BOARD_CHECK(ethif_trace_replay(&trace_if.ethif, &trace, buf, len));
+  for (size_t i = 0; i < trace_op_count; i++) {
+    sim_run_until(trace_ops[i].at_ns);
+    trace_do(&trace_ops[i]);
+  }
+
+  BOARD_CHECK(trace.mismatches == 0 && trace.errors == 0);
+  BOARD_CHECK(trace.pos == len);
+  BOARD_CHECK(trace_rx.rx_frames == recorded.rx_frames);
+  if (corrupt) {
+    BOARD_CHECK(trace_rx.rx_hash != recorded.rx_hash);
+  } else {
+    BOARD_CHECK(trace_rx.rx_hash == recorded.rx_hash);
+    BOARD_CHECK(w5500_sim_rx_pending(&trace_if.chip) == 0 && trace_if.chip.st.cs_cycles == 0);
+  }
+  trace.len = len;
+  trace_print(corrupt ? "replay_corrupted" : "replay");
+  return 0;
+}
+
+int main(void)
+{
+  printf("phase,transactions,spi_bytes,trace_bytes,rx_frames,tx_frames,mismatches,errors,host_ns\n");
+  if (board_scenario("trace record", trace_record_run, NULL) != 0) {
+    return 1;
+  }
+  int failed = board_scenario("trace replay", trace_replay_run, NULL);
+  failed |= board_scenario("trace replay with a corrupted frame", trace_replay_run, (void *)1);
+  return failed;
+}
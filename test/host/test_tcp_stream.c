@@ -0,0 +1,244 @@
+/**
+ * @file
+ * @brief TCP send queue (tcp_stream): integrity, segment fill and throughput.
+ *
+ * The board accepts a connection, optionally writes a short head copied
+ * like an HTTP response head, then streams a buffer by reference and a
+ * produced source by copy, refilled from the tcp_sent() and tcp_poll()
+ * callbacks. The producer has no data once in the middle of its source,
+ * so the stream must resume on a later pump. The peer checks every byte
+ * and counts segments; each transfer prints:
+ *
+ *     head,bytes,segments,full_segments,min_segments,pbufs_per_frame,ms,kbit_s
+ *
+ * min_segments is the payload divided by the MSS, rounded up, which the
+ * stream must reach even with the head and the producer stall, and
+ * pbufs_per_frame the average length of the pbuf chains of the data frames
+ * handed to the driver, which grows when chunks straddle segments. A further
+ * scenario checks the queue limit and zero-length sources.
+ */
+
+#include <string.h>
+
+#include "lwip/tcp.h"
+#include "lwip/prot/ethernet.h"
+#include "lwip/prot/ip4.h"
+#include "lwip/prot/tcp.h"
+
+#include "board.h"
+#include "tcp_stream.h"
+
+#define TS_PORT 5000
+#define TS_BUF_LEN 16384
+#define TS_GEN_LEN 16384
+
+static struct board_if ts_if;
+static struct peer ts_router;
+
+static uint8_t ts_buf[TS_BUF_LEN];
+static char ts_head[512];
+static uint16_t ts_head_len;
+
+static struct tcp_stream ts_stream;
+static uint32_t ts_queued;
+static bool ts_stalled;               /* The producer had no data once */
+static bool ts_done;
+
+static netif_linkoutput_fn ts_linkoutput;
+static uint32_t ts_data_frames;
+static uint32_t ts_data_pbufs;
+
+static struct peer_conn ts_conn;
+static uint32_t ts_got;
+static uint32_t ts_bad;
+
+static uint8_t ts_expected(uint32_t at)
+{
+  if (at < ts_head_len) {
+    return (uint8_t)ts_head[at];
+  }
+  at -= ts_head_len;
+  if (at < TS_BUF_LEN) {
+    return ts_buf[at];
+  }
+  at -= TS_BUF_LEN;
+  return (uint8_t)(at * 7 + (at >> 8));
+}
+
+static u16_t ts_produce(void *arg, u32_t offset, const void **data, u16_t max)
+{
+  static uint8_t chunk[TCP_MSS];
+  (void)arg;
+  if (!ts_stalled && offset >= TS_GEN_LEN / 2) {
+    ts_stalled = true;
+    return 0;
+  }
+  for (u16_t i = 0; i < max; i++) {
+    uint32_t at = offset + i;
+    chunk[i] = (uint8_t)(at * 7 + (at >> 8));
+  }
+  *data = chunk;
+  return max;
+}
+
+static void ts_pump(struct tcp_pcb *pcb)
+{
+  if (tcp_stream_pump(&ts_stream, &ts_queued) != ERR_OK) {
+    tcp_abort(pcb);
+    return;
+  }
+  tcp_output(pcb);
+  if (!tcp_stream_pending(&ts_stream) && !ts_done) {
+    ts_done = true;
+    tcp_close(pcb);
+  }
+}
+
+static err_t ts_sent(void *arg, struct tcp_pcb *pcb, u16_t len)
+{
+  (void)arg;
+  (void)len;
+  ts_pump(pcb);
+  return ERR_OK;
+}
+
+static err_t ts_poll(void *arg, struct tcp_pcb *pcb)
+{
+  (void)arg;
+  ts_pump(pcb);
+  return ERR_OK;
+}
+
+static err_t ts_accept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+  (void)arg;
+  if (err != ERR_OK || pcb == NULL) {
+    return ERR_VAL;
+  }
+  tcp_sent(pcb, ts_sent);
+  tcp_poll(pcb, ts_poll, 1);
+  tcp_stream_init(&ts_stream, pcb);
+  if (ts_head_len > 0 && tcp_write(pcb, ts_head, ts_head_len, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE) != ERR_OK) {
+    return ERR_MEM;
+  }
+  if (tcp_stream_push_buf(&ts_stream, ts_buf, TS_BUF_LEN, 0) != ERR_OK ||
+      tcp_stream_push(&ts_stream, ts_produce, NULL, TS_GEN_LEN, TCP_STREAM_FLAG_COPY) != ERR_OK) {
+    return ERR_MEM;
+  }
+  ts_pump(pcb);
+  return ERR_OK;
+}
+
+static void ts_recv(struct peer_conn *c, const uint8_t *data, size_t len, void *arg)
+{
+  (void)c;
+  (void)arg;
+  for (size_t i = 0; i < len; i++) {
+    ts_bad += data[i] != ts_expected(ts_got + (uint32_t)i);
+  }
+  ts_got += (uint32_t)len;
+}
+
+static bool ts_received(void *arg)
+{
+  (void)arg;
+  return ts_conn.remote_closed;
+}
+
+/**
+ * @brief Counts the pbufs of TCP data frames on their way to the driver.
+ */
+static err_t ts_count_output(struct netif *netif, struct pbuf *p)
+{
+  if (p->tot_len > SIZEOF_ETH_HDR + IP_HLEN + TCP_HLEN) {
+    ts_data_frames++;
+    ts_data_pbufs += pbuf_clen(p);
+  }
+  return ts_linkoutput(netif, p);
+}
+
+static int ts_board(void)
+{
+  board_init();
+  board_router(&ts_router);
+  board_if_power(&ts_if, 1);
+  BOARD_CHECK(board_if_up(&ts_if, BOARD_STATIC, NULL));
+  BOARD_CHECK(board_wait_addr(5000));
+  ts_linkoutput = ts_if.netif.linkoutput;
+  ts_if.netif.linkoutput = ts_count_output;
+
+  struct tcp_pcb *pcb = tcp_new();
+  BOARD_CHECK(pcb != NULL && tcp_bind(pcb, IP_ADDR_ANY, TS_PORT) == ERR_OK);
+  pcb = tcp_listen(pcb);
+  BOARD_CHECK(pcb != NULL);
+  tcp_accept(pcb, ts_accept);
+  return 0;
+}
+
+static int ts_transfer(void *arg)
+{
+  ts_head_len = (uint16_t)(uintptr_t)arg;
+  memset(ts_head, 'h', ts_head_len);
+  for (uint32_t i = 0; i < TS_BUF_LEN; i++) {
+    ts_buf[i] = (uint8_t)(i ^ (i >> 7));
+  }
+  BOARD_CHECK(ts_board() == 0);
+
+  ts_conn.on_recv = ts_recv;
+  peer_connect(&ts_router, &ts_conn, BOARD_STATIC, TS_PORT);
+  uint64_t t0 = sim_now_ns();
+  BOARD_CHECK(board_run(ts_received, NULL, 60000));
+  uint64_t ns = ts_conn.connected_ns ? sim_now_ns() - ts_conn.connected_ns : sim_now_ns() - t0;
+
+  uint32_t total = ts_head_len + TS_BUF_LEN + TS_GEN_LEN;
+  BOARD_CHECK(ts_got == total && ts_bad == 0);
+  BOARD_CHECK(ts_queued == TS_BUF_LEN + TS_GEN_LEN && ts_stalled);
+  BOARD_CHECK(ts_conn.rx_max_seg <= TCP_MSS);
+  uint32_t min_segments = (total + TCP_MSS - 1) / TCP_MSS;
+  BOARD_CHECK(ts_conn.rx_segs == min_segments);
+  BOARD_CHECK(ts_data_frames >= ts_conn.rx_segs);
+  printf("%u,%lu,%lu,%lu,%lu,%.2f,%.1f,%.0f\n", ts_head_len, (unsigned long)total, (unsigned long)ts_conn.rx_segs,
+         (unsigned long)ts_conn.rx_full_segs, (unsigned long)min_segments,
+         (double)ts_data_pbufs / ts_data_frames, (double)ns / 1e6,
+         (double)total * 8 * 1e6 / (double)ns);
+  return 0;
+}
+
+static u16_t ts_never(void *arg, u32_t offset, const void **data, u16_t max)
+{
+  (void)arg;
+  (void)offset;
+  (void)data;
+  (void)max;
+  return 0;
+}
+
+static int ts_queue_limit(void *arg)
+{
+  (void)arg;
+  struct tcp_stream stream;
+  tcp_stream_init(&stream, NULL);
+  BOARD_CHECK(!tcp_stream_pending(&stream));
+  BOARD_CHECK(tcp_stream_push_buf(&stream, ts_buf, 0, 0) == ERR_OK);
+  BOARD_CHECK(!tcp_stream_pending(&stream));
+  for (int i = 0; i < TCP_STREAM_QUEUE_LEN; i++) {
+    BOARD_CHECK(tcp_stream_push(&stream, ts_never, NULL, 100, 0) == ERR_OK);
+  }
+  BOARD_CHECK(tcp_stream_push(&stream, ts_never, NULL, 100, 0) == ERR_MEM);
+  BOARD_CHECK(tcp_stream_pending(&stream) && stream.count == TCP_STREAM_QUEUE_LEN);
+  return 0;
+}
+
+int main(void)
+{
+  int failed = 0;
+  static const uint16_t heads[] = {0, 123, 400};
+  printf("head,bytes,segments,full_segments,min_segments,pbufs_per_frame,ms,kbit_s\n");
+  for (size_t i = 0; i < sizeof(heads) / sizeof(heads[0]); i++) {
+    char name[32];
+    snprintf(name, sizeof(name), "transfer, %u byte head", heads[i]);
+    failed |= board_scenario(name, ts_transfer, (void *)(uintptr_t)heads[i]);
+  }
+  failed |= board_scenario("queue limit", ts_queue_limit, NULL);
+  return failed;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file
+ * @brief Warm init of a configured W5500 after an MCU reset, and ethif_reset().
+ *
+ * The module comes up with a static address and its link up, then the MCU
+ * resets (board_if_mcu_reset()) and setup() brings the interface up again:
+ *
+ * - power-on: the chip is fresh, so it is cold-reset;
+ * - configured: the chip still holds our MAC and MACRAW socket 0 with the
+ *   link up, so only socket 0 is re-opened; the PHY never renegotiates;
+ * - other MAC: the chip holds another module's MAC and is cold-reset;
+ * - ethif_reset(): after a warm init, a forced cold reset drops the link,
+ *   which ethif_poll() brings back once the PHY has renegotiated.
+ *
+ * In every case the router's datagrams reach the board afterwards, after
+ * an ARP exchange with it. Prints one row per scenario:
+ *
+ *     scenario,warm_inits,cold_inits,chip_resets,link_downs,link_up_ms,phy_link_lost
+ *
+ * chip_resets counts MR_RST writes after the first bring-up, link_up_ms is
+ * the time from the (re-)init to the netif link coming up, phy_link_lost
+ * whether the chip's PHY link dropped on the way.
+ */
+
+#include <string.h>
+
+#include "lwip/pbuf.h"
+#include "netif/ethernet.h"
+
+#include "board.h"
+
+#define WI_PORT 7000
+
+enum wi_scenario { WI_POWER_ON, WI_CONFIGURED, WI_OTHER_MAC, WI_RESET };
+static const char *const wi_names[] = {"power-on", "configured", "other MAC", "ethif_reset()"};
+
+static struct board_if wi_if;
+static struct peer wi_router;
+static uint32_t wi_datagrams;       /**< UDP datagrams to WI_PORT received */
+static bool wi_phy_lost;            /**< The chip's PHY link dropped */
+
+/**
+ * @brief netif input: counts the router's datagrams, passes every frame to lwIP.
+ */
+static err_t wi_input(struct pbuf *p, struct netif *netif)
+{
+  uint8_t h[14 + 20 + 4];
+  if (pbuf_copy_partial(p, h, sizeof(h), 0) == sizeof(h) && h[12] == 0x08 && h[13] == 0x00 && h[23] == 17 &&
+      (h[36] << 8 | h[37]) == WI_PORT) {
+    wi_datagrams++;
+  }
+  return ethernet_input(p, netif);
+}
+
+static bool wi_link_up(void *arg)
+{
+  (void)arg;
+  wi_phy_lost |= !w5500_sim_link(&wi_if.chip);
+  return netif_is_link_up(&wi_if.netif);
+}
+
+/**
+ * @brief The router, with its ARP cache flushed, reaches the board.
+ */
+static bool wi_reachable(void)
+{
+  uint32_t got = wi_datagrams;
+  peer_arp_flush(&wi_router);
+  peer_send_udp(&wi_router, BOARD_STATIC, WI_PORT, WI_PORT, "ping", 4);
+  board_run_for(100);
+  return wi_datagrams == got + 1;
+}
+
+static int wi_run(void *arg)
+{
+  enum wi_scenario sc = (enum wi_scenario)(uintptr_t)arg;
+
+  board_init();
+  board_router(&wi_router);
+  board_if_power(&wi_if, 1);
+  if (sc != WI_POWER_ON) {
+    /* Before the MCU reset */
+    BOARD_CHECK(board_if_up(&wi_if, BOARD_STATIC, wi_input));
+    BOARD_CHECK(board_run(wi_link_up, NULL, 5000));
+    BOARD_CHECK(wi_reachable());
+    board_if_mcu_reset(&wi_if);
+    if (sc == WI_OTHER_MAC) {
+      board_mac(2, wi_if.netif.hwaddr);
+    }
+  }
+  uint64_t resets = wi_if.chip.st.resets;
+  wi_phy_lost = false;
+
+  uint64_t t0 = sim_now_ns();
+  BOARD_CHECK(board_if_up(&wi_if, BOARD_STATIC, wi_input));
+  BOARD_CHECK(board_run(wi_link_up, NULL, 5000));
+  const struct ethif_stats *st = &wi_if.ethif.stats;
+  if (sc == WI_RESET) {
+    BOARD_CHECK(st->warm_inits == 1 && wi_if.chip.st.resets == resets);
+    t0 = sim_now_ns();
+    BOARD_CHECK(ethif_reset(&wi_if.netif) == ERR_OK);
+    BOARD_CHECK(!netif_is_link_up(&wi_if.netif));
+    BOARD_CHECK(board_run(wi_link_up, NULL, 5000));
+  }
+  uint64_t up_ns = sim_now_ns() - t0;
+  BOARD_CHECK(wi_reachable());
+
+  printf("%s,%lu,%lu,%lu,%lu,%.1f,%d\n", wi_names[sc], (unsigned long)st->warm_inits,
+         (unsigned long)st->cold_inits, (unsigned long)(wi_if.chip.st.resets - resets),
+         (unsigned long)st->link_down, (double)up_ns / 1e6, wi_phy_lost);
+
+  uint64_t autoneg_ns = (uint64_t)wi_if.chip.autoneg_ms * 1000000u;
+  switch (sc) {
+  case WI_CONFIGURED:
+    /* Socket 0 re-opened, the PHY kept its link */
+    BOARD_CHECK(st->warm_inits == 1 && st->cold_inits == 0);
+    BOARD_CHECK(wi_if.chip.st.resets == resets && !wi_phy_lost);
+    BOARD_CHECK(up_ns < 10000000u);
+    break;
+  case WI_RESET:
+    BOARD_CHECK(st->warm_inits == 1 && st->cold_inits == 1 && st->link_down == 1);
+    BOARD_CHECK(wi_if.chip.st.resets == resets + 1 && wi_phy_lost);
+    BOARD_CHECK(up_ns >= autoneg_ns);
+    break;
+  default:
+    BOARD_CHECK(st->warm_inits == 0 && st->cold_inits == 1);
+    BOARD_CHECK(wi_if.chip.st.resets == resets + 1 && wi_phy_lost);
+    BOARD_CHECK(up_ns >= autoneg_ns);
+    break;
+  }
+  return 0;
+}
+
+int main(void)
+{
+  int failed = 0;
+  printf("scenario,warm_inits,cold_inits,chip_resets,link_downs,link_up_ms,phy_link_lost\n");
+  for (int sc = WI_POWER_ON; sc <= WI_RESET; sc++) {
+    failed |= board_scenario(wi_names[sc], wi_run, (void *)(uintptr_t)sc);
+  }
+  return failed;
+}
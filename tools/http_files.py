@@ -0,0 +1,141 @@
+"""
+Generate src/http_files.cpp, the in-flash file table of the HTTP server, from data/.
+
+Every file under data/ is served at its path relative to data/; index.html is
+also served at its directory ("/status/"). A file ending in .gz is served
+without the suffix, with Content-Encoding: gzip. The ETag is the CRC-32 of the
+stored content, and the complete response heads are precomputed.
+
+Runs as a PlatformIO pre-build script (see platformio.ini) and standalone:
+
+    python tools/http_files.py
+"""
+
+import os
+import sys
+import zlib
+
+try:
+    Import("env")  # noqa: F821 (provided by PlatformIO)
+    PROJECT_DIR = env.subst("$PROJECT_DIR")  # noqa: F821
+except NameError:
+    PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+DATA_DIR = os.path.join(PROJECT_DIR, "data")
+OUTPUT = os.path.join(PROJECT_DIR, "src", "http_files.cpp")
+HEAD_MAX = 256  # HTTP_FILE_HEAD_MAX in include/http_files.h
+
+CONTENT_TYPES = {
+    ".html": "text/html; charset=utf-8",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".txt": "text/plain; charset=utf-8",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".jpg": "image/jpeg",
+    ".ico": "image/x-icon",
+}
+
+
+def c_string(text):
+    """Return text as a C string literal, split after each header line."""
+    escaped = text.replace("\\", "\\\\").replace('"', '\\"').replace("\r", "\\r")
+    lines = escaped.split("\n")
+    parts = ['"%s\\n"' % line for line in lines[:-1]]
+    if lines[-1] or not parts:
+        parts.append('"%s"' % lines[-1])
+    return "\n    ".join(parts)
+
+
+def c_bytes(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + " ".join("0x%02x," % b for b in data[i:i + 16]))
+    return "\n".join(lines)
+
+
+def head(content_type, length, etag, gzip, close):
+    lines = [
+        "HTTP/1.1 200 OK",
+        "Content-Type: " + content_type,
+        "Content-Length: %d" % length,
+        "ETag: " + etag,
+        "Cache-Control: no-cache",
+    ]
+    if gzip:
+        lines += ["Content-Encoding: gzip", "Vary: Accept-Encoding"]
+    if close:
+        lines.append("Connection: close")
+    return "\r\n".join(lines) + "\r\n\r\n"
+
+
+def scan():
+    files = []
+    for root, dirs, names in os.walk(DATA_DIR):
+        dirs.sort()
+        for name in sorted(names):
+            full = os.path.join(root, name)
+            rel = os.path.relpath(full, DATA_DIR).replace(os.sep, "/")
+            gzip = rel.endswith(".gz")
+            if gzip:
+                rel = rel[:-3]
+            ext = os.path.splitext(rel)[1].lower()
+            with open(full, "rb") as f:
+                data = f.read()
+            files.append({
+                "path": "/" + rel,
+                "data": data,
+                "gzip": gzip,
+                "type": CONTENT_TYPES.get(ext, "application/octet-stream"),
+                "etag": '"%08x"' % (zlib.crc32(data) & 0xFFFFFFFF),
+            })
+    return files
+
+
+def render(files):
+    out = [
+        "// Generated by tools/http_files.py from data/, do not edit.",
+        "",
+        '#include "http_files.h"',
+        "",
+    ]
+    table = []
+    for i, f in enumerate(files):
+        keep = head(f["type"], len(f["data"]), f["etag"], f["gzip"], False)
+        close = head(f["type"], len(f["data"]), f["etag"], f["gzip"], True)
+        if len(close) > HEAD_MAX:
+            sys.exit("http_files: response head of %s exceeds %d bytes" % (f["path"], HEAD_MAX))
+        out += [
+            "// %s" % f["path"],
+            "static const uint8_t file%d_data[] = {" % i,
+            c_bytes(f["data"]),
+            "};",
+            "static const char file%d_head[] =\n    %s;" % (i, c_string(keep)),
+            "static const char file%d_head_close[] =\n    %s;" % (i, c_string(close)),
+            "",
+        ]
+        paths = [f["path"]]
+        if f["path"].endswith("/index.html") and f["path"] != "/index.html":
+            paths.append(f["path"][:-len("index.html")])
+        for path in paths:
+            table.append("  {%s, %s, file%d_head, file%d_head_close, file%d_data, %d, %d, %d, %s},"
+                         % (c_string(path), c_string(f["etag"]), i, i, i, len(keep), len(close),
+                            len(f["data"]), "true" if f["gzip"] else "false"))
+    out += ["const struct http_file http_files[] = {"] + table + ["};"]
+    out += ["const size_t http_files_count = %d;" % len(table), ""]
+    return "\n".join(out)
+
+
+def generate():
+    text = render(scan())
+    if os.path.exists(OUTPUT):
+        with open(OUTPUT) as f:
+            if f.read() == text:
+                return
+    with open(OUTPUT, "w") as f:
+        f.write(text)
+    print("http_files: generated %s" % os.path.relpath(OUTPUT, PROJECT_DIR))
+
+
+generate()
@@ -0,0 +1,49 @@
+"""
+PlatformIO post-build script: report the RAM of the lwIP memory pools and heap.
+
+Reads the symbol sizes of the linked firmware, so the numbers are exact for the
+current lwipopts.h. The compile-time budget check lives in footprint.c.
+"""
+
+import re
+import subprocess
+
+Import("env")  # noqa: F821 (provided by PlatformIO)
+
+POOL_SYMBOL = re.compile(r"^memp_memory_(\w+)_base$")
+HEAP_SYMBOL = "ram_heap"
+
+
+def lwip_footprint(source, target, env):
+    elf = str(target[0])
+    nm = env.subst("$CC").replace("gcc", "nm")
+    try:
+        out = subprocess.check_output([nm, "-S", "--size-sort", elf], universal_newlines=True)
+    except (OSError, subprocess.CalledProcessError) as e:
+        print("lwip_footprint: %s failed: %s" % (nm, e))
+        return
+
+    rows = []
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) != 4:
+            continue
+        size, name = int(fields[1], 16), fields[3]
+        match = POOL_SYMBOL.match(name)
+        if match:
+            rows.append((match.group(1), size))
+        elif name == HEAP_SYMBOL:
+            rows.append(("HEAP", size))
+
+    if not rows:
+        print("lwip_footprint: no lwIP pools found in %s" % elf)
+        return
+
+    total = sum(size for _, size in rows)
+    print("lwIP RAM footprint:")
+    for name, size in sorted(rows, key=lambda r: -r[1]):
+        print("  %-20s %6d bytes %5.1f%%" % (name, size, 100.0 * size / total))
+    print("  %-20s %6d bytes" % ("TOTAL", total))
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", lwip_footprint)  # noqa: F821